@@ -305,6 +305,97 @@ struct percolsimd_copy
 };
 
 
+// copy and fill with explicit store hints
+
+inline const char *hinted_copy_name(cache_store_) { return "cached_copy"; }
+inline const char *hinted_copy_name(stream_store_) { return "stream_copy"; }
+
+inline const char *hinted_fill_name(cache_store_) { return "cached_fill"; }
+inline const char *hinted_fill_name(stream_store_) { return "stream_fill"; }
+
+inline const char *hinted_ewise_name(cache_store_) { return "linearsimd_cached_copy"; }
+inline const char *hinted_ewise_name(stream_store_) { return "linearsimd_stream_copy"; }
+
+
+template<typename T, typename S>
+struct hinted_copy
+{
+	cref_matrix<T> src;
+	mutable ref_matrix<T> dst;
+
+	hinted_copy(index_t m, index_t n, const T* s, T *d)
+	: src(s, m, n), dst(d, m, n) { }
+
+	const char *name() const
+	{
+		return hinted_copy_name(S());
+	}
+
+	size_t size() const
+	{
+		return (size_t)src.nelems();
+	}
+
+	void operator() () const
+	{
+		copy(src, dst, S());
+	}
+};
+
+
+template<typename T, typename S>
+struct hinted_fill
+{
+	mutable ref_matrix<T> dst;
+
+	hinted_fill(index_t m, index_t n, const T* s, T *d)
+	: dst(d, m, n) { }
+
+	const char *name() const
+	{
+		return hinted_fill_name(S());
+	}
+
+	size_t size() const
+	{
+		return (size_t)dst.nelems();
+	}
+
+	void operator() () const
+	{
+		fill(dst, T(1), S());
+	}
+};
+
+
+template<typename T, typename S>
+struct hinted_ewise_copy
+{
+	cref_matrix<T> src;
+	mutable ref_matrix<T> dst;
+
+	hinted_ewise_copy(index_t m, index_t n, const T* s, T *d)
+	: src(s, m, n), dst(d, m, n) { }
+
+	const char *name() const
+	{
+		return hinted_ewise_name(S());
+	}
+
+	size_t size() const
+	{
+		return (size_t)src.nelems();
+	}
+
+	void operator() () const
+	{
+		typedef simd_<default_simd_kind> tag;
+		ewise(copy_kernel<T>()).eval(macc_<linear_, tag, S>(),
+				src.shape(), in_(src), out_(dst));
+	}
+};
+
+
 index_t sizes[] = {2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000 };
 const size_t nsizes = sizeof(sizes) / sizeof(index_t);
 
@@ -368,17 +459,77 @@ void run_bench()
 }
 
 
+// large destinations (in MB), where streaming stores matter
+
+index_t large_sizes[] = {1, 4, 16, 64, 256, 1024};
+const size_t nlarge_sizes = sizeof(large_sizes) / sizeof(index_t);
+
+template<typename T>
+void run_large_bench(index_t max_mb)
+{
+	std_bench_monitor mon;
+
+	for (size_t k = 0; k < nlarge_sizes && large_sizes[k] <= max_mb; ++k)
+	{
+		const size_t nb = size_t(large_sizes[k]) << 20;
+		index_t m = 1024;
+		index_t n = index_t(nb / (sizeof(T) * size_t(m)));
+
+		dense_matrix<T> src(m, n);
+		dense_matrix<T> dst(m, n, zero());
+		const T *ps = src.ptr_data();
+		T *pd = dst.ptr_data();
+		fill_rand(src);
+
+		size_t pbsiz = (size_t(1) << 31) / nb;
+		benchmark_option opt(pbsiz > 2 ? pbsiz : 2);
+
+		std::cout << "size = " << large_sizes[k] << " MB (" << m << " x " << n << ")\n";
+		std::cout << "=======================================\n";
+
+		direct_copy<T> job_direct_copy(m, n, ps, pd);
+		run_benchmark(job_direct_copy, mon, opt);
+
+		hinted_copy<T, cache_store_> job_cached_copy(m, n, ps, pd);
+		run_benchmark(job_cached_copy, mon, opt);
+
+		hinted_copy<T, stream_store_> job_stream_copy(m, n, ps, pd);
+		run_benchmark(job_stream_copy, mon, opt);
+
+		hinted_fill<T, cache_store_> job_cached_fill(m, n, ps, pd);
+		run_benchmark(job_cached_fill, mon, opt);
+
+		hinted_fill<T, stream_store_> job_stream_fill(m, n, ps, pd);
+		run_benchmark(job_stream_fill, mon, opt);
+
+		hinted_ewise_copy<T, cache_store_> job_cached_ewise(m, n, ps, pd);
+		run_benchmark(job_cached_ewise, mon, opt);
+
+		hinted_ewise_copy<T, stream_store_> job_stream_ewise(m, n, ps, pd);
+		run_benchmark(job_stream_ewise, mon, opt);
+
+		std::cout << "\n";
+	}
+}
+
+
+// usage: bench_copy [max_size_in_MB] (default = 1024)
+
 int main(int argc, char *argv[])
 {
+	index_t max_mb = argc > 1 ? (index_t)std::atoi(argv[1]) : 1024;
+
 	std::printf("On float\n");
 	std::printf("**************************************\n");
 	run_bench<float>();
+	run_large_bench<float>(max_mb);
 
 	std::printf("\n");
 
 	std::printf("On double\n");
 	std::printf("**************************************\n");
 	run_bench<double>();
+	run_large_bench<double>(max_mb);
 
 	std::printf("\n");
 }
@@ -0,0 +1,159 @@
+/**
+ * @file bench_rsvd.cpp
+ *
+ * @brief Benchmark of randomized truncated SVD against gesdd
+ *
+ * @author Dahua Lin
+ */
+
+#include "bench_base.h"
+#include <light_mat/linalg/lapack_rsvd.h>
+#include <light_mat/random/rand_stream.h>
+
+#include <cmath>
+#include <cstdio>
+
+using namespace lmat;
+using namespace ltest;
+using namespace lmat::bench;
+using lmat::random::default_rand_stream;
+
+
+template<typename T>
+struct bench_svd_base
+{
+	const char *_name;
+	cref_matrix<T> a;
+	index_t k;
+
+	bench_svd_base(const dense_matrix<T>& a_, index_t k_)
+	: _name(0), a(a_.ptr_data(), a_.nrows(), a_.ncolumns()), k(k_) { }
+
+	const char *name() const
+	{
+		return _name;
+	}
+
+	size_t size() const
+	{
+		return (size_t)(a.nelems());
+	}
+};
+
+
+template<typename T>
+struct bench_gesdd : public bench_svd_base<T>
+{
+	mutable dense_col<T> s;
+	mutable dense_matrix<T> u;
+	mutable dense_matrix<T> vt;
+
+	bench_gesdd(const bench_svd_base<T>& base)
+	: bench_svd_base<T>(base) { this->_name = "gesdd"; }
+
+	void operator() () const
+	{
+		lapack::gesdd(this->a, s, u, vt, 'S');
+	}
+};
+
+
+template<typename T>
+struct bench_rsvd : public bench_svd_base<T>
+{
+	lapack::rsvd_options opts;
+	mutable default_rand_stream rs;
+	mutable dense_col<T> s;
+	mutable dense_matrix<T> u;
+	mutable dense_matrix<T> vt;
+
+	bench_rsvd(const bench_svd_base<T>& base, index_t q, const char *name)
+	: bench_svd_base<T>(base), opts(10, q) { this->_name = name; }
+
+	void operator() () const
+	{
+		lapack::rsvd(this->a, this->k, rs, s, u, vt, opts);
+	}
+};
+
+
+// a = X * diag(sig) * Y', with sig[j] = 1 / (j + 1)
+
+template<typename T>
+void make_test_matrix(index_t m, index_t n, dense_matrix<T>& a)
+{
+	const index_t r = math::min(m, n);
+
+	dense_matrix<T> x(m, r), y(n, r);
+	fill_rand(x);
+	fill_rand(y);
+
+	dense_matrix<T> qx, qy;
+	lapack::qr_fac<T>(x).getq(qx, r);
+	lapack::qr_fac<T>(y).getq(qy, r);
+
+	for (index_t j = 0; j < r; ++j)
+	{
+		T sig = T(1) / T(j + 1);
+		for (index_t i = 0; i < m; ++i) qx(i, j) *= sig;
+	}
+
+	a.require_size(m, n);
+	blas::gemm(qx, qy, a, 'N', 'T');
+}
+
+// max relative error of the leading k singular values
+
+template<typename T>
+double sval_error(const dense_col<T>& s, const dense_col<T>& s0, index_t k)
+{
+	double e = 0;
+	for (index_t i = 0; i < k; ++i)
+	{
+		double ei = std::fabs(double(s[i]) - double(s0[i])) / double(s0[i]);
+		if (ei > e) e = ei;
+	}
+	return e;
+}
+
+
+template<typename T>
+void bench_svds(index_t m, index_t n, index_t k)
+{
+	std::printf("m = %ld, n = %ld, k = %ld\n", (long)m, (long)n, (long)k);
+	std::printf("---------------------------------\n");
+
+	dense_matrix<T> a;
+	make_test_matrix(m, n, a);
+
+	std_bench_monitor mon;
+	benchmark_option opt(1);
+
+	bench_svd_base<T> base(a, k);
+
+	bench_gesdd<T> b0(base);
+	run_benchmark(b0, mon, opt);
+
+	bench_rsvd<T> b1(base, 0, "rsvd-q0");
+	run_benchmark(b1, mon, opt);
+
+	bench_rsvd<T> b2(base, 2, "rsvd-q2");
+	run_benchmark(b2, mon, opt);
+
+	std::printf("sval rel.err: rsvd-q0 = %.3g, rsvd-q2 = %.3g\n\n",
+			sval_error(b1.s, b0.s, k), sval_error(b2.s, b0.s, k));
+}
+
+
+int main(int argc, char *argv[])
+{
+	std::printf("Randomized SVD [double]\n");
+	std::printf("**************************************\n");
+	bench_svds<double>(2000, 500, 20);
+	bench_svds<double>(4000, 1000, 50);
+
+	std::printf("Randomized SVD [float]\n");
+	std::printf("**************************************\n");
+	bench_svds<float>(2000, 500, 20);
+	bench_svds<float>(4000, 1000, 50);
+}
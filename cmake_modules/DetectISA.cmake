@@ -20,6 +20,7 @@ if (${TARGET_ISA} STREQUAL "sse2")
     set(ALLOW_SSE4_1 "no")
     set(ALLOW_SSE4_2 "no")
     set(ALLOW_AVX    "no")
+    set(ALLOW_AVX2   "no")
 endif (${TARGET_ISA} STREQUAL "sse2")
 
 if (${TARGET_ISA} STREQUAL "sse3")
@@ -29,6 +30,7 @@ if (${TARGET_ISA} STREQUAL "sse3")
     set(ALLOW_SSE4_1 "no")
     set(ALLOW_SSE4_2 "no")
     set(ALLOW_AVX    "no")
+    set(ALLOW_AVX2   "no")
 endif (${TARGET_ISA} STREQUAL "sse3")
 
 if (${TARGET_ISA} STREQUAL "ssse3")
@@ -38,6 +40,7 @@ if (${TARGET_ISA} STREQUAL "ssse3")
     set(ALLOW_SSE4_1 "no")
     set(ALLOW_SSE4_2 "no")
     set(ALLOW_AVX    "no")
+    set(ALLOW_AVX2   "no")
 endif (${TARGET_ISA} STREQUAL "ssse3")
 
 if (${TARGET_ISA} STREQUAL "sse4.1")
@@ -47,6 +50,7 @@ if (${TARGET_ISA} STREQUAL "sse4.1")
     set(ALLOW_SSE4_1 "yes")
     set(ALLOW_SSE4_2 "no")
     set(ALLOW_AVX    "no")
+    set(ALLOW_AVX2   "no")
 endif (${TARGET_ISA} STREQUAL "sse4.1")
 
 if (${TARGET_ISA} STREQUAL "sse4.2")
@@ -56,6 +60,7 @@ if (${TARGET_ISA} STREQUAL "sse4.2")
     set(ALLOW_SSE4_1 "yes")
     set(ALLOW_SSE4_2 "yes")
     set(ALLOW_AVX    "no")
+    set(ALLOW_AVX2   "no")
 endif (${TARGET_ISA} STREQUAL "sse4.2")
 
 if (${TARGET_ISA} STREQUAL "avx")
@@ -65,21 +70,53 @@ if (${TARGET_ISA} STREQUAL "avx")
     set(ALLOW_SSE4_1 "yes")
     set(ALLOW_SSE4_2 "yes")
     set(ALLOW_AVX    "yes")
+    set(ALLOW_AVX2   "no")
 endif (${TARGET_ISA} STREQUAL "avx")
 
+if (${TARGET_ISA} STREQUAL "avx2")
+    set(ALLOW_SSE2   "yes")
+    set(ALLOW_SSE3   "yes")
+    set(ALLOW_SSSE3  "yes")
+    set(ALLOW_SSE4_1 "yes")
+    set(ALLOW_SSE4_2 "yes")
+    set(ALLOW_AVX    "yes")
+    set(ALLOW_AVX2   "yes")
+endif (${TARGET_ISA} STREQUAL "avx2")
+
 
 # set compiler arch flags
 
 if (MSVC)
-    if (ALLOW_AVX)
+    if (ALLOW_AVX2)
+        set(ARCH_FLAG "/arch:AVX2")
+    elseif (ALLOW_AVX)
         set(ARCH_FLAG "/arch:AVX")
-    else(ALLOW_AVX)
+    else (ALLOW_AVX2)
         set(ARCH_FLAG "/arch:SSE2")
-    endif (ALLOW_AVX)
+    endif (ALLOW_AVX2)
 else (MSVC)
-    set(ARCH_FLAG "-m${TARGET_ISA}")
+    if (ALLOW_AVX2)
+        # FMA3 ships with every AVX2 processor
+        set(ARCH_FLAG "-mavx2 -mfma")
+    else (ALLOW_AVX2)
+        set(ARCH_FLAG "-m${TARGET_ISA}")
+    endif (ALLOW_AVX2)
 endif (MSVC)
 
 message(STATUS "[LMAT] ARCH_FLAG = ${ARCH_FLAG}")
 
 
+
+
+# flags for the ISA variants of the run-time dispatched kernels
+# (src/dispatch), independent of TARGET_ISA
+
+if (MSVC)
+    set(DISPATCH_SSE2_FLAG "/arch:SSE2")
+    set(DISPATCH_AVX_FLAG  "/arch:AVX")
+    set(DISPATCH_AVX2_FLAG "/arch:AVX2")
+else (MSVC)
+    set(DISPATCH_SSE2_FLAG "-msse2 -mno-sse3")
+    set(DISPATCH_AVX_FLAG  "-mavx -mno-avx2 -mno-fma")
+    set(DISPATCH_AVX2_FLAG "-mavx2 -mfma")
+endif (MSVC)
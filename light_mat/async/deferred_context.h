@@ -0,0 +1,568 @@
+/**
+ * @file deferred_context.h
+ *
+ * @brief Asynchronous evaluation of matrix statements as a task graph
+ *
+ * A deferred context records statements (assignments of expressions
+ * to matrices, or arbitrary callables with declared operands), and
+ * runs them on a thread pool. The dependencies between statements are
+ * inferred from the memory they read and write: a statement waits for
+ * every earlier one that writes memory it reads or writes, or reads
+ * memory it writes. Independent statements run concurrently.
+ *
+ * The memory of a matrix is taken as the address range from its first
+ * to its last element, so that interleaved views (e.g. two rows of the
+ * same matrix) are conservatively treated as overlapping.
+ *
+ * The matrices involved must remain alive (and must not be resized)
+ * until the statements that use them are finished.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_DEFERRED_CONTEXT_H_
+#define LIGHTMAT_DEFERRED_CONTEXT_H_
+
+#include <light_mat/async/thread_pool.h>
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/matexpr/map_expr.h>
+
+#include <cstdint>
+#include <future>
+#include <tuple>
+
+namespace lmat
+{
+
+	/********************************************
+	 *
+	 *  memory footprints
+	 *
+	 ********************************************/
+
+	struct mem_range
+	{
+		std::uintptr_t begin;
+		std::uintptr_t end;
+
+		bool overlaps(const mem_range& r) const
+		{
+			return begin < r.end && r.begin < end;
+		}
+	};
+
+	template<class Mat, typename T>
+	inline mem_range mem_range_of(const IRegularMatrix<Mat, T>& a)
+	{
+		mem_range r;
+		if (a.nelems() > 0)
+		{
+			const index_t ext = (a.nrows() - 1) * a.row_stride() + (a.ncolumns() - 1) * a.col_stride() + 1;
+			r.begin = reinterpret_cast<std::uintptr_t>(a.ptr_data());
+			r.end = r.begin + (std::uintptr_t)ext * sizeof(T);
+		}
+		else
+		{
+			r.begin = r.end = 0;
+		}
+		return r;
+	}
+
+	class mem_access
+	{
+	public:
+		explicit mem_access(bool is_write)
+		: m_is_write(is_write) { }
+
+		bool is_write() const
+		{
+			return m_is_write;
+		}
+
+		const std::vector<mem_range>& ranges() const
+		{
+			return m_ranges;
+		}
+
+		template<class Mat, typename T>
+		mem_access& add(const IRegularMatrix<Mat, T>& a)
+		{
+			add(mem_range_of(a));
+			return *this;
+		}
+
+		mem_access& add(const mem_range& r)
+		{
+			if (r.begin < r.end) m_ranges.push_back(r);
+			return *this;
+		}
+
+	private:
+		bool m_is_write;
+		std::vector<mem_range> m_ranges;
+	};
+
+	namespace internal
+	{
+		inline void add_accesses(mem_access& ) { }
+
+		template<class Mat, typename... Rest>
+		inline void add_accesses(mem_access& acc, const Mat& a, const Rest&... rest)
+		{
+			acc.add(a);
+			add_accesses(acc, rest...);
+		}
+	}
+
+	/**
+	 * The operands read by a submitted task.
+	 */
+	template<typename... Mats>
+	inline mem_access reads(const Mats&... mats)
+	{
+		mem_access acc(false);
+		internal::add_accesses(acc, mats...);
+		return acc;
+	}
+
+	/**
+	 * The operands written by a submitted task.
+	 */
+	template<typename... Mats>
+	inline mem_access writes(const Mats&... mats)
+	{
+		mem_access acc(true);
+		internal::add_accesses(acc, mats...);
+		return acc;
+	}
+
+
+	/********************************************
+	 *
+	 *  captured expressions
+	 *
+	 *  An expression only refers to its operands,
+	 *  many of which are temporaries of the statement
+	 *  that records it. The capture of an expression
+	 *  keeps copies of the scalars, views and
+	 *  sub-expressions, and refers to the owning
+	 *  matrices (dense_matrix, etc) only. Captures
+	 *  are neither copyable nor movable, as each
+	 *  rebuilt expression refers to its children.
+	 *
+	 ********************************************/
+
+	namespace internal
+	{
+		struct capture_value_tag { };
+		struct capture_ref_tag { };
+		struct capture_map_tag { };
+
+		template<class E>
+		struct is_owning_mat : public meta::false_ { };
+
+		template<typename T, index_t CM, index_t CN, class Allocator>
+		struct is_owning_mat<dense_matrix<T, CM, CN, Allocator> > : public meta::true_ { };
+
+		template<typename T, index_t CM>
+		struct is_owning_mat<dense_col<T, CM> > : public meta::true_ { };
+
+		template<typename T, index_t CN>
+		struct is_owning_mat<dense_row<T, CN> > : public meta::true_ { };
+
+		template<class E, bool IsXpr=meta::is_mat_xpr<E>::value>
+		struct capture_tag
+		{
+			typedef capture_value_tag type;   // scalars
+		};
+
+		template<class E>
+		struct capture_tag<E, true>
+		{
+			static_assert(meta::is_regular_mat<E>::value || fuse_is_map<E>::value,
+					"Only regular matrices and map expressions can be deferred.");
+
+			typedef typename meta::if_<is_owning_mat<E>,
+					capture_ref_tag,
+					typename meta::if_<fuse_is_map<E>,
+						capture_map_tag,
+						capture_value_tag>::type
+					>::type type;
+		};
+
+		template<class E, typename Tag=typename capture_tag<E>::type>
+		class expr_capture;
+
+		template<class E, bool IsRegular=meta::is_regular_mat<E>::value>
+		struct capture_footprint
+		{
+			static void collect(const E& , std::vector<mem_range>& ) { }
+		};
+
+		template<class E>
+		struct capture_footprint<E, true>
+		{
+			static void collect(const E& e, std::vector<mem_range>& rs)
+			{
+				mem_range r = mem_range_of(e);
+				if (r.begin < r.end) rs.push_back(r);
+			}
+		};
+
+		template<class E>
+		class expr_capture<E, capture_value_tag> : private noncopyable
+		{
+		public:
+			typedef E expr_type;
+
+			explicit expr_capture(const E& e) : m_val(e) { }
+
+			const expr_type& expr() const
+			{
+				return m_val;
+			}
+
+			void collect(std::vector<mem_range>& rs) const
+			{
+				capture_footprint<E>::collect(m_val, rs);
+			}
+
+		private:
+			E m_val;
+		};
+
+		template<class E>
+		class expr_capture<E, capture_ref_tag> : private noncopyable
+		{
+		public:
+			typedef E expr_type;
+
+			explicit expr_capture(const E& e) : m_ref(e) { }
+
+			const expr_type& expr() const
+			{
+				return m_ref;
+			}
+
+			void collect(std::vector<mem_range>& rs) const
+			{
+				capture_footprint<E>::collect(m_ref, rs);
+			}
+
+		private:
+			const E& m_ref;
+		};
+
+		// map expressions of any number of arguments: each argument is
+		// captured, and the expression rebuilt on the captured ones
+
+		template<typename FTag, typename... Args>
+		class expr_capture<map_expr<FTag, Args...>, capture_map_tag> : private noncopyable
+		{
+			typedef map_expr<FTag, Args...> source_type;
+			typedef std::tuple<expr_capture<Args>...> captures_t;
+			typedef typename map_make_ints<sizeof...(Args)>::type indices_t;
+			static const bool in_tuple = sizeof...(Args) > 3;
+
+		public:
+			typedef map_expr<FTag, typename expr_capture<Args>::expr_type...> expr_type;
+
+			explicit expr_capture(const source_type& e)
+			: expr_capture(e, indices_t()) { }
+
+			const expr_type& expr() const
+			{
+				return m_expr;
+			}
+
+			void collect(std::vector<mem_range>& rs) const
+			{
+				collect_(rs, indices_t());
+			}
+
+		private:
+			template<int... I>
+			expr_capture(const source_type& e, map_ints<I...>)
+			: m_caps(fuse_arg<I, in_tuple>::get(e)...)
+			, m_expr(FTag(), std::get<I>(m_caps).expr()...) { }
+
+			template<int... I>
+			void collect_(std::vector<mem_range>& rs, map_ints<I...>) const
+			{
+				int ord[] = { (std::get<I>(m_caps).collect(rs), 0)... };
+				(void)ord;
+			}
+
+		private:
+			captures_t m_caps;
+			expr_type m_expr;
+		};
+
+
+		// destinations: views are copied, owning matrices referred to
+
+		template<class D, bool Own=is_owning_mat<D>::value>
+		class deferred_dest : private noncopyable
+		{
+		public:
+			explicit deferred_dest(D& d) : m_view(d) { }
+
+			D& get()
+			{
+				return m_view;
+			}
+
+		private:
+			D m_view;
+		};
+
+		template<class D>
+		class deferred_dest<D, true> : private noncopyable
+		{
+		public:
+			explicit deferred_dest(D& d) : m_ref(d) { }
+
+			D& get()
+			{
+				return m_ref;
+			}
+
+		private:
+			D& m_ref;
+		};
+
+
+		/********************************************
+		 *
+		 *  task nodes
+		 *
+		 ********************************************/
+
+		struct deferred_task
+		{
+			std::function<void()> fun;
+			std::vector<mem_range> rd;
+			std::vector<mem_range> wr;
+
+			std::atomic<index_t> npreds;	// unfinished predecessors (+1 while recording)
+			std::mutex mut;
+			bool done;
+			std::vector<std::shared_ptr<deferred_task> > succs;
+
+			deferred_task()
+			: npreds(1), done(false) { }
+
+			static bool any_overlap(const std::vector<mem_range>& a, const std::vector<mem_range>& b)
+			{
+				for (size_t i = 0; i < a.size(); ++i)
+					for (size_t j = 0; j < b.size(); ++j)
+						if (a[i].overlaps(b[j])) return true;
+				return false;
+			}
+
+			// whether this task must wait for an earlier task p
+
+			bool depends_on(const deferred_task& p) const
+			{
+				return any_overlap(wr, p.wr) || any_overlap(wr, p.rd) || any_overlap(rd, p.wr);
+			}
+		};
+	}
+
+
+	/********************************************
+	 *
+	 *  deferred context
+	 *
+	 ********************************************/
+
+	class deferred_context : private noncopyable
+	{
+		typedef internal::deferred_task task_t;
+		typedef std::shared_ptr<task_t> task_ptr;
+
+	public:
+		explicit deferred_context(thread_pool& pool = thread_pool::global())
+		: m_pool(pool), m_nunfinished(0) { }
+
+		~deferred_context()
+		{
+			sync();
+		}
+
+		thread_pool& pool() const
+		{
+			return m_pool;
+		}
+
+		/**
+		 * Records dst = expr. The destination must already have the
+		 * shape of expr, and the returned future becomes ready when
+		 * the assignment is done.
+		 */
+		template<class Expr, typename T, class DMat>
+		std::future<void> assign(IRegularMatrix<DMat, T>& dst, const IMatrixXpr<Expr, T>& expr)
+		{
+			check_arg( have_same_shape(dst, expr),
+					"deferred_context::assign: dst must have the same shape as expr.");
+
+			typedef internal::expr_capture<Expr> cap_t;
+			std::shared_ptr<cap_t> cap(new cap_t(expr.derived()));
+
+			task_ptr t(new task_t());
+			cap->collect(t->rd);
+			t->wr.push_back(mem_range_of(dst));
+
+			typedef internal::deferred_dest<DMat> dst_t;
+			std::shared_ptr<dst_t> pd(new dst_t(dst.derived()));
+
+			std::shared_ptr<std::packaged_task<void()> > pt(
+					new std::packaged_task<void()>([pd, cap]() { pd->get() = cap->expr(); }));
+
+			return record(t, pt);
+		}
+
+		/**
+		 * Records a call to f(), which accesses memory as declared.
+		 * The returned future holds the result of f().
+		 */
+		template<class F>
+		std::future<typename std::result_of<F()>::type> submit(F f)
+		{
+			return record(task_ptr(new task_t()), make_ptask(f));
+		}
+
+		template<class F>
+		std::future<typename std::result_of<F()>::type> submit(F f, const mem_access& a1)
+		{
+			task_ptr t(new task_t());
+			add_access(*t, a1);
+			return record(t, make_ptask(f));
+		}
+
+		template<class F>
+		std::future<typename std::result_of<F()>::type> submit(F f,
+				const mem_access& a1, const mem_access& a2)
+		{
+			task_ptr t(new task_t());
+			add_access(*t, a1);
+			add_access(*t, a2);
+			return record(t, make_ptask(f));
+		}
+
+		/**
+		 * Waits until all recorded statements are finished. Errors
+		 * are reported through the futures of the statements.
+		 *
+		 * Note: must not be called from within a task of this context.
+		 */
+		void sync()
+		{
+			std::unique_lock<std::mutex> lock(m_mut);
+			m_cv.wait(lock, [this]() { return m_nunfinished == 0; });
+			m_live.clear();
+		}
+
+		/**
+		 * The number of recorded statements that are not yet finished.
+		 */
+		index_t num_pending() const
+		{
+			std::lock_guard<std::mutex> lock(m_mut);
+			return m_nunfinished;
+		}
+
+	private:
+		template<class F>
+		static std::shared_ptr<std::packaged_task<typename std::result_of<F()>::type()> >
+		make_ptask(F f)
+		{
+			typedef typename std::result_of<F()>::type R;
+			return std::shared_ptr<std::packaged_task<R()> >(new std::packaged_task<R()>(f));
+		}
+
+		static void add_access(task_t& t, const mem_access& a)
+		{
+			std::vector<mem_range>& rs = a.is_write() ? t.wr : t.rd;
+			rs.insert(rs.end(), a.ranges().begin(), a.ranges().end());
+		}
+
+		template<typename R>
+		std::future<R> record(const task_ptr& t, const std::shared_ptr<std::packaged_task<R()> >& pt)
+		{
+			std::future<R> fut = pt->get_future();
+			t->fun = [pt]() { (*pt)(); };
+
+			{
+				std::lock_guard<std::mutex> lock(m_mut);
+
+				// drop finished tasks, and link to the unfinished ones in conflict
+
+				size_t k = 0;
+				for (size_t i = 0; i < m_live.size(); ++i)
+				{
+					task_t& p = *(m_live[i]);
+					std::lock_guard<std::mutex> plock(p.mut);
+					if (p.done) continue;
+
+					if (t->depends_on(p))
+					{
+						p.succs.push_back(t);
+						++ t->npreds;
+					}
+					m_live[k++] = m_live[i];
+				}
+				m_live.resize(k);
+
+				m_live.push_back(t);
+				++ m_nunfinished;
+			}
+
+			release(t);
+			return fut;
+		}
+
+		void release(const task_ptr& t)
+		{
+			if (--(t->npreds) == 0)
+			{
+				m_pool.post([this, t]() { this->run(t); });
+			}
+		}
+
+		void run(const task_ptr& t)
+		{
+			t->fun();
+			t->fun = nullptr;
+
+			std::vector<task_ptr> succs;
+			{
+				std::lock_guard<std::mutex> lock(t->mut);
+				t->done = true;
+				succs.swap(t->succs);
+			}
+
+			for (size_t i = 0; i < succs.size(); ++i) release(succs[i]);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mut);
+				if (--m_nunfinished == 0) m_cv.notify_all();
+			}
+		}
+
+	private:
+		thread_pool& m_pool;
+
+		mutable std::mutex m_mut;
+		std::condition_variable m_cv;
+		std::vector<task_ptr> m_live;	// recorded, and possibly unfinished
+		index_t m_nunfinished;
+	};
+
+}
+
+#endif
@@ -0,0 +1,205 @@
+/**
+ * @file thread_pool.h
+ *
+ * @brief A work-stealing thread pool
+ *
+ * Each worker owns a task deque. A task posted from a worker goes
+ * to the back of its own deque, and the worker takes tasks from
+ * the back (LIFO, which keeps the data of a freshly released
+ * successor in cache). Idle workers steal from the front of the
+ * other deques. Tasks posted from outside the pool are spread over
+ * the deques in a round-robin manner.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_THREAD_POOL_H_
+#define LIGHTMAT_THREAD_POOL_H_
+
+#include <light_mat/common/prim_types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lmat
+{
+	class thread_pool : private noncopyable
+	{
+	public:
+		typedef std::function<void()> task_type;
+
+	private:
+		struct task_queue
+		{
+			std::mutex mut;
+			std::deque<task_type> tasks;
+		};
+
+		struct worker_id
+		{
+			const thread_pool *pool;
+			index_t index;
+		};
+
+	public:
+		/**
+		 * Constructs a pool with n workers (0: one per hardware thread).
+		 */
+		explicit thread_pool(index_t n = 0)
+		: m_nqueued(0), m_next(0), m_stop(false)
+		{
+			if (n <= 0)
+			{
+				n = (index_t)std::thread::hardware_concurrency();
+				if (n <= 0) n = 1;
+			}
+
+			for (index_t i = 0; i < n; ++i)
+				m_queues.push_back(std::unique_ptr<task_queue>(new task_queue()));
+
+			for (index_t i = 0; i < n; ++i)
+				m_threads.push_back(std::thread(&thread_pool::run, this, i));
+		}
+
+		/**
+		 * Finishes all posted tasks and joins the workers.
+		 */
+		~thread_pool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mut);
+				m_stop = true;
+			}
+			m_cv.notify_all();
+
+			for (size_t i = 0; i < m_threads.size(); ++i) m_threads[i].join();
+		}
+
+		index_t nthreads() const
+		{
+			return (index_t)m_threads.size();
+		}
+
+		/**
+		 * Whether the calling thread is a worker of this pool.
+		 */
+		bool in_worker() const
+		{
+			return current().pool == this;
+		}
+
+		void post(task_type t)
+		{
+			const index_t nq = (index_t)m_queues.size();
+			const worker_id& w = current();
+
+			index_t i = w.pool == this ? w.index :
+					(index_t)(m_next.fetch_add(1, std::memory_order_relaxed) % (unsigned)nq);
+
+			{
+				std::lock_guard<std::mutex> lock(m_queues[i]->mut);
+				m_queues[i]->tasks.push_back(std::move(t));
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mut);
+				++ m_nqueued;
+			}
+			m_cv.notify_one();
+		}
+
+		/**
+		 * A pool shared by the whole program, with one worker
+		 * per hardware thread, created on first use.
+		 */
+		static thread_pool& global()
+		{
+			static thread_pool pool;
+			return pool;
+		}
+
+	private:
+		static worker_id& current()
+		{
+			static thread_local worker_id w = { nullptr, 0 };
+			return w;
+		}
+
+		bool pop_local(index_t i, task_type& t)
+		{
+			task_queue& q = *(m_queues[i]);
+			std::lock_guard<std::mutex> lock(q.mut);
+			if (q.tasks.empty()) return false;
+
+			t = std::move(q.tasks.back());
+			q.tasks.pop_back();
+			return true;
+		}
+
+		bool steal(index_t i, task_type& t)
+		{
+			const index_t nq = (index_t)m_queues.size();
+			for (index_t k = 1; k < nq; ++k)
+			{
+				task_queue& q = *(m_queues[(i + k) % nq]);
+				std::lock_guard<std::mutex> lock(q.mut);
+				if (!q.tasks.empty())
+				{
+					t = std::move(q.tasks.front());
+					q.tasks.pop_front();
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void run(index_t i)
+		{
+			worker_id& w = current();
+			w.pool = this;
+			w.index = i;
+
+			task_type t;
+			for(;;)
+			{
+				if (pop_local(i, t) || steal(i, t))
+				{
+					{
+						std::lock_guard<std::mutex> lock(m_mut);
+						-- m_nqueued;
+					}
+					t();
+					t = nullptr;
+				}
+				else
+				{
+					std::unique_lock<std::mutex> lock(m_mut);
+					m_cv.wait(lock, [this]() { return m_stop || m_nqueued > 0; });
+					if (m_stop && m_nqueued == 0) return;
+				}
+			}
+		}
+
+	private:
+		std::vector<std::unique_ptr<task_queue> > m_queues;
+		std::vector<std::thread> m_threads;
+
+		std::mutex m_mut;
+		std::condition_variable m_cv;
+		index_t m_nqueued;		// posted, but not yet taken by a worker
+		std::atomic<unsigned> m_next;
+		bool m_stop;
+	};
+}
+
+#endif
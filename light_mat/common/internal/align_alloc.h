@@ -18,6 +18,12 @@
 
 #if LIGHTMAT_PLATFORM == LIGHTMAT_POSIX
 #include <stdlib.h>
+#if defined(__linux__)
+#define LMAT_HAS_LINUX_HUGEPAGE
+#include <stdint.h>
+#include <cstdio>
+#include <sys/mman.h>
+#endif
 #elif LIGHTMAT_PLATFORM == LIGHTMAT_WIN32
 #include <malloc.h>
 #endif
@@ -65,6 +71,144 @@ namespace lmat { namespace internal {
 #endif
 
 
+	/********************************************
+	 *
+	 *  huge-page allocation
+	 *
+	 *  Blocks are mapped on their own, 2 MB aligned
+	 *  and rounded up to whole huge pages:
+	 *
+	 *  - with hugetlb, MAP_HUGETLB is tried first,
+	 *    which succeeds only if the system has a
+	 *    reserved pool of huge pages;
+	 *  - otherwise (or if that fails), a regular
+	 *    mapping is advised with MADV_HUGEPAGE, so
+	 *    that transparent huge pages back it when
+	 *    the kernel can provide them.
+	 *
+	 *  hugepage_release must be given the same
+	 *  size as the allocation.
+	 *
+	 ********************************************/
+
+	const size_t hugepage_size = size_t(1) << 21;
+
+	LMAT_ENSURE_INLINE
+	inline size_t hugepage_round(size_t nbytes)
+	{
+		return nbytes == 0 ? hugepage_size :
+				(nbytes + (hugepage_size - 1)) & ~(hugepage_size - 1);
+	}
+
+	// the global policy (see LMAT_HUGEPAGE_THRESHOLD)
+
+	LMAT_ENSURE_INLINE
+	inline bool use_hugepages(size_t nbytes)
+	{
+		const size_t t = (size_t)(LMAT_HUGEPAGE_THRESHOLD);  // 0: off
+		return t > 0 && nbytes >= t;
+	}
+
+#ifdef LMAT_HAS_LINUX_HUGEPAGE
+
+	inline void* hugepage_allocate(size_t nbytes, bool hugetlb)
+	{
+		const size_t len = hugepage_round(nbytes);
+		const int prot = PROT_READ | PROT_WRITE;
+
+#ifdef MAP_HUGETLB
+		if (hugetlb)
+		{
+			void *p = ::mmap(0, len, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (p != MAP_FAILED) return p;
+		}
+#endif
+
+		// map one more huge page, and trim it to an aligned range
+
+		char *q = (char*)::mmap(0, len + hugepage_size, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (q == (char*)MAP_FAILED)
+		{
+			throw std::bad_alloc();
+		}
+
+		char *p = (char*)(((uintptr_t)q + (hugepage_size - 1)) & ~(uintptr_t)(hugepage_size - 1));
+		const size_t head = (size_t)(p - q);
+
+		if (head > 0) ::munmap(q, head);
+		if (head < hugepage_size) ::munmap(p + len, hugepage_size - head);
+
+#ifdef MADV_HUGEPAGE
+		::madvise(p, len, MADV_HUGEPAGE);  // only advisory: regular pages otherwise
+#endif
+		return p;
+	}
+
+	inline void hugepage_release(void *p, size_t nbytes)
+	{
+		::munmap(p, hugepage_round(nbytes));
+	}
+
+	/**
+	 * The number of bytes backed by huge pages in the mapping
+	 * containing p, as reported by /proc/self/smaps.
+	 */
+	inline size_t hugepage_bytes_of(const void *p)
+	{
+		std::FILE *f = std::fopen("/proc/self/smaps", "r");
+		if (!f) return 0;
+
+		const uintptr_t a = (uintptr_t)p;
+		bool in_map = false;
+		bool found = false;
+		size_t kb = 0;
+
+		char line[512];
+		while (std::fgets(line, sizeof(line), f))
+		{
+			unsigned long b, e;
+			unsigned long v;
+
+			if (std::sscanf(line, "%lx-%lx ", &b, &e) == 2)
+			{
+				if (found) break;
+				in_map = (a >= (uintptr_t)b && a < (uintptr_t)e);
+				found = in_map;
+			}
+			else if (in_map)
+			{
+				if (std::sscanf(line, "AnonHugePages: %lu kB", &v) == 1 ||
+					std::sscanf(line, "Private_Hugetlb: %lu kB", &v) == 1 ||
+					std::sscanf(line, "Shared_Hugetlb: %lu kB", &v) == 1)
+				{
+					kb += (size_t)v;
+				}
+			}
+		}
+
+		std::fclose(f);
+		return kb * 1024;
+	}
+
+#else
+
+	inline void* hugepage_allocate(size_t nbytes, bool)
+	{
+		return aligned_allocate(hugepage_round(nbytes), (unsigned int)hugepage_size);
+	}
+
+	inline void hugepage_release(void *p, size_t)
+	{
+		aligned_release(p);
+	}
+
+	inline size_t hugepage_bytes_of(const void *)
+	{
+		return 0;
+	}
+
+#endif
+
 } }
 
 #endif /* ALIGN_ALLOC_H_ */
@@ -77,16 +77,25 @@ namespace lmat
     		return std::numeric_limits<size_type>::max() / sizeof(value_type);
     	}
 
+    	// very large blocks go to huge pages (see LMAT_HUGEPAGE_THRESHOLD)
+
     	LMAT_ENSURE_INLINE
     	pointer allocate(size_type n, const void* hint=0)
     	{
-    		return (pointer)internal::aligned_allocate(n * sizeof(value_type), Align);
+    		const size_t nb = n * sizeof(value_type);
+    		return (pointer)(internal::use_hugepages(nb) ?
+    				internal::hugepage_allocate(nb, false) :
+    				internal::aligned_allocate(nb, Align));
     	}
 
     	LMAT_ENSURE_INLINE
-    	void deallocate(pointer p, size_type)
+    	void deallocate(pointer p, size_type n)
     	{
-    		internal::aligned_release(p);
+    		const size_t nb = n * sizeof(value_type);
+    		if (internal::use_hugepages(nb))
+    			internal::hugepage_release(p, nb);
+    		else
+    			internal::aligned_release(p);
     	}
 
     	LMAT_ENSURE_INLINE
@@ -103,6 +112,114 @@ namespace lmat
 
     }; // end class aligned_allocator
 
+
+	/********************************************
+	 *
+	 *  Huge-page allocation
+	 *
+	 ********************************************/
+
+	enum hugepage_mode
+	{
+		hugepage_advise,	// transparent huge pages (MADV_HUGEPAGE)
+		hugepage_tlb		// the reserved pool (MAP_HUGETLB) if available,
+							// transparent huge pages otherwise
+	};
+
+    template<typename T, hugepage_mode Mode=hugepage_advise>
+    class hugepage_allocator
+    {
+    public:
+    	typedef T value_type;
+    	typedef T* pointer;
+    	typedef T& reference;
+    	typedef const T* const_pointer;
+    	typedef const T& const_reference;
+    	typedef size_t size_type;
+    	typedef ptrdiff_t difference_type;
+
+    	template<typename TOther>
+    	struct rebind
+    	{
+    		typedef hugepage_allocator<TOther, Mode> other;
+    	};
+
+    public:
+    	LMAT_ENSURE_INLINE
+    	hugepage_allocator() { }
+
+    	template<typename U>
+    	LMAT_ENSURE_INLINE
+    	hugepage_allocator(const hugepage_allocator<U, Mode>& r) { }
+
+    	LMAT_ENSURE_INLINE
+    	unsigned int alignment() const
+    	{
+    		return (unsigned int)internal::hugepage_size;
+    	}
+
+    	LMAT_ENSURE_INLINE
+    	pointer address( reference x ) const
+    	{
+    		return &x;
+    	}
+
+    	LMAT_ENSURE_INLINE
+    	const_pointer address( const_reference x ) const
+    	{
+    		return &x;
+    	}
+
+    	LMAT_ENSURE_INLINE
+    	size_type max_size() const
+    	{
+    		return std::numeric_limits<size_type>::max() / sizeof(value_type);
+    	}
+
+    	LMAT_ENSURE_INLINE
+    	pointer allocate(size_type n, const void* hint=0)
+    	{
+    		return (pointer)internal::hugepage_allocate(n * sizeof(value_type), Mode == hugepage_tlb);
+    	}
+
+    	LMAT_ENSURE_INLINE
+    	void deallocate(pointer p, size_type n)
+    	{
+    		internal::hugepage_release(p, n * sizeof(value_type));
+    	}
+
+    	LMAT_ENSURE_INLINE
+    	void construct (pointer p, const_reference val)
+    	{
+    		new (p) value_type(val);
+    	}
+
+    	LMAT_ENSURE_INLINE
+    	void destroy (pointer p)
+    	{
+    		p->~value_type();
+    	}
+
+    }; // end class hugepage_allocator
+
+
+    /**
+     * The number of bytes backed by huge pages in the memory
+     * mapping that contains p (0 if this cannot be told).
+     *
+     * Transparent huge pages are only given on the first touch,
+     * so this is meaningful after the memory has been written.
+     */
+    inline size_t hugepage_bytes(const void *p)
+    {
+    	return internal::hugepage_bytes_of(p);
+    }
+
+    inline bool on_hugepages(const void *p)
+    {
+    	return hugepage_bytes(p) > 0;
+    }
+
 }
 
 
@@ -16,6 +16,7 @@
 #include <light_mat/common/basic_defs.h>
 #include <cstring>
 #include <iterator>
+#include <type_traits>
 
 namespace lmat
 {
@@ -169,18 +170,35 @@ namespace lmat
 
 	// copy
 
-	template<typename T>
+	template<typename SrcIter, typename DstIter>
 	LMAT_ENSURE_INLINE
-	inline void copy_vec(index_t n, const T *a, T *b)
+	inline void copy_vec(index_t n, SrcIter a, DstIter b)
 	{
-		std::memcpy(b, a, nbytes<T>(n));
+		for (index_t i = 0; i < n; ++i) b[i] = a[i];
 	}
 
-	template<typename SrcIter, typename DstIter>
+	namespace internal
+	{
+		template<typename T>
+		LMAT_ENSURE_INLINE
+		inline void copy_vec_(std::true_type, index_t n, const T *a, T *b)
+		{
+			std::memcpy(static_cast<void*>(b), static_cast<const void*>(a), nbytes<T>(n));
+		}
+
+		template<typename T>
+		LMAT_ENSURE_INLINE
+		inline void copy_vec_(std::false_type, index_t n, const T *a, T *b)
+		{
+			for (index_t i = 0; i < n; ++i) b[i] = a[i];
+		}
+	}
+
+	template<typename T>
 	LMAT_ENSURE_INLINE
-	inline void copy_vec(index_t n, SrcIter a, DstIter b)
+	inline void copy_vec(index_t n, const T *a, T *b)
 	{
-		for (index_t i = 0; i < n; ++i) b[i] = a[i];
+		internal::copy_vec_(std::is_trivially_copyable<T>(), n, a, b);
 	}
 
 	// zero & fill
@@ -189,11 +207,31 @@ namespace lmat
 	LMAT_ENSURE_INLINE
 	inline void set_zero_value(T& x) { x = T(0); }
 
+	namespace internal
+	{
+		template<typename T>
+		LMAT_ENSURE_INLINE
+		inline void zero_vec_(std::true_type, index_t n, T *dst)
+		{
+			// trivially copyable (e.g. std::complex<float>): the bytes may be
+			// written directly, and all-zero bytes are a zero value for the
+			// arithmetic types and their complex counterparts
+			std::memset(static_cast<void*>(dst), 0, nbytes<T>(n));
+		}
+
+		template<typename T>
+		LMAT_ENSURE_INLINE
+		inline void zero_vec_(std::false_type, index_t n, T *dst)
+		{
+			for (index_t i = 0; i < n; ++i) dst[i] = T();
+		}
+	}
+
 	template<typename T>
 	LMAT_ENSURE_INLINE
 	inline void zero_vec(index_t n, T *dst)
 	{
-		std::memset(dst, 0, nbytes<T>(n));
+		internal::zero_vec_(std::is_trivially_copyable<T>(), n, dst);
 	}
 
 	template<typename DstIter>
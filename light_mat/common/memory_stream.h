@@ -0,0 +1,253 @@
+/**
+ * @file memory_stream.h
+ *
+ * @brief Memory operations with non-temporal (streaming) stores
+ *
+ * Streaming stores write around the cache hierarchy. When the
+ * destination is much larger than the last-level cache, they
+ * avoid both the read-for-ownership of each destination line
+ * and the eviction of useful data.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_MEMORY_STREAM_H_
+#define LIGHTMAT_MEMORY_STREAM_H_
+
+#include <light_mat/common/memory.h>
+#include <light_mat/simd/simd_arch.h>
+
+#ifdef LMAT_HAS_AVX
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+#include <stdint.h>
+
+namespace lmat
+{
+	/********************************************
+	 *
+	 *  store hints
+	 *
+	 *  auto_:   streaming stores are used when
+	 *           the destination is at least
+	 *           LMAT_STREAM_STORE_THRESHOLD bytes
+	 *  stream_: always use streaming stores
+	 *  cache_:  never use streaming stores
+	 *
+	 ********************************************/
+
+	struct auto_store_ { };
+	struct stream_store_ { };
+	struct cache_store_ { };
+
+	namespace meta
+	{
+		template<typename S> struct is_store_hint : public false_ { };
+
+		template<> struct is_store_hint<auto_store_> : public true_ { };
+		template<> struct is_store_hint<stream_store_> : public true_ { };
+		template<> struct is_store_hint<cache_store_> : public true_ { };
+	}
+
+	LMAT_ENSURE_INLINE
+	inline bool use_stream_store(size_t nbytes)
+	{
+		return nbytes >= (size_t)(LMAT_STREAM_STORE_THRESHOLD);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline bool use_stream_store(auto_store_, size_t nbytes)
+	{
+		return use_stream_store(nbytes);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline bool use_stream_store(stream_store_, size_t )
+	{
+		return true;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline bool use_stream_store(cache_store_, size_t )
+	{
+		return false;
+	}
+
+	// makes preceding streaming stores globally visible
+
+	LMAT_ENSURE_INLINE
+	inline void stream_fence()
+	{
+		_mm_sfence();
+	}
+
+
+	/********************************************
+	 *
+	 *  byte-level streaming kernels
+	 *
+	 ********************************************/
+
+	namespace internal
+	{
+#ifdef LMAT_HAS_AVX
+		const size_t stream_unit = 32;
+
+		LMAT_ENSURE_INLINE
+		inline void _stream_copy_units(size_t nu, const char *src, char *dst)
+		{
+			for (size_t k = 0; k < nu; ++k, src += stream_unit, dst += stream_unit)
+			{
+				_mm256_stream_si256((__m256i*)dst, _mm256_loadu_si256((const __m256i*)src));
+			}
+		}
+
+		LMAT_ENSURE_INLINE
+		inline void _stream_set_units(size_t nu, const char *pat, char *dst)
+		{
+			const __m256i v = _mm256_loadu_si256((const __m256i*)pat);
+			for (size_t k = 0; k < nu; ++k, dst += stream_unit)
+			{
+				_mm256_stream_si256((__m256i*)dst, v);
+			}
+		}
+#else
+		const size_t stream_unit = 16;
+
+		LMAT_ENSURE_INLINE
+		inline void _stream_copy_units(size_t nu, const char *src, char *dst)
+		{
+			for (size_t k = 0; k < nu; ++k, src += stream_unit, dst += stream_unit)
+			{
+				_mm_stream_si128((__m128i*)dst, _mm_loadu_si128((const __m128i*)src));
+			}
+		}
+
+		LMAT_ENSURE_INLINE
+		inline void _stream_set_units(size_t nu, const char *pat, char *dst)
+		{
+			const __m128i v = _mm_loadu_si128((const __m128i*)pat);
+			for (size_t k = 0; k < nu; ++k, dst += stream_unit)
+			{
+				_mm_stream_si128((__m128i*)dst, v);
+			}
+		}
+#endif
+
+		// the number of leading elements to be written with regular
+		// stores before the destination is aligned to stream_unit
+		// (returns n if it can never be aligned)
+
+		template<typename T>
+		LMAT_ENSURE_INLINE
+		inline index_t _stream_head(index_t n, const T *p)
+		{
+			size_t a = (size_t)((uintptr_t)p % stream_unit);
+			if (a == 0) return 0;
+
+			size_t g = stream_unit - a;
+			if (g % sizeof(T) != 0) return n;
+
+			index_t h = (index_t)(g / sizeof(T));
+			return h < n ? h : n;
+		}
+
+		// the following do not issue the fence
+
+		template<typename T>
+		inline void _stream_copy_vec(index_t n, const T *a, T *b)
+		{
+			const index_t h = _stream_head(n, b);
+			copy_vec(h, a, b);
+
+			const size_t nb = nbytes<T>(n - h);
+			const size_t nu = nb / stream_unit;
+			const size_t nm = nu * stream_unit;
+
+			const char *src = (const char*)(a + h);
+			char *dst = (char*)(b + h);
+
+			_stream_copy_units(nu, src, dst);
+			std::memcpy(dst + nm, src + nm, nb - nm);
+		}
+
+		template<typename T>
+		inline void _stream_fill_vec(index_t n, T *p, const T& v)
+		{
+			if (stream_unit % sizeof(T) != 0)
+			{
+				fill_vec(n, p, v);
+				return;
+			}
+
+			const index_t h = _stream_head(n, p);
+			fill_vec(h, p, v);
+
+			const size_t nb = nbytes<T>(n - h);
+			const size_t nu = nb / stream_unit;
+			const index_t nr = (index_t)((nb - nu * stream_unit) / sizeof(T));
+
+			T pat[stream_unit / sizeof(T)];
+			fill_vec((index_t)(stream_unit / sizeof(T)), pat, v);
+
+			T *dst = p + h;
+			_stream_set_units(nu, (const char*)pat, (char*)dst);
+			fill_vec(nr, dst + (n - h - nr), v);
+		}
+
+		template<typename T>
+		inline void _stream_zero_vec(index_t n, T *p)
+		{
+			const index_t h = _stream_head(n, p);
+			zero_vec(h, p);
+
+			const size_t nb = nbytes<T>(n - h);
+			const size_t nu = nb / stream_unit;
+			const size_t nm = nu * stream_unit;
+
+			const char zpat[stream_unit] = {0};
+			char *dst = (char*)(p + h);
+
+			_stream_set_units(nu, zpat, dst);
+			std::memset(dst + nm, 0, nb - nm);
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  streaming vector operations
+	 *
+	 ********************************************/
+
+	template<typename T>
+	inline void stream_copy_vec(index_t n, const T *a, T *b)
+	{
+		internal::_stream_copy_vec(n, a, b);
+		stream_fence();
+	}
+
+	template<typename T>
+	inline void stream_fill_vec(index_t n, T *p, const T& v)
+	{
+		internal::_stream_fill_vec(n, p, v);
+		stream_fence();
+	}
+
+	template<typename T>
+	inline void stream_zero_vec(index_t n, T *p)
+	{
+		internal::_stream_zero_vec(n, p);
+		stream_fence();
+	}
+
+}
+
+#endif /* LIGHTMAT_MEMORY_STREAM_H_ */
@@ -0,0 +1,475 @@
+/**
+ * @file numa.h
+ *
+ * @brief NUMA-aware allocation and column-partitioned first touch
+ *
+ * On Linux, a page is placed on the NUMA node of the thread that
+ * first writes it, unless a memory policy says otherwise. A matrix
+ * initialized by a single thread therefore lives entirely on that
+ * thread's node, and later parallel passes run at remote bandwidth.
+ *
+ * The tools here keep the data local:
+ *
+ * - for_column_slabs (parallel.h) splits the columns of a matrix over
+ *   the threads of an OpenMP team in the same way as the parallel
+ *   evaluators, so that the thread initializing a slab is the thread
+ *   that later processes it.
+ *
+ * - numa_allocator maps the blocks of a page or more on their own, so
+ *   that their pages are fresh, and places them by a policy:
+ *
+ *   numa_first_touch:   pages go where they are first written;
+ *                       dense matrices are initialized in parallel.
+ *   numa_interleave:    pages are interleaved over all nodes.
+ *   numa_bind_columns:  the column slab of each thread is bound to
+ *                       the node of that thread before the first touch.
+ *
+ * On other platforms (or with a single node) the policies reduce to
+ * the parallel first touch.
+ *
+ * numa_allocator uses regular pages only: LMAT_HUGEPAGE_THRESHOLD
+ * applies to aligned_allocator. This is left as a follow-up.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_NUMA_H_
+#define LIGHTMAT_NUMA_H_
+
+#include <light_mat/common/memory.h>
+#include <light_mat/common/memalloc.h>
+#include <light_mat/common/parallel.h>
+
+#if LIGHTMAT_PLATFORM == LIGHTMAT_POSIX && defined(__linux__)
+#define LMAT_HAS_LINUX_NUMA
+#include <cstdio>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace lmat
+{
+	enum numa_policy
+	{
+		numa_first_touch,
+		numa_interleave,
+		numa_bind_columns
+	};
+
+	namespace internal
+	{
+		const size_t numa_page_size = 4096;
+
+		// constants of the Linux memory policy interface
+
+		const int lmat_mpol_bind = 2;
+		const int lmat_mpol_interleave = 3;
+		const unsigned lmat_mpol_mf_move = 1u << 1;
+		const unsigned lmat_mpol_f_node = 1u;
+		const unsigned lmat_mpol_f_addr = 1u << 1;
+
+		inline index_t read_num_nodes()
+		{
+#ifdef LMAT_HAS_LINUX_NUMA
+			// the online node list is like "0" or "0-3" or "0,2-3"
+
+			std::FILE *f = std::fopen("/sys/devices/system/node/online", "r");
+			if (!f) return 1;
+
+			int last = 0, a = 0, b = 0;
+			char sep = 0;
+			while (std::fscanf(f, "%d", &a) == 1)
+			{
+				b = a;
+				if (std::fscanf(f, "%c", &sep) == 1 && sep == '-')
+				{
+					if (std::fscanf(f, "%d", &b) != 1) break;
+					std::fscanf(f, "%c", &sep);
+				}
+				if (b > last) last = b;
+			}
+			std::fclose(f);
+			return (index_t)(last + 1);
+#else
+			return 1;
+#endif
+		}
+
+		// the pages entirely inside [p, p + nbytes)
+
+		inline bool inner_pages(void *p, size_t nbytes, char*& pb, size_t& len)
+		{
+			const size_t a = reinterpret_cast<size_t>(p);
+			const size_t b = (a + numa_page_size - 1) & ~(numa_page_size - 1);
+			const size_t e = (a + nbytes) & ~(numa_page_size - 1);
+
+			if (e <= b) return false;
+			pb = reinterpret_cast<char*>(b);
+			len = e - b;
+			return true;
+		}
+
+		inline bool numa_mbind(void *p, size_t nbytes, int mode, const unsigned long *mask, unsigned long maxnode, unsigned flags)
+		{
+#ifdef LMAT_HAS_LINUX_NUMA
+			char *pb;
+			size_t len;
+			if (!inner_pages(p, nbytes, pb, len)) return false;
+			return ::syscall(SYS_mbind, pb, len, mode, mask, maxnode, flags) == 0;
+#else
+			return false;
+#endif
+		}
+
+		// blocks mapped on their own, rounded up to whole pages, so
+		// that their pages are fresh (not yet placed on any node) and
+		// not shared with other allocations (numa_page_release must
+		// be given the size of the allocation)
+
+		LMAT_ENSURE_INLINE
+		inline size_t numa_page_round(size_t nbytes)
+		{
+			return (nbytes + (numa_page_size - 1)) & ~(numa_page_size - 1);
+		}
+
+#ifdef LMAT_HAS_LINUX_NUMA
+
+		inline void* numa_page_allocate(size_t nbytes, unsigned int alignment)
+		{
+			const size_t len = numa_page_round(nbytes);
+			const size_t extra = alignment > numa_page_size ? (size_t)alignment : 0;
+
+			char *q = (char*)::mmap(0, len + extra, PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (q == (char*)MAP_FAILED)
+			{
+				throw std::bad_alloc();
+			}
+			if (extra == 0) return q;
+
+			// trim the mapping to an aligned range
+
+			char *p = (char*)(((size_t)q + (extra - 1)) & ~(extra - 1));
+			const size_t head = (size_t)(p - q);
+
+			if (head > 0) ::munmap(q, head);
+			if (head < extra) ::munmap(p + len, extra - head);
+			return p;
+		}
+
+		inline void numa_page_release(void *p, size_t nbytes)
+		{
+			::munmap(p, numa_page_round(nbytes));
+		}
+
+#else
+
+		inline void* numa_page_allocate(size_t nbytes, unsigned int alignment)
+		{
+			return aligned_allocate(numa_page_round(nbytes),
+					alignment > numa_page_size ? alignment : (unsigned int)numa_page_size);
+		}
+
+		inline void numa_page_release(void *p, size_t)
+		{
+			aligned_release(p);
+		}
+
+#endif
+	}
+
+
+	/********************************************
+	 *
+	 *  node queries
+	 *
+	 ********************************************/
+
+	/**
+	 * The number of NUMA nodes (1 if unknown).
+	 */
+	inline index_t numa_num_nodes()
+	{
+		static const index_t n = internal::read_num_nodes();
+		return n;
+	}
+
+	/**
+	 * The node of the CPU running the calling thread (0 if unknown).
+	 */
+	inline index_t numa_current_node()
+	{
+#ifdef LMAT_HAS_LINUX_NUMA
+		unsigned cpu = 0, node = 0;
+		if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return (index_t)node;
+#endif
+		return 0;
+	}
+
+	/**
+	 * The node on which the page containing p resides (-1 if unknown).
+	 * Note that a page that has not been touched gets allocated.
+	 */
+	inline index_t numa_node_of(const void *p)
+	{
+#ifdef LMAT_HAS_LINUX_NUMA
+		int node = -1;
+		if (::syscall(SYS_get_mempolicy, &node, nullptr, 0UL, p,
+				(unsigned long)(internal::lmat_mpol_f_node | internal::lmat_mpol_f_addr)) == 0)
+			return (index_t)node;
+#endif
+		return -1;
+	}
+
+	/**
+	 * The policy mode governing the page containing p
+	 * (0: default, 2: bind, 3: interleave; -1 if unknown).
+	 */
+	inline int numa_mode_of(const void *p)
+	{
+#ifdef LMAT_HAS_LINUX_NUMA
+		int mode = -1;
+		if (::syscall(SYS_get_mempolicy, &mode, nullptr, 0UL, p,
+				(unsigned long)internal::lmat_mpol_f_addr) == 0)
+			return mode;
+#endif
+		return -1;
+	}
+
+
+	/********************************************
+	 *
+	 *  page placement
+	 *
+	 *  These apply to the pages entirely inside
+	 *  the given range, and return whether a
+	 *  policy was set.
+	 *
+	 ********************************************/
+
+	inline bool numa_set_interleave(void *p, size_t nbytes)
+	{
+		const index_t nn = numa_num_nodes();
+		const unsigned long nbits = 8 * sizeof(unsigned long);
+
+		unsigned long mask[4] = {0, 0, 0, 0};
+		if (nn > (index_t)(4 * nbits)) return false;
+		for (index_t k = 0; k < nn; ++k) mask[k / nbits] |= 1UL << (k % nbits);
+
+		return internal::numa_mbind(p, nbytes, internal::lmat_mpol_interleave,
+				mask, (unsigned long)(4 * nbits), 0);
+	}
+
+	inline bool numa_bind_to_node(void *p, size_t nbytes, index_t node)
+	{
+		const unsigned long nbits = 8 * sizeof(unsigned long);
+		if (node < 0 || node >= (index_t)(4 * nbits)) return false;
+
+		unsigned long mask[4] = {0, 0, 0, 0};
+		mask[node / nbits] = 1UL << (node % nbits);
+
+		return internal::numa_mbind(p, nbytes, internal::lmat_mpol_bind,
+				mask, (unsigned long)(4 * nbits), internal::lmat_mpol_mf_move);
+	}
+
+
+	/********************************************
+	 *
+	 *  column slabs
+	 *
+	 ********************************************/
+
+	namespace internal
+	{
+		inline bool use_parallel_init(index_t n, size_t nbytes)
+		{
+#ifdef _OPENMP
+			return n > 1 && nbytes >= (size_t)(LMAT_PARALLEL_INIT_THRESHOLD);
+#else
+			return false;
+#endif
+		}
+
+		template<typename T>
+		inline void apply_part(zero_t, index_t i, index_t len, T *p)
+		{
+			zero_vec(len, p + i);
+		}
+
+		template<typename U, typename T>
+		inline void apply_part(const fill_t<U>& op, index_t i, index_t len, T *p)
+		{
+			fill_vec(len, p + i, op.value());
+		}
+
+		template<typename U, typename T>
+		inline void apply_part(const copy_t<U>& op, index_t i, index_t len, T *p)
+		{
+			copy_vec(len, op.source() + i, p + i);
+		}
+
+		/**
+		 * Applies a memory setter to m x n contiguous columns, by
+		 * column slabs in parallel when they are large enough.
+		 */
+		template<class Setter, typename T>
+		inline void apply_by_columns(const IMemorySetter<Setter>& setter, index_t m, index_t n, T *p)
+		{
+			const Setter& s = setter.derived();
+
+			if (use_parallel_init(n, nbytes<T>(m * n)))
+			{
+				for_column_slabs(n, [&s, m, p](index_t j0, index_t nj)
+				{
+					apply_part(s, j0 * m, nj * m, p);
+				});
+			}
+			else
+			{
+				apply(s, m * n, p);
+			}
+		}
+
+		/**
+		 * Binds the column slab of each thread to its node.
+		 */
+		template<typename T>
+		inline void numa_bind_column_slabs(T *p, index_t m, index_t n)
+		{
+			for_column_slabs(n, [p, m](index_t j0, index_t nj)
+			{
+				numa_bind_to_node(p + j0 * m, nbytes<T>(nj * m), numa_current_node());
+			});
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  NUMA-aware allocator
+	 *
+	 ********************************************/
+
+	template<typename T, numa_policy Policy=numa_first_touch, unsigned int Align=LMAT_DEFAULT_ALIGNMENT>
+	class numa_allocator
+	{
+	public:
+		typedef T value_type;
+		typedef T* pointer;
+		typedef T& reference;
+		typedef const T* const_pointer;
+		typedef const T& const_reference;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+
+		static const numa_policy policy = Policy;
+
+		template<typename TOther>
+		struct rebind
+		{
+			typedef numa_allocator<TOther, Policy, Align> other;
+		};
+
+	public:
+		LMAT_ENSURE_INLINE
+		numa_allocator() { }
+
+		template<typename U>
+		LMAT_ENSURE_INLINE
+		numa_allocator(const numa_allocator<U, Policy, Align>& r) { }
+
+		LMAT_ENSURE_INLINE
+		unsigned int alignment() const
+		{
+			return Align;
+		}
+
+		LMAT_ENSURE_INLINE
+		size_type max_size() const
+		{
+			return std::numeric_limits<size_type>::max() / sizeof(value_type);
+		}
+
+		// blocks of a page or more are mapped on their own: their pages
+		// are not yet placed (so that a policy applies to all of them),
+		// and not shared with other allocations
+
+		pointer allocate(size_type n, const void* hint=0)
+		{
+			const size_t nb = n * sizeof(value_type);
+			if (nb < internal::numa_page_size)
+				return (pointer)internal::aligned_allocate(nb, Align);
+
+			void *p = internal::numa_page_allocate(nb, Align);
+
+			if (Policy == numa_interleave && numa_num_nodes() > 1)
+				numa_set_interleave(p, nb);
+
+			return (pointer)p;
+		}
+
+		LMAT_ENSURE_INLINE
+		void deallocate(pointer p, size_type n)
+		{
+			const size_t nb = n * sizeof(value_type);
+			if (nb < internal::numa_page_size)
+				internal::aligned_release(p);
+			else
+				internal::numa_page_release(p, nb);
+		}
+
+		LMAT_ENSURE_INLINE
+		void construct (pointer p, const_reference val)
+		{
+			new (p) value_type(val);
+		}
+
+		LMAT_ENSURE_INLINE
+		void destroy (pointer p)
+		{
+			p->~value_type();
+		}
+
+	}; // end class numa_allocator
+
+
+	/**
+	 * How the memory from an allocator is placed.
+	 *
+	 * - first_touch:  whether a dense matrix touches newly
+	 *                 allocated memory in parallel on construction.
+	 * - prepare:      called on newly allocated m x n columns
+	 *                 before they are touched.
+	 */
+	template<class Allocator>
+	struct allocator_placement
+	{
+		static const bool first_touch = false;
+
+		template<typename T>
+		static void prepare(T *, index_t, index_t) { }
+	};
+
+	template<typename T, numa_policy Policy, unsigned int Align>
+	struct allocator_placement<numa_allocator<T, Policy, Align> >
+	{
+		static const bool first_touch = true;
+
+		static void prepare(T *p, index_t m, index_t n)
+		{
+			if (Policy == numa_bind_columns && numa_num_nodes() > 1 &&
+					internal::use_parallel_init(n, nbytes<T>(m * n)))
+			{
+				internal::numa_bind_column_slabs(p, m, n);
+			}
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file parallel.h
+ *
+ * @brief Static partition of columns (or elements) over threads
+ *
+ * The partition is the one of an OpenMP static schedule
+ * (#pragma omp parallel for), so that code splitting the work by
+ * hand gives each thread the same part as the parallel evaluators.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_PARALLEL_H_
+#define LIGHTMAT_PARALLEL_H_
+
+#include <light_mat/common/prim_types.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace lmat { namespace internal {
+
+	/**
+	 * The columns [j0, j0 + nj) of thread t among nt threads, as
+	 * assigned by a static schedule (the first n % nt threads take
+	 * one more column).
+	 */
+	inline void static_column_slab(index_t n, index_t nt, index_t t, index_t& j0, index_t& nj)
+	{
+		const index_t q = n / nt;
+		const index_t r = n % nt;
+
+		nj = q + (t < r ? 1 : 0);
+		j0 = t * q + (t < r ? t : r);
+	}
+
+	/**
+	 * Calls f(j0, nj) on the column slab of each thread of a team
+	 * (on all n columns without OpenMP).
+	 */
+	template<class F>
+	inline void for_column_slabs(index_t n, F f)
+	{
+#ifdef _OPENMP
+#pragma omp parallel
+		{
+			index_t j0, nj;
+			static_column_slab(n, (index_t)omp_get_num_threads(), (index_t)omp_get_thread_num(), j0, nj);
+			if (nj > 0) f(j0, nj);
+		}
+#else
+		f(0, n);
+#endif
+	}
+
+} }
+
+#endif
@@ -24,6 +24,14 @@
 #define LMAT_ENABLE_DIM_CHECKING
 #endif
 
+// With LMAT_USE_RUNTIME_DISPATCH (and the ISA variants in
+// src/dispatch linked in), the regular engines route
+// suitable calls to the variant selected at run time. The variants
+// themselves define LMAT_DISPATCH_VARIANT and are never routed.
+
+#if defined(LMAT_USE_RUNTIME_DISPATCH) && !defined(LMAT_DISPATCH_VARIANT)
+#define LMAT_DISPATCH_ENGINES
+#endif
 
 #endif
 
@@ -21,4 +21,45 @@
 
 #define LMAT_DEFAULT_ALIGNMENT 16
 
+// destinations of at least this many bytes are written
+// with non-temporal (streaming) stores by default
+
+#ifndef LMAT_STREAM_STORE_THRESHOLD
+#define LMAT_STREAM_STORE_THRESHOLD (1 << 24)
+#endif
+
+// with OpenMP, matrices of at least this many bytes are
+// filled, copied and first touched by all threads, each
+// on its own slab of columns
+
+#ifndef LMAT_PARALLEL_INIT_THRESHOLD
+#define LMAT_PARALLEL_INIT_THRESHOLD (1 << 22)
+#endif
+
+// with OpenMP, text files of at least this many bytes
+// are parsed (and written) by all threads
+
+#ifndef LMAT_PARALLEL_IO_THRESHOLD
+#define LMAT_PARALLEL_IO_THRESHOLD (1 << 20)
+#endif
+
+// blocks of at least this many bytes from aligned_allocator
+// are mapped on 2 MB aligned, huge-page advised memory.
+// This is off (0) by default; to turn it on, define it before
+// including any light_mat header, or on the compiler's command
+// line, e.g. -DLMAT_HUGEPAGE_THRESHOLD=67108864 (64 MB).
+// (hugepage_allocator uses huge pages regardless of this.)
+
+#ifndef LMAT_HUGEPAGE_THRESHOLD
+#define LMAT_HUGEPAGE_THRESHOLD 0
+#endif
+
+// with LMAT_USE_RUNTIME_DISPATCH, the regular engines route
+// operations on at least this many elements to the kernels
+// of the variant selected at run time (see light_mat/dispatch)
+
+#ifndef LMAT_DISPATCH_MIN_ELEMS
+#define LMAT_DISPATCH_MIN_ELEMS 512
+#endif
+
 #endif 
@@ -0,0 +1,159 @@
+/**
+ * @file dispatch.h
+ *
+ * @brief Run-time dispatch of heavy kernels to the best ISA variant
+ *
+ * The regular engines pick the SIMD kind when they are compiled
+ * (see default_simd_kind). The kernels here are compiled once per
+ * instruction set (src/dispatch/kernels_*.cpp, each with its
+ * own flags), and the variant is chosen once at run time,
+ * according to runtime_simd_level(). So a conservative (e.g. SSE2)
+ * build still runs the AVX/AVX2 code on processors that have it.
+ *
+ * Set the environment variable LMAT_SIMD_ISA (sse2, avx, or avx2)
+ * to force a lower variant, e.g. for benchmarking.
+ *
+ * The functions here call the kernels explicitly. With
+ * LMAT_USE_RUNTIME_DISPATCH, the regular engines also route a
+ * limited set of calls to them (listed in dispatch_route.h).
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_DISPATCH_H_
+#define LIGHTMAT_DISPATCH_H_
+
+#include <light_mat/matrix/matrix_concepts.h>
+#include <light_mat/matrix/matrix_properties.h>
+#include <light_mat/random/philox.h>
+#include <light_mat/random/rand_expr.h>
+#include <light_mat/dispatch/dispatch_table.h>
+
+#include <limits>
+
+namespace lmat { namespace dispatch {
+
+	/********************************************
+	 *
+	 *  entry points on contiguous matrices
+	 *
+	 ********************************************/
+
+#define LMAT_DISPATCH_CHECK_CONT(Ty) \
+	static_assert( meta::is_contiguous<Ty>::value, #Ty " must be contiguous.");
+
+	// element-wise
+
+#define LMAT_DEFINE_DISPATCHED_BINARY_EWISE( Name ) \
+	template<typename T, class A, class B, class D> \
+	inline void Name(const IRegularMatrix<A, T>& a, const IRegularMatrix<B, T>& b, IRegularMatrix<D, T>& r) { \
+		LMAT_DISPATCH_CHECK_CONT(A) \
+		LMAT_DISPATCH_CHECK_CONT(B) \
+		LMAT_DISPATCH_CHECK_CONT(D) \
+		LMAT_CHECK_DIMS( have_same_shape(a, b, r) ) \
+		table<T>().Name(a.nelems(), a.ptr_data(), b.ptr_data(), r.ptr_data()); }
+
+	LMAT_DEFINE_DISPATCHED_BINARY_EWISE( add )
+	LMAT_DEFINE_DISPATCHED_BINARY_EWISE( sub )
+	LMAT_DEFINE_DISPATCHED_BINARY_EWISE( mul )
+	LMAT_DEFINE_DISPATCHED_BINARY_EWISE( div )
+
+	template<typename T, class X, class Y>
+	inline void axpy(const T& alpha, const IRegularMatrix<X, T>& x, IRegularMatrix<Y, T>& y)
+	{
+		LMAT_DISPATCH_CHECK_CONT(X)
+		LMAT_DISPATCH_CHECK_CONT(Y)
+		LMAT_CHECK_DIMS( have_same_shape(x, y) )
+
+		table<T>().axpy(x.nelems(), alpha, x.ptr_data(), y.ptr_data());
+	}
+
+	// reduction
+
+#define LMAT_DEFINE_DISPATCHED_FULL_REDUCTION( Name, EmptyVal ) \
+	template<typename T, class A> \
+	inline T Name(const IRegularMatrix<A, T>& a) { \
+		LMAT_DISPATCH_CHECK_CONT(A) \
+		return a.nelems() > 0 ? table<T>().Name(a.nelems(), a.ptr_data()) : EmptyVal; }
+
+	LMAT_DEFINE_DISPATCHED_FULL_REDUCTION( sum, T(0) )
+	LMAT_DEFINE_DISPATCHED_FULL_REDUCTION( maximum, -std::numeric_limits<T>::infinity() )
+	LMAT_DEFINE_DISPATCHED_FULL_REDUCTION( minimum, std::numeric_limits<T>::infinity() )
+
+	template<typename T, class A, class B>
+	inline T dot(const IRegularMatrix<A, T>& a, const IRegularMatrix<B, T>& b)
+	{
+		LMAT_DISPATCH_CHECK_CONT(A)
+		LMAT_DISPATCH_CHECK_CONT(B)
+		LMAT_CHECK_DIMS( have_same_shape(a, b) )
+
+		return a.nelems() > 0 ? table<T>().dot(a.nelems(), a.ptr_data(), b.ptr_data()) : T(0);
+	}
+
+	// memory
+
+	template<typename T, class A, class B>
+	inline void copy(const IRegularMatrix<A, T>& a, IRegularMatrix<B, T>& b)
+	{
+		LMAT_DISPATCH_CHECK_CONT(A)
+		LMAT_DISPATCH_CHECK_CONT(B)
+		LMAT_CHECK_DIMS( have_same_shape(a, b) )
+
+		table<T>().copy(a.nelems(), a.ptr_data(), b.ptr_data());
+	}
+
+	template<typename T, class A>
+	inline void fill(IRegularMatrix<A, T>& a, const T& v)
+	{
+		LMAT_DISPATCH_CHECK_CONT(A)
+		table<T>().fill(a.nelems(), a.ptr_data(), v);
+	}
+
+	// algorithms
+
+	template<typename T, class A>
+	inline void sort(IRegularMatrix<A, T>& a)  // sorts all elements in ascending order
+	{
+		LMAT_DISPATCH_CHECK_CONT(A)
+		table<T>().sort(a.nelems(), a.ptr_data());
+	}
+
+	template<typename T, class A, class B>
+	inline void transpose(const IRegularMatrix<A, T>& a, IRegularMatrix<B, T>& b)
+	{
+		LMAT_DISPATCH_CHECK_CONT(A)
+		LMAT_DISPATCH_CHECK_CONT(B)
+		LMAT_CHECK_DIMS( b.nrows() == a.ncolumns() && b.ncolumns() == a.nrows() )
+
+		table<T>().transpose(a.nrows(), a.ncolumns(), a.ptr_data(), b.ptr_data());
+	}
+
+	// random (the same values as rand_mat(std_uniform_real_distr<T>(), rs, m, n),
+	// with each column from its own window of the stream)
+
+	template<typename T, class A>
+	inline void randu(IRegularMatrix<A, T>& a, random::philox4x32_stream& rs)
+	{
+		LMAT_DISPATCH_CHECK_CONT(A)
+
+		const index_t m = a.nrows();
+		const index_t n = a.ncolumns();
+		const uint32_t *key = rs.engine().key();
+		const uint64_t seed = (uint64_t)key[0] | ((uint64_t)key[1] << 32);
+		const uint64_t span = internal::rand_column_span;
+		const uint64_t p0 = rs.position();
+
+		for (index_t j = 0; j < n; ++j)
+		{
+			table<T>().randu(m, a.ptr_data() + j * m, seed, rs.stream_id(), p0 + (uint64_t)j * span);
+		}
+		rs.seek(p0 + (uint64_t)n * span);
+	}
+
+} }
+
+#endif
@@ -0,0 +1,402 @@
+/**
+ * @file dispatch_route.h
+ *
+ * @brief Routing of the regular engines to the dispatched kernels
+ *
+ * With LMAT_USE_RUNTIME_DISPATCH, some entry points of the
+ * regular engines first try to route the call to the kernels of
+ * the variant selected at run time:
+ *
+ *  - evaluate(map_expr) of a single binary + - * / on two
+ *    matrices (not a scalar, and no nested expression),
+ *  - sum, maximum, minimum and dot (full reductions),
+ *  - copy and fill (unless the matrix is initialized in
+ *    parallel, see numa.h),
+ *  - sort (of all elements, in ascending order) and transpose, and
+ *  - uniform reals from a philox4x32_stream (rand_mat).
+ *
+ * A call is routed when the value type is float or double, all
+ * operands are contiguous regular matrices whose sizes are not
+ * fixed at compile time, and there are at least
+ * LMAT_DISPATCH_MIN_ELEMS elements. Everything else (other
+ * functions, nested expressions, column-wise reductions, strided
+ * views, fixed-size matrices, ...) runs the regular engine, that
+ * is, with the instruction set the program is compiled for.
+ * Without LMAT_USE_RUNTIME_DISPATCH the routes are empty.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_DISPATCH_ROUTE_H_
+#define LIGHTMAT_DISPATCH_ROUTE_H_
+
+#include <light_mat/config/config.h>
+
+#ifdef LMAT_DISPATCH_ENGINES
+
+#include <light_mat/matrix/matrix_properties.h>
+#include <light_mat/common/numa.h>
+#include <light_mat/math/fun_tags.h>
+#include <light_mat/random/rand_stream.h>
+#include <light_mat/dispatch/dispatch_table.h>
+
+namespace lmat
+{
+	template<typename... Args> class map_expr;
+
+	namespace random
+	{
+		template<typename T> class std_uniform_real_distr;
+	}
+}
+
+namespace lmat { namespace dispatch {
+
+	/********************************************
+	 *
+	 *  conditions
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct is_dispatched_type : public meta::false_ { };
+
+	template<> struct is_dispatched_type<float> : public meta::true_ { };
+	template<> struct is_dispatched_type<double> : public meta::true_ { };
+
+	template<class Mat, bool IsRegular=meta::is_regular_mat<Mat>::value>
+	struct is_dispatched_operand : public meta::false_ { };
+
+	template<class Mat>
+	struct is_dispatched_operand<Mat, true>
+	{
+		static const bool value =
+				is_dispatched_type<typename matrix_traits<Mat>::value_type>::value &&
+				meta::is_contiguous<Mat>::value &&
+				meta::nelems<Mat>::value == 0;
+	};
+
+	template<class... Mats>
+	struct routes : public meta::all_<is_dispatched_operand<Mats>...> { };
+
+	LMAT_ENSURE_INLINE
+	inline bool routes_size(index_t n)
+	{
+		return n >= LMAT_DISPATCH_MIN_ELEMS;
+	}
+
+
+	/********************************************
+	 *
+	 *  element-wise: r = a op b
+	 *
+	 ********************************************/
+
+	template<typename FTag> struct ewise_slot;
+
+	template<> struct ewise_slot<ftags::add_>
+	{
+		template<typename T>
+		static void run(index_t n, const T *a, const T *b, T *r) { table<T>().add(n, a, b, r); }
+	};
+
+	template<> struct ewise_slot<ftags::sub_>
+	{
+		template<typename T>
+		static void run(index_t n, const T *a, const T *b, T *r) { table<T>().sub(n, a, b, r); }
+	};
+
+	template<> struct ewise_slot<ftags::mul_>
+	{
+		template<typename T>
+		static void run(index_t n, const T *a, const T *b, T *r) { table<T>().mul(n, a, b, r); }
+	};
+
+	template<> struct ewise_slot<ftags::div_>
+	{
+		template<typename T>
+		static void run(index_t n, const T *a, const T *b, T *r) { table<T>().div(n, a, b, r); }
+	};
+
+	template<typename FTag>
+	struct is_dispatched_ewise : public meta::false_ { };
+
+	template<> struct is_dispatched_ewise<ftags::add_> : public meta::true_ { };
+	template<> struct is_dispatched_ewise<ftags::sub_> : public meta::true_ { };
+	template<> struct is_dispatched_ewise<ftags::mul_> : public meta::true_ { };
+	template<> struct is_dispatched_ewise<ftags::div_> : public meta::true_ { };
+
+	template<typename FTag, class A, class B, class D>
+	struct routes_ewise
+	{
+		static const bool value = is_dispatched_ewise<FTag>::value && routes<A, B, D>::value &&
+				std::is_same<typename matrix_traits<A>::value_type, typename matrix_traits<D>::value_type>::value &&
+				std::is_same<typename matrix_traits<B>::value_type, typename matrix_traits<D>::value_type>::value;
+	};
+
+	template<typename FTag, class A, class B, class D>
+	LMAT_ENSURE_INLINE
+	inline bool route_ewise(const map_expr<FTag, A, B>& e, D& r, meta::true_)
+	{
+		if (!routes_size(r.nelems())) return false;
+		ewise_slot<FTag>::run(r.nelems(), e.arg1().ptr_data(), e.arg2().ptr_data(), r.ptr_data());
+		return true;
+	}
+
+	template<typename FTag, class A, class B, class D>
+	LMAT_ENSURE_INLINE
+	inline bool route_ewise(const map_expr<FTag, A, B>& , D& , meta::false_)
+	{
+		return false;
+	}
+
+	template<class E, class D>
+	LMAT_ENSURE_INLINE
+	inline bool route_ewise(const E& , D& )
+	{
+		return false;
+	}
+
+	template<typename FTag, class A, class B, class D>
+	LMAT_ENSURE_INLINE
+	inline bool route_ewise(const map_expr<FTag, A, B>& e, D& r)
+	{
+		return route_ewise(e, r, meta::bool_<routes_ewise<FTag, A, B, D>::value>());
+	}
+
+
+	/********************************************
+	 *
+	 *  full reduction
+	 *
+	 ********************************************/
+
+#define LMAT_DEFINE_REDUCTION_ROUTE( Name ) \
+	template<typename T, class A> \
+	LMAT_ENSURE_INLINE \
+	inline bool route_##Name(T& r, const A& a, meta::true_) { \
+		if (!routes_size(a.nelems())) return false; \
+		r = table<T>().Name(a.nelems(), a.ptr_data()); \
+		return true; } \
+	template<typename T, class A> \
+	LMAT_ENSURE_INLINE \
+	inline bool route_##Name(T& , const A& , meta::false_) { return false; } \
+	template<typename T, class A> \
+	LMAT_ENSURE_INLINE \
+	inline bool route_##Name(T& r, const A& a) { \
+		return route_##Name(r, a, meta::bool_<routes<A>::value>()); }
+
+	LMAT_DEFINE_REDUCTION_ROUTE( sum )
+	LMAT_DEFINE_REDUCTION_ROUTE( maximum )
+	LMAT_DEFINE_REDUCTION_ROUTE( minimum )
+
+	template<typename T, class A, class B>
+	LMAT_ENSURE_INLINE
+	inline bool route_dot(T& r, const A& a, const B& b, meta::true_)
+	{
+		if (!routes_size(a.nelems())) return false;
+		r = table<T>().dot(a.nelems(), a.ptr_data(), b.ptr_data());
+		return true;
+	}
+
+	template<typename T, class A, class B>
+	LMAT_ENSURE_INLINE
+	inline bool route_dot(T& , const A& , const B& , meta::false_)
+	{
+		return false;
+	}
+
+	template<typename T, class A, class B>
+	LMAT_ENSURE_INLINE
+	inline bool route_dot(T& r, const A& a, const B& b)
+	{
+		return route_dot(r, a, b, meta::bool_<routes<A, B>::value>());
+	}
+
+
+	/********************************************
+	 *
+	 *  memory and algorithms
+	 *
+	 ********************************************/
+
+	// copy/fill of the matrices that all threads initialize on
+	// their own column slabs stay with the regular engine (numa.h)
+
+	template<class A>
+	LMAT_ENSURE_INLINE
+	inline bool routes_init(const A& a)
+	{
+		typedef typename matrix_traits<A>::value_type T;
+		return routes_size(a.nelems()) &&
+				!internal::use_parallel_init(a.ncolumns(), nbytes<T>(a.nelems()));
+	}
+
+	template<class A, class B>
+	LMAT_ENSURE_INLINE
+	inline bool route_copy(const A& a, B& b, meta::true_)
+	{
+		if (!routes_init(b)) return false;
+		typedef typename matrix_traits<B>::value_type T;
+		table<T>().copy(b.nelems(), a.ptr_data(), b.ptr_data());
+		return true;
+	}
+
+	template<class A, class B>
+	LMAT_ENSURE_INLINE
+	inline bool route_copy(const A& , B& , meta::false_)
+	{
+		return false;
+	}
+
+	template<class A, class B>
+	LMAT_ENSURE_INLINE
+	inline bool route_copy(const A& a, B& b)
+	{
+		return route_copy(a, b, meta::bool_<routes<A, B>::value>());
+	}
+
+	template<class A, typename T>
+	LMAT_ENSURE_INLINE
+	inline bool route_fill(A& a, const T& v, meta::true_)
+	{
+		if (!routes_init(a)) return false;
+		table<T>().fill(a.nelems(), a.ptr_data(), v);
+		return true;
+	}
+
+	template<class A, typename T>
+	LMAT_ENSURE_INLINE
+	inline bool route_fill(A& , const T& , meta::false_)
+	{
+		return false;
+	}
+
+	template<class A, typename T>
+	LMAT_ENSURE_INLINE
+	inline bool route_fill(A& a, const T& v)
+	{
+		return route_fill(a, v, meta::bool_<routes<A>::value>());
+	}
+
+	template<class A>
+	LMAT_ENSURE_INLINE
+	inline bool route_sort(A& a, meta::true_)
+	{
+		if (!routes_size(a.nelems())) return false;
+		typedef typename matrix_traits<A>::value_type T;
+		table<T>().sort(a.nelems(), a.ptr_data());
+		return true;
+	}
+
+	template<class A>
+	LMAT_ENSURE_INLINE
+	inline bool route_sort(A& , meta::false_)
+	{
+		return false;
+	}
+
+	template<class A>
+	LMAT_ENSURE_INLINE
+	inline bool route_sort(A& a)
+	{
+		return route_sort(a, meta::bool_<routes<A>::value>());
+	}
+
+	template<class A, class B>
+	LMAT_ENSURE_INLINE
+	inline bool route_transpose(const A& a, B& b, meta::true_)
+	{
+		if (!routes_size(a.nelems())) return false;
+		typedef typename matrix_traits<A>::value_type T;
+		table<T>().transpose(a.nrows(), a.ncolumns(), a.ptr_data(), b.ptr_data());
+		return true;
+	}
+
+	template<class A, class B>
+	LMAT_ENSURE_INLINE
+	inline bool route_transpose(const A& , B& , meta::false_)
+	{
+		return false;
+	}
+
+	template<class A, class B>
+	LMAT_ENSURE_INLINE
+	inline bool route_transpose(const A& a, B& b)
+	{
+		return route_transpose(a, b, meta::bool_<routes<A, B>::value>());
+	}
+
+	// uniform reals from philox streams, column by column, each
+	// from its own window of the stream (see counter_rand_evaluate)
+
+	template<typename T, class D, class RS>
+	inline bool route_randu(const random::std_uniform_real_distr<T>& ,
+			RS& rs, D& d, uint64_t span, meta::true_)
+	{
+		if (!routes_size(d.nelems())) return false;
+
+		const index_t m = d.nrows();
+		const index_t n = d.ncolumns();
+		const uint32_t *key = rs.engine().key();
+		const uint64_t seed = (uint64_t)key[0] | ((uint64_t)key[1] << 32);
+		const uint64_t sid = rs.stream_id();
+		const uint64_t p0 = rs.position();
+		T *pd = d.ptr_data();
+
+#ifdef _OPENMP
+#pragma omp parallel for if (d.nelems() >= 16384)
+#endif
+		for (index_t j = 0; j < n; ++j)
+		{
+			table<T>().randu(m, pd + j * m, seed, sid, p0 + (uint64_t)j * span);
+		}
+
+		rs.seek(p0 + (uint64_t)n * span);
+		return true;
+	}
+
+	template<typename T, class D, class RS>
+	LMAT_ENSURE_INLINE
+	inline bool route_randu(const random::std_uniform_real_distr<T>& ,
+			RS& , D& , uint64_t , meta::false_)
+	{
+		return false;
+	}
+
+	template<class Distr, class RS, class D>
+	LMAT_ENSURE_INLINE
+	inline bool route_randu(const Distr& , RS& , D& , uint64_t )
+	{
+		return false;
+	}
+
+	template<typename T, class D>
+	LMAT_ENSURE_INLINE
+	inline bool route_randu(const random::std_uniform_real_distr<T>& distr,
+			random::philox4x32_stream& rs, D& d, uint64_t span)
+	{
+		return route_randu(distr, rs, d, span, meta::bool_<routes<D>::value &&
+				std::is_same<T, typename matrix_traits<D>::value_type>::value>());
+	}
+
+} }
+
+#define LMAT_DISPATCH_ROUTE( Name, ... ) \
+	if (lmat::dispatch::route_##Name(__VA_ARGS__)) return;
+
+#define LMAT_DISPATCH_ROUTE_VALUE( T, Name, ... ) \
+	{ T _r; if (lmat::dispatch::route_##Name(_r, __VA_ARGS__)) return _r; }
+
+#else
+
+#define LMAT_DISPATCH_ROUTE( Name, ... )
+#define LMAT_DISPATCH_ROUTE_VALUE( T, Name, ... )
+
+#endif
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * @file dispatch_table.h
+ *
+ * @brief The tables of kernels exported by the ISA variants
+ *
+ * This header is shared by the variant translation units
+ * (src/dispatch) and the code that selects among them, so
+ * the tables are declared only in terms of primitive types.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_DISPATCH_TABLE_H_
+#define LIGHTMAT_DISPATCH_TABLE_H_
+
+#include <light_mat/common/prim_types.h>
+
+#ifndef LMAT_DISPATCH_VARIANT
+#include <light_mat/simd/cpu_features.h>
+#endif
+
+namespace lmat
+{
+	namespace dispatch
+	{
+		/********************************************
+		 *
+		 *  kernel tables
+		 *
+		 *  All arrays are contiguous, and matrices
+		 *  are column-major.
+		 *
+		 ********************************************/
+
+		template<typename T>
+		struct kernel_table
+		{
+			// element-wise: r = a op b, y += alpha * x
+
+			void (*add)(index_t n, const T *a, const T *b, T *r);
+			void (*sub)(index_t n, const T *a, const T *b, T *r);
+			void (*mul)(index_t n, const T *a, const T *b, T *r);
+			void (*div)(index_t n, const T *a, const T *b, T *r);
+			void (*axpy)(index_t n, T alpha, const T *x, T *y);
+
+			// reduction (n > 0)
+
+			T (*sum)(index_t n, const T *a);
+			T (*dot)(index_t n, const T *a, const T *b);
+			T (*maximum)(index_t n, const T *a);
+			T (*minimum)(index_t n, const T *a);
+
+			// memory
+
+			void (*copy)(index_t n, const T *a, T *b);
+			void (*fill)(index_t n, T *a, T v);
+
+			// algorithms
+
+			void (*sort)(index_t n, T *a);  // ascending
+			void (*transpose)(index_t m, index_t n, const T *a, T *b);  // a: m x n, b: n x m
+
+			// uniform reals in [0, 1), from philox4x32_stream(seed, sid) at pos
+
+			void (*randu)(index_t n, T *a, uint64_t seed, uint64_t sid, uint64_t pos);
+		};
+
+		struct kernel_set
+		{
+			int level;  // the LMAT_SIMD_LEVEL the variant was compiled with
+			kernel_table<float> f32;
+			kernel_table<double> f64;
+		};
+
+
+		// the variants (src/dispatch/kernels_*.cpp), each in a
+		// namespace of its own
+
+		namespace sse2 { const kernel_set& variant_kernels(); }
+		namespace avx  { const kernel_set& variant_kernels(); }
+		namespace avx2 { const kernel_set& variant_kernels(); }
+
+
+#ifndef LMAT_DISPATCH_VARIANT
+
+		/********************************************
+		 *
+		 *  selection (once per process)
+		 *
+		 ********************************************/
+
+		inline const kernel_set& select_kernels(int level)
+		{
+			if (level >= avx2_level) return avx2::variant_kernels();
+			else if (level >= avx_level) return avx::variant_kernels();
+			else return sse2::variant_kernels();
+		}
+
+		inline const kernel_set& kernels()
+		{
+			static const kernel_set& ks = select_kernels(runtime_simd_level());
+			return ks;
+		}
+
+		template<typename T> struct table_of;
+
+		template<> struct table_of<float>
+		{
+			LMAT_ENSURE_INLINE
+			static const kernel_table<float>& get() { return kernels().f32; }
+		};
+
+		template<> struct table_of<double>
+		{
+			LMAT_ENSURE_INLINE
+			static const kernel_table<double>& get() { return kernels().f64; }
+		};
+
+		template<typename T>
+		LMAT_ENSURE_INLINE
+		inline const kernel_table<T>& table()
+		{
+			return table_of<T>::get();
+		}
+
+#endif
+	}
+}
+
+#endif
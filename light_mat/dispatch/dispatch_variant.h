@@ -0,0 +1,334 @@
+/**
+ * @file dispatch_variant.h
+ *
+ * @brief The body of an ISA variant of the dispatched kernels
+ *
+ * A variant is a translation unit (src/dispatch/kernels_*.cpp)
+ * that defines LMAT_DISPATCH_VARIANT, the name of its instruction
+ * set (sse2, avx, or avx2), and then includes this file. It is
+ * compiled with the flags of that instruction set (DISPATCH_*_FLAG
+ * in DetectISA.cmake).
+ *
+ * The only entity a variant exports is
+ *
+ *   lmat::dispatch::<variant>::variant_kernels()
+ *
+ * Everything else it defines has internal linkage, and the kernels
+ * are written on the SIMD packs, whose functions are all forced to
+ * be inlined. Hence, no out-of-line function compiled for one
+ * instruction set can be merged with (or replace) the same function
+ * of another variant, or of the rest of the program. For the same
+ * reason, the variants do not use the regular engines or the
+ * standard algorithms (which are instantiated on shared types).
+ *
+ * @author Dahua Lin
+ */
+
+#ifndef LIGHTMAT_DISPATCH_VARIANT_H_
+#define LIGHTMAT_DISPATCH_VARIANT_H_
+
+#ifndef LMAT_DISPATCH_VARIANT
+#error LMAT_DISPATCH_VARIANT must be defined before including dispatch_variant.h.
+#endif
+
+#include <light_mat/simd/simd.h>
+#include <light_mat/random/philox.h>
+#include <light_mat/random/uniform_real_distr.h>
+#include <light_mat/dispatch/dispatch_table.h>
+
+namespace lmat { namespace dispatch { namespace LMAT_DISPATCH_VARIANT {
+
+	namespace
+	{
+		typedef default_simd_kind kind;
+
+		/********************************************
+		 *
+		 *  sorting (introsort)
+		 *
+		 ********************************************/
+
+		template<typename T>
+		inline void insertion_sort(index_t n, T *a)
+		{
+			for (index_t i = 1; i < n; ++i)
+			{
+				const T v = a[i];
+				index_t j = i;
+				for (; j > 0 && v < a[j - 1]; --j) a[j] = a[j - 1];
+				a[j] = v;
+			}
+		}
+
+		template<typename T>
+		inline void sift_down(index_t i, index_t n, T *a)
+		{
+			const T v = a[i];
+			index_t c;
+			while ((c = 2 * i + 1) < n)
+			{
+				if (c + 1 < n && a[c] < a[c + 1]) ++c;
+				if (!(v < a[c])) break;
+				a[i] = a[c];
+				i = c;
+			}
+			a[i] = v;
+		}
+
+		template<typename T>
+		inline void heap_sort(index_t n, T *a)
+		{
+			for (index_t i = n / 2; i > 0; --i) sift_down(i - 1, n, a);
+			for (index_t k = n - 1; k > 0; --k)
+			{
+				const T t = a[0]; a[0] = a[k]; a[k] = t;
+				sift_down(0, k, a);
+			}
+		}
+
+		template<typename T>
+		void intro_sort(index_t n, T *a, int depth)
+		{
+			while (n > 16)
+			{
+				if (depth-- == 0)
+				{
+					heap_sort(n, a);
+					return;
+				}
+
+				// the median of three is neither the least nor the greatest
+				// (unless tied), so both parts are non-empty
+
+				const T x = a[0], y = a[n / 2], z = a[n - 1];
+				const T p = x < y ?
+						(y < z ? y : (x < z ? z : x)) :
+						(x < z ? x : (y < z ? z : y));
+
+				index_t i = -1, j = n;
+				for(;;)
+				{
+					do ++i; while (a[i] < p);
+					do --j; while (p < a[j]);
+					if (i >= j) break;
+					const T t = a[i]; a[i] = a[j]; a[j] = t;
+				}
+
+				// recurse into the smaller part
+
+				const index_t nl = j + 1;
+				if (nl < n - nl)
+				{
+					intro_sort(nl, a, depth);
+					a += nl;
+					n -= nl;
+				}
+				else
+				{
+					intro_sort(n - nl, a + nl, depth);
+					n = nl;
+				}
+			}
+
+			insertion_sort(n, a);
+		}
+
+
+		/********************************************
+		 *
+		 *  random streams
+		 *
+		 *  Of a type of the variant's own, so that
+		 *  the stream is instantiated here
+		 *
+		 ********************************************/
+
+		struct variant_philox : public random::philox4x32_engine
+		{
+			explicit variant_philox(uint64_t seed)
+			: random::philox4x32_engine(seed) { }
+		};
+
+		typedef random::counter_rand_stream<variant_philox> variant_stream;
+
+
+		/********************************************
+		 *
+		 *  kernels
+		 *
+		 ********************************************/
+
+		template<typename T>
+		struct variant_kernels_of
+		{
+			typedef simd_pack<T, kind> pack_t;
+			static const index_t W = static_cast<index_t>(simd_traits<T, kind>::pack_width);
+
+			static index_t maj(index_t n)  // the length covered by whole packs
+			{
+				return n - n % W;
+			}
+
+#define LMAT_DEFINE_VARIANT_BINARY_EWISE( Name, Op ) \
+			static void Name(index_t n, const T *a, const T *b, T *r) { \
+				const index_t m = maj(n); \
+				for (index_t i = 0; i < m; i += W) (pack_t(a + i) Op pack_t(b + i)).store_u(r + i); \
+				for (index_t i = m; i < n; ++i) r[i] = a[i] Op b[i]; }
+
+			LMAT_DEFINE_VARIANT_BINARY_EWISE( add, + )
+			LMAT_DEFINE_VARIANT_BINARY_EWISE( sub, - )
+			LMAT_DEFINE_VARIANT_BINARY_EWISE( mul, * )
+			LMAT_DEFINE_VARIANT_BINARY_EWISE( div, / )
+
+#undef LMAT_DEFINE_VARIANT_BINARY_EWISE
+
+			static void axpy(index_t n, T alpha, const T *x, T *y)
+			{
+				const index_t m = maj(n);
+				const pack_t alpha_pk(alpha);
+				for (index_t i = 0; i < m; i += W)
+					math::fma(alpha_pk, pack_t(x + i), pack_t(y + i)).store_u(y + i);
+				for (index_t i = m; i < n; ++i) y[i] += alpha * x[i];
+			}
+
+			static T sum(index_t n, const T *a)
+			{
+				const index_t m = maj(n);
+				pack_t s_pk = pack_t::zeros();
+				for (index_t i = 0; i < m; i += W) s_pk += pack_t(a + i);
+
+				T s = lmat::sum(s_pk);
+				for (index_t i = m; i < n; ++i) s += a[i];
+				return s;
+			}
+
+			static T dot(index_t n, const T *a, const T *b)
+			{
+				const index_t m = maj(n);
+				pack_t s_pk = pack_t::zeros();
+				for (index_t i = 0; i < m; i += W) s_pk = math::fma(pack_t(a + i), pack_t(b + i), s_pk);
+
+				T s = lmat::sum(s_pk);
+				for (index_t i = m; i < n; ++i) s += a[i] * b[i];
+				return s;
+			}
+
+			static T maximum(index_t n, const T *a)
+			{
+				const index_t m = maj(n);
+				T r = a[0];
+				if (m > 0)
+				{
+					pack_t r_pk(a);
+					for (index_t i = W; i < m; i += W) r_pk = (math::max)(r_pk, pack_t(a + i));
+					r = lmat::maximum(r_pk);
+				}
+				for (index_t i = m; i < n; ++i) if (a[i] > r) r = a[i];
+				return r;
+			}
+
+			static T minimum(index_t n, const T *a)
+			{
+				const index_t m = maj(n);
+				T r = a[0];
+				if (m > 0)
+				{
+					pack_t r_pk(a);
+					for (index_t i = W; i < m; i += W) r_pk = (math::min)(r_pk, pack_t(a + i));
+					r = lmat::minimum(r_pk);
+				}
+				for (index_t i = m; i < n; ++i) if (a[i] < r) r = a[i];
+				return r;
+			}
+
+			static void copy(index_t n, const T *a, T *b)
+			{
+				const index_t m = maj(n);
+				for (index_t i = 0; i < m; i += W) pack_t(a + i).store_u(b + i);
+				for (index_t i = m; i < n; ++i) b[i] = a[i];
+			}
+
+			static void fill(index_t n, T *a, T v)
+			{
+				const index_t m = maj(n);
+				const pack_t v_pk(v);
+				for (index_t i = 0; i < m; i += W) v_pk.store_u(a + i);
+				for (index_t i = m; i < n; ++i) a[i] = v;
+			}
+
+			static void sort(index_t n, T *a)
+			{
+				int depth = 0;
+				for (index_t k = n; k > 1; k >>= 1) depth += 2;
+				intro_sort(n, a, depth);
+			}
+
+			static void transpose(index_t m, index_t n, const T *a, T *b)
+			{
+				const index_t bs = 16;  // in tiles of bs x bs
+
+				for (index_t j0 = 0; j0 < n; j0 += bs)
+				{
+					const index_t j1 = j0 + bs < n ? j0 + bs : n;
+					for (index_t i0 = 0; i0 < m; i0 += bs)
+					{
+						const index_t i1 = i0 + bs < m ? i0 + bs : m;
+						for (index_t j = j0; j < j1; ++j)
+						{
+							for (index_t i = i0; i < i1; ++i) b[j + i * n] = a[i + j * m];
+						}
+					}
+				}
+			}
+
+			// the same values as the regular engine (counter_rand_evaluate)
+			// on a column: whole packs first, then the remaining scalars
+
+			static void randu(index_t n, T *a, uint64_t seed, uint64_t sid, uint64_t pos)
+			{
+				variant_stream rs(seed, sid);
+				rs.seek(pos);
+
+				const random::std_uniform_real_simd<T, kind> pk_distr;
+				const index_t m = maj(n);
+				for (index_t i = 0; i < m; i += W) pk_distr(rs).store_u(a + i);
+				for (index_t i = m; i < n; ++i) a[i] = random::rand_real<T>::c0o1(rs);
+			}
+		};
+
+		template<typename T>
+		kernel_table<T> make_kernel_table()
+		{
+			typedef variant_kernels_of<T> K;
+
+			kernel_table<T> t;
+			t.add = &K::add;
+			t.sub = &K::sub;
+			t.mul = &K::mul;
+			t.div = &K::div;
+			t.axpy = &K::axpy;
+			t.sum = &K::sum;
+			t.dot = &K::dot;
+			t.maximum = &K::maximum;
+			t.minimum = &K::minimum;
+			t.copy = &K::copy;
+			t.fill = &K::fill;
+			t.sort = &K::sort;
+			t.transpose = &K::transpose;
+			t.randu = &K::randu;
+			return t;
+		}
+	}
+
+	const kernel_set& variant_kernels()
+	{
+		static const kernel_set ks = {
+				LMAT_SIMD_LEVEL,
+				make_kernel_table<float>(),
+				make_kernel_table<double>() };
+		return ks;
+	}
+
+} } }
+
+#endif
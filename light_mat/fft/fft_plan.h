@@ -0,0 +1,290 @@
+/**
+ * @file fft_plan.h
+ *
+ * @brief Plans of fast Fourier transforms
+ *
+ * A plan of length n factors n into radix-4, 2, 3 and 5 stages (and
+ * direct butterflies for other prime factors), and holds the twiddle
+ * factors of all stages. The stages are Stockham passes, which write
+ * to a second buffer and need no bit-reversal permutation.
+ *
+ * get_fft_plan / get_rfft_plan return plans cached by length. The
+ * caches are shared by all threads and never evicted.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_FFT_PLAN_H_
+#define LIGHTMAT_FFT_PLAN_H_
+
+#include <light_mat/fft/internal/fft_kernels.h>
+#include <light_mat/math/math_constants.h>
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace lmat
+{
+
+	/********************************************
+	 *
+	 *  complex plan
+	 *
+	 ********************************************/
+
+	template<typename T>
+	class fft_plan : private noncopyable
+	{
+	public:
+		typedef T value_type;
+
+		explicit fft_plan(index_t n)
+		: m_len(n)
+		{
+			index_t len = n;
+			index_t s = 1;
+
+			while (len > 1)
+			{
+				const index_t p = next_radix(len);
+				const index_t m = len / p;
+
+				internal::fft_stage st;
+				st.radix = p;
+				st.nsub = m;
+				st.stride = s;
+				st.tw_offset = (index_t)m_twr.size();
+				st.rt_offset = (index_t)m_rtr.size();
+
+				for (index_t j = 0; j < m; ++j)
+				{
+					for (index_t k = 1; k < p; ++k) add_root(m_twr, m_twi, j * k, len);
+				}
+
+				if (p > 5)
+				{
+					for (index_t t = 0; t < p; ++t) add_root(m_rtr, m_rti, t, p);
+				}
+
+				m_stages.push_back(st);
+				len = m;
+				s *= p;
+			}
+		}
+
+		LMAT_ENSURE_INLINE index_t length() const
+		{
+			return m_len;
+		}
+
+		LMAT_ENSURE_INLINE index_t nstages() const
+		{
+			return (index_t)m_stages.size();
+		}
+
+		LMAT_ENSURE_INLINE index_t radix(index_t i) const
+		{
+			return m_stages[(size_t)i].radix;
+		}
+
+		/**
+		 * Forward transforms of Lanes::width sequences, with element e
+		 * of sequence l at offset e * Lanes::width + l of (xr, xi).
+		 * (yr, yi) is the work buffer of the same size.
+		 *
+		 * @return whether the results are in (yr, yi)
+		 */
+		template<class Lanes>
+		bool execute_lanes(T *xr, T *xi, T *yr, T *yi) const
+		{
+			T *ur = xr, *ui = xi, *vr = yr, *vi = yi;
+			for (size_t i = 0; i < m_stages.size(); ++i)
+			{
+				internal::fft_pass<Lanes, true>(m_stages[i], tw_r(), tw_i(), rt_r(), rt_i(), ur, ui, vr, vi);
+				std::swap(ur, vr);
+				std::swap(ui, vi);
+			}
+			return ur == yr;
+		}
+
+		/**
+		 * Forward transform of a single contiguous sequence. The stages
+		 * whose stride is a multiple of the pack width process the
+		 * strided butterflies by packs.
+		 *
+		 * @return whether the results are in (yr, yi)
+		 */
+		template<typename Kind>
+		bool execute_vec(T *xr, T *xi, T *yr, T *yi) const
+		{
+			typedef internal::fft_pack_lanes<T, Kind> pack_lanes;
+			typedef internal::fft_scalar_lanes<T> scalar_lanes;
+
+			T *ur = xr, *ui = xi, *vr = yr, *vi = yi;
+			for (size_t i = 0; i < m_stages.size(); ++i)
+			{
+				const internal::fft_stage& st = m_stages[i];
+				if (st.stride % pack_lanes::width == 0)
+					internal::fft_pass<pack_lanes, false>(st, tw_r(), tw_i(), rt_r(), rt_i(), ur, ui, vr, vi);
+				else
+					internal::fft_pass<scalar_lanes, true>(st, tw_r(), tw_i(), rt_r(), rt_i(), ur, ui, vr, vi);
+				std::swap(ur, vr);
+				std::swap(ui, vi);
+			}
+			return ur == yr;
+		}
+
+	private:
+		static index_t next_radix(index_t len)
+		{
+			if (len % 4 == 0) return 4;
+			if (len % 2 == 0) return 2;
+			if (len % 3 == 0) return 3;
+			if (len % 5 == 0) return 5;
+
+			for (index_t p = 7; p * p <= len; p += 2)
+			{
+				if (len % p == 0) return p;
+			}
+			return len;
+		}
+
+		static void add_root(std::vector<T>& vr, std::vector<T>& vi, index_t k, index_t n)
+		{
+			const double a = - math::consts<double>::two_pi() * double(k) / double(n);
+			vr.push_back(T(std::cos(a)));
+			vi.push_back(T(std::sin(a)));
+		}
+
+		LMAT_ENSURE_INLINE const T* tw_r() const { return m_twr.empty() ? nullptr : &m_twr[0]; }
+		LMAT_ENSURE_INLINE const T* tw_i() const { return m_twi.empty() ? nullptr : &m_twi[0]; }
+		LMAT_ENSURE_INLINE const T* rt_r() const { return m_rtr.empty() ? nullptr : &m_rtr[0]; }
+		LMAT_ENSURE_INLINE const T* rt_i() const { return m_rti.empty() ? nullptr : &m_rti[0]; }
+
+	private:
+		index_t m_len;
+		std::vector<internal::fft_stage> m_stages;
+		std::vector<T> m_twr;
+		std::vector<T> m_twi;
+		std::vector<T> m_rtr;
+		std::vector<T> m_rti;
+	};
+
+
+	/********************************************
+	 *
+	 *  real plan
+	 *
+	 *  An even length n = 2h uses a complex plan
+	 *  of length h (see fft_kernels.h), an odd
+	 *  length a complex plan of length n.
+	 *
+	 ********************************************/
+
+	template<typename T>
+	class rfft_plan : private noncopyable
+	{
+	public:
+		typedef T value_type;
+
+		explicit rfft_plan(index_t n)
+		: m_len(n), m_cplan(n % 2 == 0 ? n / 2 : n)
+		{
+			if (n % 2 == 0)
+			{
+				const index_t h = n / 2;
+				m_wr.reserve((size_t)(h + 1));
+				m_wi.reserve((size_t)(h + 1));
+
+				for (index_t k = 0; k <= h; ++k)
+				{
+					const double a = - math::consts<double>::two_pi() * double(k) / double(n);
+					m_wr.push_back(T(std::cos(a)));
+					m_wi.push_back(T(std::sin(a)));
+				}
+			}
+		}
+
+		LMAT_ENSURE_INLINE index_t length() const
+		{
+			return m_len;
+		}
+
+		LMAT_ENSURE_INLINE bool is_halved() const
+		{
+			return m_len % 2 == 0;
+		}
+
+		LMAT_ENSURE_INLINE const fft_plan<T>& complex_plan() const
+		{
+			return m_cplan;
+		}
+
+		// exp(-2 pi i k / n), k = 0, ..., n/2 (halved plans only)
+
+		LMAT_ENSURE_INLINE const T* w_real() const
+		{
+			return &m_wr[0];
+		}
+
+		LMAT_ENSURE_INLINE const T* w_imag() const
+		{
+			return &m_wi[0];
+		}
+
+	private:
+		index_t m_len;
+		fft_plan<T> m_cplan;
+		std::vector<T> m_wr;
+		std::vector<T> m_wi;
+	};
+
+
+	/********************************************
+	 *
+	 *  plan caches
+	 *
+	 ********************************************/
+
+	namespace internal
+	{
+		template<class Plan>
+		class fft_plan_cache
+		{
+		public:
+			static const Plan& get(index_t n)
+			{
+				static std::mutex mut;
+				static std::map<index_t, std::unique_ptr<Plan> > plans;
+
+				std::lock_guard<std::mutex> lock(mut);
+				std::unique_ptr<Plan>& p = plans[n];
+				if (!p) p.reset(new Plan(n));
+				return *p;
+			}
+		};
+	}
+
+	template<typename T>
+	inline const fft_plan<T>& get_fft_plan(index_t n)
+	{
+		return internal::fft_plan_cache<fft_plan<T> >::get(n);
+	}
+
+	template<typename T>
+	inline const rfft_plan<T>& get_rfft_plan(index_t n)
+	{
+		return internal::fft_plan_cache<rfft_plan<T> >::get(n);
+	}
+
+}
+
+#endif /* FFT_PLAN_H_ */
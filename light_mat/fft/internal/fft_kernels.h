@@ -0,0 +1,504 @@
+/**
+ * @file fft_kernels.h
+ *
+ * Internal kernels of the Stockham FFT
+ *
+ * The work buffers keep the real and imaginary parts in separate
+ * arrays. Element e of a sequence is at offset e * E, where E is the
+ * number of sequences that are transformed together (one per SIMD
+ * lane in the batch mode, and 1 otherwise).
+ *
+ * A pass of radix p maps x to y as
+ *
+ *   y[q + s * (p * j + k)] = w^(j k) * sum_r x[q + s * (j + r * m)] * u^(r k)
+ *
+ * where m = len / p, s = N / len, w = exp(-2 pi i / len) and
+ * u = exp(-2 pi i / p), for 0 <= j < m, 0 <= q < s and 0 <= k < p.
+ * The output of the last pass is in natural order.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_FFT_KERNELS_H_
+#define LIGHTMAT_FFT_KERNELS_H_
+
+#include <light_mat/simd/simd.h>
+
+namespace lmat { namespace internal {
+
+	/********************************************
+	 *
+	 *  lanes
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct fft_scalar_lanes
+	{
+		typedef T value_type;
+		static const index_t width = 1;
+
+		LMAT_ENSURE_INLINE
+		static T load(const T *p) { return *p; }
+
+		LMAT_ENSURE_INLINE
+		static void store(T *p, const T& v) { *p = v; }
+
+		LMAT_ENSURE_INLINE
+		static T bcast(const T& v) { return v; }
+	};
+
+	template<typename T, typename Kind>
+	struct fft_pack_lanes
+	{
+		typedef simd_pack<T, Kind> value_type;
+		static const index_t width = (index_t)simd_traits<T, Kind>::pack_width;
+
+		// work buffers are aligned to the pack size
+
+		LMAT_ENSURE_INLINE
+		static value_type load(const T *p)
+		{
+			value_type v;
+			v.load_a(p);
+			return v;
+		}
+
+		LMAT_ENSURE_INLINE
+		static void store(T *p, const value_type& v) { v.store_a(p); }
+
+		LMAT_ENSURE_INLINE
+		static value_type bcast(const T& v) { return value_type(v); }
+	};
+
+
+	/********************************************
+	 *
+	 *  stage description
+	 *
+	 ********************************************/
+
+	struct fft_stage
+	{
+		index_t radix;		// p
+		index_t nsub;		// m = len / p
+		index_t stride;		// s
+		index_t tw_offset;	// twiddles w^(j k), (p - 1) per j, k = 1 .. p-1
+		index_t rt_offset;	// roots u^t, t = 0 .. p-1 (generic radix only)
+	};
+
+
+	/********************************************
+	 *
+	 *  radix passes
+	 *
+	 *  Batch: all E = L::width lanes hold the
+	 *  same element of different sequences.
+	 *
+	 *  Otherwise, E = 1 and a value of L holds
+	 *  L::width consecutive q, which requires
+	 *  the stride be a multiple of L::width.
+	 *
+	 ********************************************/
+
+	template<class L, typename T, typename V>
+	LMAT_ENSURE_INLINE
+	inline void fft_store_tw(T *pr, T *pi, const V& ar, const V& ai, const V& wr, const V& wi)
+	{
+		L::store(pr, ar * wr - ai * wi);
+		L::store(pi, ar * wi + ai * wr);
+	}
+
+	template<class L, bool Batch, typename T>
+	inline void fft_pass2(const fft_stage& st, const T *twr, const T *twi,
+			const T *xr, const T *xi, T *yr, T *yi)
+	{
+		typedef typename L::value_type V;
+		const index_t E = Batch ? L::width : 1;
+		const index_t qs = Batch ? 1 : L::width;
+
+		const index_t m = st.nsub;
+		const index_t s = st.stride;
+		const index_t id = s * m * E;
+		const index_t od = s * E;
+
+		for (index_t j = 0; j < m; ++j)
+		{
+			const V w1r = L::bcast(twr[j]);
+			const V w1i = L::bcast(twi[j]);
+
+			for (index_t q = 0; q < s; q += qs)
+			{
+				const index_t i = (q + s * j) * E;
+				const index_t o = (q + s * 2 * j) * E;
+
+				const V a0r = L::load(xr + i);
+				const V a0i = L::load(xi + i);
+				const V a1r = L::load(xr + i + id);
+				const V a1i = L::load(xi + i + id);
+
+				L::store(yr + o, a0r + a1r);
+				L::store(yi + o, a0i + a1i);
+				fft_store_tw<L>(yr + o + od, yi + o + od, a0r - a1r, a0i - a1i, w1r, w1i);
+			}
+		}
+	}
+
+	template<class L, bool Batch, typename T>
+	inline void fft_pass3(const fft_stage& st, const T *twr, const T *twi,
+			const T *xr, const T *xi, T *yr, T *yi)
+	{
+		typedef typename L::value_type V;
+		const index_t E = Batch ? L::width : 1;
+		const index_t qs = Batch ? 1 : L::width;
+
+		const index_t m = st.nsub;
+		const index_t s = st.stride;
+		const index_t id = s * m * E;
+		const index_t od = s * E;
+
+		const V c_half = L::bcast(T(0.5));
+		const V c_s3 = L::bcast(T(0.86602540378443864676));  // sin(2 pi / 3)
+
+		for (index_t j = 0; j < m; ++j)
+		{
+			const V w1r = L::bcast(twr[2 * j]);
+			const V w1i = L::bcast(twi[2 * j]);
+			const V w2r = L::bcast(twr[2 * j + 1]);
+			const V w2i = L::bcast(twi[2 * j + 1]);
+
+			for (index_t q = 0; q < s; q += qs)
+			{
+				const index_t i = (q + s * j) * E;
+				const index_t o = (q + s * 3 * j) * E;
+
+				const V a0r = L::load(xr + i);
+				const V a0i = L::load(xi + i);
+				const V a1r = L::load(xr + i + id);
+				const V a1i = L::load(xi + i + id);
+				const V a2r = L::load(xr + i + 2 * id);
+				const V a2i = L::load(xi + i + 2 * id);
+
+				const V tr = a1r + a2r;
+				const V ti = a1i + a2i;
+				const V ur = a0r - c_half * tr;
+				const V ui = a0i - c_half * ti;
+				const V dr = c_s3 * (a1r - a2r);
+				const V di = c_s3 * (a1i - a2i);
+
+				L::store(yr + o, a0r + tr);
+				L::store(yi + o, a0i + ti);
+				fft_store_tw<L>(yr + o + od, yi + o + od, ur + di, ui - dr, w1r, w1i);
+				fft_store_tw<L>(yr + o + 2 * od, yi + o + 2 * od, ur - di, ui + dr, w2r, w2i);
+			}
+		}
+	}
+
+	template<class L, bool Batch, typename T>
+	inline void fft_pass4(const fft_stage& st, const T *twr, const T *twi,
+			const T *xr, const T *xi, T *yr, T *yi)
+	{
+		typedef typename L::value_type V;
+		const index_t E = Batch ? L::width : 1;
+		const index_t qs = Batch ? 1 : L::width;
+
+		const index_t m = st.nsub;
+		const index_t s = st.stride;
+		const index_t id = s * m * E;
+		const index_t od = s * E;
+
+		for (index_t j = 0; j < m; ++j)
+		{
+			const V w1r = L::bcast(twr[3 * j]);
+			const V w1i = L::bcast(twi[3 * j]);
+			const V w2r = L::bcast(twr[3 * j + 1]);
+			const V w2i = L::bcast(twi[3 * j + 1]);
+			const V w3r = L::bcast(twr[3 * j + 2]);
+			const V w3i = L::bcast(twi[3 * j + 2]);
+
+			for (index_t q = 0; q < s; q += qs)
+			{
+				const index_t i = (q + s * j) * E;
+				const index_t o = (q + s * 4 * j) * E;
+
+				const V a0r = L::load(xr + i);
+				const V a0i = L::load(xi + i);
+				const V a1r = L::load(xr + i + id);
+				const V a1i = L::load(xi + i + id);
+				const V a2r = L::load(xr + i + 2 * id);
+				const V a2i = L::load(xi + i + 2 * id);
+				const V a3r = L::load(xr + i + 3 * id);
+				const V a3i = L::load(xi + i + 3 * id);
+
+				const V t0r = a0r + a2r;
+				const V t0i = a0i + a2i;
+				const V t1r = a0r - a2r;
+				const V t1i = a0i - a2i;
+				const V t2r = a1r + a3r;
+				const V t2i = a1i + a3i;
+				const V t3r = a1r - a3r;
+				const V t3i = a1i - a3i;
+
+				L::store(yr + o, t0r + t2r);
+				L::store(yi + o, t0i + t2i);
+				fft_store_tw<L>(yr + o + od, yi + o + od, t1r + t3i, t1i - t3r, w1r, w1i);
+				fft_store_tw<L>(yr + o + 2 * od, yi + o + 2 * od, t0r - t2r, t0i - t2i, w2r, w2i);
+				fft_store_tw<L>(yr + o + 3 * od, yi + o + 3 * od, t1r - t3i, t1i + t3r, w3r, w3i);
+			}
+		}
+	}
+
+	template<class L, bool Batch, typename T>
+	inline void fft_pass5(const fft_stage& st, const T *twr, const T *twi,
+			const T *xr, const T *xi, T *yr, T *yi)
+	{
+		typedef typename L::value_type V;
+		const index_t E = Batch ? L::width : 1;
+		const index_t qs = Batch ? 1 : L::width;
+
+		const index_t m = st.nsub;
+		const index_t s = st.stride;
+		const index_t id = s * m * E;
+		const index_t od = s * E;
+
+		const V c1 = L::bcast(T(0.30901699437494742410));   // cos(2 pi / 5)
+		const V c2 = L::bcast(T(-0.80901699437494742410));  // cos(4 pi / 5)
+		const V s1 = L::bcast(T(0.95105651629515357212));   // sin(2 pi / 5)
+		const V s2 = L::bcast(T(0.58778525229247312917));   // sin(4 pi / 5)
+
+		for (index_t j = 0; j < m; ++j)
+		{
+			const T *jwr = twr + 4 * j;
+			const T *jwi = twi + 4 * j;
+
+			for (index_t q = 0; q < s; q += qs)
+			{
+				const index_t i = (q + s * j) * E;
+				const index_t o = (q + s * 5 * j) * E;
+
+				const V a0r = L::load(xr + i);
+				const V a0i = L::load(xi + i);
+				const V a1r = L::load(xr + i + id);
+				const V a1i = L::load(xi + i + id);
+				const V a2r = L::load(xr + i + 2 * id);
+				const V a2i = L::load(xi + i + 2 * id);
+				const V a3r = L::load(xr + i + 3 * id);
+				const V a3i = L::load(xi + i + 3 * id);
+				const V a4r = L::load(xr + i + 4 * id);
+				const V a4i = L::load(xi + i + 4 * id);
+
+				const V t1r = a1r + a4r;
+				const V t1i = a1i + a4i;
+				const V t2r = a2r + a3r;
+				const V t2i = a2i + a3i;
+				const V d1r = a1r - a4r;
+				const V d1i = a1i - a4i;
+				const V d2r = a2r - a3r;
+				const V d2i = a2i - a3i;
+
+				const V b1r = a0r + c1 * t1r + c2 * t2r;
+				const V b1i = a0i + c1 * t1i + c2 * t2i;
+				const V b2r = a0r + c2 * t1r + c1 * t2r;
+				const V b2i = a0i + c2 * t1i + c1 * t2i;
+
+				const V e1r = s1 * d1r + s2 * d2r;
+				const V e1i = s1 * d1i + s2 * d2i;
+				const V e2r = s2 * d1r - s1 * d2r;
+				const V e2i = s2 * d1i - s1 * d2i;
+
+				L::store(yr + o, a0r + t1r + t2r);
+				L::store(yi + o, a0i + t1i + t2i);
+
+				fft_store_tw<L>(yr + o + od, yi + o + od, b1r + e1i, b1i - e1r,
+						L::bcast(jwr[0]), L::bcast(jwi[0]));
+				fft_store_tw<L>(yr + o + 2 * od, yi + o + 2 * od, b2r + e2i, b2i - e2r,
+						L::bcast(jwr[1]), L::bcast(jwi[1]));
+				fft_store_tw<L>(yr + o + 3 * od, yi + o + 3 * od, b2r - e2i, b2i + e2r,
+						L::bcast(jwr[2]), L::bcast(jwi[2]));
+				fft_store_tw<L>(yr + o + 4 * od, yi + o + 4 * od, b1r - e1i, b1i + e1r,
+						L::bcast(jwr[3]), L::bcast(jwi[3]));
+			}
+		}
+	}
+
+	// direct O(p^2) butterflies, for the prime factors other than 2, 3 and 5
+
+	template<class L, bool Batch, typename T>
+	inline void fft_passg(const fft_stage& st, const T *twr, const T *twi, const T *rtr, const T *rti,
+			const T *xr, const T *xi, T *yr, T *yi)
+	{
+		typedef typename L::value_type V;
+		const index_t E = Batch ? L::width : 1;
+		const index_t qs = Batch ? 1 : L::width;
+
+		const index_t p = st.radix;
+		const index_t m = st.nsub;
+		const index_t s = st.stride;
+		const index_t id = s * m * E;
+		const index_t od = s * E;
+
+		for (index_t j = 0; j < m; ++j)
+		{
+			const T *jwr = twr + (p - 1) * j;
+			const T *jwi = twi + (p - 1) * j;
+
+			for (index_t q = 0; q < s; q += qs)
+			{
+				const index_t i = (q + s * j) * E;
+				const index_t o = (q + s * p * j) * E;
+
+				for (index_t k = 0; k < p; ++k)
+				{
+					V sr = L::load(xr + i);
+					V si = L::load(xi + i);
+
+					index_t t = 0;
+					for (index_t r = 1; r < p; ++r)
+					{
+						t += k;
+						if (t >= p) t -= p;
+
+						const V ur = L::bcast(rtr[t]);
+						const V ui = L::bcast(rti[t]);
+						const V ar = L::load(xr + i + r * id);
+						const V ai = L::load(xi + i + r * id);
+
+						sr = sr + (ar * ur - ai * ui);
+						si = si + (ar * ui + ai * ur);
+					}
+
+					if (k == 0)
+					{
+						L::store(yr + o, sr);
+						L::store(yi + o, si);
+					}
+					else
+					{
+						fft_store_tw<L>(yr + o + k * od, yi + o + k * od, sr, si,
+								L::bcast(jwr[k - 1]), L::bcast(jwi[k - 1]));
+					}
+				}
+			}
+		}
+	}
+
+	template<class L, bool Batch, typename T>
+	inline void fft_pass(const fft_stage& st, const T *twr, const T *twi, const T *rtr, const T *rti,
+			const T *xr, const T *xi, T *yr, T *yi)
+	{
+		twr += st.tw_offset;
+		twi += st.tw_offset;
+
+		switch (st.radix)
+		{
+		case 2:
+			fft_pass2<L, Batch>(st, twr, twi, xr, xi, yr, yi);
+			break;
+		case 3:
+			fft_pass3<L, Batch>(st, twr, twi, xr, xi, yr, yi);
+			break;
+		case 4:
+			fft_pass4<L, Batch>(st, twr, twi, xr, xi, yr, yi);
+			break;
+		case 5:
+			fft_pass5<L, Batch>(st, twr, twi, xr, xi, yr, yi);
+			break;
+		default:
+			fft_passg<L, Batch>(st, twr, twi, rtr + st.rt_offset, rti + st.rt_offset, xr, xi, yr, yi);
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  real transforms (E = L::width)
+	 *
+	 *  A real sequence x of even length n = 2h
+	 *  is transformed as z[k] = x[2k] + i x[2k+1]
+	 *  of length h. With Z = fft(z) and
+	 *  w = exp(-2 pi i / n),
+	 *
+	 *  X[k] = (A + w^k * (-i) B) / 2,
+	 *  A = Z[k] + conj(Z[h-k]),
+	 *  B = Z[k] - conj(Z[h-k])
+	 *
+	 *  for k = 0, ..., h (indices modulo h).
+	 *
+	 ********************************************/
+
+	template<class L, typename T>
+	inline void rfft_post(index_t h, const T *wr, const T *wi,
+			const T *zr, const T *zi, T *xr, T *xi)
+	{
+		typedef typename L::value_type V;
+		const index_t E = L::width;
+		const V c_half = L::bcast(T(0.5));
+
+		for (index_t k = 0; k <= h; ++k)
+		{
+			const index_t k1 = (k == h ? 0 : k) * E;
+			const index_t k2 = (k == 0 ? 0 : h - k) * E;
+
+			const V z1r = L::load(zr + k1);
+			const V z1i = L::load(zi + k1);
+			const V z2r = L::load(zr + k2);
+			const V z2i = L::load(zi + k2);
+
+			const V ar = z1r + z2r;
+			const V ai = z1i - z2i;
+			const V br = z1r - z2r;
+			const V bi = z1i + z2i;
+
+			// (-i) B = (bi, -br)
+
+			const V kwr = L::bcast(wr[k]);
+			const V kwi = L::bcast(wi[k]);
+
+			L::store(xr + k * E, c_half * (ar + (kwr * bi + kwi * br)));
+			L::store(xi + k * E, c_half * (ai + (kwi * bi - kwr * br)));
+		}
+	}
+
+	// the inverse of rfft_post, scaled by c, and conjugated
+	// so that it can be followed by a forward transform
+
+	template<class L, typename T>
+	inline void irfft_pre(index_t h, const T c, const T *wr, const T *wi,
+			const T *xr, const T *xi, T *zr, T *zi)
+	{
+		typedef typename L::value_type V;
+		const index_t E = L::width;
+		const V vc = L::bcast(c);
+
+		for (index_t k = 0; k < h; ++k)
+		{
+			const V x1r = L::load(xr + k * E);
+			const V x1i = L::load(xi + k * E);
+			const V x2r = L::load(xr + (h - k) * E);
+			const V x2i = L::load(xi + (h - k) * E);
+
+			const V ar = x1r + x2r;
+			const V ai = x1i - x2i;
+			const V br = x1r - x2r;
+			const V bi = x1i + x2i;
+
+			// P = B * conj(w^k), Z = c * (A + i P)
+
+			const V kwr = L::bcast(wr[k]);
+			const V kwi = L::bcast(wi[k]);
+
+			const V pr = br * kwr + bi * kwi;
+			const V pi = bi * kwr - br * kwi;
+
+			L::store(zr + k * E, vc * (ar - pi));
+			L::store(zi + k * E, vc * (-(ai + pr)));
+		}
+	}
+
+} }
+
+#endif /* FFT_KERNELS_H_ */
@@ -0,0 +1,451 @@
+/**
+ * @file mat_fft.h
+ *
+ * @brief Fast Fourier transforms of matrix columns
+ *
+ * fft(a, r) and ifft(a, r) transform each column of a complex matrix,
+ * rfft(a, r) each column of a real matrix to its first n/2+1 complex
+ * coefficients, and irfft(a, r) back to a real matrix of n rows. The
+ * inverse transforms are scaled by 1/n. r may be a itself for fft and
+ * ifft.
+ *
+ * Columns are transformed in groups of the pack width, one column per
+ * lane, so that every butterfly works on whole packs. The remaining
+ * columns are transformed one at a time.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_MAT_FFT_H_
+#define LIGHTMAT_MAT_FFT_H_
+
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/fft/fft_plan.h>
+#include <light_mat/common/block.h>
+
+#include <complex>
+
+namespace lmat
+{
+	namespace internal
+	{
+		/********************************************
+		 *
+		 *  work space
+		 *
+		 ********************************************/
+
+		template<typename T, typename Kind>
+		class fft_workspace : private noncopyable
+		{
+		public:
+			static const index_t W = fft_pack_lanes<T, Kind>::width;
+
+			explicit fft_workspace(index_t len)
+			: m_len(len * W), m_buf(4 * len * W)
+			{
+			}
+
+			LMAT_ENSURE_INLINE T* xr() { return m_buf.ptr_data(); }
+			LMAT_ENSURE_INLINE T* xi() { return m_buf.ptr_data() + m_len; }
+			LMAT_ENSURE_INLINE T* yr() { return m_buf.ptr_data() + 2 * m_len; }
+			LMAT_ENSURE_INLINE T* yi() { return m_buf.ptr_data() + 3 * m_len; }
+
+		private:
+			index_t m_len;
+			dblock<T, aligned_allocator<T, simd_traits<T, Kind>::pack_bytes> > m_buf;
+		};
+
+
+		/********************************************
+		 *
+		 *  gather & scatter
+		 *
+		 *  p points to the first element of the
+		 *  first column, rs and cs are the row and
+		 *  column strides (in elements)
+		 *
+		 ********************************************/
+
+		template<typename T, typename Kind>
+		inline void fft_gather(fft_pack_lanes<T, Kind>, index_t n,
+				const std::complex<T> *p, index_t rs, index_t cs, bool cj, T *xr, T *xi)
+		{
+			const index_t w = fft_pack_lanes<T, Kind>::width;
+			const T *pt = reinterpret_cast<const T*>(p);
+
+			simd_pack<T, Kind> re, im;
+			for (index_t i = 0; i < n; ++i)
+			{
+				re.load_strided(pt + 2 * i * rs, 2 * cs);
+				im.load_strided(pt + 2 * i * rs + 1, 2 * cs);
+				re.store_a(xr + i * w);
+				if (cj) im = -im;
+				im.store_a(xi + i * w);
+			}
+		}
+
+		template<typename T>
+		inline void fft_gather(fft_scalar_lanes<T>, index_t n,
+				const std::complex<T> *p, index_t rs, index_t, bool cj, T *xr, T *xi)
+		{
+			for (index_t i = 0; i < n; ++i)
+			{
+				const std::complex<T>& z = p[i * rs];
+				xr[i] = z.real();
+				xi[i] = cj ? -z.imag() : z.imag();
+			}
+		}
+
+		template<typename T, typename Kind>
+		inline void fft_gather_real(fft_pack_lanes<T, Kind>, index_t n,
+				const T *p, index_t rs, index_t cs, T *x)
+		{
+			const index_t w = fft_pack_lanes<T, Kind>::width;
+
+			simd_pack<T, Kind> pk;
+			for (index_t i = 0; i < n; ++i)
+			{
+				pk.load_strided(p + i * rs, cs);
+				pk.store_a(x + i * w);
+			}
+		}
+
+		template<typename T>
+		inline void fft_gather_real(fft_scalar_lanes<T>, index_t n,
+				const T *p, index_t rs, index_t, T *x)
+		{
+			for (index_t i = 0; i < n; ++i) x[i] = p[i * rs];
+		}
+
+		// as above, with zero imaginary parts in xi
+
+		template<typename T, typename Kind>
+		inline void fft_gather_real(fft_pack_lanes<T, Kind>, index_t n,
+				const T *p, index_t rs, index_t cs, T *xr, T *xi)
+		{
+			const index_t w = fft_pack_lanes<T, Kind>::width;
+
+			simd_pack<T, Kind> pk;
+			const simd_pack<T, Kind> z = simd_pack<T, Kind>::zeros();
+			for (index_t i = 0; i < n; ++i)
+			{
+				pk.load_strided(p + i * rs, cs);
+				pk.store_a(xr + i * w);
+				z.store_a(xi + i * w);
+			}
+		}
+
+		template<typename T>
+		inline void fft_gather_real(fft_scalar_lanes<T>, index_t n,
+				const T *p, index_t rs, index_t, T *xr, T *xi)
+		{
+			for (index_t i = 0; i < n; ++i)
+			{
+				xr[i] = p[i * rs];
+				xi[i] = T(0);
+			}
+		}
+
+		// writes (c * yr, +/- c * yi), row by row as the gathers read
+
+		template<class L, typename T>
+		inline void fft_scatter(index_t n, const T *yr, const T *yi, const T c, bool cj,
+				std::complex<T> *p, index_t rs, index_t cs)
+		{
+			const index_t w = L::width;
+			const T ci = cj ? -c : c;
+
+			for (index_t i = 0; i < n; ++i)
+			{
+				std::complex<T> *pi = p + i * rs;
+				for (index_t l = 0; l < w; ++l)
+				{
+					pi[l * cs] = std::complex<T>(yr[i * w + l] * c, yi[i * w + l] * ci);
+				}
+			}
+		}
+
+		template<class L, typename T>
+		inline void fft_scatter_real(index_t n, const T *y, const T c, T *p, index_t rs, index_t cs)
+		{
+			const index_t w = L::width;
+
+			for (index_t i = 0; i < n; ++i)
+			{
+				T *pi = p + i * rs;
+				for (index_t l = 0; l < w; ++l) pi[l * cs] = y[i * w + l] * c;
+			}
+		}
+
+		// x[n-k] = conj(x[k]) for k = 1, ..., hh
+
+		template<class L, typename T>
+		inline void fft_mirror(index_t n, index_t hh, T *xr, T *xi)
+		{
+			const index_t E = L::width;
+			for (index_t k = 1; k <= hh; ++k)
+			{
+				L::store(xr + (n - k) * E, L::load(xr + k * E));
+				L::store(xi + (n - k) * E, -L::load(xi + k * E));
+			}
+		}
+
+
+		/********************************************
+		 *
+		 *  column groups
+		 *
+		 ********************************************/
+
+		template<typename T, typename Kind>
+		LMAT_ENSURE_INLINE
+		inline bool fft_exec(const fft_plan<T>& plan, fft_pack_lanes<T, Kind>, Kind,
+				T *xr, T *xi, T *yr, T *yi)
+		{
+			return plan.template execute_lanes<fft_pack_lanes<T, Kind> >(xr, xi, yr, yi);
+		}
+
+		template<typename T, typename Kind>
+		LMAT_ENSURE_INLINE
+		inline bool fft_exec(const fft_plan<T>& plan, fft_scalar_lanes<T>, Kind,
+				T *xr, T *xi, T *yr, T *yi)
+		{
+			return plan.template execute_vec<Kind>(xr, xi, yr, yi);
+		}
+
+		// the inverse is conj(fft(conj(x))) / n
+
+		template<class L, typename T, typename Kind>
+		inline void fft_cols(const fft_plan<T>& plan, fft_workspace<T, Kind>& ws, bool inv,
+				const std::complex<T> *pa, index_t ars, index_t acs,
+				std::complex<T> *pr, index_t rrs, index_t rcs)
+		{
+			const index_t n = plan.length();
+
+			fft_gather(L(), n, pa, ars, acs, inv, ws.xr(), ws.xi());
+			const bool in_y = fft_exec(plan, L(), Kind(), ws.xr(), ws.xi(), ws.yr(), ws.yi());
+
+			const T c = inv ? T(1) / T(n) : T(1);
+			fft_scatter<L>(n, in_y ? ws.yr() : ws.xr(), in_y ? ws.yi() : ws.xi(), c, inv, pr, rrs, rcs);
+		}
+
+		template<class L, typename T, typename Kind>
+		inline void rfft_cols(const rfft_plan<T>& plan, fft_workspace<T, Kind>& ws,
+				const T *pa, index_t ars, index_t acs,
+				std::complex<T> *pr, index_t rrs, index_t rcs)
+		{
+			const fft_plan<T>& cp = plan.complex_plan();
+			const index_t n = plan.length();
+
+			if (plan.is_halved())
+			{
+				const index_t h = n / 2;
+
+				fft_gather_real(L(), h, pa, 2 * ars, acs, ws.xr());
+				fft_gather_real(L(), h, pa + ars, 2 * ars, acs, ws.xi());
+
+				if (fft_exec(cp, L(), Kind(), ws.xr(), ws.xi(), ws.yr(), ws.yi()))
+				{
+					rfft_post<L>(h, plan.w_real(), plan.w_imag(), ws.yr(), ws.yi(), ws.xr(), ws.xi());
+					fft_scatter<L>(h + 1, ws.xr(), ws.xi(), T(1), false, pr, rrs, rcs);
+				}
+				else
+				{
+					rfft_post<L>(h, plan.w_real(), plan.w_imag(), ws.xr(), ws.xi(), ws.yr(), ws.yi());
+					fft_scatter<L>(h + 1, ws.yr(), ws.yi(), T(1), false, pr, rrs, rcs);
+				}
+			}
+			else
+			{
+				fft_gather_real(L(), n, pa, ars, acs, ws.xr(), ws.xi());
+
+				const bool in_y = fft_exec(cp, L(), Kind(), ws.xr(), ws.xi(), ws.yr(), ws.yi());
+				fft_scatter<L>(n / 2 + 1, in_y ? ws.yr() : ws.xr(), in_y ? ws.yi() : ws.xi(),
+						T(1), false, pr, rrs, rcs);
+			}
+		}
+
+		// the imaginary parts of X[0] and X[n/2] (n even) are ignored
+
+		template<class L, typename T, typename Kind>
+		inline void irfft_cols(const rfft_plan<T>& plan, fft_workspace<T, Kind>& ws,
+				const std::complex<T> *pa, index_t ars, index_t acs,
+				T *pr, index_t rrs, index_t rcs)
+		{
+			const fft_plan<T>& cp = plan.complex_plan();
+			const index_t n = plan.length();
+			const T c = T(1) / T(n);
+
+			if (plan.is_halved())
+			{
+				const index_t h = n / 2;
+
+				fft_gather(L(), h + 1, pa, ars, acs, false, ws.yr(), ws.yi());
+				zero_vec(L::width, ws.yi());
+				zero_vec(L::width, ws.yi() + h * L::width);
+
+				irfft_pre<L>(h, c, plan.w_real(), plan.w_imag(), ws.yr(), ws.yi(), ws.xr(), ws.xi());
+
+				const bool in_y = fft_exec(cp, L(), Kind(), ws.xr(), ws.xi(), ws.yr(), ws.yi());
+				fft_scatter_real<L>(h, in_y ? ws.yr() : ws.xr(), T(1), pr, 2 * rrs, rcs);
+				fft_scatter_real<L>(h, in_y ? ws.yi() : ws.xi(), T(-1), pr + rrs, 2 * rrs, rcs);
+			}
+			else
+			{
+				const index_t hh = n / 2;
+
+				fft_gather(L(), hh + 1, pa, ars, acs, true, ws.xr(), ws.xi());
+				fft_mirror<L>(n, hh, ws.xr(), ws.xi());
+
+				const bool in_y = fft_exec(cp, L(), Kind(), ws.xr(), ws.xi(), ws.yr(), ws.yi());
+				fft_scatter_real<L>(n, in_y ? ws.yr() : ws.xr(), c, pr, rrs, rcs);
+			}
+		}
+
+
+		/********************************************
+		 *
+		 *  column loops
+		 *
+		 ********************************************/
+
+		template<typename T, class A, class R>
+		void fft_colwise(const A& a, R& r, bool inv)
+		{
+			typedef default_simd_kind kind;
+			typedef fft_pack_lanes<T, kind> pack_lanes;
+			typedef fft_scalar_lanes<T> scalar_lanes;
+			const index_t W = pack_lanes::width;
+
+			const index_t n = a.nrows();
+			const index_t nc = a.ncolumns();
+			if (n == 0 || nc == 0) return;
+
+			const fft_plan<T>& plan = get_fft_plan<T>(n);
+			fft_workspace<T, kind> ws(n);
+
+			const std::complex<T> *pa = a.ptr_data();
+			std::complex<T> *pr = r.ptr_data();
+			const index_t ars = a.row_stride();
+			const index_t acs = a.col_stride();
+			const index_t rrs = r.row_stride();
+			const index_t rcs = r.col_stride();
+
+			index_t j = 0;
+			for (; j + W <= nc; j += W)
+				fft_cols<pack_lanes>(plan, ws, inv, pa + j * acs, ars, acs, pr + j * rcs, rrs, rcs);
+
+			for (; j < nc; ++j)
+				fft_cols<scalar_lanes>(plan, ws, inv, pa + j * acs, ars, acs, pr + j * rcs, rrs, rcs);
+		}
+
+		template<typename T, class A, class R>
+		void rfft_colwise(const A& a, R& r)
+		{
+			typedef default_simd_kind kind;
+			typedef fft_pack_lanes<T, kind> pack_lanes;
+			typedef fft_scalar_lanes<T> scalar_lanes;
+			const index_t W = pack_lanes::width;
+
+			const index_t n = a.nrows();
+			const index_t nc = a.ncolumns();
+			if (nc == 0) return;
+
+			if (n == 0)
+			{
+				zero(r);
+				return;
+			}
+
+			const rfft_plan<T>& plan = get_rfft_plan<T>(n);
+			fft_workspace<T, kind> ws(plan.complex_plan().length() + 1);
+
+			const T *pa = a.ptr_data();
+			std::complex<T> *pr = r.ptr_data();
+			const index_t ars = a.row_stride();
+			const index_t acs = a.col_stride();
+			const index_t rrs = r.row_stride();
+			const index_t rcs = r.col_stride();
+
+			index_t j = 0;
+			for (; j + W <= nc; j += W)
+				rfft_cols<pack_lanes>(plan, ws, pa + j * acs, ars, acs, pr + j * rcs, rrs, rcs);
+
+			for (; j < nc; ++j)
+				rfft_cols<scalar_lanes>(plan, ws, pa + j * acs, ars, acs, pr + j * rcs, rrs, rcs);
+		}
+
+		template<typename T, class A, class R>
+		void irfft_colwise(const A& a, R& r)
+		{
+			typedef default_simd_kind kind;
+			typedef fft_pack_lanes<T, kind> pack_lanes;
+			typedef fft_scalar_lanes<T> scalar_lanes;
+			const index_t W = pack_lanes::width;
+
+			const index_t n = r.nrows();
+			const index_t nc = r.ncolumns();
+			if (n == 0 || nc == 0) return;
+
+			const rfft_plan<T>& plan = get_rfft_plan<T>(n);
+			fft_workspace<T, kind> ws(plan.complex_plan().length() + 1);
+
+			const std::complex<T> *pa = a.ptr_data();
+			T *pr = r.ptr_data();
+			const index_t ars = a.row_stride();
+			const index_t acs = a.col_stride();
+			const index_t rrs = r.row_stride();
+			const index_t rcs = r.col_stride();
+
+			index_t j = 0;
+			for (; j + W <= nc; j += W)
+				irfft_cols<pack_lanes>(plan, ws, pa + j * acs, ars, acs, pr + j * rcs, rrs, rcs);
+
+			for (; j < nc; ++j)
+				irfft_cols<scalar_lanes>(plan, ws, pa + j * acs, ars, acs, pr + j * rcs, rrs, rcs);
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  public routines
+	 *
+	 ********************************************/
+
+	template<typename T, class A, class R>
+	inline void fft(const IRegularMatrix<A, std::complex<T> >& a, IRegularMatrix<R, std::complex<T> >& r)
+	{
+		LMAT_CHECK_DIMS( have_same_shape(a, r) )
+		internal::fft_colwise<T>(a.derived(), r.derived(), false);
+	}
+
+	template<typename T, class A, class R>
+	inline void ifft(const IRegularMatrix<A, std::complex<T> >& a, IRegularMatrix<R, std::complex<T> >& r)
+	{
+		LMAT_CHECK_DIMS( have_same_shape(a, r) )
+		internal::fft_colwise<T>(a.derived(), r.derived(), true);
+	}
+
+	template<typename T, class A, class R>
+	inline void rfft(const IRegularMatrix<A, T>& a, IRegularMatrix<R, std::complex<T> >& r)
+	{
+		LMAT_CHECK_DIMS( r.nrows() == a.nrows() / 2 + 1 && r.ncolumns() == a.ncolumns() )
+		internal::rfft_colwise<T>(a.derived(), r.derived());
+	}
+
+	template<typename T, class A, class R>
+	inline void irfft(const IRegularMatrix<A, std::complex<T> >& a, IRegularMatrix<R, T>& r)
+	{
+		LMAT_CHECK_DIMS( a.nrows() == r.nrows() / 2 + 1 && a.ncolumns() == r.ncolumns() )
+		internal::irfft_colwise<T>(a.derived(), r.derived());
+	}
+
+}
+
+#endif /* MAT_FFT_H_ */
@@ -34,6 +34,18 @@ extern "C"
 	void    LMAT_BLAS_NAME(drot) (const blas_int *n, double *x, const blas_int *incx, double *y, const blas_int *incy, const double *c, const double *s);
 	void    LMAT_BLAS_NAME(dscal)(const blas_int *n, const double *a, double *x, const blas_int *incx);
 	void    LMAT_BLAS_NAME(dswap)(const blas_int *n, double *x, const blas_int *incx, double *y, const blas_int *incy);
+
+	// the complex dot products are computed by cgemm/zgemm with a 1 x 1 output,
+	// as Fortran compilers disagree on how complex function values are returned
+
+	void LMAT_BLAS_NAME(cgemm)(const char *transa, const char *transb, const blas_int *m, const blas_int *n, const blas_int *k,
+	           const std::complex<float> *alpha, const std::complex<float> *a, const blas_int *lda,
+	           const std::complex<float> *b, const blas_int *ldb,
+	           const std::complex<float> *beta, std::complex<float> *c, const blas_int *ldc);
+	void LMAT_BLAS_NAME(zgemm)(const char *transa, const char *transb, const blas_int *m, const blas_int *n, const blas_int *k,
+	           const std::complex<double> *alpha, const std::complex<double> *a, const blas_int *lda,
+	           const std::complex<double> *b, const blas_int *ldb,
+	           const std::complex<double> *beta, std::complex<double> *c, const blas_int *ldc);
 }
 
 
@@ -141,6 +153,84 @@ namespace lmat { namespace blas {
 		return LMAT_BLAS_NAME(ddot)(&n, x.ptr_data(), &incx, y.ptr_data(), &incy);
 	}
 
+	// complex dot: dot(x, y) = x^T y, dotc(x, y) = x^H y
+
+	namespace internal
+	{
+		// y and x are taken as 1 x n matrices (with leading dimensions incy and incx),
+		// and r = y * op(x), with op = 'T' or 'C'
+
+		template<class X, class Y>
+		LMAT_ENSURE_INLINE
+		inline std::complex<float> cdot(const IRegularMatrix<X, std::complex<float> >& x,
+				const IRegularMatrix<Y, std::complex<float> >& y, char trans)
+		{
+			blas_int n = (blas_int)(x.nelems());
+			LMAT_CHECK_DIMS( x.nelems() == y.nelems() );
+
+			blas_int incx = (blas_int)(lmat::internal::get_vector_intv(x));
+			blas_int incy = (blas_int)(lmat::internal::get_vector_intv(y));
+
+			const char transa = 'N';
+			const blas_int one = 1;
+			const std::complex<float> alpha(1), beta(0);
+			std::complex<float> r(0);
+
+			LMAT_BLAS_NAME(cgemm)(&transa, &trans, &one, &one, &n, &alpha,
+					y.ptr_data(), &incy, x.ptr_data(), &incx, &beta, &r, &one);
+			return r;
+		}
+
+		template<class X, class Y>
+		LMAT_ENSURE_INLINE
+		inline std::complex<double> cdot(const IRegularMatrix<X, std::complex<double> >& x,
+				const IRegularMatrix<Y, std::complex<double> >& y, char trans)
+		{
+			blas_int n = (blas_int)(x.nelems());
+			LMAT_CHECK_DIMS( x.nelems() == y.nelems() );
+
+			blas_int incx = (blas_int)(lmat::internal::get_vector_intv(x));
+			blas_int incy = (blas_int)(lmat::internal::get_vector_intv(y));
+
+			const char transa = 'N';
+			const blas_int one = 1;
+			const std::complex<double> alpha(1), beta(0);
+			std::complex<double> r(0);
+
+			LMAT_BLAS_NAME(zgemm)(&transa, &trans, &one, &one, &n, &alpha,
+					y.ptr_data(), &incy, x.ptr_data(), &incx, &beta, &r, &one);
+			return r;
+		}
+	}
+
+	template<class X, class Y>
+	LMAT_ENSURE_INLINE
+	inline std::complex<float> dot(const IRegularMatrix<X, std::complex<float> >& x, const IRegularMatrix<Y, std::complex<float> >& y)
+	{
+		return internal::cdot(x, y, 'T');
+	}
+
+	template<class X, class Y>
+	LMAT_ENSURE_INLINE
+	inline std::complex<double> dot(const IRegularMatrix<X, std::complex<double> >& x, const IRegularMatrix<Y, std::complex<double> >& y)
+	{
+		return internal::cdot(x, y, 'T');
+	}
+
+	template<class X, class Y>
+	LMAT_ENSURE_INLINE
+	inline std::complex<float> dotc(const IRegularMatrix<X, std::complex<float> >& x, const IRegularMatrix<Y, std::complex<float> >& y)
+	{
+		return internal::cdot(x, y, 'C');
+	}
+
+	template<class X, class Y>
+	LMAT_ENSURE_INLINE
+	inline std::complex<double> dotc(const IRegularMatrix<X, std::complex<double> >& x, const IRegularMatrix<Y, std::complex<double> >& y)
+	{
+		return internal::cdot(x, y, 'C');
+	}
+
 	// rot
 
 	template<class X, class Y>
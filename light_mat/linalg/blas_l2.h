@@ -44,6 +44,14 @@ extern "C"
 	           const double *a, const blas_int *lda, double *b, const blas_int *incx);
 	void LMAT_BLAS_NAME(dtrsv)(const char *uplo, const char *trans, const char *diag, const blas_int *n,
 	           const double *a, const blas_int *lda, double *x, const blas_int *incx);
+
+	void LMAT_BLAS_NAME(cgemv)(const char *trans, const blas_int *m, const blas_int *n, const std::complex<float> *alpha,
+	           const std::complex<float> *a, const blas_int *lda, const std::complex<float> *x, const blas_int *incx,
+	           const std::complex<float> *beta, std::complex<float> *y, const blas_int *incy);
+
+	void LMAT_BLAS_NAME(zgemv)(const char *trans, const blas_int *m, const blas_int *n, const std::complex<double> *alpha,
+	           const std::complex<double> *a, const blas_int *lda, const std::complex<double> *x, const blas_int *incx,
+	           const std::complex<double> *beta, std::complex<double> *y, const blas_int *incy);
 }
 
 
@@ -122,6 +130,64 @@ namespace lmat { namespace blas {
 		gemv(1.0, a, x, 0.0, y, trans);
 	}
 
+	// complex gemv: trans can be 'N', 'T', or 'C' (conjugate transpose)
+
+	template<class A, class X, class Y>
+	LMAT_ENSURE_INLINE
+	inline void gemv(
+			std::complex<float> alpha, const IRegularMatrix<A, std::complex<float> >& a,
+			const IRegularMatrix<X, std::complex<float> >& x,
+			std::complex<float> beta, IRegularMatrix<Y, std::complex<float> >& y, char trans='N')
+	{
+		LMAT_CHECK_DIMS( internal::gemv_check_dims(a, x, y, trans) )
+
+		blas_int lda = (blas_int)a.col_stride();
+		blas_int incx = (blas_int)lmat::internal::get_vector_intv(x);
+		blas_int incy = (blas_int)lmat::internal::get_vector_intv(y);
+
+		blas_int m = (blas_int)a.nrows();
+		blas_int n = (blas_int)a.ncolumns();
+
+		LMAT_BLAS_NAME(cgemv)(&trans, &m, &n, &alpha, a.ptr_data(), &lda, x.ptr_data(), &incx, &beta, y.ptr_data(), &incy);
+	}
+
+	template<class A, class X, class Y>
+	LMAT_ENSURE_INLINE
+	inline void gemv(
+			std::complex<double> alpha, const IRegularMatrix<A, std::complex<double> >& a,
+			const IRegularMatrix<X, std::complex<double> >& x,
+			std::complex<double> beta, IRegularMatrix<Y, std::complex<double> >& y, char trans='N')
+	{
+		LMAT_CHECK_DIMS( internal::gemv_check_dims(a, x, y, trans) )
+
+		blas_int lda = (blas_int)a.col_stride();
+		blas_int incx = (blas_int)lmat::internal::get_vector_intv(x);
+		blas_int incy = (blas_int)lmat::internal::get_vector_intv(y);
+
+		blas_int m = (blas_int)a.nrows();
+		blas_int n = (blas_int)a.ncolumns();
+
+		LMAT_BLAS_NAME(zgemv)(&trans, &m, &n, &alpha, a.ptr_data(), &lda, x.ptr_data(), &incx, &beta, y.ptr_data(), &incy);
+	}
+
+	template<class A, class X, class Y>
+	LMAT_ENSURE_INLINE
+	inline void gemv(
+			const IRegularMatrix<A, std::complex<float> >& a, const IRegularMatrix<X, std::complex<float> >& x,
+			IRegularMatrix<Y, std::complex<float> >& y, char trans='N')
+	{
+		gemv(std::complex<float>(1), a, x, std::complex<float>(0), y, trans);
+	}
+
+	template<class A, class X, class Y>
+	LMAT_ENSURE_INLINE
+	inline void gemv(
+			const IRegularMatrix<A, std::complex<double> >& a, const IRegularMatrix<X, std::complex<double> >& x,
+			IRegularMatrix<Y, std::complex<double> >& y, char trans='N')
+	{
+		gemv(std::complex<double>(1), a, x, std::complex<double>(0), y, trans);
+	}
+
 
 	// symv
 
@@ -48,6 +48,16 @@ extern "C"
 	void LMAT_BLAS_NAME(dtrsm)(const char *side, const char *uplo, const char *transa, const char *diag,
 	           const blas_int *m, const blas_int *n, const double *alpha, const double *a, const blas_int *lda,
 	           double *b, const blas_int *ldb);
+
+	void LMAT_BLAS_NAME(cgemm)(const char *transa, const char *transb, const blas_int *m, const blas_int *n, const blas_int *k,
+	           const std::complex<float> *alpha, const std::complex<float> *a, const blas_int *lda,
+	           const std::complex<float> *b, const blas_int *ldb,
+	           const std::complex<float> *beta, std::complex<float> *c, const blas_int *ldc);
+
+	void LMAT_BLAS_NAME(zgemm)(const char *transa, const char *transb, const blas_int *m, const blas_int *n, const blas_int *k,
+	           const std::complex<double> *alpha, const std::complex<double> *a, const blas_int *lda,
+	           const std::complex<double> *b, const blas_int *ldb,
+	           const std::complex<double> *beta, std::complex<double> *c, const blas_int *ldc);
 }
 
 
@@ -142,6 +152,58 @@ namespace lmat { namespace blas {
 		gemm(1.0, a, b, 0.0, c, transa, transb);
 	}
 
+	// complex gemm: transa and transb can be 'N', 'T', or 'C' (conjugate transpose)
+
+	template<class A, class B, class C>
+	LMAT_ENSURE_INLINE
+	inline void gemm(std::complex<float> alpha, const IRegularMatrix<A, std::complex<float> >& a,
+			const IRegularMatrix<B, std::complex<float> >& b,
+			std::complex<float> beta, IRegularMatrix<C, std::complex<float> >& c, char transa='N', char transb='N')
+	{
+		blas_int m, n, k;
+		internal::gemm_get_dims(a, b, c, transa, transb, m, n, k);
+
+		blas_int lda = (blas_int)a.col_stride();
+		blas_int ldb = (blas_int)b.col_stride();
+		blas_int ldc = (blas_int)c.col_stride();
+
+		LMAT_BLAS_NAME(cgemm)(&transa, &transb, &m, &n, &k, &alpha,
+				a.ptr_data(), &lda, b.ptr_data(), &ldb, &beta, c.ptr_data(), &ldc);
+	}
+
+	template<class A, class B, class C>
+	LMAT_ENSURE_INLINE
+	inline void gemm(std::complex<double> alpha, const IRegularMatrix<A, std::complex<double> >& a,
+			const IRegularMatrix<B, std::complex<double> >& b,
+			std::complex<double> beta, IRegularMatrix<C, std::complex<double> >& c, char transa='N', char transb='N')
+	{
+		blas_int m, n, k;
+		internal::gemm_get_dims(a, b, c, transa, transb, m, n, k);
+
+		blas_int lda = (blas_int)a.col_stride();
+		blas_int ldb = (blas_int)b.col_stride();
+		blas_int ldc = (blas_int)c.col_stride();
+
+		LMAT_BLAS_NAME(zgemm)(&transa, &transb, &m, &n, &k, &alpha,
+				a.ptr_data(), &lda, b.ptr_data(), &ldb, &beta, c.ptr_data(), &ldc);
+	}
+
+	template<class A, class B, class C>
+	LMAT_ENSURE_INLINE
+	inline void gemm(const IRegularMatrix<A, std::complex<float> >& a, const IRegularMatrix<B, std::complex<float> >& b,
+	          IRegularMatrix<C, std::complex<float> >& c, char transa='N', char transb='N')
+	{
+		gemm(std::complex<float>(1), a, b, std::complex<float>(0), c, transa, transb);
+	}
+
+	template<class A, class B, class C>
+	LMAT_ENSURE_INLINE
+	inline void gemm(const IRegularMatrix<A, std::complex<double> >& a, const IRegularMatrix<B, std::complex<double> >& b,
+	          IRegularMatrix<C, std::complex<double> >& c, char transa='N', char transb='N')
+	{
+		gemm(std::complex<double>(1), a, b, std::complex<double>(0), c, transa, transb);
+	}
+
 
 	// symm
 
@@ -251,6 +313,72 @@ namespace lmat { namespace blas {
 	}
 
 
+	// syrk
+
+	namespace internal
+	{
+		template<class A, class C>
+		LMAT_ENSURE_INLINE
+		inline void syrk_get_dims(const A& a, const C& c, char trans,
+				blas_int& n, blas_int& k)
+		{
+			index_t na, ka;
+			get_op_dims(a, trans, na, ka);
+
+			LMAT_CHECK_DIMS( na == c.nrows() && na == c.ncolumns() );
+
+			n = (blas_int)na;
+			k = (blas_int)ka;
+		}
+	}
+
+	template<class A, class C>
+	LMAT_ENSURE_INLINE
+	inline void syrk(float alpha, const IRegularMatrix<A, float>& a,
+	                 float beta, IRegularMatrix<C, float>& c, char trans='N', char uplo='L')
+	{
+		blas_int n, k;
+		internal::syrk_get_dims(a, c, trans, n, k);
+
+		blas_int lda = (blas_int)a.col_stride();
+		blas_int ldc = (blas_int)c.col_stride();
+
+		LMAT_BLAS_NAME(ssyrk)(&uplo, &trans, &n, &k,
+				&alpha, a.ptr_data(), &lda, &beta, c.ptr_data(), &ldc);
+	}
+
+	template<class A, class C>
+	LMAT_ENSURE_INLINE
+	inline void syrk(double alpha, const IRegularMatrix<A, double>& a,
+	                 double beta, IRegularMatrix<C, double>& c, char trans='N', char uplo='L')
+	{
+		blas_int n, k;
+		internal::syrk_get_dims(a, c, trans, n, k);
+
+		blas_int lda = (blas_int)a.col_stride();
+		blas_int ldc = (blas_int)c.col_stride();
+
+		LMAT_BLAS_NAME(dsyrk)(&uplo, &trans, &n, &k,
+				&alpha, a.ptr_data(), &lda, &beta, c.ptr_data(), &ldc);
+	}
+
+	template<class A, class C>
+	LMAT_ENSURE_INLINE
+	inline void syrk(const IRegularMatrix<A, float>& a, IRegularMatrix<C, float>& c,
+	                 char trans='N', char uplo='L')
+	{
+		syrk(1.0f, a, 0.0f, c, trans, uplo);
+	}
+
+	template<class A, class C>
+	LMAT_ENSURE_INLINE
+	inline void syrk(const IRegularMatrix<A, double>& a, IRegularMatrix<C, double>& c,
+	                 char trans='N', char uplo='L')
+	{
+		syrk(1.0, a, 0.0, c, trans, uplo);
+	}
+
+
 	// trmm
 
 	template<class A, class B>
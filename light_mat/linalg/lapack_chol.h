@@ -150,9 +150,13 @@ namespace lmat { namespace lapack {
 			return m_dim;
 		}
 
-		const dense_matrix<T>& intern() const
+		// the factor, as the leading dim() x dim() block of the storage
+		// (which keeps its capacity on remove, and grows geometrically
+		// on insert)
+
+		cref_block<T> intern() const
 		{
-			return m_a;
+			return cref_block<T>(m_a.ptr_data(), m_dim, m_dim, m_a.col_stride());
 		}
 
 		template<class L>
@@ -161,14 +165,151 @@ namespace lmat { namespace lapack {
 			mat.require_size(m_dim, m_dim);
 			zero(mat);
 
+			cref_block<T> a_(m_a.ptr_data(), m_dim, m_dim, m_a.col_stride());
 			if (is_lower())
 			{
-				copy_tril(m_a, mat);
+				copy_tril(a_, mat);
 			}
 			else
 			{
-				copy_triu(m_a, mat);
+				copy_triu(a_, mat);
+			}
+		}
+
+		// modification of the factorized matrix A (each costs O(n^2) per rank)
+
+		template<class X>
+		void update(const IMatrixXpr<X, T>& x)  // A <- A + X * X'
+		{
+			rank_modify(x, T(1));
+		}
+
+		template<class X>
+		void downdate(const IMatrixXpr<X, T>& x)  // A <- A - X * X'
+		{
+			rank_modify(x, T(-1));
+		}
+
+		template<class C>
+		void insert(index_t j, const IMatrixXpr<C, T>& c)  // insert c as the j-th row & column of A
+		{
+			const index_t n = m_dim;
+
+			check_arg(j >= 0 && j <= n, "chol_fac::insert: j is out of range.");
+			LMAT_CHECK_DIMS( c.nrows() == n + 1 && c.ncolumns() == 1 );
+
+			dense_col<T> c_(c);
+
+			// with L = [L11 0; L21 L22], the new factor is
+			// [L11 0 0; y' d 0; L21 z L33], where L11 * y = c1,
+			// d^2 = c2 - y' * y, z = (c3 - L21 * y) / d, and
+			// L33 * L33' = L22 * L22' - z * z'
+			//
+			// y, d, and z are computed, and L33 is checked to exist,
+			// before A is modified
+
+			dense_col<T> y(j);
+			T d2 = c_[j];
+			for (index_t i = 0; i < j; ++i)
+			{
+				T v = c_[i];
+				for (index_t t = 0; t < i; ++t) v -= fac(i, t) * y[t];
+				y[i] = (v /= fac(i, i));
+				d2 -= v * v;
+			}
+
+			if (!(d2 > T(0)))
+				throw invalid_argument("chol_fac::insert: the result is not positive definite.");
+
+			const T d = math::sqrt(d2);
+
+			dense_col<T> z(n - j);
+			for (index_t i = j; i < n; ++i)
+			{
+				T v = c_[i + 1];
+				for (index_t t = 0; t < j; ++t) v -= fac(i, t) * y[t];
+				z[i - j] = v / d;
+			}
+
+			// L22 * L22' - z * z' is positive definite iff p' * p < 1,
+			// with p = L22^{-1} * z
+
+			dense_col<T> p(n - j);
+			T pp(0);
+			for (index_t i = j; i < n; ++i)
+			{
+				T v = z[i - j];
+				for (index_t t = j; t < i; ++t) v -= fac(i, t) * p[t - j];
+				p[i - j] = (v /= fac(i, i));
+				pp += v * v;
+			}
+
+			if (!(pp < T(1)))
+				throw invalid_argument("chol_fac::insert: the result is not positive definite.");
+
+			reserve(n + 1);
+
+			// shift the rows (and columns) from j on down (and right)
+			// within the storage, in decreasing order, so that no entry
+			// is overwritten before it is moved
+
+			const index_t ai = is_lower() ? 1 : m_a.col_stride();
+			const index_t ak = is_lower() ? m_a.col_stride() : 1;
+			T *pa = m_a.ptr_data();
+
+			for (index_t k = n - 1; k >= 0; --k)
+			{
+				const index_t k_ = k < j ? k : k + 1;
+				for (index_t i = n - 1; i >= (k < j ? j : k); --i)
+				{
+					pa[(i + 1) * ai + k_ * ak] = pa[i * ai + k * ak];
+				}
+			}
+
+			for (index_t t = 0; t < j; ++t) pa[j * ai + t * ak] = y[t];
+			pa[j * (ai + ak)] = d;
+			for (index_t i = j; i < n; ++i) pa[(i + 1) * ai + j * ak] = z[i - j];
+
+			m_dim = n + 1;
+
+			// (failing from here on takes rounding or non-finite inputs)
+
+			if (!rank1_modify(n - j, pa + (j + 1) * (ai + ak), ai, ak, z.ptr_data(), T(-1)))
+				throw invalid_argument("chol_fac::insert: the result is not positive definite.");
+		}
+
+		void remove(index_t j)  // remove the j-th row & column of A
+		{
+			const index_t n = m_dim;
+			check_arg(j >= 0 && j < n, "chol_fac::remove: j is out of range.");
+
+			// L33 * L33' = L22 * L22' + z * z', with z = L(j+1:n, j)
+
+			dense_col<T> z(n - 1 - j);
+			for (index_t i = j + 1; i < n; ++i) z[i - 1 - j] = fac(i, j);
+
+			// shift the rows (and columns) after j up (and left) within
+			// the storage, in increasing order, so that no entry is
+			// overwritten before it is moved
+
+			const index_t ai = is_lower() ? 1 : m_a.col_stride();
+			const index_t ak = is_lower() ? m_a.col_stride() : 1;
+			T *pa = m_a.ptr_data();
+
+			for (index_t k = 0; k < n; ++k)
+			{
+				if (k == j) continue;
+				const index_t k_ = k < j ? k : k - 1;
+				for (index_t i = (k < j ? j + 1 : k); i < n; ++i)
+				{
+					pa[(i - 1) * ai + k_ * ak] = pa[i * ai + k * ak];
+				}
 			}
+
+			// an update never loses positive definiteness
+
+			rank1_modify(n - 1 - j, pa + j * (ai + ak), ai, ak, z.ptr_data(), T(1));
+			m_dim = n - 1;
 		}
 
 	protected:
@@ -181,6 +322,134 @@ namespace lmat { namespace lapack {
 			m_a = mat;
 		}
 
+	private:
+		// the (i, k) entry of L (i >= k), whichever triangle is stored
+
+		T fac(index_t i, index_t k) const
+		{
+			return is_lower() ? m_a(i, k) : m_a(k, i);
+		}
+
+		// grows the storage (geometrically) to hold an m x m factor,
+		// keeping the leading dim() x dim() block
+
+		void reserve(index_t m)
+		{
+			const index_t cap = m_a.nrows();
+			if (m > cap)
+			{
+				const index_t cap2 = m > 2 * cap ? m : 2 * cap;
+				dense_matrix<T> b(cap2, cap2, zero());
+				for (index_t k = 0; k < m_dim; ++k)
+				{
+					for (index_t i = 0; i < m_dim; ++i) b(i, k) = m_a(i, k);
+				}
+				m_a.swap(b);
+			}
+		}
+
+		template<class X>
+		void rank_modify(const IMatrixXpr<X, T>& x, T sign)
+		{
+			LMAT_CHECK_DIMS( x.nrows() == m_dim );
+
+			dense_matrix<T> w(x);
+
+			// checked before A is modified
+
+			if (sign < T(0) && !downdatable(w))
+				throw invalid_argument("chol_fac::downdate: the result is not positive definite.");
+
+			const index_t ai = is_lower() ? 1 : m_a.col_stride();
+			const index_t ak = is_lower() ? m_a.col_stride() : 1;
+
+			// (failing from here on takes rounding or non-finite inputs)
+
+			for (index_t j = 0; j < w.ncolumns(); ++j)
+			{
+				if (!rank1_modify(m_dim, m_a.ptr_data(), ai, ak, w.ptr_col(j), sign))
+					throw invalid_argument(sign < T(0) ?
+						"chol_fac::downdate: the result is not positive definite." :
+						"chol_fac::update: the result is not positive definite.");
+			}
+		}
+
+		// whether A - W * W' is positive definite: with P = L^{-1} * W,
+		// this holds iff I - P' * P is (which is checked by its Cholesky pivots)
+
+		bool downdatable(const dense_matrix<T>& w) const
+		{
+			const index_t n = m_dim;
+			const index_t r = w.ncolumns();
+
+			dense_matrix<T> p(w);
+			for (index_t j = 0; j < r; ++j)
+			{
+				T *pj = p.ptr_col(j);
+				for (index_t k = 0; k < n; ++k)
+				{
+					const T v = (pj[k] /= fac(k, k));
+					for (index_t i = k + 1; i < n; ++i) pj[i] -= fac(i, k) * v;
+				}
+			}
+
+			dense_matrix<T> g(r, r);
+			for (index_t j = 0; j < r; ++j)
+			{
+				for (index_t i = j; i < r; ++i)
+				{
+					T v = i == j ? T(1) : T(0);
+					for (index_t t = 0; t < n; ++t) v -= p(t, i) * p(t, j);
+					g(i, j) = v;
+				}
+			}
+
+			for (index_t k = 0; k < r; ++k)
+			{
+				if (!(g(k, k) > T(0))) return false;
+				const T d = math::sqrt(g(k, k));
+
+				for (index_t i = k + 1; i < r; ++i) g(i, k) /= d;
+				for (index_t j = k + 1; j < r; ++j)
+				{
+					for (index_t i = j; i < r; ++i) g(i, j) -= g(i, k) * g(j, k);
+				}
+			}
+			return true;
+		}
+
+		// L * L' + sign * x * x' -> L * L', with L(i, k) at a[i * si + k * sk]
+		// (x is overwritten)
+		//
+		// @return false if the result is not positive definite, with
+		//         the columns before the failing one already modified
+
+		static bool rank1_modify(index_t n, T *a, index_t si, index_t sk, T *x, T sign)
+		{
+			for (index_t k = 0; k < n; ++k)
+			{
+				T *ak = a + k * sk;
+				const T lkk = ak[k * si];
+				const T xk = x[k];
+
+				const T r2 = lkk * lkk + sign * xk * xk;
+				if (!(r2 > T(0))) return false;
+
+				const T r = math::sqrt(r2);
+				const T c = r / lkk;
+				const T s = xk / lkk;
+				ak[k * si] = r;
+
+				for (index_t i = k + 1; i < n; ++i)
+				{
+					const T l = (ak[i * si] + sign * s * x[i]) / c;
+					x[i] = c * x[i] - s * l;
+					ak[i * si] = l;
+				}
+			}
+			return true;
+		}
+
 	protected:
 		const char m_uplo;
 		index_t m_dim;
@@ -236,7 +505,7 @@ namespace lmat { namespace lapack {
 		float eval_det() const   // det of the factor
 		{
 			const dense_matrix<float> &a_ = this->m_a;
-			const index_t n = a_.nrows();
+			const index_t n = this->m_dim;
 			double r(1.0);
 			for (index_t i = 0; i < n; ++i) r *= a_(i,i);
 			return static_cast<float>(r);
@@ -245,7 +514,7 @@ namespace lmat { namespace lapack {
 		float eval_logdet() const  // logdet of the factor
 		{
 			const dense_matrix<float> &a_ = this->m_a;
-			const index_t n = a_.nrows();
+			const index_t n = this->m_dim;
 			double r(0.0);
 			for (index_t i = 0; i < n; ++i) r += math::log(a_(i,i));
 			return static_cast<float>(r);
@@ -342,7 +611,7 @@ namespace lmat { namespace lapack {
 		double eval_det() const   // det of the factor
 		{
 			const dense_matrix<double> &a_ = this->m_a;
-			const index_t n = a_.nrows();
+			const index_t n = this->m_dim;
 			double r(1.0);
 			for (index_t i = 0; i < n; ++i) r *= a_(i,i);
 			return r;
@@ -351,7 +620,7 @@ namespace lmat { namespace lapack {
 		double eval_logdet() const  // logdet of the factor
 		{
 			const dense_matrix<double> &a_ = this->m_a;
-			const index_t n = a_.nrows();
+			const index_t n = this->m_dim;
 			double r(0.0);
 			for (index_t i = 0; i < n; ++i) r += math::log(a_(i,i));
 			return r;
@@ -0,0 +1,504 @@
+/**
+ * @file lapack_eigs.h
+ *
+ * @brief Iterative solvers for a few extreme eigenpairs of a symmetric operator
+ *
+ * Both solvers only touch the operator through products with
+ * (blocks of) vectors, and solve small projected problems with syev.
+ *
+ * - lanczos_eigs: thick-restart Lanczos with full re-orthogonalization
+ * - lobpcg_eigs:  LOBPCG (Knyazev, 2001) on an orthonormal basis [X, W, P]
+ *
+ * An operator is any callable as op(x, y), with x a cref_matrix<T> and
+ * y a ref_matrix<T>, both n x b, which writes y = A * x. Matrices
+ * are wrapped by sym_matrix_op, which calls symv (b = 1) or symm.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_LAPACK_EIGS_H_
+#define LIGHTMAT_LAPACK_EIGS_H_
+
+#include <light_mat/math/math_base.h>
+#include <light_mat/linalg/blas_l1.h>
+#include <light_mat/linalg/blas_l2.h>
+#include <light_mat/linalg/blas_l3.h>
+#include <light_mat/linalg/lapack_qr.h>
+#include <light_mat/linalg/lapack_syev.h>
+#include <light_mat/random/rand_expr.h>
+#include <light_mat/random/rand_stream.h>
+
+#include <limits>
+
+namespace lmat { namespace lapack {
+
+	/********************************************
+	 *
+	 *  options & operators
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct symeig_options
+	{
+		T tol;				// on residual norms, relative to max |eigenvalue|
+		index_t max_iters;	// restarts (Lanczos) or iterations (LOBPCG)
+		index_t ncv;		// Lanczos basis size (0: max(2k + 1, 20))
+
+		symeig_options()
+		: tol(math::sqrt(std::numeric_limits<T>::epsilon()))
+		, max_iters(500), ncv(0) { }
+
+		symeig_options(T tol_, index_t max_iters_, index_t ncv_=0)
+		: tol(tol_), max_iters(max_iters_), ncv(ncv_) { }
+	};
+
+
+	template<typename T, class Mat>
+	class sym_matrix_op
+	{
+	public:
+		sym_matrix_op(const IRegularMatrix<Mat, T>& a, char uplo='L')
+		: m_a(a.derived()), m_uplo(uplo)
+		{
+			LMAT_CHECK_DIMS( a.nrows() == a.ncolumns() );
+		}
+
+		index_t dim() const
+		{
+			return m_a.nrows();
+		}
+
+		void operator() (const cref_matrix<T>& x, ref_matrix<T>& y) const
+		{
+			if (x.ncolumns() == 1)
+				blas::symv(m_a, x, y, m_uplo);
+			else
+				blas::symm(T(1), m_a, x, T(0), y, 'L', m_uplo);
+		}
+
+	private:
+		const Mat& m_a;
+		char m_uplo;
+	};
+
+
+	namespace internal
+	{
+		inline char check_eigs_which(char c)
+		{
+			if (c == 'L' || c == 'l') return 'L';
+			else if (c == 'S' || c == 's') return 'S';
+			else
+				throw invalid_argument("Invalid character for eigs which (must be 'L' or 'S').");
+		}
+
+		// start of the p wanted values among m ascending ones
+
+		LMAT_ENSURE_INLINE
+		inline index_t eigs_first(index_t m, index_t p, char which)
+		{
+			return which == 'L' ? m - p : 0;
+		}
+
+		template<typename T>
+		inline T eigs_scale(const dense_col<T>& theta, index_t m)
+		{
+			return math::max(math::abs(theta[0]), math::abs(theta[m-1]));
+		}
+
+		template<typename T, class RStream>
+		inline void eigs_rand(RStream& rs, ref_matrix<T>& x)
+		{
+			x = rand_mat(random::std_normal_distr<T>(), rs, x.nrows(), x.ncolumns());
+		}
+
+		// y -= Q * (Q' * y), twice (classical Gram-Schmidt with re-orthogonalization)
+
+		template<typename T>
+		inline void eigs_project_out(const cref_matrix<T>& q, ref_matrix<T>& y)
+		{
+			const index_t nq = q.ncolumns();
+			if (nq == 0) return;
+
+			dense_matrix<T> c(nq, y.ncolumns());
+			for (int t = 0; t < 2; ++t)
+			{
+				blas::gemm(q, y, c, 'T', 'N');
+				blas::gemm(T(-1), q, c, T(1), y);
+			}
+		}
+
+		template<typename T>
+		inline void eigs_orth(dense_matrix<T>& y)
+		{
+			qr_fac<T> qf(y);
+			qf.getq(y, y.ncolumns());
+		}
+
+		template<typename T, class Op, class W, class V>
+		bool _lanczos_eigs(const Op& op, index_t n, index_t k,
+				IRegularMatrix<W, T>& w, IRegularMatrix<V, T>& v, char which,
+				const symeig_options<T>& opts)
+		{
+			which = check_eigs_which(which);
+
+			index_t m = opts.ncv > 0 ? opts.ncv : math::max(2 * k + 1, index_t(20));
+			m = math::min(m, n);
+
+			check_arg(k > 0 && k < m, "lanczos_eigs: k is out of range (0 < k < min(ncv, n)).");
+
+			const T eps = std::numeric_limits<T>::epsilon();
+
+			// V(:, 0:m+1) is the basis (with the residual direction at the end),
+			// and H = V(:, 0:m)' * A * V(:, 0:m) is its projection
+
+			dense_matrix<T> vb(n, m + 1);
+			dense_matrix<T> h(m, m, zero());
+			dense_col<T> c(m);
+
+			dense_col<T> theta(m);
+			dense_matrix<T> y(m, m);
+
+			random::default_rand_stream rs;
+
+			ref_matrix<T> v0(vb.ptr_data(), n, 1);
+			eigs_rand(rs, v0);
+			blas::scal(v0, T(1) / blas::nrm2(v0));
+
+			index_t j0 = 0;
+			T beta = 0;
+			bool converged = false;
+
+			for (index_t it = 0; ; ++it)
+			{
+				// expand the basis to m vectors
+
+				for (index_t j = j0; j < m; ++j)
+				{
+					cref_matrix<T> vj(vb.ptr_col(j), n, 1);
+					ref_matrix<T> r(vb.ptr_col(j + 1), n, 1);
+					op(vj, r);
+
+					T anorm = blas::nrm2(r);
+
+					cref_matrix<T> q(vb.ptr_data(), n, j + 1);
+					ref_matrix<T> cj(c.ptr_data(), j + 1, 1);
+
+					for (index_t i = 0; i <= j; ++i) h(i, j) = T(0);
+
+					for (int t = 0; t < 2; ++t)
+					{
+						blas::gemv(T(1), q, r, T(0), cj, 'T');
+						blas::gemv(T(-1), q, cj, T(1), r, 'N');
+						for (index_t i = 0; i <= j; ++i) h(i, j) += c[i];
+					}
+					for (index_t i = 0; i < j; ++i) h(j, i) = h(i, j);
+
+					beta = blas::nrm2(r);
+
+					if (beta <= T(10) * eps * anorm)
+					{
+						// invariant subspace: continue with a fresh direction
+
+						beta = T(0);
+						if (j + 1 < n)
+						{
+							eigs_rand(rs, r);
+							eigs_project_out(q, r);
+							blas::scal(r, T(1) / blas::nrm2(r));
+						}
+					}
+					else
+					{
+						blas::scal(r, T(1) / beta);
+					}
+				}
+
+				// Rayleigh-Ritz
+
+				syev(h, theta, y);
+
+				const index_t b = eigs_first(m, k, which);
+				const T thres = opts.tol * eigs_scale(theta, m);
+
+				index_t nconv = 0;
+				for (index_t i = b; i < b + k; ++i)
+				{
+					if (math::abs(beta * y(m-1, i)) <= thres) ++nconv;
+				}
+
+				converged = (nconv == k);
+				if (converged || it + 1 >= opts.max_iters)
+				{
+					w.require_size(k, 1);
+					v.require_size(n, k);
+
+					w.derived() = theta(range(b, k), whole());
+					blas::gemm(cref_matrix<T>(vb.ptr_data(), n, m), cref_matrix<T>(y.ptr_col(b), m, k), v);
+					break;
+				}
+
+				// thick restart: keep p Ritz vectors at the wanted end
+
+				const index_t p = math::min(k + (m - k) / 2, m - 1);
+				const index_t rb = eigs_first(m, p, which);
+
+				dense_matrix<T> u(n, p);
+				blas::gemm(cref_matrix<T>(vb.ptr_data(), n, m), cref_matrix<T>(y.ptr_col(rb), m, p), u);
+
+				ref_matrix<T> vk(vb.ptr_data(), n, p);
+				vk = u;
+				ref_matrix<T> vp(vb.ptr_col(p), n, 1);
+				vp = cref_matrix<T>(vb.ptr_col(m), n, 1);
+
+				zero(h);
+				for (index_t i = 0; i < p; ++i) h(i, i) = theta[rb + i];
+
+				j0 = p;
+			}
+
+			return converged;
+		}
+
+
+		template<typename T, class Op, class W, class V>
+		bool _lobpcg_eigs(const Op& op, index_t n, index_t k,
+				IRegularMatrix<W, T>& w, IRegularMatrix<V, T>& v, char which,
+				const symeig_options<T>& opts)
+		{
+			which = check_eigs_which(which);
+
+			check_arg(k > 0 && 3 * k <= n, "lobpcg_eigs: k is out of range (0 < k <= n / 3).");
+
+			// S = [X, W, P] and AS = A * S, with S orthonormal
+
+			dense_matrix<T> s(n, 3 * k);
+			dense_matrix<T> as(n, 3 * k);
+
+			ref_matrix<T> x(s.ptr_data(), n, k);
+			ref_matrix<T> ax(as.ptr_data(), n, k);
+
+			dense_matrix<T> x0(n, k);
+			random::default_rand_stream rs;
+			ref_matrix<T> x0r(x0.ptr_data(), n, k);
+			eigs_rand(rs, x0r);
+			eigs_orth(x0);
+			x = x0;
+			op(cref_matrix<T>(x.ptr_data(), n, k), ax);
+
+			dense_matrix<T> p(n, k);
+			index_t np = 0;
+
+			dense_col<T> lam(k);
+			dense_col<T> theta;
+			dense_matrix<T> g;
+			dense_matrix<T> c;
+
+			dense_matrix<T> xn(n, k);
+			dense_matrix<T> axn(n, k);
+			dense_matrix<T> z;
+
+			bool converged = false;
+
+			for (index_t it = 0; ; ++it)
+			{
+				// Rayleigh-Ritz on the current basis
+
+				const index_t ns = k + (it == 0 ? 0 : k + np);
+
+				cref_matrix<T> sc(s.ptr_data(), n, ns);
+				cref_matrix<T> asc(as.ptr_data(), n, ns);
+
+				g.require_size(ns, ns);
+				blas::gemm(sc, asc, g, 'T', 'N');
+				for (index_t j = 0; j < ns; ++j)
+				{
+					for (index_t i = j + 1; i < ns; ++i)
+						g(i, j) = g(j, i) = (g(i, j) + g(j, i)) * T(0.5);
+				}
+
+				syev(g, theta, c);
+
+				const index_t b = eigs_first(ns, k, which);
+				cref_matrix<T> cx(c.ptr_col(b), ns, k);
+
+				blas::gemm(sc, cx, xn);
+				blas::gemm(asc, cx, axn);
+
+				if (ns > k)
+				{
+					// P: the part of the update outside of the previous X
+
+					blas::gemm(cref_matrix<T>(s.ptr_col(k), n, ns - k),
+							cref_block<T>(c.ptr_col(b) + k, ns - k, k, ns), p);
+					np = k;
+				}
+
+				x = xn;
+				ax = axn;
+				lam = theta(range(b, k), whole());
+
+				// residuals W = AX - X * diag(lam)
+
+				const T thres = opts.tol * math::max(math::abs(lam[0]), math::abs(lam[k-1]));
+
+				ref_matrix<T> r(s.ptr_col(k), n, k);
+				r = ax;
+
+				index_t nconv = 0;
+				for (index_t j = 0; j < k; ++j)
+				{
+					ref_matrix<T> rj(r.ptr_col(j), n, 1);
+					blas::axpy(-lam[j], cref_matrix<T>(x.ptr_col(j), n, 1), rj);
+					if (blas::nrm2(rj) <= thres) ++nconv;
+				}
+
+				converged = (nconv == k);
+				if (converged || it + 1 >= opts.max_iters)
+				{
+					w.require_size(k, 1);
+					v.require_size(n, k);
+
+					w.derived() = lam;
+					v.derived() = x;
+					break;
+				}
+
+				// orthonormalize [W, P] against X and within itself
+
+				const index_t nz = k + np;
+
+				if (np > 0)
+				{
+					ref_matrix<T> sp(s.ptr_col(2 * k), n, k);
+					sp = p;
+				}
+
+				z.require_size(n, nz);
+				z = cref_matrix<T>(s.ptr_col(k), n, nz);
+
+				for (int t = 0; t < 2; ++t)
+				{
+					ref_matrix<T> zr(z.ptr_data(), n, nz);
+					eigs_project_out(cref_matrix<T>(x.ptr_data(), n, k), zr);
+					eigs_orth(z);
+				}
+
+				ref_matrix<T> sz(s.ptr_col(k), n, nz);
+				ref_matrix<T> asz(as.ptr_col(k), n, nz);
+				sz = z;
+				op(cref_matrix<T>(sz.ptr_data(), n, nz), asz);
+			}
+
+			return converged;
+		}
+
+
+		template<typename T, class Mat>
+		inline void check_eigs_mat(const IRegularMatrix<Mat, T>& a)
+		{
+			LMAT_CHECK_DIMS( a.nrows() == a.ncolumns() );
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  Lanczos
+	 *
+	 ********************************************/
+
+	/**
+	 * Computes the k largest (which = 'L') or smallest (which = 'S')
+	 * eigenvalues w (in ascending order) and eigenvectors v (n x k)
+	 * of the symmetric operator op of dimension n.
+	 *
+	 * @return whether all pairs converged within opts.max_iters restarts.
+	 */
+	template<class Op, class W, class V>
+	inline bool lanczos_eigs(const Op& op, index_t n, index_t k,
+			IRegularMatrix<W, float>& w, IRegularMatrix<V, float>& v, char which='L',
+			const symeig_options<float>& opts = symeig_options<float>())
+	{
+		return internal::_lanczos_eigs(op, n, k, w, v, which, opts);
+	}
+
+	template<class Op, class W, class V>
+	inline bool lanczos_eigs(const Op& op, index_t n, index_t k,
+			IRegularMatrix<W, double>& w, IRegularMatrix<V, double>& v, char which='L',
+			const symeig_options<double>& opts = symeig_options<double>())
+	{
+		return internal::_lanczos_eigs(op, n, k, w, v, which, opts);
+	}
+
+	template<class A, class W, class V>
+	inline bool lanczos_eigs(const IRegularMatrix<A, float>& a, index_t k,
+			IRegularMatrix<W, float>& w, IRegularMatrix<V, float>& v, char which='L',
+			const symeig_options<float>& opts = symeig_options<float>())
+	{
+		internal::check_eigs_mat(a);
+		return internal::_lanczos_eigs(sym_matrix_op<float, A>(a), a.nrows(), k, w, v, which, opts);
+	}
+
+	template<class A, class W, class V>
+	inline bool lanczos_eigs(const IRegularMatrix<A, double>& a, index_t k,
+			IRegularMatrix<W, double>& w, IRegularMatrix<V, double>& v, char which='L',
+			const symeig_options<double>& opts = symeig_options<double>())
+	{
+		internal::check_eigs_mat(a);
+		return internal::_lanczos_eigs(sym_matrix_op<double, A>(a), a.nrows(), k, w, v, which, opts);
+	}
+
+
+	/********************************************
+	 *
+	 *  LOBPCG
+	 *
+	 ********************************************/
+
+	/**
+	 * Same as lanczos_eigs, with the k pairs iterated as a block
+	 * (requires 3 * k <= n). Each iteration costs 2 * k products.
+	 */
+	template<class Op, class W, class V>
+	inline bool lobpcg_eigs(const Op& op, index_t n, index_t k,
+			IRegularMatrix<W, float>& w, IRegularMatrix<V, float>& v, char which='L',
+			const symeig_options<float>& opts = symeig_options<float>())
+	{
+		return internal::_lobpcg_eigs(op, n, k, w, v, which, opts);
+	}
+
+	template<class Op, class W, class V>
+	inline bool lobpcg_eigs(const Op& op, index_t n, index_t k,
+			IRegularMatrix<W, double>& w, IRegularMatrix<V, double>& v, char which='L',
+			const symeig_options<double>& opts = symeig_options<double>())
+	{
+		return internal::_lobpcg_eigs(op, n, k, w, v, which, opts);
+	}
+
+	template<class A, class W, class V>
+	inline bool lobpcg_eigs(const IRegularMatrix<A, float>& a, index_t k,
+			IRegularMatrix<W, float>& w, IRegularMatrix<V, float>& v, char which='L',
+			const symeig_options<float>& opts = symeig_options<float>())
+	{
+		internal::check_eigs_mat(a);
+		return internal::_lobpcg_eigs(sym_matrix_op<float, A>(a), a.nrows(), k, w, v, which, opts);
+	}
+
+	template<class A, class W, class V>
+	inline bool lobpcg_eigs(const IRegularMatrix<A, double>& a, index_t k,
+			IRegularMatrix<W, double>& w, IRegularMatrix<V, double>& v, char which='L',
+			const symeig_options<double>& opts = symeig_options<double>())
+	{
+		internal::check_eigs_mat(a);
+		return internal::_lobpcg_eigs(sym_matrix_op<double, A>(a), a.nrows(), k, w, v, which, opts);
+	}
+
+} }
+
+#endif /* LAPACK_EIGS_H_ */
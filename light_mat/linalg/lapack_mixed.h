@@ -0,0 +1,261 @@
+/**
+ * @file lapack_mixed.h
+ *
+ * @brief Mixed-precision linear solvers (float factorization + double refinement)
+ *
+ * The matrix is factorized in single precision, and the solution is
+ * refined with residuals computed in double precision, in the same way
+ * as LAPACK's dsgesv/dsposv. When the single-precision factorization
+ * fails or the refinement stalls, the system is solved in double.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_LAPACK_MIXED_H_
+#define LIGHTMAT_LAPACK_MIXED_H_
+
+#include <light_mat/math/math_base.h>
+#include <light_mat/matexpr/mat_arith.h>
+#include <light_mat/matexpr/mat_cast.h>
+#include <light_mat/linalg/blas_l3.h>
+#include <light_mat/linalg/lapack_lu.h>
+#include <light_mat/linalg/lapack_chol.h>
+
+#include <limits>
+
+namespace lmat { namespace lapack {
+
+	struct mixed_solve_info
+	{
+		index_t iters;		// number of refinement steps
+		bool fallback;		// whether the system was solved in double instead
+
+		mixed_solve_info()
+		: iters(0), fallback(false) { }
+	};
+
+	namespace internal
+	{
+		const index_t mixed_default_max_iters = 30;
+
+		template<class A>
+		inline double mixed_inf_norm(const IRegularMatrix<A, double>& a)
+		{
+			const index_t m = a.nrows();
+			const index_t n = a.ncolumns();
+
+			dense_col<double> rs(m, zero());
+			for (index_t j = 0; j < n; ++j)
+			{
+				for (index_t i = 0; i < m; ++i) rs[i] += math::abs(a(i, j));
+			}
+
+			double v = 0;
+			for (index_t i = 0; i < m; ++i) v = math::max(v, rs[i]);
+			return v;
+		}
+
+		// the infinity norm of a symmetric matrix, reading only its uplo triangle
+
+		template<class A>
+		inline double mixed_sym_inf_norm(const IRegularMatrix<A, double>& a, char uplo)
+		{
+			const index_t n = a.nrows();
+			const bool lower = (uplo == 'L');
+
+			dense_col<double> rs(n, zero());
+			for (index_t j = 0; j < n; ++j)
+			{
+				const index_t i0 = lower ? j : 0;
+				const index_t i1 = lower ? n : j + 1;
+
+				for (index_t i = i0; i < i1; ++i)
+				{
+					const double v = math::abs(a(i, j));
+					rs[i] += v;
+					if (i != j) rs[j] += v;
+				}
+			}
+
+			double v = 0;
+			for (index_t i = 0; i < n; ++i) v = math::max(v, rs[i]);
+			return v;
+		}
+
+		// residuals r <- r - a * x
+
+		struct mixed_ge_residual
+		{
+			template<class A>
+			double norm(const IRegularMatrix<A, double>& a) const
+			{
+				return mixed_inf_norm(a);
+			}
+
+			template<class A, class X, class R>
+			void apply(const IRegularMatrix<A, double>& a, const IRegularMatrix<X, double>& x,
+					IRegularMatrix<R, double>& r) const
+			{
+				blas::gemm(-1.0, a, x, 1.0, r);
+			}
+		};
+
+		struct mixed_sy_residual
+		{
+			char uplo;
+
+			explicit mixed_sy_residual(char ul) : uplo(ul) { }
+
+			template<class A>
+			double norm(const IRegularMatrix<A, double>& a) const
+			{
+				return mixed_sym_inf_norm(a, uplo);
+			}
+
+			template<class A, class X, class R>
+			void apply(const IRegularMatrix<A, double>& a, const IRegularMatrix<X, double>& x,
+					IRegularMatrix<R, double>& r) const
+			{
+				blas::symm(-1.0, a, x, 1.0, r, 'L', uplo);
+			}
+		};
+
+		/**
+		 * Refines x until, for each column, max|r| <= max|x| * ||A||_inf * eps * sqrt(n).
+		 *
+		 * @return false if the float path fails (NaN), stalls
+		 *         (the residual does not halve), or runs out of steps.
+		 */
+		template<class Fac, class Res, class A, class B, class X>
+		bool mixed_refine(const Fac& fac, const Res& res, const IRegularMatrix<A, double>& a,
+				const IRegularMatrix<B, double>& b, IRegularMatrix<X, double>& x,
+				index_t max_iters, index_t& iters)
+		{
+			const index_t n = a.nrows();
+			const index_t nrhs = b.ncolumns();
+
+			const double cte = res.norm(a) *
+					std::numeric_limits<double>::epsilon() * math::sqrt(double(n));
+
+			dense_matrix<float> d(to_f32(b));
+			fac.solve_inplace(d);
+			x.derived() = to_f64(d);
+
+			dense_matrix<double> r(n, nrhs);
+			double prev = std::numeric_limits<double>::infinity();
+
+			for (iters = 0; ; ++iters)
+			{
+				r = b.derived();
+				res.apply(a, x, r);
+
+				bool conv = true;
+				double rel = 0;
+
+				for (index_t j = 0; j < nrhs; ++j)
+				{
+					double rmax = 0, xmax = 0;
+					for (index_t i = 0; i < n; ++i)
+					{
+						rmax = math::max(rmax, math::abs(r(i, j)));
+						xmax = math::max(xmax, math::abs(x(i, j)));
+					}
+
+					if (!(rmax <= xmax * cte)) conv = false;
+					rel = math::max(rel, xmax > 0 ? rmax / xmax : rmax);
+				}
+
+				if (conv) return true;
+				if (iters >= max_iters || !(rel < 0.5 * prev)) return false;
+				prev = rel;
+
+				d = to_f32(r);
+				fac.solve_inplace(d);
+				x.derived() += to_f64(d);
+			}
+		}
+	}
+
+
+	/**
+	 * Solves a * x = b, with a factorized by lu_fac<float>.
+	 * a and b are not modified.
+	 */
+	template<class A, class B, class X>
+	mixed_solve_info gesv_mixed(const IRegularMatrix<A, double>& a, const IRegularMatrix<B, double>& b,
+			IRegularMatrix<X, double>& x, index_t max_iters = internal::mixed_default_max_iters)
+	{
+		LMAT_CHECK_PERCOL_CONT(X)
+		LMAT_CHECK_DIMS( a.nrows() == a.ncolumns() && a.nrows() == b.nrows() );
+
+		mixed_solve_info info;
+		bool ok = false;
+
+		try
+		{
+			lu_fac<float> fac(to_f32(a));
+			ok = internal::mixed_refine(fac, internal::mixed_ge_residual(), a, b, x, max_iters, info.iters);
+		}
+		catch (lapack_failure& )
+		{
+			ok = false;   // singular in single precision
+		}
+
+		if (!ok)
+		{
+			dense_matrix<double> a_(a);
+			x.derived() = b.derived();
+			gesv(a_, x);
+			info.fallback = true;
+		}
+
+		return info;
+	}
+
+
+	/**
+	 * Solves a * x = b for a positive definite a, factorized by chol_fac<float>.
+	 * Only the uplo triangle of a is read, by the factorization as well as
+	 * by the refinement (residuals are computed with symm).
+	 */
+	template<class A, class B, class X>
+	mixed_solve_info posv_mixed(const IRegularMatrix<A, double>& a, const IRegularMatrix<B, double>& b,
+			IRegularMatrix<X, double>& x, char uplo='L',
+			index_t max_iters = internal::mixed_default_max_iters)
+	{
+		LMAT_CHECK_PERCOL_CONT(X)
+		LMAT_CHECK_DIMS( a.nrows() == a.ncolumns() && a.nrows() == b.nrows() );
+
+		uplo = internal::check_chol_uplo(uplo);
+
+		mixed_solve_info info;
+		bool ok = false;
+
+		try
+		{
+			chol_fac<float> fac(to_f32(a), uplo);
+			ok = internal::mixed_refine(fac, internal::mixed_sy_residual(uplo), a, b, x, max_iters, info.iters);
+		}
+		catch (lapack_failure& )
+		{
+			ok = false;   // not positive definite in single precision
+		}
+
+		if (!ok)
+		{
+			dense_matrix<double> a_(a);
+			x.derived() = b.derived();
+			posv(a_, x, uplo);
+			info.fallback = true;
+		}
+
+		return info;
+	}
+
+} }
+
+#endif /* LAPACK_MIXED_H_ */
@@ -0,0 +1,148 @@
+/**
+ * @file lapack_rsvd.h
+ *
+ * @brief Randomized truncated Singular Value Decomposition
+ *
+ * The range of A is captured by a Gaussian sketch refined through
+ * a few power iterations (Halko, Martinsson, and Tropp, 2011).
+ * Only the small projected matrix is passed to gesdd.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_LAPACK_RSVD_H_
+#define LIGHTMAT_LAPACK_RSVD_H_
+
+#include <light_mat/math/math_base.h>
+#include <light_mat/linalg/blas_l3.h>
+#include <light_mat/linalg/lapack_qr.h>
+#include <light_mat/linalg/lapack_svd.h>
+#include <light_mat/random/rand_expr.h>
+
+namespace lmat { namespace lapack {
+
+	struct rsvd_options
+	{
+		index_t oversamples;	// number of extra sketch columns
+		index_t power_iters;	// number of power iterations
+
+		rsvd_options(index_t p=10, index_t q=2)
+		: oversamples(p), power_iters(q) { }
+	};
+
+
+	namespace internal
+	{
+		// replace y by an orthonormal basis of its range
+
+		template<typename T>
+		inline void rsvd_orth(dense_matrix<T>& y)
+		{
+			qr_fac<T> qf(y);
+			qf.getq(y, y.ncolumns());
+		}
+
+		template<typename T, class A, class RStream>
+		inline void rsvd_range(const IRegularMatrix<A, T>& a, index_t l, RStream& rs,
+				const rsvd_options& opts, dense_matrix<T>& q)
+		{
+			const index_t m = a.nrows();
+			const index_t n = a.ncolumns();
+
+			dense_matrix<T> omega = rand_mat(random::std_normal_distr<T>(), rs, n, l);
+
+			q.require_size(m, l);
+			blas::gemm(a, omega, q);
+			rsvd_orth(q);
+
+			// each half-step is re-orthonormalized, so that the
+			// small singular values are not lost to round-off
+
+			dense_matrix<T> z(n, l);
+			for (index_t t = 0; t < opts.power_iters; ++t)
+			{
+				blas::gemm(a, q, z, 'T', 'N');
+				rsvd_orth(z);
+
+				blas::gemm(a, z, q);
+				rsvd_orth(q);
+			}
+		}
+
+		template<typename T, class A, class RStream, class S, class U, class VT>
+		inline void _rsvd(const IRegularMatrix<A, T>& a, index_t k, RStream& rs,
+				IRegularMatrix<S, T>& s, IRegularMatrix<U, T>& u, IRegularMatrix<VT, T>& vt,
+				const rsvd_options& opts)
+		{
+			LMAT_CHECK_PERCOL_CONT(U)
+			LMAT_CHECK_PERCOL_CONT(VT)
+			LMAT_CHECK_WHOLE_CONT(S)
+
+			const index_t m = a.nrows();
+			const index_t n = a.ncolumns();
+			const index_t rk = math::min(m, n);
+
+			check_arg(k > 0 && k <= rk, "rsvd: k is out of range.");
+			check_arg(opts.oversamples >= 0 && opts.power_iters >= 0,
+					"rsvd: invalid options.");
+
+			const index_t l = math::min(k + opts.oversamples, rk);
+
+			// Q : m x l, with range(Q) ~ range(A)
+
+			dense_matrix<T> q;
+			rsvd_range(a, l, rs, opts, q);
+
+			// B = Q' * A : l x n, and B = Ub * S * Vt
+
+			dense_matrix<T> b(l, n);
+			blas::gemm(q, a, b, 'T', 'N');
+
+			dense_col<T> sb;
+			dense_matrix<T> ub;
+			dense_matrix<T> vtb;
+			gesdd(b, sb, ub, vtb, 'S');
+
+			// U = Q * Ub(:, 0:k)
+
+			s.require_size(k, 1);
+			u.require_size(m, k);
+			vt.require_size(k, n);
+
+			s.derived() = sb(range(0, k), whole());
+			blas::gemm(q, ub(whole(), range(0, k)), u);
+			vt.derived() = vtb(range(0, k), whole());
+		}
+	}
+
+
+	/**
+	 * Computes the leading k singular triplets of a, such that
+	 * a ~ u * diag(s) * vt, with u : m x k and vt : k x n.
+	 *
+	 * The sketch is drawn from rs. The accuracy improves with
+	 * opts.oversamples and (more markedly) opts.power_iters.
+	 */
+	template<class A, class RStream, class S, class U, class VT>
+	inline void rsvd(const IRegularMatrix<A, float>& a, index_t k, RStream& rs,
+			IRegularMatrix<S, float>& s, IRegularMatrix<U, float>& u, IRegularMatrix<VT, float>& vt,
+			const rsvd_options& opts = rsvd_options())
+	{
+		internal::_rsvd(a, k, rs, s, u, vt, opts);
+	}
+
+	template<class A, class RStream, class S, class U, class VT>
+	inline void rsvd(const IRegularMatrix<A, double>& a, index_t k, RStream& rs,
+			IRegularMatrix<S, double>& s, IRegularMatrix<U, double>& u, IRegularMatrix<VT, double>& vt,
+			const rsvd_options& opts = rsvd_options())
+	{
+		internal::_rsvd(a, k, rs, s, u, vt, opts);
+	}
+
+} }
+
+#endif /* LAPACK_RSVD_H_ */
@@ -0,0 +1,435 @@
+/**
+ * @file lapack_tsqr.h
+ *
+ * @brief Tall-skinny QR factorization (TSQR)
+ *
+ * The rows are split into blocks that are factorized independently,
+ * and the resulting R factors are combined pairwise in a binary tree
+ * (Demmel, Grigori, Hoemmen, and Langou, 2012). Q is only kept in
+ * implicit form, as the Householder reflectors of each tree node.
+ *
+ * tsqr_stream is the sequential (flat tree) variant that consumes row
+ * blocks one by one, so that a least-squares problem can be solved
+ * without holding the whole matrix.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_LAPACK_TSQR_H_
+#define LIGHTMAT_LAPACK_TSQR_H_
+
+#include <light_mat/math/math_base.h>
+#include <light_mat/linalg/blas_l3.h>
+#include <light_mat/linalg/lapack_qr.h>
+
+#include <vector>
+
+namespace lmat { namespace lapack {
+
+	namespace internal
+	{
+		const index_t tsqr_default_block_rows = 4096;
+
+		// [a; b] (a : ma x n, b : mb x n)
+
+		template<typename T, class A, class B>
+		inline void tsqr_stack(const IMatrixXpr<A, T>& a, const IMatrixXpr<B, T>& b, dense_matrix<T>& s)
+		{
+			const index_t ma = a.nrows();
+			const index_t mb = b.nrows();
+
+			s.require_size(ma + mb, a.ncolumns());
+			if (ma > 0) s(range(0, ma), whole()) = a.derived();
+			if (mb > 0) s(range(ma, mb), whole()) = b.derived();
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  TSQR with a reduction tree
+	 *
+	 ********************************************/
+
+	template<typename T>
+	class tsqr_fac
+	{
+	public:
+		explicit tsqr_fac(index_t block_rows=0)
+		: m_nrows(0), m_ncols(0), m_brows(block_rows) { }
+
+		template<class Mat>
+		explicit tsqr_fac(const IRegularMatrix<Mat, T>& mat, index_t block_rows=0)
+		: m_nrows(0), m_ncols(0), m_brows(block_rows)
+		{
+			set(mat);
+		}
+
+		index_t nrows() const
+		{
+			return m_nrows;
+		}
+
+		index_t ncolumns() const
+		{
+			return m_ncols;
+		}
+
+		index_t nblocks() const
+		{
+			return m_levels.empty() ? 0 : (index_t)m_levels[0].size();
+		}
+
+		index_t depth() const
+		{
+			return (index_t)m_levels.size();
+		}
+
+		template<class Mat>
+		void set(const IRegularMatrix<Mat, T>& mat)
+		{
+			const index_t m = mat.nrows();
+			const index_t n = mat.ncolumns();
+
+			check_arg(m >= n, "tsqr_fac: TSQR only applies when m >= n.");
+
+			m_nrows = m;
+			m_ncols = n;
+
+			// row blocks (each has at least n rows, the last one takes the remainder)
+
+			index_t br = m_brows > 0 ? m_brows : internal::tsqr_default_block_rows;
+			br = math::max(br, math::max(n, index_t(1)));
+
+			const index_t nb = math::max(m / br, index_t(1));
+
+			m_offsets.resize((size_t)(nb + 1));
+			for (index_t i = 0; i < nb; ++i) m_offsets[(size_t)i] = i * br;
+			m_offsets[(size_t)nb] = m;
+
+			m_levels.clear();
+			m_levels.push_back(std::vector<qr_fac<T> >((size_t)nb));
+
+			std::vector<qr_fac<T> >& leaves = m_levels[0];
+			const Mat& a = mat.derived();
+
+#ifdef _OPENMP
+#pragma omp parallel for if (nb > 1)
+#endif
+			for (index_t i = 0; i < nb; ++i)
+			{
+				const index_t r0 = m_offsets[(size_t)i];
+				const index_t mi = m_offsets[(size_t)(i + 1)] - r0;
+				leaves[(size_t)i].set(a(range(r0, mi), whole()));
+			}
+
+			// combine the R factors pairwise (a level only holds the
+			// nodes of its pairs, an unpaired R is carried up as it is)
+
+			index_t cnt = nb;
+			while (cnt > 1)
+			{
+				const index_t np = cnt / 2;
+				const size_t lb = m_levels.size() - 1;
+
+				std::vector<qr_fac<T> > nodes((size_t)np);
+
+#ifdef _OPENMP
+#pragma omp parallel for if (np > 1)
+#endif
+				for (index_t k = 0; k < np; ++k)
+				{
+					dense_matrix<T> ra, rb, s;
+					rnode(lb, 2 * k).getr(ra, n);
+					rnode(lb, 2 * k + 1).getr(rb, n);
+
+					internal::tsqr_stack(ra, rb, s);
+					nodes[(size_t)k].set(s);
+				}
+
+				m_levels.push_back(nodes);
+				cnt = (cnt + 1) / 2;
+			}
+		}
+
+		template<class R>
+		void getr(IRegularMatrix<R, T>& r) const
+		{
+			if (m_levels.empty())  // nothing factorized: an empty R
+			{
+				r.require_size(m_ncols, m_ncols);
+				return;
+			}
+			rnode(m_levels.size() - 1, 0).getr(r, m_ncols);
+		}
+
+		// y = Q' * b (y : n x nrhs)
+
+		template<class B, class Y>
+		void multq_t(const IRegularMatrix<B, T>& b, IRegularMatrix<Y, T>& y) const
+		{
+			LMAT_CHECK_DIMS( b.nrows() == m_nrows );
+
+			const index_t n = m_ncols;
+			const index_t nrhs = b.ncolumns();
+			const B& b_ = b.derived();
+
+			// leaves
+
+			const index_t nb = nblocks();
+			std::vector<dense_matrix<T> > cs((size_t)nb);
+
+#ifdef _OPENMP
+#pragma omp parallel for if (nb > 1)
+#endif
+			for (index_t i = 0; i < nb; ++i)
+			{
+				const index_t r0 = m_offsets[(size_t)i];
+				const index_t mi = m_offsets[(size_t)(i + 1)] - r0;
+
+				dense_matrix<T> s(b_(range(r0, mi), whole()));
+				m_levels[0][(size_t)i].multq_inplace(s, 'T', 'L');
+				cs[(size_t)i] = s(range(0, n), whole());
+			}
+
+			// tree
+
+			for (size_t l = 1; l < m_levels.size(); ++l)
+			{
+				const std::vector<qr_fac<T> >& nodes = m_levels[l];
+				const index_t cnt = (index_t)cs.size();
+				std::vector<dense_matrix<T> > up(nodes.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for if (cnt > 3)
+#endif
+				for (index_t k = 0; k < (index_t)nodes.size(); ++k)
+				{
+					dense_matrix<T> s;
+					internal::tsqr_stack(cs[(size_t)(2 * k)], cs[(size_t)(2 * k + 1)], s);
+					nodes[(size_t)k].multq_inplace(s, 'T', 'L');
+					up[(size_t)k] = s(range(0, n), whole());
+				}
+
+				if (cnt % 2 == 1) up.push_back(cs[(size_t)(cnt - 1)]);
+				cs.swap(up);
+			}
+
+			y.require_size(n, nrhs);
+			if (nb > 0) y.derived() = cs[0];
+		}
+
+		// y = Q * c (c : n x nrhs, y : m x nrhs)
+
+		template<class C, class Y>
+		void multq(const IMatrixXpr<C, T>& c, IRegularMatrix<Y, T>& y) const
+		{
+			LMAT_CHECK_DIMS( c.nrows() == m_ncols );
+
+			const index_t n = m_ncols;
+			const index_t nrhs = c.ncolumns();
+
+			std::vector<dense_matrix<T> > cs(1);
+			cs[0] = c.derived();
+
+			// tree (top-down)
+
+			for (size_t l = m_levels.size(); l-- > 1; )
+			{
+				const std::vector<qr_fac<T> >& nodes = m_levels[l];
+				const index_t np = (index_t)nodes.size();
+				const bool carried = (index_t)cs.size() > np;
+
+				const index_t cnt = 2 * np + (carried ? 1 : 0);
+				std::vector<dense_matrix<T> > down((size_t)cnt);
+
+#ifdef _OPENMP
+#pragma omp parallel for if (np > 1)
+#endif
+				for (index_t k = 0; k < np; ++k)
+				{
+					dense_matrix<T> s(2 * n, nrhs, zero());
+					s(range(0, n), whole()) = cs[(size_t)k];
+					nodes[(size_t)k].multq_inplace(s, 'N', 'L');
+
+					down[(size_t)(2 * k)] = s(range(0, n), whole());
+					down[(size_t)(2 * k + 1)] = s(range(n, n), whole());
+				}
+
+				if (carried) down[(size_t)(cnt - 1)] = cs[(size_t)np];
+				cs.swap(down);
+			}
+
+			// leaves
+
+			y.require_size(m_nrows, nrhs);
+			const index_t nb = nblocks();
+
+#ifdef _OPENMP
+#pragma omp parallel for if (nb > 1)
+#endif
+			for (index_t i = 0; i < nb; ++i)
+			{
+				const index_t r0 = m_offsets[(size_t)i];
+				const index_t mi = m_offsets[(size_t)(i + 1)] - r0;
+
+				dense_matrix<T> s(mi, nrhs, zero());
+				s(range(0, n), whole()) = cs[(size_t)i];
+				m_levels[0][(size_t)i].multq_inplace(s, 'N', 'L');
+
+				y.derived()(range(r0, mi), whole()) = s;
+			}
+		}
+
+		// least-squares solution of a * x = b (x : n x nrhs)
+
+		template<class B, class X>
+		void solve(const IRegularMatrix<B, T>& b, IRegularMatrix<X, T>& x) const
+		{
+			LMAT_CHECK_PERCOL_CONT(X)
+
+			multq_t(b, x);
+			if (m_levels.empty()) return;
+
+			dense_matrix<T> r;
+			getr(r);
+			blas::trsm(r, x, blas::trs('U'), 'L');
+		}
+
+	private:
+		// the node with the R factor of the i-th element at level l
+
+		const qr_fac<T>& rnode(size_t l, index_t i) const
+		{
+			while (l > 0 && i >= (index_t)m_levels[l].size())
+			{
+				i *= 2;   // carried up from the last element below
+				--l;
+			}
+			return m_levels[l][(size_t)i];
+		}
+
+	private:
+		index_t m_nrows;
+		index_t m_ncols;
+		index_t m_brows;
+
+		std::vector<index_t> m_offsets;
+		std::vector<std::vector<qr_fac<T> > > m_levels;
+	};
+
+
+	/********************************************
+	 *
+	 *  Streaming TSQR (for out-of-core problems)
+	 *
+	 ********************************************/
+
+	template<typename T>
+	class tsqr_stream
+	{
+	public:
+		tsqr_stream(index_t n, index_t nrhs=0)
+		: m_nrows(0), m_ncols(n), m_nrhs(nrhs), m_r(0, n), m_c(0, nrhs) { }
+
+		index_t nrows() const
+		{
+			return m_nrows;
+		}
+
+		index_t ncolumns() const
+		{
+			return m_ncols;
+		}
+
+		bool ready() const
+		{
+			return m_r.nrows() == m_ncols;
+		}
+
+		// consume the next row block of [a, b]
+
+		template<class A, class B>
+		void add(const IMatrixXpr<A, T>& a, const IMatrixXpr<B, T>& b)
+		{
+			LMAT_CHECK_DIMS( b.ncolumns() == m_nrhs && a.nrows() == b.nrows() );
+
+			qr_fac<T> qf;
+			const index_t k = add_rows(a, qf);
+
+			if (m_nrhs > 0)
+			{
+				dense_matrix<T> sc;
+				internal::tsqr_stack(m_c, b, sc);
+				qf.multq_inplace(sc, 'T', 'L');
+				m_c = sc(range(0, k), whole());
+			}
+		}
+
+		template<class A>
+		void add(const IMatrixXpr<A, T>& a)
+		{
+			check_arg(m_nrhs == 0, "tsqr_stream::add: the right hand sides are missing.");
+
+			qr_fac<T> qf;
+			add_rows(a, qf);
+		}
+
+		template<class R>
+		void getr(IRegularMatrix<R, T>& r) const
+		{
+			r.derived() = m_r;
+		}
+
+		// Q' * b, accumulated over all rows so far
+
+		template<class Y>
+		void getqtb(IRegularMatrix<Y, T>& y) const
+		{
+			y.derived() = m_c;
+		}
+
+		template<class X>
+		void solve(IRegularMatrix<X, T>& x) const
+		{
+			LMAT_CHECK_PERCOL_CONT(X)
+			check_arg(ready(), "tsqr_stream::solve: fewer rows than columns have been added.");
+
+			x.derived() = m_c;
+			blas::trsm(m_r, x, blas::trs('U'), 'L');
+		}
+
+	private:
+		template<class A>
+		index_t add_rows(const IMatrixXpr<A, T>& a, qr_fac<T>& qf)
+		{
+			LMAT_CHECK_DIMS( a.ncolumns() == m_ncols );
+
+			dense_matrix<T> s;
+			internal::tsqr_stack(m_r, a, s);
+
+			const index_t k = math::min(s.nrows(), m_ncols);
+
+			qf.set(s);
+			qf.getr(m_r, k);
+
+			m_nrows += a.nrows();
+			return k;
+		}
+
+	private:
+		index_t m_nrows;
+		index_t m_ncols;
+		index_t m_nrhs;
+
+		dense_matrix<T> m_r;	// k x n, upper triangular
+		dense_matrix<T> m_c;	// k x nrhs
+	};
+
+} }
+
+#endif /* LAPACK_TSQR_H_ */
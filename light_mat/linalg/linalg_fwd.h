@@ -15,6 +15,7 @@
 
 #include <light_mat/config/config.h>
 #include <light_mat/matrix/matrix_classes.h>
+#include <complex>
 
 
 #ifdef MX_API_VER  // When in MATLAB mex
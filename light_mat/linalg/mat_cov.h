@@ -0,0 +1,107 @@
+/**
+ * @file mat_cov.h
+ *
+ * @brief Covariance matrix computation (based on BLAS syrk)
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_MAT_COV_H_
+#define LIGHTMAT_MAT_COV_H_
+
+#include <light_mat/linalg/blas_l3.h>
+#include <light_mat/mateval/mat_reduce.h>
+#include <light_mat/matexpr/repvec_expr.h>
+#include <light_mat/matrix/dense_matrix.h>
+
+namespace lmat
+{
+	namespace internal
+	{
+		// number of rows to be centered & accumulated at a time,
+		// such that the block buffer stays within L2 cache
+
+		const index_t cov_block_elems = index_t(1) << 15;
+
+		LMAT_ENSURE_INLINE
+		inline index_t cov_block_rows(index_t m, index_t n)
+		{
+			index_t b = cov_block_elems / (n > 0 ? n : 1);
+			if (b < 64) b = 64;
+			return b < m ? b : m;
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  cov
+	 *
+	 *  x:  an m x n matrix, where each row is
+	 *      an observation, and each column is
+	 *      a variable
+	 *
+	 *  mu: the 1 x n row of column means
+	 *
+	 *  c:  an n x n covariance matrix,
+	 *      normalized by (m - 1)
+	 *
+	 *  The rows are centered block by block into
+	 *  a small buffer, and each block is
+	 *  accumulated to c with a rank-k update
+	 *  (syrk). Hence, no centered copy of the
+	 *  entire x is ever materialized.
+	 *
+	 ********************************************/
+
+	template<typename T, class X, class C, class Mu>
+	void cov(const IRegularMatrix<X, T>& x, const IRegularMatrix<Mu, T>& mu, IRegularMatrix<C, T>& c)
+	{
+		const index_t m = x.nrows();
+		const index_t n = x.ncolumns();
+
+		LMAT_CHECK_DIMS( mu.nrows() == 1 && mu.ncolumns() == n );
+		LMAT_CHECK_DIMS( c.nrows() == n && c.ncolumns() == n );
+
+		if (m < 2)
+		{
+			fill(c, m == 1 ? T(0) : std::numeric_limits<T>::quiet_NaN());
+			return;
+		}
+
+		const T alpha = T(1) / T(m - 1);
+		const index_t bm = internal::cov_block_rows(m, n);
+
+		dense_matrix<T> buf(bm, n);
+
+		T beta = T(0);
+		for (index_t i = 0; i < m; i += bm)
+		{
+			const index_t mb = bm < m - i ? bm : m - i;
+
+			auto bv = buf(range(0, mb), whole());
+			bv = x.derived()(range(i, mb), whole()) - reprow(mu, mb);
+
+			blas::syrk(alpha, bv, beta, c, 'T', 'L');
+			beta = T(1);
+		}
+
+		internal::complete_sym(n, c, 'L');
+	}
+
+
+	template<typename T, class X, class C>
+	inline void cov(const IRegularMatrix<X, T>& x, IRegularMatrix<C, T>& c)
+	{
+		dense_row<T> mu(x.ncolumns());
+		colwise_mean(x, mu);
+		cov(x, mu, c);
+	}
+
+}
+
+#endif
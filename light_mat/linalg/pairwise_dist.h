@@ -0,0 +1,370 @@
+/**
+ * @file pairwise_dist.h
+ *
+ * @brief Pairwise distances between two sets of samples
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_PAIRWISE_DIST_H_
+#define LIGHTMAT_PAIRWISE_DIST_H_
+
+#include <light_mat/linalg/blas_l3.h>
+#include <light_mat/mateval/mat_reduce.h>
+#include <light_mat/matexpr/repvec_expr.h>
+#include <light_mat/matrix/dense_matrix.h>
+
+namespace lmat
+{
+	namespace metrics
+	{
+		struct sqL2_ { };    // squared Euclidean
+		struct L2_ { };      // Euclidean
+		struct cosine_ { };  // 1 - cos(x, y)  (1 if x or y is zero)
+		struct L1_ { };      // city-block
+		struct Linf_ { };    // Chebyshev
+	}
+
+
+	namespace internal
+	{
+		/********************************************
+		 *
+		 *  tiling
+		 *
+		 *  The distance matrix is computed tile by
+		 *  tile, such that the samples involved in
+		 *  a tile (and the tile itself) stay in
+		 *  cache while the epilogue is applied.
+		 *
+		 *  For symmetric results, the diagonal is
+		 *  set to the exact dist(x, x) given by
+		 *  tfun.diag(j), rather than the rounded
+		 *  value of the tile.
+		 *
+		 ********************************************/
+
+		const index_t pdist_tile_m = 128;
+		const index_t pdist_tile_n = 128;
+
+		template<typename T, class X, class Y, class D, class TileFun>
+		inline void pdist_tiles(const X& x, const Y& y, D& d, bool sym, const TileFun& tfun)
+		{
+			const index_t m = x.ncolumns();
+			const index_t n = y.ncolumns();
+
+			for (index_t j = 0; j < n; j += pdist_tile_n)
+			{
+				const index_t nb = pdist_tile_n < n - j ? pdist_tile_n : n - j;
+
+				// for symmetric results, only tiles on or above the diagonal are computed
+				const index_t ie = sym ? j + nb : m;
+
+				for (index_t i = 0; i < ie; i += pdist_tile_m)
+				{
+					const index_t mb = pdist_tile_m < ie - i ? pdist_tile_m : ie - i;
+					tfun(i, mb, j, nb);
+				}
+			}
+
+			if (sym)
+			{
+				for (index_t j = 0; j < n; ++j)
+				{
+					d(j, j) = tfun.diag(j);
+					for (index_t i = j + 1; i < n; ++i) d(i, j) = d(j, i);
+				}
+			}
+		}
+
+
+		/********************************************
+		 *
+		 *  gemm-based metrics
+		 *
+		 *  |x - y|^2 = |x|^2 + |y|^2 - 2 x'y
+		 *
+		 *  The norms are computed once, and the
+		 *  add & sqrt/clamp epilogue is applied to
+		 *  each tile right after its gemm.
+		 *
+		 ********************************************/
+
+		template<typename T, class X, class Y, class D>
+		struct pdist_sqL2_tiles
+		{
+			const X& x;
+			const Y& y;
+			D& d;
+			const dense_col<T>& xn;
+			const dense_row<T>& yn;
+			bool take_sqrt;
+
+			T diag(index_t ) const { return T(0); }
+
+			void operator() (index_t i, index_t mb, index_t j, index_t nb) const
+			{
+				auto dt = d(range(i, mb), range(j, nb));
+				blas::gemm(T(-2), x(whole(), range(i, mb)), y(whole(), range(j, nb)), T(0), dt, 'T', 'N');
+
+				if (take_sqrt)
+					dt = sqrt(max(repcol(xn(range(i, mb)), nb) + reprow(yn(range(j, nb)), mb) + dt, T(0)));
+				else
+					dt = max(repcol(xn(range(i, mb)), nb) + reprow(yn(range(j, nb)), mb) + dt, T(0));
+			}
+		};
+
+		template<typename T, class X, class Y, class D>
+		struct pdist_cosine_tiles
+		{
+			const X& x;
+			const Y& y;
+			D& d;
+			const dense_col<T>& xr;  // reciprocal norms
+			const dense_row<T>& yr;
+
+			// 1 for a zero column, as for the other distances involving it
+			T diag(index_t j) const { return xr[j] > T(0) ? T(0) : T(1); }
+
+			void operator() (index_t i, index_t mb, index_t j, index_t nb) const
+			{
+				auto dt = d(range(i, mb), range(j, nb));
+				blas::gemm(T(1), x(whole(), range(i, mb)), y(whole(), range(j, nb)), T(0), dt, 'T', 'N');
+
+				dt = T(1) - dt * repcol(xr(range(i, mb)), nb) * reprow(yr(range(j, nb)), mb);
+			}
+		};
+
+		template<typename T, class X, class Y, class D>
+		inline void pdist_sqL2(const X& x, const Y& y, D& d, bool sym, bool take_sqrt)
+		{
+			dense_col<T> xn(x.ncolumns());
+			colwise_sqsum(x, xn);
+
+			dense_row<T> yn(y.ncolumns());
+			if (sym) copy(xn.ptr_data(), yn); else colwise_sqsum(y, yn);
+
+			pdist_sqL2_tiles<T, X, Y, D> tf = {x, y, d, xn, yn, take_sqrt};
+			pdist_tiles<T>(x, y, d, sym, tf);
+		}
+
+		// squared norms -> reciprocal norms, with 0 for a zero column
+		// (which has no direction), so that its distances are 1, not NaN
+
+		template<typename T>
+		inline void pdist_rnorms(index_t n, T *r)
+		{
+			for (index_t i = 0; i < n; ++i)
+				r[i] = r[i] > T(0) ? T(1) / math::sqrt(r[i]) : T(0);
+		}
+
+		template<typename T, class X, class Y, class D>
+		inline void pdist_cosine(const X& x, const Y& y, D& d, bool sym)
+		{
+			dense_col<T> xr(x.ncolumns());
+			colwise_sqsum(x, xr);
+			pdist_rnorms(xr.nelems(), xr.ptr_data());
+
+			dense_row<T> yr(y.ncolumns());
+			if (sym) copy(xr.ptr_data(), yr); else { colwise_sqsum(y, yr); pdist_rnorms(yr.nelems(), yr.ptr_data()); }
+
+			pdist_cosine_tiles<T, X, Y, D> tf = {x, y, d, xr, yr};
+			pdist_tiles<T>(x, y, d, sym, tf);
+		}
+
+
+		/********************************************
+		 *
+		 *  direct metrics (SIMD over features)
+		 *
+		 ********************************************/
+
+		template<typename T>
+		inline T vdist_L1(index_t len, const T *x, const T *y)
+		{
+			typedef simd_pack<T, default_simd_kind> pack_t;
+			const index_t W = (index_t)pack_t::pack_width;
+
+			pack_t s0 = pack_t::zeros();
+			pack_t s1 = pack_t::zeros();
+			pack_t a, b;
+
+			index_t k = 0;
+			for (; k + 2 * W <= len; k += 2 * W)
+			{
+				a.load_u(x + k);     b.load_u(y + k);     s0 += math::abs(a - b);
+				a.load_u(x + k + W); b.load_u(y + k + W); s1 += math::abs(a - b);
+			}
+			if (k + W <= len)
+			{
+				a.load_u(x + k); b.load_u(y + k); s0 += math::abs(a - b);
+				k += W;
+			}
+
+			T s = sum(s0 + s1);
+			for (; k < len; ++k) s += math::abs(x[k] - y[k]);
+			return s;
+		}
+
+		template<typename T>
+		inline T vdist_Linf(index_t len, const T *x, const T *y)
+		{
+			typedef simd_pack<T, default_simd_kind> pack_t;
+			const index_t W = (index_t)pack_t::pack_width;
+
+			pack_t s0 = pack_t::zeros();
+			pack_t s1 = pack_t::zeros();
+			pack_t a, b;
+
+			index_t k = 0;
+			for (; k + 2 * W <= len; k += 2 * W)
+			{
+				a.load_u(x + k);     b.load_u(y + k);     s0 = math::max(s0, math::abs(a - b));
+				a.load_u(x + k + W); b.load_u(y + k + W); s1 = math::max(s1, math::abs(a - b));
+			}
+			if (k + W <= len)
+			{
+				a.load_u(x + k); b.load_u(y + k); s0 = math::max(s0, math::abs(a - b));
+				k += W;
+			}
+
+			T s = maximum(math::max(s0, s1));
+			for (; k < len; ++k) s = math::max(s, math::abs(x[k] - y[k]));
+			return s;
+		}
+
+		struct vdist_L1_fun
+		{
+			template<typename T>
+			LMAT_ENSURE_INLINE
+			T operator() (index_t len, const T *x, const T *y) const { return vdist_L1(len, x, y); }
+		};
+
+		struct vdist_Linf_fun
+		{
+			template<typename T>
+			LMAT_ENSURE_INLINE
+			T operator() (index_t len, const T *x, const T *y) const { return vdist_Linf(len, x, y); }
+		};
+
+		template<typename T, class X, class Y, class D, class VFun>
+		struct pdist_direct_tiles
+		{
+			const X& x;
+			const Y& y;
+			D& d;
+			VFun vfun;
+
+			T diag(index_t ) const { return T(0); }
+
+			void operator() (index_t i, index_t mb, index_t j, index_t nb) const
+			{
+				const index_t len = x.nrows();
+				const index_t xs = x.col_stride();
+				const index_t ys = y.col_stride();
+
+				for (index_t jj = j; jj < j + nb; ++jj)
+				{
+					const T *py = y.ptr_data() + jj * ys;
+					for (index_t ii = i; ii < i + mb; ++ii)
+					{
+						d(ii, jj) = vfun(len, x.ptr_data() + ii * xs, py);
+					}
+				}
+			}
+		};
+
+		template<typename T, class X, class Y, class D, class VFun>
+		inline void pdist_direct(const X& x, const Y& y, D& d, bool sym, VFun vfun)
+		{
+			pdist_direct_tiles<T, X, Y, D, VFun> tf = {x, y, d, vfun};
+			pdist_tiles<T>(x, y, d, sym, tf);
+		}
+
+
+		// dispatch on metrics
+
+		template<typename T, class X, class Y, class D>
+		LMAT_ENSURE_INLINE
+		inline void pdist_(const X& x, const Y& y, D& d, bool sym, metrics::sqL2_)
+		{
+			pdist_sqL2<T>(x, y, d, sym, false);
+		}
+
+		template<typename T, class X, class Y, class D>
+		LMAT_ENSURE_INLINE
+		inline void pdist_(const X& x, const Y& y, D& d, bool sym, metrics::L2_)
+		{
+			pdist_sqL2<T>(x, y, d, sym, true);
+		}
+
+		template<typename T, class X, class Y, class D>
+		LMAT_ENSURE_INLINE
+		inline void pdist_(const X& x, const Y& y, D& d, bool sym, metrics::cosine_)
+		{
+			pdist_cosine<T>(x, y, d, sym);
+		}
+
+		template<typename T, class X, class Y, class D>
+		LMAT_ENSURE_INLINE
+		inline void pdist_(const X& x, const Y& y, D& d, bool sym, metrics::L1_)
+		{
+			pdist_direct<T>(x, y, d, sym, vdist_L1_fun());
+		}
+
+		template<typename T, class X, class Y, class D>
+		LMAT_ENSURE_INLINE
+		inline void pdist_(const X& x, const Y& y, D& d, bool sym, metrics::Linf_)
+		{
+			pdist_direct<T>(x, y, d, sym, vdist_Linf_fun());
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  pairwise_distance
+	 *
+	 *  x:  d x m, each column is a sample
+	 *  y:  d x n, each column is a sample
+	 *  r:  m x n, r(i, j) = dist(x_i, y_j)
+	 *
+	 *  The single-set version computes the
+	 *  (symmetric) distances between the columns
+	 *  of x, and only evaluates half of them.
+	 *
+	 ********************************************/
+
+	template<typename T, class X, class Y, class D, class Metric>
+	inline void pairwise_distance(const IRegularMatrix<X, T>& x, const IRegularMatrix<Y, T>& y,
+			IRegularMatrix<D, T>& r, Metric metric)
+	{
+		LMAT_CHECK_PERCOL_CONT(X)
+		LMAT_CHECK_PERCOL_CONT(Y)
+		LMAT_CHECK_PERCOL_CONT(D)
+
+		LMAT_CHECK_DIMS( x.nrows() == y.nrows() );
+		LMAT_CHECK_DIMS( r.nrows() == x.ncolumns() && r.ncolumns() == y.ncolumns() );
+
+		internal::pdist_<T>(x.derived(), y.derived(), r.derived(), false, metric);
+	}
+
+	template<typename T, class X, class D, class Metric>
+	inline void pairwise_distance(const IRegularMatrix<X, T>& x,
+			IRegularMatrix<D, T>& r, Metric metric)
+	{
+		LMAT_CHECK_PERCOL_CONT(X)
+		LMAT_CHECK_PERCOL_CONT(D)
+
+		LMAT_CHECK_DIMS( r.nrows() == x.ncolumns() && r.ncolumns() == x.ncolumns() );
+
+		internal::pdist_<T>(x.derived(), x.derived(), r.derived(), true, metric);
+	}
+
+}
+
+#endif
@@ -43,6 +43,7 @@ namespace lmat
 	};
 
 	LMAT_DEF_SIMD_SUPPORT( copy_kernel )
+	LMAT_DEF_COMPLEX_SIMD_SUPPORT( copy_kernel )
 
 	template<typename Fun>
 	struct map_kernel
@@ -94,6 +95,7 @@ namespace lmat
 	};
 
 	LMAT_DEF_SIMD_SUPPORT( accum_kernel )
+	LMAT_DEF_COMPLEX_SIMD_SUPPORT( accum_kernel )
 
 	template<typename T>
 	struct accumx_kernel
@@ -107,7 +109,22 @@ namespace lmat
 		}
 	};
 
+	// the packed version uses (fused, when available) multiply-add
+
+	template<typename T, typename Kind>
+	struct accumx_kernel<simd_pack<T, Kind> >
+	{
+		typedef simd_pack<T, Kind> value_type;
+
+		LMAT_ENSURE_INLINE
+		void operator() (value_type& a, const value_type& c, const value_type& x) const
+		{
+			a = math::fma(x, c, a);
+		}
+	};
+
 	LMAT_DEF_SIMD_SUPPORT( accumx_kernel )
+	LMAT_DEF_COMPLEX_SIMD_SUPPORT( accumx_kernel )
 
 }
 
@@ -42,35 +42,35 @@ namespace lmat
 			return m_kernel;
 		}
 
-		template<typename U, typename... Wraps>
+		template<typename U, typename S, typename... Wraps>
 		LMAT_ENSURE_INLINE
-		void eval(macc_<linear_, U>, index_t m, index_t n, const Wraps&... wraps) const
+		void eval(macc_<linear_, U, S>, index_t m, index_t n, const Wraps&... wraps) const
 		{
 			dimension<0> dim(m * n);
-			internal::_linear_ewise_eval(dim, U(), m_kernel, make_vec_accessor(U(), wraps)...);
+			internal::_linear_ewise_eval(dim, U(), m_kernel, internal::apply_store_hint(S(), make_vec_accessor(U(), wraps))...);
 		}
 
-		template<typename U, index_t CM, index_t CN, typename... Wraps>
+		template<typename U, typename S, index_t CM, index_t CN, typename... Wraps>
 		LMAT_ENSURE_INLINE
-		void eval(macc_<linear_, U>, const matrix_shape<CM, CN>& shape, const Wraps&... wraps) const
+		void eval(macc_<linear_, U, S>, const matrix_shape<CM, CN>& shape, const Wraps&... wraps) const
 		{
 			dimension<CM * CN> dim(shape.nelems());
-			internal::_linear_ewise_eval(dim, U(), m_kernel, make_vec_accessor(U(), wraps)...);
+			internal::_linear_ewise_eval(dim, U(), m_kernel, internal::apply_store_hint(S(), make_vec_accessor(U(), wraps))...);
 		}
 
-		template<typename U, typename... Wraps>
+		template<typename U, typename S, typename... Wraps>
 		LMAT_ENSURE_INLINE
-		void eval(macc_<percol_, U>, index_t m, index_t n, const Wraps&... wraps) const
+		void eval(macc_<percol_, U, S>, index_t m, index_t n, const Wraps&... wraps) const
 		{
 			matrix_shape<0, 0> shape(m, n);
-			internal::_percol_ewise_eval(shape, U(), m_kernel, make_multicol_accessor(U(), wraps)...);
+			internal::_percol_ewise_eval(shape, U(), m_kernel, internal::apply_store_hint(S(), make_multicol_accessor(U(), wraps))...);
 		}
 
-		template<typename U, index_t CM, index_t CN, typename... Wraps>
+		template<typename U, typename S, index_t CM, index_t CN, typename... Wraps>
 		LMAT_ENSURE_INLINE
-		void eval(macc_<percol_, U>, const matrix_shape<CM, CN>& shape, const Wraps&... wraps) const
+		void eval(macc_<percol_, U, S>, const matrix_shape<CM, CN>& shape, const Wraps&... wraps) const
 		{
-			internal::_percol_ewise_eval(shape, U(), m_kernel, make_multicol_accessor(U(), wraps)...);
+			internal::_percol_ewise_eval(shape, U(), m_kernel, internal::apply_store_hint(S(), make_multicol_accessor(U(), wraps))...);
 		}
 
 		template<typename... Wraps>
@@ -155,18 +155,42 @@ namespace lmat
 	 *
 	 ********************************************/
 
-	template<typename T, typename Acc, typename U, class Expr, class DMat>
+	template<typename T, typename Acc, typename U, typename S, class Expr, class DMat>
 	LMAT_ENSURE_INLINE
-	inline void macc_evaluate(const IEWiseMatrix<Expr, T>& s, IRegularMatrix<DMat, T>& d, macc_<Acc, U> policy)
+	inline void macc_evaluate(const IEWiseMatrix<Expr, T>& s, IRegularMatrix<DMat, T>& d, macc_<Acc, U, S> policy)
 	{
 		ewise(copy_kernel<T>()).eval(policy, common_shape(s.derived(), d.derived()), in_(s), out_(d));
 	}
 
+	namespace internal
+	{
+		template<typename T, class Expr, class DMat>
+		LMAT_ENSURE_INLINE
+		inline void _macc_evaluate(const IEWiseMatrix<Expr, T>& s, IRegularMatrix<DMat, T>& d, meta::false_)
+		{
+			ewise(copy_kernel<T>())(common_shape(s.derived(), d.derived()), in_(s), out_(d));
+		}
+
+		// all row-major: evaluates the transpose (see macc_policy.h)
+
+		template<typename T, class Expr, class DMat>
+		LMAT_ENSURE_INLINE
+		inline void _macc_evaluate(const IEWiseMatrix<Expr, T>& s, IRegularMatrix<DMat, T>& d, meta::true_)
+		{
+			typedef typename preferred_expr_macc_policy<Expr, DMat>::type policy_t;
+
+			rowmajor_transpose<Expr> ts(s.derived());
+			typename rowmajor_dest_transpose<DMat>::type td = trans_view(d.derived());
+
+			ewise(copy_kernel<T>()).eval(policy_t(), common_shape(ts.get(), td), in_(ts.get()), out_(td));
+		}
+	}
+
 	template<typename T, class Expr, class DMat>
 	LMAT_ENSURE_INLINE
 	inline void macc_evaluate(const IEWiseMatrix<Expr, T>& s, IRegularMatrix<DMat, T>& d)
 	{
-		ewise(copy_kernel<T>())(common_shape(s.derived(), d.derived()), in_(s), out_(d));
+		internal::_macc_evaluate(s, d, meta::bool_<rowmajor_evaluable<Expr, DMat>::value>());
 	}
 
 }
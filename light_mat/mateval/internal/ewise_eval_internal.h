@@ -21,6 +21,52 @@
 
 namespace lmat { namespace internal {
 
+	/********************************************
+	 *
+	 *  store hints
+	 *
+	 *  An explicit hint in the macc policy forces
+	 *  or forbids streaming stores on contiguous
+	 *  writers. Other accessors are unaffected.
+	 *
+	 ********************************************/
+
+	template<typename S, class Accessor>
+	LMAT_ENSURE_INLINE
+	inline const Accessor& apply_store_hint(S, const Accessor& a)
+	{
+		return a;
+	}
+
+	template<typename T, typename U>
+	LMAT_ENSURE_INLINE
+	inline contvec_writer<T, U> apply_store_hint(stream_store_, const contvec_writer<T, U>& a)
+	{
+		return a.with_stream(true);
+	}
+
+	template<typename T, typename U>
+	LMAT_ENSURE_INLINE
+	inline contvec_writer<T, U> apply_store_hint(cache_store_, const contvec_writer<T, U>& a)
+	{
+		return a.with_stream(false);
+	}
+
+	template<typename T, typename U>
+	LMAT_ENSURE_INLINE
+	inline multi_contcol_writer<T, U> apply_store_hint(stream_store_, const multi_contcol_writer<T, U>& a)
+	{
+		return a.with_stream(true);
+	}
+
+	template<typename T, typename U>
+	LMAT_ENSURE_INLINE
+	inline multi_contcol_writer<T, U> apply_store_hint(cache_store_, const multi_contcol_writer<T, U>& a)
+	{
+		return a.with_stream(false);
+	}
+
+
 	/********************************************
 	 *
 	 *  linear element-wise evaluation
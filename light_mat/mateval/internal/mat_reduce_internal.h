@@ -17,6 +17,7 @@
 #include <light_mat/mateval/common_kernels.h>
 #include <light_mat/math/math_functors.h>
 #include <light_mat/matexpr/mat_arith.h>
+#include <light_mat/matrix/ref_matrix_rm.h>
 
 namespace lmat { namespace internal {
 
@@ -213,8 +214,9 @@ namespace lmat { namespace internal {
 
 
 	template<index_t CM, index_t CN, class FoldKernel, typename T, class DMat, class TExpr>
-	inline void colwise_fold_impl(const matrix_shape<CM, CN>& shape,
-			const FoldKernel& kernel, IRegularMatrix<DMat, T>& dmat, const IEWiseMatrix<TExpr, T>& texpr)
+	inline void _colwise_fold_impl(const matrix_shape<CM, CN>& shape,
+			const FoldKernel& kernel, IRegularMatrix<DMat, T>& dmat, const IEWiseMatrix<TExpr, T>& texpr,
+			meta::false_)
 	{
 		const index_t n = shape.ncolumns();
 		LMAT_CHECK_DIMS( n == dmat.nelems() )
@@ -231,15 +233,16 @@ namespace lmat { namespace internal {
 	// row wise reduction
 
 	template<index_t CM, index_t CN, class FoldKernel, typename T, class DMat, class TExpr>
-	inline void rowwise_fold_impl(const matrix_shape<CM, CN>& shape,
-			const FoldKernel& kernel, IRegularMatrix<DMat, T>& dmat, const IEWiseMatrix<TExpr, T>& texpr)
+	inline void _rowwise_fold_impl(const matrix_shape<CM, CN>& shape,
+			const FoldKernel& kernel, IRegularMatrix<DMat, T>& dmat, const IEWiseMatrix<TExpr, T>& texpr,
+			meta::false_)
 	{
 		dimension<CM> col_dim(shape.nrows());
 		const index_t n = shape.ncolumns();
 
 		LMAT_CHECK_DIMS( col_dim.value() == dmat.nelems() )
 
-		typedef preferred_macc_policy<matrix_shape<CM, 1>, FoldKernel, DMat, TExpr> pmap;
+		typedef preferred_macc_policy<matrix_shape<CM, 1>, FoldKernel, DMat, arg_wrap<TExpr, atags::in> > pmap;
 		// static_assert(pmap::use_simd, "should use SIMD here");
 
 		typedef typename pmap::unit U;
@@ -256,6 +259,49 @@ namespace lmat { namespace internal {
 	}
 
 
+	// row-major inputs: the rows of a are the (contiguous) columns of its
+	// transposed view, hence colwise and rowwise reductions swap roles
+
+	template<index_t CM, index_t CN, class FoldKernel, typename T, class DMat, class TExpr>
+	LMAT_ENSURE_INLINE
+	inline void _colwise_fold_impl(const matrix_shape<CM, CN>& shape,
+			const FoldKernel& kernel, IRegularMatrix<DMat, T>& dmat, const IEWiseMatrix<TExpr, T>& texpr,
+			meta::true_)
+	{
+		auto tv = trans_view(texpr.derived());
+		_rowwise_fold_impl(tv.shape(), kernel, dmat, tv, meta::false_());
+	}
+
+	template<index_t CM, index_t CN, class FoldKernel, typename T, class DMat, class TExpr>
+	LMAT_ENSURE_INLINE
+	inline void _rowwise_fold_impl(const matrix_shape<CM, CN>& shape,
+			const FoldKernel& kernel, IRegularMatrix<DMat, T>& dmat, const IEWiseMatrix<TExpr, T>& texpr,
+			meta::true_)
+	{
+		auto tv = trans_view(texpr.derived());
+		_colwise_fold_impl(tv.shape(), kernel, dmat, tv, meta::false_());
+	}
+
+
+	template<index_t CM, index_t CN, class FoldKernel, typename T, class DMat, class TExpr>
+	LMAT_ENSURE_INLINE
+	inline void colwise_fold_impl(const matrix_shape<CM, CN>& shape,
+			const FoldKernel& kernel, IRegularMatrix<DMat, T>& dmat, const IEWiseMatrix<TExpr, T>& texpr)
+	{
+		typedef meta::bool_<prefers_rowmajor_access<TExpr>::value> is_rm;
+		_colwise_fold_impl(shape, kernel, dmat, texpr, is_rm());
+	}
+
+	template<index_t CM, index_t CN, class FoldKernel, typename T, class DMat, class TExpr>
+	LMAT_ENSURE_INLINE
+	inline void rowwise_fold_impl(const matrix_shape<CM, CN>& shape,
+			const FoldKernel& kernel, IRegularMatrix<DMat, T>& dmat, const IEWiseMatrix<TExpr, T>& texpr)
+	{
+		typedef meta::bool_<prefers_rowmajor_access<TExpr>::value> is_rm;
+		_rowwise_fold_impl(shape, kernel, dmat, texpr, is_rm());
+	}
+
+
 } }
 
 #endif 
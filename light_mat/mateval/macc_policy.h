@@ -15,6 +15,8 @@
 
 #include <light_mat/mateval/mateval_fwd.h>
 #include <light_mat/matrix/matrix_concepts.h>
+#include <light_mat/common/memory_stream.h>
+#include <utility>
 
 namespace lmat
 {
@@ -23,32 +25,35 @@ namespace lmat
 	struct linear_ { };
 	struct percol_ { };
 
-	template<typename Acc, typename U> struct macc_ { };
+	// S: the store hint for contiguous destinations
+	//    (auto_store_, stream_store_, or cache_store_)
 
-	template<typename U>
+	template<typename Acc, typename U, typename S=auto_store_> struct macc_ { };
+
+	template<typename U, typename S>
 	LMAT_ENSURE_INLINE
-	inline bool use_linear_acc(macc_<linear_, U>)
+	inline bool use_linear_acc(macc_<linear_, U, S>)
 	{
 		return true;
 	}
 
-	template<typename U>
+	template<typename U, typename S>
 	LMAT_ENSURE_INLINE
-	inline bool use_linear_acc(macc_<percol_, U>)
+	inline bool use_linear_acc(macc_<percol_, U, S>)
 	{
 		return false;
 	}
 
-	template<typename Acc, typename U>
+	template<typename Acc, typename U, typename S>
 	LMAT_ENSURE_INLINE
-	inline bool use_simd(macc_<Acc, U>)
+	inline bool use_simd(macc_<Acc, U, S>)
 	{
 		return false;
 	}
 
-	template<typename Acc, typename Kind>
+	template<typename Acc, typename Kind, typename S>
 	LMAT_ENSURE_INLINE
-	inline bool use_simd(macc_<Acc, simd_<Kind> >)
+	inline bool use_simd(macc_<Acc, simd_<Kind>, S>)
 	{
 		return true;
 	}
@@ -106,6 +111,82 @@ namespace lmat
 	: public meta::true_ { };
 
 
+	/********************************************
+	 *
+	 *  Row-major access
+	 *
+	 *  A row-major (per-row contiguous but not
+	 *  per-column contiguous) matrix can only be
+	 *  accessed with scalar strides through the
+	 *  per-column policies. Vector-wise routines
+	 *  should instead work on its transposed
+	 *  (column-major) view, where the rows
+	 *  become contiguous columns.
+	 *
+	 *  Likewise, when the destination and every
+	 *  matrix operand of an element-wise
+	 *  expression are row-major, the expression
+	 *  is evaluated on its transpose, i.e. the
+	 *  same expression over the trans_views of
+	 *  the operands, written to the trans_view
+	 *  of the destination. There, the per-column
+	 *  (or linear) SIMD policies apply.
+	 *
+	 *  rowmajor_transposable<Expr> tells whether
+	 *  an expression can be transposed, and
+	 *  rowmajor_transpose<Expr> holds its
+	 *  transpose (type, get()). The transposes
+	 *  of the leaves (scalars and row-major
+	 *  matrices) are defined with the row-major
+	 *  views (ref_matrix_rm.h), and expressions
+	 *  specialize both (see map_expr.h). Other
+	 *  expressions (e.g. repeated vectors) go
+	 *  through the strided path.
+	 *
+	 ********************************************/
+
+	template<typename A>
+	struct prefers_rowmajor_access
+	: public meta::and_<
+	  	  meta::is_regular_mat<A>,
+	  	  meta::and_<
+	  	  	  meta::is_perrow_contiguous<A>,
+	  	  	  meta::not_<meta::is_percol_contiguous<A> > >
+	> { };
+
+	namespace internal
+	{
+		// 0: a scalar, 1: a row-major matrix, 2: other
+		template<class A>
+		struct _rm_leaf_kind
+		{
+			static const int value = !meta::is_mat_xpr<A>::value ? 0 :
+					(prefers_rowmajor_access<A>::value ? 1 : 2);
+		};
+	}
+
+	template<class Expr>
+	struct rowmajor_transposable
+	: public meta::bool_<(internal::_rm_leaf_kind<Expr>::value < 2)> { };
+
+	// (defined in ref_matrix_rm.h)
+
+	template<class Expr> class rowmajor_transpose;
+	template<class Dst> struct rowmajor_dest_transpose;
+
+	// (a vector, e.g. a column with row steps,
+	// is left as it is)
+
+	template<class Expr, class Dst>
+	struct rowmajor_evaluable
+	: public meta::all_<
+	  	  prefers_rowmajor_access<Dst>,
+	  	  meta::not_<meta::is_vector<Dst> >,
+	  	  meta::is_mat_xpr<Expr>,
+	  	  rowmajor_transposable<Expr>
+	> { };
+
+
 	/********************************************
 	 *
 	 *  SIMD support
@@ -148,11 +229,45 @@ namespace lmat
 	template<>
 	struct supports_simd<double, avx_t> : public meta::true_ { };
 
+	template<>
+	struct supports_simd<std::complex<float>, sse_t> : public meta::true_ { };
+
+	template<>
+	struct supports_simd<std::complex<float>, avx_t> : public meta::true_ { };
+
+	template<>
+	struct supports_simd<std::complex<double>, sse_t> : public meta::true_ { };
+
+	template<>
+	struct supports_simd<std::complex<double>, avx_t> : public meta::true_ { };
+
 	template<typename A, typename ATag, typename Kind>
 	struct supports_simd<arg_wrap<A, ATag>, Kind>
 	: public supports_simd<A, Kind> { };
 
 
+	/********************************************
+	 *
+	 *  SIMD support for reading
+	 *
+	 *  A regular matrix with any strides can be
+	 *  read in packs (through strided loads),
+	 *  while writing packs still requires the
+	 *  contiguity checked by supports_simd.
+	 *
+	 ********************************************/
+
+	template<typename A, typename Kind>
+	struct supports_simd_read
+	: public std::conditional<meta::is_regular_mat<A>::value,
+	  	  supports_simd<typename meta::value_type_of<A>::type, Kind>,
+	  	  supports_simd<A, Kind> >::type { };
+
+	template<typename A, typename Kind>
+	struct supports_simd<arg_wrap<A, atags::in>, Kind>
+	: public supports_simd_read<A, Kind> { };
+
+
 	/********************************************
 	 *
 	 *  preferred policy
@@ -241,15 +356,38 @@ namespace lmat
 	}
 
 
+	// the policy expr is evaluated into dst with
+	// (on the transposes if rowmajor_evaluable)
+
+	namespace internal
+	{
+		template<class Expr, class Dst, bool Trans>
+		struct _expr_macc_policy
+		{
+			typedef typename meta::value_type_of<Expr>::type T;
+
+			typedef typename preferred_macc_policy<
+				typename meta::common_shape<Expr, Dst>::type, copy_kernel<T>,
+				arg_wrap<Expr, atags::in>, Dst>::type type;
+		};
+
+		template<class Expr, class Dst>
+		struct _expr_macc_policy<Expr, Dst, true>
+		: public _expr_macc_policy<
+		  	  typename rowmajor_transpose<Expr>::type,
+		  	  typename rowmajor_dest_transpose<Dst>::type, false> { };
+	}
+
+	template<class Expr, class Dst>
+	struct preferred_expr_macc_policy
+	: public internal::_expr_macc_policy<Expr, Dst, rowmajor_evaluable<Expr, Dst>::value> { };
+
 	template<typename T, class Expr, typename Dst>
-	typename preferred_macc_policy<
-		typename meta::common_shape<Expr, Dst>::type, copy_kernel<T>, Expr, Dst>::type
+	typename preferred_expr_macc_policy<Expr, Dst>::type
 	get_preferred_expr_macc_policy(const IMatrixXpr<Expr, T>& expr, const IRegularMatrix<Dst, T>& dst)
 	{
-		const Expr& s = expr.derived();
-		const Dst& d = dst.derived();
-
-		return get_preferred_macc_policy(common_shape(s, d), copy_kernel<T>(), s, d);
+		typedef typename preferred_expr_macc_policy<Expr, Dst>::type policy_t;
+		return policy_t();
 	}
 
 
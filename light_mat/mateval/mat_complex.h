@@ -0,0 +1,237 @@
+/**
+ * @file mat_complex.h
+ *
+ * Real-valued parts of complex matrices
+ *
+ * real(a, r), imag(a, r), abs(a, r), norm(a, r) and arg(a, r) write to
+ * a real matrix r of the same shape as the complex matrix a. They are
+ * routines rather than expressions, since one pack of results takes two
+ * complex packs, which the element-wise evaluation (with one pack width
+ * per expression) does not express.
+ *
+ * Vectors with unit stride are processed with SIMD packs, others (and
+ * the tails) element by element. abs scales by the larger part on packs,
+ * so, like std::abs on scalars, it does not overflow or underflow where
+ * the squared modulus would. arg always uses std::arg.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_MAT_COMPLEX_H_
+#define LIGHTMAT_MAT_COMPLEX_H_
+
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/simd/simd.h>
+
+#include <complex>
+
+namespace lmat
+{
+	namespace internal
+	{
+		/********************************************
+		 *
+		 *  part extractors
+		 *
+		 ********************************************/
+
+		struct cpart_real_
+		{
+			typedef meta::true_ use_simd;
+
+			template<typename T>
+			LMAT_ENSURE_INLINE
+			static T get(const std::complex<T>& z) { return z.real(); }
+
+			template<typename T, typename Kind>
+			LMAT_ENSURE_INLINE
+			static simd_pack<T, Kind> get(const simd_pack<std::complex<T>, Kind>& a0, const simd_pack<std::complex<T>, Kind>& a1)
+			{
+				return real(a0, a1);
+			}
+		};
+
+		struct cpart_imag_
+		{
+			typedef meta::true_ use_simd;
+
+			template<typename T>
+			LMAT_ENSURE_INLINE
+			static T get(const std::complex<T>& z) { return z.imag(); }
+
+			template<typename T, typename Kind>
+			LMAT_ENSURE_INLINE
+			static simd_pack<T, Kind> get(const simd_pack<std::complex<T>, Kind>& a0, const simd_pack<std::complex<T>, Kind>& a1)
+			{
+				return imag(a0, a1);
+			}
+		};
+
+		struct cpart_abs_
+		{
+			typedef meta::true_ use_simd;
+
+			template<typename T>
+			LMAT_ENSURE_INLINE
+			static T get(const std::complex<T>& z) { return std::abs(z); }
+
+			template<typename T, typename Kind>
+			LMAT_ENSURE_INLINE
+			static simd_pack<T, Kind> get(const simd_pack<std::complex<T>, Kind>& a0, const simd_pack<std::complex<T>, Kind>& a1)
+			{
+				return abs(a0, a1);
+			}
+		};
+
+		struct cpart_norm_
+		{
+			typedef meta::true_ use_simd;
+
+			template<typename T>
+			LMAT_ENSURE_INLINE
+			static T get(const std::complex<T>& z) { return std::norm(z); }
+
+			template<typename T, typename Kind>
+			LMAT_ENSURE_INLINE
+			static simd_pack<T, Kind> get(const simd_pack<std::complex<T>, Kind>& a0, const simd_pack<std::complex<T>, Kind>& a1)
+			{
+				return norm(a0, a1);
+			}
+		};
+
+		struct cpart_arg_
+		{
+			typedef meta::false_ use_simd;
+
+			template<typename T>
+			LMAT_ENSURE_INLINE
+			static T get(const std::complex<T>& z) { return std::arg(z); }
+		};
+
+
+		/********************************************
+		 *
+		 *  vector kernels
+		 *
+		 ********************************************/
+
+		// processes the leading elements of contiguous vectors with packs,
+		// and returns the number of elements done
+
+		template<class Op, typename T>
+		LMAT_ENSURE_INLINE
+		inline index_t cpart_packs(Op, meta::false_, const std::complex<T> *, T *, index_t)
+		{
+			return 0;
+		}
+
+		template<class Op, typename T>
+		inline index_t cpart_packs(Op, meta::true_, const std::complex<T> *a, T *r, index_t len)
+		{
+			typedef simd_pack<std::complex<T>, default_simd_kind> cpack_t;
+			typedef simd_pack<T, default_simd_kind> rpack_t;
+
+			const index_t w = (index_t)rpack_t::pack_width;
+			const index_t cw = (index_t)cpack_t::pack_width;
+			const index_t lp = len - len % w;
+
+			for (index_t i = 0; i < lp; i += w)
+				Op::get(cpack_t(a + i), cpack_t(a + i + cw)).store_u(r + i);
+
+			return lp;
+		}
+
+		template<class Op, typename T>
+		inline void cpart_vec(Op op, const std::complex<T> *a, index_t sa, T *r, index_t sr, index_t len)
+		{
+			index_t i = 0;
+			if (sa == 1 && sr == 1)
+			{
+				i = cpart_packs(op, typename Op::use_simd(), a, r, len);
+			}
+
+			for (; i < len; ++i) r[i * sr] = Op::get(a[i * sa]);
+		}
+
+		template<class Op, typename T, class A, class R>
+		inline void cpart_mat(Op op, const IRegularMatrix<A, std::complex<T> >& a, IRegularMatrix<R, T>& r)
+		{
+			LMAT_CHECK_DIMS( have_same_shape(a, r) )
+
+			const A& a_ = a.derived();
+			R& r_ = r.derived();
+
+			const index_t m = a_.nrows();
+			const index_t n = a_.ncolumns();
+			if (m == 0 || n == 0) return;
+
+			const std::complex<T> *pa = a_.ptr_data();
+			T *pr = r_.ptr_data();
+
+			const index_t ars = a_.row_stride();
+			const index_t acs = a_.col_stride();
+			const index_t rrs = r_.row_stride();
+			const index_t rcs = r_.col_stride();
+
+			if (ars == 1 && rrs == 1 && (n == 1 || (acs == m && rcs == m)))
+			{
+				cpart_vec(op, pa, 1, pr, 1, m * n);
+			}
+			else if (acs == 1 && rcs == 1 && m > 1)
+			{
+				// row-major views: rows are contiguous
+				for (index_t i = 0; i < m; ++i)
+					cpart_vec(op, pa + i * ars, 1, pr + i * rrs, 1, n);
+			}
+			else
+			{
+				for (index_t j = 0; j < n; ++j)
+					cpart_vec(op, pa + j * acs, ars, pr + j * rcs, rrs, m);
+			}
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  public routines
+	 *
+	 ********************************************/
+
+	template<typename T, class A, class R>
+	inline void real(const IRegularMatrix<A, std::complex<T> >& a, IRegularMatrix<R, T>& r)
+	{
+		internal::cpart_mat(internal::cpart_real_(), a, r);
+	}
+
+	template<typename T, class A, class R>
+	inline void imag(const IRegularMatrix<A, std::complex<T> >& a, IRegularMatrix<R, T>& r)
+	{
+		internal::cpart_mat(internal::cpart_imag_(), a, r);
+	}
+
+	template<typename T, class A, class R>
+	inline void abs(const IRegularMatrix<A, std::complex<T> >& a, IRegularMatrix<R, T>& r)
+	{
+		internal::cpart_mat(internal::cpart_abs_(), a, r);
+	}
+
+	template<typename T, class A, class R>
+	inline void norm(const IRegularMatrix<A, std::complex<T> >& a, IRegularMatrix<R, T>& r)
+	{
+		internal::cpart_mat(internal::cpart_norm_(), a, r);
+	}
+
+	template<typename T, class A, class R>
+	inline void arg(const IRegularMatrix<A, std::complex<T> >& a, IRegularMatrix<R, T>& r)
+	{
+		internal::cpart_mat(internal::cpart_arg_(), a, r);
+	}
+
+}
+
+#endif /* MAT_COMPLEX_H_ */
@@ -117,11 +117,53 @@ namespace lmat
 	 ********************************************/
 
 	LMAT_DEFINE_SIMPLE_FOLD_KERNEL( sum, x, a += x, sum(a) )
+	LMAT_DEF_COMPLEX_SIMD_SUPPORT( sum_kernel )
 
 	LMAT_DEFINE_SIMPLE_FOLD_KERNEL( maximum, x, a = math::max(a, x), maximum(a) )
 
 	LMAT_DEFINE_SIMPLE_FOLD_KERNEL( minimum, x, a = math::min(a, x), minimum(a) )
 
+	// inner product (the packed version uses fused multiply-add when available)
+
+	template<typename T>
+	struct dot_kernel
+	{
+		typedef T value_type;
+		typedef T accumulated_type;
+
+		LMAT_ENSURE_INLINE
+		T init(const T& x, const T& y) const { return x * y; }
+
+		LMAT_ENSURE_INLINE
+		void operator()(T& a, const T& x, const T& y) const { a += x * y; }
+
+		LMAT_ENSURE_INLINE
+		void operator()(T& a, const T& b) const { a += b; }
+	};
+
+	template<typename T, typename Kind>
+	struct dot_kernel<simd_pack<T, Kind> >
+	{
+		typedef simd_pack<T, Kind> value_type;
+		typedef simd_pack<T, Kind> accumulated_type;
+
+		LMAT_ENSURE_INLINE
+		accumulated_type init(const value_type& x, const value_type& y) const { return x * y; }
+
+		LMAT_ENSURE_INLINE
+		void operator()(accumulated_type& a, const value_type& x, const value_type& y) const { a = math::fma(x, y, a); }
+
+		LMAT_ENSURE_INLINE
+		void operator()(accumulated_type& a, const accumulated_type& b) const { a += b; }
+
+		LMAT_ENSURE_INLINE
+		T reduce(const accumulated_type& a) const { return sum(a); }
+	};
+
+	LMAT_DECL_SIMDIZABLE_ON_REAL( dot_kernel )
+	LMAT_DEF_TRIVIAL_SIMDIZE_MAP( dot_kernel )
+	LMAT_DEF_COMPLEX_SIMD_SUPPORT( dot_kernel )
+
 
 
 	/********************************************
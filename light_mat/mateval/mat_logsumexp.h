@@ -0,0 +1,615 @@
+/**
+ * @file mat_logsumexp.h
+ *
+ * Numerically stable log-sum-exp reduction and softmax
+ *
+ * logsumexp(a) = m + log(sum(exp(a - m))) with m = max(a), computed
+ * in a single pass: a running maximum and a sum relative to it are
+ * kept, and the sum is rescaled whenever the maximum grows. With SIMD,
+ * each lane keeps its own maximum and sum; the maximum of a block of
+ * packs is taken first, so that the sum is rescaled once per block
+ * and each element needs only one exp.
+ *
+ * The exp on packs is computed in-place (range reduction by ln(2) and
+ * a polynomial), and does not depend on an external vector math
+ * library. Arguments below the normal range give zero, and NaN gives
+ * NaN. A NaN element makes the log-sum-exp NaN, in the SIMD and the
+ * scalar paths alike (it is carried by the running maximum).
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_MAT_LOGSUMEXP_H_
+#define LIGHTMAT_MAT_LOGSUMEXP_H_
+
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/mateval/common_kernels.h>
+#include <light_mat/mateval/macc_policy.h>
+#include <light_mat/simd/simd.h>
+#include <light_mat/common/parallel.h>
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace lmat
+{
+	namespace internal
+	{
+		const index_t lse_omp_threshold = 32768;
+		const index_t lse_block_packs = 16;  // packs per rescaling (along a vector)
+		const index_t lse_col_group = 8;     // vectors per rescaling (across vectors)
+
+
+		/********************************************
+		 *
+		 *  exp on packs
+		 *
+		 *  exp(x) = 2^n * exp(r), with n = round(x / ln2),
+		 *  and exp(r) on |r| <= ln2/2 by a polynomial
+		 *
+		 ********************************************/
+
+		// 2^n for integral n in the normal range
+
+		LMAT_ENSURE_INLINE
+		inline sse_f32pk lse_pow2n(const sse_f32pk& n)
+		{
+			__m128i k = _mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127));
+			return _mm_castsi128_ps(_mm_slli_epi32(k, 23));
+		}
+
+		LMAT_ENSURE_INLINE
+		inline sse_f64pk lse_pow2n(const sse_f64pk& n)
+		{
+			// the low bits of 1.5 * 2^52 + (n + 1023) hold n + 1023
+			__m128d t = _mm_add_pd(n, _mm_set1_pd(6755399441055744.0 + 1023.0));
+			return _mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(t), 52));
+		}
+
+#ifdef LMAT_HAS_AVX
+
+		LMAT_ENSURE_INLINE
+		inline avx_f32pk lse_pow2n(const avx_f32pk& n)
+		{
+			__m256i k = _mm256_cvttps_epi32(n);
+#ifdef LMAT_HAS_AVX2
+			k = _mm256_slli_epi32(_mm256_add_epi32(k, _mm256_set1_epi32(127)), 23);
+			return _mm256_castsi256_ps(k);
+#else
+			const __m128i b = _mm_set1_epi32(127);
+			__m128i lo = _mm_slli_epi32(_mm_add_epi32(_mm256_castsi256_si128(k), b), 23);
+			__m128i hi = _mm_slli_epi32(_mm_add_epi32(_mm256_extractf128_si256(k, 1), b), 23);
+			return _mm256_castsi256_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1));
+#endif
+		}
+
+		LMAT_ENSURE_INLINE
+		inline avx_f64pk lse_pow2n(const avx_f64pk& n)
+		{
+			__m256i t = _mm256_castpd_si256(_mm256_add_pd(n, _mm256_set1_pd(6755399441055744.0 + 1023.0)));
+#ifdef LMAT_HAS_AVX2
+			return _mm256_castsi256_pd(_mm256_slli_epi64(t, 52));
+#else
+			__m128i lo = _mm_slli_epi64(_mm256_castsi256_si128(t), 52);
+			__m128i hi = _mm_slli_epi64(_mm256_extractf128_si256(t, 1), 52);
+			return _mm256_castsi256_pd(_mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1));
+#endif
+		}
+
+#endif
+
+		template<typename Kind>
+		inline simd_pack<float, Kind> lse_exp(const simd_pack<float, Kind>& x)
+		{
+			typedef simd_pack<float, Kind> pack_t;
+
+			const pack_t lo(-87.0f);
+			const pack_t xc = (math::min)((math::max)(x, lo), pack_t(88.0f));
+
+			const pack_t n = math::floor(xc * pack_t(1.44269504088896341f) + pack_t(0.5f));
+			const pack_t r = xc - n * pack_t(0.693359375f) + n * pack_t(2.12194440e-4f);
+
+			pack_t y(1.9875691500e-4f);
+			y = y * r + pack_t(1.3981999507e-3f);
+			y = y * r + pack_t(8.3334519073e-3f);
+			y = y * r + pack_t(4.1665795894e-2f);
+			y = y * r + pack_t(1.6666665459e-1f);
+			y = y * r + pack_t(5.0000001201e-1f);
+			y = y * (r * r) + r + pack_t(1.0f);
+
+			// below the range: zero, NaN (unordered): NaN
+			return math::cond(x >= lo, y * lse_pow2n(n), math::cond(x < lo, pack_t::zeros(), x));
+		}
+
+		template<typename Kind>
+		inline simd_pack<double, Kind> lse_exp(const simd_pack<double, Kind>& x)
+		{
+			typedef simd_pack<double, Kind> pack_t;
+
+			const pack_t lo(-708.0);
+			const pack_t xc = (math::min)((math::max)(x, lo), pack_t(709.0));
+
+			const pack_t n = math::floor(xc * pack_t(1.4426950408889634074) + pack_t(0.5));
+			const pack_t r = xc - n * pack_t(6.93145751953125e-1) - n * pack_t(1.42860682030941723212e-6);
+
+			// Taylor series to degree 12, relative error below 2e-16
+
+			pack_t y(1.0 / 479001600.0);
+			y = y * r + pack_t(1.0 / 39916800.0);
+			y = y * r + pack_t(1.0 / 3628800.0);
+			y = y * r + pack_t(1.0 / 362880.0);
+			y = y * r + pack_t(1.0 / 40320.0);
+			y = y * r + pack_t(1.0 / 5040.0);
+			y = y * r + pack_t(1.0 / 720.0);
+			y = y * r + pack_t(1.0 / 120.0);
+			y = y * r + pack_t(1.0 / 24.0);
+			y = y * r + pack_t(1.0 / 6.0);
+			y = y * r + pack_t(0.5);
+			y = y * (r * r) + r + pack_t(1.0);
+
+			// below the range: zero, NaN (unordered): NaN
+			return math::cond(x >= lo, y * lse_pow2n(n), math::cond(x < lo, pack_t::zeros(), x));
+		}
+
+		// exp(m0 - m1) with m0 <= m1, and 1 where they are equal
+		// (in particular where both are -inf)
+
+		template<typename T, typename Kind>
+		LMAT_ENSURE_INLINE
+		inline simd_pack<T, Kind> lse_rescale(const simd_pack<T, Kind>& m0, const simd_pack<T, Kind>& m1)
+		{
+			typedef simd_pack<T, Kind> pack_t;
+			return math::cond(m0 == m1, pack_t(T(1)), lse_exp(m0 - m1));
+		}
+
+
+		/********************************************
+		 *
+		 *  running state
+		 *
+		 *  s = sum(exp(x - m)) over the elements
+		 *  seen so far, with m their maximum
+		 *
+		 ********************************************/
+
+		template<typename T>
+		struct lse_state
+		{
+			T m;
+			T s;
+
+			lse_state()
+			: m(-std::numeric_limits<T>::infinity()), s(T(0)) { }
+
+			lse_state(const T& m_, const T& s_)
+			: m(m_), s(s_) { }
+
+			LMAT_ENSURE_INLINE
+			void add(const T& x)
+			{
+				if (x > m)
+				{
+					s = s * std::exp(m - x) + T(1);
+					m = x;
+				}
+				else if (x != x)  // NaN, carried by the maximum
+				{
+					m = x;
+				}
+				else if (x != -std::numeric_limits<T>::infinity())
+				{
+					s += std::exp(x - m);
+				}
+			}
+
+			void merge(const lse_state& o)
+			{
+				if (o.m > m)
+				{
+					s = s * std::exp(m - o.m) + o.s;
+					m = o.m;
+				}
+				else if (o.m != o.m)
+				{
+					m = o.m;
+				}
+				else if (o.m != -std::numeric_limits<T>::infinity())
+				{
+					s += o.s * std::exp(o.m - m);
+				}
+			}
+
+			T value() const
+			{
+				return (m == std::numeric_limits<T>::infinity() ||
+						m == -std::numeric_limits<T>::infinity()) ? m : m + std::log(s);
+			}
+		};
+
+		template<typename T>
+		struct lse_use_simd
+		{
+			static const bool value = supports_simd<T, default_simd_kind>::value;
+		};
+
+		// the lanes that have seen a NaN take it as their maximum
+
+		template<typename T, typename Kind>
+		LMAT_ENSURE_INLINE
+		inline simd_pack<T, Kind> lse_mark_nan(const simd_pack<T, Kind>& M, const simd_bpack<T, Kind>& U)
+		{
+			return math::cond(U, simd_pack<T, Kind>(std::numeric_limits<T>::quiet_NaN()), M);
+		}
+
+		template<typename T, typename Kind>
+		inline void lse_merge_lanes(lse_state<T>& st, const simd_pack<T, Kind>& M, const simd_pack<T, Kind>& S)
+		{
+			const unsigned int W = simd_traits<T, Kind>::pack_width;
+			T mv[W];
+			T sv[W];
+			M.store_u(mv);
+			S.store_u(sv);
+
+			for (unsigned int k = 0; k < W; ++k) st.merge(lse_state<T>(mv[k], sv[k]));
+		}
+
+
+		/********************************************
+		 *
+		 *  vector kernels
+		 *
+		 ********************************************/
+
+		template<typename T>
+		inline void lse_vec(lse_state<T>& st, const T *a, index_t step, index_t len)
+		{
+			for (index_t i = 0; i < len; ++i) st.add(a[i * step]);
+		}
+
+		template<typename T>
+		inline void lse_vec_cont(lse_state<T>& st, const T *a, index_t len, meta::bool_<false>)
+		{
+			lse_vec(st, a, 1, len);
+		}
+
+		template<typename T>
+		inline void lse_vec_cont(lse_state<T>& st, const T *a, index_t len, meta::bool_<true>)
+		{
+			typedef simd_pack<T, default_simd_kind> pack_t;
+			typedef simd_bpack<T, default_simd_kind> bpack_t;
+			const index_t w = (index_t)simd_traits<T, default_simd_kind>::pack_width;
+
+			index_t i = 0;
+			if (len >= w)
+			{
+				pack_t M = pack_t::neg_inf();
+				pack_t S = pack_t::zeros();
+				bpack_t U = bpack_t::all_false();  // lanes with NaN
+
+				while (i + w <= len)
+				{
+					const index_t nb = std::min(lse_block_packs, (len - i) / w);
+					const T *p = a + i;
+
+					pack_t cm(p);
+					U |= math::isnan(cm);
+					for (index_t k = 1; k < nb; ++k)
+					{
+						const pack_t x(p + k * w);
+						U |= math::isnan(x);
+						cm = (math::max)(cm, x);
+					}
+
+					const pack_t nm = (math::max)(M, cm);
+					S = S * lse_rescale(M, nm);
+					for (index_t k = 0; k < nb; ++k) S += lse_exp(pack_t(p + k * w) - nm);
+					M = nm;
+
+					i += nb * w;
+				}
+
+				lse_merge_lanes(st, lse_mark_nan(M, U), S);
+			}
+
+			for (; i < len; ++i) st.add(a[i]);
+		}
+
+		// cnt vectors adjacent in memory (the e-th element of the s-th
+		// vector at a[e * es + s]), one pack of vectors at a time
+
+		template<typename T>
+		inline void lse_across(lse_state<T> *sts, const T *a, index_t es, index_t len, index_t cnt, meta::bool_<false>)
+		{
+			for (index_t s = 0; s < cnt; ++s) lse_vec(sts[s], a + s, es, len);
+		}
+
+		template<typename T>
+		inline void lse_across(lse_state<T> *sts, const T *a, index_t es, index_t len, index_t cnt, meta::bool_<true>)
+		{
+			typedef simd_pack<T, default_simd_kind> pack_t;
+			typedef simd_bpack<T, default_simd_kind> bpack_t;
+			const index_t w = (index_t)simd_traits<T, default_simd_kind>::pack_width;
+			const index_t np = cnt / w;
+
+#ifdef _OPENMP
+#pragma omp parallel for if (len * cnt >= lse_omp_threshold && np > 1)
+#endif
+			for (index_t q = 0; q < np; ++q)
+			{
+				const T *aq = a + q * w;
+				pack_t M = pack_t::neg_inf();
+				pack_t S = pack_t::zeros();
+				bpack_t U = bpack_t::all_false();  // lanes with NaN
+
+				for (index_t e0 = 0; e0 < len; e0 += lse_col_group)
+				{
+					const index_t ne = std::min(lse_col_group, len - e0);
+					const T *p = aq + e0 * es;
+
+					pack_t cm(p);
+					U |= math::isnan(cm);
+					for (index_t k = 1; k < ne; ++k)
+					{
+						const pack_t x(p + k * es);
+						U |= math::isnan(x);
+						cm = (math::max)(cm, x);
+					}
+
+					const pack_t nm = (math::max)(M, cm);
+					S = S * lse_rescale(M, nm);
+					for (index_t k = 0; k < ne; ++k) S += lse_exp(pack_t(p + k * es) - nm);
+					M = nm;
+				}
+
+				T mv[simd_traits<T, default_simd_kind>::pack_width];
+				T sv[simd_traits<T, default_simd_kind>::pack_width];
+				lse_mark_nan(M, U).store_u(mv);
+				S.store_u(sv);
+				for (index_t k = 0; k < w; ++k) sts[q * w + k] = lse_state<T>(mv[k], sv[k]);
+			}
+
+			for (index_t s = np * w; s < cnt; ++s) lse_vec(sts[s], a + s, es, len);
+		}
+
+		// cnt vectors of length len: the e-th element of the s-th
+		// vector at a[e * es + s * ss]
+
+		template<typename T>
+		inline void lse_multi(lse_state<T> *sts, const T *a, index_t es, index_t ss, index_t len, index_t cnt)
+		{
+			typedef meta::bool_<lse_use_simd<T>::value> use_simd;
+
+			if (cnt > 1 && ss == 1 && es != 1)
+			{
+				lse_across(sts, a, es, len, cnt, use_simd());
+				return;
+			}
+
+#ifdef _OPENMP
+#pragma omp parallel for if (len * cnt >= lse_omp_threshold && cnt > 1)
+#endif
+			for (index_t s = 0; s < cnt; ++s)
+			{
+				if (es == 1)
+					lse_vec_cont(sts[s], a + s * ss, len, use_simd());
+				else
+					lse_vec(sts[s], a + s * ss, es, len);
+			}
+		}
+
+		// a long contiguous vector, split over the threads and
+		// merged in a fixed order
+
+		template<typename T>
+		inline lse_state<T> lse_long(const T *a, index_t len)
+		{
+			typedef meta::bool_<lse_use_simd<T>::value> use_simd;
+			lse_state<T> st;
+
+#ifdef _OPENMP
+			if (len >= lse_omp_threshold && omp_get_max_threads() > 1)
+			{
+				std::vector<lse_state<T> > parts((size_t)omp_get_max_threads());
+				index_t np = 0;
+
+#pragma omp parallel
+				{
+					const index_t nt = (index_t)omp_get_num_threads();
+					const index_t t = (index_t)omp_get_thread_num();
+
+					index_t i0, ni;
+					static_column_slab(len, nt, t, i0, ni);
+					lse_vec_cont(parts[t], a + i0, ni, use_simd());
+
+#pragma omp single
+					np = nt;
+				}
+
+				for (index_t t = 0; t < np; ++t) st.merge(parts[t]);
+				return st;
+			}
+#endif
+			lse_vec_cont(st, a, len, use_simd());
+			return st;
+		}
+
+
+		/********************************************
+		 *
+		 *  softmax of a vector (in-place)
+		 *
+		 *  With the values at hand, the maximum is
+		 *  taken first, so that each element needs
+		 *  one exp (stored), and the sum is then
+		 *  applied by a multiplication.
+		 *
+		 ********************************************/
+
+		template<typename T>
+		inline void softmax_vec(T *a, index_t step, index_t len)
+		{
+			T m = -std::numeric_limits<T>::infinity();
+			for (index_t i = 0; i < len; ++i) if (a[i * step] > m) m = a[i * step];
+
+			T s(0);
+			for (index_t i = 0; i < len; ++i) s += (a[i * step] = std::exp(a[i * step] - m));
+
+			const T c = T(1) / s;
+			for (index_t i = 0; i < len; ++i) a[i * step] *= c;
+		}
+
+		template<typename T>
+		inline void softmax_vec_cont(T *a, index_t len, meta::bool_<false>)
+		{
+			softmax_vec(a, 1, len);
+		}
+
+		template<typename T>
+		inline void softmax_vec_cont(T *a, index_t len, meta::bool_<true>)
+		{
+			typedef simd_pack<T, default_simd_kind> pack_t;
+			const index_t w = (index_t)simd_traits<T, default_simd_kind>::pack_width;
+			const index_t lp = len - len % w;
+
+			pack_t mp = pack_t::neg_inf();
+			for (index_t i = 0; i < lp; i += w) mp = (math::max)(mp, pack_t(a + i));
+
+			T m = lp > 0 ? maximum(mp) : -std::numeric_limits<T>::infinity();
+			for (index_t i = lp; i < len; ++i) if (a[i] > m) m = a[i];
+
+			mp = pack_t(m);
+			pack_t sp = pack_t::zeros();
+			for (index_t i = 0; i < lp; i += w)
+			{
+				pack_t e = lse_exp(pack_t(a + i) - mp);
+				e.store_u(a + i);
+				sp += e;
+			}
+
+			T s = lp > 0 ? sum(sp) : T(0);
+			for (index_t i = lp; i < len; ++i) s += (a[i] = std::exp(a[i] - m));
+
+			const T c = T(1) / s;
+			const pack_t cp(c);
+			for (index_t i = 0; i < lp; i += w) (pack_t(a + i) * cp).store_u(a + i);
+			for (index_t i = lp; i < len; ++i) a[i] *= c;
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  log-sum-exp
+	 *
+	 *  logsumexp(a):            over all elements
+	 *  colwise_logsumexp(a, r): r has n elements
+	 *  rowwise_logsumexp(a, r): r has m elements
+	 *
+	 *  The log-sum-exp of nothing is -inf.
+	 *
+	 ********************************************/
+
+	template<typename T, class A>
+	inline T logsumexp(const IRegularMatrix<A, T>& a)
+	{
+		static_assert(std::is_floating_point<T>::value, "logsumexp: T must be a floating point type.");
+
+		const A& a_ = a.derived();
+		const index_t m = a_.nrows();
+		const index_t n = a_.ncolumns();
+		if (m == 0 || n == 0) return -std::numeric_limits<T>::infinity();
+
+		if (a_.row_stride() == 1 && (n == 1 || a_.col_stride() == m))
+			return internal::lse_long(a_.ptr_data(), m * n).value();
+
+		if (m == 1)
+		{
+			internal::lse_state<T> st;
+			internal::lse_vec(st, a_.ptr_data(), a_.col_stride(), n);
+			return st.value();
+		}
+
+		std::vector<internal::lse_state<T> > sts((size_t)n);
+		internal::lse_multi(&sts[0], a_.ptr_data(), a_.row_stride(), a_.col_stride(), m, n);
+
+		for (index_t j = 1; j < n; ++j) sts[0].merge(sts[j]);
+		return sts[0].value();
+	}
+
+	template<typename T, class A, class DMat>
+	inline void colwise_logsumexp(const IRegularMatrix<A, T>& a, IRegularMatrix<DMat, T>& dmat)
+	{
+		static_assert(std::is_floating_point<T>::value, "colwise_logsumexp: T must be a floating point type.");
+
+		const A& a_ = a.derived();
+		const index_t n = a_.ncolumns();
+		LMAT_CHECK_DIMS( dmat.nelems() == n );
+		if (n == 0) return;
+
+		std::vector<internal::lse_state<T> > sts((size_t)n);
+		internal::lse_multi(&sts[0], a_.ptr_data(), a_.row_stride(), a_.col_stride(), a_.nrows(), n);
+
+		DMat& d = dmat.derived();
+		for (index_t j = 0; j < n; ++j) d[j] = sts[j].value();
+	}
+
+	template<typename T, class A, class DMat>
+	inline void rowwise_logsumexp(const IRegularMatrix<A, T>& a, IRegularMatrix<DMat, T>& dmat)
+	{
+		static_assert(std::is_floating_point<T>::value, "rowwise_logsumexp: T must be a floating point type.");
+
+		const A& a_ = a.derived();
+		const index_t m = a_.nrows();
+		LMAT_CHECK_DIMS( dmat.nelems() == m );
+		if (m == 0) return;
+
+		std::vector<internal::lse_state<T> > sts((size_t)m);
+		internal::lse_multi(&sts[0], a_.ptr_data(), a_.col_stride(), a_.row_stride(), a_.ncolumns(), m);
+
+		DMat& d = dmat.derived();
+		for (index_t i = 0; i < m; ++i) d[i] = sts[i].value();
+	}
+
+
+	/********************************************
+	 *
+	 *  softmax (in-place)
+	 *
+	 *  colwise_softmax(a): each column of a is
+	 *  replaced by exp(a(:,j) - logsumexp(a(:,j)))
+	 *
+	 ********************************************/
+
+	template<typename T, class A>
+	inline void colwise_softmax(IRegularMatrix<A, T>& a)
+	{
+		static_assert(std::is_floating_point<T>::value, "colwise_softmax: T must be a floating point type.");
+
+		A& a_ = a.derived();
+		const index_t m = a_.nrows();
+		const index_t n = a_.ncolumns();
+		if (m == 0 || n == 0) return;
+
+		const index_t rs = a_.row_stride();
+
+#ifdef _OPENMP
+#pragma omp parallel for if (m * n >= internal::lse_omp_threshold && n > 1)
+#endif
+		for (index_t j = 0; j < n; ++j)
+		{
+			if (rs == 1)
+				internal::softmax_vec_cont(a_.ptr_col(j), m, meta::bool_<internal::lse_use_simd<T>::value>());
+			else
+				internal::softmax_vec(a_.ptr_col(j), rs, m);
+		}
+	}
+
+}
+
+#endif
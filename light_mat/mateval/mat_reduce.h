@@ -14,6 +14,7 @@
 #define LIGHTMAT_MAT_REDUCE_H_
 
 #include "internal/mat_reduce_internal.h"
+#include <light_mat/dispatch/dispatch_route.h>
 
 
 /********************************************
@@ -28,6 +29,7 @@
 	template<typename T, class A> \
 	LMAT_ENSURE_INLINE \
 	inline T Name(const IEWiseMatrix<A, T>& a) { \
+		LMAT_DISPATCH_ROUTE_VALUE( T, Name, a.derived() ) \
 		return a.nelems() > 0 ? \
 				fold(Name##_kernel<T>())(a.shape(), in_(a)) : \
 				internal::empty_values<T>::Name(); }
@@ -204,7 +206,14 @@ namespace lmat
 	LMAT_DEFINE_FULL_REDUCTION_2( diff_amax,  maximum, abs(a - b), T(0) )
 	LMAT_DEFINE_FULL_REDUCTION_2( diff_sqsum, sum,     sqr(a - b), T(0) )
 
-	LMAT_DEFINE_FULL_REDUCTION_2( dot, sum, a * b, T(0) )
+	template<typename T, class A, class B>
+	LMAT_ENSURE_INLINE
+	inline T dot(const IEWiseMatrix<A, T>& a, const IEWiseMatrix<B, T>& b)
+	{
+		typename meta::common_shape<A, B>::type shape = internal::reduc_get_shape(a, b);
+		LMAT_DISPATCH_ROUTE_VALUE( T, dot, a.derived(), b.derived() )
+		return shape.nelems() > 0 ? fold(dot_kernel<T>())(shape, in_(a), in_(b)) : T(0);
+	}
 
 	// colwise reduction
 
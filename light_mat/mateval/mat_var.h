@@ -0,0 +1,314 @@
+/**
+ * @file mat_var.h
+ *
+ * @brief One-pass variance and standard deviation of matrices
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_MAT_VAR_H_
+#define LIGHTMAT_MAT_VAR_H_
+
+#include "internal/mat_reduce_internal.h"
+#include <light_mat/matrix/dense_matrix.h>
+
+namespace lmat
+{
+	namespace internal
+	{
+		template<typename T>
+		struct meanvar_elem
+		{
+			typedef T type;
+		};
+
+		template<typename T, typename Kind>
+		struct meanvar_elem<simd_pack<T, Kind> >
+		{
+			typedef T type;
+		};
+	}
+
+
+	/********************************************
+	 *
+	 *  mean-var statistics
+	 *
+	 *  Welford's update for single values, and
+	 *  Chan's pairwise merge for partial stats,
+	 *  such that the data is scanned only once.
+	 *
+	 *  For a SIMD pack, each lane keeps its
+	 *  own mean/m2, while they share the count.
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct meanvar_stat
+	{
+		typedef typename internal::meanvar_elem<T>::type elem_t;
+
+		index_t count;
+		T mean;
+		T m2;    // sum of squared deviations from mean
+
+		meanvar_stat() { }
+
+		meanvar_stat(const T& x)
+		: count(1), mean(x), m2(elem_t(0)) { }
+
+		void update(const T& x)
+		{
+			++ count;
+			T d = x - mean;
+			mean += d * T(elem_t(1) / elem_t(count));
+			m2 += d * (x - mean);
+		}
+
+		void update(const meanvar_stat& s)
+		{
+			index_t n = count + s.count;
+			elem_t w = elem_t(s.count) / elem_t(n);
+
+			T d = s.mean - mean;
+			mean += d * T(w);
+			m2 += s.m2 + d * d * T(elem_t(count) * w);
+			count = n;
+		}
+
+		elem_t var_factor() const  // normalized by count - 1 (unbiased)
+		{
+			return count > 1 ? elem_t(1) / elem_t(count - 1) : elem_t(0);
+		}
+
+		T var() const
+		{
+			return m2 * T(var_factor());
+		}
+	};
+
+	template<typename T>
+	LMAT_ENSURE_INLINE
+	inline meanvar_stat<T> meanvar_empty_value()
+	{
+		meanvar_stat<T> s;
+		s.count = 0;
+		s.mean = std::numeric_limits<T>::quiet_NaN();
+		s.m2 = std::numeric_limits<T>::quiet_NaN();
+		return s;
+	}
+
+	template<typename T, typename Kind>
+	LMAT_ENSURE_INLINE
+	inline meanvar_stat<T> reduce_impl(const meanvar_stat<simd_pack<T, Kind> >& s)
+	{
+		// all lanes have the same count, so the merge reduces to
+		// m2 = sum(m2_i) + count * sum((mean_i - mean)^2)
+
+		typedef simd_pack<T, Kind> pack_t;
+		const unsigned int w = pack_t::pack_width;
+
+		meanvar_stat<T> r;
+		r.count = s.count * (index_t)w;
+		r.mean = sum(s.mean) * (T(1) / T(w));
+
+		pack_t d = s.mean - pack_t(r.mean);
+		r.m2 = sum(s.m2) + T(s.count) * sum(d * d);
+		return r;
+	}
+
+	LMAT_DEFINE_AGGREG_SIMD_FOLDKERNEL(meanvar_stat, meanvar_kernel, 1)
+
+	LMAT_DEF_SIMD_SUPPORT( meanvar_kernel )
+
+
+	// row-wise update kernel: (mean, m2) <- x, with r = 1 / count
+
+	template<typename T>
+	struct welford_kernel
+	{
+		typedef T value_type;
+
+		LMAT_ENSURE_INLINE
+		void operator() (T& mu, T& m2, const T& r, const T& x) const
+		{
+			T d = x - mu;
+			mu += d * r;
+			m2 += d * (x - mu);
+		}
+	};
+
+	LMAT_DEF_SIMD_SUPPORT( welford_kernel )
+
+
+	/********************************************
+	 *
+	 *  full reduction
+	 *
+	 ********************************************/
+
+	template<typename T, class A>
+	LMAT_ENSURE_INLINE
+	inline meanvar_stat<T> meanvar(const IEWiseMatrix<A, T>& a)
+	{
+		return a.nelems() > 0 ?
+				fold(meanvar_kernel<T>())(a.shape(), in_(a)) :
+				meanvar_empty_value<T>();
+	}
+
+	template<typename T, class A>
+	LMAT_ENSURE_INLINE
+	inline T var(const IEWiseMatrix<A, T>& a)
+	{
+		return meanvar(a).var();
+	}
+
+	template<typename T, class A>
+	LMAT_ENSURE_INLINE
+	inline T stddev(const IEWiseMatrix<A, T>& a)
+	{
+		return math::sqrt(var(a));
+	}
+
+
+	/********************************************
+	 *
+	 *  colwise reduction
+	 *
+	 ********************************************/
+
+	template<typename T, class A, class DMat1, class DMat2>
+	inline void colwise_meanvar(const IEWiseMatrix<A, T>& a,
+			IRegularMatrix<DMat1, T>& dmat_mean,
+			IRegularMatrix<DMat2, T>& dmat_var)
+	{
+		auto shape = internal::reduc_get_shape(a);
+		const index_t n = shape.ncolumns();
+		LMAT_CHECK_DIMS( n == dmat_mean.nelems() && n == dmat_var.nelems() )
+
+		if (shape.nrows() > 0)
+		{
+			auto g = make_colwise_fold_getter(meanvar_kernel<T>(), shape, a);
+
+			DMat1& d1 = dmat_mean.derived();
+			DMat2& d2 = dmat_var.derived();
+
+			for (index_t j = 0; j < n; ++j)
+			{
+				meanvar_stat<T> s = g[j];
+				d1[j] = s.mean;
+				d2[j] = s.var();
+			}
+		}
+		else
+		{
+			fill(dmat_mean, internal::empty_values<T>::mean());
+			fill(dmat_var, internal::empty_values<T>::mean());
+		}
+	}
+
+	template<typename T, class A, class DMat>
+	inline void colwise_var(const IEWiseMatrix<A, T>& a, IRegularMatrix<DMat, T>& dmat)
+	{
+		auto shape = internal::reduc_get_shape(a);
+		const index_t n = shape.ncolumns();
+		LMAT_CHECK_DIMS( n == dmat.nelems() )
+
+		if (shape.nrows() > 0)
+		{
+			auto g = make_colwise_fold_getter(meanvar_kernel<T>(), shape, a);
+
+			DMat& d = dmat.derived();
+			for (index_t j = 0; j < n; ++j) d[j] = g[j].var();
+		}
+		else
+		{
+			fill(dmat, internal::empty_values<T>::mean());
+		}
+	}
+
+	template<typename T, class A, class DMat>
+	inline void colwise_stddev(const IEWiseMatrix<A, T>& a, IRegularMatrix<DMat, T>& dmat)
+	{
+		colwise_var(a, dmat);
+
+		DMat& d = dmat.derived();
+		const index_t n = d.nelems();
+		for (index_t j = 0; j < n; ++j) d[j] = math::sqrt(d[j]);
+	}
+
+
+	/********************************************
+	 *
+	 *  rowwise reduction
+	 *
+	 ********************************************/
+
+	template<typename T, class A, class DMat1, class DMat2>
+	inline void rowwise_meanvar(const IEWiseMatrix<A, T>& a,
+			IRegularMatrix<DMat1, T>& dmat_mean,
+			IRegularMatrix<DMat2, T>& dmat_var)
+	{
+		typedef typename meta::shape<A>::type shape_t;
+		const index_t CM = shape_t::ct_nrows;
+
+		shape_t shape = internal::reduc_get_shape(a);
+		dimension<CM> col_dim(shape.nrows());
+		const index_t n = shape.ncolumns();
+
+		LMAT_CHECK_DIMS( col_dim.value() == dmat_mean.nelems() && col_dim.value() == dmat_var.nelems() )
+
+		if (n == 0)
+		{
+			fill(dmat_mean, internal::empty_values<T>::mean());
+			fill(dmat_var, internal::empty_values<T>::mean());
+			return;
+		}
+
+		typedef preferred_macc_policy<matrix_shape<CM, 1>, welford_kernel<T>, DMat1, DMat2, arg_wrap<A, atags::in> > pmap;
+		typedef typename pmap::unit U;
+
+		auto amu = make_vec_accessor(U(), in_out_(dmat_mean));
+		auto am2 = make_vec_accessor(U(), in_out_(dmat_var));
+		auto rd = make_multicol_accessor(U(), in_(a));
+
+		internal::_linear_ewise_eval(col_dim, U(), copy_kernel<T>(), rd.col(0), amu);
+		fill(dmat_var, T(0));
+
+		for (index_t j = 1; j < n; ++j)
+		{
+			const T r = T(1) / T(j + 1);
+			internal::_linear_ewise_eval(col_dim, U(), welford_kernel<T>(),
+					amu, am2, make_vec_accessor(U(), const_(r)), rd.col(j));
+		}
+
+		if (n > 1)
+		{
+			dmat_var.derived() *= math::rcp(T(n - 1));
+		}
+	}
+
+	template<typename T, class A, class DMat>
+	inline void rowwise_var(const IEWiseMatrix<A, T>& a, IRegularMatrix<DMat, T>& dmat)
+	{
+		dense_col<T, meta::nrows<A>::value> mu(a.nrows());
+		rowwise_meanvar(a, mu, dmat);
+	}
+
+	template<typename T, class A, class DMat>
+	inline void rowwise_stddev(const IEWiseMatrix<A, T>& a, IRegularMatrix<DMat, T>& dmat)
+	{
+		rowwise_var(a, dmat);
+
+		DMat& d = dmat.derived();
+		const index_t m = d.nelems();
+		for (index_t i = 0; i < m; ++i) d[i] = math::sqrt(d[i]);
+	}
+
+}
+
+#endif
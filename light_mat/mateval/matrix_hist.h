@@ -0,0 +1,810 @@
+/**
+ * @file matrix_hist.h
+ *
+ * Counting and grouped aggregation: bincount, histogram, accumarray
+ *
+ * Labels (and bins) are integers in [0, K), where K is given by the
+ * size of the output. Elements whose label or value falls outside
+ * the bins are ignored. Matrices are traversed in column-major order.
+ *
+ * Large inputs are split over the threads (with OpenMP), each of which
+ * accumulates into its own copy of the bins; the copies are merged in
+ * a fixed order at the end, so the results do not depend on timing.
+ *
+ * Counting avoids the store-to-load conflicts of consecutive elements
+ * falling into the same bin: with at most 8 bins, contiguous int32
+ * labels are compared with all the bins a pack at a time; otherwise
+ * consecutive elements go to interleaved copies of the bins.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_MATRIX_HIST_H_
+#define LIGHTMAT_MATRIX_HIST_H_
+
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/simd/simd_base.h>
+#include <light_mat/common/parallel.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace lmat
+{
+	namespace accum
+	{
+		struct sum_ { };
+		struct mean_ { };
+		struct min_ { };
+		struct max_ { };
+	}
+
+	namespace internal
+	{
+		const index_t hist_omp_threshold = 65536;
+		const index_t hist_max_small_bins = 8;
+		const index_t hist_max_replicated_bins = 4096;
+		const index_t hist_replicas = 4;
+
+
+		/********************************************
+		 *
+		 *  linear traversal
+		 *
+		 *  A matrix is visited as nseg segments of
+		 *  len elements: the e-th element of the
+		 *  s-th segment is at p[e * es + s * ss].
+		 *  A vector or a contiguous matrix is a
+		 *  single segment.
+		 *
+		 ********************************************/
+
+		template<typename T>
+		struct hist_view
+		{
+			const T *p;
+			index_t len;
+			index_t nseg;
+			index_t es;
+			index_t ss;
+
+			LMAT_ENSURE_INLINE
+			const T *ptr(index_t s, index_t e) const
+			{
+				return p + s * ss + e * es;
+			}
+		};
+
+		template<typename T, class Mat>
+		inline hist_view<T> make_hist_view(const IRegularMatrix<Mat, T>& a, bool flat)
+		{
+			const Mat& a_ = a.derived();
+			const index_t m = a_.nrows();
+			const index_t n = a_.ncolumns();
+
+			hist_view<T> v = { a_.ptr_data(), m, n, a_.row_stride(), a_.col_stride() };
+			if (flat)
+			{
+				if (n == 1) { v.nseg = 1; }
+				else if (m == 1) { v.len = n; v.nseg = 1; v.es = a_.col_stride(); }
+				else if (a_.row_stride() == 1 && a_.col_stride() == m) { v.len = m * n; v.nseg = 1; }
+			}
+			return v;
+		}
+
+		template<typename T>
+		LMAT_ENSURE_INLINE
+		inline bool is_flat(const hist_view<T>& v)
+		{
+			return v.nseg == 1;
+		}
+
+		// calls f(s, e, l) on the pieces of segments that cover the
+		// linear range [i0, i0 + ni)
+
+		template<class F>
+		inline void for_segment_pieces(index_t len, index_t i0, index_t ni, F f)
+		{
+			index_t s = i0 / len;
+			index_t e = i0 % len;
+			while (ni > 0)
+			{
+				const index_t l = std::min(len - e, ni);
+				f(s, e, l);
+				ni -= l;
+				++ s;
+				e = 0;
+			}
+		}
+
+
+		/********************************************
+		 *
+		 *  privatized accumulation
+		 *
+		 *  scan(i0, ni, bins) accumulates the linear
+		 *  range [i0, i0 + ni) into nb bins, and
+		 *  merge(dst, src) merges one set of nb
+		 *  bins into another.
+		 *
+		 ********************************************/
+
+		template<typename B, class Scan, class Merge>
+		inline void privatized_scan(index_t total, index_t nb, B *bins, const B& init, Scan scan, Merge merge)
+		{
+#ifdef _OPENMP
+			const index_t maxt = (index_t)omp_get_max_threads();
+
+			if (maxt > 1 && total >= hist_omp_threshold && nb <= total / 4)
+			{
+				std::vector<B> priv((size_t)(maxt * nb), init);
+				index_t nt = 1;
+
+#pragma omp parallel num_threads(maxt)
+				{
+					const index_t t = (index_t)omp_get_thread_num();
+					if (t == 0) nt = (index_t)omp_get_num_threads();
+
+					index_t i0, ni;
+					static_column_slab(total, (index_t)omp_get_num_threads(), t, i0, ni);
+					if (ni > 0) scan(i0, ni, &priv[(size_t)(t * nb)]);
+				}
+
+				for (index_t t = 0; t < nt; ++t) merge(bins, &priv[(size_t)(t * nb)]);
+				return;
+			}
+#endif
+			scan(0, total, bins);
+		}
+
+
+		/********************************************
+		 *
+		 *  counting
+		 *
+		 ********************************************/
+
+		template<typename TI>
+		struct label_binner
+		{
+			index_t K;
+
+			LMAT_ENSURE_INLINE
+			index_t operator() (const TI& x) const
+			{
+				return x >= 0 && x < K ? (index_t)x : -1;
+			}
+		};
+
+		template<typename T>
+		struct uniform_binner
+		{
+			T lo;
+			T hi;
+			T scale;
+			index_t K;
+
+			LMAT_ENSURE_INLINE
+			index_t operator() (const T& x) const
+			{
+				if (!(x >= lo && x <= hi)) return -1;
+				index_t k = (index_t)((x - lo) * scale);
+				return k < K ? k : K - 1;
+			}
+		};
+
+		// the bins [e[k], e[k+1]), with the last one closed;
+		// uniform edges are located by a guess that is then
+		// corrected, others by a binary search
+
+		template<typename T>
+		struct edges_binner
+		{
+			const T *e;
+			index_t K;
+			bool uniform;
+			T scale;
+
+			LMAT_ENSURE_INLINE
+			index_t operator() (const T& x) const
+			{
+				if (!(x >= e[0] && x <= e[K])) return -1;
+				if (x == e[K]) return K - 1;
+
+				if (uniform)
+				{
+					index_t k = (index_t)((x - e[0]) * scale);
+					if (k >= K) k = K - 1;
+					while (x < e[k]) --k;
+					while (x >= e[k + 1]) ++k;
+					return k;
+				}
+				else
+				{
+					return (index_t)(std::upper_bound(e, e + (K + 1), x) - e) - 1;
+				}
+			}
+		};
+
+		template<typename T>
+		inline edges_binner<T> make_edges_binner(const std::vector<T>& e)
+		{
+			const index_t K = (index_t)e.size() - 1;
+
+			for (index_t k = 0; k < K; ++k)
+			{
+				if (!(e[k] < e[k + 1]))
+					throw invalid_argument("histogram: the edges must be strictly increasing.");
+			}
+
+			const T w = (e[K] - e[0]) / T(K);
+			bool u = true;
+			for (index_t k = 1; k < K && u; ++k)
+			{
+				T d = e[k] - (e[0] + w * T(k));
+				if (d < 0) d = -d;
+				u = d <= w * T(1.0e-3);
+			}
+
+			edges_binner<T> b = { &e[0], K, u, T(1) / w };
+			return b;
+		}
+
+		template<typename T, class Binner>
+		inline void count_scan(const T *p, index_t len, index_t step, const Binner& bin, index_t K, index_t *c)
+		{
+			if (K > hist_max_replicated_bins || len < 4 * K)
+			{
+				for (index_t i = 0; i < len; ++i)
+				{
+					const index_t k = bin(p[i * step]);
+					if (k >= 0) ++ c[k];
+				}
+				return;
+			}
+
+			// consecutive elements go to different copies of the bins
+
+			std::vector<index_t> rc((size_t)(hist_replicas * K), 0);
+			index_t *c0 = &rc[0];
+			index_t *c1 = c0 + K;
+			index_t *c2 = c1 + K;
+			index_t *c3 = c2 + K;
+
+			index_t i = 0;
+			for (; i + 4 <= len; i += 4)
+			{
+				const index_t k0 = bin(p[i * step]);
+				const index_t k1 = bin(p[(i + 1) * step]);
+				const index_t k2 = bin(p[(i + 2) * step]);
+				const index_t k3 = bin(p[(i + 3) * step]);
+
+				if (k0 >= 0) ++ c0[k0];
+				if (k1 >= 0) ++ c1[k1];
+				if (k2 >= 0) ++ c2[k2];
+				if (k3 >= 0) ++ c3[k3];
+			}
+			for (; i < len; ++i)
+			{
+				const index_t k = bin(p[i * step]);
+				if (k >= 0) ++ c0[k];
+			}
+
+			for (index_t k = 0; k < K; ++k) c[k] += c0[k] + c1[k] + c2[k] + c3[k];
+		}
+
+#ifdef LMAT_HAS_SSE2
+
+		// each bin is compared with a pack of labels at a time,
+		// and the matches are subtracted (as -1) from its counter
+
+		template<int K>
+		inline void count_small_sse2(const int32_t *p, index_t len, index_t *c)
+		{
+			const index_t chunk = index_t(1) << 20;
+
+			index_t i = 0;
+			while (len - i >= 4)
+			{
+				const index_t ie = i + std::min(chunk, (len - i) & ~index_t(3));
+
+				__m128i acc[K];
+				for (int k = 0; k < K; ++k) acc[k] = _mm_setzero_si128();
+
+				for (; i < ie; i += 4)
+				{
+					const __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+					for (int k = 0; k < K; ++k)
+						acc[k] = _mm_sub_epi32(acc[k], _mm_cmpeq_epi32(v, _mm_set1_epi32(k)));
+				}
+
+				for (int k = 0; k < K; ++k)
+				{
+					LMAT_ALIGN_SSE int32_t r[4];
+					_mm_store_si128((__m128i*)r, acc[k]);
+					c[k] += (index_t)r[0] + (index_t)r[1] + (index_t)r[2] + (index_t)r[3];
+				}
+			}
+
+			for (; i < len; ++i)
+			{
+				if (p[i] >= 0 && p[i] < K) ++ c[p[i]];
+			}
+		}
+
+		inline void count_labels_small(const int32_t *p, index_t len, index_t K, index_t *c)
+		{
+			switch (K)
+			{
+				case 1: count_small_sse2<1>(p, len, c); break;
+				case 2: count_small_sse2<2>(p, len, c); break;
+				case 3: count_small_sse2<3>(p, len, c); break;
+				case 4: count_small_sse2<4>(p, len, c); break;
+				case 5: count_small_sse2<5>(p, len, c); break;
+				case 6: count_small_sse2<6>(p, len, c); break;
+				case 7: count_small_sse2<7>(p, len, c); break;
+				default: count_small_sse2<8>(p, len, c); break;
+			}
+		}
+
+		inline void count_labels(const int32_t *p, index_t len, index_t step, index_t K, index_t *c)
+		{
+			if (step == 1 && K <= hist_max_small_bins)
+				count_labels_small(p, len, K, c);
+			else
+				count_scan(p, len, step, label_binner<int32_t>{K}, K, c);
+		}
+
+#endif
+
+		template<typename TI>
+		inline void count_labels(const TI *p, index_t len, index_t step, index_t K, index_t *c)
+		{
+			count_scan(p, len, step, label_binner<TI>{K}, K, c);
+		}
+
+		// counting functors (used on all pieces of a view)
+
+		template<typename TI>
+		struct label_counter
+		{
+			index_t K;
+
+			LMAT_ENSURE_INLINE
+			void operator() (const TI *p, index_t len, index_t step, index_t *c) const
+			{
+				count_labels(p, len, step, K, c);
+			}
+		};
+
+		template<typename T, class Binner>
+		struct binned_counter
+		{
+			Binner bin;
+			index_t K;
+
+			LMAT_ENSURE_INLINE
+			void operator() (const T *p, index_t len, index_t step, index_t *c) const
+			{
+				count_scan(p, len, step, bin, K, c);
+			}
+		};
+
+		template<typename T, class Counter>
+		inline void count_all(const hist_view<T>& v, const Counter& cnt, index_t K, index_t *c)
+		{
+			const index_t len = v.len;
+
+			privatized_scan(len * v.nseg, K, c, index_t(0),
+				[&v, &cnt, len](index_t i0, index_t ni, index_t *b)
+				{
+					for_segment_pieces(len, i0, ni, [&v, &cnt, b](index_t s, index_t e, index_t l)
+					{
+						cnt(v.ptr(s, e), l, v.es, b);
+					});
+				},
+				[K](index_t *d, const index_t *s)
+				{
+					for (index_t k = 0; k < K; ++k) d[k] += s[k];
+				});
+		}
+
+		template<typename T, class Counter, class C>
+		inline void count_colwise(const hist_view<T>& v, const Counter& cnt, index_t K, C& out)
+		{
+			typedef typename matrix_traits<C>::value_type TC;
+			const index_t n = v.nseg;
+
+#ifdef _OPENMP
+#pragma omp parallel if (v.len * n >= hist_omp_threshold)
+#endif
+			{
+				std::vector<index_t> c((size_t)K);
+
+#ifdef _OPENMP
+#pragma omp for
+#endif
+				for (index_t j = 0; j < n; ++j)
+				{
+					std::fill(c.begin(), c.end(), index_t(0));
+					cnt(v.ptr(j, 0), v.len, v.es, &c[0]);
+					for (index_t k = 0; k < K; ++k) out(k, j) = static_cast<TC>(c[k]);
+				}
+			}
+		}
+
+		template<class C>
+		inline void write_counts(const std::vector<index_t>& c, C& out)
+		{
+			typedef typename matrix_traits<C>::value_type TC;
+			for (index_t k = 0; k < (index_t)c.size(); ++k) out[k] = static_cast<TC>(c[k]);
+		}
+
+		template<typename T, class E>
+		inline std::vector<T> hist_edges(const IRegularMatrix<E, T>& edges, index_t K)
+		{
+			LMAT_CHECK_DIMS( edges.nelems() == K + 1 )
+			if (K < 1)
+				throw invalid_argument("histogram: there must be at least one bin.");
+
+			const E& e_ = edges.derived();
+			std::vector<T> e((size_t)(K + 1));
+			for (index_t k = 0; k <= K; ++k) e[k] = e_.elem(k % e_.nrows(), k / e_.nrows());
+			return e;
+		}
+
+		template<typename T>
+		inline uniform_binner<T> make_uniform_binner(const T& lo, const T& hi, index_t K)
+		{
+			if (K < 1)
+				throw invalid_argument("histogram: there must be at least one bin.");
+			if (!(lo < hi))
+				throw invalid_argument("histogram: lo must be less than hi.");
+
+			uniform_binner<T> b = { lo, hi, T(K) / (hi - lo), K };
+			return b;
+		}
+
+
+		/********************************************
+		 *
+		 *  grouped aggregation
+		 *
+		 ********************************************/
+
+		template<typename T>
+		struct accum_cell
+		{
+			T v;
+			index_t n;
+		};
+
+		template<class Op> struct accum_op;
+
+		template<>
+		struct accum_op<accum::sum_>
+		{
+			template<typename T>
+			LMAT_ENSURE_INLINE static T init() { return T(0); }
+
+			template<typename T>
+			LMAT_ENSURE_INLINE static void add(T& a, const T& x) { a += x; }
+
+			template<typename T>
+			LMAT_ENSURE_INLINE static T result(const accum_cell<T>& c) { return c.v; }
+		};
+
+		template<>
+		struct accum_op<accum::mean_>
+		{
+			template<typename T>
+			LMAT_ENSURE_INLINE static T init() { return T(0); }
+
+			template<typename T>
+			LMAT_ENSURE_INLINE static void add(T& a, const T& x) { a += x; }
+
+			template<typename T>
+			LMAT_ENSURE_INLINE static T result(const accum_cell<T>& c) { return c.n > 0 ? c.v / T(c.n) : T(0); }
+		};
+
+		template<>
+		struct accum_op<accum::min_>
+		{
+			template<typename T>
+			LMAT_ENSURE_INLINE static T init()
+			{
+				return std::numeric_limits<T>::has_infinity ?
+						std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+			}
+
+			template<typename T>
+			LMAT_ENSURE_INLINE static void add(T& a, const T& x) { if (x < a) a = x; }
+
+			template<typename T>
+			LMAT_ENSURE_INLINE static T result(const accum_cell<T>& c) { return c.n > 0 ? c.v : T(0); }
+		};
+
+		template<>
+		struct accum_op<accum::max_>
+		{
+			template<typename T>
+			LMAT_ENSURE_INLINE static T init()
+			{
+				return std::numeric_limits<T>::has_infinity ?
+						-std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+			}
+
+			template<typename T>
+			LMAT_ENSURE_INLINE static void add(T& a, const T& x) { if (x > a) a = x; }
+
+			template<typename T>
+			LMAT_ENSURE_INLINE static T result(const accum_cell<T>& c) { return c.n > 0 ? c.v : T(0); }
+		};
+
+		template<class Op, typename TI, typename T>
+		inline void accum_scan(const TI *lp, index_t ls, const T *vp, index_t vs, index_t len,
+				index_t K, accum_cell<T> *cells)
+		{
+			for (index_t i = 0; i < len; ++i)
+			{
+				const TI k = lp[i * ls];
+				if (k >= 0 && k < K)
+				{
+					accum_cell<T>& c = cells[k];
+					accum_op<Op>::add(c.v, vp[i * vs]);
+					++ c.n;
+				}
+			}
+		}
+
+		template<class Op, typename T>
+		inline void accum_merge(accum_cell<T> *d, const accum_cell<T> *s, index_t K)
+		{
+			for (index_t k = 0; k < K; ++k)
+			{
+				accum_op<Op>::add(d[k].v, s[k].v);
+				d[k].n += s[k].n;
+			}
+		}
+
+		template<class Op, typename T>
+		inline accum_cell<T> accum_init_cell()
+		{
+			accum_cell<T> c = { accum_op<Op>::template init<T>(), 0 };
+			return c;
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  bincount
+	 *
+	 *  counts[k] <- the number of labels equal
+	 *  to k (for k in [0, K), K = counts.nelems())
+	 *
+	 *  colwise: counts is K x n, and its j-th
+	 *  column counts the j-th column of labels.
+	 *
+	 ********************************************/
+
+	template<typename TI, class L, typename TC, class C>
+	inline void bincount(const IRegularMatrix<L, TI>& labels, IRegularMatrix<C, TC>& counts)
+	{
+		static_assert(std::is_integral<TI>::value, "bincount: labels must be integers.");
+
+		const index_t K = counts.nelems();
+		std::vector<index_t> c((size_t)K, 0);
+
+		if (K > 0)
+			internal::count_all(internal::make_hist_view(labels, true),
+					internal::label_counter<TI>{K}, K, &c[0]);
+
+		internal::write_counts(c, counts.derived());
+	}
+
+	template<typename TI, class L, typename TC, class C>
+	inline void colwise_bincount(const IRegularMatrix<L, TI>& labels, IRegularMatrix<C, TC>& counts)
+	{
+		static_assert(std::is_integral<TI>::value, "colwise_bincount: labels must be integers.");
+		LMAT_CHECK_DIMS( counts.ncolumns() == labels.ncolumns() )
+
+		const index_t K = counts.nrows();
+		if (K == 0) return;
+
+		internal::count_colwise(internal::make_hist_view(labels, false),
+				internal::label_counter<TI>{K}, K, counts.derived());
+	}
+
+
+	/********************************************
+	 *
+	 *  histogram
+	 *
+	 *  With edges (K + 1 strictly increasing
+	 *  values), counts[k] is the number of x in
+	 *  [edges[k], edges[k+1]), where the last bin
+	 *  also includes edges[K].
+	 *
+	 *  With (lo, hi), the K bins split [lo, hi]
+	 *  uniformly.
+	 *
+	 *  K = counts.nelems() (or counts.nrows() for
+	 *  the colwise variants).
+	 *
+	 ********************************************/
+
+	template<typename T, class X, class E, typename TC, class C>
+	inline void histogram(const IRegularMatrix<X, T>& x, const IRegularMatrix<E, T>& edges,
+			IRegularMatrix<C, TC>& counts)
+	{
+		static_assert(std::is_floating_point<T>::value, "histogram: values must be real numbers.");
+		const index_t K = counts.nelems();
+		std::vector<T> e = internal::hist_edges(edges, K);
+		internal::edges_binner<T> bin = internal::make_edges_binner(e);
+
+		std::vector<index_t> c((size_t)K, 0);
+		internal::count_all(internal::make_hist_view(x, true),
+				internal::binned_counter<T, internal::edges_binner<T> >{bin, K}, K, &c[0]);
+
+		internal::write_counts(c, counts.derived());
+	}
+
+	template<typename T, class X, typename TC, class C>
+	inline void histogram(const IRegularMatrix<X, T>& x, const T& lo, const T& hi,
+			IRegularMatrix<C, TC>& counts)
+	{
+		static_assert(std::is_floating_point<T>::value, "histogram: values must be real numbers.");
+		const index_t K = counts.nelems();
+		internal::uniform_binner<T> bin = internal::make_uniform_binner(lo, hi, K);
+
+		std::vector<index_t> c((size_t)K, 0);
+		internal::count_all(internal::make_hist_view(x, true),
+				internal::binned_counter<T, internal::uniform_binner<T> >{bin, K}, K, &c[0]);
+
+		internal::write_counts(c, counts.derived());
+	}
+
+	template<typename T, class X, class E, typename TC, class C>
+	inline void colwise_histogram(const IRegularMatrix<X, T>& x, const IRegularMatrix<E, T>& edges,
+			IRegularMatrix<C, TC>& counts)
+	{
+		static_assert(std::is_floating_point<T>::value, "histogram: values must be real numbers.");
+		LMAT_CHECK_DIMS( counts.ncolumns() == x.ncolumns() )
+
+		const index_t K = counts.nrows();
+		std::vector<T> e = internal::hist_edges(edges, K);
+		internal::edges_binner<T> bin = internal::make_edges_binner(e);
+
+		internal::count_colwise(internal::make_hist_view(x, false),
+				internal::binned_counter<T, internal::edges_binner<T> >{bin, K}, K, counts.derived());
+	}
+
+	template<typename T, class X, typename TC, class C>
+	inline void colwise_histogram(const IRegularMatrix<X, T>& x, const T& lo, const T& hi,
+			IRegularMatrix<C, TC>& counts)
+	{
+		static_assert(std::is_floating_point<T>::value, "histogram: values must be real numbers.");
+		LMAT_CHECK_DIMS( counts.ncolumns() == x.ncolumns() )
+
+		const index_t K = counts.nrows();
+		internal::uniform_binner<T> bin = internal::make_uniform_binner(lo, hi, K);
+
+		internal::count_colwise(internal::make_hist_view(x, false),
+				internal::binned_counter<T, internal::uniform_binner<T> >{bin, K}, K, counts.derived());
+	}
+
+
+	/********************************************
+	 *
+	 *  accumarray
+	 *
+	 *  out[k] <- op over the values whose labels
+	 *  are k (K = out.nelems()), where op is
+	 *  accum::sum_ (default), mean_, min_ or max_.
+	 *  Bins without values receive 0.
+	 *
+	 *  colwise: labels has m elements (one per
+	 *  row of values), values is m x n and out is
+	 *  K x n: the rows of values are grouped by
+	 *  their labels, and aggregated per column.
+	 *
+	 ********************************************/
+
+	template<typename TI, class L, typename T, class V, class D, class Op>
+	inline void accumarray(const IRegularMatrix<L, TI>& labels, const IRegularMatrix<V, T>& values,
+			IRegularMatrix<D, T>& out, Op)
+	{
+		static_assert(std::is_integral<TI>::value, "accumarray: labels must be integers.");
+		LMAT_CHECK_DIMS( have_same_shape(labels, values) )
+
+		const index_t K = out.nelems();
+		std::vector<internal::accum_cell<T> > cells((size_t)K, internal::accum_init_cell<Op, T>());
+
+		if (K > 0)
+		{
+			internal::hist_view<TI> lv = internal::make_hist_view(labels, true);
+			internal::hist_view<T> vv = internal::make_hist_view(values, true);
+			if (!internal::is_flat(lv) || !internal::is_flat(vv))
+			{
+				lv = internal::make_hist_view(labels, false);
+				vv = internal::make_hist_view(values, false);
+			}
+
+			const index_t len = lv.len;
+			internal::privatized_scan(len * lv.nseg, K, &cells[0], internal::accum_init_cell<Op, T>(),
+				[&lv, &vv, len, K](index_t i0, index_t ni, internal::accum_cell<T> *b)
+				{
+					internal::for_segment_pieces(len, i0, ni, [&lv, &vv, K, b](index_t s, index_t e, index_t l)
+					{
+						internal::accum_scan<Op>(lv.ptr(s, e), lv.es, vv.ptr(s, e), vv.es, l, K, b);
+					});
+				},
+				[K](internal::accum_cell<T> *d, const internal::accum_cell<T> *s)
+				{
+					internal::accum_merge<Op>(d, s, K);
+				});
+		}
+
+		D& out_ = out.derived();
+		for (index_t k = 0; k < K; ++k) out_[k] = internal::accum_op<Op>::result(cells[k]);
+	}
+
+	template<typename TI, class L, typename T, class V, class D>
+	inline void accumarray(const IRegularMatrix<L, TI>& labels, const IRegularMatrix<V, T>& values,
+			IRegularMatrix<D, T>& out)
+	{
+		accumarray(labels, values, out, accum::sum_());
+	}
+
+	template<typename TI, class L, typename T, class V, class D, class Op>
+	inline void colwise_accumarray(const IRegularMatrix<L, TI>& labels, const IRegularMatrix<V, T>& values,
+			IRegularMatrix<D, T>& out, Op)
+	{
+		static_assert(std::is_integral<TI>::value, "colwise_accumarray: labels must be integers.");
+
+		const index_t m = values.nrows();
+		const index_t n = values.ncolumns();
+		const index_t K = out.nrows();
+
+		LMAT_CHECK_DIMS( labels.nelems() == m )
+		LMAT_CHECK_DIMS( out.ncolumns() == n )
+		if (K == 0) return;
+
+		internal::hist_view<TI> lv = internal::make_hist_view(labels, true);
+		internal::hist_view<T> vv = internal::make_hist_view(values, false);
+		D& out_ = out.derived();
+
+#ifdef _OPENMP
+#pragma omp parallel if (m * n >= internal::hist_omp_threshold)
+#endif
+		{
+			std::vector<internal::accum_cell<T> > cells((size_t)K);
+
+#ifdef _OPENMP
+#pragma omp for
+#endif
+			for (index_t j = 0; j < n; ++j)
+			{
+				std::fill(cells.begin(), cells.end(), internal::accum_init_cell<Op, T>());
+				internal::accum_scan<Op>(lv.p, lv.es, vv.ptr(j, 0), vv.es, m, K, &cells[0]);
+				for (index_t k = 0; k < K; ++k) out_(k, j) = internal::accum_op<Op>::result(cells[k]);
+			}
+		}
+	}
+
+	template<typename TI, class L, typename T, class V, class D>
+	inline void colwise_accumarray(const IRegularMatrix<L, TI>& labels, const IRegularMatrix<V, T>& values,
+			IRegularMatrix<D, T>& out)
+	{
+		colwise_accumarray(labels, values, out, accum::sum_());
+	}
+
+}
+
+#endif
@@ -0,0 +1,473 @@
+/**
+ * @file matrix_scan.h
+ *
+ * Inclusive prefix scans: cumsum, cumprod, cummax, cummin
+ *
+ * The whole-matrix forms scan all elements in column-major order,
+ * colwise forms scan each column, and rowwise forms scan each row.
+ * The result may be the input itself (in-place scan).
+ *
+ * Contiguous vectors are scanned a pack at a time: each pack is
+ * scanned in registers with log-step shifts, and then combined with
+ * the carry (the last value of the previous pack, broadcast), so that
+ * only one operation per pack is on the dependency chain.
+ *
+ * When consecutive vectors are adjacent in memory (rows of a
+ * column-major matrix, for rowwise scans), the scan proceeds along
+ * the other dimension: r(:,j) = op(r(:,j-1), a(:,j)), which is
+ * element-wise over contiguous memory and needs no shuffles at all.
+ *
+ * cummax and cummin propagate NaN: once a NaN is met, all the
+ * following results are NaN, in the pack and scalar paths alike.
+ *
+ * With OpenMP, many vectors are scanned in parallel, and a single
+ * long vector is scanned in two passes: each thread scans its block,
+ * the block totals are scanned, and each thread then combines its
+ * block with the total of the blocks before it.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_MATRIX_SCAN_H_
+#define LIGHTMAT_MATRIX_SCAN_H_
+
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/mateval/common_kernels.h>
+#include <light_mat/mateval/macc_policy.h>
+#include <light_mat/simd/simd.h>
+#include <light_mat/common/parallel.h>
+
+#include <algorithm>
+#include <vector>
+#include <type_traits>
+
+namespace lmat
+{
+	namespace internal
+	{
+		const index_t scan_omp_threshold = 65536;
+		const index_t scan_row_block = 1024;
+
+
+		/********************************************
+		 *
+		 *  scan operations
+		 *
+		 ********************************************/
+
+		struct scan_sum
+		{
+			template<typename T>
+			LMAT_ENSURE_INLINE
+			static T eval(const T& x, const T& y) { return x + y; }
+
+			template<typename T, typename K>
+			LMAT_ENSURE_INLINE
+			static simd_pack<T, K> eval(const simd_pack<T, K>& x, const simd_pack<T, K>& y) { return x + y; }
+
+			template<typename T, typename K>
+			LMAT_ENSURE_INLINE
+			static simd_pack<T, K> prefix(const simd_pack<T, K>& x) { return prefix_sum(x); }
+		};
+
+		struct scan_prod
+		{
+			template<typename T>
+			LMAT_ENSURE_INLINE
+			static T eval(const T& x, const T& y) { return x * y; }
+
+			template<typename T, typename K>
+			LMAT_ENSURE_INLINE
+			static simd_pack<T, K> eval(const simd_pack<T, K>& x, const simd_pack<T, K>& y) { return x * y; }
+
+			template<typename T, typename K>
+			LMAT_ENSURE_INLINE
+			static simd_pack<T, K> prefix(const simd_pack<T, K>& x) { return prefix_prod(x); }
+		};
+
+		struct scan_max
+		{
+			template<typename T>
+			LMAT_ENSURE_INLINE
+			static T eval(const T& x, const T& y) { return (y > x || y != y) ? y : x; }
+
+			template<typename T, typename K>
+			LMAT_ENSURE_INLINE
+			static simd_pack<T, K> eval(const simd_pack<T, K>& x, const simd_pack<T, K>& y)
+			{
+				return math::cond(math::isnan(x), x, (math::max)(x, y));  // maxps yields y if either is NaN
+			}
+
+			template<typename T, typename K>
+			LMAT_ENSURE_INLINE
+			static simd_pack<T, K> prefix(const simd_pack<T, K>& x) { return prefix_max(x); }
+		};
+
+		struct scan_min
+		{
+			template<typename T>
+			LMAT_ENSURE_INLINE
+			static T eval(const T& x, const T& y) { return (y < x || y != y) ? y : x; }
+
+			template<typename T, typename K>
+			LMAT_ENSURE_INLINE
+			static simd_pack<T, K> eval(const simd_pack<T, K>& x, const simd_pack<T, K>& y)
+			{
+				return math::cond(math::isnan(x), x, (math::min)(x, y));  // minps yields y if either is NaN
+			}
+
+			template<typename T, typename K>
+			LMAT_ENSURE_INLINE
+			static simd_pack<T, K> prefix(const simd_pack<T, K>& x) { return prefix_min(x); }
+		};
+
+		// the prefix scans are defined on real packs only
+
+		template<typename T>
+		struct scan_use_simd
+		{
+			static const bool value = std::is_floating_point<T>::value &&
+					supports_simd<T, default_simd_kind>::value;
+		};
+
+
+		/********************************************
+		 *
+		 *  vector kernels
+		 *
+		 *  scan_vec: r[i] = a[0] op ... op a[i]
+		 *  scan_offset: r[i] = c op r[i]
+		 *
+		 ********************************************/
+
+		template<class Op, typename T>
+		inline void scan_vec(const T *a, index_t as, T *r, index_t rs, index_t len)
+		{
+			T s = a[0];
+			r[0] = s;
+			for (index_t i = 1; i < len; ++i)
+				r[i * rs] = s = Op::eval(s, a[i * as]);
+		}
+
+		template<class Op, typename T>
+		inline void scan_cont(const T *a, T *r, index_t len, meta::bool_<false>)
+		{
+			scan_vec<Op>(a, 1, r, 1, len);
+		}
+
+		template<class Op, typename T>
+		inline void scan_cont(const T *a, T *r, index_t len, meta::bool_<true>)
+		{
+			typedef simd_pack<T, default_simd_kind> pack_t;
+			const unsigned int W = simd_traits<T, default_simd_kind>::pack_width;
+			const index_t w = (index_t)W;
+
+			if (len < w)
+			{
+				scan_vec<Op>(a, 1, r, 1, len);
+				return;
+			}
+
+			pack_t x = Op::prefix(pack_t(a));
+			x.store_u(r);
+			pack_t c = x.broadcast(pos_<W-1>());
+
+			index_t i = w;
+			for (; i + w <= len; i += w)
+			{
+				x = Op::eval(c, Op::prefix(pack_t(a + i)));
+				x.store_u(r + i);
+				c = x.broadcast(pos_<W-1>());
+			}
+
+			T s = c.to_scalar();
+			for (; i < len; ++i) r[i] = s = Op::eval(s, a[i]);
+		}
+
+		template<class Op, typename T>
+		inline void scan_offset(const T& c, T *r, index_t rs, index_t len)
+		{
+			for (index_t i = 0; i < len; ++i)
+				r[i * rs] = Op::eval(c, r[i * rs]);
+		}
+
+		template<class Op, typename T>
+		inline void scan_offset_cont(const T& c, T *r, index_t len, meta::bool_<false>)
+		{
+			scan_offset<Op>(c, r, 1, len);
+		}
+
+		template<class Op, typename T>
+		inline void scan_offset_cont(const T& c, T *r, index_t len, meta::bool_<true>)
+		{
+			typedef simd_pack<T, default_simd_kind> pack_t;
+			const index_t w = (index_t)simd_traits<T, default_simd_kind>::pack_width;
+
+			const pack_t cp(c);
+			index_t i = 0;
+			for (; i + w <= len; i += w)
+				Op::eval(cp, pack_t(r + i)).store_u(r + i);
+
+			for (; i < len; ++i) r[i] = Op::eval(c, r[i]);
+		}
+
+		// a long contiguous vector, in two passes over thread blocks
+
+		template<class Op, typename T>
+		inline void scan_long(const T *a, T *r, index_t len)
+		{
+			typedef meta::bool_<scan_use_simd<T>::value> use_simd;
+
+#ifdef _OPENMP
+			if (len >= scan_omp_threshold && omp_get_max_threads() > 1)
+			{
+				std::vector<T> tot((size_t)omp_get_max_threads());
+
+#pragma omp parallel
+				{
+					const index_t nt = (index_t)omp_get_num_threads();
+					const index_t t = (index_t)omp_get_thread_num();
+
+					index_t i0, ni;
+					static_column_slab(len, nt, t, i0, ni);
+
+					scan_cont<Op>(a + i0, r + i0, ni, use_simd());
+					tot[t] = r[i0 + ni - 1];
+
+#pragma omp barrier
+#pragma omp single
+					{
+						for (index_t k = 1; k < nt; ++k)
+							tot[k] = Op::eval(tot[k-1], tot[k]);
+					}
+
+					if (t > 0) scan_offset_cont<Op>(tot[t-1], r + i0, ni, use_simd());
+				}
+				return;
+			}
+#endif
+			scan_cont<Op>(a, r, len, use_simd());
+		}
+
+
+		/********************************************
+		 *
+		 *  multiple vectors
+		 *
+		 *  cnt vectors of length len: the e-th
+		 *  element of the s-th vector is at
+		 *  a[e * es + s * ss] (likewise for r).
+		 *
+		 ********************************************/
+
+		template<class Op, typename T>
+		inline void scan_along(const T *a, index_t aes, index_t ass,
+				T *r, index_t res, index_t rss, index_t len, index_t cnt)
+		{
+			typedef meta::bool_<scan_use_simd<T>::value> use_simd;
+
+			if (cnt == 1 && aes == 1 && res == 1)
+			{
+				scan_long<Op>(a, r, len);
+				return;
+			}
+
+#ifdef _OPENMP
+#pragma omp parallel for if (len * cnt >= scan_omp_threshold && cnt > 1)
+#endif
+			for (index_t s = 0; s < cnt; ++s)
+			{
+				if (aes == 1 && res == 1)
+					scan_cont<Op>(a + s * ass, r + s * rss, len, use_simd());
+				else
+					scan_vec<Op>(a + s * ass, aes, r + s * rss, res, len);
+			}
+		}
+
+		// vectors adjacent in memory (ss == 1): scan over the rows
+		// of the (cnt x len) block, a block of rows at a time
+
+		template<class Op, typename T>
+		inline void scan_across_block(const T *a, index_t aes, T *r, index_t res, index_t len, index_t cnt, meta::bool_<false>)
+		{
+			for (index_t s = 0; s < cnt; ++s) r[s] = a[s];
+
+			for (index_t e = 1; e < len; ++e)
+			{
+				const T *ae = a + e * aes;
+				const T *rp = r + (e - 1) * res;
+				T *re = r + e * res;
+				for (index_t s = 0; s < cnt; ++s) re[s] = Op::eval(rp[s], ae[s]);
+			}
+		}
+
+		template<class Op, typename T>
+		inline void scan_across_block(const T *a, index_t aes, T *r, index_t res, index_t len, index_t cnt, meta::bool_<true>)
+		{
+			typedef simd_pack<T, default_simd_kind> pack_t;
+			const index_t w = (index_t)simd_traits<T, default_simd_kind>::pack_width;
+
+			for (index_t s = 0; s < cnt; ++s) r[s] = a[s];
+
+			for (index_t e = 1; e < len; ++e)
+			{
+				const T *ae = a + e * aes;
+				const T *rp = r + (e - 1) * res;
+				T *re = r + e * res;
+
+				index_t s = 0;
+				for (; s + w <= cnt; s += w)
+					Op::eval(pack_t(rp + s), pack_t(ae + s)).store_u(re + s);
+
+				for (; s < cnt; ++s) re[s] = Op::eval(rp[s], ae[s]);
+			}
+		}
+
+		template<class Op, typename T>
+		inline void scan_across(const T *a, index_t aes, T *r, index_t res, index_t len, index_t cnt)
+		{
+			typedef meta::bool_<scan_use_simd<T>::value> use_simd;
+			const index_t nb = (cnt + scan_row_block - 1) / scan_row_block;
+
+#ifdef _OPENMP
+#pragma omp parallel for if (len * cnt >= scan_omp_threshold && nb > 1)
+#endif
+			for (index_t b = 0; b < nb; ++b)
+			{
+				const index_t s0 = b * scan_row_block;
+				const index_t bs = std::min(scan_row_block, cnt - s0);
+				scan_across_block<Op>(a + s0, aes, r + s0, res, len, bs, use_simd());
+			}
+		}
+
+		template<class Op, typename T>
+		inline void scan_multi(const T *a, index_t aes, index_t ass,
+				T *r, index_t res, index_t rss, index_t len, index_t cnt)
+		{
+			if (len == 0 || cnt == 0) return;
+
+			if (cnt > 1 && ass == 1 && rss == 1 && !(aes == 1 && res == 1))
+				scan_across<Op>(a, aes, r, res, len, cnt);
+			else
+				scan_along<Op>(a, aes, ass, r, res, rss, len, cnt);
+		}
+
+
+		/********************************************
+		 *
+		 *  drivers
+		 *
+		 ********************************************/
+
+		template<class Op, typename T, class A, class R>
+		inline void scan_all(const IRegularMatrix<A, T>& a, IRegularMatrix<R, T>& r)
+		{
+			LMAT_CHECK_DIMS( have_same_shape(a, r) )
+
+			const A& a_ = a.derived();
+			R& r_ = r.derived();
+
+			const index_t m = a_.nrows();
+			const index_t n = a_.ncolumns();
+			if (m == 0 || n == 0) return;
+
+			const bool a_cont = a_.row_stride() == 1 && (n == 1 || a_.col_stride() == m);
+			const bool r_cont = r_.row_stride() == 1 && (n == 1 || r_.col_stride() == m);
+
+			if (a_cont && r_cont)
+			{
+				scan_long<Op>(a_.ptr_data(), r_.ptr_data(), m * n);
+			}
+			else if (n == 1)
+			{
+				scan_vec<Op>(a_.ptr_data(), a_.row_stride(), r_.ptr_data(), r_.row_stride(), m);
+			}
+			else if (m == 1)
+			{
+				scan_vec<Op>(a_.ptr_data(), a_.col_stride(), r_.ptr_data(), r_.col_stride(), n);
+			}
+			else
+			{
+				// scan the columns, then carry over from one to the next
+
+				const index_t rrs = r_.row_stride();
+				const index_t rcs = r_.col_stride();
+
+				scan_multi<Op>(a_.ptr_data(), a_.row_stride(), a_.col_stride(),
+						r_.ptr_data(), rrs, rcs, m, n);
+
+				for (index_t j = 1; j < n; ++j)
+				{
+					T *rj = r_.ptr_data() + j * rcs;
+					const T c = rj[(m - 1) * rrs - rcs];
+					if (rrs == 1)
+						scan_offset_cont<Op>(c, rj, m, meta::bool_<scan_use_simd<T>::value>());
+					else
+						scan_offset<Op>(c, rj, rrs, m);
+				}
+			}
+		}
+
+		template<class Op, typename T, class A, class R>
+		inline void scan_colwise(const IRegularMatrix<A, T>& a, IRegularMatrix<R, T>& r)
+		{
+			LMAT_CHECK_DIMS( have_same_shape(a, r) )
+
+			const A& a_ = a.derived();
+			R& r_ = r.derived();
+
+			scan_multi<Op>(a_.ptr_data(), a_.row_stride(), a_.col_stride(),
+					r_.ptr_data(), r_.row_stride(), r_.col_stride(), a_.nrows(), a_.ncolumns());
+		}
+
+		template<class Op, typename T, class A, class R>
+		inline void scan_rowwise(const IRegularMatrix<A, T>& a, IRegularMatrix<R, T>& r)
+		{
+			LMAT_CHECK_DIMS( have_same_shape(a, r) )
+
+			const A& a_ = a.derived();
+			R& r_ = r.derived();
+
+			scan_multi<Op>(a_.ptr_data(), a_.col_stride(), a_.row_stride(),
+					r_.ptr_data(), r_.col_stride(), r_.row_stride(), a_.ncolumns(), a_.nrows());
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  cumulative sums, products, maxima & minima
+	 *
+	 *  r has the same shape as a, and
+	 *
+	 *  cumsum:          over all elements
+	 *  colwise_cumsum:  down each column
+	 *  rowwise_cumsum:  along each row
+	 *
+	 *  (likewise for cumprod, cummax & cummin)
+	 *
+	 ********************************************/
+
+#define LMAT_DEFINE_MATRIX_SCAN( Name, Op ) \
+	template<typename T, class A, class R> \
+	inline void Name(const IRegularMatrix<A, T>& a, IRegularMatrix<R, T>& r) \
+	{ internal::scan_all<internal::Op>(a, r); } \
+	template<typename T, class A, class R> \
+	inline void colwise_##Name(const IRegularMatrix<A, T>& a, IRegularMatrix<R, T>& r) \
+	{ internal::scan_colwise<internal::Op>(a, r); } \
+	template<typename T, class A, class R> \
+	inline void rowwise_##Name(const IRegularMatrix<A, T>& a, IRegularMatrix<R, T>& r) \
+	{ internal::scan_rowwise<internal::Op>(a, r); }
+
+	LMAT_DEFINE_MATRIX_SCAN( cumsum, scan_sum )
+	LMAT_DEFINE_MATRIX_SCAN( cumprod, scan_prod )
+	LMAT_DEFINE_MATRIX_SCAN( cummax, scan_max )
+	LMAT_DEFINE_MATRIX_SCAN( cummin, scan_min )
+
+}
+
+#endif
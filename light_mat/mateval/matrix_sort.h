@@ -16,6 +16,7 @@
 #include <light_mat/matrix/matrix_classes.h>
 #include <light_mat/matexpr/subs_expr.h>
 #include <light_mat/matexpr/mat_zip.h>
+#include <light_mat/dispatch/dispatch_route.h>
 
 #include <functional>
 #include <algorithm>
@@ -185,6 +186,8 @@ namespace lmat
 	template<class A, typename T>
 	inline void sort(IRegularMatrix<A, T>& a)
 	{
+		LMAT_DISPATCH_ROUTE( sort, a.derived() )
+
 		gsort(a, default_sort_alg(), asc_());
 	}
 
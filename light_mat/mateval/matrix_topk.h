@@ -0,0 +1,554 @@
+/**
+ * @file matrix_topk.h
+ *
+ * Selection of the k largest (or smallest) elements, with indices
+ *
+ * Each vector is scanned once, against the k-th best value seen
+ * so far (the threshold). Whole packs are first compared with the
+ * threshold, and only those with a better element are examined
+ * further, so after the first few elements most of the work is a
+ * SIMD comparison. The current k best are kept in a small heap.
+ *
+ * The results are in order (best first). Ties are resolved in
+ * favor of the smaller index, and NaNs are never selected unless
+ * they are among the first k elements.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_MATRIX_TOPK_H_
+#define LIGHTMAT_MATRIX_TOPK_H_
+
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/mateval/matrix_sort.h>
+#include <light_mat/mateval/macc_policy.h>
+#include <light_mat/simd/simd.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace lmat
+{
+	namespace internal
+	{
+		/********************************************
+		 *
+		 *  order & heap
+		 *
+		 ********************************************/
+
+		template<class Ord> struct topk_ord;
+
+		template<>
+		struct topk_ord<desc_>
+		{
+			template<typename X>
+			LMAT_ENSURE_INLINE
+			static auto better(const X& x, const X& y) -> decltype(x > y)
+			{
+				return x > y;
+			}
+		};
+
+		template<>
+		struct topk_ord<asc_>
+		{
+			template<typename X>
+			LMAT_ENSURE_INLINE
+			static auto better(const X& x, const X& y) -> decltype(x < y)
+			{
+				return x < y;
+			}
+		};
+
+		template<typename T>
+		struct topk_entry
+		{
+			T v;
+			index_t i;
+		};
+
+		template<typename T, class Ord>
+		struct topk_before  // whether a precedes b in the results
+		{
+			LMAT_ENSURE_INLINE
+			bool operator() (const topk_entry<T>& a, const topk_entry<T>& b) const
+			{
+				return topk_ord<Ord>::better(a.v, b.v) || (a.v == b.v && a.i < b.i);
+			}
+		};
+
+		// the k best entries, with the worst of them at the front
+		// (candidates must be added in ascending order of index)
+
+		template<typename T, class Ord>
+		class topk_heap
+		{
+		public:
+			LMAT_ENSURE_INLINE
+			topk_heap(topk_entry<T> *buf, index_t k)
+			: m_h(buf), m_k(k), m_size(0) { }
+
+			LMAT_ENSURE_INLINE bool full() const
+			{
+				return m_size == m_k;
+			}
+
+			LMAT_ENSURE_INLINE T threshold() const  // requires full()
+			{
+				return m_h[0].v;
+			}
+
+			inline void add(const T& v, index_t i)
+			{
+				topk_entry<T> e = {v, i};
+
+				if (m_size < m_k)
+				{
+					m_h[m_size++] = e;
+					if (m_size == m_k)
+						std::make_heap(m_h, m_h + m_k, topk_before<T, Ord>());
+				}
+				else if (topk_ord<Ord>::better(v, m_h[0].v))
+				{
+					std::pop_heap(m_h, m_h + m_k, topk_before<T, Ord>());
+					m_h[m_k - 1] = e;
+					std::push_heap(m_h, m_h + m_k, topk_before<T, Ord>());
+				}
+			}
+
+			inline void finish()  // sort best first
+			{
+				std::sort_heap(m_h, m_h + m_k, topk_before<T, Ord>());
+			}
+
+			LMAT_ENSURE_INLINE const topk_entry<T>& operator[] (index_t q) const
+			{
+				return m_h[q];
+			}
+
+		private:
+			topk_entry<T> *m_h;
+			index_t m_k;
+			index_t m_size;
+		};
+
+
+		/********************************************
+		 *
+		 *  scanning a vector
+		 *
+		 ********************************************/
+
+		template<typename T>
+		struct topk_use_simd
+		{
+			static const bool value = supports_simd<T, default_simd_kind>::value;
+		};
+
+		template<typename T, class Ord>
+		inline void topk_scan(topk_heap<T, Ord>& h, const T *p, index_t len, index_t step, index_t base)
+		{
+			index_t i = 0;
+			for (; i < len && !h.full(); ++i) h.add(p[i * step], base + i);
+
+			if (i < len)
+			{
+				T t = h.threshold();
+				for (; i < len; ++i)
+				{
+					const T x = p[i * step];
+					if (topk_ord<Ord>::better(x, t))
+					{
+						h.add(x, base + i);
+						t = h.threshold();
+					}
+				}
+			}
+		}
+
+		template<typename T, class Ord>
+		inline void topk_scan_cont(topk_heap<T, Ord>& h, const T *p, index_t len, index_t base, meta::bool_<false>)
+		{
+			topk_scan(h, p, len, 1, base);
+		}
+
+		template<typename T, class Ord>
+		inline void topk_scan_cont(topk_heap<T, Ord>& h, const T *p, index_t len, index_t base, meta::bool_<true>)
+		{
+			typedef simd_pack<T, default_simd_kind> pack_t;
+			const index_t w = (index_t)simd_traits<T, default_simd_kind>::pack_width;
+
+			index_t i = 0;
+			for (; i < len && !h.full(); ++i) h.add(p[i], base + i);
+			if (i == len) return;
+
+			T t = h.threshold();
+
+			for (; i + w <= len; i += w)
+			{
+				if (any_true(topk_ord<Ord>::better(pack_t(p + i), pack_t(t))))
+				{
+					for (index_t l = 0; l < w; ++l)
+					{
+						if (topk_ord<Ord>::better(p[i + l], t))
+						{
+							h.add(p[i + l], base + i + l);
+							t = h.threshold();
+						}
+					}
+				}
+			}
+
+			for (; i < len; ++i)
+			{
+				if (topk_ord<Ord>::better(p[i], t))
+				{
+					h.add(p[i], base + i);
+					t = h.threshold();
+				}
+			}
+		}
+
+
+		/********************************************
+		 *
+		 *  multiple vectors
+		 *
+		 *  cnt vectors of length len, where the
+		 *  e-th element of the v-th vector is at
+		 *  p[e * es + v * vs].
+		 *
+		 *  If es == 1, the vectors are scanned one
+		 *  by one. Otherwise, if vs == 1, all the
+		 *  vectors are scanned together, element
+		 *  by element, and their thresholds are
+		 *  compared with SIMD.
+		 *
+		 *  The q-th result of the v-th vector is
+		 *  delivered as out(v, q, value, index).
+		 *
+		 ********************************************/
+
+		const index_t topk_omp_threshold = 32768;
+		const index_t topk_sweep_bsize = 256;
+
+		template<typename T, class Ord, class Out>
+		inline void topk_each(const T *p, index_t len, index_t cnt, index_t es, index_t vs,
+				index_t k, Ord, Out& out)
+		{
+#ifdef _OPENMP
+#pragma omp parallel if (len * cnt >= topk_omp_threshold)
+#endif
+			{
+				std::vector<topk_entry<T> > buf(k);
+
+#ifdef _OPENMP
+#pragma omp for
+#endif
+				for (index_t v = 0; v < cnt; ++v)
+				{
+					topk_heap<T, Ord> h(&buf[0], k);
+					if (es == 1)
+						topk_scan_cont(h, p + v * vs, len, 0, meta::bool_<topk_use_simd<T>::value>());
+					else
+						topk_scan(h, p + v * vs, len, es, 0);
+
+					h.finish();
+					for (index_t q = 0; q < k; ++q) out(v, q, h[q].v, h[q].i);
+				}
+			}
+		}
+
+		template<typename T, class Ord>
+		inline void topk_sweep_block(topk_heap<T, Ord> *hs, T *thr,
+				const T *p, index_t len, index_t cnt, index_t es, index_t k, meta::bool_<false>)
+		{
+			for (index_t e = k; e < len; ++e)
+			{
+				const T *pe = p + e * es;
+				for (index_t v = 0; v < cnt; ++v)
+				{
+					if (topk_ord<Ord>::better(pe[v], thr[v]))
+					{
+						hs[v].add(pe[v], e);
+						thr[v] = hs[v].threshold();
+					}
+				}
+			}
+		}
+
+		template<typename T, class Ord>
+		inline void topk_sweep_block(topk_heap<T, Ord> *hs, T *thr,
+				const T *p, index_t len, index_t cnt, index_t es, index_t k, meta::bool_<true>)
+		{
+			typedef simd_pack<T, default_simd_kind> pack_t;
+			const index_t w = (index_t)simd_traits<T, default_simd_kind>::pack_width;
+
+			for (index_t e = k; e < len; ++e)
+			{
+				const T *pe = p + e * es;
+
+				index_t v = 0;
+				for (; v + w <= cnt; v += w)
+				{
+					if (any_true(topk_ord<Ord>::better(pack_t(pe + v), pack_t(thr + v))))
+					{
+						for (index_t l = 0; l < w; ++l)
+						{
+							if (topk_ord<Ord>::better(pe[v + l], thr[v + l]))
+							{
+								hs[v + l].add(pe[v + l], e);
+								thr[v + l] = hs[v + l].threshold();
+							}
+						}
+					}
+				}
+
+				for (; v < cnt; ++v)
+				{
+					if (topk_ord<Ord>::better(pe[v], thr[v]))
+					{
+						hs[v].add(pe[v], e);
+						thr[v] = hs[v].threshold();
+					}
+				}
+			}
+		}
+
+		template<typename T, class Ord, class Out>
+		inline void topk_sweep(const T *p, index_t len, index_t cnt, index_t es,
+				index_t k, Ord, Out& out)
+		{
+			const index_t nblocks = (cnt + topk_sweep_bsize - 1) / topk_sweep_bsize;
+
+#ifdef _OPENMP
+#pragma omp parallel if (len * cnt >= topk_omp_threshold)
+#endif
+			{
+				std::vector<topk_entry<T> > buf(topk_sweep_bsize * k);
+				std::vector<topk_heap<T, Ord> > hs;
+				dense_col<T> thr(topk_sweep_bsize);
+
+#ifdef _OPENMP
+#pragma omp for
+#endif
+				for (index_t b = 0; b < nblocks; ++b)
+				{
+					const index_t v0 = b * topk_sweep_bsize;
+					const index_t bn = std::min(topk_sweep_bsize, cnt - v0);
+					const T *pb = p + v0;
+
+					hs.clear();
+					for (index_t v = 0; v < bn; ++v)
+						hs.push_back(topk_heap<T, Ord>(&buf[v * k], k));
+
+					for (index_t e = 0; e < k; ++e)
+						for (index_t v = 0; v < bn; ++v) hs[v].add(pb[e * es + v], e);
+
+					for (index_t v = 0; v < bn; ++v) thr[v] = hs[v].threshold();
+
+					topk_sweep_block(&hs[0], thr.ptr_data(), pb, len, bn, es, k,
+							meta::bool_<topk_use_simd<T>::value>());
+
+					for (index_t v = 0; v < bn; ++v)
+					{
+						hs[v].finish();
+						for (index_t q = 0; q < k; ++q) out(v0 + v, q, hs[v][q].v, hs[v][q].i);
+					}
+				}
+			}
+		}
+
+		template<typename T, class Ord, class Out>
+		inline void topk_multi(const T *p, index_t len, index_t cnt, index_t es, index_t vs,
+				index_t k, Ord ord, Out& out)
+		{
+			if (es != 1 && vs == 1)
+				topk_sweep(p, len, cnt, es, k, ord, out);
+			else
+				topk_each(p, len, cnt, es, vs, k, ord, out);
+		}
+
+
+		// output writers
+
+		template<class V, class I>
+		struct topk_col_writer  // the results of the v-th vector go to the v-th columns
+		{
+			V& vals;
+			I& idx;
+
+			template<typename T>
+			LMAT_ENSURE_INLINE
+			void operator() (index_t v, index_t q, const T& x, index_t i) const
+			{
+				vals(q, v) = x;
+				idx(q, v) = static_cast<typename matrix_traits<I>::value_type>(i);
+			}
+		};
+
+		template<class V, class I>
+		struct topk_row_writer  // the results of the v-th vector go to the v-th rows
+		{
+			V& vals;
+			I& idx;
+
+			template<typename T>
+			LMAT_ENSURE_INLINE
+			void operator() (index_t v, index_t q, const T& x, index_t i) const
+			{
+				vals(v, q) = x;
+				idx(v, q) = static_cast<typename matrix_traits<I>::value_type>(i);
+			}
+		};
+	}
+
+
+	/********************************************
+	 *
+	 *  top-k of all elements
+	 *
+	 *  vals and idx (of k elements each) receive
+	 *  the values and the (column-major) linear
+	 *  indices of the k best elements.
+	 *
+	 *  Ord: desc_ (largest, default) or asc_
+	 *
+	 ********************************************/
+
+	template<typename T, class A, class V, typename TI, class I, class Ord>
+	inline typename std::enable_if<
+		meta::supports_linear_index<V>::value &&
+		meta::supports_linear_index<I>::value,
+	void>::type
+	topk(const IRegularMatrix<A, T>& a, index_t k,
+			IRegularMatrix<V, T>& vals, IRegularMatrix<I, TI>& idx, Ord)
+	{
+		const index_t m = a.nrows();
+		const index_t n = a.ncolumns();
+
+		if (k < 0 || k > m * n)
+			throw invalid_argument("topk: the value of k is out of valid range.");
+
+		LMAT_CHECK_DIMS( vals.nelems() == k && idx.nelems() == k )
+		if (k == 0) return;
+
+		const A& a_ = a.derived();
+		V& vals_ = vals.derived();
+		I& idx_ = idx.derived();
+
+		std::vector<internal::topk_entry<T> > buf(k);
+		internal::topk_heap<T, Ord> h(&buf[0], k);
+
+		if (a_.row_stride() == 1 && (n == 1 || a_.col_stride() == m))
+		{
+			internal::topk_scan_cont(h, a_.ptr_data(), m * n, 0,
+					meta::bool_<internal::topk_use_simd<T>::value>());
+		}
+		else
+		{
+			for (index_t j = 0; j < n; ++j)
+			{
+				if (a_.row_stride() == 1)
+					internal::topk_scan_cont(h, a_.ptr_col(j), m, j * m,
+							meta::bool_<internal::topk_use_simd<T>::value>());
+				else
+					internal::topk_scan(h, a_.ptr_col(j), m, a_.row_stride(), j * m);
+			}
+		}
+
+		h.finish();
+		for (index_t q = 0; q < k; ++q)
+		{
+			vals_[q] = h[q].v;
+			idx_[q] = static_cast<TI>(h[q].i);
+		}
+	}
+
+	template<typename T, class A, class V, typename TI, class I>
+	inline void topk(const IRegularMatrix<A, T>& a, index_t k,
+			IRegularMatrix<V, T>& vals, IRegularMatrix<I, TI>& idx)
+	{
+		topk(a, k, vals, idx, desc_());
+	}
+
+
+	/********************************************
+	 *
+	 *  column-wise & row-wise top-k
+	 *
+	 *  colwise: vals and idx are k x n, and the
+	 *  j-th columns receive the k best elements
+	 *  of a's j-th column (with row indices).
+	 *
+	 *  rowwise: vals and idx are m x k, and the
+	 *  i-th rows receive the k best elements
+	 *  of a's i-th row (with column indices).
+	 *
+	 *  The columns (rows) are processed in
+	 *  parallel when OpenMP is enabled.
+	 *
+	 ********************************************/
+
+	template<typename T, class A, class V, typename TI, class I, class Ord>
+	inline void colwise_topk(const IRegularMatrix<A, T>& a, index_t k,
+			IRegularMatrix<V, T>& vals, IRegularMatrix<I, TI>& idx, Ord ord)
+	{
+		const index_t m = a.nrows();
+		const index_t n = a.ncolumns();
+
+		if (k < 0 || k > m)
+			throw invalid_argument("colwise_topk: the value of k is out of valid range.");
+
+		LMAT_CHECK_DIMS( vals.nrows() == k && vals.ncolumns() == n )
+		LMAT_CHECK_DIMS( idx.nrows() == k && idx.ncolumns() == n )
+		if (k == 0 || n == 0) return;
+
+		const A& a_ = a.derived();
+		internal::topk_col_writer<V, I> out = { vals.derived(), idx.derived() };
+
+		internal::topk_multi(a_.ptr_data(), m, n, a_.row_stride(), a_.col_stride(), k, ord, out);
+	}
+
+	template<typename T, class A, class V, typename TI, class I>
+	inline void colwise_topk(const IRegularMatrix<A, T>& a, index_t k,
+			IRegularMatrix<V, T>& vals, IRegularMatrix<I, TI>& idx)
+	{
+		colwise_topk(a, k, vals, idx, desc_());
+	}
+
+	template<typename T, class A, class V, typename TI, class I, class Ord>
+	inline void rowwise_topk(const IRegularMatrix<A, T>& a, index_t k,
+			IRegularMatrix<V, T>& vals, IRegularMatrix<I, TI>& idx, Ord ord)
+	{
+		const index_t m = a.nrows();
+		const index_t n = a.ncolumns();
+
+		if (k < 0 || k > n)
+			throw invalid_argument("rowwise_topk: the value of k is out of valid range.");
+
+		LMAT_CHECK_DIMS( vals.nrows() == m && vals.ncolumns() == k )
+		LMAT_CHECK_DIMS( idx.nrows() == m && idx.ncolumns() == k )
+		if (k == 0 || m == 0) return;
+
+		const A& a_ = a.derived();
+		internal::topk_row_writer<V, I> out = { vals.derived(), idx.derived() };
+
+		internal::topk_multi(a_.ptr_data(), n, m, a_.col_stride(), a_.row_stride(), k, ord, out);
+	}
+
+	template<typename T, class A, class V, typename TI, class I>
+	inline void rowwise_topk(const IRegularMatrix<A, T>& a, index_t k,
+			IRegularMatrix<V, T>& vals, IRegularMatrix<I, TI>& idx)
+	{
+		rowwise_topk(a, k, vals, idx, desc_());
+	}
+
+}
+
+#endif
@@ -324,17 +324,27 @@ namespace lmat
 		LMAT_ENSURE_INLINE
 		explicit multi_contcol_writer(Mat& mat)
 		: m_pbase(mat.ptr_data()), m_colstride(mat.col_stride())
+		, m_stream(use_stream_store(nbytes<T>(mat.nelems())))
 		{ }
 
+		LMAT_ENSURE_INLINE
+		multi_contcol_writer with_stream(bool stream) const
+		{
+			multi_contcol_writer r(*this);
+			r.m_stream = stream;
+			return r;
+		}
+
 		LMAT_ENSURE_INLINE
 		col_accessor_type col(index_t j) const
 		{
-			return col_accessor_type(m_pbase + m_colstride * j);
+			return col_accessor_type(m_pbase + m_colstride * j, m_stream);
 		}
 
 	private:
 		T *m_pbase;
 		index_t m_colstride;
+		bool m_stream;
 	};
 
 
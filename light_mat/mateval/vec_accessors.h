@@ -17,6 +17,7 @@
 #include <light_mat/matrix/matrix_concepts.h>
 
 #include <light_mat/math/math_base.h>
+#include <light_mat/common/memory_stream.h>
 
 namespace lmat
 {
@@ -148,6 +149,41 @@ namespace lmat
 	};
 
 
+	// strided packs are gathered (or deinterleaved for small steps),
+	// so a strided operand no longer forces a scalar kernel
+
+	template<typename T, typename Kind>
+	class stepvec_reader<T, simd_<Kind> > : public simd_vec_accessor_base
+	{
+	public:
+		typedef T scalar_type;
+		typedef Kind simd_kind;
+		typedef simd_pack<T, Kind> pack_type;
+
+		LMAT_ENSURE_INLINE
+		explicit stepvec_reader(const T* p, index_t step)
+		: m_pdata(p), m_step(step) { }
+
+		LMAT_ENSURE_INLINE
+		T scalar(index_t i) const
+		{
+			return m_pdata[i * m_step];
+		}
+
+		LMAT_ENSURE_INLINE
+		pack_type pack(index_t i) const
+		{
+			pack_type pk;
+			pk.load_strided(m_pdata + i * m_step, m_step);
+			return pk;
+		}
+
+	private:
+		const T* m_pdata;
+		index_t m_step;
+	};
+
+
 	// single_reader
 
 	template<typename T>
@@ -304,7 +340,13 @@ namespace lmat
 	{
 	public:
 		LMAT_ENSURE_INLINE
-		explicit contvec_writer(T* p) : m_pdata(p) { }
+		explicit contvec_writer(T* p, bool = false) : m_pdata(p) { }
+
+		LMAT_ENSURE_INLINE
+		contvec_writer with_stream(bool) const
+		{
+			return *this;
+		}
 
 		LMAT_ENSURE_INLINE
 		T& scalar(index_t ) const
@@ -333,8 +375,18 @@ namespace lmat
 		typedef Kind simd_kind;
 		typedef simd_pack<T, Kind> pack_type;
 
+		// streaming stores are only used when p is aligned to the pack size
+
 		LMAT_ENSURE_INLINE
-		explicit contvec_writer(T* p) : m_pdata(p) { }
+		explicit contvec_writer(T* p, bool stream = false)
+		: m_pdata(p)
+		, m_stream(stream && ((uintptr_t)p % sizeof(pack_type) == 0)) { }
+
+		LMAT_ENSURE_INLINE
+		contvec_writer with_stream(bool stream) const
+		{
+			return contvec_writer(m_pdata, stream);
+		}
 
 		LMAT_ENSURE_INLINE
 		T& scalar(index_t) const
@@ -358,7 +410,17 @@ namespace lmat
 		LMAT_ENSURE_INLINE
 		nil_t done_pack(index_t i) const
 		{
-			m_ptemp.store_u(m_pdata + i);
+			if (m_stream)
+				m_ptemp.store_s(m_pdata + i);
+			else
+				m_ptemp.store_u(m_pdata + i);
+			return nil_t();
+		}
+
+		LMAT_ENSURE_INLINE
+		nil_t finalize() const
+		{
+			if (m_stream) stream_fence();
 			return nil_t();
 		}
 
@@ -366,6 +428,7 @@ namespace lmat
 		mutable pack_type m_ptemp;
 		mutable T m_stemp;
 		T* m_pdata;
+		bool m_stream;
 	};
 
 	// stepvec_writer
@@ -418,7 +481,7 @@ namespace lmat
 			LMAT_ENSURE_INLINE
 			static type get(Mat& mat)
 			{
-				return type(mat.ptr_data());
+				return type(mat.ptr_data(), use_stream_store(nbytes<T>(mat.nelems())));
 			}
 		};
 
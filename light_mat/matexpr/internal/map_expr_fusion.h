@@ -0,0 +1,1292 @@
+/**
+ * @file map_expr_fusion.h
+ *
+ * @brief Internal implementation of fused map expressions
+ *
+ * A map expression tree is flattened (at compile time) into a
+ * list of nodes in post order, one for each occurrence of a leaf
+ * or a sub-expression. Each node records its own position and
+ * those of its children. The fused kernel evaluates the nodes
+ * from the leaves up to the root, once per element (or pack),
+ * and keeps the intermediate values in a local tuple.
+ *
+ * Which nodes take the value of an earlier one is described by a
+ * sharing, which maps each node to the node whose value it takes
+ * (itself, if it is computed or read on its own). The sharing is
+ * derived from the types of the nodes: each node takes the value
+ * of the first node of the same type, and the nodes that do are
+ * skipped altogether. Hence, in
+ *
+ *   exp(a) * exp(a) + exp(a)
+ *
+ * exp(a) is computed once.
+ *
+ * This holds if the leaves of the same type refer to the same
+ * operand (or, for scalars, have the same value), which is checked
+ * once, when the leaves are bound. If it does not, the tree is
+ * evaluated with the dynamic sharing instead, where each node takes
+ * the value of the first earlier node that has the same type and
+ * the same operands, as found at binding time (node by node), and
+ * is computed otherwise. Hence, in
+ *
+ *   exp(a) * exp(b) + exp(a)
+ *
+ * with a and b of the same type, exp(a) is still computed once.
+ * So, a tree has at most two kernels.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_MAP_EXPR_FUSION_H_
+#define LIGHTMAT_MAP_EXPR_FUSION_H_
+
+#include <light_mat/matexpr/internal/map_expr_internal.h>
+#include <tuple>
+
+namespace lmat
+{
+	template<typename... Args> class map_expr;
+}
+
+namespace lmat { namespace internal {
+
+	/********************************************
+	 *
+	 *  node lists
+	 *
+	 ********************************************/
+
+	template<int... I> struct fuse_ints { };
+
+	template<int K, class Is> struct fuse_ints_prepend;
+
+	template<int K, int... I>
+	struct fuse_ints_prepend<K, fuse_ints<I...> >
+	{
+		typedef fuse_ints<K, I...> type;
+	};
+
+	// a node: the sub-expression E at position K, with its children at Ch...
+
+	template<int K, typename E, int... Ch>
+	struct fuse_node
+	{
+		static const int index = K;
+		typedef E expr_type;
+		typedef fuse_ints<Ch...> children;
+	};
+
+	template<int K, typename E, class Is> struct fuse_make_node;
+
+	template<int K, typename E, int... Ch>
+	struct fuse_make_node<K, E, fuse_ints<Ch...> >
+	{
+		typedef fuse_node<K, E, Ch...> type;
+	};
+
+	template<typename... N>
+	struct fuse_list
+	{
+		static const int size = sizeof...(N);
+	};
+
+	template<class L, typename N> struct fuse_push;
+
+	template<typename... T, typename N>
+	struct fuse_push<fuse_list<T...>, N>
+	{
+		typedef fuse_list<T..., N> type;
+	};
+
+	// position of the first node of E in the list (-1 if absent)
+
+	template<class L, typename E> struct fuse_index_of;
+
+	template<typename E>
+	struct fuse_index_of<fuse_list<>, E>
+	{
+		static const int value = -1;
+	};
+
+	template<typename H, typename... R, typename E>
+	struct fuse_index_of<fuse_list<H, R...>, E>
+	{
+		static const int _r = fuse_index_of<fuse_list<R...>, E>::value;
+		static const int value = std::is_same<typename H::expr_type, E>::value ?
+				H::index : _r;
+	};
+
+	template<class L, int K> struct fuse_node_at;
+
+	template<typename H, typename... R>
+	struct fuse_node_at<fuse_list<H, R...>, 0>
+	{
+		typedef H type;
+	};
+
+	template<typename H, typename... R, int K>
+	struct fuse_node_at<fuse_list<H, R...>, K>
+	{
+		typedef typename fuse_node_at<fuse_list<R...>, K-1>::type type;
+	};
+
+
+	template<typename E>
+	struct fuse_is_map : public meta::false_ { };
+
+	template<typename FTag, typename... Args>
+	struct fuse_is_map<map_expr<FTag, Args...> > : public meta::true_ { };
+
+	// number of leaves that repeat the type of an earlier one
+
+	template<class Nodes, class L = Nodes> struct fuse_num_repeated;
+
+	template<class Nodes>
+	struct fuse_num_repeated<Nodes, fuse_list<> >
+	{
+		static const int value = 0;
+	};
+
+	template<class Nodes, typename H, typename... R>
+	struct fuse_num_repeated<Nodes, fuse_list<H, R...> >
+	{
+		static const bool _repeated = !fuse_is_map<typename H::expr_type>::value &&
+				fuse_index_of<Nodes, typename H::expr_type>::value < H::index;
+
+		static const int value = int(_repeated) +
+				fuse_num_repeated<Nodes, fuse_list<R...> >::value;
+	};
+
+
+	/********************************************
+	 *
+	 *  sharings
+	 *
+	 *  A sharing is a list of node positions
+	 *  (fuse_ints), one for each node: the node
+	 *  whose value it takes.
+	 *
+	 ********************************************/
+
+	template<class Is, int K> struct fuse_ints_at;
+
+	template<int I, int... R>
+	struct fuse_ints_at<fuse_ints<I, R...>, 0>
+	{
+		static const int value = I;
+	};
+
+	template<int I, int... R, int K>
+	struct fuse_ints_at<fuse_ints<I, R...>, K>
+	{
+		static const int value = fuse_ints_at<fuse_ints<R...>, K-1>::value;
+	};
+
+	template<class... S>
+	struct fuse_sharings
+	{
+		static const int size = sizeof...(S);
+	};
+
+	// each node takes the value of the first node of its type
+
+	template<class Nodes> struct fuse_common_sharing;
+
+	template<typename... N>
+	struct fuse_common_sharing<fuse_list<N...> >
+	{
+		typedef fuse_ints<fuse_index_of<fuse_list<N...>, typename N::expr_type>::value...> type;
+	};
+
+	// each node reads its own children, and takes the value of another
+	// node (or is skipped) as recorded in the fuse_table of the binding
+
+	template<class S> struct fuse_dynamic { };  // S: the identity
+
+	template<class Nodes> struct fuse_dynamic_sharing;
+
+	template<typename... N>
+	struct fuse_dynamic_sharing<fuse_list<N...> >
+	{
+		typedef fuse_dynamic<fuse_ints<N::index...> > type;
+	};
+
+	// the sharings a kernel is instantiated for: the common one,
+	// and the dynamic one if a leaf repeats (as it may differ at run time)
+
+	template<class Nodes, bool Repeated = (fuse_num_repeated<Nodes>::value > 0)>
+	struct fuse_sharings_of
+	{
+		typedef fuse_sharings<
+				typename fuse_common_sharing<Nodes>::type,
+				typename fuse_dynamic_sharing<Nodes>::type> type;
+	};
+
+	template<class Nodes>
+	struct fuse_sharings_of<Nodes, false>
+	{
+		typedef fuse_sharings<typename fuse_common_sharing<Nodes>::type> type;
+	};
+
+	// whether the node at K is computed (or read) under S: it takes
+	// no other value, and is the root or the child of a computed node
+
+	template<class S, class Ch, int K> struct fuse_reads;
+
+	template<class S, int K>
+	struct fuse_reads<S, fuse_ints<>, K>
+	{
+		static const bool value = false;
+	};
+
+	template<class S, int C, int... R, int K>
+	struct fuse_reads<S, fuse_ints<C, R...>, K>
+	{
+		static const bool value =
+				fuse_ints_at<S, C>::value == K || fuse_reads<S, fuse_ints<R...>, K>::value;
+	};
+
+	template<class Nodes, class S, int K> struct fuse_computes;
+
+	template<class Nodes, class S, int K, int J = K + 1, int N = Nodes::size>
+	struct fuse_needed
+	{
+		typedef typename fuse_node_at<Nodes, J>::type::children _children;
+
+		static const bool value =
+				(fuse_computes<Nodes, S, J>::value && fuse_reads<S, _children, K>::value) ||
+				fuse_needed<Nodes, S, K, J+1, N>::value;
+	};
+
+	template<class Nodes, class S, int K, int N>
+	struct fuse_needed<Nodes, S, K, N, N>
+	{
+		static const bool value = false;
+	};
+
+	template<class Nodes, class S, int K>
+	struct fuse_computes
+	{
+		static const bool value = fuse_ints_at<S, K>::value == K &&
+				(K == Nodes::size - 1 || fuse_needed<Nodes, S, K>::value);
+	};
+
+	template<class Nodes, class S, int K = 0, int N = Nodes::size>
+	struct fuse_num_computed
+	{
+		static const int value = int(fuse_computes<Nodes, S, K>::value) +
+				fuse_num_computed<Nodes, S, K+1, N>::value;
+	};
+
+	template<class Nodes, class S, int N>
+	struct fuse_num_computed<Nodes, S, N, N>
+	{
+		static const int value = 0;
+	};
+
+
+	/********************************************
+	 *
+	 *  leaves
+	 *
+	 *  A map expression only refers to its
+	 *  operands, many of which are temporaries.
+	 *  A fused expression keeps copies of the
+	 *  scalars, views and other expressions at
+	 *  its leaves, and refers to the owning
+	 *  matrices (dense_matrix, etc) only.
+	 *
+	 ********************************************/
+
+	template<class E>
+	struct fuse_owning : public meta::false_ { };
+
+	template<typename T, index_t CM, index_t CN, class Allocator>
+	struct fuse_owning<dense_matrix<T, CM, CN, Allocator> > : public meta::true_ { };
+
+	template<typename T, index_t CM>
+	struct fuse_owning<dense_col<T, CM> > : public meta::true_ { };
+
+	template<typename T, index_t CN>
+	struct fuse_owning<dense_row<T, CN> > : public meta::true_ { };
+
+	template<typename E, bool Owning=fuse_owning<E>::value>
+	class fuse_leaf
+	{
+	public:
+		LMAT_ENSURE_INLINE
+		explicit fuse_leaf(const void *p) : m_val(*static_cast<const E*>(p)) { }
+
+		LMAT_ENSURE_INLINE const E& get() const
+		{
+			return m_val;
+		}
+
+	private:
+		E m_val;
+	};
+
+	template<typename E>
+	class fuse_leaf<E, true>
+	{
+	public:
+		LMAT_ENSURE_INLINE
+		explicit fuse_leaf(const void *p) : m_ptr(static_cast<const E*>(p)) { }
+
+		LMAT_ENSURE_INLINE const E& get() const
+		{
+			return *m_ptr;
+		}
+
+	private:
+		const E *m_ptr;
+	};
+
+	struct fused_map_slot  // map nodes keep no state
+	{
+		LMAT_ENSURE_INLINE fused_map_slot() { }
+		LMAT_ENSURE_INLINE explicit fused_map_slot(const void *) { }
+	};
+
+	// the addresses of the leaf operands in the original tree
+
+	template<int N>
+	struct fuse_addrs
+	{
+		const void *ptrs[N];
+
+		fuse_addrs()
+		{
+			for (int k = 0; k < N; ++k) ptrs[k] = 0;
+		}
+	};
+
+	// the sharing found at binding time: the node whose value each node
+	// takes, and whether its value is needed (the dynamic sharing reads it)
+
+	template<int N>
+	struct fuse_table
+	{
+		int src[N];
+		bool live[N];
+
+		int num_computed() const
+		{
+			int c = 0;
+			for (int k = 0; k < N; ++k)
+				if (live[k] && src[k] == k) ++c;
+			return c;
+		}
+	};
+
+
+	// the argument at I of a map expression (of up to three
+	// arguments, or of more, which are kept in a tuple)
+
+	template<int I, bool InTuple> struct fuse_arg
+	{
+		template<class M>
+		LMAT_ENSURE_INLINE
+		static auto get(const M& e) -> decltype(std::get<I>(e.args())) { return std::get<I>(e.args()); }
+	};
+
+	template<> struct fuse_arg<0, false>
+	{
+		template<class M>
+		LMAT_ENSURE_INLINE
+		static auto get(const M& e) -> decltype(e.arg1()) { return e.arg1(); }
+	};
+
+	template<> struct fuse_arg<1, false>
+	{
+		template<class M>
+		LMAT_ENSURE_INLINE
+		static auto get(const M& e) -> decltype(e.arg2()) { return e.arg2(); }
+	};
+
+	template<> struct fuse_arg<2, false>
+	{
+		template<class M>
+		LMAT_ENSURE_INLINE
+		static auto get(const M& e) -> decltype(e.arg3()) { return e.arg3(); }
+	};
+
+
+
+	/********************************************
+	 *
+	 *  flattening
+	 *
+	 ********************************************/
+
+	// leaves
+
+	template<class L, typename E>
+	struct fuse_collect
+	{
+		static const int index = L::size;
+		typedef typename fuse_push<L, fuse_node<index, E> >::type type;
+
+		template<int N>
+		LMAT_ENSURE_INLINE
+		static void bind(fuse_addrs<N>& a, const E& e)
+		{
+			a.ptrs[index] = &e;
+		}
+	};
+
+	template<class L, bool InTuple, int Pos, typename... Args> struct fuse_collect_args;
+
+	template<class L, bool InTuple, int Pos>
+	struct fuse_collect_args<L, InTuple, Pos>
+	{
+		typedef L type;
+		typedef fuse_ints<> indices;
+
+		template<int N, class M>
+		LMAT_ENSURE_INLINE
+		static void bind(fuse_addrs<N>& , const M& ) { }
+	};
+
+	template<class L, bool InTuple, int Pos, typename A, typename... R>
+	struct fuse_collect_args<L, InTuple, Pos, A, R...>
+	{
+		typedef fuse_collect<L, A> first_t;
+		typedef fuse_collect_args<typename first_t::type, InTuple, Pos+1, R...> rest_t;
+
+		typedef typename rest_t::type type;
+		typedef typename fuse_ints_prepend<first_t::index, typename rest_t::indices>::type indices;
+
+		template<int N, class M>
+		LMAT_ENSURE_INLINE
+		static void bind(fuse_addrs<N>& a, const M& e)
+		{
+			first_t::bind(a, fuse_arg<Pos, InTuple>::get(e));
+			rest_t::bind(a, e);
+		}
+	};
+
+	// maps (children first)
+
+	template<class L, typename FTag, typename... Args>
+	struct fuse_collect<L, map_expr<FTag, Args...> >
+	{
+		typedef map_expr<FTag, Args...> expr_t;
+		typedef fuse_collect_args<L, (sizeof...(Args) > 3), 0, Args...> args_t;
+		typedef typename args_t::type args_list;
+
+		static const int index = args_list::size;
+		typedef typename fuse_push<args_list,
+				typename fuse_make_node<index, expr_t, typename args_t::indices>::type>::type type;
+
+		template<int N>
+		LMAT_ENSURE_INLINE
+		static void bind(fuse_addrs<N>& a, const expr_t& e)
+		{
+			args_t::bind(a, e);
+		}
+	};
+
+
+	template<class Expr>
+	struct fuse_plan
+	{
+		typedef fuse_collect<fuse_list<>, Expr> collect_t;
+		typedef typename collect_t::type nodes;
+
+		static const int num_nodes = nodes::size;
+
+		typedef typename fuse_sharings_of<nodes>::type sharings;
+
+		LMAT_ENSURE_INLINE
+		static fuse_addrs<num_nodes> bind(const Expr& e)
+		{
+			fuse_addrs<num_nodes> a;
+			collect_t::bind(a, e);
+			return a;
+		}
+	};
+
+
+	/********************************************
+	 *
+	 *  nodes
+	 *
+	 ********************************************/
+
+	// leaves
+
+	template<class N> struct fused_node;
+
+	template<int K, typename E>
+	struct fused_node<fuse_node<K, E> >
+	{
+		typedef typename arg_value_type<E>::type value_type;
+		typedef fuse_leaf<E> slot_type;
+
+		template<typename Kind>
+		struct pack_of
+		{
+			typedef simd_pack<value_type, Kind> type;
+		};
+
+		template<typename U>
+		struct vec_reader
+		{
+			typedef arg_vec_reader_map<E, U> map_t;
+			typedef typename map_t::type type;
+
+			LMAT_ENSURE_INLINE
+			static type get(const slot_type& s)
+			{
+				return map_t::get(s.get());
+			}
+		};
+
+		template<typename U>
+		struct multicol_reader
+		{
+			typedef arg_multicol_reader_map<E, U> map_t;
+			typedef typename map_t::type type;
+
+			LMAT_ENSURE_INLINE
+			static type get(const slot_type& s)
+			{
+				return map_t::get(s.get());
+			}
+		};
+
+		// whether the leaf refers to the same operand as the leaf at J
+
+		template<int J, class B, int N>
+		LMAT_ENSURE_INLINE
+		static bool same_as(const B& b, const fuse_addrs<N>& a)
+		{
+			return same_operand<J>(b, a, meta::bool_<meta::is_mat_xpr<E>::value>());
+		}
+
+		template<class MRd>
+		LMAT_ENSURE_INLINE
+		static typename MRd::col_accessor_type col(const MRd& rd, index_t j)
+		{
+			return rd.col(j);
+		}
+
+		template<class S, class Rd, class Vals>
+		LMAT_ENSURE_INLINE
+		static value_type scalar(const Rd& rd, index_t i, const Vals& )
+		{
+			return rd.scalar(i);
+		}
+
+		template<typename Kind, class S, class Rd, class Vals>
+		LMAT_ENSURE_INLINE
+		static typename pack_of<Kind>::type pack(const Rd& rd, index_t i, const Vals& )
+		{
+			return rd.pack(i);
+		}
+
+	private:
+		template<int J, class B, int N>
+		LMAT_ENSURE_INLINE
+		static bool same_operand(const B& , const fuse_addrs<N>& a, meta::bool_<true>)
+		{
+			return a.ptrs[J] == a.ptrs[K];
+		}
+
+		template<int J, class B, int N>
+		LMAT_ENSURE_INLINE
+		static bool same_operand(const B& b, const fuse_addrs<N>& , meta::bool_<false>)
+		{
+			// scalars are compared by value
+			return std::get<J>(b.slots).get() == std::get<K>(b.slots).get();
+		}
+	};
+
+	// maps: the arguments are taken from the values of their children
+
+	template<int K, typename FTag, typename... Args, int... Ch>
+	struct fused_node<fuse_node<K, map_expr<FTag, Args...>, Ch...> >
+	{
+		typedef typename map_expr_fun<FTag, scalar_, Args...>::type fun_t;
+		typedef typename fun_t::result_type value_type;
+		typedef fused_map_slot slot_type;
+
+		template<typename Kind>
+		struct pack_of
+		{
+			typedef typename simdize_map<fun_t, Kind>::type::result_type type;
+		};
+
+		template<typename U>
+		struct vec_reader
+		{
+			typedef fused_map_slot type;
+
+			LMAT_ENSURE_INLINE
+			static type get(const slot_type& s) { return s; }
+		};
+
+		template<typename U>
+		struct multicol_reader
+		{
+			typedef fused_map_slot type;
+
+			LMAT_ENSURE_INLINE
+			static type get(const slot_type& s) { return s; }
+		};
+
+		LMAT_ENSURE_INLINE
+		static fused_map_slot col(fused_map_slot s, index_t )
+		{
+			return s;
+		}
+
+		// the value of a child is that of the node it takes it from under S
+
+		template<class S, class Vals>
+		LMAT_ENSURE_INLINE
+		static value_type scalar(fused_map_slot, index_t , const Vals& v)
+		{
+			return fun_t()(std::get<fuse_ints_at<S, Ch>::value>(v)...);
+		}
+
+		template<typename Kind, class S, class Vals>
+		LMAT_ENSURE_INLINE
+		static typename pack_of<Kind>::type pack(fused_map_slot, index_t , const Vals& v)
+		{
+			return simdize_map<fun_t, Kind>::get(fun_t())(std::get<fuse_ints_at<S, Ch>::value>(v)...);
+		}
+	};
+
+
+	/********************************************
+	 *
+	 *  binding of the leaves
+	 *
+	 ********************************************/
+
+	// whether each leaf that repeats the type of an earlier one
+	// refers to the same operand as the first leaf of its type
+
+	template<class Nodes, int K = 0, int N = Nodes::size>
+	struct fuse_leaves_agree
+	{
+		typedef typename fuse_node_at<Nodes, K>::type node_t;
+
+		static const int first = fuse_index_of<Nodes, typename node_t::expr_type>::value;
+		static const bool check = !fuse_is_map<typename node_t::expr_type>::value && first < K;
+
+		template<class B>
+		LMAT_ENSURE_INLINE
+		static bool test(const B& b, const fuse_addrs<N>& a)
+		{
+			return test_(b, a, meta::bool_<check>()) &&
+					fuse_leaves_agree<Nodes, K+1, N>::test(b, a);
+		}
+
+	private:
+		template<class B>
+		LMAT_ENSURE_INLINE
+		static bool test_(const B& , const fuse_addrs<N>& , meta::bool_<false>)
+		{
+			return true;
+		}
+
+		template<class B>
+		LMAT_ENSURE_INLINE
+		static bool test_(const B& b, const fuse_addrs<N>& a, meta::bool_<true>)
+		{
+			return fused_node<node_t>::template same_as<first>(b, a);
+		}
+	};
+
+	template<class Nodes, int N>
+	struct fuse_leaves_agree<Nodes, N, N>
+	{
+		template<class B>
+		LMAT_ENSURE_INLINE
+		static bool test(const B& , const fuse_addrs<N>& )
+		{
+			return true;
+		}
+	};
+
+
+	// whether the nodes at J and K (of the same type) take the same value:
+	// leaves that refer to the same operand, and maps of the same children
+
+	template<class CJ, class CK> struct fuse_same_children;
+
+	template<>
+	struct fuse_same_children<fuse_ints<>, fuse_ints<> >
+	{
+		LMAT_ENSURE_INLINE
+		static bool test(const int * ) { return true; }
+	};
+
+	template<int J, int... RJ, int K, int... RK>
+	struct fuse_same_children<fuse_ints<J, RJ...>, fuse_ints<K, RK...> >
+	{
+		LMAT_ENSURE_INLINE
+		static bool test(const int *src)
+		{
+			return src[J] == src[K] &&
+					fuse_same_children<fuse_ints<RJ...>, fuse_ints<RK...> >::test(src);
+		}
+	};
+
+	template<class Nodes, int K, int J = 0>
+	struct fuse_find_source
+	{
+		typedef typename fuse_node_at<Nodes, K>::type node_t;
+		typedef typename fuse_node_at<Nodes, J>::type cand_t;
+		typedef typename node_t::expr_type expr_t;
+
+		static const bool candidate = std::is_same<typename cand_t::expr_type, expr_t>::value;
+
+		template<class B>
+		LMAT_ENSURE_INLINE
+		static int get(const B& b, const fuse_addrs<Nodes::size>& a, const int *src)
+		{
+			return same_(b, a, src, meta::bool_<candidate>(), meta::bool_<fuse_is_map<expr_t>::value>()) ?
+					J : fuse_find_source<Nodes, K, J+1>::get(b, a, src);
+		}
+
+	private:
+		template<class B, bool IsMap>
+		LMAT_ENSURE_INLINE
+		static bool same_(const B& , const fuse_addrs<Nodes::size>& , const int *,
+				meta::bool_<false>, meta::bool_<IsMap>)
+		{
+			return false;
+		}
+
+		template<class B>
+		LMAT_ENSURE_INLINE
+		static bool same_(const B& b, const fuse_addrs<Nodes::size>& a, const int *,
+				meta::bool_<true>, meta::bool_<false>)
+		{
+			return fused_node<node_t>::template same_as<J>(b, a);
+		}
+
+		template<class B>
+		LMAT_ENSURE_INLINE
+		static bool same_(const B& , const fuse_addrs<Nodes::size>& , const int *src,
+				meta::bool_<true>, meta::bool_<true>)
+		{
+			return fuse_same_children<typename cand_t::children, typename node_t::children>::test(src);
+		}
+	};
+
+	template<class Nodes, int K>
+	struct fuse_find_source<Nodes, K, K>
+	{
+		template<class B>
+		LMAT_ENSURE_INLINE
+		static int get(const B& , const fuse_addrs<Nodes::size>& , const int * )
+		{
+			return K;
+		}
+	};
+
+	template<class Nodes, int K = 0, int N = Nodes::size>
+	struct fuse_find_sources
+	{
+		template<class B>
+		static void run(const B& b, const fuse_addrs<N>& a, fuse_table<N>& t)
+		{
+			t.src[K] = fuse_find_source<Nodes, K>::get(b, a, t.src);
+			fuse_find_sources<Nodes, K+1, N>::run(b, a, t);
+		}
+	};
+
+	template<class Nodes, int N>
+	struct fuse_find_sources<Nodes, N, N>
+	{
+		template<class B>
+		static void run(const B& , const fuse_addrs<N>& , fuse_table<N>& ) { }
+	};
+
+	// a node is live if it is the root, or the child of a live node
+	// that is computed (from the root down)
+
+	template<class Ch> struct fuse_mark_children;
+
+	template<>
+	struct fuse_mark_children<fuse_ints<> >
+	{
+		static void run(bool * ) { }
+	};
+
+	template<int C, int... R>
+	struct fuse_mark_children<fuse_ints<C, R...> >
+	{
+		static void run(bool *live)
+		{
+			live[C] = true;
+			fuse_mark_children<fuse_ints<R...> >::run(live);
+		}
+	};
+
+	template<class Nodes, int K = Nodes::size - 1>
+	struct fuse_mark_live
+	{
+		typedef typename fuse_node_at<Nodes, K>::type node_t;
+
+		static void run(fuse_table<Nodes::size>& t)
+		{
+			if (t.live[K] && t.src[K] == K)
+				fuse_mark_children<typename node_t::children>::run(t.live);
+			fuse_mark_live<Nodes, K-1>::run(t);
+		}
+	};
+
+	template<class Nodes>
+	struct fuse_mark_live<Nodes, -1>
+	{
+		static void run(fuse_table<Nodes::size>& ) { }
+	};
+
+
+	template<class Nodes> struct fuse_binding;
+
+	template<typename... N>
+	struct fuse_binding<fuse_list<N...> >
+	{
+		typedef fuse_list<N...> nodes;
+		typedef typename fuse_sharings_of<nodes>::type sharings;
+		typedef std::tuple<typename fused_node<N>::slot_type...> slots_type;
+
+		slots_type slots;
+		int sharing;  // the position of the sharing in sharings
+		fuse_table<nodes::size> table;
+
+		explicit fuse_binding(const fuse_addrs<nodes::size>& a)
+		: slots(typename fused_node<N>::slot_type(a.ptrs[N::index])...)
+		{
+			sharing = fuse_leaves_agree<nodes>::test(*this, a) ? 0 : sharings::size - 1;
+
+			fuse_find_sources<nodes>::run(*this, a, table);
+			for (int k = 0; k < nodes::size; ++k) table.live[k] = false;
+			table.live[nodes::size - 1] = true;
+			fuse_mark_live<nodes>::run(table);
+		}
+	};
+
+
+
+	/********************************************
+	 *
+	 *  node tuples
+	 *
+	 ********************************************/
+
+	template<class Nodes> struct fused_tuples;
+
+	template<typename... N>
+	struct fused_tuples<fuse_list<N...> >
+	{
+		typedef fuse_list<N...> nodes;
+
+		typedef std::tuple<typename fused_node<N>::value_type...> values;
+
+		template<typename Kind>
+		struct packs
+		{
+			typedef std::tuple<typename fused_node<N>::template pack_of<Kind>::type...> type;
+		};
+
+		template<typename U>
+		struct vec_readers
+		{
+			typedef std::tuple<typename fused_node<N>::template vec_reader<U>::type...> type;
+
+			LMAT_ENSURE_INLINE
+			static type get(const fuse_binding<nodes>& b)
+			{
+				return type(fused_node<N>::template vec_reader<U>::get(std::get<N::index>(b.slots))...);
+			}
+		};
+
+		template<typename U>
+		struct multicol_readers
+		{
+			typedef std::tuple<typename fused_node<N>::template multicol_reader<U>::type...> type;
+
+			typedef std::tuple<decltype(fused_node<N>::col(
+					std::declval<const typename fused_node<N>::template multicol_reader<U>::type&>(), 0))...>
+			col_type;
+
+			LMAT_ENSURE_INLINE
+			static type get(const fuse_binding<nodes>& b)
+			{
+				return type(fused_node<N>::template multicol_reader<U>::get(std::get<N::index>(b.slots))...);
+			}
+
+			LMAT_ENSURE_INLINE
+			static col_type col(const type& rds, index_t j)
+			{
+				return col_type(fused_node<N>::col(std::get<N::index>(rds), j)...);
+			}
+		};
+	};
+
+
+	/********************************************
+	 *
+	 *  evaluation (from leaves to root)
+	 *
+	 ********************************************/
+
+	// a node is computed if the sharing S needs it, and skipped otherwise
+
+	template<class Nodes, class S, int K, bool Computed = fuse_computes<Nodes, S, K>::value>
+	struct fused_step
+	{
+		typedef fused_node<typename fuse_node_at<Nodes, K>::type> node_t;
+
+		template<class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void scalar(const Rds& rds, const fuse_table<Nodes::size>& , index_t i, Vals& v)
+		{
+			std::get<K>(v) = node_t::template scalar<S>(std::get<K>(rds), i, v);
+		}
+
+		template<typename Kind, class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void pack(const Rds& rds, const fuse_table<Nodes::size>& , index_t i, Vals& v)
+		{
+			std::get<K>(v) = node_t::template pack<Kind, S>(std::get<K>(rds), i, v);
+		}
+	};
+
+	template<class Nodes, class S, int K>
+	struct fused_step<Nodes, S, K, false>
+	{
+		template<class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void scalar(const Rds& , const fuse_table<Nodes::size>& , index_t , Vals& ) { }
+
+		template<typename Kind, class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void pack(const Rds& , const fuse_table<Nodes::size>& , index_t , Vals& ) { }
+	};
+
+	// the value given to the nodes skipped under the dynamic sharing
+	// (so that each value is set on all paths, as the compiler sees them)
+
+	template<typename V>
+	struct fused_zero
+	{
+		LMAT_ENSURE_INLINE static V get() { return V(); }
+	};
+
+	template<typename T, typename Kind>
+	struct fused_zero<simd_pack<T, Kind> >
+	{
+		LMAT_ENSURE_INLINE static simd_pack<T, Kind> get() { return simd_pack<T, Kind>::zeros(); }
+	};
+
+	template<typename T, typename Kind>
+	struct fused_zero<simd_bpack<T, Kind> >
+	{
+		LMAT_ENSURE_INLINE static simd_bpack<T, Kind> get() { return simd_bpack<T, Kind>::all_false(); }
+	};
+
+	// copies the value of the node at j (an earlier one of the same type) to K
+
+	template<class Nodes, int K, int J = 0>
+	struct fused_copy
+	{
+		static const bool candidate = std::is_same<
+				typename fuse_node_at<Nodes, J>::type::expr_type,
+				typename fuse_node_at<Nodes, K>::type::expr_type>::value;
+
+		template<class Vals>
+		LMAT_ENSURE_INLINE
+		static void run(int j, Vals& v)
+		{
+			run_(j, v, meta::bool_<candidate>());
+		}
+
+	private:
+		template<class Vals>
+		LMAT_ENSURE_INLINE
+		static void run_(int j, Vals& v, meta::bool_<true>)
+		{
+			if (j == J)
+				std::get<K>(v) = std::get<J>(v);
+			else
+				fused_copy<Nodes, K, J+1>::run(j, v);
+		}
+
+		template<class Vals>
+		LMAT_ENSURE_INLINE
+		static void run_(int j, Vals& v, meta::bool_<false>)
+		{
+			fused_copy<Nodes, K, J+1>::run(j, v);
+		}
+	};
+
+	template<class Nodes, int K>
+	struct fused_copy<Nodes, K, K>  // not reached (j < K is of the same type)
+	{
+		template<class Vals>
+		LMAT_ENSURE_INLINE
+		static void run(int , Vals& v)
+		{
+			std::get<K>(v) = fused_zero<typename std::tuple_element<K, Vals>::type>::get();
+		}
+	};
+
+	// under the dynamic sharing, the table decides at run time
+
+	template<class Nodes, class S, int K>
+	struct fused_dynamic_step
+	{
+		typedef fused_node<typename fuse_node_at<Nodes, K>::type> node_t;
+
+		template<class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void scalar(const Rds& rds, const fuse_table<Nodes::size>& t, index_t i, Vals& v)
+		{
+			if (t.live[K])
+			{
+				if (t.src[K] == K)
+					std::get<K>(v) = node_t::template scalar<S>(std::get<K>(rds), i, v);
+				else
+					fused_copy<Nodes, K>::run(t.src[K], v);
+			}
+			else
+			{
+				std::get<K>(v) = fused_zero<typename std::tuple_element<K, Vals>::type>::get();
+			}
+		}
+
+		template<typename Kind, class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void pack(const Rds& rds, const fuse_table<Nodes::size>& t, index_t i, Vals& v)
+		{
+			if (t.live[K])
+			{
+				if (t.src[K] == K)
+					std::get<K>(v) = node_t::template pack<Kind, S>(std::get<K>(rds), i, v);
+				else
+					fused_copy<Nodes, K>::run(t.src[K], v);
+			}
+			else
+			{
+				std::get<K>(v) = fused_zero<typename std::tuple_element<K, Vals>::type>::get();
+			}
+		}
+	};
+
+	template<class Nodes, class S, int K>
+	struct fused_step_of
+	{
+		typedef fused_step<Nodes, S, K> type;
+	};
+
+	template<class Nodes, class S, int K>
+	struct fused_step_of<Nodes, fuse_dynamic<S>, K>
+	{
+		typedef fused_dynamic_step<Nodes, S, K> type;
+	};
+
+	template<class Nodes, class S, int K = 0, int N = Nodes::size>
+	struct fused_eval
+	{
+		typedef typename fused_step_of<Nodes, S, K>::type step_t;
+		typedef fused_eval<Nodes, S, K+1, N> next_t;
+
+		template<class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void scalar(const Rds& rds, const fuse_table<N>& t, index_t i, Vals& v)
+		{
+			step_t::scalar(rds, t, i, v);
+			next_t::scalar(rds, t, i, v);
+		}
+
+		template<typename Kind, class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void pack(const Rds& rds, const fuse_table<N>& t, index_t i, Vals& v)
+		{
+			step_t::template pack<Kind>(rds, t, i, v);
+			next_t::template pack<Kind>(rds, t, i, v);
+		}
+	};
+
+	template<class Nodes, class S, int N>
+	struct fused_eval<Nodes, S, N, N>
+	{
+		template<class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void scalar(const Rds& , const fuse_table<N>& , index_t , Vals& ) { }
+
+		template<typename Kind, class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void pack(const Rds& , const fuse_table<N>& , index_t , Vals& ) { }
+	};
+
+	// the kernel of the s-th of the sharings in L
+	// (a reader of a fused_expr chooses it per element, see map_expr.h)
+
+	template<class Nodes, class L> struct fused_eval_of;
+
+	template<class Nodes, class S>
+	struct fused_eval_of<Nodes, fuse_sharings<S> >
+	{
+		template<class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void scalar(int , const fuse_table<Nodes::size>& t, const Rds& rds, index_t i, Vals& v)
+		{
+			fused_eval<Nodes, S>::scalar(rds, t, i, v);
+		}
+
+		template<typename Kind, class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void pack(int , const fuse_table<Nodes::size>& t, const Rds& rds, index_t i, Vals& v)
+		{
+			fused_eval<Nodes, S>::template pack<Kind>(rds, t, i, v);
+		}
+	};
+
+	template<class Nodes, class S, class S2, class... R>
+	struct fused_eval_of<Nodes, fuse_sharings<S, S2, R...> >
+	{
+		typedef fused_eval_of<Nodes, fuse_sharings<S2, R...> > next_t;
+
+		template<class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void scalar(int s, const fuse_table<Nodes::size>& t, const Rds& rds, index_t i, Vals& v)
+		{
+			if (s == 0)
+				fused_eval<Nodes, S>::scalar(rds, t, i, v);
+			else
+				next_t::scalar(s - 1, t, rds, i, v);
+		}
+
+		template<typename Kind, class Rds, class Vals>
+		LMAT_ENSURE_INLINE
+		static void pack(int s, const fuse_table<Nodes::size>& t, const Rds& rds, index_t i, Vals& v)
+		{
+			if (s == 0)
+				fused_eval<Nodes, S>::template pack<Kind>(rds, t, i, v);
+			else
+				next_t::template pack<Kind>(s - 1, t, rds, i, v);
+		}
+	};
+
+} }
+
+
+namespace lmat
+{
+	/********************************************
+	 *
+	 *  Fused readers
+	 *
+	 ********************************************/
+
+	// L: the sharings, of which the s-th is used
+
+	template<class Nodes, class L, typename U, class Rds> class fused_vec_reader;
+
+	template<class Nodes, class L, class Rds>
+	class fused_vec_reader<Nodes, L, scalar_, Rds> : public scalar_vec_accessor_base
+	{
+		typedef typename internal::fused_tuples<Nodes>::values vals_t;
+		typedef typename std::tuple_element<Nodes::size - 1, vals_t>::type result_t;
+
+	public:
+		LMAT_ENSURE_INLINE
+		fused_vec_reader(const Rds& rds, int s, const internal::fuse_table<Nodes::size>& t)
+		: m_rds(rds), m_sharing(s), m_table(&t)
+		{ }
+
+		LMAT_ENSURE_INLINE
+		result_t scalar(index_t i) const
+		{
+			vals_t v;
+			internal::fused_eval_of<Nodes, L>::scalar(m_sharing, *m_table, m_rds, i, v);
+			return std::get<Nodes::size - 1>(v);
+		}
+
+	private:
+		Rds m_rds;
+		int m_sharing;
+		const internal::fuse_table<Nodes::size> *m_table;
+	};
+
+	template<class Nodes, class L, typename Kind, class Rds>
+	class fused_vec_reader<Nodes, L, simd_<Kind>, Rds> : public simd_vec_accessor_base
+	{
+		typedef typename internal::fused_tuples<Nodes>::values vals_t;
+		typedef typename internal::fused_tuples<Nodes>::template packs<Kind>::type pvals_t;
+
+		typedef typename std::tuple_element<Nodes::size - 1, vals_t>::type result_t;
+		typedef typename std::tuple_element<Nodes::size - 1, pvals_t>::type pack_t;
+
+	public:
+		LMAT_ENSURE_INLINE
+		fused_vec_reader(const Rds& rds, int s, const internal::fuse_table<Nodes::size>& t)
+		: m_rds(rds), m_sharing(s), m_table(&t)
+		{ }
+
+		LMAT_ENSURE_INLINE
+		result_t scalar(index_t i) const
+		{
+			vals_t v;
+			internal::fused_eval_of<Nodes, L>::scalar(m_sharing, *m_table, m_rds, i, v);
+			return std::get<Nodes::size - 1>(v);
+		}
+
+		LMAT_ENSURE_INLINE
+		pack_t pack(index_t i) const
+		{
+			pvals_t v;
+			internal::fused_eval_of<Nodes, L>::template pack<Kind>(m_sharing, *m_table, m_rds, i, v);
+			return std::get<Nodes::size - 1>(v);
+		}
+
+	private:
+		Rds m_rds;
+		int m_sharing;
+		const internal::fuse_table<Nodes::size> *m_table;
+	};
+
+
+	template<class Nodes, class L, typename U>
+	class fused_multicol_reader : public multicol_accessor_base
+	{
+		typedef typename internal::fused_tuples<Nodes>::template multicol_readers<U> rds_map;
+		typedef typename rds_map::type rds_t;
+
+	public:
+		typedef fused_vec_reader<Nodes, L, U, typename rds_map::col_type> col_accessor_type;
+
+		LMAT_ENSURE_INLINE
+		fused_multicol_reader(const rds_t& rds, int s, const internal::fuse_table<Nodes::size>& t)
+		: m_rds(rds), m_sharing(s), m_table(&t)
+		{ }
+
+		LMAT_ENSURE_INLINE
+		col_accessor_type col(index_t j) const
+		{
+			return col_accessor_type(rds_map::col(m_rds, j), m_sharing, *m_table);
+		}
+
+	private:
+		rds_t m_rds;
+		int m_sharing;
+		const internal::fuse_table<Nodes::size> *m_table;
+	};
+
+}
+
+#endif
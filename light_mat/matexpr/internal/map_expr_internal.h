@@ -221,6 +221,97 @@ namespace lmat { namespace internal {
 	};
 
 
+	// four or more arguments: the scalars among them
+	// have no part in the shape and the domain
+
+	template<typename Arg, bool IsXpr=meta::is_mat_xpr<Arg>::value>
+	struct map_arg_nrows : public meta::int_<0> { };
+
+	template<typename Arg>
+	struct map_arg_nrows<Arg, true> : public meta::nrows<Arg> { };
+
+	template<typename Arg, bool IsXpr=meta::is_mat_xpr<Arg>::value>
+	struct map_arg_ncols : public meta::int_<0> { };
+
+	template<typename Arg>
+	struct map_arg_ncols<Arg, true> : public meta::ncols<Arg> { };
+
+	template<typename D, typename Arg, bool IsXpr=meta::is_mat_xpr<Arg>::value>
+	struct map_domain_with
+	{
+		typedef D type;
+	};
+
+	template<typename D, typename Arg>
+	struct map_domain_with<D, Arg, true>
+	{
+		typedef typename meta::common_<D, typename meta::domain_of<Arg>::type>::type type;
+	};
+
+	template<typename Arg>
+	struct map_domain_with<void, Arg, true>
+	{
+		typedef typename meta::domain_of<Arg>::type type;
+	};
+
+	template<typename D, typename... Args>
+	struct map_args_domain
+	{
+		typedef D type;
+	};
+
+	template<typename D, typename Arg, typename... Rest>
+	struct map_args_domain<D, Arg, Rest...>
+	: public map_args_domain<typename map_domain_with<D, Arg>::type, Rest...> { };
+
+	template<typename Arg>
+	LMAT_ENSURE_INLINE
+	inline void map_arg_dims(index_t& , index_t& , const Arg& , meta::bool_<false>) { }
+
+	template<typename Arg>
+	LMAT_ENSURE_INLINE
+	inline void map_arg_dims(index_t& m, index_t& n, const Arg& arg, meta::bool_<true>)
+	{
+		if (m < 0)
+		{
+			m = arg.nrows();
+			n = arg.ncolumns();
+		}
+		else
+		{
+			LMAT_CHECK_DIMS( arg.nrows() == m && arg.ncolumns() == n )
+		}
+	}
+
+	LMAT_ENSURE_INLINE
+	inline void map_args_dims(index_t& , index_t& ) { }
+
+	template<typename Arg, typename... Rest>
+	LMAT_ENSURE_INLINE
+	inline void map_args_dims(index_t& m, index_t& n, const Arg& arg, const Rest&... rest)
+	{
+		map_arg_dims(m, n, arg, meta::bool_<meta::is_mat_xpr<Arg>::value>());
+		map_args_dims(m, n, rest...);
+	}
+
+	template<typename... Args>
+	struct map_expr_helperN
+	{
+		static const index_t ct_nrows = meta::common_dim<map_arg_nrows<Args>...>::value;
+		static const index_t ct_ncols = meta::common_dim<map_arg_ncols<Args>...>::value;
+		typedef matrix_shape<ct_nrows, ct_ncols> shape_type;
+		typedef typename map_args_domain<void, Args...>::type domain;
+
+		static shape_type get_shape(const Args&... args)
+		{
+			index_t m = -1, n = -1;
+			map_args_dims(m, n, args...);
+			return shape_type(m, n);
+		}
+	};
+
+
+
 	template<typename... Args> struct map_expr_helper;
 
 	template<typename Arg>
@@ -246,6 +337,12 @@ namespace lmat { namespace internal {
 				meta::is_mat_xpr<Arg3>::value> type;
 	};
 
+	template<typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename... Rest>
+	struct map_expr_helper<Arg1, Arg2, Arg3, Arg4, Rest...>
+	{
+		typedef map_expr_helperN<Arg1, Arg2, Arg3, Arg4, Rest...> type;
+	};
+
 
 	/********************************************
 	 *
@@ -279,6 +376,17 @@ namespace lmat { namespace internal {
 		typedef typename fun_map<FTag, arg1_vtype, arg2_vtype, arg3_vtype>::type type;
 	};
 
+	template<typename FTag, typename U, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename... Rest>
+	struct map_expr_fun<FTag, U, Arg1, Arg2, Arg3, Arg4, Rest...>
+	{
+		typedef typename fun_map<FTag,
+				typename arg_value_type<Arg1>::type,
+				typename arg_value_type<Arg2>::type,
+				typename arg_value_type<Arg3>::type,
+				typename arg_value_type<Arg4>::type,
+				typename arg_value_type<Rest>::type...>::type type;
+	};
+
 
 	/********************************************
 	 *
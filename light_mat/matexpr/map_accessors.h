@@ -15,6 +15,7 @@
 
 #include <light_mat/mateval/multicol_accessors.h>
 #include <light_mat/math/functor_base.h>
+#include <tuple>
 
 namespace lmat
 {
@@ -299,6 +300,153 @@ namespace lmat
 	};
 
 
+	/********************************************
+	 *
+	 *  Readers of four or more arguments
+	 *
+	 *  The argument readers are kept in a tuple,
+	 *  and expanded over their indices.
+	 *
+	 ********************************************/
+
+	namespace internal
+	{
+		template<int... I> struct map_ints { };
+
+		template<int N, int... I>
+		struct map_make_ints : public map_make_ints<N-1, N-1, I...> { };
+
+		template<int... I>
+		struct map_make_ints<0, I...>
+		{
+			typedef map_ints<I...> type;
+		};
+	}
+
+	template<typename Fun, typename Rd1, typename Rd2, typename Rd3, typename Rd4, typename... Rds>
+	class map_vec_reader<Fun, scalar_, Rd1, Rd2, Rd3, Rd4, Rds...> : public scalar_vec_accessor_base
+	{
+		typedef scalar_ atag;
+		typedef typename Fun::result_type result_t;
+
+		typedef std::tuple<Rd1, Rd2, Rd3, Rd4, Rds...> rds_t;
+		typedef typename internal::map_make_ints<4 + sizeof...(Rds)>::type indices_t;
+
+	public:
+		LMAT_ENSURE_INLINE
+		map_vec_reader(const Fun& fun, atag u,
+				const Rd1& rd1, const Rd2& rd2, const Rd3& rd3, const Rd4& rd4, const Rds&... rds)
+		: m_fun(fun), m_rds(rd1, rd2, rd3, rd4, rds...)
+		{ }
+
+		LMAT_ENSURE_INLINE
+		result_t scalar(index_t i) const
+		{
+			return get_scalar(i, indices_t());
+		}
+
+	private:
+		template<int... I>
+		LMAT_ENSURE_INLINE
+		result_t get_scalar(index_t i, internal::map_ints<I...>) const
+		{
+			return m_fun(std::get<I>(m_rds).scalar(i)...);
+		}
+
+		Fun m_fun;
+		rds_t m_rds;
+	};
+
+	template<typename Fun, typename Kind, typename Rd1, typename Rd2, typename Rd3, typename Rd4, typename... Rds>
+	class map_vec_reader<Fun, simd_<Kind>, Rd1, Rd2, Rd3, Rd4, Rds...> : public simd_vec_accessor_base
+	{
+		typedef simd_<Kind> atag;
+
+		typedef typename Fun::result_type result_t;
+		typedef typename simdize_map<Fun, Kind>::type simd_fun_t;
+		typedef typename simd_fun_t::result_type pack_t;
+
+		typedef std::tuple<Rd1, Rd2, Rd3, Rd4, Rds...> rds_t;
+		typedef typename internal::map_make_ints<4 + sizeof...(Rds)>::type indices_t;
+
+	public:
+		LMAT_ENSURE_INLINE
+		map_vec_reader(const Fun& fun, atag u,
+				const Rd1& rd1, const Rd2& rd2, const Rd3& rd3, const Rd4& rd4, const Rds&... rds)
+		: m_fun(fun)
+		, m_pkfun(simdize_map<Fun, Kind>::get(fun))
+		, m_rds(rd1, rd2, rd3, rd4, rds...)
+		{ }
+
+		LMAT_ENSURE_INLINE
+		result_t scalar(index_t i) const
+		{
+			return get_scalar(i, indices_t());
+		}
+
+		LMAT_ENSURE_INLINE
+		pack_t pack(index_t i) const
+		{
+			return get_pack(i, indices_t());
+		}
+
+	private:
+		template<int... I>
+		LMAT_ENSURE_INLINE
+		result_t get_scalar(index_t i, internal::map_ints<I...>) const
+		{
+			return m_fun(std::get<I>(m_rds).scalar(i)...);
+		}
+
+		template<int... I>
+		LMAT_ENSURE_INLINE
+		pack_t get_pack(index_t i, internal::map_ints<I...>) const
+		{
+			return m_pkfun(std::get<I>(m_rds).pack(i)...);
+		}
+
+		Fun m_fun;
+		simd_fun_t m_pkfun;
+		rds_t m_rds;
+	};
+
+	template<typename Fun, typename U, typename Rd1, typename Rd2, typename Rd3, typename Rd4, typename... Rds>
+	class map_multicol_reader<Fun, U, Rd1, Rd2, Rd3, Rd4, Rds...> : public multicol_accessor_base
+	{
+		typedef std::tuple<Rd1, Rd2, Rd3, Rd4, Rds...> rds_t;
+		typedef typename internal::map_make_ints<4 + sizeof...(Rds)>::type indices_t;
+
+	public:
+		typedef map_vec_reader<Fun, U,
+				typename Rd1::col_accessor_type,
+				typename Rd2::col_accessor_type,
+				typename Rd3::col_accessor_type,
+				typename Rd4::col_accessor_type,
+				typename Rds::col_accessor_type...> col_accessor_type;
+
+		LMAT_ENSURE_INLINE
+		map_multicol_reader(const Fun& fun, U,
+				const Rd1& rd1, const Rd2& rd2, const Rd3& rd3, const Rd4& rd4, const Rds&... rds)
+		:m_fun(fun), m_rds(rd1, rd2, rd3, rd4, rds...) { }
+
+		LMAT_ENSURE_INLINE
+		col_accessor_type col(index_t j) const
+		{
+			return get_col(j, indices_t());
+		}
+
+	private:
+		template<int... I>
+		LMAT_ENSURE_INLINE
+		col_accessor_type get_col(index_t j, internal::map_ints<I...>) const
+		{
+			return col_accessor_type(m_fun, U(), std::get<I>(m_rds).col(j)...);
+		}
+
+		Fun m_fun;
+		rds_t m_rds;
+	};
+
 
 }
 
@@ -17,6 +17,8 @@
 #include <light_mat/simd/simd.h>
 
 #include "internal/map_expr_internal.h"
+#include "internal/map_expr_fusion.h"
+#include <light_mat/dispatch/dispatch_route.h>
 
 namespace lmat
 {
@@ -24,6 +26,8 @@ namespace lmat
 	// forward declarations
 
 	template<typename... Args> class map_expr;
+	template<class Expr> class fused_expr;
+	template<class Expr, class S> class fused_sharing_expr;
 
 
 	/********************************************
@@ -216,6 +220,61 @@ namespace lmat
 	};
 
 
+	// four or more arguments (of functors that take as many),
+	// which are kept in a tuple
+
+	template<typename FTag, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename... Rest>
+	class map_expr<FTag, Arg1, Arg2, Arg3, Arg4, Rest...>
+	: public IEWiseMatrix<map_expr<FTag, Arg1, Arg2, Arg3, Arg4, Rest...>,
+	  typename internal::map_expr_value<FTag, Arg1, Arg2, Arg3, Arg4, Rest...>::type>
+	{
+		typedef typename internal::map_expr_helper<Arg1, Arg2, Arg3, Arg4, Rest...>::type helper_t;
+		typedef typename helper_t::shape_type shape_type;
+
+	public:
+		typedef std::tuple<const Arg1&, const Arg2&, const Arg3&, const Arg4&, const Rest&...> args_type;
+
+		LMAT_ENSURE_INLINE
+		map_expr(FTag, const Arg1& a1, const Arg2& a2, const Arg3& a3, const Arg4& a4, const Rest&... rest)
+		: m_shape(helper_t::get_shape(a1, a2, a3, a4, rest...))
+		, m_args(a1, a2, a3, a4, rest...) { }
+
+		LMAT_ENSURE_INLINE FTag tag() const
+		{
+			return FTag();
+		}
+
+		LMAT_ENSURE_INLINE const args_type& args() const
+		{
+			return m_args;
+		}
+
+		LMAT_ENSURE_INLINE index_t nrows() const
+		{
+			return m_shape.nrows();
+		}
+
+		LMAT_ENSURE_INLINE index_t ncolumns() const
+		{
+			return m_shape.ncolumns();
+		}
+
+		LMAT_ENSURE_INLINE index_t nelems() const
+		{
+			return m_shape.nelems();
+		}
+
+		LMAT_ENSURE_INLINE shape_type shape() const
+		{
+			return m_shape;
+		}
+
+	private:
+		shape_type m_shape;
+		args_type m_args;
+	};
+
+
 	/********************************************
 	 *
 	 *  Expression construction functions
@@ -313,6 +372,21 @@ namespace lmat
 	}
 
 
+	// four or more arguments, each a matrix expression or a scalar
+
+	template<typename FTag, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename... Rest>
+	LMAT_ENSURE_INLINE
+	inline map_expr<FTag, Arg1, Arg2, Arg3, Arg4, Rest...>
+	make_map_expr(const FTag& ftag, const Arg1& a1, const Arg2& a2, const Arg3& a3, const Arg4& a4, const Rest&... rest)
+	{
+		static_assert(meta::any_<meta::is_mat_xpr<Arg1>, meta::is_mat_xpr<Arg2>,
+				meta::is_mat_xpr<Arg3>, meta::is_mat_xpr<Arg4>, meta::is_mat_xpr<Rest>...>::value,
+				"At least one of the arguments must be a matrix expression.");
+
+		return map_expr<FTag, Arg1, Arg2, Arg3, Arg4, Rest...>(ftag, a1, a2, a3, a4, rest...);
+	}
+
+
 	/********************************************
 	 *
 	 *  Accessor classes
@@ -435,6 +509,291 @@ namespace lmat
 						internal::arg_multicol_reader_map<Arg3, U>::get(expr.arg3()) );
 			}
 		};
+
+
+		template<typename FTag, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename... Rest, typename U>
+		struct vec_reader_map<map_expr<FTag, Arg1, Arg2, Arg3, Arg4, Rest...>, U>
+		{
+			typedef map_expr<FTag, Arg1, Arg2, Arg3, Arg4, Rest...> expr_type;
+			typedef typename internal::map_expr_fun<FTag, U, Arg1, Arg2, Arg3, Arg4, Rest...>::type fun_type;
+
+			typedef map_vec_reader<fun_type, U,
+					typename internal::arg_vec_reader_map<Arg1, U>::type,
+					typename internal::arg_vec_reader_map<Arg2, U>::type,
+					typename internal::arg_vec_reader_map<Arg3, U>::type,
+					typename internal::arg_vec_reader_map<Arg4, U>::type,
+					typename internal::arg_vec_reader_map<Rest, U>::type...> type;
+
+			LMAT_ENSURE_INLINE
+			static type get(const expr_type& expr)
+			{
+				return get_(expr, typename map_make_ints<4 + sizeof...(Rest)>::type());
+			}
+
+		private:
+			template<int... I>
+			LMAT_ENSURE_INLINE
+			static type get_(const expr_type& expr, map_ints<I...>)
+			{
+				return type(fun_type(), U(),
+						internal::arg_vec_reader_map<
+							typename std::tuple_element<I, std::tuple<Arg1, Arg2, Arg3, Arg4, Rest...> >::type, U
+						>::get(std::get<I>(expr.args()))...);
+			}
+		};
+
+		template<typename FTag, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename... Rest, typename U>
+		struct multicol_reader_map<map_expr<FTag, Arg1, Arg2, Arg3, Arg4, Rest...>, U>
+		{
+			typedef map_expr<FTag, Arg1, Arg2, Arg3, Arg4, Rest...> expr_type;
+			typedef typename internal::map_expr_fun<FTag, U, Arg1, Arg2, Arg3, Arg4, Rest...>::type fun_type;
+
+			typedef map_multicol_reader<fun_type, U,
+					typename internal::arg_multicol_reader_map<Arg1, U>::type,
+					typename internal::arg_multicol_reader_map<Arg2, U>::type,
+					typename internal::arg_multicol_reader_map<Arg3, U>::type,
+					typename internal::arg_multicol_reader_map<Arg4, U>::type,
+					typename internal::arg_multicol_reader_map<Rest, U>::type...> type;
+
+			LMAT_ENSURE_INLINE
+			static type get(const expr_type& expr)
+			{
+				return get_(expr, typename map_make_ints<4 + sizeof...(Rest)>::type());
+			}
+
+		private:
+			template<int... I>
+			LMAT_ENSURE_INLINE
+			static type get_(const expr_type& expr, map_ints<I...>)
+			{
+				return type(fun_type(), U(),
+						internal::arg_multicol_reader_map<
+							typename std::tuple_element<I, std::tuple<Arg1, Arg2, Arg3, Arg4, Rest...> >::type, U
+						>::get(std::get<I>(expr.args()))...);
+			}
+		};
+	}
+
+
+	/********************************************
+	 *
+	 *  Fused expressions
+	 *
+	 *  fuse(expr) evaluates a tree of map
+	 *  expressions with a single kernel, where
+	 *  each sub-expression that repeats an
+	 *  earlier one is computed only once per
+	 *  element or pack, e.g. exp(a) in
+	 *
+	 *    exp(a) * exp(a) + exp(a)
+	 *
+	 *  The repeated sub-expressions are found
+	 *  at compile time, by their types. As two
+	 *  leaves of the same type may still refer
+	 *  to different operands (or scalars), these
+	 *  are compared once, when the expression is
+	 *  made, and if any differ, the tree is
+	 *  evaluated by a second kernel, which shares
+	 *  the nodes found equal pair by pair (see
+	 *  internal/map_expr_fusion.h).
+	 *
+	 *  A fused expression keeps copies of its
+	 *  scalars and views, so it may outlive the
+	 *  tree it is made from, though not the
+	 *  matrices the tree refers to.
+	 *
+	 *  Fusion is explicit: a map expression
+	 *  that is not fused is evaluated as usual.
+	 *
+	 ********************************************/
+
+	template<class Expr>
+	struct matrix_traits<fused_expr<Expr> > : public matrix_traits<Expr> { };
+
+	template<class Expr>
+	class fused_expr
+	: public IEWiseMatrix<fused_expr<Expr>, typename matrix_traits<Expr>::value_type>
+	{
+		typedef typename matrix_traits<Expr>::shape_type shape_type;
+		typedef internal::fuse_plan<Expr> plan_t;
+
+	public:
+		typedef typename plan_t::nodes nodes;
+		typedef typename plan_t::sharings sharings;
+
+		LMAT_ENSURE_INLINE
+		explicit fused_expr(const Expr& expr)
+		: m_shape(expr.shape())
+		, m_binding(plan_t::bind(expr))
+		{ }
+
+		LMAT_ENSURE_INLINE const internal::fuse_binding<nodes>& binding() const
+		{
+			return m_binding;
+		}
+
+		// the number of nodes computed (or read) per element
+		LMAT_ENSURE_INLINE int num_distinct_nodes() const
+		{
+			return m_binding.table.num_computed();
+		}
+
+		LMAT_ENSURE_INLINE index_t nrows() const
+		{
+			return m_shape.nrows();
+		}
+
+		LMAT_ENSURE_INLINE index_t ncolumns() const
+		{
+			return m_shape.ncolumns();
+		}
+
+		LMAT_ENSURE_INLINE index_t nelems() const
+		{
+			return m_shape.nelems();
+		}
+
+		LMAT_ENSURE_INLINE shape_type shape() const
+		{
+			return m_shape;
+		}
+
+	private:
+		shape_type m_shape;
+		internal::fuse_binding<nodes> m_binding;
+	};
+
+	template<typename T, class Expr>
+	LMAT_ENSURE_INLINE
+	inline fused_expr<Expr> fuse(const IEWiseMatrix<Expr, T>& expr)
+	{
+		return fused_expr<Expr>(expr.derived());
+	}
+
+
+	// a fused expression evaluated with the sharing S
+	// (only lives during the evaluation of the former)
+
+	template<class Expr, class S>
+	struct matrix_traits<fused_sharing_expr<Expr, S> > : public matrix_traits<Expr> { };
+
+	template<class Expr, class S>
+	class fused_sharing_expr
+	: public IEWiseMatrix<fused_sharing_expr<Expr, S>, typename matrix_traits<Expr>::value_type>
+	{
+		typedef typename matrix_traits<Expr>::shape_type shape_type;
+
+	public:
+		typedef typename fused_expr<Expr>::nodes nodes;
+
+		LMAT_ENSURE_INLINE
+		explicit fused_sharing_expr(const fused_expr<Expr>& fexpr)
+		: m_fexpr(fexpr)
+		{ }
+
+		LMAT_ENSURE_INLINE const internal::fuse_binding<nodes>& binding() const
+		{
+			return m_fexpr.binding();
+		}
+
+		LMAT_ENSURE_INLINE index_t nrows() const
+		{
+			return m_fexpr.nrows();
+		}
+
+		LMAT_ENSURE_INLINE index_t ncolumns() const
+		{
+			return m_fexpr.ncolumns();
+		}
+
+		LMAT_ENSURE_INLINE index_t nelems() const
+		{
+			return m_fexpr.nelems();
+		}
+
+		LMAT_ENSURE_INLINE shape_type shape() const
+		{
+			return m_fexpr.shape();
+		}
+
+	private:
+		const fused_expr<Expr>& m_fexpr;
+	};
+
+
+	namespace internal
+	{
+		template<class Expr, class L, typename U>
+		struct fused_vec_reader_map
+		{
+			typedef typename fuse_plan<Expr>::nodes nodes;
+			typedef typename fused_tuples<nodes>::template vec_readers<U> rds_map;
+			typedef fused_vec_reader<nodes, L, U, typename rds_map::type> type;
+		};
+
+		template<class Expr, class L, typename U>
+		struct fused_multicol_reader_map
+		{
+			typedef typename fuse_plan<Expr>::nodes nodes;
+			typedef typename fused_tuples<nodes>::template multicol_readers<U> rds_map;
+			typedef fused_multicol_reader<nodes, L, U> type;
+		};
+
+		template<class Expr, typename U>
+		struct vec_reader_map<fused_expr<Expr>, U>
+		{
+			typedef fused_expr<Expr> expr_type;
+			typedef fused_vec_reader_map<Expr, typename expr_type::sharings, U> maps_t;
+			typedef typename maps_t::type type;
+
+			LMAT_ENSURE_INLINE
+			static type get(const expr_type& expr)
+			{
+				return type(maps_t::rds_map::get(expr.binding()), expr.binding().sharing, expr.binding().table);
+			}
+		};
+
+		template<class Expr, typename U>
+		struct multicol_reader_map<fused_expr<Expr>, U>
+		{
+			typedef fused_expr<Expr> expr_type;
+			typedef fused_multicol_reader_map<Expr, typename expr_type::sharings, U> maps_t;
+			typedef typename maps_t::type type;
+
+			LMAT_ENSURE_INLINE
+			static type get(const expr_type& expr)
+			{
+				return type(maps_t::rds_map::get(expr.binding()), expr.binding().sharing, expr.binding().table);
+			}
+		};
+
+		template<class Expr, class S, typename U>
+		struct vec_reader_map<fused_sharing_expr<Expr, S>, U>
+		{
+			typedef fused_sharing_expr<Expr, S> expr_type;
+			typedef fused_vec_reader_map<Expr, fuse_sharings<S>, U> maps_t;
+			typedef typename maps_t::type type;
+
+			LMAT_ENSURE_INLINE
+			static type get(const expr_type& expr)
+			{
+				return type(maps_t::rds_map::get(expr.binding()), 0, expr.binding().table);
+			}
+		};
+
+		template<class Expr, class S, typename U>
+		struct multicol_reader_map<fused_sharing_expr<Expr, S>, U>
+		{
+			typedef fused_sharing_expr<Expr, S> expr_type;
+			typedef fused_multicol_reader_map<Expr, fuse_sharings<S>, U> maps_t;
+			typedef typename maps_t::type type;
+
+			LMAT_ENSURE_INLINE
+			static type get(const expr_type& expr)
+			{
+				return type(maps_t::rds_map::get(expr.binding()), 0, expr.binding().table);
+			}
+		};
 	}
 
 
@@ -459,15 +818,213 @@ namespace lmat
 
 		static const bool value =
 				is_simdizable<fun_t, Kind>::value &&
-				meta::all_<supports_simd<Args, Kind>...>::value;
+				meta::all_<supports_simd_read<Args, Kind>...>::value;
 	};
 
+	template<class Expr, typename Kind>
+	struct supports_simd<fused_expr<Expr>, Kind> : public supports_simd<Expr, Kind> { };
+
+	template<class Expr>
+	struct supports_linear_access<fused_expr<Expr> > : public supports_linear_access<Expr> { };
+
+	template<class Expr, class S, typename Kind>
+	struct supports_simd<fused_sharing_expr<Expr, S>, Kind> : public supports_simd<Expr, Kind> { };
+
+	template<class Expr, class S>
+	struct supports_linear_access<fused_sharing_expr<Expr, S> > : public supports_linear_access<Expr> { };
+
+	// transposes (over the trans_views of row-major leaves, see macc_policy.h),
+	// built in place, as they refer to the views of the holders of the arguments
+
+	template<typename FTag, typename... Args>
+	struct rowmajor_transposable<map_expr<FTag, Args...> >
+	: public meta::all_<rowmajor_transposable<Args>...> { };
+
+	template<typename FTag, typename Arg1>
+	class rowmajor_transpose<map_expr<FTag, Arg1> > : private noncopyable
+	{
+	public:
+		typedef map_expr<FTag,
+				typename rowmajor_transpose<Arg1>::type> type;
+
+		LMAT_ENSURE_INLINE
+		explicit rowmajor_transpose(const map_expr<FTag, Arg1>& e)
+		: m_a1(e.arg1())
+		, m_expr(FTag(), m_a1.get()) { }
+
+		LMAT_ENSURE_INLINE const type& get() const
+		{
+			return m_expr;
+		}
+
+	private:
+		rowmajor_transpose<Arg1> m_a1;
+		type m_expr;
+	};
+
+	template<typename FTag, typename Arg1, typename Arg2>
+	class rowmajor_transpose<map_expr<FTag, Arg1, Arg2> > : private noncopyable
+	{
+	public:
+		typedef map_expr<FTag,
+				typename rowmajor_transpose<Arg1>::type,
+				typename rowmajor_transpose<Arg2>::type> type;
+
+		LMAT_ENSURE_INLINE
+		explicit rowmajor_transpose(const map_expr<FTag, Arg1, Arg2>& e)
+		: m_a1(e.arg1()), m_a2(e.arg2())
+		, m_expr(FTag(), m_a1.get(), m_a2.get()) { }
+
+		LMAT_ENSURE_INLINE const type& get() const
+		{
+			return m_expr;
+		}
+
+	private:
+		rowmajor_transpose<Arg1> m_a1;
+		rowmajor_transpose<Arg2> m_a2;
+		type m_expr;
+	};
+
+	template<typename FTag, typename Arg1, typename Arg2, typename Arg3>
+	class rowmajor_transpose<map_expr<FTag, Arg1, Arg2, Arg3> > : private noncopyable
+	{
+	public:
+		typedef map_expr<FTag,
+				typename rowmajor_transpose<Arg1>::type,
+				typename rowmajor_transpose<Arg2>::type,
+				typename rowmajor_transpose<Arg3>::type> type;
+
+		LMAT_ENSURE_INLINE
+		explicit rowmajor_transpose(const map_expr<FTag, Arg1, Arg2, Arg3>& e)
+		: m_a1(e.arg1()), m_a2(e.arg2()), m_a3(e.arg3())
+		, m_expr(FTag(), m_a1.get(), m_a2.get(), m_a3.get()) { }
+
+		LMAT_ENSURE_INLINE const type& get() const
+		{
+			return m_expr;
+		}
+
+	private:
+		rowmajor_transpose<Arg1> m_a1;
+		rowmajor_transpose<Arg2> m_a2;
+		rowmajor_transpose<Arg3> m_a3;
+		type m_expr;
+	};
+
+	template<typename FTag, typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename... Rest>
+	class rowmajor_transpose<map_expr<FTag, Arg1, Arg2, Arg3, Arg4, Rest...> > : private noncopyable
+	{
+		typedef map_expr<FTag, Arg1, Arg2, Arg3, Arg4, Rest...> expr_t;
+		typedef typename internal::map_make_ints<4 + sizeof...(Rest)>::type indices_t;
+
+	public:
+		typedef map_expr<FTag,
+				typename rowmajor_transpose<Arg1>::type,
+				typename rowmajor_transpose<Arg2>::type,
+				typename rowmajor_transpose<Arg3>::type,
+				typename rowmajor_transpose<Arg4>::type,
+				typename rowmajor_transpose<Rest>::type...> type;
+
+		LMAT_ENSURE_INLINE
+		explicit rowmajor_transpose(const expr_t& e)
+		: m_as(e.args())
+		, m_expr(make_expr(m_as, indices_t())) { }
+
+		LMAT_ENSURE_INLINE const type& get() const
+		{
+			return m_expr;
+		}
+
+	private:
+		typedef std::tuple<
+				rowmajor_transpose<Arg1>,
+				rowmajor_transpose<Arg2>,
+				rowmajor_transpose<Arg3>,
+				rowmajor_transpose<Arg4>,
+				rowmajor_transpose<Rest>...> holders_t;
+
+		template<int... I>
+		LMAT_ENSURE_INLINE
+		static type make_expr(const holders_t& as, internal::map_ints<I...>)
+		{
+			return type(FTag(), std::get<I>(as).get()...);
+		}
+
+		holders_t m_as;
+		type m_expr;
+	};
+
+	namespace internal
+	{
+		template<class Expr, typename T, class DMat>
+		LMAT_ENSURE_INLINE
+		inline void map_expr_evaluate(const Expr& sexpr, IRegularMatrix<DMat, T>& dmat, meta::bool_<false>)
+		{
+			macc_evaluate(sexpr, dmat);
+		}
+
+		// all row-major: evaluates the transpose
+
+		template<class Expr, typename T, class DMat>
+		LMAT_ENSURE_INLINE
+		inline void map_expr_evaluate(const Expr& sexpr, IRegularMatrix<DMat, T>& dmat, meta::bool_<true>)
+		{
+			rowmajor_transpose<Expr> ts(sexpr);
+			typename rowmajor_dest_transpose<DMat>::type td = trans_view(dmat.derived());
+			macc_evaluate(ts.get(), td);
+		}
+
+		// evaluates with the kernel of the sharing the leaves were found to have
+		// (each kernel is a function of its own, not inlined into the dispatch)
+
+		template<class Expr, class L> struct fused_evaluate;
+
+		template<class Expr, class S>
+		struct fused_evaluate<Expr, fuse_sharings<S> >
+		{
+			template<typename T, class DMat>
+			static void run(const fused_expr<Expr>& fexpr, int , IRegularMatrix<DMat, T>& dmat)
+			{
+				macc_evaluate(fused_sharing_expr<Expr, S>(fexpr), dmat);
+			}
+		};
+
+		template<class Expr, class S, class S2>
+		struct fused_evaluate<Expr, fuse_sharings<S, S2> >
+		{
+			template<typename T, class DMat>
+			LMAT_ENSURE_INLINE
+			static void run(const fused_expr<Expr>& fexpr, int s, IRegularMatrix<DMat, T>& dmat)
+			{
+				if (s == 0)
+					fused_evaluate<Expr, fuse_sharings<S> >::run(fexpr, 0, dmat);
+				else
+					fused_evaluate<Expr, fuse_sharings<S2> >::run(fexpr, 0, dmat);
+			}
+		};
+	}
+
 	template<typename FTag, typename... Args, class DMat>
 	LMAT_ENSURE_INLINE
 	inline void evaluate(const map_expr<FTag, Args...>& sexpr,
 			IRegularMatrix<DMat, typename internal::map_expr_value<FTag, Args...>::type>& dmat)
 	{
-		macc_evaluate(sexpr, dmat);
+		// with LMAT_USE_RUNTIME_DISPATCH, only a + b, a - b, a * b and a / b on
+		// contiguous dynamic-size float/double matrices are routed (dispatch_route.h)
+		LMAT_DISPATCH_ROUTE( ewise, sexpr, dmat.derived() )
+
+		internal::map_expr_evaluate(sexpr, dmat,
+				meta::bool_<rowmajor_evaluable<map_expr<FTag, Args...>, DMat>::value>());
+	}
+
+	template<class Expr, class DMat>
+	LMAT_ENSURE_INLINE
+	inline void evaluate(const fused_expr<Expr>& sexpr,
+			IRegularMatrix<DMat, typename matrix_traits<Expr>::value_type>& dmat)
+	{
+		typedef typename fused_expr<Expr>::sharings sharings;
+		internal::fused_evaluate<Expr, sharings>::run(sexpr, sexpr.binding().sharing, dmat);
 	}
 
 
@@ -30,6 +30,8 @@ namespace lmat
 
 	_LMAT_DEFINE_RMATFUN( fma, 3 )
 
+	_LMAT_DEFINE_CMATFUN( conj, 1 )
+
 	// min & max
 
 	_LMAT_DEFINE_GMATFUN( max, 2 )
@@ -162,6 +162,10 @@
 	_LMAT_DEFINE_SMATFUN_##NA( FunName, FTag, float ) \
 	_LMAT_DEFINE_SMATFUN_##NA( FunName, FTag, double )
 
+#define LMAT_DEF_CMATFUN( FunName, FTag, NA ) \
+	_LMAT_DEFINE_SMATFUN_##NA( FunName, FTag, std::complex<float> ) \
+	_LMAT_DEFINE_SMATFUN_##NA( FunName, FTag, std::complex<double> )
+
 
 /************************************************
  *
@@ -186,5 +190,6 @@
 
 #define _LMAT_DEFINE_GMATFUN( Name, NA ) LMAT_DEF_GMATFUN( Name, ftags::Name##_, NA )
 #define _LMAT_DEFINE_RMATFUN( Name, NA ) LMAT_DEF_RMATFUN( Name, ftags::Name##_, NA )
+#define _LMAT_DEFINE_CMATFUN( Name, NA ) LMAT_DEF_CMATFUN( Name, ftags::Name##_, NA )
 
 #endif
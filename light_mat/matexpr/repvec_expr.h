@@ -195,7 +195,7 @@ namespace lmat
 
 	template<typename Arg, index_t CN, typename Kind>
 	struct supports_simd<repcol_expr<Arg, CN>, Kind>
-	: public supports_simd<Arg, Kind> { };
+	: public supports_simd_read<Arg, Kind> { };
 
 	template<typename Arg, index_t CM, typename Kind>
 	struct supports_simd<reprow_expr<Arg, CM>, Kind>
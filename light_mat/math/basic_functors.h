@@ -90,6 +90,16 @@ namespace lmat {
 	_LMAT_DEFINE_GENERIC_MATH_FUN_EX( div, 2, x1 / x2 )
 	_LMAT_DEFINE_GENERIC_MATH_FUN_EX( neg, 1, -x1 )
 
+	_LMAT_DEFINE_COMPLEX_SIMD_SUPPORT( ftags::add_, add_fun )
+	_LMAT_DEFINE_COMPLEX_SIMD_SUPPORT( ftags::sub_, sub_fun )
+	_LMAT_DEFINE_COMPLEX_SIMD_SUPPORT( ftags::mul_, mul_fun )
+	_LMAT_DEFINE_COMPLEX_SIMD_SUPPORT( ftags::div_, div_fun )
+	_LMAT_DEFINE_COMPLEX_SIMD_SUPPORT( ftags::neg_, neg_fun )
+
+	LMAT_DEF_GENERIC_MATH_FUNCTOR( ftags::conj_, 1, conj_fun, math::conj(x1) )
+	LMAT_DEF_COMPLEX_FUNMAP( ftags::conj_, 1, conj_fun )
+	_LMAT_DEFINE_COMPLEX_SIMD_SUPPORT( ftags::conj_, conj_fun )
+
 	_LMAT_DEFINE_REAL_MATH_FUN( fma, 3 )
 
 	_LMAT_DEFINE_GENERIC_MATH_FUN( max, 2 )
@@ -25,6 +25,7 @@ namespace lmat { namespace ftags {
 	struct mul_ { };
 	struct div_ { };
 	struct neg_ { };
+	struct conj_ { };
 
 	struct abs_ { };
 	struct fma_ { };
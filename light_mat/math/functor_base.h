@@ -99,6 +99,32 @@ namespace lmat {
 	LMAT_DECL_SIMDIZABLE_ON_REAL( FunT ) \
 	LMAT_DEF_TRIVIAL_SIMDIZE_MAP( FunT )
 
+// complex packs (interleaved std::complex<float/double>)
+
+#define LMAT_DECL_SIMDIZABLE_ON_COMPLEX(FunT) \
+		template<typename Kind> \
+		struct is_simdizable<FunT<std::complex<float> >, Kind> : public std::true_type { }; \
+		template<typename Kind> \
+		struct is_simdizable<FunT<std::complex<double> >, Kind> : public std::true_type { };
+
+#define LMAT_DEF_TRIVIAL_COMPLEX_SIMDIZE_MAP(FunT) \
+		template<typename Kind> \
+		struct simdize_map<FunT<std::complex<float> >, Kind> { \
+			typedef FunT<simd_pack<std::complex<float>, Kind> > type; \
+			LMAT_ENSURE_INLINE \
+			static type get(FunT<std::complex<float> > ) { return type(); } \
+		}; \
+		template<typename Kind> \
+		struct simdize_map<FunT<std::complex<double> >, Kind> { \
+			typedef FunT<simd_pack<std::complex<double>, Kind> > type; \
+			LMAT_ENSURE_INLINE \
+			static type get(FunT<std::complex<double> > ) { return type(); } \
+		};
+
+#define LMAT_DEF_COMPLEX_SIMD_SUPPORT( FunT ) \
+	LMAT_DECL_SIMDIZABLE_ON_COMPLEX( FunT ) \
+	LMAT_DEF_TRIVIAL_COMPLEX_SIMDIZE_MAP( FunT )
+
 
 /************************************************
  *
@@ -121,6 +147,14 @@ namespace lmat {
 	struct fun_map<FTag, LMAT_REPEAT_ARGS_##NA(double)> { \
 		typedef Functor<double> type; };
 
+#define LMAT_DEF_COMPLEX_FUNMAP( FTag, NA, Functor ) \
+	template<> \
+	struct fun_map<FTag, LMAT_REPEAT_ARGS_##NA(std::complex<float>)> { \
+		typedef Functor<std::complex<float> > type; }; \
+	template<> \
+	struct fun_map<FTag, LMAT_REPEAT_ARGS_##NA(std::complex<double>)> { \
+		typedef Functor<std::complex<double> > type; };
+
 // Useful macros to define functors
 
 #define LMAT_DEF_GENERIC_MATH_FUNCTOR( FTag, NA, Functor, Expr ) \
@@ -171,6 +205,15 @@ namespace lmat {
 	template<typename Kind> \
 	struct is_simdizable<FunT<double>, Kind> : public meta::has_simd_support<FTag, double, Kind> { };
 
+#define _LMAT_DEFINE_COMPLEX_SIMD_SUPPORT(FTag, FunT) \
+	LMAT_DEF_TRIVIAL_COMPLEX_SIMDIZE_MAP( FunT ) \
+	template<typename Kind> \
+	struct is_simdizable<FunT<std::complex<float> >, Kind> \
+	: public meta::has_simd_support<FTag, std::complex<float>, Kind> { }; \
+	template<typename Kind> \
+	struct is_simdizable<FunT<std::complex<double> >, Kind> \
+	: public meta::has_simd_support<FTag, std::complex<double>, Kind> { };
+
 #define _LMAT_DEFINE_GENERIC_MATH_FUN_EX( Name, NA, Expr ) \
 	LMAT_DEF_GENERIC_MATH_FUN( ftags::Name##_, NA, Name##_fun, Expr ) \
 	_LMAT_DEFINE_SIMD_SUPPORT( ftags::Name##_, Name##_fun )
@@ -22,12 +22,14 @@
 
 #include <cstdlib>
 #include <cmath>
+#include <complex>
 
 namespace lmat { namespace math {
 
 	// arithmetics
 
 	using std::fma;
+	using std::conj;
 
 	template<typename T>
 	LMAT_ENSURE_INLINE inline T (max)(const T& x, const T& y) { return x > y ? x : y; }
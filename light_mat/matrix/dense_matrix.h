@@ -15,6 +15,7 @@
 
 #include <light_mat/matrix/regular_mat_base.h>
 #include <light_mat/common/block.h>
+#include <light_mat/common/numa.h>
 
 #include <algorithm> // for std::swap
 
@@ -27,8 +28,8 @@ namespace lmat
 	 *
 	 ********************************************/
 
-	template<typename T, index_t CM, index_t CN>
-	struct matrix_traits<dense_matrix<T, CM, CN> >
+	template<typename T, index_t CM, index_t CN, class Allocator>
+	struct matrix_traits<dense_matrix<T, CM, CN, Allocator> >
 	: public regular_matrix_traits_base<T, CM, CN, cpu_domain>
 	{
 		typedef cont_layout_cm<CM, CN> layout_type;
@@ -43,7 +44,7 @@ namespace lmat
 
 	namespace internal
 	{
-		template<typename T, int CTSize>
+		template<typename T, int CTSize, class Allocator>
 		class dense_mat_storage
 		{
 #ifdef LMAT_USE_STATIC_ASSERT
@@ -79,8 +80,8 @@ namespace lmat
 		};
 
 
-		template<typename T>
-		class dense_mat_storage<T, 0>
+		template<typename T, class Allocator>
+		class dense_mat_storage<T, 0, Allocator>
 		{
 		public:
 			LMAT_ENSURE_INLINE
@@ -136,7 +137,7 @@ namespace lmat
 			}
 
 		private:
-			dblock<T> m_block;
+			dblock<T, Allocator> m_block;
 		};
 	}
 
@@ -146,8 +147,14 @@ namespace lmat
 	 *
 	 ********************************************/
 
-	template<typename T, index_t CM, index_t CN>
-	class dense_matrix : public regular_mat_base<dense_matrix<T, CM, CN> >
+	/**
+	 * The memory of a dynamic-size matrix comes from the Allocator
+	 * (see numa.h for allocators that control page placement).
+	 * Large matrices are initialized (and copied) in parallel,
+	 * by the column slabs of the parallel evaluators.
+	 */
+	template<typename T, index_t CM, index_t CN, class Allocator>
+	class dense_matrix : public regular_mat_base<dense_matrix<T, CM, CN, Allocator> >
 	{
 	public:
 		LMAT_DEFINE_REGMAT_TYPES(T)
@@ -164,6 +171,9 @@ namespace lmat
 		: m_layout(m, n)
 		, m_store(m_layout.nelems())
 		{
+			place();
+			if (allocator_placement<Allocator>::first_touch && CM * CN == 0)
+				internal::apply_by_columns(zero(), m, n, m_store.pdata());
 		}
 
 		template<class Setter>
@@ -171,13 +181,17 @@ namespace lmat
 		: m_layout(m, n)
 		, m_store(m_layout.nelems())
 		{
-			apply(setter.derived(), m * n, m_store.pdata());
+			place();
+			internal::apply_by_columns(setter, m, n, m_store.pdata());
 		}
 
 		LMAT_ENSURE_INLINE dense_matrix(const dense_matrix& s)
 		: m_layout(s.m_layout)
-		, m_store(s.m_store)
+		, m_store(m_layout.nelems())
 		{
+			place();
+			internal::apply_by_columns(copy_from(s.ptr_data()),
+					s.nrows(), s.ncolumns(), m_store.pdata());
 		}
 
 		LMAT_ENSURE_INLINE dense_matrix(dense_matrix&& s)
@@ -191,6 +205,7 @@ namespace lmat
 		: m_layout(r.nrows(), r.ncolumns())
 		, m_store(m_layout.nelems())
 		{
+			place();
 			evaluate(r.derived(), *this);
 		}
 
@@ -270,8 +285,13 @@ namespace lmat
 				{
 					storage_t new_store(new_layout.nelems());
 					m_store.swap(new_store);
+					m_layout = new_layout;
+					place();
+				}
+				else
+				{
+					m_layout = new_layout;  // the memory is reused as placed
 				}
-				m_layout = new_layout;
 			}
 		}
 
@@ -283,17 +303,25 @@ namespace lmat
 			evaluate(r.derived(), *this);
 		}
 
+		// prepares the placement of newly allocated memory (before it is touched)
+
+		LMAT_ENSURE_INLINE void place()
+		{
+			if (CM * CN == 0)
+				allocator_placement<Allocator>::prepare(m_store.pdata(), this->nrows(), this->ncolumns());
+		}
+
 	private:
-		typedef internal::dense_mat_storage<T, CM * CN> storage_t;
+		typedef internal::dense_mat_storage<T, CM * CN, Allocator> storage_t;
 
 		layout_type m_layout;
 		storage_t m_store;
 	};
 
 
-	template<typename T, index_t CM, index_t CN>
+	template<typename T, index_t CM, index_t CN, class Allocator>
 	LMAT_ENSURE_INLINE
-	inline void swap(dense_matrix<T, CM, CN>& a, dense_matrix<T, CM, CN>& b)
+	inline void swap(dense_matrix<T, CM, CN, Allocator>& a, dense_matrix<T, CM, CN, Allocator>& b)
 	{
 		a.swap(b);
 	}
@@ -14,6 +14,7 @@
 #define LIGHTMAT_MATRIX_COPY_INTERNAL_H_
 
 #include <light_mat/matrix/matrix_properties.h>
+#include <light_mat/common/memory_stream.h>
 
 namespace lmat { namespace internal {
 
@@ -445,6 +446,119 @@ namespace lmat { namespace internal {
 	}
 
 
+	/********************************************
+	 *
+	 *  Streaming copy
+	 *
+	 *  Contiguous destination columns are written
+	 *  with non-temporal stores, other schemes
+	 *  fall back to the regular routines.
+	 *
+	 *  The caller is responsible for issuing
+	 *  stream_fence() afterwards.
+	 *
+	 ********************************************/
+
+	template<typename T>
+	inline void _stream_copy_multicol(index_t m, index_t n,
+			const T *ps, index_t src_cs, T *pd, index_t dst_cs)
+	{
+		for (index_t j = 0; j < n; ++j)
+		{
+			_stream_copy_vec(m, ps + j * src_cs, pd + j * dst_cs);
+		}
+	}
+
+	// pointer to matrix
+
+	template<typename T, class DMat, class Scheme>
+	LMAT_ENSURE_INLINE
+	inline void stream_copy(const T *ps, IRegularMatrix<DMat, T>& dmat, const Scheme& sch)
+	{
+		internal::copy(ps, dmat, sch);
+	}
+
+	template<typename T, class DMat, index_t M, index_t N>
+	LMAT_ENSURE_INLINE
+	inline void stream_copy(const T *ps, IRegularMatrix<DMat, T>& dmat,
+			const matrix_copy_scheme<M, N, cont_level::whole>& sch)
+	{
+		_stream_copy_vec(sch.nelems(), ps, dmat.ptr_data());
+	}
+
+	template<typename T, class DMat, index_t M, index_t N>
+	inline void stream_copy(const T *ps, IRegularMatrix<DMat, T>& dmat,
+			const matrix_copy_scheme<M, N, cont_level::percol>& sch)
+	{
+		const index_t m = sch.nrows();
+
+		if (m == 1)
+			internal::copy(ps, dmat, sch);
+		else
+			_stream_copy_multicol(m, sch.ncolumns(), ps, m, dmat.ptr_data(), dmat.col_stride());
+	}
+
+	// matrix to pointer
+
+	template<typename T, class SMat, class Scheme>
+	LMAT_ENSURE_INLINE
+	inline void stream_copy(const IRegularMatrix<SMat, T>& smat, T *pd, const Scheme& sch)
+	{
+		internal::copy(smat, pd, sch);
+	}
+
+	template<typename T, class SMat, index_t M, index_t N>
+	LMAT_ENSURE_INLINE
+	inline void stream_copy(const IRegularMatrix<SMat, T>& smat, T *pd,
+			const matrix_copy_scheme<M, N, cont_level::whole>& sch)
+	{
+		_stream_copy_vec(sch.nelems(), smat.ptr_data(), pd);
+	}
+
+	template<typename T, class SMat, index_t M, index_t N>
+	inline void stream_copy(const IRegularMatrix<SMat, T>& smat, T *pd,
+			const matrix_copy_scheme<M, N, cont_level::percol>& sch)
+	{
+		const index_t m = sch.nrows();
+
+		if (m == 1)
+			internal::copy(smat, pd, sch);
+		else
+			_stream_copy_multicol(m, sch.ncolumns(), smat.ptr_data(), smat.col_stride(), pd, m);
+	}
+
+	// matrix to matrix
+
+	template<typename T, class SMat, class DMat, class Scheme>
+	LMAT_ENSURE_INLINE
+	inline void stream_copy(const IRegularMatrix<SMat, T>& smat, IRegularMatrix<DMat, T>& dmat,
+			const Scheme& sch)
+	{
+		internal::copy(smat, dmat, sch);
+	}
+
+	template<typename T, class SMat, class DMat, index_t M, index_t N>
+	LMAT_ENSURE_INLINE
+	inline void stream_copy(const IRegularMatrix<SMat, T>& smat, IRegularMatrix<DMat, T>& dmat,
+			const matrix_copy_scheme<M, N, cont_level::whole>& sch)
+	{
+		_stream_copy_vec(sch.nelems(), smat.ptr_data(), dmat.ptr_data());
+	}
+
+	template<typename T, class SMat, class DMat, index_t M, index_t N>
+	inline void stream_copy(const IRegularMatrix<SMat, T>& smat, IRegularMatrix<DMat, T>& dmat,
+			const matrix_copy_scheme<M, N, cont_level::percol>& sch)
+	{
+		const index_t m = sch.nrows();
+
+		if (m == 1)
+			internal::copy(smat, dmat, sch);
+		else
+			_stream_copy_multicol(m, sch.ncolumns(),
+					smat.ptr_data(), smat.col_stride(), dmat.ptr_data(), dmat.col_stride());
+	}
+
+
 } }
 
 #endif 
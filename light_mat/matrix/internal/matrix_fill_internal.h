@@ -14,6 +14,7 @@
 #define LIGHTMAT_MATRIX_FILL_INTERNAL_H_
 
 #include <light_mat/matrix/matrix_properties.h>
+#include <light_mat/common/memory_stream.h>
 
 namespace lmat { namespace internal {
 
@@ -320,8 +321,93 @@ namespace lmat { namespace internal {
 	}
 
 
+	/******************************************************
+	 *
+	 *  streaming fill & zero
+	 *
+	 *  Contiguous destination columns are written with
+	 *  non-temporal stores, other schemes fall back to
+	 *  the regular routines.
+	 *
+	 *  The caller is responsible for issuing
+	 *  stream_fence() afterwards.
+	 *
+	 ******************************************************/
+
+	template<typename T, class DMat, class Scheme>
+	LMAT_ENSURE_INLINE
+	inline void stream_fill(const T& v, IRegularMatrix<DMat, T>& dmat, const Scheme& sch)
+	{
+		fill(v, dmat, sch);
+	}
+
+	template<typename T, class DMat, index_t M, index_t N>
+	LMAT_ENSURE_INLINE
+	inline void stream_fill(const T& v, IRegularMatrix<DMat, T>& dmat,
+			const matrix_fill_scheme<M, N, cont_level::whole>& sch)
+	{
+		_stream_fill_vec(sch.nelems(), dmat.ptr_data(), v);
+	}
+
+	template<typename T, class DMat, index_t M, index_t N>
+	inline void stream_fill(const T& v, IRegularMatrix<DMat, T>& dmat,
+			const matrix_fill_scheme<M, N, cont_level::percol>& sch)
+	{
+		const index_t m = sch.nrows();
+		const index_t n = sch.ncolumns();
+
+		if (m == 1)
+		{
+			fill(v, dmat, sch);
+		}
+		else
+		{
+			T *pd = dmat.ptr_data();
+			const index_t cs = dmat.col_stride();
+
+			for (index_t j = 0; j < n; ++j)
+				_stream_fill_vec(m, pd + j * cs, v);
+		}
+	}
+
+	template<typename T, class DMat, class Scheme>
+	LMAT_ENSURE_INLINE
+	inline void stream_zero(IRegularMatrix<DMat, T>& dmat, const Scheme& sch)
+	{
+		zero(dmat, sch);
+	}
+
+	template<typename T, class DMat, index_t M, index_t N>
+	LMAT_ENSURE_INLINE
+	inline void stream_zero(IRegularMatrix<DMat, T>& dmat,
+			const matrix_fill_scheme<M, N, cont_level::whole>& sch)
+	{
+		_stream_zero_vec(sch.nelems(), dmat.ptr_data());
+	}
+
+	template<typename T, class DMat, index_t M, index_t N>
+	inline void stream_zero(IRegularMatrix<DMat, T>& dmat,
+			const matrix_fill_scheme<M, N, cont_level::percol>& sch)
+	{
+		const index_t m = sch.nrows();
+		const index_t n = sch.ncolumns();
+
+		if (m == 1)
+		{
+			zero(dmat, sch);
+		}
+		else
+		{
+			T *pd = dmat.ptr_data();
+			const index_t cs = dmat.col_stride();
+
+			for (index_t j = 0; j < n; ++j)
+				_stream_zero_vec(m, pd + j * cs);
+		}
+	}
+
+
 } }
 
 #endif /* MATRIX_FILL_INTERNAL_H_ */
 
-
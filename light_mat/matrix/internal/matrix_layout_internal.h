@@ -109,6 +109,63 @@ namespace lmat { namespace internal {
 	}
 
 
+	// row-major block layout (the contiguous one is the special case with ldim == n)
+
+	template<index_t M, index_t N>
+	LMAT_ENSURE_INLINE
+	inline index_t block_rm_sub2offset(const matrix_shape<M, N>& shape, index_t i, index_t j, index_t ldim)
+	{
+		return ldim * i + j;
+	}
+
+	template<index_t M>
+	LMAT_ENSURE_INLINE
+	inline index_t block_rm_sub2offset(const matrix_shape<M, 1>& shape, index_t i, index_t j, index_t ldim)
+	{
+		return ldim * i;
+	}
+
+	template<index_t N>
+	LMAT_ENSURE_INLINE
+	inline index_t block_rm_sub2offset(const matrix_shape<1, N>& shape, index_t i, index_t j, index_t ldim)
+	{
+		return j;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline index_t block_rm_sub2offset(const matrix_shape<1, 1>& shape, index_t i, index_t j, index_t ldim)
+	{
+		return 0;
+	}
+
+	template<index_t M, index_t N>
+	LMAT_ENSURE_INLINE
+	inline index_t block_rm_linoffset(const matrix_shape<M, N>& shape, index_t i, index_t ldim)
+	{
+		return raise_no_linear_offset();
+	}
+
+	template<index_t M>
+	LMAT_ENSURE_INLINE
+	inline index_t block_rm_linoffset(const matrix_shape<M, 1>& shape, index_t i, index_t ldim)
+	{
+		return ldim * i;
+	}
+
+	template<index_t N>
+	LMAT_ENSURE_INLINE
+	inline index_t block_rm_linoffset(const matrix_shape<1, N>& shape, index_t i, index_t ldim)
+	{
+		return i;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline index_t block_rm_linoffset(const matrix_shape<1, 1>& shape, index_t i, index_t ldim)
+	{
+		return 0;
+	}
+
+
 	// grid layout
 
 	template<index_t M, index_t N>
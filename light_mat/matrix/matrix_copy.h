@@ -13,30 +13,142 @@
 #ifndef LIGHTMAT_MATRIX_COPY_H_
 #define LIGHTMAT_MATRIX_COPY_H_
 
+#include <light_mat/common/numa.h>
 #include "internal/matrix_copy_internal.h"
+#include <light_mat/dispatch/dispatch_route.h>
 
 namespace lmat
 {
+	/********************************************
+	 *
+	 *  copy with a store hint
+	 *
+	 *  The hint (auto_store_, stream_store_, or
+	 *  cache_store_) decides whether contiguous
+	 *  destination columns are written with
+	 *  non-temporal stores. By default, this
+	 *  happens when the destination has at least
+	 *  LMAT_STREAM_STORE_THRESHOLD bytes.
+	 *
+	 ********************************************/
+
+	template<typename T, class RMat, typename S>
+	inline void copy(const T *ps, IRegularMatrix<RMat, T>& dst, S hint)
+	{
+		static_assert(meta::is_store_hint<S>::value, "hint must be a store hint.");
+
+		if (use_stream_store(hint, nbytes<T>(dst.nelems())))
+		{
+			internal::stream_copy(ps, dst.derived(), internal::get_copy_scheme(dst));
+			stream_fence();
+		}
+		else
+		{
+			internal::copy(ps, dst.derived(), internal::get_copy_scheme(dst));
+		}
+	}
+
+	template<typename T, class LMat, typename S>
+	inline void copy(const IRegularMatrix<LMat, T>& src, T* pd, S hint)
+	{
+		static_assert(meta::is_store_hint<S>::value, "hint must be a store hint.");
+
+		if (use_stream_store(hint, nbytes<T>(src.nelems())))
+		{
+			internal::stream_copy(src.derived(), pd, internal::get_copy_scheme(src));
+			stream_fence();
+		}
+		else
+		{
+			internal::copy(src.derived(), pd, internal::get_copy_scheme(src));
+		}
+	}
+
+	namespace internal
+	{
+		template<typename T, class LMat, class RMat>
+		inline void copy_cols(const IRegularMatrix<LMat, T>& src, IRegularMatrix<RMat, T>& dst, bool stream)
+		{
+			if (stream)
+			{
+				internal::stream_copy(src.derived(), dst.derived(), internal::get_copy_scheme(src, dst));
+				stream_fence();
+			}
+			else
+			{
+				internal::copy(src.derived(), dst.derived(), internal::get_copy_scheme(src, dst));
+			}
+		}
+
+		// columns [j0, j0 + nj) of matrices with contiguous columns
+
+		template<typename T>
+		inline void copy_col_slab(index_t m, index_t scs, index_t dcs, index_t j0, index_t nj,
+				const T *ps, T *pd, bool stream)
+		{
+			for (index_t j = j0; j < j0 + nj; ++j)
+			{
+				if (stream) _stream_copy_vec(m, ps + j * scs, pd + j * dcs);
+				else copy_vec(m, ps + j * scs, pd + j * dcs);
+			}
+			if (stream) stream_fence();
+		}
+	}
+
+	// large matrices are copied by all threads, each on the column
+	// slab it is assigned by the parallel evaluators (see numa.h)
+
+	template<typename T, class LMat, class RMat, typename S>
+	inline void copy(const IRegularMatrix<LMat, T>& src, IRegularMatrix<RMat, T>& dst, S hint)
+	{
+		static_assert(meta::is_store_hint<S>::value, "hint must be a store hint.");
+		LMAT_CHECK_DIMS( have_same_shape(src, dst) )
+
+		const size_t nb = nbytes<T>(dst.nelems());
+		const bool stream = use_stream_store(hint, nb);
+
+		if (src.row_stride() == 1 && dst.row_stride() == 1 &&
+				internal::use_parallel_init(dst.ncolumns(), nb))
+		{
+			const index_t m = dst.nrows();
+			const index_t scs = src.col_stride();
+			const index_t dcs = dst.col_stride();
+			const T *ps = src.ptr_data();
+			T *pd = dst.ptr_data();
+			internal::for_column_slabs(dst.ncolumns(), [m, scs, dcs, ps, pd, stream](index_t j0, index_t nj)
+			{
+				internal::copy_col_slab(m, scs, dcs, j0, nj, ps, pd, stream);
+			});
+		}
+		else
+		{
+			internal::copy_cols(src, dst, stream);
+		}
+	}
+
+
 	template<typename T, class RMat>
 	LMAT_ENSURE_INLINE
 	inline void copy(const T *ps, IRegularMatrix<RMat, T>& dst)
 	{
-		internal::copy(ps, dst.derived(), internal::get_copy_scheme(dst));
+		lmat::copy(ps, dst, auto_store_());
 	}
 
 	template<typename T, class LMat>
 	LMAT_ENSURE_INLINE
 	inline void copy(const IRegularMatrix<LMat, T>& src, T* pd)
 	{
-		internal::copy(src.derived(), pd, internal::get_copy_scheme(src));
+		lmat::copy(src, pd, auto_store_());
 	}
 
-
 	template<typename T, class LMat, class RMat>
 	LMAT_ENSURE_INLINE
 	inline void copy(const IRegularMatrix<LMat, T>& src, IRegularMatrix<RMat, T>& dst)
 	{
-		internal::copy(src.derived(), dst.derived(), internal::get_copy_scheme(src, dst));
+		LMAT_CHECK_DIMS( have_same_shape(src, dst) )
+		LMAT_DISPATCH_ROUTE( copy, src.derived(), dst.derived() )
+
+		lmat::copy(src, dst, auto_store_());
 	}
 
 	template<typename T, class DMat>
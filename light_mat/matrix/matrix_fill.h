@@ -14,22 +14,141 @@
 #define LIGHTMAT_MATRIX_FILL_H_
 
 #include <light_mat/matrix/matrix_properties.h>
+#include <light_mat/common/numa.h>
 #include "internal/matrix_fill_internal.h"
+#include <light_mat/dispatch/dispatch_route.h>
 
 namespace lmat
 {
+	/********************************************
+	 *
+	 *  zero & fill with a store hint
+	 *
+	 *  (see matrix_copy.h)
+	 *
+	 ********************************************/
+
+	namespace internal
+	{
+		template<typename T, class Mat>
+		inline void zero_cols(IRegularMatrix<Mat, T>& dst, bool stream)
+		{
+			if (stream)
+			{
+				internal::stream_zero(dst, internal::get_fill_scheme(dst));
+				stream_fence();
+			}
+			else
+			{
+				internal::zero(dst, internal::get_fill_scheme(dst));
+			}
+		}
+
+		template<typename T, class Mat>
+		inline void fill_cols(IRegularMatrix<Mat, T>& dst, const T& val, bool stream)
+		{
+			if (stream)
+			{
+				internal::stream_fill(val, dst, internal::get_fill_scheme(dst));
+				stream_fence();
+			}
+			else
+			{
+				internal::fill(val, dst, internal::get_fill_scheme(dst));
+			}
+		}
+
+		// columns [j0, j0 + nj) of a matrix with contiguous columns
+
+		template<typename T>
+		inline void zero_col_slab(index_t m, index_t cs, index_t j0, index_t nj, T *p, bool stream)
+		{
+			for (index_t j = j0; j < j0 + nj; ++j)
+			{
+				if (stream) _stream_zero_vec(m, p + j * cs);
+				else zero_vec(m, p + j * cs);
+			}
+			if (stream) stream_fence();
+		}
+
+		template<typename T>
+		inline void fill_col_slab(index_t m, index_t cs, index_t j0, index_t nj, T *p, const T& val, bool stream)
+		{
+			for (index_t j = j0; j < j0 + nj; ++j)
+			{
+				if (stream) _stream_fill_vec(m, p + j * cs, val);
+				else fill_vec(m, p + j * cs, val);
+			}
+			if (stream) stream_fence();
+		}
+	}
+
+	// large matrices are written by all threads, each on the column
+	// slab it is assigned by the parallel evaluators (see numa.h)
+
+	template<typename T, class Mat, typename S>
+	inline void zero(IRegularMatrix<Mat, T>& dst, S hint)
+	{
+		static_assert(meta::is_store_hint<S>::value, "hint must be a store hint.");
+
+		const size_t nb = nbytes<T>(dst.nelems());
+		const bool stream = use_stream_store(hint, nb);
+
+		if (dst.row_stride() == 1 && internal::use_parallel_init(dst.ncolumns(), nb))
+		{
+			const index_t m = dst.nrows();
+			const index_t cs = dst.col_stride();
+			T *p = dst.ptr_data();
+			internal::for_column_slabs(dst.ncolumns(), [m, cs, p, stream](index_t j0, index_t nj)
+			{
+				internal::zero_col_slab(m, cs, j0, nj, p, stream);
+			});
+		}
+		else
+		{
+			internal::zero_cols(dst, stream);
+		}
+	}
+
+	template<typename T, class Mat, typename S>
+	inline void fill(IRegularMatrix<Mat, T>& dst, const T& val, S hint)
+	{
+		static_assert(meta::is_store_hint<S>::value, "hint must be a store hint.");
+
+		const size_t nb = nbytes<T>(dst.nelems());
+		const bool stream = use_stream_store(hint, nb);
+
+		if (dst.row_stride() == 1 && internal::use_parallel_init(dst.ncolumns(), nb))
+		{
+			const index_t m = dst.nrows();
+			const index_t cs = dst.col_stride();
+			T *p = dst.ptr_data();
+			internal::for_column_slabs(dst.ncolumns(), [m, cs, p, &val, stream](index_t j0, index_t nj)
+			{
+				internal::fill_col_slab(m, cs, j0, nj, p, val, stream);
+			});
+		}
+		else
+		{
+			internal::fill_cols(dst, val, stream);
+		}
+	}
+
+
 	template<typename T, class Mat>
 	LMAT_ENSURE_INLINE
 	inline void zero(IRegularMatrix<Mat, T>& dst)
 	{
-		internal::zero(dst, internal::get_fill_scheme(dst));
+		zero(dst, auto_store_());
 	}
 
 	template<typename T, class Mat>
 	LMAT_ENSURE_INLINE
 	inline void fill(IRegularMatrix<Mat, T>& dst, const T& val)
 	{
-		internal::fill(val, dst, internal::get_fill_scheme(dst));
+		LMAT_DISPATCH_ROUTE( fill, dst.derived(), val )
+
+		fill(dst, val, auto_store_());
 	}
 
 	template<typename T, class DMat>
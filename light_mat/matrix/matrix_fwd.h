@@ -16,6 +16,7 @@
 #include <light_mat/common/basic_defs.h>
 #include <light_mat/common/range.h>
 #include <light_mat/common/memory.h>
+#include <light_mat/common/memalloc.h>
 
 #include <light_mat/matrix/matrix_shape.h>
 
@@ -86,7 +87,7 @@ namespace lmat
 
 	// forward declaration of some important types
 
-	template<typename T, index_t CM=0, index_t CN=0> class dense_matrix;
+	template<typename T, index_t CM=0, index_t CN=0, class Allocator=aligned_allocator<T> > class dense_matrix;
 	template<typename T, index_t CM=0> class dense_col;
 	template<typename T, index_t CN=0> class dense_row;
 
@@ -102,6 +103,11 @@ namespace lmat
 	template<typename T, index_t CM=0, index_t CN=0> class cref_grid;
 	template<typename T, index_t CM=0, index_t CN=0> class ref_grid;
 
+	template<typename T, index_t CM=0, index_t CN=0> class cref_matrix_rm;
+	template<typename T, index_t CM=0, index_t CN=0> class ref_matrix_rm;
+	template<typename T, index_t CM=0, index_t CN=0> class cref_block_rm;
+	template<typename T, index_t CM=0, index_t CN=0> class ref_block_rm;
+
 	template<typename T, index_t CM=0> class cstep_col;
 	template<typename T, index_t CM=0> class step_col;
 	template<typename T, index_t CN=0> class cstep_row;
@@ -0,0 +1,939 @@
+/**
+ * @file matrix_io.h
+ *
+ * @brief Reading and writing matrices from/to files
+ *
+ * Text files hold one matrix row per line, with the fields separated
+ * by a delimiter (by default: commas, semicolons, or runs of blanks).
+ * Empty lines and lines starting with '#' are skipped.
+ *
+ * Loading maps the file into memory, splits it at line boundaries
+ * over the threads (with OpenMP), and parses each part straight into
+ * the column-major storage of the destination. Numbers are parsed
+ * eight digits at a time (SWAR), with an exact fast path for the
+ * common cases and strtod for the rest. Numbers read into float
+ * matrices are parsed as floats (with strtof), not rounded twice
+ * through double.
+ *
+ * Binary files hold a 32-byte header (magic, element type, element
+ * size, shape) followed by the elements in column-major order.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_MATRIX_IO_H_
+#define LIGHTMAT_MATRIX_IO_H_
+
+#include <light_mat/matrix/dense_matrix.h>
+#include <light_mat/common/parallel.h>
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#if LIGHTMAT_PLATFORM == LIGHTMAT_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace lmat
+{
+	class io_error : public std::exception
+	{
+	public:
+		io_error(const std::string& msg)
+		: m_msg(msg) { }
+
+		~io_error() throw() { }
+
+		virtual const char *what() const throw()
+		{
+			return m_msg.c_str();
+		}
+
+	private:
+		std::string m_msg;
+	};
+
+
+	namespace internal
+	{
+		/********************************************
+		 *
+		 *  file access
+		 *
+		 ********************************************/
+
+		class mapped_file : private noncopyable
+		{
+		public:
+			explicit mapped_file(const char *path)
+			: m_data(nullptr), m_len(0), m_mapped(false)
+			{
+#if LIGHTMAT_PLATFORM == LIGHTMAT_POSIX
+				int fd = ::open(path, O_RDONLY);
+				if (fd < 0) throw io_error(std::string("Failed to open ") + path);
+
+				struct stat st;
+				if (::fstat(fd, &st) == 0 && st.st_size > 0)
+				{
+					m_len = (size_t)st.st_size;
+					void *p = ::mmap(0, m_len, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (p != MAP_FAILED)
+					{
+						m_data = (const char*)p;
+						m_mapped = true;
+					}
+				}
+				::close(fd);
+				if (m_mapped) return;
+
+				// st_size is 0 for pipes and files in /proc: read those through
+#endif
+				read_all(path);
+			}
+
+			~mapped_file()
+			{
+#if LIGHTMAT_PLATFORM == LIGHTMAT_POSIX
+				if (m_mapped) ::munmap((void*)m_data, m_len);
+#endif
+			}
+
+			const char *begin() const { return m_data; }
+			const char *end() const { return m_data + m_len; }
+			size_t size() const { return m_len; }
+
+		private:
+			void read_all(const char *path)
+			{
+				std::FILE *f = std::fopen(path, "rb");
+				if (!f) throw io_error(std::string("Failed to open ") + path);
+
+				char buf[65536];
+				size_t k;
+				while ((k = std::fread(buf, 1, sizeof(buf), f)) > 0)
+					m_buf.insert(m_buf.end(), buf, buf + k);
+				std::fclose(f);
+
+				m_data = m_buf.empty() ? nullptr : &m_buf[0];
+				m_len = m_buf.size();
+			}
+
+		private:
+			const char *m_data;
+			size_t m_len;
+			bool m_mapped;
+			std::vector<char> m_buf;
+		};
+
+		class file_writer : private noncopyable
+		{
+		public:
+			file_writer(const char *path)
+			: m_path(path), m_file(std::fopen(path, "wb"))
+			{
+				if (!m_file) throw io_error(std::string("Failed to open ") + path + " for writing");
+			}
+
+			~file_writer()
+			{
+				if (m_file) std::fclose(m_file);
+			}
+
+			void write(const void *p, size_t n)
+			{
+				if (n > 0 && std::fwrite(p, 1, n, m_file) != n)
+					throw io_error(std::string("Failed to write to ") + m_path);
+			}
+
+			void close()
+			{
+				int r = std::fclose(m_file);
+				m_file = nullptr;
+				if (r != 0) throw io_error(std::string("Failed to write to ") + m_path);
+			}
+
+		private:
+			std::string m_path;
+			std::FILE *m_file;
+		};
+
+		inline index_t io_num_threads(size_t nbytes)
+		{
+#ifdef _OPENMP
+			return nbytes >= (size_t)(LMAT_PARALLEL_IO_THRESHOLD) ? (index_t)omp_get_max_threads() : 1;
+#else
+			return 1;
+#endif
+		}
+
+
+		/********************************************
+		 *
+		 *  number parsing
+		 *
+		 ********************************************/
+
+		LMAT_ENSURE_INLINE
+		inline bool is_dec_digit(char c)
+		{
+			return (unsigned)(c - '0') < 10u;
+		}
+
+		LMAT_ENSURE_INLINE
+		inline bool is_blank(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		// converts 8 decimal digits at p with a few integer operations,
+		// returns false if they are not all digits
+
+		LMAT_ENSURE_INLINE
+		inline bool parse_eight_digits(const char *p, uint64_t& v)
+		{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+			uint64_t x;
+			std::memcpy(&x, p, 8);
+
+			if (((x & 0xF0F0F0F0F0F0F0F0ULL) |
+				(((x + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) != 0x3333333333333333ULL)
+				return false;
+
+			x -= 0x3030303030303030ULL;
+			x = (x * 10) + (x >> 8);
+			x = (((x & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+				(((x >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+			v = x;
+			return true;
+#else
+			uint64_t x = 0;
+			for (int k = 0; k < 8; ++k)
+			{
+				if (!is_dec_digit(p[k])) return false;
+				x = x * 10 + (uint64_t)(p[k] - '0');
+			}
+			v = x;
+			return true;
+#endif
+		}
+
+		// accumulates a run of digits into m, counting them in nd
+		// (m is only exact while nd <= 19)
+
+		LMAT_ENSURE_INLINE
+		inline const char *scan_digits(const char *p, const char *e, uint64_t& m, int& nd)
+		{
+			uint64_t v;
+			while (e - p >= 8 && nd <= 11 && parse_eight_digits(p, v))
+			{
+				m = m * 100000000ULL + v;
+				nd += 8;
+				p += 8;
+			}
+
+			while (p < e && is_dec_digit(*p))
+			{
+				if (nd < 19) m = m * 10 + (uint64_t)(*p - '0');
+				++ nd;
+				++ p;
+			}
+			return p;
+		}
+
+		inline void str_to_real(const char *s, char **r, double& v)
+		{
+			v = std::strtod(s, r);
+		}
+
+		inline void str_to_real(const char *s, char **r, float& v)
+		{
+			v = std::strtof(s, r);
+		}
+
+		template<typename R>
+		inline const char *parse_real_slow(const char *s, const char *e, R& v)
+		{
+			const char *q = s;
+			while (q < e && (std::isalnum((unsigned char)*q) || *q == '.' || *q == '+' || *q == '-')) ++q;
+
+			const size_t len = (size_t)(q - s);
+			if (len == 0 || len >= 512) return nullptr;
+
+			char buf[512];
+			std::memcpy(buf, s, len);
+			buf[len] = '\0';
+
+			char *r;
+			str_to_real(buf, &r, v);
+			return r == buf + len ? q : nullptr;
+		}
+
+		// the mantissas and powers of ten a real type holds exactly
+
+		template<typename R> struct exact_real;
+
+		template<> struct exact_real<double>
+		{
+			static const int mantissa_bits = 53;
+			static const int max_pow10 = 22;
+		};
+
+		template<> struct exact_real<float>
+		{
+			static const int mantissa_bits = 24;
+			static const int max_pow10 = 10;
+		};
+
+		// the type the text of a T is parsed as
+
+		template<typename T> struct text_real { typedef double type; };
+		template<> struct text_real<float> { typedef float type; };
+
+		/**
+		 * Parses a real number (double or float) in [p, e), returns
+		 * the position after it, or nullptr if there is no valid
+		 * number at p.
+		 */
+		template<typename R>
+		inline const char *parse_real(const char *p, const char *e, R& v)
+		{
+			static const double pow10[23] = {
+				1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+			const char *s = p;
+			bool neg = false;
+			if (p < e && (*p == '-' || *p == '+'))
+			{
+				neg = (*p == '-');
+				++ p;
+			}
+
+			uint64_t m = 0;
+			int nd = 0;
+			int e10 = 0;
+
+			// integer part (leading zeros are not significant)
+
+			const char *d0 = p;
+			while (p < e && *p == '0') ++p;
+			p = scan_digits(p, e, m, nd);
+			bool any = (p > d0);
+
+			// fraction part
+
+			if (p < e && *p == '.')
+			{
+				++ p;
+				const char *f0 = p;
+				if (nd == 0)
+				{
+					while (p < e && *p == '0') ++p;
+				}
+				p = scan_digits(p, e, m, nd);
+
+				e10 -= (int)(p - f0);
+				any = any || (p > f0);
+			}
+
+			if (!any) return parse_real_slow(s, e, v);   // e.g. nan, inf
+
+			// exponent
+
+			if (p < e && (*p == 'e' || *p == 'E'))
+			{
+				const char *q = p + 1;
+				bool eneg = false;
+				if (q < e && (*q == '-' || *q == '+'))
+				{
+					eneg = (*q == '-');
+					++ q;
+				}
+				if (q == e || !is_dec_digit(*q)) return nullptr;
+
+				int x = 0;
+				while (q < e && is_dec_digit(*q))
+				{
+					if (x < 100000) x = x * 10 + (*q - '0');
+					++ q;
+				}
+				e10 += eneg ? -x : x;
+				p = q;
+			}
+
+			// exact when both the mantissa and the power of ten are
+
+			const int max_e10 = exact_real<R>::max_pow10;
+			if (nd <= 19 && m <= (uint64_t(1) << exact_real<R>::mantissa_bits) &&
+				e10 >= -max_e10 && e10 <= max_e10)
+			{
+				R r = (R)m;
+				r = e10 < 0 ? r / (R)pow10[-e10] : r * (R)pow10[e10];
+				v = neg ? -r : r;
+				return p;
+			}
+
+			return parse_real_slow(s, e, v);
+		}
+
+
+		/********************************************
+		 *
+		 *  line parsing
+		 *
+		 ********************************************/
+
+		LMAT_ENSURE_INLINE
+		inline const char *line_end(const char *p, const char *e)
+		{
+			const char *q = (const char*)std::memchr(p, '\n', (size_t)(e - p));
+			return q ? q : e;
+		}
+
+		LMAT_ENSURE_INLINE
+		inline bool is_data_line(const char *p, const char *le)
+		{
+			while (p < le && is_blank(*p)) ++p;
+			return p < le && *p != '#';
+		}
+
+		LMAT_ENSURE_INLINE
+		inline bool is_field_delim(char c, char delim)
+		{
+			return delim ? c == delim : (c == ',' || c == ';');
+		}
+
+		LMAT_ENSURE_INLINE
+		inline const char *skip_blanks(const char *p, const char *le, char delim)
+		{
+			while (p < le && is_blank(*p) && *p != delim) ++p;
+			return p;
+		}
+
+		/**
+		 * Parses the fields of a line as reals of type R, calling
+		 * f(j, v) on each, returns the number of fields, or -1 on
+		 * a malformed field.
+		 */
+		template<typename R, class F>
+		inline index_t parse_line(const char *p, const char *le, char delim, F f)
+		{
+			index_t j = 0;
+
+			for(;;)
+			{
+				p = skip_blanks(p, le, delim);
+
+				R v;
+				const char *q = parse_real(p, le, v);
+				if (!q) return -1;
+				f(j++, v);
+
+				p = skip_blanks(q, le, delim);
+				if (p == le) return j;
+
+				if (is_field_delim(*p, delim)) ++p;
+				else if (!delim && p > q) { }   // blank-separated
+				else return -1;
+			}
+		}
+
+		struct text_part
+		{
+			const char *begin;
+			const char *end;
+			index_t nlines;		// all lines
+			index_t nrows;		// data lines
+			index_t row0;
+			index_t line0;
+			index_t bad_line;	// line (within the part) of the first error, or -1
+		};
+
+		inline void count_lines(text_part& t)
+		{
+			t.nlines = 0;
+			t.nrows = 0;
+
+			const char *p = t.begin;
+			while (p < t.end)
+			{
+				const char *le = line_end(p, t.end);
+				if (is_data_line(p, le)) ++ t.nrows;
+				++ t.nlines;
+				p = le + 1;
+			}
+		}
+
+		template<typename T>
+		inline void parse_part(text_part& t, char delim, T *a, index_t m, index_t n)
+		{
+			t.bad_line = -1;
+
+			index_t i = t.row0;
+			index_t l = 0;
+
+			const char *p = t.begin;
+			while (p < t.end)
+			{
+				const char *le = line_end(p, t.end);
+				if (is_data_line(p, le))
+				{
+					typedef typename text_real<T>::type real_t;
+
+					T *r = a + i;
+					index_t k = parse_line<real_t>(p, le, delim, [r, m, n](index_t j, real_t v)
+					{
+						if (j < n) r[j * m] = static_cast<T>(v);
+					});
+
+					if (k != n)
+					{
+						t.bad_line = l;
+						return;
+					}
+					++ i;
+				}
+				++ l;
+				p = le + 1;
+			}
+		}
+
+		// splits [b, e) into nt parts at line boundaries
+
+		inline std::vector<text_part> split_text(const char *b, const char *e, index_t nt)
+		{
+			std::vector<text_part> parts((size_t)nt);
+
+			const size_t len = (size_t)(e - b);
+
+			const char *prev = b;
+			for (index_t t = 0; t < nt; ++t)
+			{
+				const char *q = b + len / (size_t)nt * (size_t)(t + 1);
+				if (q < e && q > b)
+				{
+					q = line_end(q - 1, e);
+					if (q < e) ++q;
+				}
+				if (q < prev) q = prev;
+
+				parts[t].begin = prev;
+				parts[t].end = q;
+				prev = q;
+			}
+			parts[nt - 1].end = e;
+			return parts;
+		}
+
+
+		/********************************************
+		 *
+		 *  number formatting
+		 *
+		 ********************************************/
+
+		template<typename T>
+		inline typename meta::enable_if_<std::is_integral<T>, size_t>::type
+		format_number(char *buf, const T& x, int)
+		{
+			typedef typename std::make_unsigned<T>::type U;
+
+			char tmp[24];
+			int k = 0;
+			U u = x < 0 ? (U)(U(0) - (U)x) : (U)x;
+			do
+			{
+				tmp[k++] = (char)('0' + (int)(u % 10));
+				u /= 10;
+			}
+			while (u);
+
+			size_t len = 0;
+			if (x < 0) buf[len++] = '-';
+			while (k > 0) buf[len++] = tmp[--k];
+			return len;
+		}
+
+		// buf has at least 40 chars: digits beyond those of a double are
+		// dropped, so that "%.*g" (at most 24 chars then) is never truncated
+
+		template<typename T>
+		inline typename meta::enable_if_<std::is_floating_point<T>, size_t>::type
+		format_number(char *buf, const T& x, int precision)
+		{
+			const int max_prec = std::numeric_limits<double>::max_digits10;
+			if (precision > max_prec) precision = max_prec;
+
+			const int len = std::snprintf(buf, 40, "%.*g", precision, (double)x);
+			return len < 0 ? 0 : (len < 40 ? (size_t)len : 39);
+		}
+
+		template<typename T>
+		inline int default_text_precision()
+		{
+			return std::numeric_limits<T>::max_digits10;
+		}
+
+
+		/********************************************
+		 *
+		 *  binary format
+		 *
+		 ********************************************/
+
+		template<typename T> struct io_dtype;
+
+		template<> struct io_dtype<float>    { static const uint32_t code = 1; };
+		template<> struct io_dtype<double>   { static const uint32_t code = 2; };
+		template<> struct io_dtype<int8_t>   { static const uint32_t code = 3; };
+		template<> struct io_dtype<uint8_t>  { static const uint32_t code = 4; };
+		template<> struct io_dtype<int16_t>  { static const uint32_t code = 5; };
+		template<> struct io_dtype<uint16_t> { static const uint32_t code = 6; };
+		template<> struct io_dtype<int32_t>  { static const uint32_t code = 7; };
+		template<> struct io_dtype<uint32_t> { static const uint32_t code = 8; };
+		template<> struct io_dtype<int64_t>  { static const uint32_t code = 9; };
+		template<> struct io_dtype<uint64_t> { static const uint32_t code = 10; };
+
+		const char binary_magic[4] = {'L', 'M', 'A', 'T'};
+
+		struct binary_header
+		{
+			uint32_t dtype;
+			uint32_t elem_size;
+			int64_t nrows;
+			int64_t ncols;
+		};
+
+		inline void encode_binary_header(const binary_header& h, char *buf)
+		{
+			const uint32_t version = 1;
+
+			std::memcpy(buf, binary_magic, 4);
+			std::memcpy(buf + 4, &version, 4);
+			std::memcpy(buf + 8, &h.dtype, 4);
+			std::memcpy(buf + 12, &h.elem_size, 4);
+			std::memcpy(buf + 16, &h.nrows, 8);
+			std::memcpy(buf + 24, &h.ncols, 8);
+		}
+
+		inline bool decode_binary_header(const char *buf, binary_header& h)
+		{
+			uint32_t version;
+			std::memcpy(&version, buf + 4, 4);
+			if (std::memcmp(buf, binary_magic, 4) != 0 || version != 1) return false;
+
+			std::memcpy(&h.dtype, buf + 8, 4);
+			std::memcpy(&h.elem_size, buf + 12, 4);
+			std::memcpy(&h.nrows, buf + 16, 8);
+			std::memcpy(&h.ncols, buf + 24, 8);
+			return true;
+		}
+
+		const size_t binary_header_size = 32;
+
+		// the number of bytes of the elements, false if the shape is invalid
+		// (negative, a dimension beyond index_t, or too many elements)
+
+		template<typename T>
+		inline bool binary_data_size(const binary_header& h, uint64_t& nb)
+		{
+			const int64_t max_dim = (int64_t)std::numeric_limits<index_t>::max();
+
+			if (h.nrows < 0 || h.ncols < 0 || h.nrows > max_dim || h.ncols > max_dim)
+				return false;
+			if (h.ncols > 0 && h.nrows > max_dim / h.ncols)
+				return false;
+
+			const uint64_t n = (uint64_t)h.nrows * (uint64_t)h.ncols;
+			if (n > (uint64_t)std::numeric_limits<size_t>::max() / sizeof(T))
+				return false;
+
+			nb = n * sizeof(T);
+			return true;
+		}
+
+		// 64-bit file positions (a long has 32 bits on Win64)
+
+		inline int64_t io_tell(std::FILE *f)
+		{
+#ifdef _WIN32
+			return (int64_t)::_ftelli64(f);
+#else
+			return (int64_t)::ftello(f);
+#endif
+		}
+
+		inline bool io_seek(std::FILE *f, int64_t pos, int origin)
+		{
+#ifdef _WIN32
+			return ::_fseeki64(f, pos, origin) == 0;
+#else
+			return ::fseeko(f, (off_t)pos, origin) == 0;
+#endif
+		}
+
+		inline bool remaining_bytes(std::FILE *f, uint64_t& r)
+		{
+			const int64_t cur = io_tell(f);
+			if (cur < 0 || !io_seek(f, 0, SEEK_END)) return false;
+
+			const int64_t end = io_tell(f);
+			if (end < cur || !io_seek(f, cur, SEEK_SET)) return false;
+
+			r = (uint64_t)(end - cur);
+			return true;
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  text I/O
+	 *
+	 ********************************************/
+
+	/**
+	 * Loads a matrix from a text file (delim = 0: commas,
+	 * semicolons or blanks), one row per line.
+	 */
+	template<typename T, index_t CM, index_t CN, class Allocator>
+	void load_text(const char *path, dense_matrix<T, CM, CN, Allocator>& a, char delim = 0)
+	{
+		internal::mapped_file f(path);
+		const char *b = f.begin();
+		const char *e = f.end();
+
+		// the number of columns is that of the first data line
+
+		index_t n = 0;
+		index_t lfirst = 0;
+		for (const char *p = b; p < e; ++lfirst)
+		{
+			const char *le = internal::line_end(p, e);
+			if (internal::is_data_line(p, le))
+			{
+				n = internal::parse_line<double>(p, le, delim, [](index_t, double) { });
+				if (n < 0)
+					throw io_error(std::string(path) + ": malformed line " + std::to_string(lfirst + 1));
+				break;
+			}
+			p = le + 1;
+		}
+
+		const index_t nt = internal::io_num_threads(f.size());
+		std::vector<internal::text_part> parts = nt > 0 && b < e ?
+				internal::split_text(b, e, nt) : std::vector<internal::text_part>();
+		const index_t np = (index_t)parts.size();
+
+#ifdef _OPENMP
+#pragma omp parallel for if(np > 1)
+#endif
+		for (index_t t = 0; t < np; ++t)
+		{
+			internal::count_lines(parts[t]);
+		}
+
+		index_t m = 0;
+		index_t nl = 0;
+		for (index_t t = 0; t < np; ++t)
+		{
+			parts[t].row0 = m;
+			parts[t].line0 = nl;
+			m += parts[t].nrows;
+			nl += parts[t].nlines;
+		}
+
+		a.require_size(m, n);
+		T *pa = a.ptr_data();
+
+#ifdef _OPENMP
+#pragma omp parallel for if(np > 1)
+#endif
+		for (index_t t = 0; t < np; ++t)
+		{
+			internal::parse_part(parts[t], delim, pa, m, n);
+		}
+
+		for (index_t t = 0; t < np; ++t)
+		{
+			if (parts[t].bad_line >= 0)
+				throw io_error(std::string(path) + ": malformed line " +
+						std::to_string(parts[t].line0 + parts[t].bad_line + 1));
+		}
+	}
+
+	/**
+	 * Writes a matrix to a text file, one row per line.
+	 * (precision < 0: enough digits to read back the same
+	 * values)
+	 */
+	template<typename T, class Mat>
+	void save_text(const char *path, const IRegularMatrix<Mat, T>& X, char delim = ',', int precision = -1)
+	{
+		const index_t m = X.nrows();
+		const index_t n = X.ncolumns();
+		if (precision < 0) precision = internal::default_text_precision<T>();
+
+		internal::file_writer w(path);
+
+		// rows are formatted in batches, each by all threads
+
+		const index_t nt = internal::io_num_threads(nbytes<T>(m * n));
+		const index_t bm = n > 0 ? std::max(nt, (index_t)(LMAT_PARALLEL_IO_THRESHOLD) / n + 1) : m;
+		std::vector<std::string> bufs((size_t)nt);
+
+		for (index_t i0 = 0; i0 < m; i0 += bm)
+		{
+			const index_t nr = std::min(bm, m - i0);
+
+#ifdef _OPENMP
+#pragma omp parallel for if(nt > 1)
+#endif
+			for (index_t t = 0; t < nt; ++t)
+			{
+				index_t r0, nrt;
+				internal::static_column_slab(nr, nt, t, r0, nrt);
+
+				std::string& s = bufs[t];
+				s.clear();
+
+				char num[48];
+				for (index_t i = i0 + r0; i < i0 + r0 + nrt; ++i)
+				{
+					for (index_t j = 0; j < n; ++j)
+					{
+						if (j > 0) s.push_back(delim);
+						s.append(num, internal::format_number(num, X.elem(i, j), precision));
+					}
+					s.push_back('\n');
+				}
+			}
+
+			for (index_t t = 0; t < nt; ++t) w.write(bufs[t].data(), bufs[t].size());
+		}
+
+		w.close();
+	}
+
+
+	/********************************************
+	 *
+	 *  binary I/O
+	 *
+	 ********************************************/
+
+	template<typename T, class Mat>
+	void save_binary(const char *path, const IRegularMatrix<Mat, T>& X)
+	{
+		const index_t m = X.nrows();
+		const index_t n = X.ncolumns();
+
+		internal::binary_header h;
+		h.dtype = internal::io_dtype<T>::code;
+		h.elem_size = (uint32_t)sizeof(T);
+		h.nrows = (int64_t)m;
+		h.ncols = (int64_t)n;
+
+		char hbuf[internal::binary_header_size];
+		internal::encode_binary_header(h, hbuf);
+
+		internal::file_writer w(path);
+		w.write(hbuf, sizeof(hbuf));
+
+		if (X.row_stride() == 1 && (X.col_stride() == m || n == 1))
+		{
+			w.write(X.ptr_data(), nbytes<T>(m * n));
+		}
+		else if (X.row_stride() == 1)
+		{
+			for (index_t j = 0; j < n; ++j)
+				w.write(X.ptr_data() + j * X.col_stride(), nbytes<T>(m));
+		}
+		else
+		{
+			std::vector<T> col((size_t)m);
+			for (index_t j = 0; j < n; ++j)
+			{
+				for (index_t i = 0; i < m; ++i) col[i] = X.elem(i, j);
+				if (m > 0) w.write(&col[0], nbytes<T>(m));
+			}
+		}
+
+		w.close();
+	}
+
+	/**
+	 * Loads a matrix written by save_binary. The element type
+	 * must be the one that was saved, and the file must hold
+	 * exactly the elements of the shape in its header (this is
+	 * checked before the matrix is allocated).
+	 */
+	template<typename T, index_t CM, index_t CN, class Allocator>
+	void load_binary(const char *path, dense_matrix<T, CM, CN, Allocator>& a)
+	{
+		std::FILE *f = std::fopen(path, "rb");
+		if (!f) throw io_error(std::string("Failed to open ") + path);
+
+		char hbuf[internal::binary_header_size];
+		internal::binary_header h;
+
+		if (std::fread(hbuf, 1, sizeof(hbuf), f) != sizeof(hbuf) || !internal::decode_binary_header(hbuf, h))
+		{
+			std::fclose(f);
+			throw io_error(std::string(path) + ": not a matrix file");
+		}
+
+		if (h.dtype != internal::io_dtype<T>::code || h.elem_size != sizeof(T))
+		{
+			std::fclose(f);
+			throw io_error(std::string(path) + ": element type mismatch");
+		}
+
+		uint64_t nb64 = 0;
+		if (!internal::binary_data_size<T>(h, nb64))
+		{
+			std::fclose(f);
+			throw io_error(std::string(path) + ": invalid matrix shape");
+		}
+
+		uint64_t rb = 0;
+		if (!internal::remaining_bytes(f, rb))
+		{
+			std::fclose(f);
+			throw io_error(std::string("Failed to read ") + path);
+		}
+
+		if (rb != nb64)
+		{
+			std::fclose(f);
+			throw io_error(std::string(path) + (rb < nb64 ? ": truncated" : ": trailing data"));
+		}
+
+		a.require_size((index_t)h.nrows, (index_t)h.ncols);
+
+		const size_t nb = (size_t)nb64;
+		bool ok = nb == 0 || std::fread(a.ptr_data(), 1, nb, f) == nb;
+		std::fclose(f);
+
+		if (!ok) throw io_error(std::string(path) + ": truncated");
+	}
+
+}
+
+#endif /* LIGHTMAT_MATRIX_IO_H_ */
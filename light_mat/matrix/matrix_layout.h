@@ -24,6 +24,9 @@ namespace lmat
 	template<index_t M, index_t N> class block_layout_cm;
 	template<index_t M, index_t N> class grid_layout;
 
+	template<index_t M, index_t N> class cont_layout_rm;
+	template<index_t M, index_t N> class block_layout_rm;
+
 	/********************************************
 	 *
 	 *  Layout traits
@@ -40,6 +43,7 @@ namespace lmat
 
 		static const bool ct_is_contiguous = true;
 		static const bool ct_is_percol_contiguous = true;
+		static const bool ct_is_perrow_contiguous = (M == 1 || N == 1);
 
 		typedef matrix_shape<M, N> shape_type;
 	};
@@ -52,6 +56,7 @@ namespace lmat
 
 		static const bool ct_is_contiguous = (N == 1);
 		static const bool ct_is_percol_contiguous = true;
+		static const bool ct_is_perrow_contiguous = (N == 1);
 
 		typedef matrix_shape<M, N> shape_type;
 	};
@@ -64,6 +69,46 @@ namespace lmat
 
 		static const bool ct_is_contiguous = (M == 1 && N == 1);
 		static const bool ct_is_percol_contiguous = M == 1;
+		static const bool ct_is_perrow_contiguous = N == 1;
+
+		typedef matrix_shape<M, N> shape_type;
+	};
+
+	// row-major layouts:
+	// each row is contiguous, while the elements of a column are
+	// separated by the row stride (n or ldim). Note that linear
+	// indexing is still column-major, i.e. a row-major layout is
+	// contiguous (and per-column contiguous) only when it is a vector.
+	//
+	// Element-wise kernels (ewise, macc_evaluate) are written for
+	// column-major access. When the destination and all operands are
+	// row-major, expressions are evaluated on their trans_views (see
+	// macc_policy.h), as are the vector-wise reductions; otherwise a
+	// row-major matrix that is not a vector goes through the strided
+	// per-column path.
+
+	template<index_t M, index_t N>
+	struct layout_traits<cont_layout_rm<M, N> >
+	{
+		static const index_t ct_num_rows = M;
+		static const index_t ct_num_cols = N;
+
+		static const bool ct_is_contiguous = (M == 1 || N == 1);
+		static const bool ct_is_percol_contiguous = (M == 1 || N == 1);
+		static const bool ct_is_perrow_contiguous = true;
+
+		typedef matrix_shape<M, N> shape_type;
+	};
+
+	template<index_t M, index_t N>
+	struct layout_traits<block_layout_rm<M, N> >
+	{
+		static const index_t ct_num_rows = M;
+		static const index_t ct_num_cols = N;
+
+		static const bool ct_is_contiguous = (M == 1);
+		static const bool ct_is_percol_contiguous = (M == 1);
+		static const bool ct_is_perrow_contiguous = true;
 
 		typedef matrix_shape<M, N> shape_type;
 	};
@@ -390,7 +435,7 @@ namespace lmat
 		LMAT_ENSURE_INLINE
 		bool is_percol_contiguous() const
 		{
-			return m_rowstride() == 1;
+			return m_rowstride == 1;
 		}
 
 		LMAT_ENSURE_INLINE
@@ -424,6 +469,181 @@ namespace lmat
 	};
 
 
+	template<index_t M, index_t N>
+	class cont_layout_rm : public IMatrixLayout<cont_layout_rm<M, N> >
+	{
+	public:
+		LMAT_ENSURE_INLINE
+		cont_layout_rm() : m_shape() { }
+
+		LMAT_ENSURE_INLINE
+		cont_layout_rm(index_t m, index_t n) : m_shape(m, n) { };
+
+	public:
+		LMAT_ENSURE_INLINE
+		index_t nrows() const
+		{
+			return m_shape.nrows();
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t ncolumns() const
+		{
+			return m_shape.ncolumns();
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t nelems() const
+		{
+			return m_shape.nelems();
+		}
+
+		LMAT_ENSURE_INLINE
+		matrix_shape<M, N> shape() const
+		{
+			return m_shape;
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t row_stride() const
+		{
+			return m_shape.ncolumns();
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t col_stride() const
+		{
+			return 1;
+		}
+
+		LMAT_ENSURE_INLINE
+		bool is_contiguous() const
+		{
+			return nrows() == 1 || ncolumns() == 1;
+		}
+
+		LMAT_ENSURE_INLINE
+		bool is_percol_contiguous() const
+		{
+			return nrows() == 1 || ncolumns() == 1;
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t offset(index_t i, index_t j) const
+		{
+			return internal::block_rm_sub2offset(m_shape, i, j, m_shape.ncolumns());
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t col_offset(index_t j) const
+		{
+			return j;
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t row_offset(index_t i) const
+		{
+			return m_shape.ncolumns() * i;
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t lin_offset(index_t i) const
+		{
+			return internal::block_rm_linoffset(m_shape, i, m_shape.ncolumns());
+		}
+
+	private:
+		matrix_shape<M, N> m_shape;
+	};
+
+
+	template<index_t M, index_t N>
+	class block_layout_rm : public IMatrixLayout<block_layout_rm<M, N> >
+	{
+	public:
+		LMAT_ENSURE_INLINE
+		block_layout_rm(index_t m, index_t n, index_t ldim) : m_shape(m, n), m_leaddim(ldim) { };
+
+	public:
+		LMAT_ENSURE_INLINE
+		index_t nrows() const
+		{
+			return m_shape.nrows();
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t ncolumns() const
+		{
+			return m_shape.ncolumns();
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t nelems() const
+		{
+			return m_shape.nelems();
+		}
+
+		LMAT_ENSURE_INLINE
+		matrix_shape<M, N> shape() const
+		{
+			return m_shape;
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t row_stride() const
+		{
+			return m_leaddim;
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t col_stride() const
+		{
+			return 1;
+		}
+
+		LMAT_ENSURE_INLINE
+		bool is_contiguous() const
+		{
+			return nrows() == 1 || (ncolumns() == 1 && m_leaddim == 1);
+		}
+
+		LMAT_ENSURE_INLINE
+		bool is_percol_contiguous() const
+		{
+			return nrows() == 1 || m_leaddim == 1;
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t offset(index_t i, index_t j) const
+		{
+			return internal::block_rm_sub2offset(m_shape, i, j, m_leaddim);
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t col_offset(index_t j) const
+		{
+			return j;
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t row_offset(index_t i) const
+		{
+			return m_leaddim * i;
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t lin_offset(index_t i) const
+		{
+			return internal::block_rm_linoffset(m_shape, i, m_leaddim);
+		}
+
+	private:
+		matrix_shape<M, N> m_shape;
+		index_t m_leaddim;
+	};
+
+
+
 }
 
 #endif /* MATRIX_LAYOUT_H_ */
@@ -297,6 +297,13 @@ namespace lmat { namespace meta {
 		static const bool value = layout_traits<layout_type>::ct_is_percol_contiguous;
 	};
 
+	template<class Mat>
+	struct is_perrow_contiguous
+	{
+		typedef typename matrix_traits<Mat>::layout_type layout_type;
+		static const bool value = layout_traits<layout_type>::ct_is_perrow_contiguous;
+	};
+
 
 	template<typename... Mat> struct contiguousness;
 
@@ -14,6 +14,7 @@
 #define LIGHTMAT_MATRIX_TRANSPOSE_H_
 
 #include "internal/matrix_transpose_internal.h"
+#include <light_mat/dispatch/dispatch_route.h>
 
 namespace lmat
 {
@@ -31,6 +32,7 @@ namespace lmat
 		index_t n = smat.ncolumns();
 
 		LMAT_CHECK_DIMS( dmat.nrows() == n && dmat.ncolumns() == m );
+		LMAT_DISPATCH_ROUTE( transpose, smat.derived(), dmat.derived() )
 
 		internal::direct_transpose(m, n, smat, dmat);
 	}
@@ -60,6 +60,12 @@ namespace lmat
 		{
 		}
 
+		LMAT_ENSURE_INLINE
+		cref_block(const cref_block& s)
+		: m_data(s.m_data), m_layout(s.m_layout)
+		{
+		}
+
 	private:
 		cref_block& operator = (const cref_block& );  // no assignment
 
@@ -99,6 +105,12 @@ namespace lmat
 		{
 		}
 
+		LMAT_ENSURE_INLINE
+		ref_block(const ref_block& s)
+		: m_data(s.m_data), m_layout(s.m_layout)
+		{
+		}
+
 	public:
 		LMAT_ENSURE_INLINE ref_block& operator = (const ref_block& r)
 		{
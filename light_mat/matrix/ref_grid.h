@@ -60,6 +60,12 @@ namespace lmat
 		{
 		}
 
+		LMAT_ENSURE_INLINE
+		cref_grid(const cref_grid& s)
+		: m_data(s.m_data), m_layout(s.m_layout)
+		{
+		}
+
 	private:
 		cref_grid& operator = (const cref_grid& );  // no assignment
 
@@ -97,6 +103,12 @@ namespace lmat
 		{
 		}
 
+		LMAT_ENSURE_INLINE
+		ref_grid(const ref_grid& s)
+		: m_data(s.m_data), m_layout(s.m_layout)
+		{
+		}
+
 	public:
 		LMAT_ENSURE_INLINE ref_grid& operator = (const ref_grid& r)
 		{
@@ -60,6 +60,12 @@ namespace lmat
 		{
 		}
 
+		LMAT_ENSURE_INLINE
+		cref_matrix(const cref_matrix& s)
+		: m_data(s.m_data), m_layout(s.m_layout)
+		{
+		}
+
 	private:
 		cref_matrix& operator = (const cref_matrix& );  // no assignment
 
@@ -97,6 +103,12 @@ namespace lmat
 		{
 		}
 
+		LMAT_ENSURE_INLINE
+		ref_matrix(const ref_matrix& s)
+		: m_data(s.m_data), m_layout(s.m_layout)
+		{
+		}
+
 	public:
 		LMAT_ENSURE_INLINE ref_matrix& operator = (const ref_matrix& r)
 		{
@@ -0,0 +1,413 @@
+/**
+ * @file ref_matrix_rm.h
+ *
+ * Row-major views: cref_matrix_rm, ref_matrix_rm, cref_block_rm, and ref_block_rm
+ *
+ * These classes wrap C-ordered (row-major) buffers, e.g. those
+ * coming from NumPy or plain C arrays, without copying.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_REF_MATRIX_RM_H_
+#define LIGHTMAT_REF_MATRIX_RM_H_
+
+#include <light_mat/matrix/ref_matrix.h>
+#include <light_mat/matrix/ref_block.h>
+#include <utility>
+
+namespace lmat
+{
+
+	/********************************************
+	 *
+	 *  matrix traits
+	 *
+	 ********************************************/
+
+	template<typename T, index_t CM, index_t CN>
+	struct matrix_traits<cref_matrix_rm<T, CM, CN> >
+	: public regular_matrix_traits_base<const T, CM, CN, cpu_domain>
+	{
+		typedef cont_layout_rm<CM, CN> layout_type;
+	};
+
+	template<typename T, index_t CM, index_t CN>
+	struct matrix_traits<ref_matrix_rm<T, CM, CN> >
+	: public regular_matrix_traits_base<T, CM, CN, cpu_domain>
+	{
+		typedef cont_layout_rm<CM, CN> layout_type;
+	};
+
+	template<typename T, index_t CM, index_t CN>
+	struct matrix_traits<cref_block_rm<T, CM, CN> >
+	: public regular_matrix_traits_base<const T, CM, CN, cpu_domain>
+	{
+		typedef block_layout_rm<CM, CN> layout_type;
+	};
+
+	template<typename T, index_t CM, index_t CN>
+	struct matrix_traits<ref_block_rm<T, CM, CN> >
+	: public regular_matrix_traits_base<T, CM, CN, cpu_domain>
+	{
+		typedef block_layout_rm<CM, CN> layout_type;
+	};
+
+
+	/********************************************
+	 *
+	 *  contiguous row-major views
+	 *
+	 ********************************************/
+
+	template<typename T, index_t CM, index_t CN>
+	class cref_matrix_rm : public regular_mat_base<cref_matrix_rm<T, CM, CN> >
+	{
+	public:
+		LMAT_DEFINE_REGMAT_TYPES(const T)
+		typedef cont_layout_rm<CM, CN> layout_type;
+
+	public:
+		LMAT_ENSURE_INLINE
+		cref_matrix_rm(const T* pdata, index_t m, index_t n)
+		: m_data(pdata), m_layout(m, n)
+		{
+		}
+
+		LMAT_ENSURE_INLINE
+		cref_matrix_rm(const cref_matrix_rm& s)
+		: m_data(s.m_data), m_layout(s.m_layout)
+		{
+		}
+
+	private:
+		cref_matrix_rm& operator = (const cref_matrix_rm& );  // no assignment
+
+	public:
+		LMAT_ENSURE_INLINE const layout_type& layout() const
+		{
+			return m_layout;
+		}
+
+		LMAT_ENSURE_INLINE const_pointer ptr_data() const
+		{
+			return m_data;
+		}
+
+		LMAT_DEFINE_NO_RESIZE( cref_matrix_rm )
+
+	private:
+		const T *m_data;
+		layout_type m_layout;
+
+	}; // end class cref_matrix_rm
+
+
+	template<typename T, index_t CM, index_t CN>
+	class ref_matrix_rm : public regular_mat_base<ref_matrix_rm<T, CM, CN> >
+	{
+	public:
+		LMAT_DEFINE_REGMAT_TYPES(T)
+		typedef cont_layout_rm<CM, CN> layout_type;
+
+	public:
+		LMAT_ENSURE_INLINE
+		ref_matrix_rm(T* pdata, index_t m, index_t n)
+		: m_data(pdata), m_layout(m, n)
+		{
+		}
+
+		LMAT_ENSURE_INLINE
+		ref_matrix_rm(const ref_matrix_rm& s)
+		: m_data(s.m_data), m_layout(s.m_layout)
+		{
+		}
+
+	public:
+		LMAT_ENSURE_INLINE ref_matrix_rm& operator = (const ref_matrix_rm& r)
+		{
+			if (this != &r)
+			{
+				copy(r, *this);
+			}
+			return *this;
+		}
+
+		template<class Expr>
+		LMAT_ENSURE_INLINE ref_matrix_rm& operator = (const IMatrixXpr<Expr, T>& r)
+		{
+			evaluate(r.derived(), *this);
+			return *this;
+		}
+
+	public:
+		LMAT_ENSURE_INLINE const layout_type& layout() const
+		{
+			return m_layout;
+		}
+
+		LMAT_ENSURE_INLINE const_pointer ptr_data() const
+		{
+			return m_data;
+		}
+
+		LMAT_ENSURE_INLINE pointer ptr_data()
+		{
+			return m_data;
+		}
+
+		LMAT_DEFINE_NO_RESIZE( ref_matrix_rm )
+
+	private:
+		T *m_data;
+		layout_type m_layout;
+
+	}; // end ref_matrix_rm
+
+
+	/********************************************
+	 *
+	 *  row-major block views
+	 *
+	 *  ldim: the distance between the beginnings
+	 *        of two consecutive rows
+	 *
+	 ********************************************/
+
+	template<typename T, index_t CM, index_t CN>
+	class cref_block_rm : public regular_mat_base<cref_block_rm<T, CM, CN> >
+	{
+	public:
+		LMAT_DEFINE_REGMAT_TYPES(const T)
+		typedef block_layout_rm<CM, CN> layout_type;
+
+	public:
+		LMAT_ENSURE_INLINE
+		cref_block_rm(const T* pdata, index_t m, index_t n, index_t ldim)
+		: m_data(pdata), m_layout(m, n, ldim)
+		{
+		}
+
+		LMAT_ENSURE_INLINE
+		cref_block_rm(const cref_block_rm& s)
+		: m_data(s.m_data), m_layout(s.m_layout)
+		{
+		}
+
+	private:
+		cref_block_rm& operator = (const cref_block_rm& );  // no assignment
+
+	public:
+		LMAT_ENSURE_INLINE const layout_type& layout() const
+		{
+			return m_layout;
+		}
+
+		LMAT_ENSURE_INLINE const_pointer ptr_data() const
+		{
+			return m_data;
+		}
+
+		LMAT_DEFINE_NO_RESIZE( cref_block_rm )
+
+	private:
+		const T *m_data;
+		layout_type m_layout;
+
+	}; // end class cref_block_rm
+
+
+	template<typename T, index_t CM, index_t CN>
+	class ref_block_rm : public regular_mat_base<ref_block_rm<T, CM, CN> >
+	{
+	public:
+		LMAT_DEFINE_REGMAT_TYPES(T)
+		typedef block_layout_rm<CM, CN> layout_type;
+
+	public:
+		LMAT_ENSURE_INLINE
+		ref_block_rm(T* pdata, index_t m, index_t n, index_t ldim)
+		: m_data(pdata), m_layout(m, n, ldim)
+		{
+		}
+
+		LMAT_ENSURE_INLINE
+		ref_block_rm(const ref_block_rm& s)
+		: m_data(s.m_data), m_layout(s.m_layout)
+		{
+		}
+
+	public:
+		LMAT_ENSURE_INLINE ref_block_rm& operator = (const ref_block_rm& r)
+		{
+			if (this != &r)
+			{
+				copy(r, *this);
+			}
+			return *this;
+		}
+
+		template<class Expr>
+		LMAT_ENSURE_INLINE ref_block_rm& operator = (const IMatrixXpr<Expr, T>& r)
+		{
+			evaluate(r.derived(), *this);
+			return *this;
+		}
+
+	public:
+		LMAT_ENSURE_INLINE const layout_type& layout() const
+		{
+			return m_layout;
+		}
+
+		LMAT_ENSURE_INLINE const_pointer ptr_data() const
+		{
+			return m_data;
+		}
+
+		LMAT_ENSURE_INLINE pointer ptr_data()
+		{
+			return m_data;
+		}
+
+		LMAT_DEFINE_NO_RESIZE( ref_block_rm )
+
+	private:
+		T *m_data;
+		layout_type m_layout;
+
+	}; // end ref_block_rm
+
+
+	/********************************************
+	 *
+	 *  transposed views
+	 *
+	 *  The transpose of a per-row contiguous
+	 *  matrix is a column-major block over the
+	 *  same memory, with ldim = row_stride, and
+	 *  that of a contiguous row-major matrix is
+	 *  a contiguous column-major matrix.
+	 *
+	 *  A non-const ref view gives a writable
+	 *  transposed view.
+	 *
+	 ********************************************/
+
+	template<typename T, class Mat>
+	LMAT_ENSURE_INLINE
+	inline cref_block<T, meta::ncols<Mat>::value, meta::nrows<Mat>::value>
+	trans_view(const IRegularMatrix<Mat, T>& a)
+	{
+		static_assert(meta::is_perrow_contiguous<Mat>::value, "a must be perrow contiguous.");
+
+		typedef cref_block<T, meta::ncols<Mat>::value, meta::nrows<Mat>::value> type;
+		return type(a.ptr_data(), a.ncolumns(), a.nrows(), a.row_stride());
+	}
+
+	template<typename T, index_t CM, index_t CN>
+	LMAT_ENSURE_INLINE
+	inline cref_matrix<T, CN, CM> trans_view(const cref_matrix_rm<T, CM, CN>& a)
+	{
+		return cref_matrix<T, CN, CM>(a.ptr_data(), a.ncolumns(), a.nrows());
+	}
+
+	template<typename T, index_t CM, index_t CN>
+	LMAT_ENSURE_INLINE
+	inline cref_matrix<T, CN, CM> trans_view(const ref_matrix_rm<T, CM, CN>& a)
+	{
+		return cref_matrix<T, CN, CM>(a.ptr_data(), a.ncolumns(), a.nrows());
+	}
+
+	template<typename T, index_t CM, index_t CN>
+	LMAT_ENSURE_INLINE
+	inline ref_matrix<T, CN, CM> trans_view(ref_matrix_rm<T, CM, CN>& a)
+	{
+		return ref_matrix<T, CN, CM>(a.ptr_data(), a.ncolumns(), a.nrows());
+	}
+
+	template<typename T, index_t CM, index_t CN>
+	LMAT_ENSURE_INLINE
+	inline ref_block<T, CN, CM> trans_view(ref_block_rm<T, CM, CN>& a)
+	{
+		return ref_block<T, CN, CM>(a.ptr_data(), a.ncolumns(), a.nrows(), a.row_stride());
+	}
+
+
+	/********************************************
+	 *
+	 *  Transposes of the leaves
+	 *
+	 *  An all-row-major expression is evaluated
+	 *  on its transpose (see macc_policy.h).
+	 *  Here, the transposes of the leaves are
+	 *  defined: a scalar is kept, and a row-major
+	 *  matrix becomes its trans_view. Expressions
+	 *  specialize rowmajor_transpose (see
+	 *  map_expr.h).
+	 *
+	 ********************************************/
+
+	namespace internal
+	{
+		template<class A, bool IsMat=meta::is_mat_xpr<A>::value>
+		class _rm_leaf_transpose  // a scalar
+		{
+		public:
+			typedef A type;
+
+			LMAT_ENSURE_INLINE
+			explicit _rm_leaf_transpose(const A& a) : m_arg(a) { }
+
+			LMAT_ENSURE_INLINE const type& get() const
+			{
+				return m_arg;
+			}
+
+		private:
+			const A& m_arg;
+		};
+
+		template<class A>
+		class _rm_leaf_transpose<A, true>
+		{
+		public:
+			typedef decltype(trans_view(std::declval<const A&>())) type;
+
+			LMAT_ENSURE_INLINE
+			explicit _rm_leaf_transpose(const A& a) : m_view(trans_view(a)) { }
+
+			LMAT_ENSURE_INLINE const type& get() const
+			{
+				return m_view;
+			}
+
+		private:
+			type m_view;
+		};
+	}
+
+	template<class Expr>
+	class rowmajor_transpose
+	: public internal::_rm_leaf_transpose<Expr>
+	{
+		typedef internal::_rm_leaf_transpose<Expr> base_t;
+
+	public:
+		LMAT_ENSURE_INLINE
+		explicit rowmajor_transpose(const Expr& e) : base_t(e) { }
+	};
+
+	template<class Dst>
+	struct rowmajor_dest_transpose
+	{
+		typedef decltype(trans_view(std::declval<Dst&>())) type;
+	};
+
+}
+
+#endif
@@ -0,0 +1,302 @@
+/**
+ * @file counter_stream.h
+ *
+ * @brief Counter-based random streams
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_COUNTER_STREAM_H_
+#define LIGHTMAT_COUNTER_STREAM_H_
+
+#include <light_mat/random/rand_stream.h>
+#include <light_mat/random/stream_tracker.h>
+
+#include "internal/rand_stream_internal.h"
+
+namespace lmat { namespace random {
+
+	/********************************************
+	 *
+	 *  counter_state
+	 *
+	 *  Each block of four 32-bit units is
+	 *  obtained by applying a keyed bijection
+	 *  (the Engine) to a 128-bit counter
+	 *
+	 *    (pos_lo, pos_hi, sid_lo, sid_hi)
+	 *
+	 *  where pos is the block index and sid
+	 *  is the stream id. Blocks are generated
+	 *  in batches of four (one per SIMD lane).
+	 *
+	 ********************************************/
+
+	template<class Engine>
+	class counter_state
+	{
+	public:
+		static const unsigned int block_units = 4;
+		static const unsigned int batch_blocks = 4;
+		static const unsigned int batch_units = block_units * batch_blocks;
+
+		LMAT_ENSURE_INLINE
+		counter_state(uint64_t seed, uint64_t sid)
+		: m_engine(seed), m_next(0), m_sid(sid) { }
+
+		LMAT_ENSURE_INLINE
+		const Engine& engine() const
+		{
+			return m_engine;
+		}
+
+		LMAT_ENSURE_INLINE
+		void set_seed(uint64_t seed)
+		{
+			m_engine.set_seed(seed);
+		}
+
+		LMAT_ENSURE_INLINE
+		uint64_t stream_id() const
+		{
+			return m_sid;
+		}
+
+		LMAT_ENSURE_INLINE
+		void set_stream_id(uint64_t sid)
+		{
+			m_sid = sid;
+		}
+
+		LMAT_ENSURE_INLINE
+		uint64_t next_block() const  // the index of the first block of the next batch
+		{
+			return m_next;
+		}
+
+		LMAT_ENSURE_INLINE
+		void set_next_block(uint64_t b)
+		{
+			m_next = b;
+		}
+
+		LMAT_ENSURE_INLINE
+		void next()
+		{
+			m_engine.generate4(m_next, m_sid, m_buf);
+			m_next += batch_blocks;
+		}
+
+		LMAT_ENSURE_INLINE
+		const uint32_t* ptr_base() const
+		{
+			return m_buf;
+		}
+
+		LMAT_ENSURE_INLINE
+		__m128i pack(size_t offset) const  // offset must be multiples of four
+		{
+			return _mm_load_si128(reinterpret_cast<const __m128i*>(m_buf + offset));
+		}
+
+#ifdef LMAT_HAS_AVX
+		LMAT_ENSURE_INLINE
+		__m256i avx_pack(size_t offset) const  // offset must be multiples of eight
+		{
+			return _mm256_load_si256(reinterpret_cast<const __m256i*>(m_buf + offset));
+		}
+#endif
+
+		LMAT_ENSURE_INLINE
+		uint64_t u64(size_t offset) const // offset must be multiples of two
+		{
+			return *(reinterpret_cast<const uint64_t*>(m_buf + offset));
+		}
+
+		LMAT_ENSURE_INLINE
+		uint32_t u32(size_t offset) const
+		{
+			return m_buf[offset];
+		}
+
+	private:
+		LMAT_ALIGN(32) uint32_t m_buf[batch_units];
+		Engine m_engine;
+		uint64_t m_next;
+		uint64_t m_sid;
+	};
+
+
+	/********************************************
+	 *
+	 *  counter_rand_stream
+	 *
+	 ********************************************/
+
+	template<class Engine>
+	struct rand_stream_traits<counter_rand_stream<Engine> >
+	{
+		typedef uint64_t seed_type;
+	};
+
+
+	template<class Engine>
+	class counter_rand_stream : public IRandStream<counter_rand_stream<Engine> >
+	{
+		typedef counter_state<Engine> state_t;
+		static const unsigned int BU = state_t::batch_units;
+
+	public:
+		typedef uint64_t seed_type;
+		typedef Engine engine_type;
+
+		LMAT_ENSURE_INLINE
+		explicit counter_rand_stream(uint64_t seed=1234, uint64_t sid=0)
+		: m_intern(seed, sid), m_tracker(BU) { }
+
+		LMAT_ENSURE_INLINE
+		counter_rand_stream(const counter_rand_stream& r)
+		: m_intern(r.m_intern), m_tracker(BU)
+		{
+			m_tracker.set_offset(r.m_tracker.offset());
+		}
+
+		LMAT_ENSURE_INLINE
+		counter_rand_stream& operator = (const counter_rand_stream& r)
+		{
+			m_intern = r.m_intern;
+			m_tracker.set_offset(r.m_tracker.offset());
+			return *this;
+		}
+
+		LMAT_ENSURE_INLINE
+		const Engine& engine() const
+		{
+			return m_intern.engine();
+		}
+
+	public:
+		LMAT_ENSURE_INLINE
+		void set_seed(const seed_type& seed)
+		{
+			m_intern.set_seed(seed);
+			seek(0);
+		}
+
+		LMAT_ENSURE_INLINE
+		size_t state_size() const  // in terms of bytes
+		{
+			return Engine::key_bytes + 16;  // key + counter
+		}
+
+		LMAT_ENSURE_INLINE
+		uint64_t stream_id() const
+		{
+			return m_intern.stream_id();
+		}
+
+		LMAT_ENSURE_INLINE
+		void set_stream_id(uint64_t sid)  // switch to an independent stream, and rewind
+		{
+			m_intern.set_stream_id(sid);
+			seek(0);
+		}
+
+		LMAT_ENSURE_INLINE
+		uint64_t position() const  // in terms of 32-bit units
+		{
+			return m_intern.next_block() * state_t::block_units - BU + m_tracker.offset();
+		}
+
+		void seek(uint64_t pos)  // in terms of 32-bit units
+		{
+			const uint64_t b = (pos / BU) * state_t::batch_blocks;
+			const size_t r = (size_t)(pos % BU);
+
+			m_intern.set_next_block(b);
+
+			if (r)
+			{
+				m_intern.next();
+				m_tracker.set_offset(r);
+			}
+			else
+			{
+				m_tracker.set_end();
+			}
+		}
+
+		LMAT_ENSURE_INLINE
+		void discard(uint64_t n)  // in terms of 32-bit units
+		{
+			seek(position() + n);
+		}
+
+		LMAT_ENSURE_INLINE uint32_t rand_u32()
+		{
+			check_end();
+			uint32_t x = m_intern.u32(m_tracker.offset());
+			m_tracker.forward(1);
+			return x;
+		}
+
+		LMAT_ENSURE_INLINE uint64_t rand_u64()
+		{
+			m_tracker.to_boundary(bdtags::dbl());
+
+			check_end();
+			uint64_t x = m_intern.u64(m_tracker.offset());
+			m_tracker.forward(2);
+			return x;
+		}
+
+		LMAT_ENSURE_INLINE __m128i rand_pack(sse_t)
+		{
+			m_tracker.to_boundary(bdtags::quad());
+
+			check_end();
+			__m128i u = m_intern.pack(m_tracker.offset());
+			m_tracker.forward(4);
+			return u;
+		}
+
+#ifdef LMAT_HAS_AVX
+		LMAT_ENSURE_INLINE __m256i rand_pack(avx_t)
+		{
+			m_tracker.to_boundary(bdtags::oct());
+
+			check_end();
+			__m256i u = m_intern.avx_pack(m_tracker.offset());
+			m_tracker.forward(8);
+			return u;
+		}
+#endif
+
+		LMAT_ENSURE_INLINE void rand_seq(size_t nbytes, void *buf)
+		{
+			internal::gen_rand_seq(m_intern, m_tracker, buf, nbytes);
+		}
+
+	private:
+		LMAT_ENSURE_INLINE
+		void check_end()
+		{
+			if (m_tracker.is_end())
+			{
+				m_intern.next();
+				m_tracker.rewind();
+			}
+		}
+
+	private:
+		state_t m_intern;
+		stream_tracker<uint32_t> m_tracker;
+	};
+
+} }
+
+#endif
@@ -71,6 +71,40 @@ namespace lmat { namespace random { namespace internal {
 		}
 	}
 
+
+	// transpose four 4-lane packs in place:
+	// from lane-per-block layout to block-per-pack layout
+
+	LMAT_ENSURE_INLINE
+	inline void transpose4_epi32(__m128i& x0, __m128i& x1, __m128i& x2, __m128i& x3)
+	{
+		__m128i t0 = _mm_unpacklo_epi32(x0, x1);
+		__m128i t1 = _mm_unpacklo_epi32(x2, x3);
+		__m128i t2 = _mm_unpackhi_epi32(x0, x1);
+		__m128i t3 = _mm_unpackhi_epi32(x2, x3);
+
+		x0 = _mm_unpacklo_epi64(t0, t1);
+		x1 = _mm_unpackhi_epi64(t0, t1);
+		x2 = _mm_unpacklo_epi64(t2, t3);
+		x3 = _mm_unpackhi_epi64(t2, t3);
+	}
+
+	// rotate each 32-bit lane to the left by R bits
+
+	template<int R>
+	LMAT_ENSURE_INLINE
+	inline __m128i rotl_epi32(__m128i x)
+	{
+		return _mm_or_si128(_mm_slli_epi32(x, R), _mm_srli_epi32(x, 32 - R));
+	}
+
+	template<int R>
+	LMAT_ENSURE_INLINE
+	inline uint32_t rotl_u32(uint32_t x)
+	{
+		return (x << R) | (x >> (32 - R));
+	}
+
 } } }
 
 #endif /* RAND_STREAM_INTERNAL_H_ */
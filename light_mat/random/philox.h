@@ -0,0 +1,166 @@
+/**
+ * @file philox.h
+ *
+ * @brief Philox-4x32-10 counter-based random stream
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_PHILOX_H_
+#define LIGHTMAT_PHILOX_H_
+
+#include <light_mat/random/counter_stream.h>
+
+namespace lmat { namespace random {
+
+	/********************************************
+	 *
+	 *  philox4x32_engine
+	 *
+	 *  Salmon et al., Parallel random numbers:
+	 *  as easy as 1, 2, 3. SC'11.
+	 *
+	 ********************************************/
+
+	class philox4x32_engine
+	{
+	public:
+		static const unsigned int key_units = 2;
+		static const unsigned int key_bytes = key_units * 4;
+		static const unsigned int num_rounds = 10;
+
+		static const uint32_t M0 = 0xD2511F53;
+		static const uint32_t M1 = 0xCD9E8D57;
+		static const uint32_t W0 = 0x9E3779B9;
+		static const uint32_t W1 = 0xBB67AE85;
+
+		LMAT_ENSURE_INLINE
+		explicit philox4x32_engine(uint64_t seed)
+		{
+			set_seed(seed);
+		}
+
+		LMAT_ENSURE_INLINE
+		void set_seed(uint64_t seed)
+		{
+			m_key[0] = (uint32_t)(seed);
+			m_key[1] = (uint32_t)(seed >> 32);
+		}
+
+		LMAT_ENSURE_INLINE
+		void set_key(const uint32_t *key)
+		{
+			m_key[0] = key[0];
+			m_key[1] = key[1];
+		}
+
+		LMAT_ENSURE_INLINE
+		const uint32_t* key() const
+		{
+			return m_key;
+		}
+
+		// scalar version: one block
+
+		void block(const uint32_t *ctr, uint32_t *out) const
+		{
+			uint32_t x0 = ctr[0], x1 = ctr[1], x2 = ctr[2], x3 = ctr[3];
+			uint32_t k0 = m_key[0], k1 = m_key[1];
+
+			for (unsigned int r = 0; r < num_rounds; ++r)
+			{
+				if (r > 0) { k0 += W0; k1 += W1; }
+
+				uint64_t p0 = (uint64_t)M0 * x0;
+				uint64_t p1 = (uint64_t)M1 * x2;
+
+				uint32_t y0 = (uint32_t)(p1 >> 32) ^ x1 ^ k0;
+				uint32_t y2 = (uint32_t)(p0 >> 32) ^ x3 ^ k1;
+
+				x1 = (uint32_t)p1;
+				x3 = (uint32_t)p0;
+				x0 = y0;
+				x2 = y2;
+			}
+
+			out[0] = x0; out[1] = x1; out[2] = x2; out[3] = x3;
+		}
+
+		// SIMD version: four consecutive blocks (one per lane)
+
+		LMAT_ENSURE_INLINE
+		void generate4(uint64_t pos, uint64_t sid, uint32_t *out) const  // out must be 16-byte aligned
+		{
+			__m128i x0 = _mm_set_epi32(
+					(int)(uint32_t)(pos + 3), (int)(uint32_t)(pos + 2),
+					(int)(uint32_t)(pos + 1), (int)(uint32_t)(pos));
+			__m128i x1 = _mm_set_epi32(
+					(int)(uint32_t)((pos + 3) >> 32), (int)(uint32_t)((pos + 2) >> 32),
+					(int)(uint32_t)((pos + 1) >> 32), (int)(uint32_t)(pos >> 32));
+			__m128i x2 = _mm_set1_epi32((int)(uint32_t)sid);
+			__m128i x3 = _mm_set1_epi32((int)(uint32_t)(sid >> 32));
+
+			__m128i k0 = _mm_set1_epi32((int)m_key[0]);
+			__m128i k1 = _mm_set1_epi32((int)m_key[1]);
+
+			const __m128i m0 = _mm_set1_epi32((int)M0);
+			const __m128i m1 = _mm_set1_epi32((int)M1);
+			const __m128i w0 = _mm_set1_epi32((int)W0);
+			const __m128i w1 = _mm_set1_epi32((int)W1);
+
+			for (unsigned int r = 0; r < num_rounds; ++r)
+			{
+				if (r > 0)
+				{
+					k0 = _mm_add_epi32(k0, w0);
+					k1 = _mm_add_epi32(k1, w1);
+				}
+
+				__m128i hi0, lo0, hi1, lo1;
+				mulhilo(x0, m0, hi0, lo0);
+				mulhilo(x2, m1, hi1, lo1);
+
+				x0 = _mm_xor_si128(_mm_xor_si128(hi1, x1), k0);
+				x2 = _mm_xor_si128(_mm_xor_si128(hi0, x3), k1);
+				x1 = lo1;
+				x3 = lo0;
+			}
+
+			internal::transpose4_epi32(x0, x1, x2, x3);
+
+			__m128i *p = reinterpret_cast<__m128i*>(out);
+			_mm_store_si128(p,     x0);
+			_mm_store_si128(p + 1, x1);
+			_mm_store_si128(p + 2, x2);
+			_mm_store_si128(p + 3, x3);
+		}
+
+	private:
+		LMAT_ENSURE_INLINE
+		static void mulhilo(__m128i a, __m128i m, __m128i& hi, __m128i& lo)
+		{
+			// _mm_mul_epu32 only multiplies lanes 0 and 2
+
+			__m128i p02 = _mm_mul_epu32(a, m);
+			__m128i p13 = _mm_mul_epu32(_mm_srli_epi64(a, 32), m);
+
+			lo = _mm_unpacklo_epi32(
+					_mm_shuffle_epi32(p02, _MM_SHUFFLE(0, 0, 2, 0)),
+					_mm_shuffle_epi32(p13, _MM_SHUFFLE(0, 0, 2, 0)));
+
+			hi = _mm_unpacklo_epi32(
+					_mm_shuffle_epi32(p02, _MM_SHUFFLE(0, 0, 3, 1)),
+					_mm_shuffle_epi32(p13, _MM_SHUFFLE(0, 0, 3, 1)));
+		}
+
+	private:
+		uint32_t m_key[key_units];
+	};
+
+} }
+
+#endif
@@ -23,6 +23,7 @@
 #include <light_mat/random/exponential_distr.h>
 #include <light_mat/random/normal_distr.h>
 #include <light_mat/random/gamma_distr.h>
+#include <light_mat/dispatch/dispatch_route.h>
 
 namespace lmat
 {
@@ -256,14 +257,70 @@ namespace lmat
 		static const bool value = is_simdizable<Distr, Kind>::value;
 	};
 
+	namespace internal
+	{
+		// each column is generated from a disjoint window of the stream
+		// (of length rand_column_span units), which does not depend on
+		// the number of units actually consumed by the preceding columns.
+		// Hence, columns can be generated independently (and in parallel),
+		// yielding the same result regardless of the evaluation order.
+
+		const uint64_t rand_column_span = uint64_t(1) << 36;  // in terms of 32-bit units
+
+		template<class Distr, class RStream, index_t CM, index_t CN, class DMat>
+		inline void counter_rand_evaluate(const rand_expr<Distr, RStream, CM, CN>& sexpr, DMat& dmat)
+		{
+			typedef typename Distr::result_type T;
+			typedef rand_expr<Distr, RStream, CM, CN> expr_t;
+			typedef typename preferred_macc_policy<matrix_shape<CM, 1>,
+					copy_kernel<T>, expr_t, DMat>::unit U;
+
+			dimension<CM> coldim(dmat.nrows());
+			const index_t n = dmat.ncolumns();
+
+			RStream& rs = sexpr.stream();
+			const uint64_t p0 = rs.position();
+
+			auto wt = make_multicol_accessor(U(), out_(dmat));
+			const Distr& distr = sexpr.distr();
+
+#ifdef _OPENMP
+#pragma omp parallel for if (dmat.nelems() >= 16384)
+#endif
+			for (index_t j = 0; j < n; ++j)
+			{
+				RStream rs_j(rs);
+				rs_j.seek(p0 + (uint64_t)j * rand_column_span);
+
+				_linear_ewise_eval(coldim, U(), copy_kernel<T>(),
+						rand_vec_reader<RStream, Distr, U>(rs_j, distr), wt.col(j));
+			}
+
+			rs.seek(p0 + (uint64_t)n * rand_column_span);
+		}
+	}
+
 	template<class Distr, class RStream, index_t CM, index_t CN, class DMat>
 	LMAT_ENSURE_INLINE
-	inline void evaluate(const rand_expr<Distr, RStream, CM, CN>& sexpr,
+	inline typename std::enable_if<!random::is_counter_based_stream<RStream>::value, void>::type
+	evaluate(const rand_expr<Distr, RStream, CM, CN>& sexpr,
 			IRegularMatrix<DMat, typename Distr::result_type>& dmat)
 	{
 		macc_evaluate(sexpr, dmat);
 	}
 
+	template<class Distr, class RStream, index_t CM, index_t CN, class DMat>
+	LMAT_ENSURE_INLINE
+	inline typename std::enable_if<random::is_counter_based_stream<RStream>::value, void>::type
+	evaluate(const rand_expr<Distr, RStream, CM, CN>& sexpr,
+			IRegularMatrix<DMat, typename Distr::result_type>& dmat)
+	{
+		LMAT_DISPATCH_ROUTE( randu, sexpr.distr(), sexpr.stream(), dmat.derived(),
+				internal::rand_column_span )
+
+		internal::counter_rand_evaluate(sexpr, dmat.derived());
+	}
+
 
 }
 
@@ -76,6 +76,31 @@ namespace lmat { namespace random {
 
 	typedef sfmt_rand_stream<19937> default_rand_stream;
 
+	template<class Engine> class counter_rand_stream;
+
+	class philox4x32_engine;
+	class threefry4x32_engine;
+
+	typedef counter_rand_stream<philox4x32_engine> philox4x32_stream;
+	typedef counter_rand_stream<threefry4x32_engine> threefry_stream;
+
+
+	/********************************************
+	 *
+	 *  stream properties
+	 *
+	 ********************************************/
+
+	// whether a stream supports O(1) random access (seek/discard)
+	// and cheap copying, such that independent sub-streams can be
+	// derived without sequential state updates
+
+	template<class RStream>
+	struct is_counter_based_stream : public meta::false_ { };
+
+	template<class Engine>
+	struct is_counter_based_stream<counter_rand_stream<Engine> > : public meta::true_ { };
+
 
 } }
 
@@ -3,6 +3,13 @@
  *
  * @brief Sampling without replacement
  *
+ * The enumerators produce one index at a time. The bulk routines
+ * (rand_sample_*, reservoir_sampler, rand_shuffle) draw 32-bit words
+ * from the stream in batches through rand_seq, which copies whole
+ * runs of the generator state, and map them to bounded integers by
+ * multiply-shift with rejection, so the draws are exactly uniform.
+ * A batch is drawn in full even if only part of it is used.
+ *
  * @author Dahua Lin
  */
 
@@ -16,6 +23,9 @@
 #include <light_mat/matrix/dense_matrix.h>
 #include <light_mat/random/uniform_int_distr.h>
 #include <unordered_set>
+#include <algorithm>
+#include <vector>
+#include <cmath>
 
 namespace lmat { namespace random {
 
@@ -154,6 +164,569 @@ namespace lmat { namespace random {
 	};
 
 
+	/********************************************
+	 *
+	 *  Batched random words
+	 *
+	 ********************************************/
+
+	namespace internal
+	{
+		template<class RStream>
+		class rand_word_batch
+		{
+		public:
+			static const index_t batch_len = 512;
+
+			LMAT_ENSURE_INLINE
+			explicit rand_word_batch(RStream& rs)
+			: m_rstream(rs), m_i(batch_len), m_bits(0), m_nbits(0) { }
+
+			LMAT_ENSURE_INLINE
+			uint32_t u32()
+			{
+				if (m_i == batch_len) refill();
+				return m_buf[m_i++];
+			}
+
+			LMAT_ENSURE_INLINE
+			uint64_t u64()
+			{
+				uint64_t lo = u32();
+				return lo | ((uint64_t)u32() << 32);
+			}
+
+			LMAT_ENSURE_INLINE
+			bool bit()
+			{
+				if (m_nbits == 0)
+				{
+					m_bits = u32();
+					m_nbits = 32;
+				}
+				bool b = (m_bits & 1) != 0;
+				m_bits >>= 1;
+				-- m_nbits;
+				return b;
+			}
+
+			// uniform over [0, r), with r > 0
+
+			LMAT_ENSURE_INLINE
+			uint64_t below(uint64_t r)
+			{
+				return r <= 0xffffffffULL ? below32((uint32_t)r) : below64(r);
+			}
+
+			// uniform over (0, 1)
+
+			LMAT_ENSURE_INLINE
+			double open_unit()
+			{
+				return (double(u64() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+			}
+
+		private:
+			void refill()
+			{
+				m_rstream.rand_seq(sizeof(m_buf), m_buf);
+				m_i = 0;
+			}
+
+			LMAT_ENSURE_INLINE
+			uint64_t below32(uint32_t r)
+			{
+				uint64_t m = (uint64_t)u32() * r;
+				uint32_t l = (uint32_t)m;
+				if (l < r)
+				{
+					const uint32_t t = (0u - r) % r;
+					while (l < t)
+					{
+						m = (uint64_t)u32() * r;
+						l = (uint32_t)m;
+					}
+				}
+				return m >> 32;
+			}
+
+			uint64_t below64(uint64_t r)
+			{
+				uint64_t mask = r - 1;
+				mask |= mask >> 1;
+				mask |= mask >> 2;
+				mask |= mask >> 4;
+				mask |= mask >> 8;
+				mask |= mask >> 16;
+				mask |= mask >> 32;
+
+				uint64_t x;
+				do { x = u64() & mask; } while (x >= r);
+				return x;
+			}
+
+		private:
+			RStream& m_rstream;
+			uint32_t m_buf[batch_len];
+			index_t m_i;
+			uint32_t m_bits;
+			unsigned int m_nbits;
+		};
+
+
+		// open-addressing set of indices, sized for k insertions
+
+		class index_hash_set
+		{
+		public:
+			explicit index_hash_set(index_t k)
+			{
+				unsigned int b = 4;
+				while (((uint64_t)1 << b) < 2 * (uint64_t)k) ++b;
+
+				m_shift = 64 - b;
+				m_mask = ((size_t)1 << b) - 1;
+				m_slots.assign(m_mask + 1, 0);
+			}
+
+			// returns false if x was already in the set
+
+			LMAT_ENSURE_INLINE
+			bool insert(uint64_t x)
+			{
+				const uint64_t key = x + 1;  // 0 marks an empty slot
+				size_t h = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> m_shift);
+
+				for(;;)
+				{
+					const uint64_t s = m_slots[h];
+					if (s == 0)
+					{
+						m_slots[h] = key;
+						return true;
+					}
+					if (s == key) return false;
+					h = (h + 1) & m_mask;
+				}
+			}
+
+		private:
+			std::vector<uint64_t> m_slots;
+			size_t m_mask;
+			unsigned int m_shift;
+		};
+	}
+
+
+	/********************************************
+	 *
+	 *  k-of-n sampling
+	 *
+	 *  k is given by the length of the output.
+	 *
+	 *  rand_sample_floyd: Floyd's algorithm,
+	 *  exactly k draws. The subset is uniform,
+	 *  but the order of its elements is not.
+	 *
+	 *  rand_sample_hashed: draws with rejection
+	 *  of repeats, for k << n. The sample is in
+	 *  random order.
+	 *
+	 *  rand_sample_wor: a sample in random order,
+	 *  by rejection for k <= n / 4, otherwise by
+	 *  a partial Fisher-Yates shuffle of [0, n).
+	 *
+	 ********************************************/
+
+	template<typename TI, class RStream>
+	void rand_sample_floyd(RStream& rs, index_t n, dense_col<TI>& r)
+	{
+		const index_t k = r.nelems();
+		if (k > n)
+			throw invalid_argument("rand_sample_floyd: k must not exceed n.");
+
+		internal::rand_word_batch<RStream> w(rs);
+		internal::index_hash_set past(k);
+
+		TI *pr = r.ptr_data();
+		for (index_t j = n - k; j < n; ++j)
+		{
+			uint64_t t = w.below((uint64_t)(j + 1));
+			if (!past.insert(t))
+			{
+				t = (uint64_t)j;  // never drawn before, as all past ones are < j
+				past.insert(t);
+			}
+			*(pr++) = static_cast<TI>(t);
+		}
+	}
+
+	template<typename TI, class RStream>
+	void rand_sample_hashed(RStream& rs, index_t n, dense_col<TI>& r)
+	{
+		const index_t k = r.nelems();
+		if (k > n)
+			throw invalid_argument("rand_sample_hashed: k must not exceed n.");
+
+		internal::rand_word_batch<RStream> w(rs);
+		internal::index_hash_set past(k);
+
+		TI *pr = r.ptr_data();
+		index_t c = 0;
+		while (c < k)
+		{
+			const uint64_t t = w.below((uint64_t)n);
+			if (past.insert(t)) pr[c++] = static_cast<TI>(t);
+		}
+	}
+
+	template<typename TI, class RStream>
+	void rand_sample_wor(RStream& rs, index_t n, dense_col<TI>& r)
+	{
+		const index_t k = r.nelems();
+		if (k > n)
+			throw invalid_argument("rand_sample_wor: k must not exceed n.");
+
+		if (k <= n / 4)
+		{
+			rand_sample_hashed(rs, n, r);
+		}
+		else
+		{
+			internal::rand_word_batch<RStream> w(rs);
+
+			std::vector<TI> seq((size_t)n);
+			for (index_t i = 0; i < n; ++i) seq[i] = static_cast<TI>(i);
+
+			TI *pr = r.ptr_data();
+			for (index_t i = 0; i < k; ++i)
+			{
+				const index_t j = i + (index_t)w.below((uint64_t)(n - i));
+				std::swap(seq[i], seq[j]);
+				pr[i] = seq[i];
+			}
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  reservoir_sampler
+	 *
+	 *  Keeps a uniform k-subset of the items
+	 *  pushed so far (Li's algorithm L): the gap
+	 *  to the next item that enters the sample
+	 *  is drawn directly, so the items skipped
+	 *  over cost nothing, and a pushed block
+	 *  takes O(k log(n / k)) draws in all.
+	 *
+	 *  The stream position is counted in 64 bits,
+	 *  so a stream may be longer than index_t.
+	 *
+	 ********************************************/
+
+	template<typename T, class RStream=default_rand_stream>
+	class reservoir_sampler
+	{
+	public:
+		typedef T value_type;
+
+		reservoir_sampler(RStream& rs, index_t k)
+		: m_words(rs), m_sample(k), m_count(0), m_next(0), m_w(1.0)
+		{
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t capacity() const
+		{
+			return m_sample.nelems();
+		}
+
+		LMAT_ENSURE_INLINE
+		uint64_t count() const  // the number of items pushed
+		{
+			return m_count;
+		}
+
+		LMAT_ENSURE_INLINE
+		index_t size() const  // the number of items in the sample
+		{
+			return m_count < (uint64_t)capacity() ? (index_t)m_count : capacity();
+		}
+
+		LMAT_ENSURE_INLINE
+		const dense_col<T>& sample() const  // the first size() elements are valid
+		{
+			return m_sample;
+		}
+
+		LMAT_ENSURE_INLINE
+		void push(const T& x)
+		{
+			push(&x, 1);
+		}
+
+		void push(const T* p, index_t len)
+		{
+			const index_t k = capacity();
+
+			if (m_count < (uint64_t)k)
+			{
+				const index_t c = (index_t)m_count;
+				const index_t r = k - c < len ? k - c : len;
+				for (index_t i = 0; i < r; ++i) m_sample[c + i] = p[i];
+
+				m_count += (uint64_t)r;
+				p += r;
+				len -= r;
+
+				if (m_count < (uint64_t)k) return;
+
+				m_w = std::exp(std::log(m_words.open_unit()) / double(k));
+				advance((uint64_t)k);
+			}
+
+			if (k == 0)
+			{
+				m_count += (uint64_t)len;
+				return;
+			}
+
+			const uint64_t end = m_count + (uint64_t)len;
+			while (m_next < end)
+			{
+				m_sample[(index_t)m_words.below((uint64_t)k)] = p[(index_t)(m_next - m_count)];
+				m_w *= std::exp(std::log(m_words.open_unit()) / double(k));
+				advance(m_next + 1);
+			}
+			m_count = end;
+		}
+
+	private:
+		void advance(uint64_t i)  // the next item to take, counting from i
+		{
+			// the skip is clamped in double before it is converted,
+			// and items from 2^62 on are never taken
+			const uint64_t never = uint64_t(1) << 62;
+
+			const double g = std::floor(std::log(m_words.open_unit()) / std::log1p(-m_w));
+			m_next = g < double(never - i) ? i + (uint64_t)g : never;
+		}
+
+	private:
+		internal::rand_word_batch<RStream> m_words;
+		dense_col<T> m_sample;
+		uint64_t m_count;
+		uint64_t m_next;
+		double m_w;
+	};
+
+
+	/********************************************
+	 *
+	 *  Shuffles
+	 *
+	 *  Long vectors are shuffled with MergeShuffle
+	 *  (Bacher et al.): blocks are shuffled with
+	 *  Fisher-Yates in parallel, then adjacent
+	 *  runs are merged pairwise by coin flips,
+	 *  followed by insertions for the remainder,
+	 *  which keeps the result exactly uniform.
+	 *
+	 *  Each block and each merge has its own
+	 *  stream, seeded from rs up front. The
+	 *  blocks only depend on the length, so the
+	 *  result does not depend on the number of
+	 *  threads.
+	 *
+	 ********************************************/
+
+	namespace internal
+	{
+		const index_t shuffle_block_len = index_t(1) << 16;
+
+		template<typename TI, class RStream>
+		inline void fisher_yates(rand_word_batch<RStream>& w, TI *a, index_t n)
+		{
+			for (index_t i = n - 1; i > 0; --i)
+			{
+				const index_t j = (index_t)w.below((uint64_t)(i + 1));
+				std::swap(a[i], a[j]);
+			}
+		}
+
+		// a[0, m) and a[m, n) are uniformly shuffled on input,
+		// a[0, n) is uniformly shuffled on output
+
+		template<typename TI, class RStream>
+		inline void merge_shuffled(rand_word_batch<RStream>& w, TI *a, index_t m, index_t n)
+		{
+			index_t u = 0;
+			index_t v = m;
+
+			for(;;)
+			{
+				if (w.bit())
+				{
+					if (v == n) break;
+					std::swap(a[u], a[v++]);
+				}
+				else if (u == v) break;
+				++u;
+			}
+
+			for (; u < n; ++u)
+			{
+				std::swap(a[u], a[(index_t)w.below((uint64_t)(u + 1))]);
+			}
+		}
+
+		// the start of the b-th of nb blocks of a[0, n)
+		// (n * b can exceed the range of index_t)
+
+		LMAT_ENSURE_INLINE
+		inline index_t shuffle_block_begin(index_t n, index_t b, index_t nb)
+		{
+			return (index_t)((int64_t)n * b / nb);
+		}
+
+		// the sub-streams of merge_shuffle: the k-th is keyed by a base
+		// drawn once from the parent together with k, so no two coincide
+		// (SFMT: a 128-bit key array with k appended; counter-based
+		// streams: a 64-bit key with stream id k)
+
+		template<class RStream>
+		class shuffle_substreams
+		{
+		public:
+			typedef typename rand_stream_traits<RStream>::seed_type seed_type;
+
+			explicit shuffle_substreams(RStream& rs)
+			{
+				rs.rand_seq(sizeof(seed_type), &m_base);
+			}
+
+			void seed(RStream& sub, index_t k) const
+			{
+				sub.set_seed(static_cast<seed_type>(m_base + static_cast<seed_type>(k)));
+			}
+
+		private:
+			seed_type m_base;
+		};
+
+		template<unsigned int MEXP>
+		class shuffle_substreams<sfmt_rand_stream<MEXP> >
+		{
+		public:
+			explicit shuffle_substreams(sfmt_rand_stream<MEXP>& rs)
+			{
+				rs.rand_seq(sizeof(m_key), m_key);
+			}
+
+			void seed(sfmt_rand_stream<MEXP>& sub, index_t k) const
+			{
+				uint32_t key[6] = { m_key[0], m_key[1], m_key[2], m_key[3],
+					(uint32_t)((uint64_t)k), (uint32_t)((uint64_t)k >> 32) };
+				sub.set_seed(key, 6);
+			}
+
+		private:
+			uint32_t m_key[4];
+		};
+
+		template<class Engine>
+		class shuffle_substreams<counter_rand_stream<Engine> >
+		{
+		public:
+			explicit shuffle_substreams(counter_rand_stream<Engine>& rs)
+			{
+				rs.rand_seq(sizeof(m_seed), &m_seed);
+			}
+
+			void seed(counter_rand_stream<Engine>& sub, index_t k) const
+			{
+				sub.set_seed(m_seed);
+				sub.set_stream_id((uint64_t)k);
+			}
+
+		private:
+			uint64_t m_seed;
+		};
+
+		template<typename TI, class RStream>
+		void merge_shuffle(RStream& rs, TI *a, index_t n)
+		{
+			index_t nb = 1;
+			while (nb * shuffle_block_len < n) nb *= 2;
+
+			const shuffle_substreams<RStream> subs(rs);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+			for (index_t b = 0; b < nb; ++b)
+			{
+				RStream sub;
+				subs.seed(sub, b);
+				rand_word_batch<RStream> w(sub);
+
+				const index_t i0 = shuffle_block_begin(n, b, nb);
+				const index_t i1 = shuffle_block_begin(n, b + 1, nb);
+				fisher_yates(w, a + i0, i1 - i0);
+			}
+
+			index_t s = nb;
+			for (index_t h = 1; h < nb; h *= 2)  // runs of h blocks into runs of 2h
+			{
+				const index_t nm = nb / (2 * h);
+
+#ifdef _OPENMP
+#pragma omp parallel for if (nm > 1)
+#endif
+				for (index_t q = 0; q < nm; ++q)
+				{
+					RStream sub;
+					subs.seed(sub, s + q);
+					rand_word_batch<RStream> w(sub);
+
+					const index_t i0 = shuffle_block_begin(n, 2 * q * h, nb);
+					const index_t im = shuffle_block_begin(n, (2 * q + 1) * h, nb);
+					const index_t i1 = shuffle_block_begin(n, (2 * q + 2) * h, nb);
+					merge_shuffled(w, a + i0, im - i0, i1 - i0);
+				}
+				s += nm;
+			}
+		}
+	}
+
+	template<typename TI, class RStream>
+	void rand_shuffle(RStream& rs, dense_col<TI>& a)
+	{
+		const index_t n = a.nelems();
+
+		if (n <= internal::shuffle_block_len)
+		{
+			internal::rand_word_batch<RStream> w(rs);
+			internal::fisher_yates(w, a.ptr_data(), n);
+		}
+		else
+		{
+			internal::merge_shuffle(rs, a.ptr_data(), n);
+		}
+	}
+
+	template<typename TI, class RStream>
+	void rand_permutation(RStream& rs, dense_col<TI>& a)  // a random permutation of [0, n)
+	{
+		const index_t n = a.nelems();
+		TI *pa = a.ptr_data();
+		for (index_t i = 0; i < n; ++i) pa[i] = static_cast<TI>(i);
+
+		rand_shuffle(rs, a);
+	}
+
+
 
 } }
 
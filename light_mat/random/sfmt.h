@@ -52,6 +52,8 @@ namespace lmat { namespace random {
 
 		void init_states(uint32_t seed);
 
+		void init_states(const uint32_t *key, unsigned int len);  // SFMT init_by_array
+
 		void next()
 		{
 		    __m128i r1 = state[param_t::N - 2].si;
@@ -105,6 +107,8 @@ namespace lmat { namespace random {
 
 	private:
 
+		void certify_period();
+
 		LMAT_ENSURE_INLINE
 		static __m128i mm_recursion(__m128i a, __m128i b,
 						__m128i c, __m128i d, __m128i msk)
@@ -132,10 +136,6 @@ namespace lmat { namespace random {
 	template<unsigned int MEXP>
 	void sfmt_state<MEXP>::init_states(uint32_t seed)
 	{
-		const uint32_t parity[4] = {
-			param_t::PARITY1, param_t::PARITY2,
-			param_t::PARITY3, param_t::PARITY4};
-
 	    uint32_t *psfmt32 = &state[0].u[0];
 
 	    psfmt32[LMAT_SFMT_IDXOF(0)] = seed;
@@ -146,7 +146,68 @@ namespace lmat { namespace random {
 				^ (psfmt32[LMAT_SFMT_IDXOF(i - 1)] >> 30)) + i;
 	    }
 
-	    // period certification
+	    certify_period();
+	}
+
+
+	template<unsigned int MEXP>
+	void sfmt_state<MEXP>::init_states(const uint32_t *key, unsigned int len)
+	{
+		const unsigned int n32 = param_t::N32;
+		const unsigned int lag = n32 >= 623 ? 11 : (n32 >= 68 ? 7 : (n32 >= 39 ? 5 : 3));
+		const unsigned int mid = (n32 - lag) / 2;
+
+	    uint32_t *psfmt32 = &state[0].u[0];
+	    for (unsigned int i = 0; i < n32; i++) psfmt32[i] = 0x8b8b8b8bU;
+
+	    unsigned int count = (len + 1 > n32 ? len + 1 : n32);
+
+	    uint32_t r = psfmt32[LMAT_SFMT_IDXOF(0)] ^ psfmt32[LMAT_SFMT_IDXOF(mid)]
+	    		^ psfmt32[LMAT_SFMT_IDXOF(n32 - 1)];
+	    r = (r ^ (r >> 27)) * 1664525U;
+	    psfmt32[LMAT_SFMT_IDXOF(mid)] += r;
+	    r += len;
+	    psfmt32[LMAT_SFMT_IDXOF(mid + lag)] += r;
+	    psfmt32[LMAT_SFMT_IDXOF(0)] = r;
+
+	    count--;
+	    unsigned int i = 1;
+	    for (unsigned int j = 0; j < count; j++)
+	    {
+	    	r = psfmt32[LMAT_SFMT_IDXOF(i)] ^ psfmt32[LMAT_SFMT_IDXOF((i + mid) % n32)]
+	    		^ psfmt32[LMAT_SFMT_IDXOF((i + n32 - 1) % n32)];
+	    	r = (r ^ (r >> 27)) * 1664525U;
+	    	psfmt32[LMAT_SFMT_IDXOF((i + mid) % n32)] += r;
+	    	r += (j < len ? key[j] : 0) + i;
+	    	psfmt32[LMAT_SFMT_IDXOF((i + mid + lag) % n32)] += r;
+	    	psfmt32[LMAT_SFMT_IDXOF(i)] = r;
+	    	i = (i + 1) % n32;
+	    }
+
+	    for (unsigned int j = 0; j < n32; j++)
+	    {
+	    	r = psfmt32[LMAT_SFMT_IDXOF(i)] + psfmt32[LMAT_SFMT_IDXOF((i + mid) % n32)]
+	    		+ psfmt32[LMAT_SFMT_IDXOF((i + n32 - 1) % n32)];
+	    	r = (r ^ (r >> 27)) * 1566083941U;
+	    	psfmt32[LMAT_SFMT_IDXOF((i + mid) % n32)] ^= r;
+	    	r -= i;
+	    	psfmt32[LMAT_SFMT_IDXOF((i + mid + lag) % n32)] ^= r;
+	    	psfmt32[LMAT_SFMT_IDXOF(i)] = r;
+	    	i = (i + 1) % n32;
+	    }
+
+	    certify_period();
+	}
+
+
+	template<unsigned int MEXP>
+	void sfmt_state<MEXP>::certify_period()
+	{
+		const uint32_t parity[4] = {
+			param_t::PARITY1, param_t::PARITY2,
+			param_t::PARITY3, param_t::PARITY4};
+
+	    uint32_t *psfmt32 = &state[0].u[0];
 
 	    int inner = 0;
 
@@ -233,6 +294,13 @@ namespace lmat { namespace random {
 			m_tracker.set_end();
 		}
 
+		LMAT_ENSURE_INLINE
+		void set_seed(const uint32_t *key, unsigned int len)  // full-width seeding from a key array
+		{
+			m_intern.init_states(key, len);
+			m_tracker.set_end();
+		}
+
 		LMAT_ENSURE_INLINE
 		size_t state_size() const  // in terms of bytes
 		{
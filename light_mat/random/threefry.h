@@ -0,0 +1,179 @@
+/**
+ * @file threefry.h
+ *
+ * @brief Threefry-4x32-20 counter-based random stream
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_THREEFRY_H_
+#define LIGHTMAT_THREEFRY_H_
+
+#include <light_mat/random/counter_stream.h>
+
+#define LMAT_THREEFRY_MIX(a, b, R) \
+	a += b; b = internal::rotl_u32<R>(b); b ^= a;
+
+#define LMAT_THREEFRY_MIX_SSE(a, b, R) \
+	a = _mm_add_epi32(a, b); b = internal::rotl_epi32<R>(b); b = _mm_xor_si128(b, a);
+
+namespace lmat { namespace random {
+
+	/********************************************
+	 *
+	 *  threefry4x32_engine
+	 *
+	 *  Salmon et al., Parallel random numbers:
+	 *  as easy as 1, 2, 3. SC'11.
+	 *
+	 *  Only uses add/rotate/xor, and thus
+	 *  vectorizes well on plain SSE2.
+	 *
+	 ********************************************/
+
+	class threefry4x32_engine
+	{
+	public:
+		static const unsigned int key_units = 4;
+		static const unsigned int key_bytes = key_units * 4;
+		static const unsigned int num_rounds = 20;
+
+		static const uint32_t KS_PARITY = 0x1BD11BDA;
+
+		LMAT_ENSURE_INLINE
+		explicit threefry4x32_engine(uint64_t seed)
+		{
+			set_seed(seed);
+		}
+
+		LMAT_ENSURE_INLINE
+		void set_seed(uint64_t seed)
+		{
+			const uint32_t key[4] = {(uint32_t)(seed), (uint32_t)(seed >> 32), 0, 0};
+			set_key(key);
+		}
+
+		LMAT_ENSURE_INLINE
+		void set_key(const uint32_t *key)
+		{
+			m_ks[4] = KS_PARITY;
+			for (unsigned int i = 0; i < 4; ++i)
+			{
+				m_ks[i] = key[i];
+				m_ks[4] ^= key[i];
+			}
+		}
+
+		LMAT_ENSURE_INLINE
+		const uint32_t* key() const
+		{
+			return m_ks;
+		}
+
+		// scalar version: one block
+
+		void block(const uint32_t *ctr, uint32_t *out) const
+		{
+			uint32_t x0 = ctr[0] + m_ks[0];
+			uint32_t x1 = ctr[1] + m_ks[1];
+			uint32_t x2 = ctr[2] + m_ks[2];
+			uint32_t x3 = ctr[3] + m_ks[3];
+
+			for (unsigned int s = 1; s <= num_rounds / 4; ++s)
+			{
+				if (s & 1)
+				{
+					LMAT_THREEFRY_MIX(x0, x1, 10) LMAT_THREEFRY_MIX(x2, x3, 26)
+					LMAT_THREEFRY_MIX(x0, x3, 11) LMAT_THREEFRY_MIX(x2, x1, 21)
+					LMAT_THREEFRY_MIX(x0, x1, 13) LMAT_THREEFRY_MIX(x2, x3, 27)
+					LMAT_THREEFRY_MIX(x0, x3, 23) LMAT_THREEFRY_MIX(x2, x1, 5)
+				}
+				else
+				{
+					LMAT_THREEFRY_MIX(x0, x1, 6)  LMAT_THREEFRY_MIX(x2, x3, 20)
+					LMAT_THREEFRY_MIX(x0, x3, 17) LMAT_THREEFRY_MIX(x2, x1, 11)
+					LMAT_THREEFRY_MIX(x0, x1, 25) LMAT_THREEFRY_MIX(x2, x3, 10)
+					LMAT_THREEFRY_MIX(x0, x3, 18) LMAT_THREEFRY_MIX(x2, x1, 20)
+				}
+
+				// key injection
+
+				x0 += m_ks[s % 5];
+				x1 += m_ks[(s + 1) % 5];
+				x2 += m_ks[(s + 2) % 5];
+				x3 += m_ks[(s + 3) % 5] + s;
+			}
+
+			out[0] = x0; out[1] = x1; out[2] = x2; out[3] = x3;
+		}
+
+		// SIMD version: four consecutive blocks (one per lane)
+
+		void generate4(uint64_t pos, uint64_t sid, uint32_t *out) const  // out must be 16-byte aligned
+		{
+			__m128i ks[5];
+			for (unsigned int i = 0; i < 5; ++i)
+				ks[i] = _mm_set1_epi32((int)m_ks[i]);
+
+			__m128i x0 = _mm_set_epi32(
+					(int)(uint32_t)(pos + 3), (int)(uint32_t)(pos + 2),
+					(int)(uint32_t)(pos + 1), (int)(uint32_t)(pos));
+			__m128i x1 = _mm_set_epi32(
+					(int)(uint32_t)((pos + 3) >> 32), (int)(uint32_t)((pos + 2) >> 32),
+					(int)(uint32_t)((pos + 1) >> 32), (int)(uint32_t)(pos >> 32));
+			__m128i x2 = _mm_set1_epi32((int)(uint32_t)sid);
+			__m128i x3 = _mm_set1_epi32((int)(uint32_t)(sid >> 32));
+
+			x0 = _mm_add_epi32(x0, ks[0]);
+			x1 = _mm_add_epi32(x1, ks[1]);
+			x2 = _mm_add_epi32(x2, ks[2]);
+			x3 = _mm_add_epi32(x3, ks[3]);
+
+			for (unsigned int s = 1; s <= num_rounds / 4; ++s)
+			{
+				if (s & 1)
+				{
+					LMAT_THREEFRY_MIX_SSE(x0, x1, 10) LMAT_THREEFRY_MIX_SSE(x2, x3, 26)
+					LMAT_THREEFRY_MIX_SSE(x0, x3, 11) LMAT_THREEFRY_MIX_SSE(x2, x1, 21)
+					LMAT_THREEFRY_MIX_SSE(x0, x1, 13) LMAT_THREEFRY_MIX_SSE(x2, x3, 27)
+					LMAT_THREEFRY_MIX_SSE(x0, x3, 23) LMAT_THREEFRY_MIX_SSE(x2, x1, 5)
+				}
+				else
+				{
+					LMAT_THREEFRY_MIX_SSE(x0, x1, 6)  LMAT_THREEFRY_MIX_SSE(x2, x3, 20)
+					LMAT_THREEFRY_MIX_SSE(x0, x3, 17) LMAT_THREEFRY_MIX_SSE(x2, x1, 11)
+					LMAT_THREEFRY_MIX_SSE(x0, x1, 25) LMAT_THREEFRY_MIX_SSE(x2, x3, 10)
+					LMAT_THREEFRY_MIX_SSE(x0, x3, 18) LMAT_THREEFRY_MIX_SSE(x2, x1, 20)
+				}
+
+				// key injection
+
+				x0 = _mm_add_epi32(x0, ks[s % 5]);
+				x1 = _mm_add_epi32(x1, ks[(s + 1) % 5]);
+				x2 = _mm_add_epi32(x2, ks[(s + 2) % 5]);
+				x3 = _mm_add_epi32(_mm_add_epi32(x3, ks[(s + 3) % 5]), _mm_set1_epi32((int)s));
+			}
+
+			internal::transpose4_epi32(x0, x1, x2, x3);
+
+			__m128i *p = reinterpret_cast<__m128i*>(out);
+			_mm_store_si128(p,     x0);
+			_mm_store_si128(p + 1, x1);
+			_mm_store_si128(p + 2, x2);
+			_mm_store_si128(p + 3, x3);
+		}
+
+	private:
+		uint32_t m_ks[5];  // key schedule: four key units + parity
+	};
+
+} }
+
+#undef LMAT_THREEFRY_MIX
+#undef LMAT_THREEFRY_MIX_SSE
+
+#endif
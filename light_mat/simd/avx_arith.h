@@ -187,13 +187,21 @@ namespace lmat {  namespace math {
 	LMAT_ENSURE_INLINE
 	inline avx_f32pk fma(const avx_f32pk& x, const avx_f32pk& y, const avx_f32pk& z)
 	{
+#ifdef LMAT_HAS_FMA
+		return _mm256_fmadd_ps(x, y, z);
+#else
 		return _mm256_add_ps(_mm256_mul_ps(x, y), z);
+#endif
 	}
 
 	LMAT_ENSURE_INLINE
 	inline avx_f64pk fma(const avx_f64pk& x, const avx_f64pk& y, const avx_f64pk& z)
 	{
+#ifdef LMAT_HAS_FMA
+		return _mm256_fmadd_pd(x, y, z);
+#else
 		return _mm256_add_pd(_mm256_mul_pd(x, y), z);
+#endif
 	}
 
 
@@ -0,0 +1,667 @@
+/**
+ * @file avx_cpacks.h
+ *
+ * @brief AVX packs of complex numbers
+ *
+ * The same interleaved layout and algorithms as in sse_cpacks.h, with
+ * 4 complex<float> or 2 complex<double> in a pack. The in-lane shuffles
+ * used for multiplication stay within each 128-bit half, while real/imag
+ * first exchange the halves of the two input packs, so that the output
+ * keeps the element order.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_AVX_CPACKS_H_
+#define LIGHTMAT_AVX_CPACKS_H_
+
+#include <light_mat/simd/avx_arith.h>
+#include <light_mat/simd/avx_pred.h>
+#include <light_mat/simd/sse_cpacks.h>
+
+namespace lmat { namespace meta {
+
+	LMAT_DEFINE_HAS_AVX_COMPLEX_SUPPORT( add_ )
+	LMAT_DEFINE_HAS_AVX_COMPLEX_SUPPORT( sub_ )
+	LMAT_DEFINE_HAS_AVX_COMPLEX_SUPPORT( mul_ )
+	LMAT_DEFINE_HAS_AVX_COMPLEX_SUPPORT( div_ )
+	LMAT_DEFINE_HAS_AVX_COMPLEX_SUPPORT( neg_ )
+	LMAT_DEFINE_HAS_AVX_COMPLEX_SUPPORT( conj_ )
+
+} }
+
+
+namespace lmat {
+
+	/********************************************
+	 *
+	 *  trait classes
+	 *
+	 ********************************************/
+
+	LMAT_DEFINE_SIMD_TRAITS( avx_t, std::complex<float>,  4, 32 )
+	LMAT_DEFINE_SIMD_TRAITS( avx_t, std::complex<double>, 2, 32 )
+
+
+	/********************************************
+	 *
+	 *  pack classes
+	 *
+	 ********************************************/
+
+	typedef simd_pack<std::complex<float>,  avx_t> avx_c32pk;
+	typedef simd_pack<std::complex<double>, avx_t> avx_c64pk;
+
+
+	template<>
+	class simd_pack<std::complex<float>, avx_t>
+	{
+	private:
+		union
+		{
+			__m256 v;
+			LMAT_ALIGN_AVX float e[8];
+		};
+
+	public:
+		LMAT_DEFINE_FOR_SIMD_PACK( avx_t, std::complex<float>, 4 )
+
+		LMAT_ENSURE_INLINE
+		unsigned int width() const
+		{
+			return pack_width;
+		}
+
+		// constructors
+
+		LMAT_ENSURE_INLINE simd_pack() { }
+
+		LMAT_ENSURE_INLINE simd_pack(const __m256& v_) : v(v_) { }
+
+		LMAT_ENSURE_INLINE simd_pack(const std::complex<float>& ev)
+		{
+			set(ev);
+		}
+
+		LMAT_ENSURE_INLINE simd_pack(
+				const std::complex<float>& e0, const std::complex<float>& e1,
+				const std::complex<float>& e2, const std::complex<float>& e3)
+		{
+			set(e0, e1, e2, e3);
+		}
+
+		LMAT_ENSURE_INLINE explicit simd_pack(const std::complex<float> *p)
+		{
+			load_u(p);
+		}
+
+	    LMAT_ENSURE_INLINE
+	    static simd_pack zeros()
+	    {
+	    	return _mm256_setzero_ps();
+	    }
+
+	    LMAT_ENSURE_INLINE
+	    static simd_pack ones()
+	    {
+	    	return _mm256_setr_ps(1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f);
+	    }
+
+	    // converter
+
+	    LMAT_ENSURE_INLINE
+	    operator __m256() const
+	    {
+	    	return v;
+	    }
+
+	    LMAT_ENSURE_INLINE
+	    sse_c32pk get_low() const
+	    {
+	    	return _mm256_castps256_ps128(v);
+	    }
+
+	    LMAT_ENSURE_INLINE
+	    sse_c32pk get_high() const
+	    {
+	    	return _mm256_extractf128_ps(v, 1);
+	    }
+
+		// set
+
+		LMAT_ENSURE_INLINE void reset()
+		{
+			v = _mm256_setzero_ps();
+		}
+
+		LMAT_ENSURE_INLINE void set(const std::complex<float>& ev)
+		{
+			const float re = ev.real();
+			const float im = ev.imag();
+			v = _mm256_setr_ps(re, im, re, im, re, im, re, im);
+		}
+
+		LMAT_ENSURE_INLINE void set(
+				const std::complex<float>& e0, const std::complex<float>& e1,
+				const std::complex<float>& e2, const std::complex<float>& e3)
+		{
+			v = _mm256_setr_ps(
+					e0.real(), e0.imag(), e1.real(), e1.imag(),
+					e2.real(), e2.imag(), e3.real(), e3.imag());
+		}
+
+		// load
+
+		LMAT_ENSURE_INLINE void load_u(const std::complex<float> *p)
+		{
+			v = _mm256_loadu_ps(reinterpret_cast<const float*>(p));
+		}
+
+		LMAT_ENSURE_INLINE void load_a(const std::complex<float> *p)
+		{
+			v = _mm256_load_ps(reinterpret_cast<const float*>(p));
+		}
+
+	    // gathers p[0], p[step], p[2 * step], p[3 * step]
+
+	    LMAT_ENSURE_INLINE void load_strided(const std::complex<float> *p, index_t step)
+	    {
+	    	sse_c32pk lo, hi;
+	    	lo.load_strided(p, step);
+	    	hi.load_strided(p + 2 * step, step);
+	    	v = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+	    }
+
+	    // store
+
+	    LMAT_ENSURE_INLINE void store_u(std::complex<float> *p) const
+	    {
+	    	_mm256_storeu_ps(reinterpret_cast<float*>(p), v);
+	    }
+
+	    LMAT_ENSURE_INLINE void store_a(std::complex<float> *p) const
+	    {
+	    	_mm256_store_ps(reinterpret_cast<float*>(p), v);
+	    }
+
+	    LMAT_ENSURE_INLINE void store_s(std::complex<float> *p) const  // non-temporal, p must be aligned
+	    {
+	    	_mm256_stream_ps(reinterpret_cast<float*>(p), v);
+	    }
+
+	    // extract
+
+	    LMAT_ENSURE_INLINE std::complex<float> to_scalar() const
+	    {
+	    	return std::complex<float>(e[0], e[1]);
+	    }
+
+	    LMAT_ENSURE_INLINE std::complex<float> operator[] (unsigned int i) const
+	    {
+	    	return std::complex<float>(e[2 * i], e[2 * i + 1]);
+	    }
+
+	}; // AVX c32 pack
+
+
+	template<>
+	class simd_pack<std::complex<double>, avx_t>
+	{
+	private:
+		union
+		{
+			__m256d v;
+			LMAT_ALIGN_AVX double e[4];
+		};
+
+	public:
+		LMAT_DEFINE_FOR_SIMD_PACK( avx_t, std::complex<double>, 2 )
+
+		LMAT_ENSURE_INLINE
+		unsigned int width() const
+		{
+			return pack_width;
+		}
+
+		// constructors
+
+		LMAT_ENSURE_INLINE simd_pack() { }
+
+		LMAT_ENSURE_INLINE simd_pack(const __m256d& v_) : v(v_) { }
+
+		LMAT_ENSURE_INLINE simd_pack(const std::complex<double>& ev)
+		{
+			set(ev);
+		}
+
+		LMAT_ENSURE_INLINE simd_pack(const std::complex<double>& e0, const std::complex<double>& e1)
+		{
+			set(e0, e1);
+		}
+
+		LMAT_ENSURE_INLINE explicit simd_pack(const std::complex<double> *p)
+		{
+			load_u(p);
+		}
+
+	    LMAT_ENSURE_INLINE
+	    static simd_pack zeros()
+	    {
+	    	return _mm256_setzero_pd();
+	    }
+
+	    LMAT_ENSURE_INLINE
+	    static simd_pack ones()
+	    {
+	    	return _mm256_setr_pd(1.0, 0.0, 1.0, 0.0);
+	    }
+
+	    // converter
+
+	    LMAT_ENSURE_INLINE
+	    operator __m256d() const
+	    {
+	    	return v;
+	    }
+
+	    LMAT_ENSURE_INLINE
+	    sse_c64pk get_low() const
+	    {
+	    	return _mm256_castpd256_pd128(v);
+	    }
+
+	    LMAT_ENSURE_INLINE
+	    sse_c64pk get_high() const
+	    {
+	    	return _mm256_extractf128_pd(v, 1);
+	    }
+
+		// set
+
+		LMAT_ENSURE_INLINE void reset()
+		{
+			v = _mm256_setzero_pd();
+		}
+
+		LMAT_ENSURE_INLINE void set(const std::complex<double>& ev)
+		{
+			v = _mm256_setr_pd(ev.real(), ev.imag(), ev.real(), ev.imag());
+		}
+
+		LMAT_ENSURE_INLINE void set(const std::complex<double>& e0, const std::complex<double>& e1)
+		{
+			v = _mm256_setr_pd(e0.real(), e0.imag(), e1.real(), e1.imag());
+		}
+
+		// load
+
+		LMAT_ENSURE_INLINE void load_u(const std::complex<double> *p)
+		{
+			v = _mm256_loadu_pd(reinterpret_cast<const double*>(p));
+		}
+
+		LMAT_ENSURE_INLINE void load_a(const std::complex<double> *p)
+		{
+			v = _mm256_load_pd(reinterpret_cast<const double*>(p));
+		}
+
+	    // gathers p[0], p[step]
+
+	    LMAT_ENSURE_INLINE void load_strided(const std::complex<double> *p, index_t step)
+	    {
+	    	__m128d lo = _mm_loadu_pd(reinterpret_cast<const double*>(p));
+	    	__m128d hi = _mm_loadu_pd(reinterpret_cast<const double*>(p + step));
+	    	v = _mm256_insertf128_pd(_mm256_castpd128_pd256(lo), hi, 1);
+	    }
+
+	    // store
+
+	    LMAT_ENSURE_INLINE void store_u(std::complex<double> *p) const
+	    {
+	    	_mm256_storeu_pd(reinterpret_cast<double*>(p), v);
+	    }
+
+	    LMAT_ENSURE_INLINE void store_a(std::complex<double> *p) const
+	    {
+	    	_mm256_store_pd(reinterpret_cast<double*>(p), v);
+	    }
+
+	    LMAT_ENSURE_INLINE void store_s(std::complex<double> *p) const  // non-temporal, p must be aligned
+	    {
+	    	_mm256_stream_pd(reinterpret_cast<double*>(p), v);
+	    }
+
+	    // extract
+
+	    LMAT_ENSURE_INLINE std::complex<double> to_scalar() const
+	    {
+	    	return std::complex<double>(e[0], e[1]);
+	    }
+
+	    LMAT_ENSURE_INLINE std::complex<double> operator[] (unsigned int i) const
+	    {
+	    	return std::complex<double>(e[2 * i], e[2 * i + 1]);
+	    }
+
+	}; // AVX c64 pack
+
+
+	/********************************************
+	 *
+	 *  Internal helpers
+	 *
+	 ********************************************/
+
+	namespace internal
+	{
+		LMAT_ENSURE_INLINE
+		inline __m256 avx_imag_signmask_ps()
+		{
+			return _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f);
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m256d avx_imag_signmask_pd()
+		{
+			return _mm256_setr_pd(0.0, -0.0, 0.0, -0.0);
+		}
+
+		// (ar * br - ai * bi, ai * br + ar * bi)
+
+		LMAT_ENSURE_INLINE
+		inline __m256 avx_cmul_ps(__m256 a, __m256 b)
+		{
+			__m256 t = _mm256_mul_ps(_mm256_permute_ps(a, 0xB1), _mm256_movehdup_ps(b));
+#ifdef LMAT_HAS_FMA
+			return _mm256_fmaddsub_ps(a, _mm256_moveldup_ps(b), t);
+#else
+			return _mm256_addsub_ps(_mm256_mul_ps(a, _mm256_moveldup_ps(b)), t);
+#endif
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m256d avx_cmul_pd(__m256d a, __m256d b)
+		{
+			__m256d t = _mm256_mul_pd(_mm256_permute_pd(a, 0x5), _mm256_permute_pd(b, 0xF));
+#ifdef LMAT_HAS_FMA
+			return _mm256_fmaddsub_pd(a, _mm256_movedup_pd(b), t);
+#else
+			return _mm256_addsub_pd(_mm256_mul_pd(a, _mm256_movedup_pd(b)), t);
+#endif
+		}
+
+		// a * conj(b') / (m |b'|^2), with m = max(|br|, |bi|) and b' = b / m
+
+		LMAT_ENSURE_INLINE
+		inline __m256 avx_cdiv_ps(__m256 a, __m256 b)
+		{
+			__m256 m = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), b);
+			m = _mm256_max_ps(m, _mm256_permute_ps(m, 0xB1));
+			b = _mm256_div_ps(b, m);
+			__m256 n = _mm256_mul_ps(b, b);
+			n = _mm256_add_ps(n, _mm256_permute_ps(n, 0xB1));
+			__m256 p = avx_cmul_ps(a, _mm256_xor_ps(b, avx_imag_signmask_ps()));
+			return _mm256_div_ps(p, _mm256_mul_ps(n, m));
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m256d avx_cdiv_pd(__m256d a, __m256d b)
+		{
+			__m256d m = _mm256_andnot_pd(_mm256_set1_pd(-0.0), b);
+			m = _mm256_max_pd(m, _mm256_permute_pd(m, 0x5));
+			b = _mm256_div_pd(b, m);
+			__m256d n = _mm256_mul_pd(b, b);
+			n = _mm256_add_pd(n, _mm256_permute_pd(n, 0x5));
+			__m256d p = avx_cmul_pd(a, _mm256_xor_pd(b, avx_imag_signmask_pd()));
+			return _mm256_div_pd(p, _mm256_mul_pd(n, m));
+		}
+
+		// |re + i im|, scaled by the larger part (as in sse_cpacks.h)
+
+		template<typename T>
+		LMAT_ENSURE_INLINE
+		inline simd_pack<T, avx_t> scaled_hypot(const simd_pack<T, avx_t>& re, const simd_pack<T, avx_t>& im)
+		{
+			simd_pack<T, avx_t> x = math::abs(re);
+			simd_pack<T, avx_t> y = math::abs(im);
+			simd_pack<T, avx_t> m = (math::max)(x, y);
+			simd_pack<T, avx_t> q = (math::min)(x, y) / m;
+			simd_pack<T, avx_t> h = m * math::sqrt(math::fma(q, q, simd_pack<T, avx_t>(T(1))));
+			return math::cond(q == q, h, x + y);
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  Arithmetic operators
+	 *
+	 ********************************************/
+
+	LMAT_ENSURE_INLINE
+	inline avx_c32pk operator + (const avx_c32pk& a, const avx_c32pk& b)
+	{
+		return _mm256_add_ps(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c64pk operator + (const avx_c64pk& a, const avx_c64pk& b)
+	{
+		return _mm256_add_pd(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c32pk operator - (const avx_c32pk& a, const avx_c32pk& b)
+	{
+		return _mm256_sub_ps(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c64pk operator - (const avx_c64pk& a, const avx_c64pk& b)
+	{
+		return _mm256_sub_pd(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c32pk operator * (const avx_c32pk& a, const avx_c32pk& b)
+	{
+		return internal::avx_cmul_ps(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c64pk operator * (const avx_c64pk& a, const avx_c64pk& b)
+	{
+		return internal::avx_cmul_pd(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c32pk operator / (const avx_c32pk& a, const avx_c32pk& b)
+	{
+		return internal::avx_cdiv_ps(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c64pk operator / (const avx_c64pk& a, const avx_c64pk& b)
+	{
+		return internal::avx_cdiv_pd(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c32pk operator - (const avx_c32pk& a)
+	{
+		return _mm256_xor_ps(_mm256_set1_ps(-0.0f), a);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c64pk operator - (const avx_c64pk& a)
+	{
+		return _mm256_xor_pd(_mm256_set1_pd(-0.0), a);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c32pk& operator += (avx_c32pk& a, const avx_c32pk& b)
+	{
+		a = _mm256_add_ps(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c64pk& operator += (avx_c64pk& a, const avx_c64pk& b)
+	{
+		a = _mm256_add_pd(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c32pk& operator -= (avx_c32pk& a, const avx_c32pk& b)
+	{
+		a = _mm256_sub_ps(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c64pk& operator -= (avx_c64pk& a, const avx_c64pk& b)
+	{
+		a = _mm256_sub_pd(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c32pk& operator *= (avx_c32pk& a, const avx_c32pk& b)
+	{
+		a = internal::avx_cmul_ps(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c64pk& operator *= (avx_c64pk& a, const avx_c64pk& b)
+	{
+		a = internal::avx_cmul_pd(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c32pk& operator /= (avx_c32pk& a, const avx_c32pk& b)
+	{
+		a = internal::avx_cdiv_ps(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_c64pk& operator /= (avx_c64pk& a, const avx_c64pk& b)
+	{
+		a = internal::avx_cdiv_pd(a, b);
+		return a;
+	}
+
+
+	/********************************************
+	 *
+	 *  Reduction
+	 *
+	 ********************************************/
+
+	LMAT_ENSURE_INLINE
+	inline std::complex<float> sum(const avx_c32pk& a)
+	{
+		return sum(sse_c32pk(_mm_add_ps(a.get_low(), a.get_high())));
+	}
+
+	LMAT_ENSURE_INLINE
+	inline std::complex<double> sum(const avx_c64pk& a)
+	{
+		return sse_c64pk(_mm_add_pd(a.get_low(), a.get_high())).to_scalar();
+	}
+
+
+	/********************************************
+	 *
+	 *  Parts of complex packs
+	 *
+	 ********************************************/
+
+	LMAT_ENSURE_INLINE
+	inline avx_f32pk real(const avx_c32pk& a0, const avx_c32pk& a1)
+	{
+		__m256 lo = _mm256_permute2f128_ps(a0, a1, 0x20);
+		__m256 hi = _mm256_permute2f128_ps(a0, a1, 0x31);
+		return _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_f64pk real(const avx_c64pk& a0, const avx_c64pk& a1)
+	{
+		__m256d lo = _mm256_permute2f128_pd(a0, a1, 0x20);
+		__m256d hi = _mm256_permute2f128_pd(a0, a1, 0x31);
+		return _mm256_unpacklo_pd(lo, hi);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_f32pk imag(const avx_c32pk& a0, const avx_c32pk& a1)
+	{
+		__m256 lo = _mm256_permute2f128_ps(a0, a1, 0x20);
+		__m256 hi = _mm256_permute2f128_ps(a0, a1, 0x31);
+		return _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+	}
+
+	LMAT_ENSURE_INLINE
+	inline avx_f64pk imag(const avx_c64pk& a0, const avx_c64pk& a1)
+	{
+		__m256d lo = _mm256_permute2f128_pd(a0, a1, 0x20);
+		__m256d hi = _mm256_permute2f128_pd(a0, a1, 0x31);
+		return _mm256_unpackhi_pd(lo, hi);
+	}
+
+	template<typename T>
+	LMAT_ENSURE_INLINE
+	inline simd_pack<T, avx_t> norm(const simd_pack<std::complex<T>, avx_t>& a0, const simd_pack<std::complex<T>, avx_t>& a1)
+	{
+		simd_pack<T, avx_t> re = real(a0, a1);
+		simd_pack<T, avx_t> im = imag(a0, a1);
+		return math::fma(re, re, im * im);
+	}
+
+	template<typename T>
+	LMAT_ENSURE_INLINE
+	inline simd_pack<T, avx_t> abs(const simd_pack<std::complex<T>, avx_t>& a0, const simd_pack<std::complex<T>, avx_t>& a1)
+	{
+		return internal::scaled_hypot(real(a0, a1), imag(a0, a1));
+	}
+
+
+	namespace math
+	{
+		LMAT_ENSURE_INLINE
+		inline avx_c32pk conj(const avx_c32pk& a)
+		{
+			return _mm256_xor_ps(a, lmat::internal::avx_imag_signmask_ps());
+		}
+
+		LMAT_ENSURE_INLINE
+		inline avx_c64pk conj(const avx_c64pk& a)
+		{
+			return _mm256_xor_pd(a, lmat::internal::avx_imag_signmask_pd());
+		}
+
+		// x * y + z
+
+		LMAT_ENSURE_INLINE
+		inline avx_c32pk fma(const avx_c32pk& x, const avx_c32pk& y, const avx_c32pk& z)
+		{
+			return _mm256_add_ps(lmat::internal::avx_cmul_ps(x, y), z);
+		}
+
+		LMAT_ENSURE_INLINE
+		inline avx_c64pk fma(const avx_c64pk& x, const avx_c64pk& y, const avx_c64pk& z)
+		{
+			return _mm256_add_pd(lmat::internal::avx_cmul_pd(x, y), z);
+		}
+	}
+
+}
+
+#endif /* AVX_CPACKS_H_ */
@@ -164,6 +164,35 @@ namespace lmat
 	    	v = _mm256_maskload_ps(p, internal::avx_part_mask_32(n));
 	    }
 
+	    // gathers p[0], p[step], ..., p[7 * step]
+
+	    LMAT_ENSURE_INLINE void load_strided(const float *p, index_t step)
+	    {
+	    	if (step == 2)
+	    	{
+	    		v = _mm256_insertf128_ps(_mm256_castps128_ps256(internal::sse_load_step2_f32(p)),
+	    				internal::sse_load_step2_f32(p + 8), 1);
+	    		return;
+	    	}
+	    	if (step == 3)
+	    	{
+	    		v = _mm256_insertf128_ps(_mm256_castps128_ps256(internal::sse_load_step3_f32(p)),
+	    				internal::sse_load_step3_f32(p + 12), 1);
+	    		return;
+	    	}
+#ifdef LMAT_HAS_AVX2
+	    	if ((size_t)(step < 0 ? -step : step) < ((size_t)1 << 28))
+	    	{
+	    		const int s = (int)step;
+	    		const __m256i idx = _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+	    		v = _mm256_i32gather_ps(p, idx, 4);
+	    		return;
+	    	}
+#endif
+	    	v = _mm256_setr_ps(p[0], p[step], p[2 * step], p[3 * step],
+	    			p[4 * step], p[5 * step], p[6 * step], p[7 * step]);
+	    }
+
 	    // store
 
 	    LMAT_ENSURE_INLINE void store_u(float *p) const
@@ -176,6 +205,11 @@ namespace lmat
 	    	_mm256_store_ps(p, v);
 	    }
 
+	    LMAT_ENSURE_INLINE void store_s(float *p) const  // non-temporal, p must be aligned
+	    {
+	    	_mm256_stream_ps(p, v);
+	    }
+
 	    template<unsigned int N>
 	    LMAT_ENSURE_INLINE void store_part(siz_<N> n, float *p) const
 	    {
@@ -344,6 +378,19 @@ namespace lmat
 	    	v = _mm256_maskload_pd(p, internal::avx_part_mask_64(n));
 	    }
 
+	    // gathers p[0], p[step], p[2 * step], p[3 * step]
+
+	    LMAT_ENSURE_INLINE void load_strided(const double *p, index_t step)
+	    {
+#ifdef LMAT_HAS_AVX2
+	    	const long long s = (long long)step;
+	    	const __m256i idx = _mm256_setr_epi64x(0, s, 2 * s, 3 * s);
+	    	v = _mm256_i64gather_pd(p, idx, 8);
+#else
+	    	v = _mm256_setr_pd(p[0], p[step], p[2 * step], p[3 * step]);
+#endif
+	    }
+
 	    // store
 
 	    LMAT_ENSURE_INLINE void store_u(double *p) const
@@ -356,6 +403,11 @@ namespace lmat
 	    	_mm256_store_pd(p, v);
 	    }
 
+	    LMAT_ENSURE_INLINE void store_s(double *p) const  // non-temporal, p must be aligned
+	    {
+	    	_mm256_stream_pd(p, v);
+	    }
+
 	    template<unsigned int N>
 	    LMAT_ENSURE_INLINE void store_part(siz_<N> n, double *p) const
 	    {
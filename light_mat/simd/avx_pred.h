@@ -17,6 +17,10 @@
 #include <light_mat/simd/avx_bpacks.h>
 #include "internal/sse_fpclass_impl.h"
 
+#ifdef LMAT_HAS_AVX2
+#include "internal/avx2_fpclass_impl.h"
+#endif
+
 namespace lmat { namespace meta {
 
 	// comparison
@@ -235,68 +239,100 @@ namespace lmat { namespace math {
 	LMAT_ENSURE_INLINE
 	inline avx_f32bpk signbit(const avx_f32pk& a)
 	{
+#ifdef LMAT_HAS_AVX2
+		return lmat::internal::avx2_is_neg_ps(a);
+#else
 		return lmat::internal::combine_m128(
 				lmat::internal::sse_is_neg_ps(a.get_low()),
 				lmat::internal::sse_is_neg_ps(a.get_high()));
+#endif
 	}
 
 	LMAT_ENSURE_INLINE
 	inline avx_f64bpk signbit(const avx_f64pk& a)
 	{
+#ifdef LMAT_HAS_AVX2
+		return lmat::internal::avx2_is_neg_pd(a);
+#else
 		return lmat::internal::combine_m128d(
 				lmat::internal::sse_is_neg_pd(a.get_low()),
 				lmat::internal::sse_is_neg_pd(a.get_high()));
+#endif
 	}
 
 
 	LMAT_ENSURE_INLINE
 	inline avx_f32bpk isfinite(const avx_f32pk& a)
 	{
+#ifdef LMAT_HAS_AVX2
+		return lmat::internal::avx2_is_finite_ps(a);
+#else
 		return lmat::internal::combine_m128(
 				lmat::internal::sse_is_finite_ps(a.get_low()),
 				lmat::internal::sse_is_finite_ps(a.get_high()));
+#endif
 	}
 
 	LMAT_ENSURE_INLINE
 	inline avx_f64bpk isfinite(const avx_f64pk& a)
 	{
+#ifdef LMAT_HAS_AVX2
+		return lmat::internal::avx2_is_finite_pd(a);
+#else
 		return lmat::internal::combine_m128d(
 				lmat::internal::sse_is_finite_pd(a.get_low()),
 				lmat::internal::sse_is_finite_pd(a.get_high()));
+#endif
 	}
 
 
 	LMAT_ENSURE_INLINE
 	inline avx_f32bpk isinf(const avx_f32pk& a)
 	{
+#ifdef LMAT_HAS_AVX2
+		return lmat::internal::avx2_is_inf_ps(a);
+#else
 		return lmat::internal::combine_m128(
 				lmat::internal::sse_is_inf_ps(a.get_low()),
 				lmat::internal::sse_is_inf_ps(a.get_high()));
+#endif
 	}
 
 	LMAT_ENSURE_INLINE
 	inline avx_f64bpk isinf(const avx_f64pk& a)
 	{
+#ifdef LMAT_HAS_AVX2
+		return lmat::internal::avx2_is_inf_pd(a);
+#else
 		return lmat::internal::combine_m128d(
 				lmat::internal::sse_is_inf_pd(a.get_low()),
 				lmat::internal::sse_is_inf_pd(a.get_high()));
+#endif
 	}
 
 
 	LMAT_ENSURE_INLINE
 	inline avx_f32bpk isnan(const avx_f32pk& a)
 	{
+#ifdef LMAT_HAS_AVX2
+		return lmat::internal::avx2_is_nan_ps(a);
+#else
 		return lmat::internal::combine_m128(
 				lmat::internal::sse_is_nan_ps(a.get_low()),
 				lmat::internal::sse_is_nan_ps(a.get_high()));
+#endif
 	}
 
 	LMAT_ENSURE_INLINE
 	inline avx_f64bpk isnan(const avx_f64pk& a)
 	{
+#ifdef LMAT_HAS_AVX2
+		return lmat::internal::avx2_is_nan_pd(a);
+#else
 		return lmat::internal::combine_m128d(
 				lmat::internal::sse_is_nan_pd(a.get_low()),
 				lmat::internal::sse_is_nan_pd(a.get_high()));
+#endif
 	}
 
 } }
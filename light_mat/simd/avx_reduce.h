@@ -65,6 +65,78 @@ namespace lmat
 	}
 
 
+	// inclusive prefix scans: each 128-bit half is scanned,
+	// then the last lane of the lower half is carried over
+
+	namespace internal
+	{
+		LMAT_ENSURE_INLINE
+		inline __m256 avx_shift1_f32(__m256 x, __m256 id)  // within halves
+		{
+			return _mm256_blend_ps(_mm256_permute_ps(x, 0x90), id, 0x11);
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m256 avx_shift2_f32(__m256 x, __m256 id)  // within halves
+		{
+			return _mm256_blend_ps(_mm256_permute_ps(x, 0x40), id, 0x33);
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m256 avx_carry_f32(__m256 x, __m256 id)
+		{
+			__m256 t = _mm256_permute_ps(x, 0xff);
+			return _mm256_blend_ps(_mm256_permute2f128_ps(t, t, 0x00), id, 0x0f);
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m256d avx_shift1_f64(__m256d x, __m256d id)  // within halves
+		{
+			return _mm256_blend_pd(_mm256_permute_pd(x, 0x0), id, 0x5);
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m256d avx_carry_f64(__m256d x, __m256d id)
+		{
+			__m256d t = _mm256_permute_pd(x, 0xf);
+			return _mm256_blend_pd(_mm256_permute2f128_pd(t, t, 0x00), id, 0x3);
+		}
+
+		// max & min that propagate NaN from either operand
+
+#define LMAT_DEFINE_AVX_NAN_PROP_OP( Name, Op, PS, PD ) \
+		LMAT_ENSURE_INLINE \
+		inline __m256 Name##_f32(__m256 x, __m256 y) { \
+			return _mm256_blendv_ps(Op##PS(x, y), x, _mm256_cmp_ps(x, x, _CMP_UNORD_Q)); } \
+		LMAT_ENSURE_INLINE \
+		inline __m256d Name##_f64(__m256d x, __m256d y) { \
+			return _mm256_blendv_pd(Op##PD(x, y), x, _mm256_cmp_pd(x, x, _CMP_UNORD_Q)); }
+
+		LMAT_DEFINE_AVX_NAN_PROP_OP( avx_nmax, _mm256_max, _ps, _pd )
+		LMAT_DEFINE_AVX_NAN_PROP_OP( avx_nmin, _mm256_min, _ps, _pd )
+	}
+
+#define LMAT_DEFINE_AVX_PREFIX_SCAN( Name, OpPS, OpPD, IdF32, IdF64 ) \
+	LMAT_ENSURE_INLINE \
+	inline avx_f32pk Name(const avx_f32pk& a) { \
+		const __m256 id = IdF32; \
+		__m256 x = a; \
+		x = OpPS(x, internal::avx_shift1_f32(x, id)); \
+		x = OpPS(x, internal::avx_shift2_f32(x, id)); \
+		return OpPS(x, internal::avx_carry_f32(x, id)); } \
+	LMAT_ENSURE_INLINE \
+	inline avx_f64pk Name(const avx_f64pk& a) { \
+		const __m256d id = IdF64; \
+		__m256d x = a; \
+		x = OpPD(x, internal::avx_shift1_f64(x, id)); \
+		return OpPD(x, internal::avx_carry_f64(x, id)); }
+
+	LMAT_DEFINE_AVX_PREFIX_SCAN( prefix_sum,  _mm256_add_ps, _mm256_add_pd, _mm256_setzero_ps(), _mm256_setzero_pd() )
+	LMAT_DEFINE_AVX_PREFIX_SCAN( prefix_prod, _mm256_mul_ps, _mm256_mul_pd, _mm256_set1_ps(1.0f), _mm256_set1_pd(1.0) )
+	LMAT_DEFINE_AVX_PREFIX_SCAN( prefix_max,  internal::avx_nmax_f32, internal::avx_nmax_f64, avx_f32pk::neg_inf(), avx_f64pk::neg_inf() )
+	LMAT_DEFINE_AVX_PREFIX_SCAN( prefix_min,  internal::avx_nmin_f32, internal::avx_nmin_f64, avx_f32pk::inf(), avx_f64pk::inf() )
+
+
 	// all & any
 
 	LMAT_ENSURE_INLINE
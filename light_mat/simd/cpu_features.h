@@ -0,0 +1,150 @@
+/**
+ * @file cpu_features.h
+ *
+ * @brief Run-time detection of the SIMD instruction sets
+ *
+ * LMAT_SIMD_LEVEL tells what the compiler was allowed to
+ * emit. The functions here tell what the processor (and the
+ * operating system) actually support, which is what the
+ * run-time dispatch (see light_mat/dispatch) is based on.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_CPU_FEATURES_H_
+#define LIGHTMAT_CPU_FEATURES_H_
+
+#include <light_mat/common/prim_types.h>
+#include <light_mat/simd/simd_arch.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+namespace lmat
+{
+	/********************************************
+	 *
+	 *  SIMD levels
+	 *
+	 *  The values agree with LMAT_SIMD_LEVEL.
+	 *  The avx2 level also requires FMA3.
+	 *
+	 ********************************************/
+
+	const int sse2_level = 2;
+	const int avx_level  = 7;
+	const int avx2_level = 8;
+
+
+	namespace internal
+	{
+		LMAT_ENSURE_INLINE
+		inline void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int *r)
+		{
+#ifdef _MSC_VER
+			int v[4];
+			__cpuidex(v, (int)leaf, (int)subleaf);
+			for (int i = 0; i < 4; ++i) r[i] = (unsigned int)v[i];
+#else
+			__cpuid_count(leaf, subleaf, r[0], r[1], r[2], r[3]);
+#endif
+		}
+
+		// whether the OS saves the YMM registers on context switches
+
+		inline bool os_saves_ymm()
+		{
+#ifdef _MSC_VER
+			unsigned long long xcr0 = _xgetbv(0);
+#else
+			unsigned int lo, hi;
+			__asm__ __volatile__ ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+			unsigned long long xcr0 = ((unsigned long long)hi << 32) | lo;
+#endif
+			return (xcr0 & 6) == 6;
+		}
+	}
+
+
+	// the highest level supported by the processor and the OS
+
+	inline int detect_simd_level()
+	{
+		unsigned int r[4];  // eax, ebx, ecx, edx
+
+		internal::cpuid(0, 0, r);
+		const unsigned int max_leaf = r[0];
+
+		internal::cpuid(1, 0, r);
+		const bool osxsave = (r[2] >> 27) & 1;
+		const bool has_avx = (r[2] >> 28) & 1;
+		const bool has_fma = (r[2] >> 12) & 1;
+
+		if (!(osxsave && has_avx && internal::os_saves_ymm())) return sse2_level;
+
+		bool has_avx2 = false;
+		if (max_leaf >= 7)
+		{
+			internal::cpuid(7, 0, r);
+			has_avx2 = (r[1] >> 5) & 1;
+		}
+
+		return has_avx2 && has_fma ? avx2_level : avx_level;
+	}
+
+
+	// parses "sse2", "avx", or "avx2" (the names used by LMAT_TARGET_ISA),
+	// returns -1 for other names
+
+	inline int parse_simd_level(const char *name)
+	{
+		if (std::strcmp(name, "sse2") == 0) return sse2_level;
+		if (std::strcmp(name, "avx") == 0) return avx_level;
+		if (std::strcmp(name, "avx2") == 0) return avx2_level;
+		return -1;
+	}
+
+
+	/********************************************
+	 *
+	 *  the level used by run-time dispatch
+	 *
+	 *  It is the detected level, unless the
+	 *  environment variable LMAT_SIMD_ISA names
+	 *  a lower one (e.g. for benchmarking).
+	 *  Requests for unsupported levels and
+	 *  unknown names are ignored.
+	 *
+	 *  The result is determined once.
+	 *
+	 ********************************************/
+
+	inline int select_simd_level(int detected, const char *request)
+	{
+		if (request)
+		{
+			int r = parse_simd_level(request);
+			if (r > 0 && r < detected) return r;
+		}
+		return detected;
+	}
+
+	inline int runtime_simd_level()
+	{
+		static const int level = select_simd_level(detect_simd_level(), std::getenv("LMAT_SIMD_ISA"));
+		return level;
+	}
+
+}
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * @file avx2_fpclass_impl.h
+ *
+ * @brief Implementation of FP classification on AVX2
+ *
+ * AVX2 provides 256-bit integer operations, so that the
+ * classification can be done on a whole pack, without
+ * splitting it into two SSE halves.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_AVX2_FPCLASS_IMPL_H_
+#define LIGHTMAT_AVX2_FPCLASS_IMPL_H_
+
+#include <light_mat/simd/simd_base.h>
+#include "numrepr_format.h"
+
+#ifndef LMAT_HAS_AVX2
+#error Only include avx2_fpclass_impl.h when AVX2 is enabled.
+#endif
+
+namespace lmat { namespace internal {
+
+	LMAT_ENSURE_INLINE
+	inline __m256 avx2_is_neg_ps(const __m256& a)
+	{
+		return _mm256_castsi256_ps(_mm256_srai_epi32(_mm256_castps_si256(a), 31));
+	}
+
+	LMAT_ENSURE_INLINE
+	inline __m256d avx2_is_neg_pd(const __m256d& a)
+	{
+		return _mm256_castsi256_pd(_mm256_cmpgt_epi64(
+				_mm256_setzero_si256(), _mm256_castpd_si256(a)));
+	}
+
+
+	LMAT_ENSURE_INLINE
+	inline __m256 avx2_is_finite_ps(const __m256& a)
+	{
+		typedef num_fmt<float> fmt;
+
+		__m256i exp_m = _mm256_set1_epi32(fmt::exponent_bits);
+		__m256i exp = _mm256_and_si256(exp_m, _mm256_castps_si256(a));
+		__m256i not_finite = _mm256_cmpeq_epi32(exp, exp_m);
+		return _mm256_castsi256_ps(_mm256_xor_si256(not_finite, _mm256_set1_epi32(-1)));
+	}
+
+	LMAT_ENSURE_INLINE
+	inline __m256d avx2_is_finite_pd(const __m256d& a)
+	{
+		typedef num_fmt<double> fmt;
+
+		__m256i exp_m = _mm256_set1_epi64x(fmt::exponent_bits);
+		__m256i exp = _mm256_and_si256(exp_m, _mm256_castpd_si256(a));
+		__m256i not_finite = _mm256_cmpeq_epi64(exp, exp_m);
+		return _mm256_castsi256_pd(_mm256_xor_si256(not_finite, _mm256_set1_epi32(-1)));
+	}
+
+
+	LMAT_ENSURE_INLINE
+	inline __m256 avx2_is_inf_ps(const __m256& a)
+	{
+		typedef num_fmt<float> fmt;
+
+		__m256i ai = _mm256_and_si256(_mm256_castps_si256(a),
+				_mm256_set1_epi32(fmt::exponent_bits | fmt::mantissa_bits));
+		return _mm256_castsi256_ps(_mm256_cmpeq_epi32(ai, _mm256_set1_epi32(fmt::exponent_bits)));
+	}
+
+	LMAT_ENSURE_INLINE
+	inline __m256d avx2_is_inf_pd(const __m256d& a)
+	{
+		typedef num_fmt<double> fmt;
+
+		__m256i ai = _mm256_and_si256(_mm256_castpd_si256(a),
+				_mm256_set1_epi64x(fmt::exponent_bits | fmt::mantissa_bits));
+		return _mm256_castsi256_pd(_mm256_cmpeq_epi64(ai, _mm256_set1_epi64x(fmt::exponent_bits)));
+	}
+
+
+	LMAT_ENSURE_INLINE
+	inline __m256 avx2_is_nan_ps(const __m256& a)
+	{
+		typedef num_fmt<float> fmt;
+
+		// with the sign cleared, NaNs are exactly those above +inf
+
+		__m256i ai = _mm256_and_si256(_mm256_castps_si256(a),
+				_mm256_set1_epi32(fmt::exponent_bits | fmt::mantissa_bits));
+		return _mm256_castsi256_ps(_mm256_cmpgt_epi32(ai, _mm256_set1_epi32(fmt::exponent_bits)));
+	}
+
+	LMAT_ENSURE_INLINE
+	inline __m256d avx2_is_nan_pd(const __m256d& a)
+	{
+		typedef num_fmt<double> fmt;
+
+		__m256i ai = _mm256_and_si256(_mm256_castpd_si256(a),
+				_mm256_set1_epi64x(fmt::exponent_bits | fmt::mantissa_bits));
+		return _mm256_castsi256_pd(_mm256_cmpgt_epi64(ai, _mm256_set1_epi64x(fmt::exponent_bits)));
+	}
+
+} }
+
+#endif
@@ -50,7 +50,7 @@ namespace lmat { namespace internal {
 
 		__m128i sgn_m = sse_signmask_pd();
 		__m128i sgn   = _mm_and_si128(sgn_m, ai);
-		return _mm_castsi128_pd(_mm_cmpeq_epi64(sgn, sgn_m));
+		return _mm_castsi128_pd(sse_cmpeq_epi64(sgn, sgn_m));
 	}
 
 
@@ -72,7 +72,7 @@ namespace lmat { namespace internal {
 
 		__m128i exp_m = sse_expmask_pd();
 		__m128i exp = _mm_and_si128(exp_m, ai);
-		__m128i not_finite = _mm_cmpeq_epi64(exp, exp_m);
+		__m128i not_finite = sse_cmpeq_epi64(exp, exp_m);
 		return _mm_castsi128_pd(sse_bitwise_not(not_finite));
 	}
 
@@ -92,7 +92,7 @@ namespace lmat { namespace internal {
 		__m128i ai = _mm_castpd_si128(a);
 		ai = _mm_andnot_si128(sse_signmask_pd(), ai);
 
-		return _mm_castsi128_pd(_mm_cmpeq_epi64(ai, sse_expmask_pd()));
+		return _mm_castsi128_pd(sse_cmpeq_epi64(ai, sse_expmask_pd()));
 	}
 
 
@@ -126,8 +126,8 @@ namespace lmat { namespace internal {
 		__m128i s = _mm_and_si128(ai, s_msk);
 
 		return _mm_castsi128_pd(_mm_andnot_si128(
-				_mm_cmpeq_epi64(s, _mm_setzero_si128()),
-				_mm_cmpeq_epi64(e, e_msk)));
+				sse_cmpeq_epi64(s, _mm_setzero_si128()),
+				sse_cmpeq_epi64(e, e_msk)));
 	}
 
 } }
@@ -109,6 +109,25 @@ namespace lmat { namespace internal {
 	}
 
 
+	// strided loads by deinterleaving, touching p[0] .. p[3 * step] only
+
+	LMAT_ENSURE_INLINE
+	inline __m128 sse_load_step2_f32(const float *p)
+	{
+		__m128 a = _mm_loadu_ps(p);      // p0 p1 p2 p3
+		__m128 b = _mm_loadu_ps(p + 3);  // p3 p4 p5 p6
+		return _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 2, 0));
+	}
+
+	LMAT_ENSURE_INLINE
+	inline __m128 sse_load_step3_f32(const float *p)
+	{
+		__m128 a = _mm_loadu_ps(p);      // p0 p1 p2 p3
+		__m128 b = _mm_loadu_ps(p + 6);  // p6 p7 p8 p9
+		return _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 0, 3, 0));
+	}
+
+
 	// extract scalar
 
 	LMAT_ENSURE_INLINE
@@ -220,6 +239,19 @@ namespace lmat { namespace internal {
 		typedef num_fmt<double> fmt;
 		return _mm_set1_epi64x(fmt::sign_bit);
 	}
+
+	// 64-bit integer comparison (SSE4.1 instruction, emulated on SSE2)
+
+	LMAT_ENSURE_INLINE
+	inline __m128i sse_cmpeq_epi64(const __m128i& a, const __m128i& b)
+	{
+#ifdef LMAT_HAS_SSE4_1
+		return _mm_cmpeq_epi64(a, b);
+#else
+		__m128i t = _mm_cmpeq_epi32(a, b);
+		return _mm_and_si128(t, _mm_shuffle_epi32(t, _MM_SHUFFLE(2, 3, 0, 1)));
+#endif
+	}
 } }
 
 
@@ -71,6 +71,13 @@
 #define LMAT_HAS_AVX2
 #endif
 
+// FMA3 is a separate extension: it comes with every AVX2 processor,
+// but compilers only enable it with -mfma (or a suitable -march)
+
+#if defined(LMAT_HAS_AVX) && defined( __FMA__ )
+#define LMAT_HAS_FMA
+#endif
+
 
 #if (!defined(LMAT_HAS_SSE2))
 #error LightMatrix requires at least SSE2 support.
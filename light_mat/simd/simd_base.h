@@ -17,6 +17,7 @@
 #include <light_mat/common/basic_defs.h>
 #include <light_mat/math/fun_tags.h>
 #include <limits>
+#include <complex>
 
 // system headers for SIMD intrinsics
 
@@ -115,6 +116,14 @@ namespace lmat {
 	template<> struct has_simd_support<ftags::FTag, float, avx_t> : public true_ { }; \
 	template<> struct has_simd_support<ftags::FTag, double, avx_t> : public true_ { };
 
+#define LMAT_DEFINE_HAS_SSE_COMPLEX_SUPPORT( FTag ) \
+	template<> struct has_simd_support<ftags::FTag, std::complex<float>, sse_t> : public true_ { }; \
+	template<> struct has_simd_support<ftags::FTag, std::complex<double>, sse_t> : public true_ { };
+
+#define LMAT_DEFINE_HAS_AVX_COMPLEX_SUPPORT( FTag ) \
+	template<> struct has_simd_support<ftags::FTag, std::complex<float>, avx_t> : public true_ { }; \
+	template<> struct has_simd_support<ftags::FTag, std::complex<double>, avx_t> : public true_ { };
+
 #endif /* SIMD_BASE_H_ */
 
 
@@ -18,5 +18,6 @@
 #include <light_mat/simd/sse_arith.h>
 #include <light_mat/simd/sse_pred.h>
 #include <light_mat/simd/sse_reduce.h>
+#include <light_mat/simd/sse_cpacks.h>
 
 #endif /* SSE_H_ */
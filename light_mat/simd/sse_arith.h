@@ -188,13 +188,21 @@ namespace lmat { namespace math {
 	LMAT_ENSURE_INLINE
 	inline sse_f32pk fma(const sse_f32pk& x, const sse_f32pk& y, const sse_f32pk& z)
 	{
+#ifdef LMAT_HAS_FMA
+		return _mm_fmadd_ps(x, y, z);
+#else
 		return _mm_add_ps(_mm_mul_ps(x, y), z);
+#endif
 	}
 
 	LMAT_ENSURE_INLINE
 	inline sse_f64pk fma(const sse_f64pk& x, const sse_f64pk& y, const sse_f64pk& z)
 	{
+#ifdef LMAT_HAS_FMA
+		return _mm_fmadd_pd(x, y, z);
+#else
 		return _mm_add_pd(_mm_mul_pd(x, y), z);
+#endif
 	}
 
 	LMAT_ENSURE_INLINE
@@ -0,0 +1,672 @@
+/**
+ * @file sse_cpacks.h
+ *
+ * @brief SSE packs of complex numbers
+ *
+ * Complex values are stored interleaved (re, im, re, im, ...), the same
+ * layout as std::complex arrays, so that packs are loaded and stored
+ * directly from/to the matrix memory. A pack holds 2 complex<float> or
+ * 1 complex<double>.
+ *
+ * Multiplication duplicates the real and imaginary parts of the second
+ * operand (moveldup/movehdup), swaps the parts of the first one, and
+ * combines both products with addsub (or fmaddsub when FMA is enabled).
+ * Division first scales b by m = max(|br|, |bi|), then multiplies by the
+ * conjugate of b/m and divides by m|b/m|^2, so that, as with std::complex,
+ * the squared modulus neither overflows nor underflows.
+ *
+ * real/imag/norm/abs take two complex packs and give one real pack of
+ * the same width in bytes, which is how they are applied to columns.
+ * abs is likewise computed as m * sqrt(1 + (min/m)^2), m = max(|re|, |im|).
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef LIGHTMAT_SSE_CPACKS_H_
+#define LIGHTMAT_SSE_CPACKS_H_
+
+#include <light_mat/simd/sse_arith.h>
+#include <light_mat/simd/sse_pred.h>
+#include <complex>
+
+namespace lmat { namespace meta {
+
+	LMAT_DEFINE_HAS_SSE_COMPLEX_SUPPORT( add_ )
+	LMAT_DEFINE_HAS_SSE_COMPLEX_SUPPORT( sub_ )
+	LMAT_DEFINE_HAS_SSE_COMPLEX_SUPPORT( mul_ )
+	LMAT_DEFINE_HAS_SSE_COMPLEX_SUPPORT( div_ )
+	LMAT_DEFINE_HAS_SSE_COMPLEX_SUPPORT( neg_ )
+	LMAT_DEFINE_HAS_SSE_COMPLEX_SUPPORT( conj_ )
+
+} }
+
+
+namespace lmat {
+
+	/********************************************
+	 *
+	 *  trait classes
+	 *
+	 ********************************************/
+
+	LMAT_DEFINE_SIMD_TRAITS( sse_t, std::complex<float>,  2, 16 )
+	LMAT_DEFINE_SIMD_TRAITS( sse_t, std::complex<double>, 1, 16 )
+
+
+	/********************************************
+	 *
+	 *  pack classes
+	 *
+	 ********************************************/
+
+	typedef simd_pack<std::complex<float>,  sse_t> sse_c32pk;
+	typedef simd_pack<std::complex<double>, sse_t> sse_c64pk;
+
+
+	template<>
+	class simd_pack<std::complex<float>, sse_t>
+	{
+	private:
+		union
+		{
+			__m128 v;
+			LMAT_ALIGN_SSE float e[4];
+		};
+
+	public:
+		LMAT_DEFINE_FOR_SIMD_PACK( sse_t, std::complex<float>, 2 )
+
+		LMAT_ENSURE_INLINE
+		unsigned int width() const
+		{
+			return pack_width;
+		}
+
+		// constructors
+
+		LMAT_ENSURE_INLINE simd_pack() { }
+
+		LMAT_ENSURE_INLINE simd_pack(const __m128& v_) : v(v_) { }
+
+		LMAT_ENSURE_INLINE simd_pack(const std::complex<float>& ev)
+		{
+			set(ev);
+		}
+
+		LMAT_ENSURE_INLINE simd_pack(const std::complex<float>& e0, const std::complex<float>& e1)
+		{
+			set(e0, e1);
+		}
+
+		LMAT_ENSURE_INLINE explicit simd_pack(const std::complex<float> *p)
+		{
+			load_u(p);
+		}
+
+	    LMAT_ENSURE_INLINE
+	    static simd_pack zeros()
+	    {
+	    	return _mm_setzero_ps();
+	    }
+
+	    LMAT_ENSURE_INLINE
+	    static simd_pack ones()
+	    {
+	    	return _mm_setr_ps(1.0f, 0.0f, 1.0f, 0.0f);
+	    }
+
+	    // converter
+
+	    LMAT_ENSURE_INLINE
+	    operator __m128() const
+	    {
+	    	return v;
+	    }
+
+		// set
+
+		LMAT_ENSURE_INLINE void reset()
+		{
+			v = _mm_setzero_ps();
+		}
+
+		LMAT_ENSURE_INLINE void set(const std::complex<float>& ev)
+		{
+			v = _mm_setr_ps(ev.real(), ev.imag(), ev.real(), ev.imag());
+		}
+
+		LMAT_ENSURE_INLINE void set(const std::complex<float>& e0, const std::complex<float>& e1)
+		{
+			v = _mm_setr_ps(e0.real(), e0.imag(), e1.real(), e1.imag());
+		}
+
+		// load
+
+		LMAT_ENSURE_INLINE void load_u(const std::complex<float> *p)
+		{
+			v = _mm_loadu_ps(reinterpret_cast<const float*>(p));
+		}
+
+		LMAT_ENSURE_INLINE void load_a(const std::complex<float> *p)
+		{
+			v = _mm_load_ps(reinterpret_cast<const float*>(p));
+		}
+
+	    // gathers p[0], p[step] (each element is one 64-bit load)
+
+	    LMAT_ENSURE_INLINE void load_strided(const std::complex<float> *p, index_t step)
+	    {
+	    	// through __m64 pointers, which may alias the float parts
+	    	__m128 lo = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p));
+	    	v = _mm_loadh_pi(lo, reinterpret_cast<const __m64*>(p + step));
+	    }
+
+	    // store
+
+	    LMAT_ENSURE_INLINE void store_u(std::complex<float> *p) const
+	    {
+	    	_mm_storeu_ps(reinterpret_cast<float*>(p), v);
+	    }
+
+	    LMAT_ENSURE_INLINE void store_a(std::complex<float> *p) const
+	    {
+	    	_mm_store_ps(reinterpret_cast<float*>(p), v);
+	    }
+
+	    LMAT_ENSURE_INLINE void store_s(std::complex<float> *p) const  // non-temporal, p must be aligned
+	    {
+	    	_mm_stream_ps(reinterpret_cast<float*>(p), v);
+	    }
+
+	    // extract
+
+	    LMAT_ENSURE_INLINE std::complex<float> to_scalar() const
+	    {
+	    	return std::complex<float>(e[0], e[1]);
+	    }
+
+	    LMAT_ENSURE_INLINE std::complex<float> operator[] (unsigned int i) const
+	    {
+	    	return std::complex<float>(e[2 * i], e[2 * i + 1]);
+	    }
+
+	}; // SSE c32 pack
+
+
+	template<>
+	class simd_pack<std::complex<double>, sse_t>
+	{
+	private:
+		union
+		{
+			__m128d v;
+			LMAT_ALIGN_SSE double e[2];
+		};
+
+	public:
+		LMAT_DEFINE_FOR_SIMD_PACK( sse_t, std::complex<double>, 1 )
+
+		LMAT_ENSURE_INLINE
+		unsigned int width() const
+		{
+			return pack_width;
+		}
+
+		// constructors
+
+		LMAT_ENSURE_INLINE simd_pack() { }
+
+		LMAT_ENSURE_INLINE simd_pack(const __m128d& v_) : v(v_) { }
+
+		LMAT_ENSURE_INLINE simd_pack(const std::complex<double>& ev)
+		{
+			set(ev);
+		}
+
+		LMAT_ENSURE_INLINE explicit simd_pack(const std::complex<double> *p)
+		{
+			load_u(p);
+		}
+
+	    LMAT_ENSURE_INLINE
+	    static simd_pack zeros()
+	    {
+	    	return _mm_setzero_pd();
+	    }
+
+	    LMAT_ENSURE_INLINE
+	    static simd_pack ones()
+	    {
+	    	return _mm_setr_pd(1.0, 0.0);
+	    }
+
+	    // converter
+
+	    LMAT_ENSURE_INLINE
+	    operator __m128d() const
+	    {
+	    	return v;
+	    }
+
+		// set
+
+		LMAT_ENSURE_INLINE void reset()
+		{
+			v = _mm_setzero_pd();
+		}
+
+		LMAT_ENSURE_INLINE void set(const std::complex<double>& ev)
+		{
+			v = _mm_setr_pd(ev.real(), ev.imag());
+		}
+
+		// load
+
+		LMAT_ENSURE_INLINE void load_u(const std::complex<double> *p)
+		{
+			v = _mm_loadu_pd(reinterpret_cast<const double*>(p));
+		}
+
+		LMAT_ENSURE_INLINE void load_a(const std::complex<double> *p)
+		{
+			v = _mm_load_pd(reinterpret_cast<const double*>(p));
+		}
+
+	    LMAT_ENSURE_INLINE void load_strided(const std::complex<double> *p, index_t)
+	    {
+	    	load_u(p);
+	    }
+
+	    // store
+
+	    LMAT_ENSURE_INLINE void store_u(std::complex<double> *p) const
+	    {
+	    	_mm_storeu_pd(reinterpret_cast<double*>(p), v);
+	    }
+
+	    LMAT_ENSURE_INLINE void store_a(std::complex<double> *p) const
+	    {
+	    	_mm_store_pd(reinterpret_cast<double*>(p), v);
+	    }
+
+	    LMAT_ENSURE_INLINE void store_s(std::complex<double> *p) const  // non-temporal, p must be aligned
+	    {
+	    	_mm_stream_pd(reinterpret_cast<double*>(p), v);
+	    }
+
+	    // extract
+
+	    LMAT_ENSURE_INLINE std::complex<double> to_scalar() const
+	    {
+	    	return std::complex<double>(e[0], e[1]);
+	    }
+
+	    LMAT_ENSURE_INLINE std::complex<double> operator[] (unsigned int ) const
+	    {
+	    	return std::complex<double>(e[0], e[1]);
+	    }
+
+	}; // SSE c64 pack
+
+
+	/********************************************
+	 *
+	 *  Internal helpers
+	 *
+	 ********************************************/
+
+	namespace internal
+	{
+		// sign bits on imaginary parts
+
+		LMAT_ENSURE_INLINE
+		inline __m128 sse_imag_signmask_ps()
+		{
+			return _mm_castsi128_ps(_mm_setr_epi32(0, (int)0x80000000, 0, (int)0x80000000));
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m128d sse_imag_signmask_pd()
+		{
+			return _mm_castsi128_pd(_mm_setr_epi32(0, 0, 0, (int)0x80000000));
+		}
+
+		// (re, im) -> (re, re) and (im, im)
+
+		LMAT_ENSURE_INLINE
+		inline __m128 sse_dup_real_ps(__m128 a)
+		{
+#ifdef LMAT_HAS_SSE3
+			return _mm_moveldup_ps(a);
+#else
+			return _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 0, 0));
+#endif
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m128 sse_dup_imag_ps(__m128 a)
+		{
+#ifdef LMAT_HAS_SSE3
+			return _mm_movehdup_ps(a);
+#else
+			return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 1, 1));
+#endif
+		}
+
+		// x - y on real parts, x + y on imaginary parts
+
+		LMAT_ENSURE_INLINE
+		inline __m128 sse_addsub_ps(__m128 x, __m128 y)
+		{
+#ifdef LMAT_HAS_SSE3
+			return _mm_addsub_ps(x, y);
+#else
+			return _mm_add_ps(x, _mm_xor_ps(y, _mm_castsi128_ps(_mm_setr_epi32((int)0x80000000, 0, (int)0x80000000, 0))));
+#endif
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m128d sse_addsub_pd(__m128d x, __m128d y)
+		{
+#ifdef LMAT_HAS_SSE3
+			return _mm_addsub_pd(x, y);
+#else
+			return _mm_add_pd(x, _mm_xor_pd(y, _mm_castsi128_pd(_mm_setr_epi32(0, (int)0x80000000, 0, 0))));
+#endif
+		}
+
+		// (ar * br - ai * bi, ai * br + ar * bi)
+
+		LMAT_ENSURE_INLINE
+		inline __m128 sse_cmul_ps(__m128 a, __m128 b)
+		{
+			__m128 t = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), sse_dup_imag_ps(b));
+#ifdef LMAT_HAS_FMA
+			return _mm_fmaddsub_ps(a, sse_dup_real_ps(b), t);
+#else
+			return sse_addsub_ps(_mm_mul_ps(a, sse_dup_real_ps(b)), t);
+#endif
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m128d sse_cmul_pd(__m128d a, __m128d b)
+		{
+			__m128d t = _mm_mul_pd(_mm_shuffle_pd(a, a, 1), _mm_unpackhi_pd(b, b));
+#ifdef LMAT_HAS_FMA
+			return _mm_fmaddsub_pd(a, _mm_unpacklo_pd(b, b), t);
+#else
+			return sse_addsub_pd(_mm_mul_pd(a, _mm_unpacklo_pd(b, b)), t);
+#endif
+		}
+
+		// a * conj(b') / (m |b'|^2), with m = max(|br|, |bi|) and b' = b / m
+
+		LMAT_ENSURE_INLINE
+		inline __m128 sse_cdiv_ps(__m128 a, __m128 b)
+		{
+			__m128 m = _mm_andnot_ps(_mm_castsi128_ps(sse_signmask_ps()), b);
+			m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+			b = _mm_div_ps(b, m);
+			__m128 n = _mm_mul_ps(b, b);
+			n = _mm_add_ps(n, _mm_shuffle_ps(n, n, _MM_SHUFFLE(2, 3, 0, 1)));
+			__m128 p = sse_cmul_ps(a, _mm_xor_ps(b, sse_imag_signmask_ps()));
+			return _mm_div_ps(p, _mm_mul_ps(n, m));
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m128d sse_cdiv_pd(__m128d a, __m128d b)
+		{
+			__m128d m = _mm_andnot_pd(_mm_castsi128_pd(sse_signmask_pd()), b);
+			m = _mm_max_pd(m, _mm_shuffle_pd(m, m, 1));
+			b = _mm_div_pd(b, m);
+			__m128d n = _mm_mul_pd(b, b);
+			n = _mm_add_pd(n, _mm_shuffle_pd(n, n, 1));
+			__m128d p = sse_cmul_pd(a, _mm_xor_pd(b, sse_imag_signmask_pd()));
+			return _mm_div_pd(p, _mm_mul_pd(n, m));
+		}
+
+		// |re + i im|, scaled by the larger part; m = 0 and re = im = inf
+		// give 0/0 and inf/inf in the ratio, for which the result is |re| + |im|
+
+		template<typename T>
+		LMAT_ENSURE_INLINE
+		inline simd_pack<T, sse_t> scaled_hypot(const simd_pack<T, sse_t>& re, const simd_pack<T, sse_t>& im)
+		{
+			simd_pack<T, sse_t> x = math::abs(re);
+			simd_pack<T, sse_t> y = math::abs(im);
+			simd_pack<T, sse_t> m = (math::max)(x, y);
+			simd_pack<T, sse_t> q = (math::min)(x, y) / m;
+			simd_pack<T, sse_t> h = m * math::sqrt(math::fma(q, q, simd_pack<T, sse_t>(T(1))));
+			return math::cond(q == q, h, x + y);
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  Arithmetic operators
+	 *
+	 ********************************************/
+
+	LMAT_ENSURE_INLINE
+	inline sse_c32pk operator + (const sse_c32pk& a, const sse_c32pk& b)
+	{
+		return _mm_add_ps(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c64pk operator + (const sse_c64pk& a, const sse_c64pk& b)
+	{
+		return _mm_add_pd(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c32pk operator - (const sse_c32pk& a, const sse_c32pk& b)
+	{
+		return _mm_sub_ps(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c64pk operator - (const sse_c64pk& a, const sse_c64pk& b)
+	{
+		return _mm_sub_pd(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c32pk operator * (const sse_c32pk& a, const sse_c32pk& b)
+	{
+		return internal::sse_cmul_ps(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c64pk operator * (const sse_c64pk& a, const sse_c64pk& b)
+	{
+		return internal::sse_cmul_pd(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c32pk operator / (const sse_c32pk& a, const sse_c32pk& b)
+	{
+		return internal::sse_cdiv_ps(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c64pk operator / (const sse_c64pk& a, const sse_c64pk& b)
+	{
+		return internal::sse_cdiv_pd(a, b);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c32pk operator - (const sse_c32pk& a)
+	{
+		return _mm_xor_ps(_mm_castsi128_ps(internal::sse_signmask_ps()), a);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c64pk operator - (const sse_c64pk& a)
+	{
+		return _mm_xor_pd(_mm_castsi128_pd(internal::sse_signmask_pd()), a);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c32pk& operator += (sse_c32pk& a, const sse_c32pk& b)
+	{
+		a = _mm_add_ps(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c64pk& operator += (sse_c64pk& a, const sse_c64pk& b)
+	{
+		a = _mm_add_pd(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c32pk& operator -= (sse_c32pk& a, const sse_c32pk& b)
+	{
+		a = _mm_sub_ps(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c64pk& operator -= (sse_c64pk& a, const sse_c64pk& b)
+	{
+		a = _mm_sub_pd(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c32pk& operator *= (sse_c32pk& a, const sse_c32pk& b)
+	{
+		a = internal::sse_cmul_ps(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c64pk& operator *= (sse_c64pk& a, const sse_c64pk& b)
+	{
+		a = internal::sse_cmul_pd(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c32pk& operator /= (sse_c32pk& a, const sse_c32pk& b)
+	{
+		a = internal::sse_cdiv_ps(a, b);
+		return a;
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_c64pk& operator /= (sse_c64pk& a, const sse_c64pk& b)
+	{
+		a = internal::sse_cdiv_pd(a, b);
+		return a;
+	}
+
+
+	/********************************************
+	 *
+	 *  Reduction
+	 *
+	 ********************************************/
+
+	LMAT_ENSURE_INLINE
+	inline std::complex<float> sum(const sse_c32pk& a)
+	{
+		return sse_c32pk(_mm_add_ps(a, _mm_movehl_ps(a, a))).to_scalar();
+	}
+
+	LMAT_ENSURE_INLINE
+	inline std::complex<double> sum(const sse_c64pk& a)
+	{
+		return a.to_scalar();
+	}
+
+
+	/********************************************
+	 *
+	 *  Parts of complex packs
+	 *
+	 *  each takes the packs of 2 * width
+	 *  consecutive complex numbers
+	 *
+	 ********************************************/
+
+	LMAT_ENSURE_INLINE
+	inline sse_f32pk real(const sse_c32pk& a0, const sse_c32pk& a1)
+	{
+		return _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0));
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_f64pk real(const sse_c64pk& a0, const sse_c64pk& a1)
+	{
+		return _mm_unpacklo_pd(a0, a1);
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_f32pk imag(const sse_c32pk& a0, const sse_c32pk& a1)
+	{
+		return _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1));
+	}
+
+	LMAT_ENSURE_INLINE
+	inline sse_f64pk imag(const sse_c64pk& a0, const sse_c64pk& a1)
+	{
+		return _mm_unpackhi_pd(a0, a1);
+	}
+
+	template<typename T>
+	LMAT_ENSURE_INLINE
+	inline simd_pack<T, sse_t> norm(const simd_pack<std::complex<T>, sse_t>& a0, const simd_pack<std::complex<T>, sse_t>& a1)
+	{
+		simd_pack<T, sse_t> re = real(a0, a1);
+		simd_pack<T, sse_t> im = imag(a0, a1);
+		return math::fma(re, re, im * im);
+	}
+
+	template<typename T>
+	LMAT_ENSURE_INLINE
+	inline simd_pack<T, sse_t> abs(const simd_pack<std::complex<T>, sse_t>& a0, const simd_pack<std::complex<T>, sse_t>& a1)
+	{
+		return internal::scaled_hypot(real(a0, a1), imag(a0, a1));
+	}
+
+
+	namespace math
+	{
+		LMAT_ENSURE_INLINE
+		inline sse_c32pk conj(const sse_c32pk& a)
+		{
+			return _mm_xor_ps(a, lmat::internal::sse_imag_signmask_ps());
+		}
+
+		LMAT_ENSURE_INLINE
+		inline sse_c64pk conj(const sse_c64pk& a)
+		{
+			return _mm_xor_pd(a, lmat::internal::sse_imag_signmask_pd());
+		}
+
+		// x * y + z
+
+		LMAT_ENSURE_INLINE
+		inline sse_c32pk fma(const sse_c32pk& x, const sse_c32pk& y, const sse_c32pk& z)
+		{
+			return _mm_add_ps(lmat::internal::sse_cmul_ps(x, y), z);
+		}
+
+		LMAT_ENSURE_INLINE
+		inline sse_c64pk fma(const sse_c64pk& x, const sse_c64pk& y, const sse_c64pk& z)
+		{
+			return _mm_add_pd(lmat::internal::sse_cmul_pd(x, y), z);
+		}
+	}
+
+}
+
+#endif /* SSE_CPACKS_H_ */
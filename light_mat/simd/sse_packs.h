@@ -158,6 +158,18 @@ namespace lmat {
 	    	v = internal::sse_loadpart_f32(n, p);
 	    }
 
+	    // gathers p[0], p[step], p[2 * step], p[3 * step]
+
+	    LMAT_ENSURE_INLINE void load_strided(float const * p, index_t step)
+	    {
+	    	if (step == 2)
+	    		v = internal::sse_load_step2_f32(p);
+	    	else if (step == 3)
+	    		v = internal::sse_load_step3_f32(p);
+	    	else
+	    		v = _mm_setr_ps(p[0], p[step], p[2 * step], p[3 * step]);
+	    }
+
 
 	    // store
 
@@ -171,6 +183,11 @@ namespace lmat {
 	    	_mm_store_ps(p, v);
 	    }
 
+	    LMAT_ENSURE_INLINE void store_s(float *p) const  // non-temporal, p must be aligned
+	    {
+	    	_mm_stream_ps(p, v);
+	    }
+
 	    template<unsigned int N>
 	    LMAT_ENSURE_INLINE void store_part(siz_<N> n, float *p) const
 	    {
@@ -325,6 +342,13 @@ namespace lmat {
 	    	v = internal::sse_loadpart_f64(n, p);
 	    }
 
+	    // gathers p[0], p[step]
+
+	    LMAT_ENSURE_INLINE void load_strided(double const * p, index_t step)
+	    {
+	    	v = _mm_setr_pd(p[0], p[step]);
+	    }
+
 	    // store
 
 	    LMAT_ENSURE_INLINE void store_u(double *p) const
@@ -337,6 +361,11 @@ namespace lmat {
 	    	_mm_store_pd(p, v);
 	    }
 
+	    LMAT_ENSURE_INLINE void store_s(double *p) const  // non-temporal, p must be aligned
+	    {
+	    	_mm_stream_pd(p, v);
+	    }
+
 	    template<unsigned int N>
 	    LMAT_ENSURE_INLINE void store_part(siz_<N> n, double *p) const
 	    {
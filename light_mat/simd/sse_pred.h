@@ -140,7 +140,7 @@ namespace lmat
 	inline sse_f64bpk operator ~ (const sse_f64bpk& a)
 	{
 		return _mm_castsi128_pd(
-				_mm_cmpeq_epi64(_mm_castpd_si128(a), _mm_setzero_si128()));
+				internal::sse_cmpeq_epi64(_mm_castpd_si128(a), _mm_setzero_si128()));
 	}
 
 	LMAT_ENSURE_INLINE
@@ -178,7 +178,7 @@ namespace lmat
 	inline sse_f64bpk operator == (const sse_f64bpk& a, const sse_f64bpk& b)
 	{
 		return _mm_castsi128_pd(
-				_mm_cmpeq_epi64(_mm_castpd_si128(a), _mm_castpd_si128(b)));
+				internal::sse_cmpeq_epi64(_mm_castpd_si128(a), _mm_castpd_si128(b)));
 	}
 
 	LMAT_ENSURE_INLINE
@@ -73,6 +73,66 @@ namespace lmat {
 	}
 
 
+	// inclusive prefix scans (lane i <- a[0] op ... op a[i])
+
+	namespace internal
+	{
+		// shift the lanes up by k, filling the first k with id
+
+		LMAT_ENSURE_INLINE
+		inline __m128 sse_shift1_f32(__m128 x, __m128 id)
+		{
+			return _mm_move_ss(_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)), id);
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m128 sse_shift2_f32(__m128 x, __m128 id)
+		{
+			return _mm_movelh_ps(id, x);
+		}
+
+		LMAT_ENSURE_INLINE
+		inline __m128d sse_shift1_f64(__m128d x, __m128d id)
+		{
+			return _mm_unpacklo_pd(id, x);
+		}
+
+		// max & min that propagate NaN from either operand
+		// (maxps/minps return the second operand if either is NaN)
+
+#define LMAT_DEFINE_SSE_NAN_PROP_OP( Name, Op, PS, PD ) \
+		LMAT_ENSURE_INLINE \
+		inline __m128 Name##_f32(__m128 x, __m128 y) { \
+			__m128 u = _mm_cmpunord_ps(x, x); \
+			return _mm_or_ps(_mm_and_ps(u, x), _mm_andnot_ps(u, Op##PS(x, y))); } \
+		LMAT_ENSURE_INLINE \
+		inline __m128d Name##_f64(__m128d x, __m128d y) { \
+			__m128d u = _mm_cmpunord_pd(x, x); \
+			return _mm_or_pd(_mm_and_pd(u, x), _mm_andnot_pd(u, Op##PD(x, y))); }
+
+		LMAT_DEFINE_SSE_NAN_PROP_OP( sse_nmax, _mm_max, _ps, _pd )
+		LMAT_DEFINE_SSE_NAN_PROP_OP( sse_nmin, _mm_min, _ps, _pd )
+	}
+
+#define LMAT_DEFINE_SSE_PREFIX_SCAN( Name, OpPS, OpPD, IdF32, IdF64 ) \
+	LMAT_ENSURE_INLINE \
+	inline sse_f32pk Name(const sse_f32pk& a) { \
+		const __m128 id = IdF32; \
+		__m128 x = a; \
+		x = OpPS(x, internal::sse_shift1_f32(x, id)); \
+		return OpPS(x, internal::sse_shift2_f32(x, id)); } \
+	LMAT_ENSURE_INLINE \
+	inline sse_f64pk Name(const sse_f64pk& a) { \
+		const __m128d id = IdF64; \
+		__m128d x = a; \
+		return OpPD(x, internal::sse_shift1_f64(x, id)); }
+
+	LMAT_DEFINE_SSE_PREFIX_SCAN( prefix_sum,  _mm_add_ps, _mm_add_pd, _mm_setzero_ps(), _mm_setzero_pd() )
+	LMAT_DEFINE_SSE_PREFIX_SCAN( prefix_prod, _mm_mul_ps, _mm_mul_pd, _mm_set1_ps(1.0f), _mm_set1_pd(1.0) )
+	LMAT_DEFINE_SSE_PREFIX_SCAN( prefix_max,  internal::sse_nmax_f32, internal::sse_nmax_f64, sse_f32pk::neg_inf(), sse_f64pk::neg_inf() )
+	LMAT_DEFINE_SSE_PREFIX_SCAN( prefix_min,  internal::sse_nmin_f32, internal::sse_nmin_f64, sse_f32pk::inf(), sse_f64pk::inf() )
+
+
 	// all & any
 
 	LMAT_ENSURE_INLINE
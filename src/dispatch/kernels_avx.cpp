@@ -0,0 +1,14 @@
+/**
+ * @file kernels_avx.cpp
+ *
+ * The avx variant of the dispatched kernels
+ *
+ * Compile with DISPATCH_AVX_FLAG (e.g. -mavx -mno-avx2 -mno-fma)
+ *
+ * @author Dahua Lin
+ */
+
+#define LMAT_DISPATCH_VARIANT avx
+
+#include <light_mat/dispatch/dispatch_variant.h>
+
@@ -0,0 +1,14 @@
+/**
+ * @file kernels_avx2.cpp
+ *
+ * The avx2 variant of the dispatched kernels
+ *
+ * Compile with DISPATCH_AVX2_FLAG (e.g. -mavx2 -mfma)
+ *
+ * @author Dahua Lin
+ */
+
+#define LMAT_DISPATCH_VARIANT avx2
+
+#include <light_mat/dispatch/dispatch_variant.h>
+
@@ -0,0 +1,14 @@
+/**
+ * @file kernels_sse2.cpp
+ *
+ * The sse2 variant of the dispatched kernels
+ *
+ * Compile with DISPATCH_SSE2_FLAG (e.g. -msse2 -mno-sse3)
+ *
+ * @author Dahua Lin
+ */
+
+#define LMAT_DISPATCH_VARIANT sse2
+
+#include <light_mat/dispatch/dispatch_variant.h>
+
@@ -0,0 +1,319 @@
+/**
+ * @file test_deferred.cpp
+ *
+ * @brief Unit testing of thread pools and deferred contexts
+ *
+ * @author Dahua Lin
+ */
+
+#include "../test_base.h"
+
+#include <light_mat/async/deferred_context.h>
+#include <light_mat/matexpr/mat_arith.h>
+#include <stdexcept>
+
+using namespace lmat;
+using namespace lmat::test;
+
+const index_t M = 37;
+const index_t N = 53;
+const int NRepeats = 20;
+
+template<class Allocator>
+void fill_seq(dense_matrix<double, 0, 0, Allocator>& a, double base)
+{
+	for (index_t i = 0; i < a.nelems(); ++i) a[i] = base + double(i % 17);
+}
+
+
+// a functor of four arguments
+
+namespace lmat
+{
+	namespace ftags
+	{
+		struct madd4_ { };
+	}
+
+	LMAT_DEF_REAL_MATH_FUN( ftags::madd4_, 4, madd4_fun, x1 * x2 + x3 * x4 )
+	LMAT_DEF_SIMD_SUPPORT( madd4_fun )
+}
+
+
+SIMPLE_CASE( pool_post )
+{
+	std::atomic<int> cnt(0);
+
+	{
+		thread_pool pool(4);
+		ASSERT_EQ( pool.nthreads(), 4 );
+		ASSERT_FALSE( pool.in_worker() );
+
+		for (int i = 0; i < 1000; ++i)
+			pool.post([&cnt]() { ++cnt; });
+	}
+
+	ASSERT_EQ( cnt.load(), 1000 );
+}
+
+SIMPLE_CASE( pool_nested )
+{
+	// tasks posted from workers go to their own queues, and are stolen by others
+
+	std::atomic<int> cnt(0);
+	std::atomic<int> nin(0);
+
+	{
+		thread_pool pool(4);
+
+		for (int i = 0; i < 8; ++i)
+		{
+			pool.post([&pool, &cnt, &nin]()
+			{
+				if (pool.in_worker()) ++nin;
+				for (int j = 0; j < 100; ++j)
+					pool.post([&cnt]() { ++cnt; });
+			});
+		}
+	}
+
+	ASSERT_EQ( nin.load(), 8 );
+	ASSERT_EQ( cnt.load(), 800 );
+}
+
+SIMPLE_CASE( deferred_independent )
+{
+	thread_pool pool(4);
+
+	dense_matrix<double> a(M, N), b(M, N);
+	fill_seq(a, 1.0);
+	fill_seq(b, 2.0);
+
+	dense_matrix<double> c(M, N), d(M, N), e(M, N);
+
+	deferred_context ctx(pool);
+	std::future<void> fc = ctx.assign(c, a + b);
+	std::future<void> fd = ctx.assign(d, a * b);
+	ctx.assign(e, (a - b) * 2.0 + 1.0);    // temporaries of the statement are captured
+	ctx.sync();
+
+	ASSERT_EQ( ctx.num_pending(), 0 );
+	fc.get();
+	fd.get();
+
+	for (index_t i = 0; i < M * N; ++i)
+	{
+		ASSERT_EQ( c[i], a[i] + b[i] );
+		ASSERT_EQ( d[i], a[i] * b[i] );
+		ASSERT_EQ( e[i], (a[i] - b[i]) * 2.0 + 1.0 );
+	}
+}
+
+SIMPLE_CASE( deferred_chain )
+{
+	thread_pool pool(4);
+
+	dense_matrix<double> a(M, N), b(M, N);
+	fill_seq(a, 1.0);
+	fill_seq(b, 2.0);
+
+	for (int r = 0; r < NRepeats; ++r)
+	{
+		dense_matrix<double> t(M, N), u(M, N), w(M, N), x(M, N);
+		dense_matrix<double> a2(a);
+
+		deferred_context ctx(pool);
+
+		ctx.assign(t, a2 + b);          // t <- a2
+		ctx.assign(u, t * t);           // RAW on t
+		ctx.assign(x, a2 - b);          // independent of t and u
+		ctx.assign(a2, b * 3.0);        // WAR on a2: waits for t and x
+		ctx.assign(w, u + a2);          // RAW on u and the new a2
+		ctx.assign(t, w - 1.0);         // WAW on t
+		ctx.sync();
+
+		for (index_t i = 0; i < M * N; ++i)
+		{
+			double t0 = a[i] + b[i];
+			double u0 = t0 * t0;
+			double w0 = u0 + b[i] * 3.0;
+
+			ASSERT_EQ( u[i], u0 );
+			ASSERT_EQ( x[i], a[i] - b[i] );
+			ASSERT_EQ( a2[i], b[i] * 3.0 );
+			ASSERT_EQ( w[i], w0 );
+			ASSERT_EQ( t[i], w0 - 1.0 );
+		}
+	}
+}
+
+SIMPLE_CASE( deferred_views )
+{
+	thread_pool pool(4);
+
+	dense_matrix<double> a(M, N), c(M, N, zero());
+	fill_seq(a, 1.0);
+
+	deferred_context ctx(pool);
+
+	// columns of c do not overlap, and are assigned concurrently
+
+	for (index_t j = 0; j < N; ++j)
+	{
+		auto cj = c.column(j);
+		ctx.assign(cj, a.column(j) * double(j));
+	}
+
+	// a row view spans over all columns, so it waits for them
+
+	auto c0 = c.row(0);
+	ctx.assign(c0, c.row(1) + 1.0);
+	ctx.sync();
+
+	for (index_t j = 0; j < N; ++j)
+	{
+		ASSERT_EQ( c(0, j), a(1, j) * double(j) + 1.0 );
+		for (index_t i = 1; i < M; ++i)
+			ASSERT_EQ( c(i, j), a(i, j) * double(j) );
+	}
+}
+
+SIMPLE_CASE( deferred_allocators )
+{
+	// dense matrices with other allocators are referred to, as
+	// destinations and as sources, like those with the default one
+
+	typedef dense_matrix<double, 0, 0, numa_allocator<double> > nmat_t;
+	typedef dense_matrix<double, 0, 0, hugepage_allocator<double> > hmat_t;
+
+	thread_pool pool(4);
+
+	nmat_t a(M, N);
+	dense_matrix<double> b(M, N), x(M, N);
+	fill_seq(a, 1.0);
+	fill_seq(b, 2.0);
+
+	nmat_t c(M, N, zero());
+	hmat_t h(M, N, zero());
+
+	deferred_context ctx(pool);
+
+	ctx.assign(c, a + b);
+	ctx.assign(h, c * 2.0);         // RAW on c
+	ctx.assign(a, b - 1.0);         // WAR on a: waits for c
+	ctx.assign(x, h + a);           // RAW on h and the new a
+	ctx.sync();
+
+	for (index_t i = 0; i < M * N; ++i)
+	{
+		double c0 = (1.0 + double(i % 17)) + b[i];
+
+		ASSERT_EQ( c[i], c0 );
+		ASSERT_EQ( h[i], c0 * 2.0 );
+		ASSERT_EQ( a[i], b[i] - 1.0 );
+		ASSERT_EQ( x[i], c0 * 2.0 + b[i] - 1.0 );
+	}
+}
+
+SIMPLE_CASE( deferred_nary )
+{
+	thread_pool pool(4);
+
+	dense_matrix<double> a(M, N), b(M, N), c(M, N), d(M, N);
+	fill_seq(a, 1.0);
+	fill_seq(b, 2.0);
+
+	deferred_context ctx(pool);
+
+	// maps of four arguments, with a scalar and a sub-expression among them
+
+	ctx.assign(c, make_map_expr(ftags::madd4_(), a, b, a + b, 2.0));
+	ctx.assign(d, make_map_expr(ftags::madd4_(), c, 0.5, a, b) - 1.0);
+	ctx.sync();
+
+	for (index_t i = 0; i < M * N; ++i)
+	{
+		double c0 = a[i] * b[i] + (a[i] + b[i]) * 2.0;
+		ASSERT_EQ( c[i], c0 );
+		ASSERT_EQ( d[i], c0 * 0.5 + a[i] * b[i] - 1.0 );
+	}
+}
+
+SIMPLE_CASE( deferred_submit )
+{
+	thread_pool pool(4);
+
+	dense_matrix<double> a(M, N), b(M, N), c(M, N);
+	fill_seq(a, 1.0);
+	fill_seq(b, 2.0);
+
+	for (int r = 0; r < NRepeats; ++r)
+	{
+		deferred_context ctx(pool);
+
+		ctx.submit([&]() { fill_seq(a, double(r)); }, writes(a));
+		std::future<double> s = ctx.submit([&]()
+		{
+			double v = 0;
+			for (index_t i = 0; i < a.nelems(); ++i) v += a[i];
+			return v;
+		}, reads(a));
+
+		ctx.assign(c, a + b);
+		std::future<int> z = ctx.submit([]() { return 42; });
+
+		double s0 = 0;
+		for (index_t i = 0; i < M * N; ++i) s0 += double(r) + double(i % 17);
+
+		ASSERT_EQ( s.get(), s0 );
+		ASSERT_EQ( z.get(), 42 );
+
+		ctx.sync();
+		for (index_t i = 0; i < M * N; ++i) ASSERT_EQ( c[i], a[i] + b[i] );
+	}
+}
+
+SIMPLE_CASE( deferred_errors )
+{
+	thread_pool pool(2);
+	deferred_context ctx(pool);
+
+	dense_matrix<double> a(M, N), c(M, N);
+	fill_seq(a, 1.0);
+
+	std::future<void> f = ctx.submit([]() { throw std::runtime_error("failed"); }, writes(a));
+	std::future<void> g = ctx.assign(c, a + 1.0);   // still runs after the failed task
+	ctx.sync();
+
+	bool thrown = false;
+	try { f.get(); }
+	catch (std::runtime_error& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	g.get();
+	ASSERT_EQ( c[0], a[0] + 1.0 );
+
+	dense_matrix<double> d(M + 1, N);
+	thrown = false;
+	try { ctx.assign(d, a + 1.0); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+}
+
+
+AUTO_TPACK( thread_pool )
+{
+	ADD_SIMPLE_CASE( pool_post )
+	ADD_SIMPLE_CASE( pool_nested )
+}
+
+AUTO_TPACK( deferred_context )
+{
+	ADD_SIMPLE_CASE( deferred_independent )
+	ADD_SIMPLE_CASE( deferred_chain )
+	ADD_SIMPLE_CASE( deferred_views )
+	ADD_SIMPLE_CASE( deferred_allocators )
+	ADD_SIMPLE_CASE( deferred_nary )
+	ADD_SIMPLE_CASE( deferred_submit )
+	ADD_SIMPLE_CASE( deferred_errors )
+}
@@ -0,0 +1,105 @@
+/**
+ * @file test_hugepage.cpp
+ *
+ * Unit testing of huge-page allocation
+ *
+ * @author Dahua Lin
+ */
+
+#include "../test_base.h"
+
+#include <light_mat/common/block.h>
+
+using namespace lmat;
+using namespace lmat::test;
+
+// explicit instantiation
+
+template class lmat::dblock<double, hugepage_allocator<double> >;
+template class lmat::dblock<double, hugepage_allocator<double, hugepage_tlb> >;
+
+const size_t HP = internal::hugepage_size;
+
+
+SIMPLE_CASE( hugepage_round )
+{
+	ASSERT_EQ( internal::hugepage_round(0), HP );
+	ASSERT_EQ( internal::hugepage_round(1), HP );
+	ASSERT_EQ( internal::hugepage_round(HP), HP );
+	ASSERT_EQ( internal::hugepage_round(HP + 1), 2 * HP );
+	ASSERT_EQ( internal::hugepage_round(5 * HP - 8), 5 * HP );
+}
+
+template<hugepage_mode Mode>
+void verify_hugepage_block(index_t n)
+{
+	dblock<double, hugepage_allocator<double, Mode> > a(n);
+	ASSERT_EQ( (size_t)a.ptr_data() % HP, 0 );
+
+	for (index_t i = 0; i < n; ++i) a[i] = double(i + 1);
+
+	// whether huge pages are given depends on the system,
+	// but what is reported never exceeds the mapping
+
+	size_t hb = hugepage_bytes(a.ptr_data());
+	ASSERT_EQ( hb % HP, 0 );
+	ASSERT_EQ( on_hugepages(a.ptr_data()), hb > 0 );
+
+	dblock<double, hugepage_allocator<double, Mode> > b(a);
+	ASSERT_EQ( (size_t)b.ptr_data() % HP, 0 );
+	for (index_t i = 0; i < n; ++i) ASSERT_EQ( b[i], double(i + 1) );
+
+	b.resize(n / 2 + 1);
+	ASSERT_EQ( (size_t)b.ptr_data() % HP, 0 );
+}
+
+SIMPLE_CASE( hugepage_advise_block )
+{
+	verify_hugepage_block<hugepage_advise>(10);
+	verify_hugepage_block<hugepage_advise>(3 * (index_t)(HP / sizeof(double)) + 5);
+}
+
+SIMPLE_CASE( hugepage_tlb_block )
+{
+	// falls back to transparent huge pages without a reserved pool
+
+	verify_hugepage_block<hugepage_tlb>(10);
+	verify_hugepage_block<hugepage_tlb>(3 * (index_t)(HP / sizeof(double)) + 5);
+}
+
+SIMPLE_CASE( hugepage_threshold )
+{
+	// (turned on for this test, see CMakeLists.txt)
+
+	const size_t t = (size_t)(LMAT_HUGEPAGE_THRESHOLD);
+	ASSERT_TRUE( t > 0 );
+
+	ASSERT_FALSE( internal::use_hugepages(t - 1) );
+	ASSERT_TRUE( internal::use_hugepages(t) );
+
+	// large blocks of the default allocator are huge-page aligned
+
+	const index_t n = (index_t)(t / sizeof(double)) + 3;
+	dblock<double> a(n, zero());
+	ASSERT_EQ( (size_t)a.ptr_data() % HP, 0 );
+	ASSERT_EQ( a[n - 1], 0.0 );
+
+	dblock<double> b(16, zero());
+	ASSERT_EQ( b[15], 0.0 );
+}
+
+SIMPLE_CASE( hugepage_bytes_small )
+{
+	double x = 1.0;
+	ASSERT_EQ( hugepage_bytes(&x), 0 );
+}
+
+
+AUTO_TPACK( hugepage )
+{
+	ADD_SIMPLE_CASE( hugepage_round )
+	ADD_SIMPLE_CASE( hugepage_advise_block )
+	ADD_SIMPLE_CASE( hugepage_tlb_block )
+	ADD_SIMPLE_CASE( hugepage_threshold )
+	ADD_SIMPLE_CASE( hugepage_bytes_small )
+}
@@ -0,0 +1,301 @@
+/**
+ * @file test_dispatch.cpp
+ *
+ * @brief Unit testing of run-time dispatched kernels
+ *
+ * @author Dahua Lin
+ */
+
+#include "../test_base.h"
+
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/matrix/matrix_transpose.h>
+#include <light_mat/matexpr/mat_arith.h>
+#include <light_mat/mateval/mat_reduce.h>
+#include <light_mat/mateval/matrix_sort.h>
+#include <light_mat/random/philox.h>
+#include <light_mat/random/uniform_real_distr.h>
+#include <light_mat/random/rand_expr.h>
+#include <light_mat/dispatch/dispatch.h>
+
+#include <algorithm>
+
+using namespace lmat;
+using namespace lmat::test;
+
+
+const index_t vlen = 1003;  // not a multiple of any pack width
+
+
+SIMPLE_CASE( simd_level_select )
+{
+	ASSERT_EQ( parse_simd_level("sse2"), sse2_level );
+	ASSERT_EQ( parse_simd_level("avx"), avx_level );
+	ASSERT_EQ( parse_simd_level("avx2"), avx2_level );
+	ASSERT_EQ( parse_simd_level("avx512"), -1 );
+
+	ASSERT_EQ( select_simd_level(avx2_level, 0), avx2_level );
+	ASSERT_EQ( select_simd_level(avx2_level, "sse2"), sse2_level );
+	ASSERT_EQ( select_simd_level(avx2_level, "avx"), avx_level );
+	ASSERT_EQ( select_simd_level(avx_level, "avx2"), avx_level );  // cannot go up
+	ASSERT_EQ( select_simd_level(avx_level, "neon"), avx_level );
+
+	const int d = detect_simd_level();
+	ASSERT_TRUE( d == sse2_level || d == avx_level || d == avx2_level );
+	ASSERT_TRUE( runtime_simd_level() <= d );
+}
+
+SIMPLE_CASE( dispatch_variants )
+{
+	ASSERT_EQ( dispatch::sse2::variant_kernels().level, sse2_level );
+	ASSERT_EQ( dispatch::avx::variant_kernels().level, avx_level );
+	ASSERT_EQ( dispatch::avx2::variant_kernels().level, avx2_level );
+
+	ASSERT_EQ( &dispatch::select_kernels(sse2_level), &dispatch::sse2::variant_kernels() );
+	ASSERT_EQ( &dispatch::select_kernels(avx_level), &dispatch::avx::variant_kernels() );
+	ASSERT_EQ( &dispatch::select_kernels(avx2_level), &dispatch::avx2::variant_kernels() );
+
+	ASSERT_EQ( dispatch::kernels().level, runtime_simd_level() );
+}
+
+
+template<typename T>
+void verify_kernel_table(const dispatch::kernel_table<T>& kt)
+{
+	const index_t n = vlen;
+	const T tol = T(1.0e-4);
+
+	dense_col<T> a(n), b(n), r(n), r0(n);
+	for (index_t i = 0; i < n; ++i)
+	{
+		a[i] = T(i % 17) - T(3.5);
+		b[i] = T(i % 5) + T(1);
+	}
+
+	// ewise
+
+	kt.add(n, a.ptr_data(), b.ptr_data(), r.ptr_data());
+	for (index_t i = 0; i < n; ++i) r0[i] = a[i] + b[i];
+	ASSERT_VEC_EQ( n, r, r0 );
+
+	kt.sub(n, a.ptr_data(), b.ptr_data(), r.ptr_data());
+	for (index_t i = 0; i < n; ++i) r0[i] = a[i] - b[i];
+	ASSERT_VEC_EQ( n, r, r0 );
+
+	kt.mul(n, a.ptr_data(), b.ptr_data(), r.ptr_data());
+	for (index_t i = 0; i < n; ++i) r0[i] = a[i] * b[i];
+	ASSERT_VEC_EQ( n, r, r0 );
+
+	kt.div(n, a.ptr_data(), b.ptr_data(), r.ptr_data());
+	for (index_t i = 0; i < n; ++i) r0[i] = a[i] / b[i];
+	ASSERT_VEC_APPROX( n, r, r0, tol );
+
+	copy(b, r);
+	kt.axpy(n, T(2), a.ptr_data(), r.ptr_data());
+	for (index_t i = 0; i < n; ++i) r0[i] = b[i] + T(2) * a[i];
+	ASSERT_VEC_EQ( n, r, r0 );
+
+	// reduction
+
+	T s = 0, d = 0, mx = a[0], mn = a[0];
+	for (index_t i = 0; i < n; ++i)
+	{
+		s += a[i];
+		d += a[i] * b[i];
+		mx = std::max(mx, a[i]);
+		mn = std::min(mn, a[i]);
+	}
+
+	ASSERT_APPROX( kt.sum(n, a.ptr_data()), s, tol * n );
+	ASSERT_APPROX( kt.dot(n, a.ptr_data(), b.ptr_data()), d, tol * n );
+	ASSERT_EQ( kt.maximum(n, a.ptr_data()), mx );
+	ASSERT_EQ( kt.minimum(n, a.ptr_data()), mn );
+
+	// memory
+
+	kt.copy(n, a.ptr_data(), r.ptr_data());
+	ASSERT_VEC_EQ( n, r, a );
+
+	kt.fill(n, r.ptr_data(), T(2.5));
+	for (index_t i = 0; i < n; ++i) r0[i] = T(2.5);
+	ASSERT_VEC_EQ( n, r, r0 );
+
+	// sort (with ties, reversed, and constant inputs)
+
+	for (index_t i = 0; i < n; ++i) r[i] = T((i * 37) % 101) - T(50);
+	copy(r, r0);
+	kt.sort(n, r.ptr_data());
+	std::sort(r0.ptr_data(), r0.ptr_data() + n);
+	ASSERT_VEC_EQ( n, r, r0 );
+
+	for (index_t i = 0; i < n; ++i) r[i] = T(n - i);
+	kt.sort(n, r.ptr_data());
+	for (index_t i = 0; i < n; ++i) r0[i] = T(i + 1);
+	ASSERT_VEC_EQ( n, r, r0 );
+
+	kt.fill(n, r.ptr_data(), T(1));
+	kt.sort(n, r.ptr_data());
+	for (index_t i = 0; i < n; ++i) r0[i] = T(1);
+	ASSERT_VEC_EQ( n, r, r0 );
+
+	// transpose
+
+	const index_t m = 37;
+	const index_t k = 23;
+	dense_matrix<T> x(m, k), y(k, m);
+	for (index_t i = 0; i < m * k; ++i) x[i] = T(i + 1);
+
+	kt.transpose(m, k, x.ptr_data(), y.ptr_data());
+	for (index_t j = 0; j < k; ++j)
+		for (index_t i = 0; i < m; ++i) ASSERT_EQ( y(j, i), x(i, j) );
+
+	// random (must agree with the regular engine on the same stream;
+	// fixed-size matrices are never routed to the dispatched kernels)
+
+	const uint64_t seed = 2468;
+	const uint64_t sid = 3;
+	const uint64_t pos = 40;
+
+	kt.randu(n, r.ptr_data(), seed, sid, pos);
+
+	random::philox4x32_stream rs(seed, sid);
+	rs.seek(pos);
+	dense_matrix<T, vlen, 1> u0 = rand_mat(random::std_uniform_real_distr<T>(), rs, n, 1);
+	ASSERT_VEC_EQ( n, r, u0 );
+}
+
+#define DEF_DISPATCH_VARIANT_CASES( Variant ) \
+	SIMPLE_CASE( dispatch_##Variant##_f32 ) { \
+		if (dispatch::Variant::variant_kernels().level <= detect_simd_level()) \
+			verify_kernel_table(dispatch::Variant::variant_kernels().f32); } \
+	SIMPLE_CASE( dispatch_##Variant##_f64 ) { \
+		if (dispatch::Variant::variant_kernels().level <= detect_simd_level()) \
+			verify_kernel_table(dispatch::Variant::variant_kernels().f64); }
+
+DEF_DISPATCH_VARIANT_CASES( sse2 )
+DEF_DISPATCH_VARIANT_CASES( avx )
+DEF_DISPATCH_VARIANT_CASES( avx2 )
+
+
+SIMPLE_CASE( dispatch_entries )
+{
+	const index_t m = 13;
+	const index_t n = 7;
+
+	dense_matrix<double> a(m, n), b(m, n), r(m, n), r0(m, n);
+	for (index_t i = 0; i < m * n; ++i)
+	{
+		a[i] = double(i % 11) - 2.0;
+		b[i] = double(i % 3) + 0.5;
+	}
+
+	dispatch::add(a, b, r);
+	r0 = a + b;
+	ASSERT_MAT_EQ( m, n, r, r0 );
+
+	dispatch::axpy(3.0, a, r);
+	r0 += 3.0 * a;
+	ASSERT_MAT_EQ( m, n, r, r0 );
+
+	ASSERT_EQ( dispatch::sum(a), sum(a) );
+	ASSERT_EQ( dispatch::maximum(a), maximum(a) );
+	ASSERT_EQ( dispatch::minimum(a), minimum(a) );
+	ASSERT_APPROX( dispatch::dot(a, b), dot(a, b), 1.0e-12 );
+
+	r = a;
+	dispatch::sort(r);
+	r0 = a;
+	std::sort(r0.ptr_data(), r0.ptr_data() + m * n);
+	ASSERT_MAT_EQ( m, n, r, r0 );
+
+	dense_matrix<double> t(n, m);
+	dispatch::transpose(a, t);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < m; ++i) ASSERT_EQ( t(j, i), a(i, j) );
+
+	random::philox4x32_stream rs(97, 1), rs0(rs);
+	dispatch::randu(r, rs);
+	dense_matrix<double, m, n> u0 = rand_mat(random::std_uniform_real_distr<double>(), rs0, m, n);
+	ASSERT_MAT_EQ( m, n, r, u0 );
+	ASSERT_EQ( rs.position(), rs0.position() );
+
+	dense_col<float> e(0);
+	ASSERT_EQ( dispatch::sum(e), 0.0f );
+}
+
+
+// the regular engines route large contiguous operands (see dispatch_route.h)
+
+SIMPLE_CASE( dispatch_routes )
+{
+	const index_t m = 53;
+	const index_t n = 19;
+
+	dense_matrix<double> a(m, n), b(m, n), r(m, n);
+	dense_matrix<double, m, n> a0, b0, r0;
+	for (index_t i = 0; i < m * n; ++i)
+	{
+		a0[i] = a[i] = double((i * 7) % 23) - 5.0;
+		b0[i] = b[i] = double(i % 3) + 0.5;
+	}
+
+	r = a + b;
+	r0 = a0 + b0;
+	ASSERT_MAT_EQ( m, n, r, r0 );
+
+	r = a / b;
+	r0 = a0 / b0;
+	ASSERT_MAT_APPROX( m, n, r, r0, 1.0e-12 );
+
+	ASSERT_APPROX( sum(a), sum(a0), 1.0e-9 );
+	ASSERT_EQ( maximum(a), maximum(a0) );
+	ASSERT_EQ( minimum(a), minimum(a0) );
+	ASSERT_APPROX( dot(a, b), dot(a0, b0), 1.0e-9 );
+
+	copy(a, r);
+	ASSERT_MAT_EQ( m, n, r, a0 );
+
+	fill(r, 1.5);
+	fill(r0, 1.5);
+	ASSERT_MAT_EQ( m, n, r, r0 );
+
+	r = a;
+	r0 = a0;
+	sort(r);
+	sort(r0);
+	ASSERT_MAT_EQ( m, n, r, r0 );
+
+	dense_matrix<double> t(n, m);
+	dense_matrix<double, n, m> t0;
+	transpose(a, t);
+	transpose(a0, t0);
+	ASSERT_MAT_EQ( n, m, t, t0 );
+
+	// each column from its own window of the stream
+
+	random::philox4x32_stream rs(1357, 2);
+	random::philox4x32_stream rs0(rs);
+	r = rand_mat(random::std_uniform_real_distr<double>(), rs, m, n);
+	r0 = rand_mat(random::std_uniform_real_distr<double>(), rs0, m, n);
+	ASSERT_MAT_EQ( m, n, r, r0 );
+	ASSERT_EQ( rs.position(), rs0.position() );
+}
+
+
+AUTO_TPACK( dispatch_select )
+{
+	ADD_SIMPLE_CASE( simd_level_select )
+	ADD_SIMPLE_CASE( dispatch_variants )
+}
+
+AUTO_TPACK( dispatch_kernels )
+{
+	ADD_SIMPLE_CASE( dispatch_sse2_f32 )
+	ADD_SIMPLE_CASE( dispatch_sse2_f64 )
+	ADD_SIMPLE_CASE( dispatch_avx_f32 )
+	ADD_SIMPLE_CASE( dispatch_avx_f64 )
+	ADD_SIMPLE_CASE( dispatch_avx2_f32 )
+	ADD_SIMPLE_CASE( dispatch_avx2_f64 )
+	ADD_SIMPLE_CASE( dispatch_entries )
+	ADD_SIMPLE_CASE( dispatch_routes )
+}
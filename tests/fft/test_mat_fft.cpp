@@ -0,0 +1,291 @@
+/**
+ * @file test_mat_fft.cpp
+ *
+ * @brief Unit testing of column-wise FFT
+ *
+ * @author Dahua Lin
+ */
+
+#include "../test_base.h"
+#include <light_mat/fft/mat_fft.h>
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace lmat;
+using namespace lmat::test;
+
+// column counts covering whole pack groups and remaining columns
+const index_t DN = 11;
+
+// lengths: powers of two, mixed radix, other primes
+const index_t fft_lens[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 12, 14, 15, 16, 25, 30, 49, 60, 64, 77, 120, 128, 243, 256};
+const int n_fft_lens = sizeof(fft_lens) / sizeof(index_t);
+
+template<typename T> struct fft_tol;
+template<> struct fft_tol<float>  { static double get() { return 2.0e-6; } };
+template<> struct fft_tol<double> { static double get() { return 1.0e-14; } };
+
+template<typename T>
+inline T frand()
+{
+	return T(std::rand() % 2001 - 1000) / T(500);
+}
+
+template<typename T, class Mat>
+void fill_rand(IRegularMatrix<Mat, T>& a)
+{
+	for (index_t j = 0; j < a.ncolumns(); ++j)
+		for (index_t i = 0; i < a.nrows(); ++i) a(i, j) = frand<T>();
+}
+
+template<typename T, class Mat>
+void fill_rand(IRegularMatrix<Mat, std::complex<T> >& a)
+{
+	for (index_t j = 0; j < a.ncolumns(); ++j)
+		for (index_t i = 0; i < a.nrows(); ++i) a(i, j) = std::complex<T>(frand<T>(), frand<T>());
+}
+
+// direct DFT of a column, in double precision
+
+template<typename T, class Mat>
+dense_col<std::complex<double> > naive_dft(const IRegularMatrix<Mat, T>& a, index_t j, bool inv)
+{
+	const index_t n = a.nrows();
+	const double sgn = inv ? 1.0 : -1.0;
+	dense_col<std::complex<double> > r(n);
+
+	for (index_t k = 0; k < n; ++k)
+	{
+		std::complex<double> s(0);
+		for (index_t t = 0; t < n; ++t)
+		{
+			const double u = sgn * 2.0 * math::consts<double>::pi() * double((k * t) % n) / double(n);
+			s += std::complex<double>(a(t, j)) * std::complex<double>(std::cos(u), std::sin(u));
+		}
+		r[k] = inv ? s / double(n) : s;
+	}
+	return r;
+}
+
+// error relative to the magnitude of the transform
+
+template<typename T, class Mat>
+bool col_approx(const IRegularMatrix<Mat, std::complex<T> >& r, index_t j,
+		const dense_col<std::complex<double> >& ref, index_t len, double tol)
+{
+	double mag = 1.0;
+	for (index_t i = 0; i < len; ++i) mag = std::max(mag, std::abs(ref[i]));
+
+	const double t = tol * mag * (1.0 + std::log(double(r.nrows() + 1)));
+	for (index_t i = 0; i < len; ++i)
+	{
+		if (std::abs(std::complex<double>(r(i, j)) - ref[i]) > t) return false;
+	}
+	return true;
+}
+
+template<typename T, class A, class B>
+bool mat_approx(const IRegularMatrix<A, T>& a, const IRegularMatrix<B, T>& b, double tol)
+{
+	for (index_t j = 0; j < a.ncolumns(); ++j)
+		for (index_t i = 0; i < a.nrows(); ++i)
+			if (std::abs(a(i, j) - b(i, j)) > tol) return false;
+	return true;
+}
+
+
+T_CASE( fft_plans )
+{
+	const fft_plan<T>& p64 = get_fft_plan<T>(64);
+	ASSERT_EQ( p64.length(), 64 );
+	ASSERT_EQ( p64.nstages(), 3 );
+	for (index_t i = 0; i < 3; ++i) ASSERT_EQ( p64.radix(i), 4 );
+
+	const fft_plan<T>& p60 = get_fft_plan<T>(60);
+	ASSERT_EQ( p60.nstages(), 3 );
+	ASSERT_EQ( p60.radix(0), 4 );
+	ASSERT_EQ( p60.radix(1), 3 );
+	ASSERT_EQ( p60.radix(2), 5 );
+
+	const fft_plan<T>& p77 = get_fft_plan<T>(77);
+	ASSERT_EQ( p77.nstages(), 2 );
+	ASSERT_EQ( p77.radix(0), 7 );
+	ASSERT_EQ( p77.radix(1), 11 );
+
+	ASSERT_EQ( get_fft_plan<T>(1).nstages(), 0 );
+
+	// cached by length
+
+	ASSERT_TRUE( &get_fft_plan<T>(60) == &p60 );
+	ASSERT_TRUE( &get_rfft_plan<T>(60) == &get_rfft_plan<T>(60) );
+	ASSERT_TRUE( get_rfft_plan<T>(60).is_halved() );
+	ASSERT_EQ( get_rfft_plan<T>(60).complex_plan().length(), 30 );
+	ASSERT_FALSE( get_rfft_plan<T>(15).is_halved() );
+}
+
+template<typename T, class A>
+void verify_fft(const IRegularMatrix<A, std::complex<T> >& a)
+{
+	typedef std::complex<T> C;
+	const double tol = fft_tol<T>::get();
+	const index_t n = a.nrows();
+
+	dense_matrix<C> r(n, a.ncolumns());
+	fft(a, r);
+	for (index_t j = 0; j < a.ncolumns(); ++j)
+		ASSERT_TRUE( col_approx(r, j, naive_dft(a, j, false), n, tol) );
+
+	dense_matrix<C> b(n, a.ncolumns());
+	ifft(a, b);
+	for (index_t j = 0; j < a.ncolumns(); ++j)
+		ASSERT_TRUE( col_approx(b, j, naive_dft(a, j, true), n, tol) );
+}
+
+T_CASE( fft_complex )
+{
+	typedef std::complex<T> C;
+
+	for (int u = 0; u < n_fft_lens; ++u)
+	{
+		const index_t n = fft_lens[u];
+
+		dense_matrix<C> a(n, DN);
+		fill_rand(a);
+		verify_fft(a);
+
+		// strided columns and rows
+
+		dense_matrix<C> s(n + 3, DN + 2);
+		fill_rand(s);
+		verify_fft(cref_block<C>(s.ptr_data() + 1, n, DN, n + 3));
+		verify_fft(ref_matrix_rm<C>(s.ptr_data(), n, DN));
+	}
+}
+
+T_CASE( fft_vector )
+{
+	typedef std::complex<T> C;
+
+	// a single column: the later stages run on packs
+
+	const index_t lens[] = {1024, 960, 384, 343};
+	for (int u = 0; u < 4; ++u)
+	{
+		const index_t n = lens[u];
+		dense_col<C> a(n), r(n);
+		fill_rand(a);
+
+		fft(a, r);
+		ASSERT_TRUE( col_approx(r, 0, naive_dft(a, 0, false), n, fft_tol<T>::get()) );
+	}
+}
+
+T_CASE( fft_inverse )
+{
+	typedef std::complex<T> C;
+	const double tol = fft_tol<T>::get() * 50;
+
+	for (int u = 0; u < n_fft_lens; ++u)
+	{
+		const index_t n = fft_lens[u];
+
+		dense_matrix<C> a(n, DN), r(n, DN), b(n, DN);
+		fill_rand(a);
+
+		fft(a, r);
+		ifft(r, b);
+		ASSERT_TRUE( mat_approx(a, b, tol) );
+
+		// in place
+
+		b = a;
+		fft(b, b);
+		ASSERT_TRUE( mat_approx(b, r, tol * double(n)) );
+		ifft(b, b);
+		ASSERT_TRUE( mat_approx(a, b, tol) );
+	}
+}
+
+T_CASE( fft_real )
+{
+	typedef std::complex<T> C;
+	const double tol = fft_tol<T>::get();
+
+	for (int u = 0; u < n_fft_lens; ++u)
+	{
+		const index_t n = fft_lens[u];
+		const index_t h = n / 2 + 1;
+
+		dense_matrix<T> a(n, DN);
+		fill_rand(a);
+
+		dense_matrix<C> r(h, DN);
+		rfft(a, r);
+		for (index_t j = 0; j < DN; ++j)
+			ASSERT_TRUE( col_approx(r, j, naive_dft(a, j, false), h, tol) );
+
+		dense_matrix<T> b(n, DN);
+		irfft(r, b);
+		ASSERT_TRUE( mat_approx(a, b, tol * 50) );
+
+		// strided
+
+		dense_matrix<T> s(DN, n);
+		fill_rand(s);
+		ref_matrix_rm<T> sa(s.ptr_data(), n, DN);
+
+		dense_matrix<C> rs(h + 1, DN);
+		ref_block<C> rs_v(rs.ptr_data(), h, DN, h + 1);
+		rfft(sa, rs_v);
+		for (index_t j = 0; j < DN; ++j)
+			ASSERT_TRUE( col_approx(rs_v, j, naive_dft(sa, j, false), h, tol) );
+
+		dense_matrix<T> sb(DN, n);
+		ref_matrix_rm<T> sb_v(sb.ptr_data(), n, DN);
+		irfft(rs_v, sb_v);
+		ASSERT_TRUE( mat_approx(s, sb, tol * 50) );
+	}
+}
+
+T_CASE( fft_args )
+{
+	typedef std::complex<T> C;
+
+	dense_matrix<C> a(8, 3), r(8, 4);
+	bool thrown = false;
+	try { fft(a, r); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	dense_matrix<T> x(8, 3);
+	dense_matrix<C> y(4, 3);
+	thrown = false;
+	try { rfft(x, y); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	// empty
+
+	dense_matrix<C> e(0, 3), er(0, 3);
+	fft(e, er);
+}
+
+
+AUTO_TPACK( fft_plan )
+{
+	ADD_T_CASE_FP( fft_plans )
+}
+
+AUTO_TPACK( fft_complex )
+{
+	ADD_T_CASE_FP( fft_complex )
+	ADD_T_CASE_FP( fft_vector )
+	ADD_T_CASE_FP( fft_inverse )
+}
+
+AUTO_TPACK( fft_real )
+{
+	ADD_T_CASE_FP( fft_real )
+	ADD_T_CASE_FP( fft_args )
+}
@@ -113,6 +113,24 @@ namespace lmat { namespace test {
 		}
 	}
 
+	template<typename T, class Mat>
+	void fill_rand_complex(IRegularMatrix<Mat, std::complex<T> >& mat)
+	{
+		for (index_t j = 0; j < mat.ncolumns(); ++j)
+		{
+			for (index_t i = 0; i < mat.nrows(); ++i)
+			{
+				mat(i, j) = std::complex<T>(randunif<T>(T(-1.0), T(1.0)), randunif<T>(T(-1.0), T(1.0)));
+			}
+		}
+	}
+
+	template<typename T>
+	inline bool complex_approx(const std::complex<T>& a, const std::complex<T>& b, T tol)
+	{
+		return std::abs(a - b) <= tol;
+	}
+
 	template<typename T, class Mat>
 	void fill_rand_sym(IRegularMatrix<Mat, T>& mat)
 	{
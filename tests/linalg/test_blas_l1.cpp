@@ -203,3 +203,34 @@ DEFINE_BLAS_L1_CASE( dot )
 DEFINE_BLAS_L1_CASE( rot )
 DEFINE_BLAS_L1_CASE( scal )
 
+
+// complex dot products
+
+T_CASE( mat_blas_cdot )
+{
+	typedef std::complex<T> C;
+	T tol = blas_default_tol<T>::get();
+
+	dense_matrix<C> a(DM, DN);
+	dense_matrix<C> b(DN, DM);
+	fill_rand_complex(a);
+	fill_rand_complex(b);
+
+	// a row (strided) against a column (contiguous)
+
+	C r0(0), rc0(0);
+	for (index_t k = 0; k < DN; ++k)
+	{
+		r0 += a(2, k) * b(k, 1);
+		rc0 += std::conj(a(2, k)) * b(k, 1);
+	}
+
+	ASSERT_TRUE( complex_approx(blas::dot(a.row(2), b.column(1)), r0, tol) );
+	ASSERT_TRUE( complex_approx(blas::dotc(a.row(2), b.column(1)), rc0, tol) );
+	ASSERT_TRUE( complex_approx(blas::dotc(b.column(1), a.row(2)), std::conj(rc0), tol) );
+}
+
+AUTO_TPACK( mat_blas_cdot )
+{
+	ADD_T_CASE_FP( mat_blas_cdot )
+}
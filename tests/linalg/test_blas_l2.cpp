@@ -541,4 +541,49 @@ AUTO_TPACK( mat_ger )
 }
 
 
+// complex gemv
 
+T_CASE( mat_blas_cgemv )
+{
+	typedef std::complex<T> C;
+	T tol = blas_default_tol<T>::get();
+
+	dense_matrix<C> a(DM, DN);
+	dense_col<C> x(DN), y(DM), y0(DM);
+	fill_rand_complex(a);
+	fill_rand_complex(x);
+	fill_rand_complex(y0);
+
+	const C alpha(T(1.5), T(-0.5)), beta(T(0.5), T(2.0));
+
+	y = y0;
+	blas::gemv(alpha, a, x, beta, y);
+	for (index_t i = 0; i < DM; ++i)
+	{
+		C s(0);
+		for (index_t k = 0; k < DN; ++k) s += a(i, k) * x[k];
+		ASSERT_TRUE( complex_approx(y[i], alpha * s + beta * y0[i], tol) );
+	}
+
+	dense_col<C> u(DN);
+	blas::gemv(a, y0, u, 'T');
+	for (index_t k = 0; k < DN; ++k)
+	{
+		C s(0);
+		for (index_t i = 0; i < DM; ++i) s += a(i, k) * y0[i];
+		ASSERT_TRUE( complex_approx(u[k], s, tol) );
+	}
+
+	blas::gemv(a, y0, u, 'C');
+	for (index_t k = 0; k < DN; ++k)
+	{
+		C s(0);
+		for (index_t i = 0; i < DM; ++i) s += std::conj(a(i, k)) * y0[i];
+		ASSERT_TRUE( complex_approx(u[k], s, tol) );
+	}
+}
+
+AUTO_TPACK( mat_cgemv )
+{
+	ADD_T_CASE_FP( mat_blas_cgemv )
+}
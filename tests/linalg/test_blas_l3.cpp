@@ -254,6 +254,83 @@ void test_symm_r()
 }
 
 
+template<typename T, class C, class R>
+void copy_tri(char uplo, const C& c, R& r)
+{
+	index_t n = c.nrows();
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < n; ++i)
+		{
+			bool in_tri = (uplo == 'l' || uplo == 'L') ? i >= j : i <= j;
+			if (in_tri) r(i, j) = c(i, j);
+		}
+	}
+}
+
+template<class SA, class SB, class SC, typename T, int M, int N>
+void test_syrk_n(char uplo)
+{
+	index_t m = M == 0 ? DM : M;
+	index_t k = N == 0 ? DN : N;
+
+	typedef typename mat_host<SA, T, M, N>::cmat_t amat_t;
+	typedef typename mat_host<SC, T, M, M>::mat_t  cmat_t;
+
+	mat_host<SA, T, M, N> a_host(m, k);
+	mat_host<SC, T, M, M> c_host(m, m);
+
+	a_host.fill_rand();
+	c_host.fill_rand();
+
+	amat_t a = a_host.get_cmat();
+	cmat_t c = c_host.get_mat();
+
+	dense_matrix<T> r(m, m);
+	dense_matrix<T> p(m, m);
+	T tol = blas_default_tol<T>::get();
+
+	T alpha = T(2.5);
+	T beta = T(1.6);
+
+	safe_mm(alpha, a, 'n', a, 't', beta, c, r);
+	p = r;
+	blas::syrk(alpha, a, beta, c, 'n', uplo);
+	copy_tri<T>(uplo, c, p);
+
+	ASSERT_MAT_APPROX(m, m, p, r, tol);
+}
+
+template<class SA, class SB, class SC, typename T, int M, int N>
+void test_syrk_t(char uplo)
+{
+	index_t m = M == 0 ? DM : M;
+	index_t k = N == 0 ? DN : N;
+
+	typedef typename mat_host<SA, T, N, M>::cmat_t amat_t;
+	typedef typename mat_host<SC, T, M, M>::mat_t  cmat_t;
+
+	mat_host<SA, T, N, M> a_host(k, m);
+	mat_host<SC, T, M, M> c_host(m, m);
+
+	a_host.fill_rand();
+	c_host.fill_rand();
+
+	amat_t a = a_host.get_cmat();
+	cmat_t c = c_host.get_mat();
+
+	dense_matrix<T> r(m, m);
+	dense_matrix<T> p(m, m);
+	T tol = blas_default_tol<T>::get();
+
+	safe_mm(T(1), a, 't', a, 'n', T(0), c, r);
+	p = r;
+	blas::syrk(a, c, 't', uplo);
+	copy_tri<T>(uplo, c, p);
+
+	ASSERT_MAT_APPROX(m, m, p, r, tol);
+}
+
 template<class SA, class SB, class SC, typename T, int M, int N>
 void test_trmm_ln(char uplo)
 {
@@ -580,6 +657,27 @@ AUTO_TPACK( mat_symm_r )
 
 
 
+// syrk
+
+DEF_BLAS3_CASES_P3_TR( syrk_n )
+
+AUTO_TPACK( mat_syrk_n )
+{
+	ADD_BLAS3_CASES_P3( syrk_n, float )
+	ADD_BLAS3_CASES_P3( syrk_n, double )
+}
+
+DEF_BLAS3_CASES_P3_TR( syrk_t )
+
+AUTO_TPACK( mat_syrk_t )
+{
+	ADD_BLAS3_CASES_P3( syrk_t, float )
+	ADD_BLAS3_CASES_P3( syrk_t, double )
+}
+
+
+
+
 // trmm
 
 DEF_BLAS3_CASES_P3_TR( trmm_ln )
@@ -652,3 +750,49 @@ AUTO_TPACK( mat_trsm_rt )
 	ADD_BLAS3_CASES_P3( trsm_rt, double )
 }
 
+
+// complex gemm
+
+T_CASE( mat_blas_cgemm )
+{
+	typedef std::complex<T> C;
+	T tol = blas_default_tol<T>::get();
+
+	const index_t m = DM, n = DN, k = DK;
+
+	dense_matrix<C> a(m, k), b(k, n), bh(n, k), c(m, n), c0(m, n);
+	fill_rand_complex(a);
+	fill_rand_complex(b);
+	fill_rand_complex(bh);
+	fill_rand_complex(c0);
+
+	const C alpha(T(0.5), T(1.5)), beta(T(-1.0), T(0.5));
+
+	c = c0;
+	blas::gemm(alpha, a, b, beta, c);
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i)
+		{
+			C s(0);
+			for (index_t l = 0; l < k; ++l) s += a(i, l) * b(l, j);
+			ASSERT_TRUE( complex_approx(c(i, j), alpha * s + beta * c0(i, j), tol) );
+		}
+	}
+
+	blas::gemm(a, bh, c, 'N', 'C');
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i)
+		{
+			C s(0);
+			for (index_t l = 0; l < k; ++l) s += a(i, l) * std::conj(bh(j, l));
+			ASSERT_TRUE( complex_approx(c(i, j), s, tol) );
+		}
+	}
+}
+
+AUTO_TPACK( mat_cgemm )
+{
+	ADD_T_CASE_FP( mat_blas_cgemm )
+}
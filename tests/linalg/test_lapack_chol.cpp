@@ -181,6 +181,157 @@ void test_pddet(const dense_matrix<T>& a, const T& vdet)
 }
 
 
+template<typename T>
+void test_chol_update( char uplo )
+{
+	const index_t n = 9;
+	const index_t k = 3;
+
+	dense_matrix<T> a(n, n);
+	fill_rand_pdm(a);
+
+	dense_matrix<T> x(n, k);
+	do_fill_rand(x.ptr_data(), n * k);
+
+	dense_matrix<T> a1(a);
+	blas::gemm(T(1), x, x, T(1), a1, 'N', 'T');
+
+	T tol = (T)(sizeof(T) == 4 ? 1.0e-4 : 1.0e-10);
+
+	// update
+
+	chol_fac<T> chol(a, uplo);
+	const T *p0 = chol.intern().ptr_data();
+
+	chol.update(x);
+	ASSERT_EQ( chol.intern().ptr_data(), p0 );
+
+	dense_matrix<T> f, f0;
+	chol.get(f);
+	chol_fac<T>(a1, uplo).get(f0);
+	ASSERT_MAT_APPROX( n, n, f, f0, tol );
+
+	// downdate
+
+	chol.downdate(x);
+	ASSERT_EQ( chol.intern().ptr_data(), p0 );
+
+	chol.get(f);
+	chol_fac<T>(a, uplo).get(f0);
+	ASSERT_MAT_APPROX( n, n, f, f0, tol );
+
+	// downdate that loses positive definiteness
+
+	dense_matrix<T> y(n, 1, zero());
+	y[0] = math::sqrt(a(0, 0)) * T(2);
+
+	bool thrown = false;
+	try { chol.downdate(y); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	// ... leaves the factor intact, also when only a later column fails
+
+	dense_matrix<T> y2(n, 2, zero());
+	y2[0] = math::sqrt(a(0, 0)) * T(0.5);
+	y2[n] = math::sqrt(a(0, 0)) * T(2);
+
+	thrown = false;
+	try { chol.downdate(y2); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	chol.get(f);
+	ASSERT_MAT_APPROX( n, n, f, f0, tol );
+}
+
+
+template<typename T>
+void test_chol_insert_remove( char uplo )
+{
+	const index_t n = 8;
+
+	dense_matrix<T> a(n + 1, n + 1);
+	fill_rand_pdm(a);
+
+	T tol = (T)(sizeof(T) == 4 ? 1.0e-4 : 1.0e-10);
+
+	for (index_t j = 0; j <= n; ++j)
+	{
+		// a0: a without its j-th row & column
+
+		dense_matrix<T> a0(n, n);
+		for (index_t c = 0; c < n; ++c)
+			for (index_t r = 0; r < n; ++r)
+				a0(r, c) = a(r < j ? r : r + 1, c < j ? c : c + 1);
+
+		chol_fac<T> chol(a0, uplo);
+		chol.insert(j, a.column(j));
+		ASSERT_EQ( chol.dim(), n + 1 );
+
+		dense_matrix<T> f, f0;
+		chol.get(f);
+		chol_fac<T>(a, uplo).get(f0);
+		ASSERT_MAT_APPROX( n + 1, n + 1, f, f0, tol );
+
+		chol.remove(j);
+		ASSERT_EQ( chol.dim(), n );
+
+		chol.get(f);
+		chol_fac<T>(a0, uplo).get(f0);
+		ASSERT_MAT_APPROX( n, n, f, f0, tol );
+
+		// intern() is the factor (the leading block of the storage)
+
+		ASSERT_EQ( chol.intern().nrows(), n );
+		ASSERT_EQ( chol.intern().ncolumns(), n );
+
+		dense_matrix<T> fi(n, n, zero());
+		if (uplo == 'L') copy_tril(chol.intern(), fi);
+		else copy_triu(chol.intern(), fi);
+		ASSERT_MAT_APPROX( n, n, fi, f0, tol );
+
+		const T *pi = chol.intern().ptr_data();
+
+		dense_matrix<T> b(n, 2), x(n, 2), x0(n, 2);
+		do_fill_rand(b.ptr_data(), n * 2);
+		chol.solve(b, x);
+		chol_fac<T>(a0, uplo).solve(b, x0);
+		ASSERT_MAT_APPROX( n, 2, x, x0, tol );
+		ASSERT_APPROX( chol.eval_logdet(), chol_fac<T>(a0, uplo).eval_logdet(), tol );
+
+		// re-inserted within the capacity
+
+		chol.insert(j, a.column(j));
+		ASSERT_EQ( chol.intern().ptr_data(), pi );
+		ASSERT_EQ( chol.intern().nrows(), n + 1 );
+
+		chol.get(f);
+		chol_fac<T>(a, uplo).get(f0);
+		ASSERT_MAT_APPROX( n + 1, n + 1, f, f0, tol );
+	}
+
+	// an insertion that loses positive definiteness leaves the factor intact
+
+	// (with c = [a00; 2 * a(:,0)] inserted first, it is the trailing block that fails)
+
+	dense_col<T> c(n + 2);
+	c[0] = a(0, 0);
+	for (index_t i = 0; i <= n; ++i) c[i + 1] = a(i, 0) * T(2);
+
+	chol_fac<T> chol(a, uplo);
+	bool thrown = false;
+	try { chol.insert(0, c); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	dense_matrix<T> f, f0;
+	chol.get(f);
+	chol_fac<T>(a, uplo).get(f0);
+	ASSERT_MAT_APPROX( n + 1, n + 1, f, f0, tol );
+}
+
+
 T_CASE( mat_chol_solve_l )
 {
 	test_chol_solve<T>('L');
@@ -201,6 +352,26 @@ T_CASE( mat_chol_inv_u )
 	test_chol_inv<T>('U');
 }
 
+T_CASE( mat_chol_update_l )
+{
+	test_chol_update<T>('L');
+}
+
+T_CASE( mat_chol_update_u )
+{
+	test_chol_update<T>('U');
+}
+
+T_CASE( mat_chol_insert_l )
+{
+	test_chol_insert_remove<T>('L');
+}
+
+T_CASE( mat_chol_insert_u )
+{
+	test_chol_insert_remove<T>('U');
+}
+
 T_CASE( mat_chol_pdinv )
 {
 	test_pdinv<T>();
@@ -314,4 +485,14 @@ AUTO_TPACK( mat_pddev )
 	ADD_T_CASE( mat_pddet_5, double )
 }
 
-
+AUTO_TPACK( mat_chol_modify )
+{
+	ADD_T_CASE( mat_chol_update_l, float )
+	ADD_T_CASE( mat_chol_update_l, double )
+	ADD_T_CASE( mat_chol_update_u, float )
+	ADD_T_CASE( mat_chol_update_u, double )
+	ADD_T_CASE( mat_chol_insert_l, float )
+	ADD_T_CASE( mat_chol_insert_l, double )
+	ADD_T_CASE( mat_chol_insert_u, float )
+	ADD_T_CASE( mat_chol_insert_u, double )
+}
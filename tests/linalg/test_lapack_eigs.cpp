@@ -0,0 +1,240 @@
+/**
+ * @file test_lapack_eigs.cpp
+ *
+ * @brief Unit testing of iterative symmetric eigensolvers
+ *
+ * @author Dahua Lin
+ */
+
+#include "linalg_test_base.h"
+#include <light_mat/linalg/lapack_eigs.h>
+
+using namespace lmat;
+using namespace lmat::test;
+
+using lmat::lapack::syev;
+using lmat::lapack::lanczos_eigs;
+using lmat::lapack::lobpcg_eigs;
+using lmat::lapack::symeig_options;
+
+const index_t N = 120;
+const index_t K = 5;
+
+
+// a random symmetric matrix with eigenvalues -N/2, ..., N/2 - 1
+
+template<typename T>
+void make_symmat(index_t n, dense_matrix<T>& a)
+{
+	dense_matrix<T> g(n, n);
+	do_fill_rand(g.ptr_data(), n * n);
+
+	lapack::qr_fac<T> qf(g);
+	dense_matrix<T> q;
+	qf.getq(q, n);
+
+	dense_matrix<T> qd(q);
+	for (index_t j = 0; j < n; ++j)
+	{
+		T d = T(j - n / 2);
+		for (index_t i = 0; i < n; ++i) qd(i, j) *= d;
+	}
+
+	a.require_size(n, n);
+	blas::gemm(qd, q, a, 'N', 'T');
+
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = j + 1; i < n; ++i) a(j, i) = a(i, j);
+}
+
+
+// 1D Laplacian, applied without forming the matrix
+
+template<typename T>
+struct laplacian_op
+{
+	void operator() (const cref_matrix<T>& x, ref_matrix<T>& y) const
+	{
+		const index_t n = x.nrows();
+		for (index_t j = 0; j < x.ncolumns(); ++j)
+		{
+			for (index_t i = 0; i < n; ++i)
+			{
+				T v = T(2) * x(i, j);
+				if (i > 0) v -= x(i - 1, j);
+				if (i < n - 1) v -= x(i + 1, j);
+				y(i, j) = v;
+			}
+		}
+	}
+};
+
+
+template<typename T, class Op>
+void verify_eigpairs(const Op& op, index_t n, const dense_col<T>& w0,
+		const dense_col<T>& w, const dense_matrix<T>& v, T tol)
+{
+	const index_t k = w0.nelems();
+
+	ASSERT_EQ( w.nrows(), k );
+	ASSERT_EQ( v.nrows(), n );
+	ASSERT_EQ( v.ncolumns(), k );
+
+	ASSERT_VEC_APPROX( k, w, w0, tol );
+
+	// A * v = v * diag(w)
+
+	dense_matrix<T> av(n, k);
+	ref_matrix<T> avr(av.ptr_data(), n, k);
+	op(cref_matrix<T>(v.ptr_data(), n, k), avr);
+
+	dense_matrix<T> vw(v);
+	for (index_t j = 0; j < k; ++j)
+		for (index_t i = 0; i < n; ++i) vw(i, j) *= w[j];
+
+	ASSERT_MAT_APPROX( n, k, av, vw, tol );
+
+	// v' * v = I
+
+	dense_matrix<T> e(k, k, zero());
+	for (index_t i = 0; i < k; ++i) e(i, i) = T(1);
+
+	dense_matrix<T> g(k, k);
+	blas::gemm(v, v, g, 'T', 'N');
+	ASSERT_MAT_APPROX( k, k, g, e, tol );
+}
+
+template<typename T>
+T eigs_test_tol()
+{
+	return (T)(sizeof(T) == 4 ? 2.0e-2 : 1.0e-6);
+}
+
+template<typename T>
+symeig_options<T> eigs_test_opts()
+{
+	return symeig_options<T>((T)(sizeof(T) == 4 ? 1.0e-5 : 1.0e-10), 1000);
+}
+
+
+T_CASE( lanczos_mat )
+{
+	dense_matrix<T> a;
+	make_symmat(N, a);
+
+	dense_col<T> wa;
+	syev(a, wa);
+
+	dense_col<T> w0L = wa(range(N - K, K), whole());
+	dense_col<T> w0S = wa(range(0, K), whole());
+
+	dense_col<T> w;
+	dense_matrix<T> v;
+	lapack::sym_matrix_op<T, dense_matrix<T> > op(a);
+
+	ASSERT_TRUE( lanczos_eigs(a, K, w, v, 'L', eigs_test_opts<T>()) );
+	verify_eigpairs(op, N, w0L, w, v, eigs_test_tol<T>());
+
+	ASSERT_TRUE( lanczos_eigs(a, K, w, v, 'S', eigs_test_opts<T>()) );
+	verify_eigpairs(op, N, w0S, w, v, eigs_test_tol<T>());
+}
+
+T_CASE( lobpcg_mat )
+{
+	dense_matrix<T> a;
+	make_symmat(N, a);
+
+	dense_col<T> wa;
+	syev(a, wa);
+
+	dense_col<T> w0L = wa(range(N - K, K), whole());
+	dense_col<T> w0S = wa(range(0, K), whole());
+
+	dense_col<T> w;
+	dense_matrix<T> v;
+	lapack::sym_matrix_op<T, dense_matrix<T> > op(a);
+
+	ASSERT_TRUE( lobpcg_eigs(a, K, w, v, 'L', eigs_test_opts<T>()) );
+	verify_eigpairs(op, N, w0L, w, v, eigs_test_tol<T>());
+
+	ASSERT_TRUE( lobpcg_eigs(a, K, w, v, 'S', eigs_test_opts<T>()) );
+	verify_eigpairs(op, N, w0S, w, v, eigs_test_tol<T>());
+}
+
+T_CASE( eigs_matfree )
+{
+	const index_t n = 60;
+	laplacian_op<T> op;
+
+	// eigenvalues: 2 - 2 cos(pi * j / (n + 1))
+
+	dense_col<T> w0L(K), w0S(K);
+	for (index_t j = 0; j < K; ++j)
+	{
+		w0S[j] = T(2 - 2 * std::cos(M_PI * double(j + 1) / double(n + 1)));
+		w0L[j] = T(2 - 2 * std::cos(M_PI * double(n - K + j + 1) / double(n + 1)));
+	}
+
+	dense_col<T> w;
+	dense_matrix<T> v;
+
+	ASSERT_TRUE( lanczos_eigs(op, n, K, w, v, 'L', eigs_test_opts<T>()) );
+	verify_eigpairs(op, n, w0L, w, v, eigs_test_tol<T>());
+
+	ASSERT_TRUE( lanczos_eigs(op, n, K, w, v, 'S', eigs_test_opts<T>()) );
+	verify_eigpairs(op, n, w0S, w, v, eigs_test_tol<T>());
+
+	ASSERT_TRUE( lobpcg_eigs(op, n, K, w, v, 'L', eigs_test_opts<T>()) );
+	verify_eigpairs(op, n, w0L, w, v, eigs_test_tol<T>());
+}
+
+SIMPLE_CASE( eigs_args )
+{
+	dense_matrix<double> a;
+	make_symmat(9, a);
+
+	dense_col<double> w;
+	dense_matrix<double> v;
+
+	// small problems: the whole space is spanned
+
+	dense_col<double> wa;
+	syev(a, wa);
+	ASSERT_TRUE( lanczos_eigs(a, 3, w, v, 'S') );
+	ASSERT_VEC_APPROX( 3, w, wa, 1.0e-8 );
+
+	bool thrown = false;
+	try { lanczos_eigs(a, 9, w, v); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	thrown = false;
+	try { lobpcg_eigs(a, 4, w, v); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	thrown = false;
+	try { lanczos_eigs(a, 2, w, v, 'X'); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+}
+
+
+AUTO_TPACK( eigs_lanczos )
+{
+	ADD_T_CASE( lanczos_mat, float )
+	ADD_T_CASE( lanczos_mat, double )
+}
+
+AUTO_TPACK( eigs_lobpcg )
+{
+	ADD_T_CASE( lobpcg_mat, float )
+	ADD_T_CASE( lobpcg_mat, double )
+}
+
+AUTO_TPACK( eigs_others )
+{
+	ADD_T_CASE( eigs_matfree, float )
+	ADD_T_CASE( eigs_matfree, double )
+	ADD_SIMPLE_CASE( eigs_args )
+}
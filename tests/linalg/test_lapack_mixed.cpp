@@ -0,0 +1,198 @@
+/**
+ * @file test_lapack_mixed.cpp
+ *
+ * @brief Unit testing of mixed-precision linear solvers
+ *
+ * @author Dahua Lin
+ */
+
+#include "linalg_test_base.h"
+#include <light_mat/linalg/lapack_mixed.h>
+#include <light_mat/linalg/lapack_qr.h>
+
+using namespace lmat;
+using namespace lmat::test;
+
+using lmat::lapack::mixed_solve_info;
+using lmat::lapack::gesv_mixed;
+using lmat::lapack::posv_mixed;
+
+const index_t N = 80;
+const index_t NRHS = 3;
+
+
+// a = q * diag(s) * q', with s spaced geometrically from 1 to 1/cond
+
+void make_condmat(index_t n, double cond, dense_matrix<double>& a)
+{
+	dense_matrix<double> g(n, n);
+	do_fill_rand(g.ptr_data(), n * n);
+
+	dense_matrix<double> q;
+	lapack::qr_fac<double>(g).getq(q, n);
+
+	dense_matrix<double> qs(q);
+	for (index_t j = 0; j < n; ++j)
+	{
+		double s = std::pow(cond, -double(j) / double(n - 1));
+		for (index_t i = 0; i < n; ++i) qs(i, j) *= s;
+	}
+
+	a.require_size(n, n);
+	blas::gemm(qs, q, a, 'N', 'T');
+}
+
+void verify_residual(const dense_matrix<double>& a, const dense_matrix<double>& b,
+		const dense_matrix<double>& x, double tol)
+{
+	dense_matrix<double> r(b);
+	blas::gemm(-1.0, a, x, 1.0, r);
+
+	for (index_t j = 0; j < b.ncolumns(); ++j)
+	{
+		double rmax = 0, xmax = 0;
+		for (index_t i = 0; i < b.nrows(); ++i)
+		{
+			rmax = math::max(rmax, math::abs(r(i, j)));
+			xmax = math::max(xmax, math::abs(x(i, j)));
+		}
+		ASSERT_TRUE( rmax <= tol * xmax );
+	}
+}
+
+
+SIMPLE_CASE( gesv_mixed_refine )
+{
+	dense_matrix<double> a(N, N), b(N, NRHS);
+	make_condmat(N, 100.0, a);
+	do_fill_rand(b.ptr_data(), N * NRHS);
+
+	dense_matrix<double> x(N, NRHS);
+	mixed_solve_info info = gesv_mixed(a, b, x);
+
+	ASSERT_FALSE( info.fallback );
+	ASSERT_TRUE( info.iters > 0 );
+	ASSERT_TRUE( info.iters <= 5 );
+
+	dense_matrix<double> a_(a), x0(b);
+	lapack::gesv(a_, x0);
+
+	ASSERT_MAT_APPROX( N, NRHS, x, x0, 1.0e-11 );
+	verify_residual(a, b, x, 1.0e-12);
+}
+
+SIMPLE_CASE( gesv_mixed_fallback )
+{
+	dense_matrix<double> a(N, N), b(N, NRHS);
+	do_fill_rand(b.ptr_data(), N * NRHS);
+
+	dense_matrix<double> x(N, NRHS);
+
+	// too ill-conditioned for single precision: refinement stalls
+
+	make_condmat(N, 1.0e10, a);
+	mixed_solve_info info = gesv_mixed(a, b, x);
+	ASSERT_TRUE( info.fallback );
+
+	dense_matrix<double> a_(a), x0(b);
+	lapack::gesv(a_, x0);
+	ASSERT_MAT_APPROX( N, NRHS, x, x0, 1.0e-12 );
+
+	// singular in single precision: the factorization fails
+
+	dense_matrix<double> d(2, 2, zero()), e(2, 1), y(2, 1);
+	d(0, 0) = 1.0;
+	d(1, 1) = 1.0e-50;
+	e[0] = 2.0;
+	e[1] = 3.0e-50;
+
+	info = gesv_mixed(d, e, y);
+	ASSERT_TRUE( info.fallback );
+	ASSERT_APPROX( y[0], 2.0, 1.0e-14 );
+	ASSERT_APPROX( y[1], 3.0, 1.0e-14 );
+
+	// no refinement steps allowed
+
+	make_condmat(N, 100.0, a);
+	info = gesv_mixed(a, b, x, 0);
+	ASSERT_TRUE( info.fallback );
+	verify_residual(a, b, x, 1.0e-12);
+}
+
+template<char Uplo>
+void test_posv_mixed()
+{
+	dense_matrix<double> a(N, N), b(N, NRHS);
+	fill_rand_pdm(a);
+	do_fill_rand(b.ptr_data(), N * NRHS);
+
+	dense_matrix<double> x(N, NRHS);
+	mixed_solve_info info = posv_mixed(a, b, x, Uplo);
+	ASSERT_FALSE( info.fallback );
+	ASSERT_TRUE( info.iters <= 5 );
+
+	dense_matrix<double> a_(a), x0(b);
+	lapack::posv(a_, x0, Uplo);
+
+	ASSERT_MAT_APPROX( N, NRHS, x, x0, 1.0e-11 );
+	verify_residual(a, b, x, 1.0e-12);
+
+	// only the uplo triangle is read: the other one holds garbage
+
+	dense_matrix<double> ah(a);
+	for (index_t j = 0; j < N; ++j)
+	{
+		for (index_t i = 0; i < N; ++i)
+		{
+			if (Uplo == 'L' ? i < j : i > j) ah(i, j) = 1.0e6 * double(i - j);
+		}
+	}
+
+	dense_matrix<double> xh(N, NRHS);
+	info = posv_mixed(ah, b, xh, Uplo);
+	ASSERT_FALSE( info.fallback );
+	ASSERT_TRUE( info.iters <= 5 );
+
+	ASSERT_MAT_APPROX( N, NRHS, xh, x0, 1.0e-11 );
+	verify_residual(a, b, xh, 1.0e-12);
+}
+
+SIMPLE_CASE( posv_mixed_l )
+{
+	test_posv_mixed<'L'>();
+}
+
+SIMPLE_CASE( posv_mixed_u )
+{
+	test_posv_mixed<'U'>();
+}
+
+SIMPLE_CASE( posv_mixed_fallback )
+{
+	// not positive definite in single precision
+
+	dense_matrix<double> d(2, 2, zero()), e(2, 1), y(2, 1);
+	d(0, 0) = 1.0;
+	d(1, 1) = 1.0e-50;
+	e[0] = 2.0;
+	e[1] = 3.0e-50;
+
+	mixed_solve_info info = posv_mixed(d, e, y);
+	ASSERT_TRUE( info.fallback );
+	ASSERT_APPROX( y[0], 2.0, 1.0e-14 );
+	ASSERT_APPROX( y[1], 3.0, 1.0e-14 );
+}
+
+
+AUTO_TPACK( mixed_gesv )
+{
+	ADD_SIMPLE_CASE( gesv_mixed_refine )
+	ADD_SIMPLE_CASE( gesv_mixed_fallback )
+}
+
+AUTO_TPACK( mixed_posv )
+{
+	ADD_SIMPLE_CASE( posv_mixed_l )
+	ADD_SIMPLE_CASE( posv_mixed_u )
+	ADD_SIMPLE_CASE( posv_mixed_fallback )
+}
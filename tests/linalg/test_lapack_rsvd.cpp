@@ -0,0 +1,233 @@
+/**
+ * @file test_lapack_rsvd.cpp
+ *
+ * @brief Unit testing of randomized truncated SVD
+ *
+ * @author Dahua Lin
+ */
+
+
+#include "linalg_test_base.h"
+#include <light_mat/linalg/lapack_rsvd.h>
+#include <light_mat/random/rand_stream.h>
+
+using namespace lmat;
+using namespace lmat::test;
+using lmat::random::default_rand_stream;
+
+using lmat::lapack::gesdd;
+using lmat::lapack::rsvd;
+using lmat::lapack::rsvd_options;
+
+
+template<typename T, class Mat>
+bool is_orth_cols( const IRegularMatrix<Mat, T>& a, T tol)
+{
+	index_t n = a.ncolumns();
+
+	dense_matrix<T> e(n, n, zero());
+	for (index_t i = 0; i < n; ++i) e(i, i) = T(1);
+
+	dense_matrix<T> r(n, n, zero());
+	blas::gemm(a, a, r, 'T', 'N');
+
+	return ltest::test_matrix_approx(n, n, r, e, tol);
+}
+
+template<typename T, class Mat>
+bool is_orth_rows( const IRegularMatrix<Mat, T>& a, T tol)
+{
+	index_t m = a.nrows();
+
+	dense_matrix<T> e(m, m, zero());
+	for (index_t i = 0; i < m; ++i) e(i, i) = T(1);
+
+	dense_matrix<T> r(m, m, zero());
+	blas::gemm(a, a, r, 'N', 'T');
+
+	return ltest::test_matrix_approx(m, m, r, e, tol);
+}
+
+template<typename T>
+void rsvd_recons(const dense_col<T>& s, const dense_matrix<T>& u, const dense_matrix<T>& vt,
+		dense_matrix<T>& r)
+{
+	index_t k = s.nelems();
+
+	dense_matrix<T> us(u);
+	for (index_t j = 0; j < k; ++j)
+		for (index_t i = 0; i < us.nrows(); ++i) us(i, j) *= s[j];
+
+	r.require_size(u.nrows(), vt.ncolumns());
+	blas::gemm(us, vt, r);
+}
+
+
+// rank-r matrix: recovered exactly
+
+template<typename T>
+void test_rsvd_lowrank( index_t m, index_t n )
+{
+	const index_t r = 4;
+	T tol = (T)(sizeof(T) == 4 ? 2.0e-4 : 1.0e-10);
+
+	dense_matrix<T> x(m, r), y(r, n), a(m, n);
+	do_fill_rand(x.ptr_data(), m * r);
+	do_fill_rand(y.ptr_data(), r * n);
+	blas::gemm(x, y, a);
+
+	dense_col<T> s0;
+	gesdd(a, s0);
+
+	default_rand_stream rs;
+
+	dense_col<T> s;
+	dense_matrix<T> u;
+	dense_matrix<T> vt;
+
+	rsvd(a, r, rs, s, u, vt, rsvd_options(3, 0));
+
+	ASSERT_EQ( s.nrows(), r );
+	ASSERT_EQ( s.ncolumns(), 1 );
+	ASSERT_EQ( u.nrows(), m );
+	ASSERT_EQ( u.ncolumns(), r );
+	ASSERT_EQ( vt.nrows(), r );
+	ASSERT_EQ( vt.ncolumns(), n );
+
+	ASSERT_VEC_APPROX( r, s, s0, tol * s0[0] );
+	ASSERT_TRUE( is_orth_cols(u, tol) );
+	ASSERT_TRUE( is_orth_rows(vt, tol) );
+
+	dense_matrix<T> ar;
+	rsvd_recons(s, u, vt, ar);
+	ASSERT_MAT_APPROX( m, n, ar, a, tol * s0[0] );
+}
+
+
+// full-rank matrix with a decaying spectrum: top triplets
+
+template<typename T>
+void test_rsvd_decay( index_t m, index_t n )
+{
+	const index_t k = 5;
+	const index_t rk = math::min(m, n);
+	T tol = (T)(sizeof(T) == 4 ? 1.0e-3 : 1.0e-8);
+
+	// a = Qu * diag(sig) * Qv'
+
+	dense_matrix<T> gu(m, rk), gv(n, rk);
+	do_fill_rand(gu.ptr_data(), m * rk);
+	do_fill_rand(gv.ptr_data(), n * rk);
+
+	lapack::qr_fac<T> qu(gu);
+	lapack::qr_fac<T> qv(gv);
+
+	dense_matrix<T> u0, v0;
+	qu.getq(u0, rk);
+	qv.getq(v0, rk);
+
+	for (index_t j = 0; j < rk; ++j)
+	{
+		T sig = std::pow(T(0.5), T(j));
+		for (index_t i = 0; i < m; ++i) u0(i, j) *= sig;
+	}
+
+	dense_matrix<T> a(m, n);
+	blas::gemm(u0, v0, a, 'N', 'T');
+
+	default_rand_stream rs;
+
+	dense_col<T> s;
+	dense_matrix<T> u;
+	dense_matrix<T> vt;
+
+	rsvd(a, k, rs, s, u, vt);
+
+	ASSERT_EQ( s.nrows(), k );
+	ASSERT_EQ( u.ncolumns(), k );
+	ASSERT_EQ( vt.nrows(), k );
+
+	for (index_t j = 0; j < k; ++j)
+	{
+		ASSERT_APPROX( s[j], std::pow(T(0.5), T(j)), tol );
+	}
+
+	ASSERT_TRUE( is_orth_cols(u, tol) );
+	ASSERT_TRUE( is_orth_rows(vt, tol) );
+
+	// the error is about the (k+1)-th singular value
+
+	dense_matrix<T> ar;
+	rsvd_recons(s, u, vt, ar);
+
+	T e2 = 0;
+	for (index_t i = 0; i < m * n; ++i) e2 += math::sqr(ar[i] - a[i]);
+	ASSERT_TRUE( std::sqrt(e2) < T(1.2) * std::pow(T(0.5), T(k - 1)) );
+}
+
+
+T_CASE( rsvd_lowrank_gt )
+{
+	test_rsvd_lowrank<T>(40, 25);
+}
+
+T_CASE( rsvd_lowrank_lt )
+{
+	test_rsvd_lowrank<T>(25, 40);
+}
+
+T_CASE( rsvd_decay_gt )
+{
+	test_rsvd_decay<T>(60, 30);
+}
+
+T_CASE( rsvd_decay_lt )
+{
+	test_rsvd_decay<T>(30, 60);
+}
+
+SIMPLE_CASE( rsvd_args )
+{
+	dense_matrix<double> a(6, 4, zero());
+	default_rand_stream rs;
+
+	dense_col<double> s;
+	dense_matrix<double> u, vt;
+
+	// the sketch is clipped at min(m, n)
+
+	a(0, 0) = 2.0;
+	a(1, 1) = 1.0;
+	rsvd(a, 4, rs, s, u, vt, rsvd_options(10, 1));
+	ASSERT_EQ( s.nrows(), 4 );
+	ASSERT_APPROX( s[0], 2.0, 1.0e-12 );
+	ASSERT_APPROX( s[1], 1.0, 1.0e-12 );
+
+	bool thrown = false;
+	try { rsvd(a, 5, rs, s, u, vt); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	thrown = false;
+	try { rsvd(a, 0, rs, s, u, vt); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+}
+
+
+AUTO_TPACK( rsvd_lowrank )
+{
+	ADD_T_CASE( rsvd_lowrank_gt, float )
+	ADD_T_CASE( rsvd_lowrank_lt, float )
+	ADD_T_CASE( rsvd_lowrank_gt, double )
+	ADD_T_CASE( rsvd_lowrank_lt, double )
+}
+
+AUTO_TPACK( rsvd_decay )
+{
+	ADD_T_CASE( rsvd_decay_gt, float )
+	ADD_T_CASE( rsvd_decay_lt, float )
+	ADD_T_CASE( rsvd_decay_gt, double )
+	ADD_T_CASE( rsvd_decay_lt, double )
+	ADD_SIMPLE_CASE( rsvd_args )
+}
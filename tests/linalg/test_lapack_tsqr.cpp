@@ -0,0 +1,187 @@
+/**
+ * @file test_lapack_tsqr.cpp
+ *
+ * @brief Unit testing of tall-skinny QR factorization
+ *
+ * @author Dahua Lin
+ */
+
+#include "linalg_test_base.h"
+#include <light_mat/linalg/lapack_tsqr.h>
+
+using namespace lmat;
+using namespace lmat::test;
+
+using lmat::lapack::qr_fac;
+using lmat::lapack::tsqr_fac;
+using lmat::lapack::tsqr_stream;
+
+
+// R factors agree with those of geqrf up to the signs of rows
+
+template<typename T>
+void regularize_r(dense_matrix<T>& r)
+{
+	const index_t n = r.ncolumns();
+	for (index_t i = 0; i < r.nrows(); ++i)
+	{
+		if (r(i, i) < 0)
+		{
+			for (index_t j = 0; j < n; ++j) r(i, j) = -r(i, j);
+		}
+	}
+}
+
+template<typename T>
+void test_tsqr(index_t m, index_t n, index_t br, index_t nb0)
+{
+	const index_t nrhs = 3;
+	T tol = (T)(sizeof(T) == 4 ? 1.0e-3 : 1.0e-10);
+
+	dense_matrix<T> a(m, n), b(m, nrhs);
+	do_fill_rand(a.ptr_data(), m * n);
+	do_fill_rand(b.ptr_data(), m * nrhs);
+
+	tsqr_fac<T> tq(a, br);
+	ASSERT_EQ( tq.nrows(), m );
+	ASSERT_EQ( tq.ncolumns(), n );
+	ASSERT_EQ( tq.nblocks(), nb0 );
+
+	// R
+
+	dense_matrix<T> r, r0;
+	tq.getr(r);
+	qr_fac<T>(a).getr(r0, n);
+
+	ASSERT_EQ( r.nrows(), n );
+	ASSERT_EQ( r.ncolumns(), n );
+
+	regularize_r(r);
+	regularize_r(r0);
+	ASSERT_MAT_APPROX( n, n, r, r0, tol );
+
+	// Q * (Q' * b) is the projection of b onto range(a)
+
+	dense_matrix<T> c, pb;
+	tq.multq_t(b, c);
+	ASSERT_EQ( c.nrows(), n );
+	ASSERT_EQ( c.ncolumns(), nrhs );
+
+	tq.multq(c, pb);
+	ASSERT_EQ( pb.nrows(), m );
+	ASSERT_EQ( pb.ncolumns(), nrhs );
+
+	dense_matrix<T> g(n, nrhs), g0(n, nrhs);
+	blas::gemm(a, pb, g, 'T', 'N');
+	blas::gemm(a, b, g0, 'T', 'N');
+	ASSERT_MAT_APPROX( n, nrhs, g, g0, tol * T(m) );
+
+	// Q has orthonormal columns
+
+	dense_matrix<T> e(n, n, zero());
+	for (index_t i = 0; i < n; ++i) e(i, i) = T(1);
+
+	dense_matrix<T> q, qtq(n, n);
+	tq.multq(e, q);
+	blas::gemm(q, q, qtq, 'T', 'N');
+	ASSERT_MAT_APPROX( n, n, qtq, e, tol );
+
+	// least squares
+
+	dense_matrix<T> x, x0;
+	tq.solve(b, x);
+	qr_fac<T>(a).solve(b, x0);
+	ASSERT_MAT_APPROX( n, nrhs, x, x0, tol );
+
+	// streaming, in uneven row blocks
+
+	tsqr_stream<T> ts(n, nrhs);
+	index_t r0i = 0;
+	for (index_t k = 1; r0i < m; ++k)
+	{
+		const index_t mi = math::min(k * 7, m - r0i);
+		ts.add(a(range(r0i, mi), whole()), b(range(r0i, mi), whole()));
+		r0i += mi;
+	}
+
+	ASSERT_EQ( ts.nrows(), m );
+	ASSERT_TRUE( ts.ready() );
+
+	dense_matrix<T> xs;
+	ts.solve(xs);
+	ASSERT_MAT_APPROX( n, nrhs, xs, x0, tol );
+
+	dense_matrix<T> rs;
+	ts.getr(rs);
+	regularize_r(rs);
+	ASSERT_MAT_APPROX( n, n, rs, r0, tol );
+}
+
+
+T_CASE( tsqr_single )
+{
+	test_tsqr<T>(50, 6, 64, 1);
+}
+
+T_CASE( tsqr_tree2 )
+{
+	test_tsqr<T>(64, 6, 32, 2);
+}
+
+T_CASE( tsqr_tree_odd )
+{
+	test_tsqr<T>(205, 5, 20, 10);   // 10 -> 5 -> 3 -> 2 -> 1
+	test_tsqr<T>(230, 5, 32, 7);    // 7 -> 4 -> 2 -> 1, remainder in the last block
+}
+
+SIMPLE_CASE( tsqr_args )
+{
+	dense_matrix<double> a(4, 6);
+	do_fill_rand(a.ptr_data(), 24);
+
+	bool thrown = false;
+	try { tsqr_fac<double> tq(a); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	tsqr_stream<double> ts(6, 1);
+	dense_matrix<double> b(4, 1, zero());
+	ts.add(a, b);
+	ASSERT_FALSE( ts.ready() );
+
+	dense_matrix<double> x;
+	thrown = false;
+	try { ts.solve(x); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	// nothing factorized yet
+
+	tsqr_fac<double> te;
+	dense_matrix<double> c0(0, 2), y0;
+	te.multq(c0, y0);
+	ASSERT_EQ( y0.nrows(), 0 );
+	ASSERT_EQ( y0.ncolumns(), 2 );
+
+	dense_matrix<double> r0;
+	te.getr(r0);
+	ASSERT_EQ( r0.nrows(), 0 );
+	ASSERT_EQ( r0.ncolumns(), 0 );
+
+	dense_matrix<double> b0(0, 2), x0;
+	te.solve(b0, x0);
+	ASSERT_EQ( x0.nrows(), 0 );
+	ASSERT_EQ( x0.ncolumns(), 2 );
+}
+
+
+AUTO_TPACK( tsqr )
+{
+	ADD_T_CASE( tsqr_single, float )
+	ADD_T_CASE( tsqr_single, double )
+	ADD_T_CASE( tsqr_tree2, float )
+	ADD_T_CASE( tsqr_tree2, double )
+	ADD_T_CASE( tsqr_tree_odd, float )
+	ADD_T_CASE( tsqr_tree_odd, double )
+	ADD_SIMPLE_CASE( tsqr_args )
+}
@@ -0,0 +1,112 @@
+/**
+ * @file test_mat_cov.cpp
+ *
+ * @brief Unit testing of covariance computation
+ *
+ * @author Dahua Lin
+ */
+
+#include "linalg_test_base.h"
+#include <light_mat/linalg/mat_cov.h>
+
+using namespace lmat;
+using namespace lmat::test;
+
+
+template<typename T, class X, class R>
+void safe_cov(const X& x, R& r)
+{
+	index_t m = x.nrows();
+	index_t n = x.ncolumns();
+
+	dense_row<double> mu(n, zero());
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i) mu[j] += x(i, j);
+		mu[j] /= double(m);
+	}
+
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t k = 0; k < n; ++k)
+		{
+			double v = 0;
+			for (index_t i = 0; i < m; ++i) v += (x(i, j) - mu[j]) * (x(i, k) - mu[k]);
+			r(j, k) = T(v / double(m - 1));
+		}
+	}
+}
+
+
+template<typename T>
+void test_cov(index_t m, index_t n)
+{
+	dense_matrix<T> x(m, n);
+	for (index_t i = 0; i < m * n; ++i) x[i] = randunif<T>(T(-1), T(1)) + T(10);
+
+	dense_matrix<T> r(n, n);
+	safe_cov<T>(x, r);
+
+	dense_matrix<T> c(n, n, zero());
+	cov(x, c);
+
+	T tol = blas_default_tol<T>::get() * T(10);
+	ASSERT_MAT_APPROX(n, n, c, r, tol);
+
+	// on a block view with given mean
+
+	dense_matrix<T> xx(m + 3, n + 2);
+	for (index_t i = 0; i < xx.nelems(); ++i) xx[i] = T(0);
+	ref_block<T> xb = xx(range(1, m), range(2, n));
+	xb = x;
+
+	dense_row<T> mu(n);
+	colwise_mean(x, mu);
+
+	dense_matrix<T> c2(n, n, zero());
+	cov(xb, mu, c2);
+	ASSERT_MAT_APPROX(n, n, c2, r, tol);
+}
+
+
+template<typename T>
+void test_cov_all()
+{
+	test_cov<T>(2, 1);
+	test_cov<T>(5, 3);
+	test_cov<T>(100, 7);
+
+	// spans multiple row blocks
+	index_t n = 9;
+	index_t bm = internal::cov_block_rows(index_t(100000), n);
+	test_cov<T>(bm * 2 + 17, n);
+}
+
+SIMPLE_CASE( mat_cov_f32 )
+{
+	test_cov_all<float>();
+}
+
+SIMPLE_CASE( mat_cov_f64 )
+{
+	test_cov_all<double>();
+}
+
+SIMPLE_CASE( mat_cov_degenerate )
+{
+	dense_matrix<double> x1(1, 4);
+	for (index_t i = 0; i < 4; ++i) x1[i] = double(i);
+
+	dense_matrix<double> c(4, 4);
+	cov(x1, c);
+
+	dense_matrix<double> z(4, 4, zero());
+	ASSERT_MAT_EQ(4, 4, c, z);
+}
+
+AUTO_TPACK( mat_cov )
+{
+	ADD_SIMPLE_CASE( mat_cov_f32 )
+	ADD_SIMPLE_CASE( mat_cov_f64 )
+	ADD_SIMPLE_CASE( mat_cov_degenerate )
+}
@@ -0,0 +1,185 @@
+/**
+ * @file test_pairwise_dist.cpp
+ *
+ * @brief Unit testing of pairwise distance computation
+ *
+ * @author Dahua Lin
+ */
+
+#include "linalg_test_base.h"
+#include <light_mat/linalg/pairwise_dist.h>
+
+using namespace lmat;
+using namespace lmat::test;
+
+
+template<typename T>
+struct pdist_tol;
+
+template<> struct pdist_tol<float>
+{
+	static float get() { return 1.0e-4f; }
+};
+
+template<> struct pdist_tol<double>
+{
+	static double get() { return 1.0e-12; }
+};
+
+
+template<typename T>
+T safe_dist(index_t d, const T *x, const T *y, metrics::sqL2_)
+{
+	double s = 0;
+	for (index_t k = 0; k < d; ++k) s += math::sqr(double(x[k]) - double(y[k]));
+	return T(s);
+}
+
+template<typename T>
+T safe_dist(index_t d, const T *x, const T *y, metrics::L2_)
+{
+	return math::sqrt(safe_dist(d, x, y, metrics::sqL2_()));
+}
+
+template<typename T>
+T safe_dist(index_t d, const T *x, const T *y, metrics::cosine_)
+{
+	double sxy = 0, sxx = 0, syy = 0;
+	for (index_t k = 0; k < d; ++k)
+	{
+		sxy += double(x[k]) * double(y[k]);
+		sxx += double(x[k]) * double(x[k]);
+		syy += double(y[k]) * double(y[k]);
+	}
+	if (sxx == 0 || syy == 0) return T(1);
+	return T(1.0 - sxy / std::sqrt(sxx * syy));
+}
+
+template<typename T>
+T safe_dist(index_t d, const T *x, const T *y, metrics::L1_)
+{
+	double s = 0;
+	for (index_t k = 0; k < d; ++k) s += std::fabs(double(x[k]) - double(y[k]));
+	return T(s);
+}
+
+template<typename T>
+T safe_dist(index_t d, const T *x, const T *y, metrics::Linf_)
+{
+	double s = 0;
+	for (index_t k = 0; k < d; ++k) s = math::max(s, std::fabs(double(x[k]) - double(y[k])));
+	return T(s);
+}
+
+
+template<typename T, class Metric>
+void test_pdist(index_t d, index_t m, index_t n)
+{
+	dense_matrix<T> x(d, m);
+	dense_matrix<T> y(d, n);
+	for (index_t i = 0; i < x.nelems(); ++i) x[i] = randunif<T>(T(-1), T(1));
+	for (index_t i = 0; i < y.nelems(); ++i) y[i] = randunif<T>(T(-1), T(1));
+
+	T tol = pdist_tol<T>::get();
+
+	// two sets
+
+	dense_matrix<T> r(m, n);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < m; ++i)
+			r(i, j) = safe_dist(d, x.ptr_data() + i * d, y.ptr_data() + j * d, Metric());
+
+	dense_matrix<T> dm(m, n, zero());
+	pairwise_distance(x, y, dm, Metric());
+	ASSERT_MAT_APPROX(m, n, dm, r, tol);
+
+	// single set
+
+	dense_matrix<T> rs(m, m);
+	for (index_t j = 0; j < m; ++j)
+		for (index_t i = 0; i < m; ++i)
+			rs(i, j) = i == j ? T(0) : safe_dist(d, x.ptr_data() + i * d, x.ptr_data() + j * d, Metric());
+
+	dense_matrix<T> ds(m, m, zero());
+	pairwise_distance(x, ds, Metric());
+	ASSERT_MAT_APPROX(m, m, ds, rs, tol);
+}
+
+template<typename T, class Metric>
+void test_pdist_all()
+{
+	test_pdist<T, Metric>(1, 3, 2);
+	test_pdist<T, Metric>(5, 7, 9);
+	test_pdist<T, Metric>(19, 13, 1);
+
+	// multiple tiles on both dimensions
+	test_pdist<T, Metric>(11, internal::pdist_tile_m * 2 + 5, internal::pdist_tile_n + 3);
+}
+
+
+template<typename T>
+void test_pdist_cosine_zero()
+{
+	const index_t d = 6, m = 5, n = 4;
+
+	dense_matrix<T> x(d, m);
+	dense_matrix<T> y(d, n);
+	for (index_t i = 0; i < x.nelems(); ++i) x[i] = randunif<T>(T(-1), T(1));
+	for (index_t i = 0; i < y.nelems(); ++i) y[i] = randunif<T>(T(-1), T(1));
+
+	for (index_t k = 0; k < d; ++k) { x(k, 2) = T(0); y(k, 1) = T(0); }
+
+	T tol = pdist_tol<T>::get();
+
+	dense_matrix<T> dm(m, n, zero());
+	pairwise_distance(x, y, dm, metrics::cosine_());
+
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < m; ++i)
+			ASSERT_APPROX( dm(i, j), safe_dist(d, x.ptr_data() + i * d, y.ptr_data() + j * d, metrics::cosine_()), tol );
+
+	ASSERT_EQ( dm(2, 0), T(1) );
+	ASSERT_EQ( dm(0, 1), T(1) );
+
+	dense_matrix<T> ds(m, m, zero());
+	pairwise_distance(x, ds, metrics::cosine_());
+
+	for (index_t i = 0; i < m; ++i)
+	{
+		if (i != 2)
+		{
+			ASSERT_EQ( ds(i, 2), T(1) );
+			ASSERT_EQ( ds(2, i), T(1) );
+		}
+	}
+	ASSERT_EQ( ds(2, 2), T(1) );  // as in the two-set version
+	ASSERT_EQ( ds(0, 0), T(0) );
+
+	dense_matrix<T> dx(m, m, zero());
+	pairwise_distance(x, x, dx, metrics::cosine_());
+	ASSERT_EQ( dx(2, 2), T(1) );
+}
+
+SIMPLE_CASE( pdist_cosine_zero_f32 ) { test_pdist_cosine_zero<float>(); }
+SIMPLE_CASE( pdist_cosine_zero_f64 ) { test_pdist_cosine_zero<double>(); }
+
+
+#define DEF_PDIST_CASES( Name, Metric ) \
+	SIMPLE_CASE( pdist_##Name##_f32 ) { test_pdist_all<float, metrics::Metric>(); } \
+	SIMPLE_CASE( pdist_##Name##_f64 ) { test_pdist_all<double, metrics::Metric>(); } \
+	AUTO_TPACK( pdist_##Name ) { \
+		ADD_SIMPLE_CASE( pdist_##Name##_f32 ) \
+		ADD_SIMPLE_CASE( pdist_##Name##_f64 ) \
+	}
+
+DEF_PDIST_CASES( sqL2, sqL2_ )
+DEF_PDIST_CASES( L2, L2_ )
+DEF_PDIST_CASES( cosine, cosine_ )
+DEF_PDIST_CASES( L1, L1_ )
+DEF_PDIST_CASES( Linf, Linf_ )
+
+AUTO_TPACK( pdist_cosine_zero )
+{
+	ADD_SIMPLE_CASE( pdist_cosine_zero_f32 )
+	ADD_SIMPLE_CASE( pdist_cosine_zero_f64 )
+}
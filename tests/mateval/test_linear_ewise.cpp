@@ -146,7 +146,7 @@ void test_linear_ewise_single_cont()
 
 
 
-template<typename U>
+template<typename U, typename S=auto_store_>
 void test_linear_ewise_varysize()
 {
 	const index_t max_len = 64;
@@ -170,7 +170,7 @@ void test_linear_ewise_varysize()
 		for (index_t i = 0; i < len; ++i)
 			r[i] = math::sqr(s[i]);
 
-		ewise(kernel).eval(macc_<linear_, U>(), len, 1, out_(d), in_(s));
+		ewise(kernel).eval(macc_<linear_, U, S>(), len, 1, out_(d), in_(s));
 		ASSERT_VEC_EQ( len, d, r );
 	}
 }
@@ -259,11 +259,21 @@ SIMPLE_CASE( linear_ewise_varysize_sse )
 	test_linear_ewise_varysize<simd_<sse_t> >();
 }
 
+SIMPLE_CASE( linear_ewise_varysize_sse_stream )
+{
+	test_linear_ewise_varysize<simd_<sse_t>, stream_store_>();
+}
+
 #ifdef LMAT_HAS_AVX
 SIMPLE_CASE( linear_ewise_varysize_avx )
 {
 	test_linear_ewise_varysize<simd_<avx_t> >();
 }
+
+SIMPLE_CASE( linear_ewise_varysize_avx_stream )
+{
+	test_linear_ewise_varysize<simd_<avx_t>, stream_store_>();
+}
 #endif
 
 
@@ -345,8 +355,10 @@ AUTO_TPACK( linear_ewise_varysize )
 {
 	ADD_SIMPLE_CASE( linear_ewise_varysize_scalar )
 	ADD_SIMPLE_CASE( linear_ewise_varysize_sse )
+	ADD_SIMPLE_CASE( linear_ewise_varysize_sse_stream )
 #ifdef LMAT_HAS_AVX
 	ADD_SIMPLE_CASE( linear_ewise_varysize_avx )
+	ADD_SIMPLE_CASE( linear_ewise_varysize_avx_stream )
 #endif
 }
 
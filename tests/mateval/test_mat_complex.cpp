@@ -0,0 +1,273 @@
+/**
+ * @file test_mat_complex.cpp
+ *
+ * @brief Unit testing for complex-valued matrices
+ *
+ * @author Dahua Lin
+ */
+
+#include "../test_base.h"
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/matrix/ref_matrix_rm.h>
+#include <light_mat/matexpr/mat_arith.h>
+#include <light_mat/mateval/mat_reduce.h>
+#include <light_mat/mateval/mat_complex.h>
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace lmat;
+using namespace lmat::test;
+
+const index_t DM = 13;
+const index_t DN = 6;
+
+template<typename T> struct ctol;
+template<> struct ctol<float>  { static double get() { return 1.0e-5; } };
+template<> struct ctol<double> { static double get() { return 1.0e-13; } };
+
+template<typename T>
+inline std::complex<T> crand()
+{
+	return std::complex<T>(
+			T(std::rand() % 2001 - 1000) / T(250),
+			T(std::rand() % 2001 - 1000) / T(250));
+}
+
+template<typename T, class Mat>
+void fill_crand(IRegularMatrix<Mat, std::complex<T> >& a)
+{
+	for (index_t j = 0; j < a.ncolumns(); ++j)
+		for (index_t i = 0; i < a.nrows(); ++i) a(i, j) = crand<T>();
+}
+
+template<typename T>
+inline bool capprox(const std::complex<T>& a, const std::complex<T>& b, double tol)
+{
+	return std::abs(std::complex<double>(a) - std::complex<double>(b)) <= tol * (1.0 + std::abs(b));
+}
+
+
+T_CASE( complex_simd_policy )
+{
+	typedef std::complex<T> C;
+	typedef default_simd_kind K;
+
+	ASSERT_TRUE( (supports_simd<dense_matrix<C>, K>::value) );
+	ASSERT_TRUE( (is_simdizable<add_fun<C>, K>::value) );
+	ASSERT_TRUE( (is_simdizable<mul_fun<C>, K>::value) );
+	ASSERT_TRUE( (is_simdizable<div_fun<C>, K>::value) );
+	ASSERT_TRUE( (is_simdizable<conj_fun<C>, K>::value) );
+	ASSERT_TRUE( (is_simdizable<sum_kernel<C>, K>::value) );
+	ASSERT_TRUE( (is_simdizable<dot_kernel<C>, K>::value) );
+	ASSERT_FALSE( (is_simdizable<max_fun<C>, K>::value) );
+}
+
+template<typename T, class A, class B>
+void verify_complex_ewise(const IRegularMatrix<A, std::complex<T> >& a, const IRegularMatrix<B, std::complex<T> >& b)
+{
+	typedef std::complex<T> C;
+	const double tol = ctol<T>::get();
+	const index_t m = a.nrows();
+	const index_t n = a.ncolumns();
+	const C c(T(1.5), T(-0.5));
+
+	dense_matrix<C> r0 = a + b;
+	dense_matrix<C> r1 = a - b;
+	dense_matrix<C> r2 = a * b;
+	dense_matrix<C> r3 = a / b;
+	dense_matrix<C> r4 = -a;
+	dense_matrix<C> r5 = conj(a);
+	dense_matrix<C> r6 = a * c + b;
+
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i)
+		{
+			const C x = a.elem(i, j);
+			const C y = b.elem(i, j);
+
+			ASSERT_TRUE( r0(i, j) == x + y );
+			ASSERT_TRUE( r1(i, j) == x - y );
+			ASSERT_TRUE( capprox(r2(i, j), x * y, tol) );
+			ASSERT_TRUE( capprox(r3(i, j), x / y, tol) );
+			ASSERT_TRUE( r4(i, j) == -x );
+			ASSERT_TRUE( r5(i, j) == std::conj(x) );
+			ASSERT_TRUE( capprox(r6(i, j), x * c + y, tol) );
+		}
+	}
+}
+
+T_CASE( complex_ewise )
+{
+	typedef std::complex<T> C;
+
+	dense_matrix<C> a(DM, DN), b(DM, DN);
+	fill_crand(a);
+	fill_crand(b);
+	verify_complex_ewise(a, b);
+
+	// even number of rows: whole packs per column
+
+	dense_matrix<C> a2(8, 3), b2(8, 3);
+	fill_crand(a2);
+	fill_crand(b2);
+	verify_complex_ewise(a2, b2);
+
+	// strided operands
+
+	dense_matrix<C> sa(DN, DM), sb(DN, DM);
+	fill_crand(sa);
+	fill_crand(sb);
+	verify_complex_ewise(ref_matrix_rm<C>(sa.ptr_data(), DM, DN), ref_matrix_rm<C>(sb.ptr_data(), DM, DN));
+}
+
+T_CASE( complex_reduce )
+{
+	typedef std::complex<T> C;
+	const double tol = ctol<T>::get() * 10;
+
+	dense_matrix<C> a(DM, DN), b(DM, DN);
+	fill_crand(a);
+	fill_crand(b);
+
+	C s0(0), d0(0);
+	for (index_t i = 0; i < DM * DN; ++i)
+	{
+		s0 += a[i];
+		d0 += a[i] * b[i];
+	}
+
+	ASSERT_TRUE( capprox(sum(a), s0, tol) );
+	ASSERT_TRUE( capprox(dot(a, b), d0, tol) );
+
+	dense_row<C> cs(DN);
+	colwise_sum(a, cs);
+	for (index_t j = 0; j < DN; ++j)
+	{
+		C sj(0);
+		for (index_t i = 0; i < DM; ++i) sj += a(i, j);
+		ASSERT_TRUE( capprox(cs[j], sj, tol) );
+	}
+
+	dense_col<C> e(0);
+	ASSERT_TRUE( sum(e) == C(0) );
+}
+
+template<typename T, class A>
+void verify_complex_parts(const IRegularMatrix<A, std::complex<T> >& a)
+{
+	const double tol = ctol<T>::get();
+	const index_t m = a.nrows();
+	const index_t n = a.ncolumns();
+
+	dense_matrix<T> re(m, n), im(m, n), ab(m, n), nr(m, n), ag(m, n);
+	real(a, re);
+	imag(a, im);
+	abs(a, ab);
+	norm(a, nr);
+	arg(a, ag);
+
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i)
+		{
+			const std::complex<T> z = a.elem(i, j);
+			ASSERT_EQ( re(i, j), z.real() );
+			ASSERT_EQ( im(i, j), z.imag() );
+			ASSERT_APPROX( ab(i, j), std::abs(z), tol * (1.0 + std::abs(z)) );
+			ASSERT_APPROX( nr(i, j), std::norm(z), tol * (1.0 + std::norm(z)) );
+			ASSERT_EQ( ag(i, j), std::arg(z) );
+		}
+	}
+}
+
+T_CASE( complex_parts )
+{
+	typedef std::complex<T> C;
+
+	dense_matrix<C> a(DM, DN);
+	fill_crand(a);
+	verify_complex_parts(a);
+
+	dense_matrix<C> b(DM + 3, DN + 1);
+	fill_crand(b);
+	verify_complex_parts(cref_block<C>(b.ptr_data() + 1, DM, DN, DM + 3));
+
+	// row-major, and rows of column-major matrices
+
+	verify_complex_parts(ref_matrix_rm<C>(b.ptr_data(), DN, DM));
+	verify_complex_parts(b.row(2));
+
+	dense_matrix<T> bad(DM, DN + 1);
+	bool thrown = false;
+	try { real(a, bad); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+}
+
+// values whose squared modulus overflows or underflows T, which must
+// give the same abs and quotients in pack lanes as in the scalar tail
+
+template<typename T> struct cextreme;
+template<> struct cextreme<float>
+{
+	static float big() { return 1.0e19f; }
+	static float tiny() { return 1.0e-25f; }
+};
+template<> struct cextreme<double>
+{
+	static double big() { return 1.0e160; }
+	static double tiny() { return 1.0e-170; }
+};
+
+T_CASE( complex_extreme )
+{
+	typedef std::complex<T> C;
+	const double tol = ctol<T>::get();
+	const index_t n = 9;  // whole packs and a tail
+	const T big = cextreme<T>::big();
+	const T tiny = cextreme<T>::tiny();
+
+	dense_col<C> a(n), b(n), c(n), d(n);
+	dense_col<T> ab(n);
+	for (index_t i = 0; i < n; ++i)
+	{
+		a[i] = C(T(3) * big, T(4) * big);
+		b[i] = C(tiny, tiny);
+		c[i] = C(T(1 + i % 3) * big, T(2) * big);
+		d[i] = C(T(2) * tiny, T(1 + i % 2) * tiny);
+	}
+
+	abs(a, ab);
+	for (index_t i = 0; i < n; ++i) ASSERT_APPROX( ab[i], std::abs(a[i]), tol * std::abs(a[i]) );
+
+	abs(b, ab);
+	for (index_t i = 0; i < n; ++i) ASSERT_APPROX( ab[i], std::abs(b[i]), tol * std::abs(b[i]) );
+
+	dense_col<C> q1 = c / a;
+	dense_col<C> q2 = b / d;
+	for (index_t i = 0; i < n; ++i)
+	{
+		ASSERT_TRUE( capprox(q1[i], c[i] / a[i], tol) );
+		ASSERT_TRUE( capprox(q2[i], b[i] / d[i], tol) );
+	}
+}
+
+
+AUTO_TPACK( mat_complex_ewise )
+{
+	ADD_T_CASE_FP( complex_simd_policy )
+	ADD_T_CASE_FP( complex_ewise )
+	ADD_T_CASE_FP( complex_extreme )
+}
+
+AUTO_TPACK( mat_complex_reduce )
+{
+	ADD_T_CASE_FP( complex_reduce )
+}
+
+AUTO_TPACK( mat_complex_parts )
+{
+	ADD_T_CASE_FP( complex_parts )
+}
@@ -0,0 +1,326 @@
+/**
+ * @file test_mat_hist.cpp
+ *
+ * @brief Unit testing for bincount, histogram and accumarray
+ *
+ * @author Dahua Lin
+ */
+
+#include "../test_base.h"
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/matrix/ref_matrix_rm.h>
+#include <light_mat/mateval/matrix_hist.h>
+
+#include <cstdlib>
+#include <vector>
+
+using namespace lmat;
+using namespace lmat::test;
+
+const index_t LongLen = 200003;  // long enough to be split over threads
+const index_t DM = 257;
+const index_t DN = 6;
+
+
+// labels in [-1, K + 1), to include some out of range
+
+template<typename TI>
+void fill_labels(TI *p, index_t n, index_t K)
+{
+	for (index_t i = 0; i < n; ++i)
+		p[i] = TI(std::rand() % (K + 2)) - TI(1);
+}
+
+template<typename T>
+void fill_values(T *p, index_t n)
+{
+	for (index_t i = 0; i < n; ++i)
+		p[i] = T(std::rand() % 2001 - 1000) / T(100);
+}
+
+template<typename TI>
+std::vector<index_t> ref_bincount(const TI *p, index_t n, index_t K)
+{
+	std::vector<index_t> c(K, 0);
+	for (index_t i = 0; i < n; ++i)
+		if (p[i] >= 0 && p[i] < K) ++ c[p[i]];
+	return c;
+}
+
+template<typename T>
+std::vector<index_t> ref_histogram(const T *p, index_t n, const std::vector<T>& e)
+{
+	const index_t K = (index_t)e.size() - 1;
+	std::vector<index_t> c(K, 0);
+	for (index_t i = 0; i < n; ++i)
+	{
+		for (index_t k = 0; k < K; ++k)
+		{
+			if (p[i] >= e[k] && (p[i] < e[k + 1] || (k == K - 1 && p[i] == e[K])))
+			{
+				++ c[k];
+				break;
+			}
+		}
+	}
+	return c;
+}
+
+
+template<typename TI>
+void test_bincount(index_t len, index_t K)
+{
+	dense_col<TI> labels(len);
+	fill_labels(labels.ptr_data(), len, K);
+
+	dense_col<index_t> c(K);
+	bincount(labels, c);
+
+	std::vector<index_t> r = ref_bincount(labels.ptr_data(), len, K);
+	ASSERT_VEC_EQ( K, c, r );
+}
+
+SIMPLE_CASE( bincount_small )   // compared a pack at a time
+{
+	test_bincount<int32_t>(LongLen, 1);
+	test_bincount<int32_t>(LongLen, 5);
+	test_bincount<int32_t>(LongLen, 8);
+	test_bincount<int32_t>(11, 3);
+}
+
+SIMPLE_CASE( bincount_replicated )
+{
+	test_bincount<int32_t>(LongLen, 9);
+	test_bincount<int32_t>(LongLen, 1000);
+	test_bincount<int64_t>(LongLen, 100);
+}
+
+SIMPLE_CASE( bincount_large )
+{
+	test_bincount<int32_t>(LongLen, 10000);
+	test_bincount<int32_t>(1000, 5000);
+}
+
+SIMPLE_CASE( bincount_views )
+{
+	const index_t K = 7;
+
+	// a row view is a strided vector
+
+	dense_matrix<int32_t> a(DM, DN);
+	fill_labels(a.ptr_data(), DM * DN, K);
+
+	ref_matrix_rm<int32_t> art(a.ptr_data(), DN, DM);
+	dense_col<double> c(K);
+	bincount(art, c);
+
+	std::vector<index_t> r = ref_bincount(a.ptr_data(), DM * DN, K);
+	for (index_t k = 0; k < K; ++k) ASSERT_EQ( c[k], double(r[k]) );
+
+	// colwise
+
+	dense_matrix<int32_t> cc(K, DN);
+	colwise_bincount(a, cc);
+	for (index_t j = 0; j < DN; ++j)
+	{
+		std::vector<index_t> rj = ref_bincount(a.ptr_col(j), DM, K);
+		for (index_t k = 0; k < K; ++k) ASSERT_EQ( cc(k, j), (int32_t)rj[k] );
+	}
+}
+
+SIMPLE_CASE( histogram_edges )
+{
+	dense_col<double> x(LongLen);
+	fill_values(x.ptr_data(), LongLen);
+	x[0] = -8.0;    // on an edge
+	x[1] = 8.0;     // the last edge
+	x[2] = 8.0001;  // beyond
+
+	// uniform edges
+
+	const index_t K = 16;
+	dense_col<double> e(K + 1);
+	for (index_t k = 0; k <= K; ++k) e[k] = -8.0 + double(k);
+
+	std::vector<double> ev(e.ptr_data(), e.ptr_data() + K + 1);
+	dense_col<index_t> c(K);
+	histogram(x, e, c);
+	ASSERT_VEC_EQ( K, c, ref_histogram(x.ptr_data(), LongLen, ev) );
+
+	// non-uniform edges
+
+	const double ne[6] = {-5.0, -1.0, 0.0, 0.25, 3.0, 9.0};
+	dense_col<double> e2(6, copy_from(ne));
+	std::vector<double> ev2(ne, ne + 6);
+
+	dense_col<index_t> c2(5);
+	histogram(x, e2, c2);
+	ASSERT_VEC_EQ( 5, c2, ref_histogram(x.ptr_data(), LongLen, ev2) );
+
+	// colwise
+
+	dense_matrix<double> a(DM, DN);
+	fill_values(a.ptr_data(), DM * DN);
+	dense_matrix<index_t> cc(5, DN);
+	colwise_histogram(a, e2, cc);
+	for (index_t j = 0; j < DN; ++j)
+	{
+		std::vector<index_t> rj = ref_histogram(a.ptr_col(j), DM, ev2);
+		for (index_t k = 0; k < 5; ++k) ASSERT_EQ( cc(k, j), rj[k] );
+	}
+
+	// edges must increase
+
+	dense_col<double> bad(3);
+	bad[0] = 0.0; bad[1] = 1.0; bad[2] = 1.0;
+	dense_col<index_t> cb(2);
+
+	bool thrown = false;
+	try { histogram(x, bad, cb); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+}
+
+SIMPLE_CASE( histogram_uniform )
+{
+	dense_col<float> x(LongLen);
+	fill_values(x.ptr_data(), LongLen);
+	x[0] = 2.5f;
+
+	const index_t K = 10;
+	dense_col<int32_t> c(K);
+	histogram(x, -5.0f, 2.5f, c);
+
+	std::vector<int32_t> r(K, 0);
+	for (index_t i = 0; i < LongLen; ++i)
+	{
+		const float v = x[i];
+		if (v >= -5.0f && v <= 2.5f)
+		{
+			index_t k = (index_t)((v + 5.0f) * (float(K) / 7.5f));
+			++ r[k < K ? k : K - 1];
+		}
+	}
+	ASSERT_VEC_EQ( K, c, r );
+
+	dense_matrix<float> a(DM, DN);
+	fill_values(a.ptr_data(), DM * DN);
+	dense_matrix<int32_t> cc(K, DN);
+	colwise_histogram(a, -5.0f, 2.5f, cc);
+
+	index_t total = 0;
+	for (index_t i = 0; i < K * DN; ++i) total += cc[i];
+	index_t inside = 0;
+	for (index_t i = 0; i < DM * DN; ++i) if (a[i] >= -5.0f && a[i] <= 2.5f) ++inside;
+	ASSERT_EQ( total, inside );
+}
+
+
+template<class Op>
+double ref_accum(const std::vector<double>& vs, Op);
+
+double ref_accum(const std::vector<double>& vs, accum::sum_)
+{
+	double s = 0;
+	for (size_t i = 0; i < vs.size(); ++i) s += vs[i];
+	return s;
+}
+
+double ref_accum(const std::vector<double>& vs, accum::mean_)
+{
+	return vs.empty() ? 0.0 : ref_accum(vs, accum::sum_()) / double(vs.size());
+}
+
+double ref_accum(const std::vector<double>& vs, accum::min_)
+{
+	double r = vs.empty() ? 0.0 : vs[0];
+	for (size_t i = 1; i < vs.size(); ++i) if (vs[i] < r) r = vs[i];
+	return r;
+}
+
+double ref_accum(const std::vector<double>& vs, accum::max_)
+{
+	double r = vs.empty() ? 0.0 : vs[0];
+	for (size_t i = 1; i < vs.size(); ++i) if (vs[i] > r) r = vs[i];
+	return r;
+}
+
+template<class Op>
+void test_accumarray(index_t len, index_t K, Op op)
+{
+	dense_col<int32_t> labels(len);
+	dense_col<double> values(len);
+	fill_labels(labels.ptr_data(), len, K);
+	fill_values(values.ptr_data(), len);
+
+	dense_col<double> r(K);
+	accumarray(labels, values, r, op);
+
+	std::vector<std::vector<double> > groups(K);
+	for (index_t i = 0; i < len; ++i)
+		if (labels[i] >= 0 && labels[i] < K) groups[labels[i]].push_back(values[i]);
+
+	for (index_t k = 0; k < K; ++k)
+		ASSERT_APPROX( r[k], ref_accum(groups[k], op), 1.0e-9 );
+
+	// colwise: rows of values grouped by labels
+
+	const index_t m = std::min(len, DM);
+	dense_matrix<double> a(m, DN);
+	fill_values(a.ptr_data(), m * DN);
+
+	dense_matrix<double> ra(K, DN);
+	colwise_accumarray(labels(range(0, m), 0), a, ra, op);
+
+	for (index_t j = 0; j < DN; ++j)
+	{
+		std::vector<std::vector<double> > gj(K);
+		for (index_t i = 0; i < m; ++i)
+			if (labels[i] >= 0 && labels[i] < K) gj[labels[i]].push_back(a(i, j));
+
+		for (index_t k = 0; k < K; ++k)
+			ASSERT_APPROX( ra(k, j), ref_accum(gj[k], op), 1.0e-9 );
+	}
+}
+
+SIMPLE_CASE( accumarray_sum )
+{
+	test_accumarray(LongLen, 20, accum::sum_());
+	test_accumarray(100, 200, accum::sum_());   // with empty bins
+}
+
+SIMPLE_CASE( accumarray_mean )
+{
+	test_accumarray(LongLen, 20, accum::mean_());
+	test_accumarray(100, 200, accum::mean_());
+}
+
+SIMPLE_CASE( accumarray_minmax )
+{
+	test_accumarray(LongLen, 20, accum::min_());
+	test_accumarray(LongLen, 20, accum::max_());
+	test_accumarray(100, 200, accum::min_());
+	test_accumarray(100, 200, accum::max_());
+}
+
+
+AUTO_TPACK( mat_bincount )
+{
+	ADD_SIMPLE_CASE( bincount_small )
+	ADD_SIMPLE_CASE( bincount_replicated )
+	ADD_SIMPLE_CASE( bincount_large )
+	ADD_SIMPLE_CASE( bincount_views )
+}
+
+AUTO_TPACK( mat_histogram )
+{
+	ADD_SIMPLE_CASE( histogram_edges )
+	ADD_SIMPLE_CASE( histogram_uniform )
+}
+
+AUTO_TPACK( mat_accumarray )
+{
+	ADD_SIMPLE_CASE( accumarray_sum )
+	ADD_SIMPLE_CASE( accumarray_mean )
+	ADD_SIMPLE_CASE( accumarray_minmax )
+}
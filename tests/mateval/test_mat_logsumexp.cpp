@@ -0,0 +1,285 @@
+/**
+ * @file test_mat_logsumexp.cpp
+ *
+ * @brief Unit testing for logsumexp and softmax
+ *
+ * @author Dahua Lin
+ */
+
+#include "../test_base.h"
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/matrix/ref_matrix_rm.h>
+#include <light_mat/mateval/mat_logsumexp.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+using namespace lmat;
+using namespace lmat::test;
+
+const index_t LongLen = 100003;  // long enough to be split over threads
+const index_t DM = 37;
+const index_t DN = 13;
+
+
+template<typename T> struct lse_tol;
+template<> struct lse_tol<float> { static double get() { return 2.0e-5; } };
+template<> struct lse_tol<double> { static double get() { return 1.0e-12; } };
+
+// values over a wide range, with increasing maxima along the way,
+// so that the running sums get rescaled
+
+template<typename T>
+void fill_lse_values(T *p, index_t n)
+{
+	for (index_t i = 0; i < n; ++i)
+		p[i] = T(std::rand() % 20001 - 15000) / T(100) + T(i % 97) * T(0.5);
+}
+
+template<typename T>
+double ref_lse(const std::vector<T>& v)
+{
+	double m = -std::numeric_limits<double>::infinity();
+	for (size_t i = 0; i < v.size(); ++i) if (double(v[i]) > m) m = double(v[i]);
+	if (std::isinf(m)) return m;
+
+	double s = 0;
+	for (size_t i = 0; i < v.size(); ++i) s += std::exp(double(v[i]) - m);
+	return m + std::log(s);
+}
+
+template<typename T, class Mat>
+std::vector<T> col_of(const IRegularMatrix<Mat, T>& a, index_t j)
+{
+	std::vector<T> v((size_t)a.nrows());
+	for (index_t i = 0; i < a.nrows(); ++i) v[i] = a.elem(i, j);
+	return v;
+}
+
+template<typename T, class Mat>
+std::vector<T> row_of(const IRegularMatrix<Mat, T>& a, index_t i)
+{
+	std::vector<T> v((size_t)a.ncolumns());
+	for (index_t j = 0; j < a.ncolumns(); ++j) v[j] = a.elem(i, j);
+	return v;
+}
+
+template<typename T, class Mat>
+void verify_lse(const IRegularMatrix<Mat, T>& a)
+{
+	const double tol = lse_tol<T>::get();
+	const index_t m = a.nrows();
+	const index_t n = a.ncolumns();
+
+	std::vector<T> all;
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < m; ++i) all.push_back(a.elem(i, j));
+
+	const double r = ref_lse(all);
+	ASSERT_APPROX( logsumexp(a), r, tol * (1.0 + std::fabs(r)) );
+
+	dense_row<T> cr(n);
+	colwise_logsumexp(a, cr);
+	for (index_t j = 0; j < n; ++j)
+	{
+		const double rj = ref_lse(col_of(a, j));
+		ASSERT_APPROX( cr[j], rj, tol * (1.0 + std::fabs(rj)) );
+	}
+
+	dense_col<T> rr(m);
+	rowwise_logsumexp(a, rr);
+	for (index_t i = 0; i < m; ++i)
+	{
+		const double ri = ref_lse(row_of(a, i));
+		ASSERT_APPROX( rr[i], ri, tol * (1.0 + std::fabs(ri)) );
+	}
+}
+
+
+T_CASE( lse_exp_accuracy )
+{
+	typedef simd_pack<T, default_simd_kind> pack_t;
+	const index_t w = (index_t)simd_traits<T, default_simd_kind>::pack_width;
+
+	T x[8], r[8];
+	for (int k = -30000; k < 200; k += (int)w)
+	{
+		for (index_t l = 0; l < w; ++l) x[l] = T(k + l) / T(37);
+		internal::lse_exp(pack_t(x)).store_u(r);
+
+		for (index_t l = 0; l < w; ++l)
+		{
+			const double e = std::exp(double(x[l]));
+			if (e >= double(std::numeric_limits<T>::min()) * 2)
+				ASSERT_APPROX( r[l] / e, 1.0, lse_tol<T>::get() * 0.1 );
+		}
+	}
+
+	x[0] = -std::numeric_limits<T>::infinity();
+	for (index_t l = 1; l < w; ++l) x[l] = T(-1000);
+	internal::lse_exp(pack_t(x)).store_u(r);
+	for (index_t l = 0; l < w; ++l) ASSERT_EQ( r[l], T(0) );
+}
+
+T_CASE( lse_dense )
+{
+	dense_matrix<T> a(DM, DN);
+	fill_lse_values(a.ptr_data(), DM * DN);
+	verify_lse(a);
+
+	dense_matrix<T> b(3, 2);  // shorter than a pack
+	fill_lse_values(b.ptr_data(), 6);
+	verify_lse(b);
+
+	dense_matrix<T> c(1000, 40);  // rows in parallel
+	fill_lse_values(c.ptr_data(), 40000);
+	verify_lse(c);
+}
+
+T_CASE( lse_views )
+{
+	// row-major: colwise runs across adjacent columns
+
+	dense_matrix<T> s(DN, DM);
+	fill_lse_values(s.ptr_data(), DM * DN);
+	verify_lse(ref_matrix_rm<T>(s.ptr_data(), DM, DN));
+
+	dense_matrix<T> b(DM + 4, DN + 1);
+	fill_lse_values(b.ptr_data(), b.nelems());
+	verify_lse(cref_block<T>(b.ptr_data() + 3, DM, DN, DM + 4));
+
+	// a row of a column-major matrix
+
+	verify_lse(b.row(5));
+}
+
+T_CASE( lse_long )
+{
+	dense_col<T> a(LongLen);
+	fill_lse_values(a.ptr_data(), LongLen);
+	verify_lse(a);
+}
+
+T_CASE( lse_infinities )
+{
+	const T inf = std::numeric_limits<T>::infinity();
+
+	dense_matrix<T> a(DM, 4);
+	fill_lse_values(a.ptr_data(), DM * 4);
+
+	for (index_t i = 0; i < DM; ++i) a(i, 1) = -inf;  // all -inf
+	a(3, 2) = -inf;                                   // some -inf
+	a(5, 3) = inf;
+
+	dense_row<T> r(4);
+	colwise_logsumexp(a, r);
+
+	ASSERT_EQ( r[1], -inf );
+	ASSERT_APPROX( r[2], ref_lse(col_of(a, 2)), lse_tol<T>::get() * 100.0 );
+	ASSERT_EQ( r[3], inf );
+
+	ASSERT_EQ( logsumexp(a), inf );
+
+	dense_col<T> e(0);
+	ASSERT_EQ( logsumexp(e), -inf );
+
+	dense_row<T> bad(3);
+	bool thrown = false;
+	try { colwise_logsumexp(a, bad); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+}
+
+T_CASE( lse_nan )
+{
+	const T nan = std::numeric_limits<T>::quiet_NaN();
+	const T inf = std::numeric_limits<T>::infinity();
+
+	// NaN at an interior position of a pack (not in the scalar tail)
+
+	dense_matrix<T> a(DM, 4);
+	fill_lse_values(a.ptr_data(), DM * 4);
+	a(1, 0) = nan;
+	a(2, 2) = nan;
+	a(3, 2) = inf;
+
+	dense_row<T> r(4);
+	colwise_logsumexp(a, r);
+
+	ASSERT_TRUE( r[0] != r[0] );
+	const double r1 = ref_lse(col_of(a, 1));
+	ASSERT_APPROX( r[1], r1, lse_tol<T>::get() * (1.0 + std::fabs(r1)) );
+	ASSERT_TRUE( r[2] != r[2] );
+	ASSERT_TRUE( logsumexp(a) != logsumexp(a) );
+
+	// across the columns, with the NaN in an interior lane
+
+	dense_col<T> rr(DM);
+	rowwise_logsumexp(a, rr);
+
+	ASSERT_TRUE( rr[1] != rr[1] );
+	ASSERT_TRUE( rr[2] != rr[2] );
+	ASSERT_EQ( rr[3], inf );
+	const double r0 = ref_lse(row_of(a, 0));
+	ASSERT_APPROX( rr[0], r0, lse_tol<T>::get() * (1.0 + std::fabs(r0)) );
+
+	dense_col<T> c(LongLen);
+	fill_lse_values(c.ptr_data(), LongLen);
+	c[LongLen / 2 + 1] = nan;
+	ASSERT_TRUE( logsumexp(c) != logsumexp(c) );
+}
+
+T_CASE( softmax )
+{
+	const double tol = lse_tol<T>::get();
+
+	dense_matrix<T> a(DM, DN);
+	fill_lse_values(a.ptr_data(), DM * DN);
+	a(0, 0) = -std::numeric_limits<T>::infinity();
+
+	dense_matrix<T> b(a);
+	colwise_softmax(b);
+
+	for (index_t j = 0; j < DN; ++j)
+	{
+		const double l = ref_lse(col_of(a, j));
+		double s = 0;
+		for (index_t i = 0; i < DM; ++i)
+		{
+			ASSERT_APPROX( b(i, j), std::exp(double(a(i, j)) - l), tol );
+			s += b(i, j);
+		}
+		ASSERT_APPROX( s, 1.0, tol * 10.0 );
+	}
+
+	ASSERT_EQ( b(0, 0), T(0) );
+
+	// strided columns
+
+	dense_matrix<T> c(DN, DM);
+	ref_matrix_rm<T> ct(c.ptr_data(), DM, DN);
+	for (index_t j = 0; j < DN; ++j)
+		for (index_t i = 0; i < DM; ++i) ct(i, j) = a(i, j);
+
+	colwise_softmax(ct);
+	for (index_t j = 0; j < DN; ++j)
+		for (index_t i = 0; i < DM; ++i) ASSERT_APPROX( ct(i, j), b(i, j), tol );
+}
+
+
+AUTO_TPACK( mat_logsumexp )
+{
+	ADD_T_CASE_FP( lse_exp_accuracy )
+	ADD_T_CASE_FP( lse_dense )
+	ADD_T_CASE_FP( lse_views )
+	ADD_T_CASE_FP( lse_long )
+	ADD_T_CASE_FP( lse_infinities )
+	ADD_T_CASE_FP( lse_nan )
+}
+
+AUTO_TPACK( mat_softmax )
+{
+	ADD_T_CASE_FP( softmax )
+}
@@ -0,0 +1,278 @@
+/**
+ * @file test_mat_scan.cpp
+ *
+ * @brief Unit testing for cumsum, cumprod, cummax and cummin
+ *
+ * @author Dahua Lin
+ */
+
+#include "../test_base.h"
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/matrix/ref_matrix_rm.h>
+#include <light_mat/mateval/matrix_scan.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+using namespace lmat;
+using namespace lmat::test;
+
+const index_t LongLen = 200003;  // long enough to be split over threads
+const index_t DM = 37;
+const index_t DN = 9;
+
+
+// small integral values, so that float sums are exact,
+// and unit factors, so that long products are exact as well
+
+template<typename T>
+void fill_scan_values(T *p, index_t n)
+{
+	for (index_t i = 0; i < n; ++i)
+		p[i] = T(std::rand() % 9 - 4);
+}
+
+template<typename T>
+void fill_prod_values(T *p, index_t n)
+{
+	for (index_t i = 0; i < n; ++i)
+		p[i] = std::rand() % 2 ? T(1) : T(-1);
+}
+
+template<class Op, typename T>
+std::vector<T> ref_scan(const std::vector<T>& a)
+{
+	std::vector<T> r(a.size());
+	if (a.empty()) return r;
+
+	r[0] = a[0];
+	for (size_t i = 1; i < a.size(); ++i) r[i] = Op::eval(r[i-1], a[i]);
+	return r;
+}
+
+template<class Mat>
+std::vector<typename matrix_traits<Mat>::value_type> col_of(const Mat& a, index_t j)
+{
+	std::vector<typename matrix_traits<Mat>::value_type> v((size_t)a.nrows());
+	for (index_t i = 0; i < a.nrows(); ++i) v[i] = a(i, j);
+	return v;
+}
+
+template<class Mat>
+std::vector<typename matrix_traits<Mat>::value_type> row_of(const Mat& a, index_t i)
+{
+	std::vector<typename matrix_traits<Mat>::value_type> v((size_t)a.ncolumns());
+	for (index_t j = 0; j < a.ncolumns(); ++j) v[j] = a(i, j);
+	return v;
+}
+
+template<class Mat>
+std::vector<typename matrix_traits<Mat>::value_type> elems_of(const Mat& a)
+{
+	std::vector<typename matrix_traits<Mat>::value_type> v;
+	for (index_t j = 0; j < a.ncolumns(); ++j)
+		for (index_t i = 0; i < a.nrows(); ++i) v.push_back(a(i, j));
+	return v;
+}
+
+
+// runs all forms of one scan on a and compares with references
+
+template<class Op, class Scan, class A, class R>
+void verify_scan(const A& a, R& r, Scan scan)
+{
+	typedef typename matrix_traits<A>::value_type T;
+	const index_t m = a.nrows();
+	const index_t n = a.ncolumns();
+
+	scan.all(a, r);
+	std::vector<T> ra = ref_scan<Op>(elems_of(a));
+	ASSERT_VEC_EQ( m * n, elems_of(r), ra );
+
+	scan.colwise(a, r);
+	for (index_t j = 0; j < n; ++j)
+		ASSERT_VEC_EQ( m, col_of(r, j), ref_scan<Op>(col_of(a, j)) );
+
+	scan.rowwise(a, r);
+	for (index_t i = 0; i < m; ++i)
+		ASSERT_VEC_EQ( n, row_of(r, i), ref_scan<Op>(row_of(a, i)) );
+}
+
+#define DEFINE_SCAN_FORMS( Name ) \
+	struct Name##_forms { \
+		template<class A, class R> void all(const A& a, R& r) const { Name(a, r); } \
+		template<class A, class R> void colwise(const A& a, R& r) const { colwise_##Name(a, r); } \
+		template<class A, class R> void rowwise(const A& a, R& r) const { rowwise_##Name(a, r); } };
+
+DEFINE_SCAN_FORMS( cumsum )
+DEFINE_SCAN_FORMS( cumprod )
+DEFINE_SCAN_FORMS( cummax )
+DEFINE_SCAN_FORMS( cummin )
+
+
+template<typename T>
+void test_scan_forms(index_t m, index_t n)
+{
+	dense_matrix<T> a(m, n);
+	dense_matrix<T> r(m, n);
+
+	fill_scan_values(a.ptr_data(), m * n);
+	verify_scan<internal::scan_sum>(a, r, cumsum_forms());
+	verify_scan<internal::scan_max>(a, r, cummax_forms());
+	verify_scan<internal::scan_min>(a, r, cummin_forms());
+
+	fill_prod_values(a.ptr_data(), m * n);
+	verify_scan<internal::scan_prod>(a, r, cumprod_forms());
+}
+
+T_CASE( scan_dense )
+{
+	test_scan_forms<T>(DM, DN);
+	test_scan_forms<T>(3, 2);      // shorter than a pack
+	test_scan_forms<T>(1, 50);
+	test_scan_forms<T>(50, 1);
+	test_scan_forms<T>(2000, 70);  // rows scanned in parallel blocks
+}
+
+SIMPLE_CASE( scan_int )
+{
+	test_scan_forms<int32_t>(DM, DN);
+	test_scan_forms<int64_t>(1, 300);
+}
+
+T_CASE( scan_views )
+{
+	// row-major: colwise scans run across adjacent columns
+
+	dense_matrix<T> s(DN, DM);
+	fill_scan_values(s.ptr_data(), DM * DN);
+	ref_matrix_rm<T> a(s.ptr_data(), DM, DN);
+
+	dense_matrix<T> r(DM, DN);
+	verify_scan<internal::scan_sum>(a, r, cumsum_forms());
+	verify_scan<internal::scan_max>(a, r, cummax_forms());
+
+	dense_matrix<T> t(DN, DM);
+	ref_matrix_rm<T> rr(t.ptr_data(), DM, DN);
+	verify_scan<internal::scan_min>(a, rr, cummin_forms());
+
+	// sub-blocks of a larger matrix
+
+	dense_matrix<T> b(DM + 5, DN + 2);
+	fill_scan_values(b.ptr_data(), b.nelems());
+	dense_matrix<T> c(DM + 5, DN + 2, zero());
+
+	cref_block<T> bb(b.ptr_data() + 2, DM, DN, DM + 5);
+	ref_block<T> cb(c.ptr_data() + 1, DM, DN, DM + 5);
+	verify_scan<internal::scan_sum>(bb, cb, cumsum_forms());
+	verify_scan<internal::scan_min>(bb, cb, cummin_forms());
+}
+
+T_CASE( scan_inplace )
+{
+	dense_matrix<T> a(DM, DN);
+	fill_scan_values(a.ptr_data(), DM * DN);
+
+	std::vector<T> ra = ref_scan<internal::scan_sum>(elems_of(a));
+	cumsum(a, a);
+	ASSERT_VEC_EQ( DM * DN, a, ra );
+
+	fill_scan_values(a.ptr_data(), DM * DN);
+	dense_matrix<T> b(a);
+	rowwise_cummax(a, a);
+	for (index_t i = 0; i < DM; ++i)
+		ASSERT_VEC_EQ( DN, row_of(a, i), ref_scan<internal::scan_max>(row_of(b, i)) );
+}
+
+T_CASE( scan_long )
+{
+	// the two-pass parallel scan
+
+	dense_col<T> a(LongLen);
+	dense_col<T> r(LongLen);
+	std::vector<T> av((size_t)LongLen);
+
+	fill_scan_values(a.ptr_data(), LongLen);
+	for (index_t i = 0; i < LongLen; ++i) av[i] = a[i];
+
+	cumsum(a, r);
+	ASSERT_VEC_EQ( LongLen, r, ref_scan<internal::scan_sum>(av) );
+
+	cummax(a, r);
+	ASSERT_VEC_EQ( LongLen, r, ref_scan<internal::scan_max>(av) );
+
+	cummin(a, r);
+	ASSERT_VEC_EQ( LongLen, r, ref_scan<internal::scan_min>(av) );
+
+	colwise_cumsum(a, a);
+	ASSERT_VEC_EQ( LongLen, a, ref_scan<internal::scan_sum>(av) );
+
+	fill_prod_values(a.ptr_data(), LongLen);
+	for (index_t i = 0; i < LongLen; ++i) av[i] = a[i];
+	cumprod(a, r);
+	ASSERT_VEC_EQ( LongLen, r, ref_scan<internal::scan_prod>(av) );
+}
+
+// cummax/cummin propagate NaN, whether it falls in a pack or the tail
+
+template<typename T>
+void verify_nan_scan(index_t len, index_t k)
+{
+	dense_col<T> a(len);
+	dense_col<T> r(len);
+	for (index_t i = 0; i < len; ++i) a[i] = T(i % 4);
+	a[k] = std::numeric_limits<T>::quiet_NaN();
+
+	cummax(a, r);
+	for (index_t i = 0; i < k; ++i) ASSERT_EQ( r[i], T(std::min(i, index_t(3))) );
+	for (index_t i = k; i < len; ++i) ASSERT_TRUE( r[i] != r[i] );
+
+	cummin(a, r);
+	for (index_t i = 0; i < k; ++i) ASSERT_EQ( r[i], T(0) );
+	for (index_t i = k; i < len; ++i) ASSERT_TRUE( r[i] != r[i] );
+}
+
+T_CASE( scan_nan )
+{
+	verify_nan_scan<T>(16, 1);   // in the first pack
+	verify_nan_scan<T>(16, 9);   // in a later pack, behind the carry
+	verify_nan_scan<T>(19, 17);  // in the scalar tail
+	verify_nan_scan<T>(3, 1);    // shorter than a pack
+
+	dense_col<T> a(16, zero());
+	dense_col<T> r(16);
+	a[0] = T(1); a[1] = std::numeric_limits<T>::quiet_NaN(); a[2] = T(3);
+	cummax(a, r);
+	ASSERT_EQ( r[0], T(1) );
+	for (index_t i = 1; i < 16; ++i) ASSERT_TRUE( r[i] != r[i] );
+}
+
+SIMPLE_CASE( scan_dims )
+{
+	dense_matrix<double> a(3, 4);
+	dense_matrix<double> r(4, 3);
+
+	bool thrown = false;
+	try { cumsum(a, r); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	dense_matrix<double> e(0, 4);
+	dense_matrix<double> er(0, 4);
+	cumsum(e, er);
+	rowwise_cummin(e, er);
+}
+
+
+AUTO_TPACK( mat_scan )
+{
+	ADD_T_CASE_FP( scan_dense )
+	ADD_SIMPLE_CASE( scan_int )
+	ADD_T_CASE_FP( scan_views )
+	ADD_T_CASE_FP( scan_inplace )
+	ADD_T_CASE_FP( scan_long )
+	ADD_T_CASE_FP( scan_nan )
+	ADD_SIMPLE_CASE( scan_dims )
+}
@@ -0,0 +1,245 @@
+/**
+ * @file test_mat_topk.cpp
+ *
+ * @brief Unit testing for top-k selection
+ *
+ * @author Dahua Lin
+ */
+
+#include "../test_base.h"
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/matrix/ref_matrix_rm.h>
+#include <light_mat/mateval/matrix_topk.h>
+
+#include <cstdlib>
+#include <vector>
+#include <utility>
+
+using namespace lmat;
+using namespace lmat::test;
+
+const index_t DM = 301;   // long enough to go through the SIMD filter
+const index_t DN = 7;
+const index_t DK = 5;
+const index_t LDim = 320;
+
+
+// values with many ties
+
+template<typename T>
+void fill_ties(T *p, index_t n)
+{
+	for (index_t i = 0; i < n; ++i)
+		p[i] = T(std::rand() % 50);
+}
+
+// reference: stable sort of (value, index)
+
+template<typename T, class Ord>
+struct ref_before
+{
+	bool operator() (const std::pair<T, index_t>& a, const std::pair<T, index_t>& b) const
+	{
+		return internal::topk_ord<Ord>::better(a.first, b.first);
+	}
+};
+
+template<typename T, class Ord>
+void ref_topk(const T *p, index_t len, index_t step, index_t k, T *v, index_t *ix, Ord)
+{
+	std::vector<std::pair<T, index_t> > s(len);
+	for (index_t i = 0; i < len; ++i) s[i] = std::make_pair(p[i * step], i);
+	std::stable_sort(s.begin(), s.end(), ref_before<T, Ord>());
+
+	for (index_t q = 0; q < k; ++q)
+	{
+		v[q] = s[q].first;
+		ix[q] = s[q].second;
+	}
+}
+
+
+template<typename T, class Ord>
+void verify_topk_full(Ord ord)
+{
+	const index_t m = DM;
+	const index_t n = DN;
+	const index_t k = 17;
+
+	dense_matrix<T> a(m, n);
+	fill_ties(a.ptr_data(), m * n);
+
+	dense_col<T> v(k), v0(k);
+	dense_col<index_t> ix(k), ix0(k);
+
+	ref_topk(a.ptr_data(), m * n, 1, k, v0.ptr_data(), ix0.ptr_data(), ord);
+
+	topk(a, k, v, ix, ord);
+	ASSERT_VEC_EQ( k, v, v0 );
+	ASSERT_VEC_EQ( k, ix, ix0 );
+
+	// non-contiguous: same linear indices
+
+	dense_matrix<T> abuf(LDim, n);
+	cref_block<T> b(abuf.ptr_data(), m, n, LDim);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < m; ++i) abuf(i, j) = a(i, j);
+
+	topk(b, k, v, ix, ord);
+	ASSERT_VEC_EQ( k, v, v0 );
+	ASSERT_VEC_EQ( k, ix, ix0 );
+}
+
+
+template<typename T, class Ord, class A>
+void verify_colwise_topk(const A& a, index_t k, Ord ord)
+{
+	const index_t m = a.nrows();
+	const index_t n = a.ncolumns();
+
+	dense_matrix<T> v(k, n), v0(k, n);
+	dense_matrix<index_t> ix(k, n), ix0(k, n);
+
+	for (index_t j = 0; j < n; ++j)
+	{
+		ref_topk(&a(0, j), m, a.row_stride(), k,
+				v0.ptr_col(j), ix0.ptr_col(j), ord);
+	}
+
+	colwise_topk(a, k, v, ix, ord);
+	ASSERT_MAT_EQ( k, n, v, v0 );
+	ASSERT_MAT_EQ( k, n, ix, ix0 );
+}
+
+template<typename T, class Ord, class A>
+void verify_rowwise_topk(const A& a, index_t k, Ord ord)
+{
+	const index_t m = a.nrows();
+	const index_t n = a.ncolumns();
+
+	dense_matrix<T> v(m, k), v0(m, k);
+	dense_matrix<index_t> ix(m, k), ix0(m, k);
+
+	dense_col<T> tv(k);
+	dense_col<index_t> tix(k);
+
+	for (index_t i = 0; i < m; ++i)
+	{
+		ref_topk(&a(i, 0), n, a.col_stride(), k, tv.ptr_data(), tix.ptr_data(), ord);
+		for (index_t q = 0; q < k; ++q)
+		{
+			v0(i, q) = tv[q];
+			ix0(i, q) = tix[q];
+		}
+	}
+
+	rowwise_topk(a, k, v, ix, ord);
+	ASSERT_MAT_EQ( m, k, v, v0 );
+	ASSERT_MAT_EQ( m, k, ix, ix0 );
+}
+
+
+template<typename T, class Ord>
+void verify_topk_layouts(Ord ord)
+{
+	const index_t m = DM;
+	const index_t n = DN;
+
+	// column-major (colwise: per column, rowwise: sweep)
+
+	dense_matrix<T> a(m, n);
+	fill_ties(a.ptr_data(), m * n);
+
+	verify_colwise_topk<T>(a, DK, ord);
+	verify_rowwise_topk<T>(a, DK, ord);
+	verify_colwise_topk<T>(a, m, ord);
+	verify_rowwise_topk<T>(a, n, ord);
+
+	dense_matrix<T> abuf(LDim, n);
+	fill_ties(abuf.ptr_data(), LDim * n);
+	cref_block<T> b(abuf.ptr_data(), m, n, LDim);
+
+	verify_colwise_topk<T>(b, DK, ord);
+	verify_rowwise_topk<T>(b, DK, ord);
+
+	// row-major (rowwise: per row, colwise: sweep)
+
+	dense_matrix<T> rbuf(n, m);
+	fill_ties(rbuf.ptr_data(), m * n);
+	cref_matrix_rm<T> r(rbuf.ptr_data(), m, n);
+
+	verify_colwise_topk<T>(r, DK, ord);
+	verify_rowwise_topk<T>(r, DK, ord);
+
+	// wide: many vectors in the sweep
+
+	dense_matrix<T> w(n, m);
+	fill_ties(w.ptr_data(), m * n);
+
+	verify_rowwise_topk<T>(w, DK, ord);
+}
+
+
+SIMPLE_CASE( topk_full_f64 )
+{
+	verify_topk_full<double>(desc_());
+	verify_topk_full<double>(asc_());
+}
+
+SIMPLE_CASE( topk_full_f32 )
+{
+	verify_topk_full<float>(desc_());
+	verify_topk_full<float>(asc_());
+}
+
+SIMPLE_CASE( topk_vecwise_f64 )
+{
+	verify_topk_layouts<double>(desc_());
+	verify_topk_layouts<double>(asc_());
+}
+
+SIMPLE_CASE( topk_vecwise_f32 )
+{
+	verify_topk_layouts<float>(desc_());
+	verify_topk_layouts<float>(asc_());
+}
+
+SIMPLE_CASE( topk_vecwise_i32 )
+{
+	verify_topk_layouts<int>(desc_());
+}
+
+SIMPLE_CASE( topk_default_order )
+{
+	dense_col<double> a(6);
+	a[0] = 3; a[1] = 9; a[2] = 1; a[3] = 9; a[4] = 4; a[5] = 7;
+
+	dense_col<double> v(3);
+	dense_col<index_t> ix(3);
+	topk(a, 3, v, ix);
+
+	double v0[3] = {9, 9, 7};
+	index_t ix0[3] = {1, 3, 5};
+	ASSERT_VEC_EQ( 3, v, v0 );
+	ASSERT_VEC_EQ( 3, ix, ix0 );
+
+	dense_col<double> e(0);
+	dense_col<index_t> ie(0);
+	topk(a, 0, e, ie);
+
+	bool thrown = false;
+	try { topk(a, 7, v, ix); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+}
+
+
+AUTO_TPACK( topk )
+{
+	ADD_SIMPLE_CASE( topk_default_order )
+	ADD_SIMPLE_CASE( topk_full_f64 )
+	ADD_SIMPLE_CASE( topk_full_f32 )
+	ADD_SIMPLE_CASE( topk_vecwise_f64 )
+	ADD_SIMPLE_CASE( topk_vecwise_f32 )
+	ADD_SIMPLE_CASE( topk_vecwise_i32 )
+}
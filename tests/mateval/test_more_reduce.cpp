@@ -12,6 +12,7 @@
 
 #include <light_mat/mateval/mat_enorms.h>
 #include <light_mat/mateval/mat_minmax.h>
+#include <light_mat/mateval/mat_var.h>
 
 
 #include <cstdlib>
@@ -165,6 +166,117 @@ SIMPLE_CASE( tcolwise_minmax )
 }
 
 
+// variance
+
+template<class Mat>
+double naive_var(const Mat& a, double& mu)
+{
+	const index_t n = a.nelems();
+	double s = 0;
+	for (index_t i = 0; i < n; ++i) s += a[i];
+	mu = s / double(n);
+
+	double v = 0;
+	for (index_t i = 0; i < n; ++i) v += math::sqr(a[i] - mu);
+	return n > 1 ? v / double(n - 1) : 0.0;
+}
+
+SIMPLE_CASE( tfull_var )
+{
+	dense_col<double> s(max_len);
+	fill_rand(s);
+	s += 100.0;  // a large offset exposes catastrophic cancellation
+
+	for (index_t k = 1; k <= max_len; ++k)
+	{
+		ref_col<double> sk = s(range(0, k));
+
+		double mu0;
+		double v0 = naive_var(sk, mu0);
+
+		meanvar_stat<double> st = meanvar(sk);
+		ASSERT_EQ( st.count, k );
+		ASSERT_APPROX( st.mean, mu0, 1.0e-12 );
+		ASSERT_APPROX( st.var(), v0, 1.0e-12 );
+
+		ASSERT_APPROX( var(sk), v0, 1.0e-12 );
+		ASSERT_APPROX( stddev(sk), math::sqrt(v0), 1.0e-12 );
+	}
+
+	ASSERT_TRUE( math::isnan(var(s(range(0, 0)))) );
+}
+
+SIMPLE_CASE( tcolwise_var )
+{
+	const index_t n = 6;
+	dense_matrix<double> src(max_nrows, n);
+	fill_rand(src);
+
+	dense_row<double> mu(n, zero());
+	dense_row<double> v(n, zero());
+	dense_row<double> sd(n, zero());
+	dense_row<double> mu0(n, zero());
+	dense_row<double> v0(n, zero());
+
+	for (unsigned k = 0; k < ntest_nrows; ++k)
+	{
+		index_t cl = test_nrows[k];
+		ref_block<double> s = src(range(0, cl), whole());
+
+		for (index_t j = 0; j < n; ++j)
+		{
+			dense_col<double> cj(s.column(j));
+			v0[j] = naive_var(cj, mu0[j]);
+		}
+
+		colwise_meanvar(s, mu, v);
+		ASSERT_MAT_APPROX(1, n, mu, mu0, 1.0e-14);
+		ASSERT_MAT_APPROX(1, n, v, v0, 1.0e-14);
+
+		colwise_var(s, v);
+		ASSERT_MAT_APPROX(1, n, v, v0, 1.0e-14);
+
+		colwise_stddev(s, sd);
+		for (index_t j = 0; j < n; ++j) ASSERT_APPROX(sd[j], math::sqrt(v0[j]), 1.0e-14);
+	}
+}
+
+SIMPLE_CASE( trowwise_var )
+{
+	const index_t n = 7;
+	dense_matrix<double> src(max_nrows, n);
+	fill_rand(src);
+
+	for (unsigned k = 0; k < ntest_nrows; ++k)
+	{
+		index_t cl = test_nrows[k];
+		ref_block<double> s = src(range(0, cl), whole());
+
+		dense_col<double> mu(cl, zero());
+		dense_col<double> v(cl, zero());
+		dense_col<double> sd(cl, zero());
+		dense_col<double> mu0(cl, zero());
+		dense_col<double> v0(cl, zero());
+
+		for (index_t i = 0; i < cl; ++i)
+		{
+			dense_row<double> ri(s.row(i));
+			v0[i] = naive_var(ri, mu0[i]);
+		}
+
+		rowwise_meanvar(s, mu, v);
+		ASSERT_MAT_APPROX(cl, 1, mu, mu0, 1.0e-14);
+		ASSERT_MAT_APPROX(cl, 1, v, v0, 1.0e-14);
+
+		rowwise_var(s, v);
+		ASSERT_MAT_APPROX(cl, 1, v, v0, 1.0e-14);
+
+		rowwise_stddev(s, sd);
+		for (index_t i = 0; i < cl; ++i) ASSERT_APPROX(sd[i], math::sqrt(v0[i]), 1.0e-14);
+	}
+}
+
+
 AUTO_TPACK( mat_norms )
 {
 	ADD_SIMPLE_CASE( tfull_norms )
@@ -178,7 +290,9 @@ AUTO_TPACK( mat_minmax )
 	ADD_SIMPLE_CASE( tcolwise_minmax )
 }
 
-
-
-
-
+AUTO_TPACK( mat_var )
+{
+	ADD_SIMPLE_CASE( tfull_var )
+	ADD_SIMPLE_CASE( tcolwise_var )
+	ADD_SIMPLE_CASE( trowwise_var )
+}
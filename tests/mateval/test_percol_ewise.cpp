@@ -26,7 +26,7 @@ using namespace lmat::test;
 
 // test cases
 
-template<typename STag, typename DTag, typename U, int M, int N>
+template<typename STag, typename DTag, typename U, int M, int N, typename S=auto_store_>
 void test_percol_ewise()
 {
 	const index_t m = M == 0 ? DM : M;
@@ -47,7 +47,7 @@ void test_percol_ewise()
 	copy_kernel<double> cpy_kernel;
 	accum_kernel<double> upd_kernel;
 
-	ewise(cpy_kernel).eval(macc_<percol_, U>(), shape, in_(smat), out_(dmat));
+	ewise(cpy_kernel).eval(macc_<percol_, U, S>(), shape, in_(smat), out_(dmat));
 
 	ASSERT_MAT_EQ(m, n, smat, dmat);
 
@@ -212,6 +212,13 @@ MN_CASE( percol_ewise_avx_repcol_cont )
 			ADD_MN_CASE_3X3( percol_ewise_##SKindName##_##STag##_##DTag, DM, DN ) \
 		}
 
+#define DEFINE_PERCOL_EWISE_STREAM_TEST( SKindName, STag, DTag ) \
+		MN_CASE( percol_ewise_##SKindName##_stream_##STag##_##DTag  ) { \
+			test_percol_ewise<STag, DTag, simd_<SKindName##_t>, M, N, stream_store_>(); } \
+		AUTO_TPACK( percol_ewise_##SKindName##_stream_##STag##_##DTag ) { \
+			ADD_MN_CASE_3X3( percol_ewise_##SKindName##_stream_##STag##_##DTag, DM, DN ) \
+		}
+
 DEFINE_PERCOL_EWISE_SCALAR_TEST( cont, cont )
 DEFINE_PERCOL_EWISE_SCALAR_TEST( cont, bloc )
 DEFINE_PERCOL_EWISE_SCALAR_TEST( cont, grid )
@@ -228,6 +235,11 @@ DEFINE_PERCOL_EWISE_SIMD_TEST( sse, cont, cont )
 DEFINE_PERCOL_EWISE_SIMD_TEST( sse, cont, bloc )
 DEFINE_PERCOL_EWISE_SIMD_TEST( sse, bloc, cont )
 DEFINE_PERCOL_EWISE_SIMD_TEST( sse, bloc, bloc )
+DEFINE_PERCOL_EWISE_SIMD_TEST( sse, grid, cont )
+DEFINE_PERCOL_EWISE_SIMD_TEST( sse, grid, bloc )
+
+DEFINE_PERCOL_EWISE_STREAM_TEST( sse, cont, cont )
+DEFINE_PERCOL_EWISE_STREAM_TEST( sse, cont, bloc )
 
 #ifdef LMAT_HAS_AVX
 
@@ -235,6 +247,11 @@ DEFINE_PERCOL_EWISE_SIMD_TEST( avx, cont, cont )
 DEFINE_PERCOL_EWISE_SIMD_TEST( avx, cont, bloc )
 DEFINE_PERCOL_EWISE_SIMD_TEST( avx, bloc, cont )
 DEFINE_PERCOL_EWISE_SIMD_TEST( avx, bloc, bloc )
+DEFINE_PERCOL_EWISE_SIMD_TEST( avx, grid, cont )
+DEFINE_PERCOL_EWISE_SIMD_TEST( avx, grid, bloc )
+
+DEFINE_PERCOL_EWISE_STREAM_TEST( avx, cont, cont )
+DEFINE_PERCOL_EWISE_STREAM_TEST( avx, cont, bloc )
 
 #endif
 
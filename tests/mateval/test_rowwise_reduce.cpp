@@ -96,6 +96,38 @@ const unsigned int ntest_nrows = sizeof(test_nrows) / sizeof(index_t);
 
 
 
+// row-major inputs: tsrc is the column-major transpose of src,
+// hence its memory is exactly src in row-major order
+
+#define DEFINE_ROWWISE_REDUCE_RM_CASE( Name ) \
+		SIMPLE_CASE( trowwise_##Name##_rm ) { \
+			const index_t n = 9; \
+			dense_matrix<double> src(max_nrows, n); \
+			dense_matrix<double> tsrc(n, max_nrows); \
+			fill_rand(src); \
+			for (index_t j = 0; j < n; ++j) { \
+				for (index_t i = 0; i < max_nrows; ++i) \
+					tsrc(j, i) = src(i, j); } \
+			for (unsigned k = 0; k < ntest_nrows; ++k) { \
+				index_t nr = test_nrows[k]; \
+				auto sn = src(range(0, nr), whole()); \
+				cref_matrix_rm<double> a(tsrc.ptr_data(), nr, n); \
+				cref_block_rm<double> b(tsrc.ptr_data(), nr, n - 2, n); \
+				dense_col<double> d(nr); \
+				dense_col<double> r(nr); \
+				rowwise_##Name(sn, r); \
+				rowwise_##Name(a, d); \
+				ASSERT_MAT_APPROX(nr, 1, r, d, 1.0e-12); \
+				rowwise_##Name(src(range(0, nr), range(0, n - 2)), r); \
+				rowwise_##Name(b, d); \
+				ASSERT_MAT_APPROX(nr, 1, r, d, 1.0e-12); \
+				dense_row<double> dc(n); \
+				dense_row<double> rc(n); \
+				colwise_##Name(sn, rc); \
+				colwise_##Name(a, dc); \
+				ASSERT_MAT_APPROX(1, n, rc, dc, 1.0e-12); } }
+
+
 DEFINE_ROWWISE_REDUCE_CASE( sum )
 DEFINE_ROWWISE_REDUCE_CASE( mean )
 DEFINE_ROWWISE_REDUCE_CASE( maximum )
@@ -113,6 +145,11 @@ DEFINE_ROWWISE_REDUCE_CASE_2( diff_sqsum )
 
 DEFINE_ROWWISE_REDUCE_CASE_2( dot )
 
+DEFINE_ROWWISE_REDUCE_RM_CASE( sum )
+DEFINE_ROWWISE_REDUCE_RM_CASE( mean )
+DEFINE_ROWWISE_REDUCE_RM_CASE( maximum )
+DEFINE_ROWWISE_REDUCE_RM_CASE( minimum )
+
 
 AUTO_TPACK( rowwise_reduce )
 {
@@ -132,6 +169,11 @@ AUTO_TPACK( rowwise_reduce )
 	ADD_SIMPLE_CASE( trowwise_diff_sqsum )
 
 	ADD_SIMPLE_CASE( trowwise_dot )
+
+	ADD_SIMPLE_CASE( trowwise_sum_rm )
+	ADD_SIMPLE_CASE( trowwise_mean_rm )
+	ADD_SIMPLE_CASE( trowwise_maximum_rm )
+	ADD_SIMPLE_CASE( trowwise_minimum_rm )
 }
 
 
@@ -0,0 +1,496 @@
+/**
+ * @file test_fused_expr.cpp
+ *
+ * @brief Unit testing of fused map expressions
+ *
+ * @author Dahua Lin
+ */
+
+#include "matfun_test_base.h"
+
+#include <light_mat/matexpr/mat_arith.h>
+#include <light_mat/matexpr/mat_emath.h>
+#include <light_mat/mateval/mat_reduce.h>
+
+using namespace lmat;
+using namespace lmat::test;
+
+
+// a functor that counts its invocations
+
+static long g_ncalls = 0;
+
+namespace lmat
+{
+	namespace ftags
+	{
+		struct counted_ { };
+	}
+
+	template<typename T>
+	struct counted_fun
+	{
+		typedef T result_type;
+
+		T operator() (const T& x) const
+		{
+			++ g_ncalls;
+			return x + T(1);
+		}
+	};
+
+	template<>
+	struct fun_map<ftags::counted_, double>
+	{
+		typedef counted_fun<double> type;
+	};
+}
+
+template<class X>
+inline map_expr<ftags::counted_, X> counted(const IEWiseMatrix<X, double>& x)
+{
+	return make_map_expr(ftags::counted_(), x);
+}
+
+
+// a functor of four arguments
+
+namespace lmat
+{
+	namespace ftags
+	{
+		struct madd4_ { };
+	}
+
+	LMAT_DEF_REAL_MATH_FUN( ftags::madd4_, 4, madd4_fun, x1 * x2 + x3 * x4 )
+	LMAT_DEF_SIMD_SUPPORT( madd4_fun )
+}
+
+
+SIMPLE_CASE( fuse_plan )
+{
+	typedef dense_matrix<double> mat_t;
+	typedef map_expr<ftags::exp_, mat_t> e_t;
+	typedef map_expr<ftags::mul_, e_t, e_t> ee_t;
+	typedef map_expr<ftags::add_, ee_t, e_t> expr_t;
+
+	typedef internal::fuse_plan<expr_t> plan_t;
+
+	// a, exp(a), a, exp(a), exp(a) * exp(a), a, exp(a), root
+
+	ASSERT_EQ( plan_t::num_nodes, 8 );
+
+	typedef plan_t::nodes nodes;
+	ASSERT_EQ( (internal::fuse_index_of<nodes, mat_t>::value), 0 );
+	ASSERT_EQ( (internal::fuse_index_of<nodes, e_t>::value), 1 );
+	ASSERT_EQ( (internal::fuse_index_of<nodes, ee_t>::value), 4 );
+	ASSERT_EQ( (internal::fuse_index_of<nodes, expr_t>::value), 7 );
+
+	// the common sharing (a, exp(a), exp(a) * exp(a), root),
+	// and the dynamic one, for operands that turn out to differ
+
+	typedef plan_t::sharings sharings;
+	ASSERT_EQ( sharings::size, 2 );
+	ASSERT_EQ( (internal::fuse_num_computed<nodes, internal::fuse_common_sharing<nodes>::type>::value), 4 );
+
+	typedef internal::fuse_plan<map_expr<ftags::add_, mat_t, mat_t> > plan2_t;
+	ASSERT_EQ( plan2_t::num_nodes, 3 );
+	ASSERT_EQ( plan2_t::sharings::size, 2 );
+
+	// no leaf repeats: a single kernel
+
+	typedef internal::fuse_plan<map_expr<ftags::add_, mat_t, dense_col<double> > > plan3_t;
+	ASSERT_EQ( plan3_t::num_nodes, 3 );
+	ASSERT_EQ( plan3_t::sharings::size, 1 );
+}
+
+
+SIMPLE_CASE( fuse_evaluates_once )
+{
+	const index_t m = 7;
+	const index_t n = 5;
+
+	dense_matrix<double> a(m, n);
+	for (index_t i = 0; i < m * n; ++i) a[i] = double(i + 1);
+
+	dense_matrix<double> r0(m, n);
+	for (index_t i = 0; i < m * n; ++i) r0[i] = (a[i] + 1) * (a[i] + 1) + (a[i] + 1);
+
+	// without fusion, each occurrence is computed
+
+	g_ncalls = 0;
+	dense_matrix<double> r = counted(a) * counted(a) + counted(a);
+
+	ASSERT_MAT_EQ( m, n, r, r0 );
+	ASSERT_EQ( g_ncalls, 3 * m * n );
+
+	// fused, the repeated sub-expression is computed once
+
+	g_ncalls = 0;
+	r = fuse(counted(a) * counted(a) + counted(a));
+
+	ASSERT_MAT_EQ( m, n, r, r0 );
+	ASSERT_EQ( g_ncalls, m * n );
+
+	// distinct operands of the same type: only the equal nodes are shared
+	// (a, counted(a), b, counted(b), the product, and the root)
+
+	dense_matrix<double> b(m, n);
+	for (index_t i = 0; i < m * n; ++i) b[i] = double(2 * i + 3);
+
+	for (index_t i = 0; i < m * n; ++i) r0[i] = (a[i] + 1) * (b[i] + 1) + (a[i] + 1);
+
+	auto f = fuse(counted(a) * counted(b) + counted(a));
+	ASSERT_EQ( f.num_distinct_nodes(), 6 );
+
+	g_ncalls = 0;
+	r = f;
+
+	ASSERT_MAT_EQ( m, n, r, r0 );
+	ASSERT_EQ( g_ncalls, 2 * m * n );
+
+	// in reversed order, and nested
+
+	for (index_t i = 0; i < m * n; ++i) r0[i] = (b[i] + 1) * (a[i] + 1) + (a[i] + 1) * (b[i] + 1);
+
+	g_ncalls = 0;
+	r = fuse(counted(b) * counted(a) + counted(a) * counted(b));
+
+	ASSERT_MAT_EQ( m, n, r, r0 );
+	ASSERT_EQ( g_ncalls, 2 * m * n );
+
+	for (index_t i = 0; i < m * n; ++i) r0[i] = ((a[i] + 1) + 1) * ((b[i] + 1) + 1) + ((a[i] + 1) + 1);
+
+	g_ncalls = 0;
+	r = fuse(counted(counted(a)) * counted(counted(b)) + counted(counted(a)));
+
+	ASSERT_MAT_EQ( m, n, r, r0 );
+	ASSERT_EQ( g_ncalls, 4 * m * n );
+}
+
+
+SIMPLE_CASE( fuse_reductions )
+{
+	const index_t m = 9;
+	const index_t n = 4;
+
+	dense_matrix<double> a(m, n), bbuf(m, n);
+	for (index_t i = 0; i < m * n; ++i) a[i] = double(i + 1);
+	for (index_t i = 0; i < m * n; ++i) bbuf[i] = double(3 * i + 2);
+
+	// a leaf of another type
+	cref_matrix<double> b(bbuf.ptr_data(), m, n);
+
+	dense_row<double> cs0(n, zero());
+	double s0 = 0;
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i)
+		{
+			double ea = a(i, j) + 1;
+			double v = ea * ea + ea * (a(i, j) + b(i, j));
+			cs0[j] += v;
+			s0 += v;
+		}
+	}
+
+	// full reduction
+
+	g_ncalls = 0;
+	double s = sum(fuse(counted(a) * counted(a) + counted(a) * (a + b)));
+
+	ASSERT_APPROX( s, s0, 1.0e-10 );
+	ASSERT_EQ( g_ncalls, m * n );
+
+	// column-wise reduction
+
+	dense_row<double> cs(n, zero());
+
+	g_ncalls = 0;
+	colwise_sum(fuse(counted(a) * counted(a) + counted(a) * (a + b)), cs);
+
+	ASSERT_MAT_APPROX( 1, n, cs, cs0, 1.0e-10 );
+	ASSERT_EQ( g_ncalls, m * n );
+
+	// with distinct operands of the same type
+
+	g_ncalls = 0;
+	s = sum(fuse(counted(a) * counted(bbuf)));
+
+	ASSERT_EQ( g_ncalls, 2 * m * n );
+}
+
+
+SIMPLE_CASE( fuse_outlives_tree )
+{
+	const index_t m = 6;
+	const index_t n = 3;
+
+	dense_matrix<double> a(m, n), r(m, n), r0(m, n);
+	for (index_t i = 0; i < m * n; ++i) a[i] = double(i + 1);
+	for (index_t i = 0; i < m * n; ++i) r0[i] = (a[i] + 1.5) * (a[i] + 1.5);
+
+	// the tree (and its scalar) are temporaries of this statement
+
+	auto f = fuse((a + 1.5) * (a + 1.5));
+	ASSERT_EQ( f.num_distinct_nodes(), 4 );
+
+	r = f;
+	ASSERT_MAT_EQ( m, n, r, r0 );
+}
+
+SIMPLE_CASE( fuse_allocators )
+{
+	// dense matrices with other allocators are referred to, not copied
+
+	typedef dense_matrix<double, 0, 0, hugepage_allocator<double> > hmat_t;
+	ASSERT_TRUE( internal::fuse_owning<hmat_t>::value );
+
+	const index_t m = 6;
+	const index_t n = 3;
+
+	hmat_t a(m, n);
+	dense_matrix<double> r(m, n), r0(m, n);
+	for (index_t i = 0; i < m * n; ++i) a[i] = double(i + 1);
+
+	auto f = fuse((a + 1.5) * (a + 1.5));
+
+	a[0] = 10.0;
+	for (index_t i = 0; i < m * n; ++i) r0[i] = (a[i] + 1.5) * (a[i] + 1.5);
+
+	r = f;
+	ASSERT_MAT_EQ( m, n, r, r0 );
+}
+
+
+SIMPLE_CASE( fuse_scalars )
+{
+	const index_t m = 6;
+	const index_t n = 4;
+
+	dense_matrix<double> a(m, n), r(m, n), r0(m, n);
+	for (index_t i = 0; i < m * n; ++i) a[i] = double(i + 1);
+
+	const double c1 = 2.0;
+	const double c2 = 3.0;
+
+	// scalars are shared only if they are equal
+
+	ASSERT_EQ( fuse((a + c1) * (a + c1)).num_distinct_nodes(), 4 );
+	ASSERT_EQ( fuse((a + c1) * (a + c2)).num_distinct_nodes(), 6 );  // a is read once
+
+	r = fuse((a + c1) * (a + c1));
+	for (index_t i = 0; i < m * n; ++i) r0[i] = (a[i] + c1) * (a[i] + c1);
+	ASSERT_MAT_EQ( m, n, r, r0 );
+
+	r = fuse((a + c1) * (a + c2));
+	for (index_t i = 0; i < m * n; ++i) r0[i] = (a[i] + c1) * (a[i] + c2);
+	ASSERT_MAT_EQ( m, n, r, r0 );
+}
+
+
+MN_CASE( fuse_cont )
+{
+	typedef dense_matrix<double, M, N> mat_t;
+
+	const index_t m = M == 0 ? DM : M;
+	const index_t n = N == 0 ? DN : N;
+
+	mat_t a(m, n), b(m, n);
+	fill_ran(a, -1.0, 1.0);
+	fill_ran(b, -1.0, 1.0);
+
+	mat_t r0(m, n);
+	for (index_t i = 0; i < m * n; ++i)
+	{
+		double e = std::exp(a[i]);
+		r0[i] = e * e + e - b[i] * e;
+	}
+
+	mat_t r = exp(a) * exp(a) + exp(a) - b * exp(a);
+	ASSERT_MAT_APPROX( m, n, r, r0, 1.0e-12 );
+
+	mat_t rf = fuse(exp(a) * exp(a) + exp(a) - b * exp(a));
+	ASSERT_MAT_APPROX( m, n, rf, r0, 1.0e-12 );
+
+	// fused expressions can be used as operands
+
+	double s0 = 0;
+	for (index_t i = 0; i < m * n; ++i) s0 += r0[i];
+	ASSERT_APPROX( sum(fuse(exp(a) * exp(a) + exp(a) - b * exp(a))), s0, 1.0e-10 );
+}
+
+
+MN_CASE( fuse_block )
+{
+	typedef dense_matrix<double> mat_t;
+
+	const index_t m = M == 0 ? DM : M;
+	const index_t n = N == 0 ? DN : N;
+
+	mat_t abuf(LDim, n);
+	fill_ran(abuf, -1.0, 1.0);
+	cref_block<double, M, N> a(abuf.ptr_data(), m, n, LDim);
+
+	dense_matrix<double, M, N> r0(m, n);
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i)
+		{
+			double e = std::exp(a(i, j));
+			r0(i, j) = e * e + e;
+		}
+	}
+
+	mat_t rbuf(LDim, n, zero());
+	ref_block<double, M, N> r(rbuf.ptr_data(), m, n, LDim);
+	r = exp(a) * exp(a) + exp(a);
+	ASSERT_MAT_APPROX( m, n, r, r0, 1.0e-12 );
+
+	fill(r, 0.0);
+	r = fuse(exp(a) * exp(a) + exp(a));
+	ASSERT_MAT_APPROX( m, n, r, r0, 1.0e-12 );
+}
+
+
+MN_CASE( map_nary )
+{
+	typedef dense_matrix<double, M, N> mat_t;
+
+	const index_t m = M == 0 ? DM : M;
+	const index_t n = N == 0 ? DN : N;
+
+	mat_t a(m, n), b(m, n), c(m, n), d(m, n);
+	fill_ran(a, -1.0, 1.0);
+	fill_ran(b, -1.0, 1.0);
+	fill_ran(c, -1.0, 1.0);
+	fill_ran(d, -1.0, 1.0);
+
+	typedef map_expr<ftags::madd4_, mat_t, mat_t, mat_t, mat_t> expr_t;
+	ASSERT_EQ( (index_t)meta::nrows<expr_t>::value, M );
+	ASSERT_EQ( (index_t)meta::ncols<expr_t>::value, N );
+
+	mat_t r0(m, n);
+	for (index_t i = 0; i < m * n; ++i) r0[i] = a[i] * b[i] + c[i] * d[i];
+
+	mat_t r = make_map_expr(ftags::madd4_(), a, b, c, d);
+	ASSERT_MAT_APPROX( m, n, r, r0, 1.0e-12 );
+
+	// with a scalar
+
+	for (index_t i = 0; i < m * n; ++i) r0[i] = a[i] * 2.0 + c[i] * d[i];
+
+	r = make_map_expr(ftags::madd4_(), a, 2.0, c, d);
+	ASSERT_MAT_APPROX( m, n, r, r0, 1.0e-12 );
+
+	// nested, and fused
+
+	for (index_t i = 0; i < m * n; ++i)
+	{
+		double e = std::exp(a[i]);
+		r0[i] = e * e + e * b[i];
+	}
+
+	r = make_map_expr(ftags::madd4_(), exp(a), exp(a), exp(a), b);
+	ASSERT_MAT_APPROX( m, n, r, r0, 1.0e-12 );
+
+	r = fuse(make_map_expr(ftags::madd4_(), exp(a), exp(a), exp(a), b));
+	ASSERT_MAT_APPROX( m, n, r, r0, 1.0e-12 );
+
+	ASSERT_APPROX( sum(make_map_expr(ftags::madd4_(), exp(a), exp(a), exp(a), b)), sum(r0), 1.0e-10 );
+
+	// row-major operands (evaluated on the transposes)
+
+	dense_matrix<double> sa(n, m), sb(n, m), sr(n, m);
+	fill_ran(sa, -1.0, 1.0);
+	fill_ran(sb, -1.0, 1.0);
+
+	cref_matrix_rm<double, M, N> ra(sa.ptr_data(), m, n);
+	cref_matrix_rm<double, M, N> rb(sb.ptr_data(), m, n);
+	ref_matrix_rm<double, M, N> rr(sr.ptr_data(), m, n);
+
+	rr = make_map_expr(ftags::madd4_(), ra, rb, 2.0, ra);
+
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i)
+			ASSERT_APPROX( rr(i, j), ra(i, j) * rb(i, j) + 2.0 * ra(i, j), 1.0e-12 );
+	}
+}
+
+
+MN_CASE( map_nary_block )
+{
+	typedef dense_matrix<double> mat_t;
+
+	const index_t m = M == 0 ? DM : M;
+	const index_t n = N == 0 ? DN : N;
+
+	mat_t abuf(LDim, n), bbuf(LDim, n);
+	fill_ran(abuf, -1.0, 1.0);
+	fill_ran(bbuf, -1.0, 1.0);
+	cref_block<double, M, N> a(abuf.ptr_data(), m, n, LDim);
+	cref_block<double, M, N> b(bbuf.ptr_data(), m, n, LDim);
+
+	dense_matrix<double, M, N> r0(m, n);
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i) r0(i, j) = a(i, j) * b(i, j) + 3.0 * a(i, j);
+	}
+
+	mat_t rbuf(LDim, n, zero());
+	ref_block<double, M, N> r(rbuf.ptr_data(), m, n, LDim);
+	r = make_map_expr(ftags::madd4_(), a, b, 3.0, a);
+
+	ASSERT_MAT_APPROX( m, n, r, r0, 1.0e-12 );
+
+	// repeated sub-expressions of a map of four arguments are computed once
+
+	dense_matrix<double, M, N> c(m, n);
+	fill_ran(c, -1.0, 1.0);
+
+	g_ncalls = 0;
+	dense_matrix<double, M, N> rc = fuse(
+			make_map_expr(ftags::madd4_(), counted(a), counted(a), counted(c), counted(a)));
+
+	ASSERT_EQ( g_ncalls, 2 * m * n );
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i)
+		{
+			double ea = a(i, j) + 1;
+			ASSERT_APPROX( rc(i, j), ea * ea + (c(i, j) + 1) * ea, 1.0e-12 );
+		}
+	}
+}
+
+
+AUTO_TPACK( fuse_basics )
+{
+	ADD_SIMPLE_CASE( fuse_plan )
+	ADD_SIMPLE_CASE( fuse_evaluates_once )
+	ADD_SIMPLE_CASE( fuse_reductions )
+	ADD_SIMPLE_CASE( fuse_outlives_tree )
+	ADD_SIMPLE_CASE( fuse_allocators )
+	ADD_SIMPLE_CASE( fuse_scalars )
+}
+
+AUTO_TPACK( fuse_cont )
+{
+	ADD_MN_CASE_3X3( fuse_cont, DM, DN )
+}
+
+AUTO_TPACK( fuse_block )
+{
+	ADD_MN_CASE_3X3( fuse_block, DM, DN )
+}
+
+AUTO_TPACK( map_nary )
+{
+	ADD_MN_CASE_3X3( map_nary, DM, DN )
+}
+
+AUTO_TPACK( map_nary_block )
+{
+	ADD_MN_CASE_3X3( map_nary_block, DM, DN )
+}
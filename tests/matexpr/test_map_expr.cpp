@@ -62,19 +62,17 @@ bool my_use_simd(const map_expr<FTag, A>& expr, const Dst& dmat)
 
 	if (use_linear)
 	{
+		// strided sources are read with strided loads
+
 		const int L = meta::nelems<A>::value;
-		const bool is_cont =
-				meta::is_contiguous<A>::value &&
-				meta::is_contiguous<Dst>::value;
+		const bool is_cont = meta::is_contiguous<Dst>::value;
 
 		return is_cont && (L % pw == 0);
 	}
 	else
 	{
 		const int M = meta::nrows<A>::value;
-		const bool is_cont_pc =
-				meta::is_percol_contiguous<A>::value &&
-				meta::is_percol_contiguous<Dst>::value;
+		const bool is_cont_pc = meta::is_percol_contiguous<Dst>::value;
 
 		return is_cont_pc && (M % pw == 0);
 	}
@@ -90,20 +88,14 @@ bool my_use_simd(const map_expr<FTag, A, B>& expr, const Dst& dmat)
 	if (use_linear)
 	{
 		const int L = meta::common_nelems<A, B>::value;
-		const bool is_cont =
-				meta::is_contiguous<A>::value &&
-				meta::is_contiguous<B>::value &&
-				meta::is_contiguous<Dst>::value;
+		const bool is_cont = meta::is_contiguous<Dst>::value;
 
 		return is_cont && (L % pw == 0);
 	}
 	else
 	{
 		const int M = meta::common_nrows<A, B>::value;
-		const bool is_cont_pc =
-				meta::is_percol_contiguous<A>::value &&
-				meta::is_percol_contiguous<B>::value &&
-				meta::is_percol_contiguous<Dst>::value;
+		const bool is_cont_pc = meta::is_percol_contiguous<Dst>::value;
 
 		return is_cont_pc && (M % pw == 0);
 	}
@@ -497,3 +489,79 @@ AUTO_TPACK( compound_map_expr )
 }
 
 
+
+
+// Row-major expressions (evaluated on their transposes)
+
+MN_CASE( map_rowmajor_expr )
+{
+	index_t m = M == 0 ? DM : M;
+	index_t n = N == 0 ? DN : N;
+	index_t ldim = n + 3;
+
+	const int pw = (int)simd_traits<double, default_simd_kind>::pack_width;
+	const bool is_vec = (M == 1 || N == 1);
+
+	dense_matrix<double> sa(n, m), sb(ldim, m), sr(n, m), srb(ldim, m, fill(-1.0));
+	for (index_t i = 0; i < n * m; ++i) sa[i] = double(i + 1);
+	for (index_t i = 0; i < ldim * m; ++i) sb[i] = double(2 * i + 3);
+
+	cref_matrix_rm<double, M, N> a(sa.ptr_data(), m, n);
+	cref_block_rm<double, M, N> b(sb.ptr_data(), m, n, ldim);
+	ref_matrix_rm<double, M, N> r(sr.ptr_data(), m, n);
+	ref_block_rm<double, M, N> rb(srb.ptr_data(), m, n, ldim);
+
+	// policy: contiguous and per-column SIMD on the transposes
+
+	auto p1 = get_preferred_expr_macc_policy(
+			make_map_expr(ftags::mul_(), a, a), r);
+
+	ASSERT_TRUE( use_linear_acc(p1) );
+	ASSERT_EQ( use_simd(p1), (M * N) % pw == 0 );
+
+	if (!is_vec)
+	{
+		auto p2 = get_preferred_expr_macc_policy(
+				make_map_expr(ftags::add_(), a, b), rb);
+
+		ASSERT_FALSE( use_linear_acc(p2) );
+		ASSERT_EQ( use_simd(p2), N % pw == 0 );
+	}
+
+	// evaluation
+
+	r = make_map_expr(ftags::add_(),
+			make_map_expr(ftags::mul_(), a, b),
+			make_map_expr_fix2(ftags::mul_(), a, 2.0));
+
+	dense_matrix<double> r0(m, n);
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i)
+			r0(i, j) = a(i, j) * b(i, j) + a(i, j) * 2.0;
+	}
+
+	ASSERT_MAT_EQ(m, n, r, r0);
+
+	// with repeated sub-expressions
+
+	rb = make_map_expr(ftags::mul_(),
+			make_map_expr(ftags::add_(), a, b),
+			make_map_expr(ftags::add_(), a, b));
+
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i)
+			r0(i, j) = (a(i, j) + b(i, j)) * (a(i, j) + b(i, j));
+	}
+
+	ASSERT_MAT_EQ(m, n, rb, r0);
+
+	for (index_t i = 0; i < m; ++i)
+		for (index_t j = n; j < ldim; ++j) ASSERT_EQ( srb(j, i), -1.0 );
+}
+
+AUTO_TPACK( rowmajor_map_expr )
+{
+	ADD_MN_CASE_3X3( map_rowmajor_expr, DM, DN )
+}
@@ -12,6 +12,7 @@
 #include <light_mat/matrix/ref_matrix.h>
 #include <light_mat/matrix/ref_block.h>
 #include <light_mat/matrix/ref_grid.h>
+#include <light_mat/matrix/dense_matrix.h>
 #include <light_mat/common/block.h>
 
 using namespace lmat;
@@ -43,6 +44,41 @@ void test_matrix_copy()
 }
 
 
+template<typename STag, typename DTag, int M, int N>
+void test_matrix_copy_stream()
+{
+	const index_t m = M == 0 ? 3 : M;
+	const index_t n = N == 0 ? 4 : N;
+
+	typedef typename mat_host<STag, double, M, N>::cmat_t smat_t;
+	typedef typename mat_host<DTag, double, M, N>::mat_t dmat_t;
+
+	mat_host<STag, double, M, N> src(m, n);
+	src.fill_lin();
+	mat_host<DTag, double, M, N> dst(m, n);
+
+	smat_t smat = src.get_cmat();
+	dmat_t dmat = dst.get_mat();
+
+	copy(smat, dmat, stream_store_());
+	ASSERT_MAT_EQ(m, n, smat, dmat);
+
+	// import & export
+
+	dense_matrix<double, M, N> c(m, n);
+	copy(dmat, c.ptr_data(), stream_store_());
+	ASSERT_MAT_EQ(m, n, smat, c);
+
+	zero(dmat);
+	copy(c.ptr_data(), dmat, stream_store_());
+	ASSERT_MAT_EQ(m, n, smat, dmat);
+
+	zero(dmat);
+	copy(smat, dmat, cache_store_());
+	ASSERT_MAT_EQ(m, n, smat, dmat);
+}
+
+
 template<typename DTag, int M, int N>
 void test_matrix_import()
 {
@@ -165,6 +201,47 @@ MN_CASE( mat_export_grid )
 }
 
 
+MN_CASE( mat_copy_stream_cont_to_cont )
+{
+	test_matrix_copy_stream<cont, cont, M, N>();
+}
+
+MN_CASE( mat_copy_stream_bloc_to_bloc )
+{
+	test_matrix_copy_stream<bloc, bloc, M, N>();
+}
+
+MN_CASE( mat_copy_stream_grid_to_grid )
+{
+	test_matrix_copy_stream<grid, grid, M, N>();
+}
+
+SIMPLE_CASE( vec_copy_stream )
+{
+	// all combinations of lengths and (mis)alignments
+
+	const index_t maxlen = 40;
+	dblock<float> src(maxlen + 8);
+	dblock<float> dst(maxlen + 8);
+	for (index_t i = 0; i < src.nelems(); ++i) src[i] = float(i + 1);
+
+	for (index_t o = 0; o < 8; ++o)
+	{
+		for (index_t len = 0; len <= maxlen; ++len)
+		{
+			zero_vec(dst.nelems(), dst.ptr_data());
+			stream_copy_vec(len, src.ptr_data() + 1, dst.ptr_data() + o);
+
+			for (index_t i = 0; i < dst.nelems(); ++i)
+			{
+				float r = (i >= o && i < o + len) ? src[i - o + 1] : 0.f;
+				ASSERT_EQ(dst[i], r);
+			}
+		}
+	}
+}
+
+
 template<class S, class D>
 void safe_copy_triu(index_t m, index_t n, const S& smat, D& dmat, index_t k)
 {
@@ -282,6 +359,14 @@ AUTO_TPACK( mat_copy )
 	ADD_MN_CASE_3X3( mat_copy_grid_to_grid, 3, 4 )
 }
 
+AUTO_TPACK( mat_copy_stream )
+{
+	ADD_MN_CASE_3X3( mat_copy_stream_cont_to_cont, 3, 4 )
+	ADD_MN_CASE_3X3( mat_copy_stream_bloc_to_bloc, 3, 4 )
+	ADD_MN_CASE_3X3( mat_copy_stream_grid_to_grid, 3, 4 )
+	ADD_SIMPLE_CASE( vec_copy_stream )
+}
+
 AUTO_TPACK( mat_import )
 {
 	ADD_MN_CASE_3X3( mat_import_cont, 3, 4 )
@@ -72,6 +72,29 @@ void test_matrix_fill()
 }
 
 
+template<typename DTag, int M, int N>
+void test_matrix_fill_stream()
+{
+	const index_t m = M == 0 ? 3 : M;
+	const index_t n = N == 0 ? 4 : N;
+
+	typedef typename mat_host<DTag, double, M, N>::mat_t mat_t;
+	mat_host<DTag, double, M, N> dst(m, n);
+	dst.fill_lin();
+
+	mat_t dmat = dst.get_mat();
+
+	zero(dmat, stream_store_());
+	ASSERT_TRUE( verify_all_equal(dmat, 0.0) );
+
+	fill(dmat, 12.0, stream_store_());
+	ASSERT_TRUE( verify_all_equal(dmat, 12.0) );
+
+	fill(dmat, 3.0, cache_store_());
+	ASSERT_TRUE( verify_all_equal(dmat, 3.0) );
+}
+
+
 MN_CASE( mat_zero_cont )
 {
 	test_matrix_zero<cont, M, N>();
@@ -103,6 +126,46 @@ MN_CASE( mat_fill_grid )
 	test_matrix_fill<grid, M, N>();
 }
 
+MN_CASE( mat_fill_stream_cont )
+{
+	test_matrix_fill_stream<cont, M, N>();
+}
+
+MN_CASE( mat_fill_stream_bloc )
+{
+	test_matrix_fill_stream<bloc, M, N>();
+}
+
+MN_CASE( mat_fill_stream_grid )
+{
+	test_matrix_fill_stream<grid, M, N>();
+}
+
+SIMPLE_CASE( vec_fill_stream )
+{
+	// all combinations of lengths and (mis)alignments
+
+	const index_t maxlen = 40;
+	dblock<float> buf(maxlen + 8);
+
+	for (index_t o = 0; o < 8; ++o)
+	{
+		for (index_t len = 0; len <= maxlen; ++len)
+		{
+			fill_vec(buf.nelems(), buf.ptr_data(), -1.f);
+			stream_fill_vec(len, buf.ptr_data() + o, 2.5f);
+
+			for (index_t i = 0; i < buf.nelems(); ++i)
+				ASSERT_EQ(buf[i], (i >= o && i < o + len) ? 2.5f : -1.f);
+
+			stream_zero_vec(len, buf.ptr_data() + o);
+
+			for (index_t i = 0; i < buf.nelems(); ++i)
+				ASSERT_EQ(buf[i], (i >= o && i < o + len) ? 0.f : -1.f);
+		}
+	}
+}
+
 
 AUTO_TPACK( mat_zero )
 {
@@ -118,9 +181,11 @@ AUTO_TPACK( mat_fill )
 	ADD_MN_CASE_3X3( mat_fill_grid, 3, 4 )
 }
 
-
-
-
-
-
+AUTO_TPACK( mat_fill_stream )
+{
+	ADD_MN_CASE_3X3( mat_fill_stream_cont, 3, 4 )
+	ADD_MN_CASE_3X3( mat_fill_stream_bloc, 3, 4 )
+	ADD_MN_CASE_3X3( mat_fill_stream_grid, 3, 4 )
+	ADD_SIMPLE_CASE( vec_fill_stream )
+}
 
@@ -0,0 +1,355 @@
+/**
+ * @file test_mat_io.cpp
+ *
+ * @brief Unit testing for matrix file I/O
+ *
+ * @author Dahua Lin
+ */
+
+#include "../test_base.h"
+#include "../multimat_supp.h"
+
+#include <light_mat/matrix/matrix_io.h>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+using namespace lmat;
+using namespace lmat::test;
+
+const char *TXT_PATH = "test_mat_io.txt";
+const char *BIN_PATH = "test_mat_io.bin";
+
+void write_file(const char *path, const char *content)
+{
+	std::FILE *f = std::fopen(path, "wb");
+	std::fputs(content, f);
+	std::fclose(f);
+}
+
+template<class Mat1, class Mat2>
+bool same_mat(const Mat1& a, const Mat2& b)
+{
+	if (a.nrows() != b.nrows() || a.ncolumns() != b.ncolumns()) return false;
+	for (index_t j = 0; j < a.ncolumns(); ++j)
+		for (index_t i = 0; i < a.nrows(); ++i)
+			if (a(i, j) != b(i, j)) return false;
+	return true;
+}
+
+
+SIMPLE_CASE( parse_real_values )
+{
+	const char *strs[] = {
+		"0", "-0", "1", "-17", "+3.25", ".5", "5.", "0.05", "1e3", "1E+3", "-2.5e-3",
+		"123456789.123456789", "0.000000012345", "12345678901234567890",
+		"9007199254740993", "1e-300", "2.2250738585072014e-308", "1.7976931348623157e308",
+		"3.14159265358979323846", "00012.5000", "1e22", "1e23", "inf", "-inf" };
+
+	const int n = (int)(sizeof(strs) / sizeof(const char*));
+	for (int k = 0; k < n; ++k)
+	{
+		const char *s = strs[k];
+		const char *e = s + std::strlen(s);
+
+		double v = 0;
+		const char *r = internal::parse_real(s, e, v);
+		ASSERT_TRUE( r == e );
+		ASSERT_EQ( v, std::strtod(s, nullptr) );
+	}
+
+	// values printed with full precision are read back exactly
+
+	char buf[64];
+	for (int k = 0; k < 2000; ++k)
+	{
+		double x = (double(std::rand()) / RAND_MAX - 0.5) * std::pow(10.0, double(std::rand() % 40 - 20));
+		std::sprintf(buf, "%.17g", x);
+
+		double v = 0;
+		const char *e = buf + std::strlen(buf);
+		ASSERT_TRUE( internal::parse_real(buf, e, v) == e );
+		ASSERT_EQ( v, x );
+	}
+
+	const char *bad[] = { "", "-", ".", "abc", "1e", "e5" };
+	for (int k = 0; k < 6; ++k)
+	{
+		double v;
+		ASSERT_TRUE( internal::parse_real(bad[k], bad[k] + std::strlen(bad[k]), v) == nullptr );
+	}
+}
+
+SIMPLE_CASE( parse_float_values )
+{
+	// the last one is rounded to 1 if parsed through double
+
+	const char *strs[] = {
+		"0", "-17", "+3.25", ".1", "0.05", "1e10", "1e11", "-2.5e-3", "16777217",
+		"3.14159265358979323846", "1e-40", "3.4028234e38", "inf", "1.0000000596046448" };
+
+	const int n = (int)(sizeof(strs) / sizeof(const char*));
+	for (int k = 0; k < n; ++k)
+	{
+		const char *s = strs[k];
+		const char *e = s + std::strlen(s);
+
+		float v = 0;
+		const char *r = internal::parse_real(s, e, v);
+		ASSERT_TRUE( r == e );
+		ASSERT_EQ( v, std::strtof(s, nullptr) );
+	}
+
+	float v = 0;
+	const char *s = strs[n - 1];
+	internal::parse_real(s, s + std::strlen(s), v);
+	ASSERT_TRUE( v > 1.0f );
+
+	char buf[64];
+	for (int k = 0; k < 2000; ++k)
+	{
+		float x = float((double(std::rand()) / RAND_MAX - 0.5) * std::pow(10.0, double(std::rand() % 20 - 10)));
+		std::sprintf(buf, "%.9g", double(x));
+
+		float y = 0;
+		const char *e = buf + std::strlen(buf);
+		ASSERT_TRUE( internal::parse_real(buf, e, y) == e );
+		ASSERT_EQ( y, x );
+	}
+}
+
+SIMPLE_CASE( load_text_formats )
+{
+	write_file(TXT_PATH,
+		"# a comment\n"
+		"1, 2.5, -3\r\n"
+		"\n"
+		"4;5;6\n"
+		"  7\t 8   9e1\n"
+		"1e-2,1E2,+0.5");
+
+	dense_matrix<double> a;
+	load_text(TXT_PATH, a);
+
+	ASSERT_EQ( a.nrows(), 4 );
+	ASSERT_EQ( a.ncolumns(), 3 );
+
+	const double r[12] = {1, 4, 7, 0.01, 2.5, 5, 8, 100, -3, 6, 90, 0.5};
+	ASSERT_VEC_EQ( 12, a, r );
+
+	write_file(TXT_PATH, "1\t2\n3\t 4\n");
+
+	dense_matrix<float> b;
+	load_text(TXT_PATH, b, '\t');
+	ASSERT_EQ( b.nrows(), 2 );
+	ASSERT_EQ( b.ncolumns(), 2 );
+	ASSERT_EQ( b(1, 1), 4.0f );
+
+	write_file(TXT_PATH, "");
+	load_text(TXT_PATH, a);
+	ASSERT_EQ( a.nelems(), 0 );
+}
+
+SIMPLE_CASE( load_text_errors )
+{
+	dense_matrix<double> a;
+
+	const char *bad[] = { "1,2\n3\n", "1,2\n3,4,5\n", "1,2\n3,x\n", "1,,2\n", "1 2,\n" };
+	for (int k = 0; k < 5; ++k)
+	{
+		write_file(TXT_PATH, bad[k]);
+
+		bool thrown = false;
+		try { load_text(TXT_PATH, a); }
+		catch (io_error& ) { thrown = true; }
+		ASSERT_TRUE( thrown );
+	}
+
+	bool thrown = false;
+	try { load_text("no/such/file.txt", a); }
+	catch (io_error& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+}
+
+SIMPLE_CASE( load_text_unsized )
+{
+#if LIGHTMAT_PLATFORM == LIGHTMAT_POSIX
+	// files in /proc report a size of 0, but are not empty
+
+	const char *path = "/proc/sys/kernel/pid_max";
+	std::FILE *f = std::fopen(path, "rb");
+	if (!f) return;
+	std::fclose(f);
+
+	dense_matrix<int32_t> a;
+	load_text(path, a);
+	ASSERT_EQ( a.nrows(), 1 );
+	ASSERT_EQ( a.ncolumns(), 1 );
+	ASSERT_TRUE( a[0] > 0 );
+#endif
+}
+
+SIMPLE_CASE( text_roundtrip )
+{
+	// large enough to be parsed by all threads
+
+	const index_t m = 30000;
+	const index_t n = 7;
+
+	dense_matrix<double> a(m, n);
+	do_fill_rand(a.ptr_data(), m * n, -1.0e3, 1.0e3);
+	a(3, 2) = 0;
+	a(5, 4) = 1.0e-200;
+
+	save_text(TXT_PATH, a);
+	dense_matrix<double> b;
+	load_text(TXT_PATH, b);
+	ASSERT_TRUE( same_mat(a, b) );
+
+	save_text(TXT_PATH, a, ' ', 6);
+	load_text(TXT_PATH, b);
+	ASSERT_EQ( b.nrows(), m );
+	ASSERT_EQ( b.ncolumns(), n );
+	for (index_t i = 0; i < m * n; ++i) ASSERT_APPROX( b[i], a[i], 1.0e-2 );
+
+	// more digits than a double has
+
+	save_text(TXT_PATH, a, ',', 60);
+	load_text(TXT_PATH, b);
+	ASSERT_TRUE( same_mat(a, b) );
+
+	dense_matrix<int32_t> c(5, 3);
+	for (index_t i = 0; i < 15; ++i) c[i] = (int32_t)(i * 1234567 - 9000000);
+
+	save_text(TXT_PATH, c, '\t');
+	dense_matrix<int32_t> d;
+	load_text(TXT_PATH, d);
+	ASSERT_TRUE( same_mat(c, d) );
+
+	dense_matrix<float> e(20, 3);
+	do_fill_rand(e.ptr_data(), 60);
+	save_text(TXT_PATH, e);
+	dense_matrix<float> f;
+	load_text(TXT_PATH, f);
+	ASSERT_TRUE( same_mat(e, f) );
+}
+
+SIMPLE_CASE( binary_roundtrip )
+{
+	dense_matrix<double> a(123, 45);
+	do_fill_rand(a.ptr_data(), a.nelems());
+
+	save_binary(BIN_PATH, a);
+	dense_matrix<double> b;
+	load_binary(BIN_PATH, b);
+	ASSERT_TRUE( same_mat(a, b) );
+
+	dense_matrix<int16_t> c(3, 4);
+	for (index_t i = 0; i < 12; ++i) c[i] = (int16_t)(i - 6);
+	save_binary(BIN_PATH, c);
+
+	dense_matrix<int16_t> d;
+	load_binary(BIN_PATH, d);
+	ASSERT_TRUE( same_mat(c, d) );
+
+	// the element type must match
+
+	dense_matrix<int32_t> w;
+	bool thrown = false;
+	try { load_binary(BIN_PATH, w); }
+	catch (io_error& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	// a text file is not a matrix file
+
+	write_file(BIN_PATH, "1,2,3\n4,5,6\n7,8,9\n10,11,12\n13,14,15\n");
+	thrown = false;
+	try { load_binary(BIN_PATH, d); }
+	catch (io_error& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	std::remove(TXT_PATH);
+	std::remove(BIN_PATH);
+}
+
+void write_binary(const char *path, int64_t m, int64_t n, size_t nb)
+{
+	internal::binary_header h;
+	h.dtype = internal::io_dtype<double>::code;
+	h.elem_size = (uint32_t)sizeof(double);
+	h.nrows = m;
+	h.ncols = n;
+
+	char hbuf[internal::binary_header_size];
+	internal::encode_binary_header(h, hbuf);
+
+	std::vector<char> data(nb, 0);
+	std::FILE *f = std::fopen(path, "wb");
+	std::fwrite(hbuf, 1, sizeof(hbuf), f);
+	if (nb > 0) std::fwrite(&data[0], 1, nb, f);
+	std::fclose(f);
+}
+
+bool load_binary_fails(const char *path)
+{
+	dense_matrix<double> a;
+	try { load_binary(path, a); }
+	catch (io_error& ) { return true; }
+	return false;
+}
+
+SIMPLE_CASE( binary_bad_headers )
+{
+	const int64_t max_dim = (int64_t)std::numeric_limits<index_t>::max();
+
+	// the shape is checked before anything is allocated
+
+	write_binary(BIN_PATH, -1, 3, 0);
+	ASSERT_TRUE( load_binary_fails(BIN_PATH) );
+
+	write_binary(BIN_PATH, 3, -2, 0);
+	ASSERT_TRUE( load_binary_fails(BIN_PATH) );
+
+	write_binary(BIN_PATH, max_dim, max_dim, 16);
+	ASSERT_TRUE( load_binary_fails(BIN_PATH) );
+
+	write_binary(BIN_PATH, int64_t(1) << 40, int64_t(1) << 40, 16);
+	ASSERT_TRUE( load_binary_fails(BIN_PATH) );
+
+	write_binary(BIN_PATH, int64_t(1) << 30, int64_t(1) << 30, 16);
+	ASSERT_TRUE( load_binary_fails(BIN_PATH) );
+
+	// the data must be exactly that of the shape
+
+	write_binary(BIN_PATH, 4, 5, 20 * sizeof(double) - 1);
+	ASSERT_TRUE( load_binary_fails(BIN_PATH) );
+
+	write_binary(BIN_PATH, 4, 5, 20 * sizeof(double) + 8);
+	ASSERT_TRUE( load_binary_fails(BIN_PATH) );
+
+	write_binary(BIN_PATH, 4, 5, 20 * sizeof(double));
+	ASSERT_FALSE( load_binary_fails(BIN_PATH) );
+
+	write_binary(BIN_PATH, 0, 5, 0);
+	ASSERT_FALSE( load_binary_fails(BIN_PATH) );
+
+	std::remove(BIN_PATH);
+}
+
+
+AUTO_TPACK( mat_text_io )
+{
+	ADD_SIMPLE_CASE( parse_real_values )
+	ADD_SIMPLE_CASE( parse_float_values )
+	ADD_SIMPLE_CASE( load_text_formats )
+	ADD_SIMPLE_CASE( load_text_errors )
+	ADD_SIMPLE_CASE( load_text_unsized )
+	ADD_SIMPLE_CASE( text_roundtrip )
+}
+
+AUTO_TPACK( mat_binary_io )
+{
+	ADD_SIMPLE_CASE( binary_roundtrip )
+	ADD_SIMPLE_CASE( binary_bad_headers )
+}
@@ -0,0 +1,236 @@
+/**
+ * @file test_numa.cpp
+ *
+ * Unit testing of NUMA-aware allocation and parallel first touch
+ *
+ * @author Dahua Lin
+ */
+
+#include "../test_base.h"
+
+#include <light_mat/matrix/dense_matrix.h>
+#include <vector>
+
+using namespace lmat;
+using namespace lmat::test;
+
+// large enough for the parallel initialization (8 MB)
+
+const index_t M = 1000;
+const index_t N = 1031;
+
+typedef dense_matrix<double, 0, 0, numa_allocator<double> > ft_mat;
+typedef dense_matrix<double, 0, 0, numa_allocator<double, numa_interleave> > il_mat;
+typedef dense_matrix<double, 0, 0, numa_allocator<double, numa_bind_columns> > bc_mat;
+
+template class lmat::dense_matrix<double, 0, 0, numa_allocator<double> >;
+
+// an allocator that counts the placements of its memory
+
+static int g_nplaced = 0;
+
+template<typename T>
+class counted_allocator : public aligned_allocator<T>
+{
+public:
+	template<typename TOther>
+	struct rebind
+	{
+		typedef counted_allocator<TOther> other;
+	};
+
+	counted_allocator() { }
+
+	template<typename U>
+	counted_allocator(const counted_allocator<U>& ) { }
+};
+
+namespace lmat
+{
+	template<typename T>
+	struct allocator_placement<counted_allocator<T> >
+	{
+		static const bool first_touch = false;
+
+		static void prepare(T *, index_t, index_t) { ++ g_nplaced; }
+	};
+}
+
+
+SIMPLE_CASE( numa_nodes )
+{
+	index_t nn = numa_num_nodes();
+	ASSERT_TRUE( nn >= 1 );
+
+	index_t c = numa_current_node();
+	ASSERT_TRUE( c >= 0 && c < nn );
+}
+
+SIMPLE_CASE( numa_column_slabs )
+{
+	const index_t ns[] = {0, 1, 5, 16, 37};
+	const index_t nts[] = {1, 2, 3, 8, 40};
+
+	for (int a = 0; a < 5; ++a)
+	{
+		for (int b = 0; b < 5; ++b)
+		{
+			const index_t n = ns[a];
+			const index_t nt = nts[b];
+
+			index_t next = 0;
+			for (index_t t = 0; t < nt; ++t)
+			{
+				index_t j0, nj;
+				internal::static_column_slab(n, nt, t, j0, nj);
+
+				ASSERT_EQ( j0, next );
+				ASSERT_TRUE( nj == n / nt || nj == n / nt + 1 );
+				next = j0 + nj;
+			}
+			ASSERT_EQ( next, n );
+		}
+	}
+}
+
+SIMPLE_CASE( numa_interleave_pages )
+{
+	const size_t nb = 64 * internal::numa_page_size;
+	numa_allocator<char, numa_interleave> alloc;
+	char *p = alloc.allocate(nb);
+
+	ASSERT_EQ( (size_t)p % internal::numa_page_size, 0 );
+
+	// the policy may be refused (e.g. in a restricted container)
+	if (numa_set_interleave(p, nb))
+	{
+		ASSERT_EQ( numa_mode_of(p), 3 );
+	}
+
+	p[0] = 1;
+	ASSERT_TRUE( numa_node_of(p) < numa_num_nodes() );
+
+	alloc.deallocate(p, nb);
+}
+
+SIMPLE_CASE( numa_mapped_blocks )
+{
+	// blocks of a page or more have pages of their own
+
+	numa_allocator<double, numa_bind_columns> alloc;
+	const size_t n = 3 * internal::numa_page_size / sizeof(double) + 7;
+	double *p = alloc.allocate(n);
+	ASSERT_EQ( (size_t)p % internal::numa_page_size, 0 );
+	p[n - 1] = 1.0;
+	alloc.deallocate(p, n);
+}
+
+SIMPLE_CASE( numa_place_fresh_only )
+{
+	typedef dense_matrix<double, 0, 0, counted_allocator<double> > mat_t;
+
+	g_nplaced = 0;
+	mat_t a(4, 6);
+	ASSERT_EQ( g_nplaced, 1 );
+
+	// the same number of elements: the memory is reused, as placed
+
+	a.require_size(6, 4);
+	ASSERT_EQ( g_nplaced, 1 );
+
+	a.require_size(5, 5);
+	ASSERT_EQ( g_nplaced, 2 );
+}
+
+template<class Mat>
+void verify_numa_mat()
+{
+	Mat a(M, N);
+	ASSERT_EQ( (size_t)a.ptr_data() % internal::numa_page_size, 0 );
+	for (index_t i = 0; i < M * N; ++i) ASSERT_EQ( a[i], 0.0 );
+
+	Mat b(M, N, fill(2.5));
+	for (index_t i = 0; i < M * N; ++i) ASSERT_EQ( b[i], 2.5 );
+
+	for (index_t i = 0; i < M * N; ++i) b[i] = double(i % 101);
+	Mat c(b);
+	for (index_t i = 0; i < M * N; ++i) ASSERT_EQ( c[i], b[i] );
+
+	dense_matrix<double> d(b);
+	for (index_t i = 0; i < M * N; ++i) ASSERT_EQ( d[i], b[i] );
+
+	c.require_size(M, N - 1);
+	ASSERT_EQ( c.ncolumns(), N - 1 );
+}
+
+SIMPLE_CASE( numa_first_touch_mat )
+{
+	verify_numa_mat<ft_mat>();
+}
+
+SIMPLE_CASE( numa_interleave_mat )
+{
+	verify_numa_mat<il_mat>();
+}
+
+SIMPLE_CASE( numa_bind_columns_mat )
+{
+	verify_numa_mat<bc_mat>();
+}
+
+SIMPLE_CASE( numa_parallel_fill_copy )
+{
+	ft_mat a(M, N);
+	dense_matrix<double> b(M, N);
+
+	fill(a, 3.0);
+	for (index_t i = 0; i < M * N; ++i) ASSERT_EQ( a[i], 3.0 );
+
+	for (index_t i = 0; i < M * N; ++i) a[i] = double(i % 97);
+	copy(a, b);
+	for (index_t i = 0; i < M * N; ++i) ASSERT_EQ( b[i], a[i] );
+
+	copy(a, b, stream_store_());
+	for (index_t i = 0; i < M * N; ++i) ASSERT_EQ( b[i], a[i] );
+
+	// the shapes are checked before the copy is split into column slabs
+
+	dense_matrix<double> c(M - 1, N);
+	bool thrown = false;
+	try { copy(c, b); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	dense_matrix<double> d(M, N - 1);
+	thrown = false;
+	try { copy(d, b, stream_store_()); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+
+	zero(b);
+	for (index_t i = 0; i < M * N; ++i) ASSERT_EQ( b[i], 0.0 );
+
+	fill(b, 1.5, stream_store_());
+	for (index_t i = 0; i < M * N; ++i) ASSERT_EQ( b[i], 1.5 );
+
+	zero(a, stream_store_());
+	for (index_t i = 0; i < M * N; ++i) ASSERT_EQ( a[i], 0.0 );
+}
+
+
+AUTO_TPACK( numa_base )
+{
+	ADD_SIMPLE_CASE( numa_nodes )
+	ADD_SIMPLE_CASE( numa_column_slabs )
+	ADD_SIMPLE_CASE( numa_interleave_pages )
+	ADD_SIMPLE_CASE( numa_mapped_blocks )
+	ADD_SIMPLE_CASE( numa_place_fresh_only )
+}
+
+AUTO_TPACK( numa_mat )
+{
+	ADD_SIMPLE_CASE( numa_first_touch_mat )
+	ADD_SIMPLE_CASE( numa_interleave_mat )
+	ADD_SIMPLE_CASE( numa_bind_columns_mat )
+	ADD_SIMPLE_CASE( numa_parallel_fill_copy )
+}
@@ -0,0 +1,203 @@
+/**
+ * @file test_ref_mat_rm.cpp
+ *
+ * Unit testing of row-major views (cref/ref_matrix_rm and cref/ref_block_rm)
+ *
+ * @author Dahua Lin
+ */
+
+#include "../test_base.h"
+
+#include <light_mat/matrix/ref_matrix_rm.h>
+#include <light_mat/matrix/dense_matrix.h>
+#include <light_mat/common/block.h>
+
+using namespace lmat;
+using namespace lmat::test;
+
+
+// explicit instantiation
+
+template class lmat::cref_matrix_rm<double, 0, 0>;
+template class lmat::cref_matrix_rm<double, 0, 4>;
+template class lmat::cref_matrix_rm<double, 3, 0>;
+template class lmat::cref_matrix_rm<double, 3, 4>;
+
+template class lmat::ref_matrix_rm<double, 0, 0>;
+template class lmat::ref_matrix_rm<double, 0, 4>;
+template class lmat::ref_matrix_rm<double, 3, 0>;
+template class lmat::ref_matrix_rm<double, 3, 4>;
+
+template class lmat::cref_block_rm<double, 0, 0>;
+template class lmat::cref_block_rm<double, 0, 4>;
+template class lmat::cref_block_rm<double, 3, 0>;
+template class lmat::cref_block_rm<double, 3, 4>;
+
+template class lmat::ref_block_rm<double, 0, 0>;
+template class lmat::ref_block_rm<double, 0, 4>;
+template class lmat::ref_block_rm<double, 3, 0>;
+template class lmat::ref_block_rm<double, 3, 4>;
+
+static_assert(lmat::meta::is_regular_mat<lmat::cref_matrix_rm<double> >::value, "Interface verification failed.");
+static_assert(lmat::meta::is_regular_mat<lmat::ref_matrix_rm<double> >::value, "Interface verification failed.");
+static_assert(lmat::meta::is_regular_mat<lmat::cref_block_rm<double> >::value, "Interface verification failed.");
+static_assert(lmat::meta::is_regular_mat<lmat::ref_block_rm<double> >::value, "Interface verification failed.");
+
+static_assert(lmat::meta::is_perrow_contiguous<lmat::cref_matrix_rm<double> >::value, "Layout verification failed.");
+static_assert(!lmat::meta::is_percol_contiguous<lmat::cref_matrix_rm<double> >::value, "Layout verification failed.");
+static_assert(lmat::meta::is_contiguous<lmat::cref_matrix_rm<double, 1, 0> >::value, "Layout verification failed.");
+static_assert(lmat::meta::is_percol_contiguous<lmat::cref_matrix_rm<double, 1, 0> >::value, "Layout verification failed.");
+static_assert(lmat::meta::is_percol_contiguous<lmat::cref_matrix_rm<double, 0, 1> >::value, "Layout verification failed.");
+static_assert(lmat::meta::is_perrow_contiguous<lmat::cref_block_rm<double> >::value, "Layout verification failed.");
+static_assert(!lmat::meta::is_percol_contiguous<lmat::cref_block_rm<double, 0, 1> >::value, "Layout verification failed.");
+
+
+template<class Mat>
+inline void verify_layout(const Mat& a, index_t m, index_t n, index_t ldim)
+{
+	ASSERT_EQ(a.nrows(), m);
+	ASSERT_EQ(a.ncolumns(), n);
+	ASSERT_EQ(a.nelems(), m * n);
+	ASSERT_EQ(a.row_stride(), ldim);
+	ASSERT_EQ(a.col_stride(), 1);
+}
+
+template<class Mat>
+inline void verify_access(const Mat& a, const double *ref, index_t m, index_t n, index_t ldim)
+{
+	for (index_t i = 0; i < m; ++i)
+	{
+		ASSERT_EQ(a.ptr_row(i), a.ptr_data() + i * ldim);
+
+		for (index_t j = 0; j < n; ++j)
+		{
+			ASSERT_EQ( a.elem(i, j), ref[i * ldim + j] );
+			ASSERT_EQ( a(i, j), ref[i * ldim + j] );
+		}
+	}
+
+	if (meta::is_vector<Mat>::value)
+	{
+		for (index_t k = 0; k < m * n; ++k)
+		{
+			ASSERT_EQ( a[k], ref[n == 1 ? k * ldim : k] );
+		}
+	}
+}
+
+
+MN_CASE( ref_mat_rm_access )
+{
+	const index_t m = M == 0 ? 3 : M;
+	const index_t n = N == 0 ? 4 : N;
+
+	dblock<double> s(m * n);
+	for (index_t i = 0; i < m * n; ++i) s[i] = double(i + 2);
+
+	cref_matrix_rm<double, M, N> a(s.ptr_data(), m, n);
+	verify_layout(a, m, n, n);
+	ASSERT_EQ(a.ptr_data(), s.ptr_data());
+	verify_access(a, s.ptr_data(), m, n, n);
+
+	ref_matrix_rm<double, M, N> b(s.ptr_data(), m, n);
+	verify_layout(b, m, n, n);
+	ASSERT_EQ(b.ptr_data(), s.ptr_data());
+	verify_access(b, s.ptr_data(), m, n, n);
+}
+
+MN_CASE( ref_block_rm_access )
+{
+	const index_t ldim = 7;
+	const index_t m = M == 0 ? 3 : M;
+	const index_t n = N == 0 ? 4 : N;
+
+	dblock<double> s(ldim * m);
+	for (index_t i = 0; i < ldim * m; ++i) s[i] = double(i + 2);
+
+	cref_block_rm<double, M, N> a(s.ptr_data(), m, n, ldim);
+	verify_layout(a, m, n, ldim);
+	ASSERT_EQ(a.ptr_data(), s.ptr_data());
+	verify_access(a, s.ptr_data(), m, n, ldim);
+
+	ref_block_rm<double, M, N> b(s.ptr_data(), m, n, ldim);
+	verify_layout(b, m, n, ldim);
+	ASSERT_EQ(b.ptr_data(), s.ptr_data());
+	verify_access(b, s.ptr_data(), m, n, ldim);
+}
+
+MN_CASE( ref_block_rm_assign )
+{
+	const index_t ldim = 7;
+	const index_t m = M == 0 ? 3 : M;
+	const index_t n = N == 0 ? 4 : N;
+
+	dense_matrix<double, M, N> c(m, n);
+	for (index_t i = 0; i < m * n; ++i) c[i] = double(i + 2);
+
+	// column-major -> row-major
+
+	dblock<double> s(ldim * m, fill(-1.0));
+	ref_block_rm<double, M, N> a(s.ptr_data(), m, n, ldim);
+	a = c;
+
+	dblock<double> r(ldim * m, fill(-1.0));
+	for (index_t i = 0; i < m; ++i)
+		for (index_t j = 0; j < n; ++j) r[i * ldim + j] = c(i, j);
+
+	ASSERT_VEC_EQ(ldim * m, s, r);
+
+	// row-major -> column-major
+
+	dense_matrix<double, M, N> c2(m, n, zero());
+	c2 = a;
+	ASSERT_MAT_EQ(m, n, c2, c);
+
+	// row-major -> row-major
+
+	dblock<double> s2(m * n);
+	ref_matrix_rm<double, M, N> b(s2.ptr_data(), m, n);
+	b = a;
+	ASSERT_MAT_EQ(m, n, b, c);
+}
+
+MN_CASE( rm_trans_view )
+{
+	const index_t ldim = 7;
+	const index_t m = M == 0 ? 3 : M;
+	const index_t n = N == 0 ? 4 : N;
+
+	dblock<double> s(ldim * m);
+	for (index_t i = 0; i < ldim * m; ++i) s[i] = double(i + 2);
+
+	cref_block_rm<double, M, N> a(s.ptr_data(), m, n, ldim);
+	cref_block<double, N, M> t = trans_view(a);
+
+	ASSERT_EQ(t.nrows(), n);
+	ASSERT_EQ(t.ncolumns(), m);
+	ASSERT_EQ(t.ptr_data(), a.ptr_data());
+
+	for (index_t i = 0; i < m; ++i)
+		for (index_t j = 0; j < n; ++j)
+			ASSERT_EQ(t(j, i), a(i, j));
+}
+
+
+AUTO_TPACK( ref_mat_rm_access )
+{
+	ADD_MN_CASE_3X3( ref_mat_rm_access, 3, 4 )
+}
+
+AUTO_TPACK( ref_block_rm_access )
+{
+	ADD_MN_CASE_3X3( ref_block_rm_access, 3, 4 )
+}
+
+AUTO_TPACK( ref_block_rm_assign )
+{
+	ADD_MN_CASE_3X3( ref_block_rm_assign, 3, 4 )
+}
+
+AUTO_TPACK( rm_trans_view )
+{
+	ADD_MN_CASE_3X3( rm_trans_view, 3, 4 )
+}
@@ -0,0 +1,327 @@
+/**
+ * @file test_counter_stream.cpp
+ *
+ * @brief Test of counter-based random streams (Philox & Threefry)
+ *
+ * @author Dahua Lin
+ */
+
+#include "../test_base.h"
+
+#include <light_mat/matrix/matrix_classes.h>
+#include <light_mat/random/philox.h>
+#include <light_mat/random/threefry.h>
+#include <light_mat/random/rand_expr.h>
+
+using namespace lmat;
+using namespace lmat::random;
+using namespace lmat::test;
+
+
+const index_t vlen = 1000;
+const uint64_t seed0 = 1234;
+
+// Known-answer tests (from the Random123 distribution)
+
+const uint32_t kat_ctrs[3][4] = {
+	{0x00000000, 0x00000000, 0x00000000, 0x00000000},
+	{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+	{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344} };
+
+const uint32_t kat_philox_keys[3][2] = {
+	{0x00000000, 0x00000000},
+	{0xffffffff, 0xffffffff},
+	{0xa4093822, 0x299f31d0} };
+
+const uint32_t kat_philox_outs[3][4] = {
+	{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+	{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+	{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1} };
+
+const uint32_t kat_threefry_keys[3][4] = {
+	{0x00000000, 0x00000000, 0x00000000, 0x00000000},
+	{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+	{0xa4093822, 0x299f31d0, 0x082efa98, 0xec4e6c89} };
+
+const uint32_t kat_threefry_outs[3][4] = {
+	{0x9c6ca96a, 0xe17eae66, 0xfc10ecd4, 0x5256a7d8},
+	{0x2a881696, 0x57012287, 0xf6c7446e, 0xa16a6732},
+	{0x59cd1dbb, 0xb8879579, 0x86b5d00c, 0xac8b6d84} };
+
+
+SIMPLE_CASE( philox_kat )
+{
+	philox4x32_engine eng(0);
+	uint32_t r[4];
+
+	for (int i = 0; i < 3; ++i)
+	{
+		eng.set_key(kat_philox_keys[i]);
+		eng.block(kat_ctrs[i], r);
+		ASSERT_VEC_EQ(4, r, kat_philox_outs[i]);
+	}
+}
+
+SIMPLE_CASE( threefry_kat )
+{
+	threefry4x32_engine eng(0);
+	uint32_t r[4];
+
+	for (int i = 0; i < 3; ++i)
+	{
+		eng.set_key(kat_threefry_keys[i]);
+		eng.block(kat_ctrs[i], r);
+		ASSERT_VEC_EQ(4, r, kat_threefry_outs[i]);
+	}
+}
+
+
+template<class Engine>
+void verify_generate4()
+{
+	Engine eng(seed0);
+
+	const int npos = 4;
+	const uint64_t poss[npos] = {0, 6, 0xfffffffeULL, 0x123456789aULL};
+	const uint64_t sid = 0x9876543210ULL;
+
+	LMAT_ALIGN(16) uint32_t x[16];
+	uint32_t ctr[4];
+	uint32_t r[4];
+
+	for (int i = 0; i < npos; ++i)
+	{
+		eng.generate4(poss[i], sid, x);
+
+		for (unsigned k = 0; k < 4; ++k)
+		{
+			uint64_t p = poss[i] + k;
+			ctr[0] = (uint32_t)p;
+			ctr[1] = (uint32_t)(p >> 32);
+			ctr[2] = (uint32_t)sid;
+			ctr[3] = (uint32_t)(sid >> 32);
+
+			eng.block(ctr, r);
+			ASSERT_VEC_EQ(4, x + k * 4, r);
+		}
+	}
+}
+
+
+template<class Engine>
+void verify_u64()
+{
+	counter_rand_stream<Engine> rs(seed0);
+
+	dense_col<uint32_t> v32(vlen);
+	for (index_t i = 0; i < vlen; ++i) v32[i] = rs.rand_u32();
+
+	rs.set_seed(seed0);
+	rs.rand_u32(); // ignore one unit
+
+	for (index_t i = 0; i < vlen / 2 - 1; ++i)
+	{
+		uint64_t x = rs.rand_u64();
+		uint64_t x0 = (uint64_t)v32[2 * i + 2] | ((uint64_t)v32[2 * i + 3] << 32);
+		ASSERT_EQ( x, x0 );
+	}
+}
+
+
+template<class Engine>
+void verify_m128()
+{
+	counter_rand_stream<Engine> rs(seed0);
+
+	dense_col<uint32_t> v32(vlen);
+	for (index_t i = 0; i < vlen; ++i) v32[i] = rs.rand_u32();
+
+	LMAT_ALIGN(16) uint32_t x[4];
+
+	for (index_t o = 0; o < 4; ++o)
+	{
+		rs.set_seed(seed0);
+		for (index_t j = 0; j < o; ++j) rs.rand_u32(); // ignore o units
+
+		index_t i0 = o > 0 ? 1 : 0;
+		for (index_t i = i0; i < vlen / 4; ++i)
+		{
+			__m128i p = rs.rand_pack(sse_t());
+			_mm_store_si128(reinterpret_cast<__m128i*>(x), p);
+			ASSERT_VEC_EQ(4, x, &v32[i * 4]);
+		}
+	}
+}
+
+#ifdef LMAT_HAS_AVX
+
+template<class Engine>
+void verify_m256()
+{
+	counter_rand_stream<Engine> rs(seed0);
+
+	dense_col<uint32_t> v32(vlen);
+	for (index_t i = 0; i < vlen; ++i) v32[i] = rs.rand_u32();
+
+	LMAT_ALIGN(32) uint32_t x[8];
+
+	for (index_t o = 0; o < 8; ++o)
+	{
+		rs.set_seed(seed0);
+		for (index_t j = 0; j < o; ++j) rs.rand_u32(); // ignore o units
+
+		index_t i0 = o > 0 ? 1 : 0;
+		for (index_t i = i0; i < vlen / 8; ++i)
+		{
+			__m256i p = rs.rand_pack(avx_t());
+			_mm256_store_si256(reinterpret_cast<__m256i*>(x), p);
+			ASSERT_VEC_EQ(8, x, &v32[i * 8]);
+		}
+	}
+}
+
+#endif
+
+
+template<class Engine>
+void verify_seq()
+{
+	counter_rand_stream<Engine> rs(seed0);
+
+	const int nstarts = 4;
+	const index_t starts[nstarts] = {0, 3, 16, 21};
+
+	const int nlens = 5;
+	const index_t lens[nlens] = {3, 16, 37, 64, 333};
+
+	for (int i = 0; i < nstarts; ++i)
+	{
+		for (int j = 0; j < nlens; ++j)
+		{
+			index_t n = lens[j];
+			dense_col<uint32_t> r(n * 2);
+			dense_col<uint32_t> x(n * 2, zero());
+
+			rs.set_seed(seed0);
+			for (index_t k = 0; k < starts[i]; ++k) rs.rand_u32();
+			for (index_t k = 0; k < n * 2; ++k) r[k] = rs.rand_u32();
+
+			rs.set_seed(seed0);
+			for (index_t k = 0; k < starts[i]; ++k) rs.rand_u32();
+			rs.rand_seq((size_t)n * sizeof(uint32_t), x.ptr_data());
+			rs.rand_seq((size_t)n * sizeof(uint32_t), x.ptr_data() + n);
+
+			ASSERT_VEC_EQ(n * 2, x, r);
+		}
+	}
+}
+
+
+template<class Engine>
+void verify_seek()
+{
+	counter_rand_stream<Engine> rs(seed0);
+
+	dense_col<uint32_t> v32(vlen);
+	for (index_t i = 0; i < vlen; ++i) v32[i] = rs.rand_u32();
+	ASSERT_EQ( rs.position(), (uint64_t)vlen );
+
+	const int nposs = 6;
+	const index_t poss[nposs] = {0, 1, 15, 16, 333, 800};
+
+	for (int i = 0; i < nposs; ++i)
+	{
+		rs.seek((uint64_t)poss[i]);
+		ASSERT_EQ( rs.position(), (uint64_t)poss[i] );
+
+		for (index_t k = poss[i]; k < poss[i] + 20; ++k)
+			ASSERT_EQ( rs.rand_u32(), v32[k] );
+
+		rs.discard(7);
+		ASSERT_EQ( rs.position(), (uint64_t)(poss[i] + 27) );
+		ASSERT_EQ( rs.rand_u32(), v32[poss[i] + 27] );
+	}
+
+	// a different stream id yields a different sequence
+
+	counter_rand_stream<Engine> rs2(seed0, 1);
+	ASSERT_EQ( rs2.stream_id(), uint64_t(1) );
+
+	index_t c = 0;
+	for (index_t i = 0; i < vlen; ++i)
+	{
+		if (rs2.rand_u32() == v32[i]) ++c;
+	}
+	ASSERT_TRUE( c < 5 );
+
+	rs2.set_stream_id(0);
+	for (index_t i = 0; i < vlen; ++i)
+		ASSERT_EQ( rs2.rand_u32(), v32[i] );
+}
+
+
+template<class Engine>
+void verify_rand_expr()
+{
+	typedef counter_rand_stream<Engine> stream_t;
+
+	const index_t m = 37;
+	const index_t n = 5;
+
+	stream_t rs(seed0);
+
+	dense_matrix<double> a = randu(rs, m, n);
+	dense_matrix<double> b = randu(rs, m, n);
+
+	// each column comes from its own window of the stream
+
+	stream_t rs0(seed0);
+
+	for (index_t j = 0; j < n; ++j)
+	{
+		stream_t rj(rs0);
+		rj.seek((uint64_t)j * lmat::internal::rand_column_span);
+
+		dense_col<double> c = randu(rj, m, 1);
+		ASSERT_VEC_EQ( m, a.column(j), c );
+	}
+
+	ASSERT_EQ( rs.position(), (uint64_t)(2 * n) * lmat::internal::rand_column_span );
+
+	// deterministic
+
+	stream_t rs1(seed0);
+	dense_matrix<double> a1 = randu(rs1, m, n);
+	dense_matrix<double> b1 = randu(rs1, m, n);
+
+	ASSERT_MAT_EQ( m, n, a, a1 );
+	ASSERT_MAT_EQ( m, n, b, b1 );
+}
+
+
+#define DEF_COUNTER_STREAM_TESTS( packname, tfunname ) \
+		SIMPLE_CASE( packname##_philox ) { tfunname<philox4x32_engine>(); } \
+		SIMPLE_CASE( packname##_threefry ) { tfunname<threefry4x32_engine>(); } \
+		AUTO_TPACK( packname ) { \
+			ADD_SIMPLE_CASE( packname##_philox ) \
+			ADD_SIMPLE_CASE( packname##_threefry ) \
+		}
+
+AUTO_TPACK( counter_kat )
+{
+	ADD_SIMPLE_CASE( philox_kat )
+	ADD_SIMPLE_CASE( threefry_kat )
+}
+
+DEF_COUNTER_STREAM_TESTS( counter_generate4, verify_generate4 )
+DEF_COUNTER_STREAM_TESTS( counter_u64, verify_u64 )
+DEF_COUNTER_STREAM_TESTS( counter_m128, verify_m128 )
+
+#ifdef LMAT_HAS_AVX
+DEF_COUNTER_STREAM_TESTS( counter_m256, verify_m256 )
+#endif
+
+DEF_COUNTER_STREAM_TESTS( counter_seq, verify_seq )
+DEF_COUNTER_STREAM_TESTS( counter_seek, verify_seek )
+DEF_COUNTER_STREAM_TESTS( counter_rand_expr, verify_rand_expr )
+
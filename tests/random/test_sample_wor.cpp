@@ -9,6 +9,10 @@
 
 #include "distr_test_base.h"
 #include <light_mat/random/sample_wor.h>
+#include <light_mat/random/philox.h>
+
+#include <algorithm>
+#include <vector>
 
 
 default_rand_stream rstream;
@@ -81,6 +85,326 @@ T_CASE( test_past_avoider )
 }
 
 
+// bulk sampling
+
+// frequencies of each value at each position, which are all 1 / n
+// for a uniform ordered sample
+
+template<class Sampler>
+void test_ordered_sample(index_t n, index_t k, Sampler sampler)
+{
+	dense_matrix<uint32_t> cnts(k, n, zero());
+	dense_col<int32_t> r(k);
+	dense_col<bool> visited(n);
+
+	for (index_t t = 0; t < N; ++t)
+	{
+		sampler(n, r);
+
+		zero(visited);
+		for (index_t j = 0; j < k; ++j)
+		{
+			index_t x = (index_t)r[j];
+			ASSERT_TRUE( x >= 0 && x < n );
+			ASSERT_FALSE( visited[x] );
+			visited[x] = true;
+			++ cnts(j, x);
+		}
+	}
+
+	dense_matrix<double> p(k, n);
+	for (index_t i = 0; i < k * n; ++i) p[i] = double(cnts[i]) / double(N);
+
+	dense_matrix<double> p0(k, n);
+	fill(p0, 1.0 / double(n));
+
+	ASSERT_MAT_APPROX(k, n, p, p0, get_p_tol(N));
+}
+
+struct floyd_sampler
+{
+	void operator() (index_t n, dense_col<int32_t>& r) const { rand_sample_floyd(rstream, n, r); }
+};
+
+struct hashed_sampler
+{
+	void operator() (index_t n, dense_col<int32_t>& r) const { rand_sample_hashed(rstream, n, r); }
+};
+
+struct wor_sampler
+{
+	void operator() (index_t n, dense_col<int32_t>& r) const { rand_sample_wor(rstream, n, r); }
+};
+
+struct shuffle_sampler
+{
+	void operator() (index_t n, dense_col<int32_t>& r) const { rand_permutation(rstream, r); }
+};
+
+
+SIMPLE_CASE( test_floyd )
+{
+	// the subset is uniform, hence so is each value's inclusion
+
+	const index_t n = 7;
+	const index_t k = 3;
+
+	dense_col<uint32_t> cnts(n, zero());
+	dense_col<int32_t> r(k);
+
+	for (index_t t = 0; t < N; ++t)
+	{
+		rand_sample_floyd(rstream, n, r);
+		for (index_t j = 0; j < k; ++j)
+		{
+			ASSERT_TRUE( r[j] >= 0 && r[j] < n );
+			for (index_t i = 0; i < j; ++i) ASSERT_TRUE( r[i] != r[j] );
+			++ cnts[r[j]];
+		}
+	}
+
+	for (index_t i = 0; i < n; ++i)
+		ASSERT_APPROX( double(cnts[i]) / double(N), double(k) / double(n), get_p_tol(N) );
+
+	// all of [0, n)
+
+	dense_col<int32_t> a(n);
+	rand_sample_floyd(rstream, n, a);
+	dense_col<bool> visited(n, zero());
+	for (index_t i = 0; i < n; ++i) visited[a[i]] = true;
+	for (index_t i = 0; i < n; ++i) ASSERT_TRUE( visited[i] );
+}
+
+SIMPLE_CASE( test_hashed )
+{
+	test_ordered_sample(7, 3, hashed_sampler());
+	test_ordered_sample(5, 5, hashed_sampler());
+}
+
+SIMPLE_CASE( test_wor )
+{
+	test_ordered_sample(20, 3, wor_sampler());  // by rejection
+	test_ordered_sample(5, 3, wor_sampler());   // by partial shuffle
+}
+
+SIMPLE_CASE( test_sample_large )
+{
+	const index_t n = 100000000;
+	const index_t k = 5000;
+
+	dense_col<uint32_t> r(k);
+	rand_sample_hashed(rstream, n, r);
+
+	std::vector<uint32_t> v(r.ptr_data(), r.ptr_data() + k);
+	std::sort(v.begin(), v.end());
+	ASSERT_TRUE( std::unique(v.begin(), v.end()) == v.end() );
+	ASSERT_TRUE( v.back() < (uint32_t)n );
+
+	rand_sample_floyd(rstream, n, r);
+	v.assign(r.ptr_data(), r.ptr_data() + k);
+	std::sort(v.begin(), v.end());
+	ASSERT_TRUE( std::unique(v.begin(), v.end()) == v.end() );
+	ASSERT_TRUE( v.back() < (uint32_t)n );
+
+	// k > n
+
+	dense_col<uint32_t> b(10);
+	bool thrown = false;
+	try { rand_sample_wor(rstream, 5, b); }
+	catch (invalid_argument& ) { thrown = true; }
+	ASSERT_TRUE( thrown );
+}
+
+SIMPLE_CASE( test_reservoir )
+{
+	const index_t n = 50;
+	const index_t k = 4;
+
+	dense_col<double> items(n);
+	for (index_t i = 0; i < n; ++i) items[i] = double(i);
+
+	dense_col<uint32_t> cnts(n, zero());
+
+	for (index_t t = 0; t < N; ++t)
+	{
+		reservoir_sampler<double> rsp(rstream, k);
+		ASSERT_EQ( rsp.capacity(), k );
+
+		// single items, then blocks
+
+		rsp.push(items[0]);
+		rsp.push(items[1]);
+		ASSERT_EQ( rsp.size(), 2 );
+
+		rsp.push(items.ptr_data() + 2, 11);
+		rsp.push(items.ptr_data() + 13, n - 13);
+
+		ASSERT_EQ( rsp.count(), (uint64_t)n );
+		ASSERT_EQ( rsp.size(), k );
+
+		for (index_t j = 0; j < k; ++j)
+		{
+			index_t x = (index_t)rsp.sample()[j];
+			ASSERT_TRUE( x >= 0 && x < n );
+			++ cnts[x];
+		}
+	}
+
+	for (index_t i = 0; i < n; ++i)
+		ASSERT_APPROX( double(cnts[i]) / double(N), double(k) / double(n), get_p_tol(N) );
+}
+
+SIMPLE_CASE( test_reservoir_long )
+{
+	// a stream longer than index_t (2^31 + 5 items)
+
+	const index_t len = index_t(1) << 20;
+	const uint64_t n = (uint64_t(1) << 31) + 5;
+
+	dense_col<uint32_t> items(len);
+	for (index_t i = 0; i < len; ++i) items[i] = (uint32_t)i;
+
+	reservoir_sampler<uint32_t> rsp(rstream, 1);
+
+	uint64_t m = 0;
+	while (m + (uint64_t)len <= n)
+	{
+		rsp.push(items.ptr_data(), len);
+		m += (uint64_t)len;
+	}
+	rsp.push(items.ptr_data(), (index_t)(n - m));
+
+	ASSERT_EQ( rsp.count(), n );
+	ASSERT_EQ( rsp.size(), 1 );
+	ASSERT_TRUE( rsp.sample()[0] < (uint32_t)len );
+
+	rsp.push(items[3]);
+	ASSERT_EQ( rsp.count(), n + 1 );
+}
+
+SIMPLE_CASE( test_shuffle )
+{
+	test_ordered_sample(5, 5, shuffle_sampler());
+}
+
+SIMPLE_CASE( test_merge_shuffled )
+{
+	// halves of different lengths
+
+	const index_t n = 5;
+	const index_t m = 2;
+
+	dense_matrix<uint32_t> cnts(n, n, zero());
+	random::internal::rand_word_batch<default_rand_stream> w(rstream);
+
+	for (index_t t = 0; t < N; ++t)
+	{
+		int32_t a[n] = {0, 1, 2, 3, 4};
+		random::internal::fisher_yates(w, a, m);
+		random::internal::fisher_yates(w, a + m, n - m);
+		random::internal::merge_shuffled(w, a, m, n);
+
+		for (index_t j = 0; j < n; ++j) ++ cnts(j, a[j]);
+	}
+
+	for (index_t i = 0; i < n * n; ++i)
+		ASSERT_APPROX( double(cnts[i]) / double(N), 1.0 / double(n), get_p_tol(N) );
+}
+
+SIMPLE_CASE( test_shuffle_long )
+{
+	// over several blocks, with uneven lengths
+
+	const index_t n = 5 * random::internal::shuffle_block_len + 17;
+
+	dense_col<int32_t> a(n);
+	rand_permutation(rstream, a);
+
+	dense_col<bool> visited(n, zero());
+	for (index_t i = 0; i < n; ++i)
+	{
+		ASSERT_TRUE( a[i] >= 0 && a[i] < n );
+		ASSERT_FALSE( visited[a[i]] );
+		visited[a[i]] = true;
+	}
+
+	// values from the first half are spread over both halves
+
+	index_t c = 0;
+	for (index_t i = 0; i < n / 2; ++i) if (a[i] < n / 2) ++c;
+	ASSERT_APPROX( double(c) / double(n / 2), 0.5, 0.01 );
+
+	// the same seed gives the same permutation
+
+	default_rand_stream rs1(42), rs2(42);
+	dense_col<int32_t> b1(n), b2(n);
+	rand_permutation(rs1, b1);
+	rand_permutation(rs2, b2);
+	ASSERT_VEC_EQ( n, b1, b2 );
+}
+
+template<class RStream>
+void verify_shuffle_substreams(RStream& rs)
+{
+	// the sub-streams of different blocks never share a sequence
+
+	const index_t ns = 2048;
+	const index_t len = 4;
+
+	random::internal::shuffle_substreams<RStream> subs(rs);
+
+	std::vector<uint64_t> heads((size_t)ns);
+	for (index_t k = 0; k < ns; ++k)
+	{
+		RStream sub;
+		subs.seed(sub, k);
+		uint32_t w[len];
+		sub.rand_seq(sizeof(w), w);
+		heads[k] = (uint64_t)w[0] | ((uint64_t)w[1] << 32);
+	}
+
+	std::sort(heads.begin(), heads.end());
+	ASSERT_TRUE( std::adjacent_find(heads.begin(), heads.end()) == heads.end() );
+
+	// and are reproducible
+
+	RStream s1, s2;
+	subs.seed(s1, 7);
+	subs.seed(s2, 7);
+	for (index_t i = 0; i < 16; ++i) ASSERT_EQ( s1.rand_u32(), s2.rand_u32() );
+}
+
+SIMPLE_CASE( test_shuffle_substreams )
+{
+	verify_shuffle_substreams(rstream);
+
+	philox4x32_stream prs(42);
+	verify_shuffle_substreams(prs);
+}
+
+SIMPLE_CASE( test_shuffle_huge )
+{
+	// the block bounds n * b / nb exceed the range of a 32-bit index_t
+
+	const index_t n = index_t(1) << 25;
+
+	dense_col<int32_t> a(n);
+	rand_permutation(rstream, a);
+
+	dense_col<bool> visited(n, zero());
+	for (index_t i = 0; i < n; ++i)
+	{
+		ASSERT_TRUE( a[i] >= 0 && a[i] < n );
+		ASSERT_FALSE( visited[a[i]] );
+		visited[a[i]] = true;
+	}
+
+	index_t c = 0;
+	for (index_t i = 0; i < n / 2; ++i) if (a[i] < n / 2) ++c;
+	ASSERT_APPROX( double(c) / double(n / 2), 0.5, 0.01 );
+}
+
+
 AUTO_TPACK( test_shuffler )
 {
 	ADD_T_CASE( test_shuffler, uint32_t )
@@ -94,3 +418,23 @@ AUTO_TPACK( test_past_avoider )
 	ADD_T_CASE( test_past_avoider, int32_t )
 }
 
+
+AUTO_TPACK( test_bulk_sample )
+{
+	ADD_SIMPLE_CASE( test_floyd )
+	ADD_SIMPLE_CASE( test_hashed )
+	ADD_SIMPLE_CASE( test_wor )
+	ADD_SIMPLE_CASE( test_sample_large )
+	ADD_SIMPLE_CASE( test_reservoir )
+	ADD_SIMPLE_CASE( test_reservoir_long )
+}
+
+
+AUTO_TPACK( test_bulk_shuffle )
+{
+	ADD_SIMPLE_CASE( test_shuffle )
+	ADD_SIMPLE_CASE( test_merge_shuffled )
+	ADD_SIMPLE_CASE( test_shuffle_long )
+	ADD_SIMPLE_CASE( test_shuffle_substreams )
+	ADD_SIMPLE_CASE( test_shuffle_huge )
+}
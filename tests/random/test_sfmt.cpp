@@ -255,6 +255,37 @@ void verify_sfmt_seq()
 }
 
 
+template<unsigned int MEXP>
+void verify_sfmt_key()
+{
+	// key-array seeding is deterministic, and keys differing
+	// in any single word give different streams
+
+	const unsigned int klen = 6;
+	const uint32_t key0[klen] = {0x1234, 0x5678, 0x9abc, 0xdef0, 0, 0};
+
+	sfmt_rand_stream<MEXP> rs;
+	rs.set_seed(key0, klen);
+
+	dense_col<uint32_t> v0(vlen);
+	for (index_t i = 0; i < vlen; ++i) v0[i] = rs.rand_u32();
+
+	rs.set_seed(key0, klen);
+	for (index_t i = 0; i < vlen; ++i) ASSERT_EQ( rs.rand_u32(), v0[i] );
+
+	for (unsigned int k = 0; k < klen; ++k)
+	{
+		uint32_t key[klen];
+		std::memcpy(key, key0, sizeof(key));
+		key[k] ^= 1;
+		rs.set_seed(key, klen);
+
+		index_t neq = 0;
+		for (index_t i = 0; i < vlen; ++i) if (rs.rand_u32() == v0[i]) ++neq;
+		ASSERT_TRUE( neq < 4 );
+	}
+}
+
 
 #define DEF_SFMT_TESTS( packname, tfunname ) \
 		SIMPLE_CASE( packname##_1279 ) { tfunname<1279>(); } \
@@ -285,5 +316,6 @@ DEF_SFMT_TESTS( sfmt_verify_m256, verify_sfmt_m256 )
 #endif
 
 DEF_SFMT_TESTS( sfmt_verify_seq, verify_sfmt_seq )
+DEF_SFMT_TESTS( sfmt_verify_key, verify_sfmt_key )
 
 
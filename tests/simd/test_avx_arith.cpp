@@ -10,6 +10,8 @@
 #include <light_mat/simd/avx_arith.h>
 #include <light_mat/math/math_base.h>
 
+#include <limits>
+
 using namespace lmat;
 using namespace lmat::test;
 
@@ -190,6 +192,30 @@ T_CASE( avx_fma )
 }
 
 
+#ifdef LMAT_HAS_FMA
+
+T_CASE( avx_fma_fused )
+{
+	typedef simd_pack<T, avx_t> pack_t;
+	const unsigned int width = pack_t::pack_width;
+
+	// (1 + e) * (1 - e) - 1 = -e^2, which is lost without a fused operation
+
+	const T e = std::numeric_limits<T>::epsilon();
+
+	pack_t a(T(1) + e);
+	pack_t b(T(1) - e);
+	pack_t c(T(-1));
+
+	T r1[width];
+	for (unsigned i = 0; i < width; ++i) r1[i] = -(e * e);
+
+	pack_t r = math::fma(a, b, c);
+	ASSERT_SIMD_EQ(r, r1);
+}
+
+#endif
+
 T_CASE( avx_abs )
 {
 	typedef simd_pack<T, avx_t> pack_t;
@@ -430,6 +456,9 @@ AUTO_TPACK( avx_arith )
 	ADD_T_CASE_FP( avx_div )
 	ADD_T_CASE_FP( avx_neg )
 	ADD_T_CASE_FP( avx_fma )
+#ifdef LMAT_HAS_FMA
+	ADD_T_CASE_FP( avx_fma_fused )
+#endif
 }
 
 AUTO_TPACK( avx_spower )
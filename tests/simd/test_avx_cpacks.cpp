@@ -0,0 +1,188 @@
+/**
+ * @file test_avx_cpacks.cpp
+ *
+ * Unit testing of AVX packs of complex numbers
+ *
+ * @author Dahua Lin
+ */
+
+#include "simd_test_base.h"
+#include <light_mat/simd/avx_cpacks.h>
+
+#include <cmath>
+
+using namespace lmat;
+using namespace lmat::test;
+
+typedef avx_t kind_t;
+
+
+template<typename T>
+inline bool cpk_approx(const simd_pack<std::complex<T>, kind_t>& pk, const std::complex<T> *ref, double tol)
+{
+	for (unsigned int i = 0; i < pk.width(); ++i)
+	{
+		if (std::abs(std::complex<double>(pk[i]) - std::complex<double>(ref[i])) > tol * (1.0 + std::abs(ref[i])))
+			return false;
+	}
+	return true;
+}
+
+template<typename T> struct cpk_tol;
+template<> struct cpk_tol<float>  { static double get() { return 1.0e-6; } };
+template<> struct cpk_tol<double> { static double get() { return 1.0e-14; } };
+
+template<typename T>
+inline void fill_cvals(std::complex<T> *p, unsigned int n, int seed)
+{
+	for (unsigned int i = 0; i < n; ++i)
+		p[i] = std::complex<T>(T(int(i) * 3 + seed) * T(0.25) - T(2), T(seed - 2 * int(i)) * T(0.5) + T(1));
+}
+
+
+T_CASE( avx_cpack_load_store )
+{
+	typedef std::complex<T> C;
+	typedef simd_pack<C, kind_t> pack_t;
+	const unsigned int w = pack_t::pack_width;
+
+	ASSERT_EQ( (unsigned int)sizeof(pack_t), 32u );
+
+	LMAT_ALIGN_AVX C src[4 * w];
+	fill_cvals(src, 4 * w, 1);
+
+	pack_t a(src);
+	ASSERT_SIMD_EQ( a, src );
+
+	pack_t b; b.load_a(src + w);
+	ASSERT_SIMD_EQ( b, src + w );
+
+	ASSERT_TRUE( a.to_scalar() == src[0] );
+	ASSERT_SIMD_EQ( pack_t(src[3]), src[3] );
+	ASSERT_SIMD_EQ( pack_t::zeros(), C(0) );
+	ASSERT_SIMD_EQ( pack_t::ones(), C(1) );
+
+	LMAT_ALIGN_AVX C dst[w];
+	a.store_u(dst);
+	ASSERT_SIMD_EQ( a, dst );
+	b.store_a(dst);
+	ASSERT_SIMD_EQ( b, dst );
+
+	for (index_t step = 1; step <= 3; ++step)
+	{
+		C ref[w];
+		for (unsigned int i = 0; i < w; ++i) ref[i] = src[i * step];
+
+		pack_t s;
+		s.load_strided(src, step);
+		ASSERT_SIMD_EQ( s, ref );
+	}
+}
+
+T_CASE( avx_cpack_arith )
+{
+	typedef std::complex<T> C;
+	typedef simd_pack<C, kind_t> pack_t;
+	const unsigned int w = pack_t::pack_width;
+	const double tol = cpk_tol<T>::get();
+
+	C x[w], y[w], r[w];
+	fill_cvals(x, w, 3);
+	fill_cvals(y, w, -5);
+
+	pack_t a(x), b(y);
+
+	for (unsigned int i = 0; i < w; ++i) r[i] = x[i] + y[i];
+	ASSERT_SIMD_EQ( a + b, r );
+
+	for (unsigned int i = 0; i < w; ++i) r[i] = x[i] - y[i];
+	ASSERT_SIMD_EQ( a - b, r );
+
+	for (unsigned int i = 0; i < w; ++i) r[i] = -x[i];
+	ASSERT_SIMD_EQ( -a, r );
+
+	for (unsigned int i = 0; i < w; ++i) r[i] = std::conj(x[i]);
+	ASSERT_SIMD_EQ( math::conj(a), r );
+
+	for (unsigned int i = 0; i < w; ++i) r[i] = x[i] * y[i];
+	ASSERT_TRUE( cpk_approx(a * b, r, tol) );
+
+	pack_t c = a;
+	c *= b;
+	ASSERT_TRUE( cpk_approx(c, r, tol) );
+
+	for (unsigned int i = 0; i < w; ++i) r[i] = x[i] * y[i] + x[i];
+	ASSERT_TRUE( cpk_approx(math::fma(a, b, a), r, tol) );
+
+	for (unsigned int i = 0; i < w; ++i) r[i] = x[i] / y[i];
+	ASSERT_TRUE( cpk_approx(a / b, r, tol) );
+
+	c = a;
+	c /= b;
+	ASSERT_TRUE( cpk_approx(c, r, tol) );
+
+	c = a;
+	c += b;
+	c -= b;
+	ASSERT_TRUE( cpk_approx(c, x, tol) );
+}
+
+T_CASE( avx_cpack_reduce )
+{
+	typedef std::complex<T> C;
+	typedef simd_pack<C, kind_t> pack_t;
+	const unsigned int w = pack_t::pack_width;
+
+	C x[w];
+	fill_cvals(x, w, 7);
+
+	C s(0);
+	for (unsigned int i = 0; i < w; ++i) s += x[i];
+
+	C r = sum(pack_t(x));
+	ASSERT_APPROX( r.real(), s.real(), cpk_tol<T>::get() * 10 );
+	ASSERT_APPROX( r.imag(), s.imag(), cpk_tol<T>::get() * 10 );
+}
+
+T_CASE( avx_cpack_parts )
+{
+	typedef std::complex<T> C;
+	typedef simd_pack<C, kind_t> pack_t;
+	typedef simd_pack<T, kind_t> rpack_t;
+	const unsigned int w = pack_t::pack_width;
+	const unsigned int rw = rpack_t::pack_width;
+	const double tol = cpk_tol<T>::get();
+
+	C x[2 * w];
+	fill_cvals(x, 2 * w, -4);
+
+	T re[2 * w], im[2 * w], nrm[2 * w], ab[2 * w];
+	for (unsigned int i = 0; i < rw; ++i)
+	{
+		re[i] = x[i].real();
+		im[i] = x[i].imag();
+		nrm[i] = std::norm(x[i]);
+		ab[i] = std::abs(x[i]);
+	}
+
+	pack_t a0(x), a1(x + w);
+
+	ASSERT_SIMD_EQ( real(a0, a1), re );
+	ASSERT_SIMD_EQ( imag(a0, a1), im );
+
+	T r[2 * w];
+	norm(a0, a1).store_u(r);
+	for (unsigned int i = 0; i < rw; ++i) ASSERT_APPROX( r[i], nrm[i], tol * nrm[i] );
+
+	abs(a0, a1).store_u(r);
+	for (unsigned int i = 0; i < rw; ++i) ASSERT_APPROX( r[i], ab[i], tol * ab[i] );
+}
+
+
+AUTO_TPACK( avx_cpacks )
+{
+	ADD_T_CASE_FP( avx_cpack_load_store )
+	ADD_T_CASE_FP( avx_cpack_arith )
+	ADD_T_CASE_FP( avx_cpack_reduce )
+	ADD_T_CASE_FP( avx_cpack_parts )
+}
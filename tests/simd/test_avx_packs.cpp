@@ -159,6 +159,44 @@ T_CASE( avx_pack_stores )
 }
 
 
+T_CASE( avx_pack_load_strided )
+{
+	typedef simd_pack<T, avx_t> pack_t;
+	const unsigned int width = pack_t::pack_width;
+
+	// small steps are loaded by deinterleaving
+
+	const index_t max_step = 5;
+	T src[width * max_step];
+	for (unsigned i = 0; i < width * max_step; ++i) src[i] = T(2.4 + i);
+
+	for (index_t step = 1; step <= max_step; ++step)
+	{
+		const index_t n = ((index_t)width - 1) * step + 1;
+
+		T r[width];
+		for (unsigned i = 0; i < width; ++i) r[i] = src[i * step];
+
+		pack_t pk;
+		pk.load_strided(src, step);
+		ASSERT_SIMD_EQ( pk, r );
+
+		// ending at the last element
+
+		for (unsigned i = 0; i < width; ++i) r[i] = src[width * max_step - n + i * step];
+
+		pk.load_strided(src + width * max_step - n, step);
+		ASSERT_SIMD_EQ( pk, r );
+
+		// negative step
+
+		for (unsigned i = 0; i < width; ++i) r[i] = src[(width - 1 - i) * step];
+
+		pk.load_strided(src + (width - 1) * step, -step);
+		ASSERT_SIMD_EQ( pk, r );
+	}
+}
+
 TI_CASE( avx_pack_load_parts )
 {
 	typedef simd_pack<T, avx_t> pack_t;
@@ -256,6 +294,7 @@ AUTO_TPACK( avx_basics )
 	ADD_T_CASE_FP( avx_pack_sets )
 	ADD_T_CASE_FP( avx_pack_loads )
 	ADD_T_CASE_FP( avx_pack_stores )
+	ADD_T_CASE_FP( avx_pack_load_strided )
 }
 
 AUTO_TPACK( avx_parts )
@@ -72,6 +72,42 @@ T_CASE( sse_min )
 }
 
 
+T_CASE( sse_prefix )
+{
+	typedef simd_pack<T, sse_t> pack_t;
+	const unsigned int width = pack_t::pack_width;
+
+	const T vals[8] = {T(2), T(-1), T(3), T(0.5), T(-4), T(1.5), T(5), T(-2)};
+	T a_src[width];
+	for (unsigned i = 0; i < width; ++i) a_src[i] = vals[i];
+
+	T r_sum[width], r_prod[width], r_max[width], r_min[width];
+	r_sum[0] = r_prod[0] = r_max[0] = r_min[0] = a_src[0];
+	for (unsigned i = 1; i < width; ++i)
+	{
+		r_sum[i] = r_sum[i-1] + a_src[i];
+		r_prod[i] = r_prod[i-1] * a_src[i];
+		r_max[i] = a_src[i] > r_max[i-1] ? a_src[i] : r_max[i-1];
+		r_min[i] = a_src[i] < r_min[i-1] ? a_src[i] : r_min[i-1];
+	}
+
+	pack_t a; a.load_u(a_src);
+	T r[width];
+
+	prefix_sum(a).store_u(r);
+	ASSERT_VEC_EQ( width, r, r_sum );
+
+	prefix_prod(a).store_u(r);
+	ASSERT_VEC_EQ( width, r, r_prod );
+
+	prefix_max(a).store_u(r);
+	ASSERT_VEC_EQ( width, r, r_max );
+
+	prefix_min(a).store_u(r);
+	ASSERT_VEC_EQ( width, r, r_min );
+}
+
+
 SIMPLE_CASE( sse_booltest_f32 )
 {
 	const unsigned int M = 15;
@@ -133,6 +169,7 @@ AUTO_TPACK( sse_stats )
 	ADD_T_CASE_FP( sse_sum )
 	ADD_T_CASE_FP( sse_max )
 	ADD_T_CASE_FP( sse_min )
+	ADD_T_CASE_FP( sse_prefix )
 }
 
 AUTO_TPACK( sse_booltest )